@@ -39,13 +39,17 @@
 
 #include "buffer_fv1.h"
 
+#include <algorithm>  // for std::max
+#include <cmath>  // for exp, sqrt
+
 namespace ug {
 namespace neuro_collection {
 
 
 template<typename TDomain>
 BufferFV1<TDomain>::BufferFV1(const char* subsets)
-: IElemDisc<TDomain>(NULL, subsets), m_bNonRegularGrid(false)
+: IElemDisc<TDomain>(NULL, subsets), m_bNonRegularGrid(false), m_bRapidBuffer(false),
+  m_bSplitting(false)
 {
 	m_reactions.reserve(1);
 }
@@ -69,6 +73,84 @@ void BufferFV1<TDomain>::set_num_reactions(size_t n)
 }
 
 
+template<typename TDomain>
+void BufferFV1<TDomain>::set_rapid_buffer_approximation(bool b)
+{
+	UG_COND_THROW(m_reactions.size(),
+		"Rapid buffer approximation must be set before adding the first reaction.");
+
+	UG_COND_THROW(b && m_bSplitting,
+		"Rapid buffer approximation and operator splitting cannot be combined.");
+
+	m_bRapidBuffer = b;
+}
+
+
+template<typename TDomain>
+void BufferFV1<TDomain>::set_operator_splitting(bool b)
+{
+	UG_COND_THROW(b && m_bRapidBuffer,
+		"Rapid buffer approximation and operator splitting cannot be combined.");
+
+	m_bSplitting = b;
+}
+
+
+template<typename TDomain>
+void BufferFV1<TDomain>::integrate_binding
+(
+	number& c,
+	number& b,
+	number btot,
+	number kb,
+	number ku,
+	number dt
+)
+{
+	// the difference of free substance and free buffer is conserved
+	const number s = c - b;
+
+	// without binding, the buffer only dissociates
+	if (kb <= 0.0)
+	{
+		const number cInf = btot + s;
+		c = cInf + (c - cInf) * exp(-ku * dt);
+		b = c - s;
+		return;
+	}
+
+	// dc/dt = -kb (c - a)(c - beta) with roots a >= 0 >= beta of
+	// kb c^2 - (kb s - ku) c - ku (btot + s)
+	const number p = kb * s - ku;
+	const number q = ku * (btot + s);
+	const number sq = sqrt(std::max(p*p + 4.0 * kb * q, 0.0));
+	number a, beta;
+	if (p >= 0.0)
+	{
+		a = (p + sq) / (2.0 * kb);
+		beta = a > 0.0 ? -q / (kb * a) : 0.0;
+	}
+	else
+	{
+		beta = (p - sq) / (2.0 * kb);
+		a = -q / (kb * beta);
+	}
+
+	// exact solution of the Riccati equation
+	const number diff = a - beta;
+	const number dev = c - a;
+	const number x = kb * diff * dt;
+	if (x < 1e-12)
+		c = a + dev / (1.0 + kb * dev * dt);
+	else
+	{
+		const number E = exp(-x);
+		c = a + dev * diff * E / (diff + dev * (1.0 - E));
+	}
+	b = c - s;
+}
+
+
 template<typename TDomain>
 void BufferFV1<TDomain>::prepare_setting(const std::vector<LFEID>& vLfeID, bool bNonRegularGrid)
 {
@@ -88,6 +170,12 @@ void BufferFV1<TDomain>::prepare_setting(const std::vector<LFEID>& vLfeID, bool
 
 	// update assemble functions
 	register_all_fv1_funcs(m_bNonRegularGrid);
+
+	// instrumentation
+	NC_HOT_PATH_LABEL(m_hpDefA, "BufferFV1::add_def_A_elem", "BufferFV1", hot_path_subset_label(this->symb_subsets()));
+	NC_HOT_PATH_LABEL(m_hpJacA, "BufferFV1::add_jac_A_elem", "BufferFV1", hot_path_subset_label(this->symb_subsets()));
+	NC_HOT_PATH_PREPARE_THREADS(m_hpDefA);
+	NC_HOT_PATH_PREPARE_THREADS(m_hpJacA);
 }
 
 template<typename TDomain>
@@ -133,6 +221,13 @@ add_reaction(const char* fct1, const char* fct2,
 		}
 	}
 
+	// no buffer unknown in the rapid buffer approximation
+	if (m_bRapidBuffer)
+	{
+		fctIndex1 = (size_t) -1;
+		found1 = true;
+	}
+
 	if (!found1)
 	{
 		fctIndex1 = fcts.size();
@@ -183,11 +278,101 @@ add_reaction(const char* fct1, const char* fct2, number tbc, number k1, number k
 }
 
 
+template<typename TDomain>
+void BufferFV1<TDomain>::pack_reactions()
+{
+	const size_t nR = m_reactions.size();
+	m_kernel.vBuffer.resize(nR);
+	m_kernel.vBuffered.resize(nR);
+	m_kernel.vbConst.resize(nR);
+	m_kernel.vConstTotBuffer.resize(nR);
+	m_kernel.vConstKBind.resize(nR);
+	m_kernel.vConstKUnbind.resize(nR);
+
+	// provide scratch buffers for all threads
+	m_reactScratch.ensure_capacity();
+
+	const MathVector<dim> x(0.0);
+	for (size_t r = 0; r < nR; ++r)
+	{
+		const ReactionInfo<dim>& react = m_reactions[r];
+		m_kernel.vBuffer[r] = react.buffer;
+		m_kernel.vBuffered[r] = react.buffered;
+
+		// constant coefficients need not be taken from the imports for every element
+		const bool bConst = react.spTotBuffer->constant() && react.spKBind->constant()
+			&& react.spKUnbind->constant();
+		m_kernel.vbConst[r] = bConst;
+		if (bConst)
+		{
+			(*react.spTotBuffer)(m_kernel.vConstTotBuffer[r], x, this->time(), -1);
+			(*react.spKBind)(m_kernel.vConstKBind[r], x, this->time(), -1);
+			(*react.spKUnbind)(m_kernel.vConstKUnbind[r], x, this->time(), -1);
+		}
+	}
+}
+
+
+template<typename TDomain>
+template<typename TFVGeom>
+void BufferFV1<TDomain>::gather_reaction_data(const LocalVector& u, const TFVGeom& fvgeom, ReactionScratch& rs)
+{
+	const size_t nR = m_kernel.vBuffer.size();
+	const size_t nSCV = fvgeom.num_scv();
+	const size_t n = nR * nSCV;
+	rs.vTotBuffer.resize(n);
+	rs.vKBind.resize(n);
+	rs.vKUnbind.resize(n);
+	rs.vB.resize(n);
+	rs.vC.resize(n);
+	rs.vRes1.resize(n);
+	rs.vRes2.resize(n);
+
+	for (size_t r = 0; r < nR; ++r)
+	{
+		const ReactionInfo<dim>& react = m_reactions[r];
+		UG_ASSERT(react.k_bind.data_given() && react.k_unbind.data_given() &&  react.tot_buffer.data_given(),
+				  "Data import for buffering reaction has no data.");
+		const size_t buffer = m_kernel.vBuffer[r];
+		const size_t buffered = m_kernel.vBuffered[r];
+		const size_t off = r * nSCV;
+		for (size_t ip = 0; ip < nSCV; ++ip)
+		{
+			const int co = fvgeom.scv(ip).node_id();
+			rs.vB[off + ip] = u(buffer, co);
+			rs.vC[off + ip] = u(buffered, co);
+		}
+
+		if (m_kernel.vbConst[r])
+		{
+			for (size_t ip = 0; ip < nSCV; ++ip)
+			{
+				rs.vTotBuffer[off + ip] = m_kernel.vConstTotBuffer[r];
+				rs.vKBind[off + ip] = m_kernel.vConstKBind[r];
+				rs.vKUnbind[off + ip] = m_kernel.vConstKUnbind[r];
+			}
+		}
+		else
+		{
+			for (size_t ip = 0; ip < nSCV; ++ip)
+			{
+				rs.vTotBuffer[off + ip] = react.tot_buffer[ip];
+				rs.vKBind[off + ip] = react.k_bind[ip];
+				rs.vKUnbind[off + ip] = react.k_unbind[ip];
+			}
+		}
+	}
+}
+
+
 template<typename TDomain>
 template<typename TElem, typename TFVGeom>
 void BufferFV1<TDomain>::
 prep_elem_loop(const ReferenceObjectID roid, const int si)
 {
+	// pack reaction data for the fused kernels
+	pack_reactions();
+
 	//	set local positions
 	if (!TFVGeom::usesHangingNodes)
 	{
@@ -255,6 +440,57 @@ template<typename TElem, typename TFVGeom>
 void BufferFV1<TDomain>::
 add_def_A_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
 {
+	NC_HOT_PATH_SCOPE(m_hpDefA);
+
+	// only mass terms in the rapid buffer approximation,
+	// nothing at all if reactions are integrated separately
+	if (m_bRapidBuffer || m_bSplitting) return;
+
+	// get finite volume geometry
+	static const TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const size_t nSCV = fvgeom.num_scv();
+	const size_t nR = m_kernel.vBuffer.size();
+	if (!nR) return;
+
+	// gather data of all reactions at all scvs
+	ReactionScratch& rs = m_reactScratch.local();
+	gather_reaction_data(u, fvgeom, rs);
+
+	// compute all reaction terms in one pass
+	const number* tb = &rs.vTotBuffer[0];
+	const number* kb = &rs.vKBind[0];
+	const number* ku = &rs.vKUnbind[0];
+	const number* b = &rs.vB[0];
+	const number* c = &rs.vC[0];
+	number* def = &rs.vRes1[0];
+	const size_t n = nR * nSCV;
+	for (size_t k = 0; k < n; ++k)
+		def[k] = kb[k] * b[k] * c[k] - ku[k] * (tb[k] - b[k]);
+
+	// scale with scv volume and add to defect
+	for (size_t ip = 0; ip < nSCV; ++ip)
+	{
+		const typename TFVGeom::SCV& scv = fvgeom.scv(ip);
+		const int co = scv.node_id();
+		const number vol = scv.volume();
+		for (size_t r = 0; r < nR; ++r)
+		{
+			const number dr = def[r*nSCV + ip] * vol;
+			d(m_kernel.vBuffer[r], co) += dr;
+			d(m_kernel.vBuffered[r], co) += dr;
+		}
+	}
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void BufferFV1<TDomain>::
+add_def_M_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{
+	// mass terms only for the bound buffer in the rapid buffer approximation
+	if (!m_bRapidBuffer) return;
+
 	// get finite volume geometry
 	static const TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
 
@@ -270,34 +506,84 @@ add_def_A_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const Mat
 		// loop reactions
 		for (size_t j = 0; j < m_reactions.size(); j++)
 		{
-			// compute local defect
 			const struct ReactionInfo<dim>& r = m_reactions[j];
 			UG_ASSERT(r.k_bind.data_given() && r.k_unbind.data_given() &&  r.tot_buffer.data_given(),
 					  "Data import for buffering reaction has no data.");
-			number def =   r.k_bind[ip] * u(r.buffer, co) * u(r.buffered, co)
-						 - r.k_unbind[ip] * (r.tot_buffer[ip] - u(r.buffer, co));
+			if (!r.k_bind[ip]) continue;
 
-			// scale with scv volume and add to defect
-			d(r.buffer, co) +=	def * scv.volume();
-			d(r.buffered, co) += def * scv.volume();
+			// bound buffer in equilibrium with the buffered substance
+			const number kd = r.k_unbind[ip] / r.k_bind[ip];
+			const number c = u(r.buffered, co);
+			d(r.buffered, co) += r.tot_buffer[ip] * c / (kd + c) * scv.volume();
 		}
 	}
 }
 
 
+// assemble stiffness part of Jacobian
 template<typename TDomain>
 template<typename TElem, typename TFVGeom>
 void BufferFV1<TDomain>::
-add_def_M_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
-{}
+add_jac_A_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{
+	NC_HOT_PATH_SCOPE(m_hpJacA);
 
+	// only mass terms in the rapid buffer approximation,
+	// nothing at all if reactions are integrated separately
+	if (m_bRapidBuffer || m_bSplitting) return;
+
+	// get finite volume geometry
+	static const TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const size_t nSCV = fvgeom.num_scv();
+	const size_t nR = m_kernel.vBuffer.size();
+	if (!nR) return;
+
+	// gather data of all reactions at all scvs
+	ReactionScratch& rs = m_reactScratch.local();
+	gather_reaction_data(u, fvgeom, rs);
+
+	// compute all local derivatives in one pass
+	const number* kb = &rs.vKBind[0];
+	const number* ku = &rs.vKUnbind[0];
+	const number* b = &rs.vB[0];
+	const number* c = &rs.vC[0];
+	number* d_dBuff = &rs.vRes1[0];
+	number* d_dBuffd = &rs.vRes2[0];
+	const size_t n = nR * nSCV;
+	for (size_t k = 0; k < n; ++k)
+	{
+		d_dBuff[k] = kb[k] * c[k] + ku[k];
+		d_dBuffd[k] = kb[k] * b[k];
+	}
+
+	// scale with scv volume and add to Jacobian
+	for (size_t ip = 0; ip < nSCV; ++ip)
+	{
+		const typename TFVGeom::SCV& scv = fvgeom.scv(ip);
+		const int co = scv.node_id();
+		const number vol = scv.volume();
+		for (size_t r = 0; r < nR; ++r)
+		{
+			const size_t buffer = m_kernel.vBuffer[r];
+			const size_t buffered = m_kernel.vBuffered[r];
+			const number jb = d_dBuff[r*nSCV + ip] * vol;
+			const number jc = d_dBuffd[r*nSCV + ip] * vol;
+			J(buffer, co, buffer, co)     += jb;
+			J(buffer, co, buffered, co)   += jc;
+			J(buffered, co, buffer, co)   += jb;
+			J(buffered, co, buffered, co) += jc;
+		}
+	}
+}
 
-// assemble stiffness part of Jacobian
 template<typename TDomain>
 template<typename TElem, typename TFVGeom>
 void BufferFV1<TDomain>::
-add_jac_A_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+add_jac_M_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
 {
+	// mass terms only for the bound buffer in the rapid buffer approximation
+	if (!m_bRapidBuffer) return;
+
 	// get finite volume geometry
 	static const TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
 
@@ -313,27 +599,19 @@ add_jac_A_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const Mat
 		// loop reactions
 		for (size_t j = 0; j < m_reactions.size(); j++)
 		{
-			// compute local derivatives
 			const struct ReactionInfo<dim>& r = m_reactions[j];
-			UG_ASSERT(r.k_bind.data_given() && r.k_unbind.data_given(), "Data import for buffering reaction has no data.");
-			number d_dBuff  = r.k_bind[ip] * u(r.buffered, co) + r.k_unbind[ip];
-			number d_dBuffd = r.k_bind[ip] * u(r.buffer, co);
-
-			// scale with scv volume and add to Jacobian
-			J(r.buffer, co, r.buffer, co)     += d_dBuff * scv.volume();
-			J(r.buffer, co, r.buffered, co)   += d_dBuffd * scv.volume();
-			J(r.buffered, co, r.buffer, co)   += d_dBuff * scv.volume();
-			J(r.buffered, co, r.buffered, co) += d_dBuffd * scv.volume();
+			UG_ASSERT(r.k_bind.data_given() && r.k_unbind.data_given() &&  r.tot_buffer.data_given(),
+					  "Data import for buffering reaction has no data.");
+			if (!r.k_bind[ip]) continue;
+
+			// derivative of the bound buffer (additional buffering capacity)
+			const number kd = r.k_unbind[ip] / r.k_bind[ip];
+			const number c = u(r.buffered, co);
+			J(r.buffered, co, r.buffered, co) += r.tot_buffer[ip] * kd / ((kd + c)*(kd + c)) * scv.volume();
 		}
 	}
 }
 
-template<typename TDomain>
-template<typename TElem, typename TFVGeom>
-void BufferFV1<TDomain>::
-add_jac_M_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
-{}
-
 
 template<typename TDomain>
 template<typename TElem, typename TFVGeom>
@@ -505,6 +783,9 @@ compute_err_est_A_elem(const LocalVector& u, GridObject* elem, const MathVector<
 {
 	// we have only elem parts here, no integral over a side
 
+	// no reaction terms in the rapid buffer approximation or with operator splitting
+	if (m_bRapidBuffer || m_bSplitting) return;
+
 	// err est data object
 	err_est_type* err_est_data = dynamic_cast<err_est_type*>(this->m_spErrEstData.get());
 	if (err_est_data->num() < this->symb_fcts().size())
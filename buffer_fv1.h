@@ -53,6 +53,10 @@
 #include "lib_disc/spatial_disc/disc_util/fv1_geom.h"
 #include "lib_disc/spatial_disc/disc_util/hfv1_geom.h"
 #include "lib_disc/spatial_disc/disc_util/geom_provider.h"
+#include "lib_disc/dof_manager/dof_distribution.h"  // for DoFDistribution
+
+#include "util/thread_scratch.h"  // for ThreadScratch
+#include "util/hot_path_counters.h"  // for NC_HOT_PATH_COUNTER
 
 
 
@@ -71,7 +75,7 @@ template<int dim> struct ReactionInfo
 				 SmartPtr<CplUserData<number, dim> > _tb,
 			     SmartPtr<CplUserData<number, dim> > _kb,
 			     SmartPtr<CplUserData<number, dim> > _ku)
-		: buffer(_b), buffered(_bd)
+		: buffer(_b), buffered(_bd), spTotBuffer(_tb), spKBind(_kb), spKUnbind(_ku)
 	{
 		tot_buffer.set_data(_tb);
 		k_bind.set_data(_kb);
@@ -83,6 +87,11 @@ template<int dim> struct ReactionInfo
 	DataImport<number, dim> tot_buffer; // data import for total buffer concentration
 	DataImport<number, dim> k_bind;		// binding constant
 	DataImport<number, dim> k_unbind;	// unbinding constant
+
+	// user data (for evaluation outside of the assembling)
+	SmartPtr<CplUserData<number, dim> > spTotBuffer;
+	SmartPtr<CplUserData<number, dim> > spKBind;
+	SmartPtr<CplUserData<number, dim> > spKUnbind;
 };
 
 /// Discretization for a buffering equation.
@@ -107,9 +116,29 @@ template<int dim> struct ReactionInfo
  *
  * \tparam	TDomain		Domain
  *
+ * For fast buffers, the rapid buffer approximation can be used instead
+ * (set_rapid_buffer_approximation()). The buffering reaction is then assumed to be
+ * in equilibrium at all times, and the (immobile) buffer is eliminated analytically:
+ * The bound buffer concentration is
+ * \f[
+ * 		b_{bound}(c) = \frac{b_{tot} \cdot c}{K_D + c}, \quad K_D = \frac{k_u}{k_b},
+ * \f]
+ * and this discretization assembles its time derivative \f$ \partial_t b_{bound}(c) \f$
+ * as an extra mass term for the buffered substance, i.e., an effective capacity of
+ * \f$ 1 + b_{tot} K_D / (K_D + c)^2 \f$. There is no buffer unknown in this case;
+ * the buffer function name given in add_reaction() is ignored.
+ *
+ * As another alternative for stiff reactions, operator splitting can be used
+ * (set_operator_splitting()). The reactions are then not assembled at all; instead,
+ * integrate_reactions() integrates them exactly, vertex by vertex, and has to be
+ * called by the time stepping scheme, e.g., for dt/2 before and after each
+ * transport step (Strang splitting). In this case, the buffer functions need another
+ * discretization providing their time derivative (e.g., diffusion with zero diffusivity).
+ *
  * \note This discretization must always be used in conjunction with another
  * 		 time-dependent process such as diffusion which carries out the discretization
- * 		 of the time derivative. NO MASS ASSEMBLINGS ARE PERFORMED IN THIS DISCRETIZATION.
+ * 		 of the time derivative. NO MASS ASSEMBLINGS ARE PERFORMED IN THIS DISCRETIZATION
+ * 		 (except for the bound buffer in the rapid buffer approximation).
  * 		 This has the advantage that the discretization can simply be added to a domain
  * 		 disc already containing a diffusion disc e.g.
  *
@@ -153,6 +182,33 @@ class BufferFV1
         /// set number of reactions
         void set_num_reactions(size_t n);
 
+        /**
+         * @brief use the rapid buffer approximation for all reactions
+         * This must be set before the first reaction is added.
+         * Default is false.
+         */
+        void set_rapid_buffer_approximation(bool b);
+
+        /**
+         * @brief do not assemble the reactions (operator splitting)
+         * The reactions then need to be integrated using integrate_reactions().
+         * Default is false.
+         */
+        void set_operator_splitting(bool b);
+
+        /**
+         * @brief integrate all reactions over a time interval
+         * Each reaction is integrated exactly at each corner of the elements of
+         * the subsets of this discretization (including corners in boundary or
+         * membrane subsets), the coefficients being evaluated at the given time.
+         *
+         * @param u      solution to be updated
+         * @param time   time the reaction step starts at
+         * @param dt     length of the reaction step
+         */
+        template <typename TGridFunction>
+        void integrate_reactions(SmartPtr<TGridFunction> u, number time, number dt) const;
+
         /// add a reaction (with DataImports)
         void add_reaction
 		(
@@ -177,6 +233,22 @@ class BufferFV1
         void add_reaction(const char* fct1, const char* fct2, number tbc, number k1, number k2);
 
 
+	protected:
+        /// exact solution of a single binding reaction over a time interval
+        static void integrate_binding(number& c, number& b, number btot, number kb, number ku, number dt);
+
+        /// append all unmarked corners of the elements of a subset (and mark them)
+        template <typename TBaseElem>
+        static void collect_corners
+        (
+        	Grid& grid,
+        	ConstSmartPtr<DoFDistribution> dd,
+        	int si,
+        	std::vector<Vertex*>& vVrt,
+        	std::vector<int>& vSI
+        );
+
+
 	private:
 		/// reactions information
 		std::vector<ReactionInfo<dim> > m_reactions;
@@ -275,8 +347,45 @@ class BufferFV1
 				std::vector<std::vector<number> > elemVals;
 		} m_shapeValues;
 
+		/// reaction data in structure-of-arrays layout for the fused element kernels
+		struct ReactionKernelData
+		{
+			std::vector<size_t> vBuffer;		///< buffer function index per reaction
+			std::vector<size_t> vBuffered;		///< buffered function index per reaction
+			std::vector<bool> vbConst;			///< whether reaction coefficients are constant
+			std::vector<number> vConstTotBuffer;
+			std::vector<number> vConstKBind;
+			std::vector<number> vConstKUnbind;
+		} m_kernel;
+
+		/// per (reaction, scv) values for the fused element kernels, index r*nSCV + ip
+		struct ReactionScratch
+		{
+			std::vector<number> vTotBuffer;
+			std::vector<number> vKBind;
+			std::vector<number> vKUnbind;
+			std::vector<number> vB;
+			std::vector<number> vC;
+			std::vector<number> vRes1;
+			std::vector<number> vRes2;
+		};
+		ThreadScratch<ReactionScratch> m_reactScratch;  ///< one set of buffers per thread
+
+		/// pack reaction indices and constant coefficients (called in prep_elem_loop)
+		void pack_reactions();
+
+		/// gather coefficients and unknowns of all reactions at all scvs of an element
+		template<typename TFVGeom>
+		void gather_reaction_data(const LocalVector& u, const TFVGeom& fvgeom, ReactionScratch& rs);
+
 	private:
 		bool m_bNonRegularGrid;
+		bool m_bRapidBuffer;
+		bool m_bSplitting;
+
+		/// instrumentation (if enabled)
+		NC_HOT_PATH_COUNTER(m_hpDefA)
+		NC_HOT_PATH_COUNTER(m_hpJacA)
 };
 
 ///@}
@@ -284,4 +393,6 @@ class BufferFV1
 } // namespace neuro_collection
 } // namespace ug
 
+#include "buffer_fv1_impl.h"
+
 #endif // UG__PLUGINS__NEURO_COLLECTION__BUFFER_FV1_H
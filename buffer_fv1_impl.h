@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "buffer_fv1.h"
+
+#include "lib_disc/common/multi_index.h"  // for DoFIndex
+#include "lib_grid/tools/subset_group.h"  // for SubsetGroup
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template<typename TDomain>
+template <typename TBaseElem>
+void BufferFV1<TDomain>::collect_corners
+(
+	Grid& grid,
+	ConstSmartPtr<DoFDistribution> dd,
+	int si,
+	std::vector<Vertex*>& vVrt,
+	std::vector<int>& vSI
+)
+{
+	typedef typename DoFDistribution::traits<TBaseElem>::const_iterator it_type;
+	it_type it = dd->template begin<TBaseElem>(si);
+	it_type itEnd = dd->template end<TBaseElem>(si);
+	for (; it != itEnd; ++it)
+	{
+		TBaseElem* elem = *it;
+		const size_t nCo = elem->num_vertices();
+		for (size_t co = 0; co < nCo; ++co)
+		{
+			Vertex* vrt = elem->vertex(co);
+			if (grid.is_marked(vrt)) continue;
+			grid.mark(vrt);
+			vVrt.push_back(vrt);
+			vSI.push_back(si);
+		}
+	}
+}
+
+
+template<typename TDomain>
+template <typename TGridFunction>
+void BufferFV1<TDomain>::integrate_reactions(SmartPtr<TGridFunction> u, number time, number dt) const
+{
+	UG_COND_THROW(m_bRapidBuffer, "There are no buffer unknowns in the rapid buffer approximation.");
+
+	ConstSmartPtr<DoFDistribution> dd = u->dd();
+	const typename TDomain::position_accessor_type& aaPos = u->domain()->position_accessor();
+	SubsetGroup ssg(u->domain()->subset_handler(), this->symb_subsets());
+	const std::vector<std::string>& vFct = this->symb_fcts();
+
+	// collect all corners of the elements of this disc's subsets (once each);
+	// boundary and membrane vertices (in other subsets) are included this way,
+	// just as in the assembled case; user data are evaluated in the element subset
+	std::vector<Vertex*> vVrt;
+	std::vector<int> vVrtSI;
+	Grid& grid = *u->domain()->grid();
+	grid.begin_marking();
+	for (size_t i = 0; i < ssg.size(); ++i)
+	{
+		const int si = ssg[i];
+		switch (ssg.dim(i))
+		{
+			case 0: collect_corners<Vertex>(grid, dd, si, vVrt, vVrtSI); break;
+			case 1: collect_corners<Edge>(grid, dd, si, vVrt, vVrtSI); break;
+			case 2: collect_corners<Face>(grid, dd, si, vVrt, vVrtSI); break;
+			case 3: collect_corners<Volume>(grid, dd, si, vVrt, vVrtSI); break;
+			default: break;
+		}
+	}
+	grid.end_marking();
+
+	// collect DoFs and coefficients first (user data might not be thread-safe)
+	std::vector<DoFIndex> vDI;
+	std::vector<DoFIndex> vBufferDI, vBufferedDI;
+	std::vector<number> vTotBuffer, vKBind, vKUnbind;
+
+	const size_t nVrt = vVrt.size();
+	const size_t nReact = m_reactions.size();
+	std::vector<size_t> vReactStart(1, 0);
+	for (size_t r = 0; r < nReact; ++r)
+	{
+		const ReactionInfo<dim>& react = m_reactions[r];
+		const size_t fctBuffer = u->fct_id_by_name(vFct[react.buffer].c_str());
+		const size_t fctBuffered = u->fct_id_by_name(vFct[react.buffered].c_str());
+
+		for (size_t v = 0; v < nVrt; ++v)
+		{
+			Vertex* vrt = vVrt[v];
+			const int si = vVrtSI[v];
+
+			dd->inner_dof_indices(vrt, fctBuffer, vDI, true);
+			if (vDI.size() != 1) continue;
+			const DoFIndex diBuffer = vDI[0];
+			dd->inner_dof_indices(vrt, fctBuffered, vDI, true);
+			if (vDI.size() != 1) continue;
+
+			vBufferDI.push_back(diBuffer);
+			vBufferedDI.push_back(vDI[0]);
+
+			number val;
+			(*react.spTotBuffer)(val, aaPos[vrt], time, si);
+			vTotBuffer.push_back(val);
+			(*react.spKBind)(val, aaPos[vrt], time, si);
+			vKBind.push_back(val);
+			(*react.spKUnbind)(val, aaPos[vrt], time, si);
+			vKUnbind.push_back(val);
+		}
+		vReactStart.push_back(vBufferDI.size());
+	}
+
+	// integrate reactions one after another (they might share the buffered substance);
+	// the points of one reaction are independent of each other
+	TGridFunction& sol = *u;
+	for (size_t r = 0; r < nReact; ++r)
+	{
+		const long begin = (long) vReactStart[r];
+		const long end = (long) vReactStart[r+1];
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(static)
+#endif
+		for (long k = begin; k < end; ++k)
+			integrate_binding(DoFRef(sol, vBufferedDI[k]), DoFRef(sol, vBufferDI[k]),
+				vTotBuffer[k], vKBind[k], vKUnbind[k], dt);
+	}
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
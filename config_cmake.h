@@ -44,5 +44,12 @@
 #cmakedefine NC_WITH_CABLENEURON
 #cmakedefine NC_WITH_NEURON
 #cmakedefine NC_WITH_PARMETIS
+#cmakedefine NC_WITH_INSTRUMENTATION
+#cmakedefine NC_WITH_GRID_GENERATION
+#cmakedefine NC_WITH_NEURITE_GENERATION
+#cmakedefine NC_WITH_NEURITE_GENERATION_MODULE
+#cmakedefine NC_WITH_LAZY_REGISTRATION
+#cmakedefine NC_WITH_FLOAT_GATING_STORAGE
+#cmakedefine NC_WITH_DEVICE_OFFLOAD
 
 #endif // UG__PLUGINS__NEURO_COLLECTION__CONFIG_H
@@ -39,6 +39,7 @@
 
 #include "bouton_generator.h"
 #include "lib_grid/refinement/regular_refinement.h"
+#include "../util/kd_tree.h"
 
 
 namespace ug{
@@ -333,6 +334,40 @@ void GetNEvenlyDistributedSphereCoords(vector<vector3>& coords, int N, double ra
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////
+//	GetFibonacciSphereCoords
+////////////////////////////////////////////////////////////////////////////////////////////
+void GetFibonacciSphereCoords(vector<vector3>& coords, int N, double radius)
+{
+	// golden angle
+	const double dPhi = PI * (3.0 - sqrt(5.0));
+
+	coords.reserve(coords.size() + N);
+	for(int i = 0; i < N; i++)
+	{
+		// equal-area bands: z uniform in (-1, 1)
+		const double z = 1.0 - (2.0*i + 1.0) / N;
+		const double r = sqrt(1.0 - z*z);
+		const double phi = i * dPhi;
+
+		coords.push_back(vector3(radius * r * cos(phi), radius * r * sin(phi), radius * z));
+	}
+}
+
+
+/// T-bar construction with temporary subset handler and attachments of the caller
+static void BuildTbar(	Grid& grid, SubsetHandler& sh_orig, SubsetHandler& sh, Vertex* vrt,
+						Grid::VertexAttachmentAccessor<APosition>& aaPos,
+						Grid::VertexAttachmentAccessor<ANormal>& aaNorm,
+						AInt& aInt,
+						Grid::FaceAttachmentAccessor<ABool>& aaBoolMarked,
+						int si,
+						number TbarHeight,
+						number TbarLegRadius,
+						number TbarTopRadius,
+						number TbarTopHeight);
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 //	BuildBouton
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -343,17 +378,40 @@ void BuildBouton(	bool bExtSpace, number radius, int numRefinements, int numRele
 					number TbarTopHeight,
 					string fileName)
 {
-//	Initial grid management setup
 	Grid grid;
+	SubsetHandler sh(grid);
+	BuildBouton(bExtSpace, radius, numRefinements, numReleaseSites,
+				TbarHeight, TbarLegRadius, TbarTopRadius, TbarTopHeight, grid, sh);
+
+//	Write file
+	stringstream ss;
+	//ss << fileName << "dnmj_bouton" << "_" << numReleaseSites << "AZ" << ".ugx";
+	ss << fileName;
+	string outfile = ss.str();
+
+	SaveGridToFile(grid, sh, outfile.c_str());
+}
+
+
+void BuildBouton(	bool bExtSpace, number radius, int numRefinements, int numReleaseSites,
+					number TbarHeight,
+					number TbarLegRadius,
+					number TbarTopRadius,
+					number TbarTopHeight,
+					Grid& grid,
+					SubsetHandler& sh)
+{
+//	Initial grid management setup
 	AInt aInt;
 	grid.attach_to_vertices(aInt);
-	grid.attach_to_vertices(aPosition);
-	grid.attach_to_vertices(aNormal);
+	if (!grid.has_vertex_attachment(aPosition))
+		grid.attach_to_vertices(aPosition);
+	const bool bHadNormals = grid.has_vertex_attachment(aNormal);
+	if (!bHadNormals)
+		grid.attach_to_vertices(aNormal);
 	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
 	Grid::VertexAttachmentAccessor<ANormal> aaNorm(grid, aNormal);
 
-	SubsetHandler sh(grid);
-
 	Selector sel(grid);
 	Selector tmpSel(grid);
 
@@ -455,21 +513,43 @@ void BuildBouton(	bool bExtSpace, number radius, int numRefinements, int numRele
 
 	if(grid.num<RegularVertex>() > 0)
 	{
+		// k-d tree instead of a linear search over all vertices for each release site
+		vector<Vertex*> vSphereVrts;
+		vector<vector3> vSphereVrtPos;
+		for(VertexIterator vIter = grid.vertices_begin(); vIter != grid.vertices_end(); ++vIter)
+		{
+			vSphereVrts.push_back(*vIter);
+			vSphereVrtPos.push_back(aaPos[*vIter]);
+		}
+		KDTree<3> kdTree(vSphereVrtPos);
+
 		for(size_t i = 0; i < coords.size(); ++i)
 		{
 			bool gotOne = false;
 			Vertex* tmpVrt = NULL;
 
-			for(VertexIterator vIter = grid.vertices_begin(); vIter != grid.vertices_end(); ++vIter)
+			number distSq;
+			Vertex* nearestVrt = vSphereVrts[kdTree.nearest(coords[i], distSq)];
+			if(sel.is_selected(nearestVrt))
 			{
-				Vertex* vrt = *vIter;
-				tmpMinDist = VecDistance(aaPos[vrt], coords[i]);
+				tmpVrt = nearestVrt;
+				gotOne = true;
+			}
 
-				if(((!gotOne) || (tmpMinDist < minDist)) && sel.is_selected(vrt))
+			// nearest vertex already taken by another release site: search the remaining ones
+			if(!gotOne)
+			{
+				for(VertexIterator vIter = grid.vertices_begin(); vIter != grid.vertices_end(); ++vIter)
 				{
-					minDist = tmpMinDist;
-					tmpVrt = vrt;
-					gotOne = true;
+					Vertex* vrt = *vIter;
+					tmpMinDist = VecDistance(aaPos[vrt], coords[i]);
+
+					if(((!gotOne) || (tmpMinDist < minDist)) && sel.is_selected(vrt))
+					{
+						minDist = tmpMinDist;
+						tmpVrt = vrt;
+						gotOne = true;
+					}
 				}
 			}
 
@@ -650,10 +730,22 @@ void BuildBouton(	bool bExtSpace, number radius, int numRefinements, int numRele
 ////
 //	Create T-bars_bnd
 ////
-	for(size_t i = 0; i < vrts.size(); ++i)
+	// temporary subset handler and attachment shared by all T-bars
+	// (setting them up costs time proportional to the whole grid)
 	{
-		Vertex* vrt = vrts[i];
-		BuildTbar(grid, sh, vrt, aaPos, aaNorm, si_Tbars_bnd, TbarHeight*0.25, TbarLegRadius, TbarTopRadius, TbarTopHeight);
+		SubsetHandler shTbar(grid);
+		ABool aBoolMarked;
+		grid.attach_to_faces(aBoolMarked);
+		Grid::FaceAttachmentAccessor<ABool> aaBoolMarked(grid, aBoolMarked);
+
+		for(size_t i = 0; i < vrts.size(); ++i)
+		{
+			Vertex* vrt = vrts[i];
+			BuildTbar(grid, sh, shTbar, vrt, aaPos, aaNorm, aInt, aaBoolMarked, si_Tbars_bnd,
+					  TbarHeight*0.25, TbarLegRadius, TbarTopRadius, TbarTopHeight);
+		}
+
+		grid.detach_from_faces(aBoolMarked);
 	}
 
 //	Reassign CChCl boundary edges to CChCl subset
@@ -1027,13 +1119,10 @@ void BuildBouton(	bool bExtSpace, number radius, int numRefinements, int numRele
 //	Grid::edge_traits::secure_container edges;
 //	grid.associated_elements(edges, vrt);
 
-//	Write file
-	stringstream ss;
-	//ss << fileName << "dnmj_bouton" << "_" << numReleaseSites << "AZ" << ".ugx";
-	ss << fileName;
-	string outfile = ss.str();
-
-	SaveGridToFile(grid, sh, outfile.c_str());
+//	Remove helper attachments
+	grid.detach_from_vertices(aInt);
+	if (!bHadNormals)
+		grid.detach_from_vertices(aNormal);
 }
 
 
@@ -1052,8 +1141,29 @@ void BuildTbar(	Grid& grid, SubsetHandler& sh_orig, Vertex* vrt,
 	SubsetHandler sh(grid);
 	AInt aInt;
 	grid.attach_to_vertices(aInt);
+	ABool aBoolMarked;
+	grid.attach_to_faces(aBoolMarked);
+	Grid::FaceAttachmentAccessor<ABool> aaBoolMarked(grid, aBoolMarked);
+
+	BuildTbar(grid, sh_orig, sh, vrt, aaPos, aaNorm, aInt, aaBoolMarked, si,
+			  TbarHeight, TbarLegRadius, TbarTopRadius, TbarTopHeight);
+
+	grid.detach_from_faces(aBoolMarked);
+	grid.detach_from_vertices(aInt);
+}
 
 
+static void BuildTbar(	Grid& grid, SubsetHandler& sh_orig, SubsetHandler& sh, Vertex* vrt,
+						Grid::VertexAttachmentAccessor<APosition>& aaPos,
+						Grid::VertexAttachmentAccessor<ANormal>& aaNorm,
+						AInt& aInt,
+						Grid::FaceAttachmentAccessor<ABool>& aaBoolMarked,
+						int si,
+						number TbarHeight,
+						number TbarLegRadius,
+						number TbarTopRadius,
+						number TbarTopHeight)
+{
 //	Temporal subset index specs
 	const int si_Tbars_bnd 		= 0;
 	const int si_Tbars_post 	= 1;
@@ -1062,24 +1172,11 @@ void BuildTbar(	Grid& grid, SubsetHandler& sh_orig, Vertex* vrt,
 	const int si_Tbars_tabletop	= 4;
 
 
-//	Instantiate temporal subset handler sh
-	for(VertexIterator vIter = sh_orig.begin<Vertex>(si); vIter != sh_orig.end<Vertex>(si); ++vIter)
-	{
-		Vertex* v = *vIter;
-		sh.assign_subset(v, 0);
-	}
-
-	for(EdgeIterator eIter = sh_orig.begin<Edge>(si); eIter != sh_orig.end<Edge>(si); ++eIter)
-	{
-		Edge* e = *eIter;
-		sh.assign_subset(e, 0);
-	}
-
-	for(FaceIterator fIter = sh_orig.begin<Face>(si); fIter != sh_orig.end<Face>(si); ++fIter)
-	{
-		Face* f = *fIter;
-		sh.assign_subset(f, 0);
-	}
+//	Reset temporal subset handler sh
+//	(elements already in subset si of sh_orig need not be copied to it,
+//	as only the new t-bar elements are transferred back at the end)
+	sh.clear();
+	sh.set_default_subset_index(-1);
 
 
 //	setup extrusion tools
@@ -1259,10 +1356,6 @@ void BuildTbar(	Grid& grid, SubsetHandler& sh_orig, Vertex* vrt,
 	sel.enable_autoselection(true);
 	tmpSel.clear();
 
-	ABool aBoolMarked = false;
-	grid.attach_to_faces(aBoolMarked);
-	Grid::FaceAttachmentAccessor<ABool> aaBoolMarked(grid, aBoolMarked);
-
 	int counter = 1;
 
 	sh.set_default_subset_index(si_Tbars_sides);
@@ -1272,6 +1365,7 @@ void BuildTbar(	Grid& grid, SubsetHandler& sh_orig, Vertex* vrt,
 	{
 		Face* f = *fIter;
 		sel.select(f);
+		aaBoolMarked[f] = false;
 	}
 
 	for(FaceIterator fIter = sel.begin<Face>(); fIter != sel.end<Face>(); ++fIter)
@@ -72,6 +72,14 @@ namespace neuro_collection{
 **/
 void GetNEvenlyDistributedSphereCoords(vector<vector3>& coords, int N, double radius);
 
+/// Function for spherical point distribution on a Fibonacci lattice
+/** This function distributes N points (any N > 0) quasi-uniformly on a sphere
+ * 	of a given radius in closed form: point i lies in the i-th of N bands of
+ * 	equal area, rotated by the golden angle against its predecessor.
+ * 	The points are appended to coords.
+**/
+void GetFibonacciSphereCoords(vector<vector3>& coords, int N, double radius);
+
 
 /// Function for creating a bouton
 /** This function creates a presynaptic bouton of the drosophila
@@ -94,6 +102,18 @@ void BuildBouton(	bool bExtSpace, number radius, int numRefinements, int numRele
 					number TbarTopHeight,
 					string fileName);
 
+/// Function for creating a bouton in memory
+/** Same as above, but the bouton is created in the given (empty) grid and
+ * 	subset handler instead of being written to a file.
+**/
+void BuildBouton(	bool bExtSpace, number radius, int numRefinements, int numReleaseSites,
+					number TbarHeight,
+					number TbarLegRadius,
+					number TbarTopRadius,
+					number TbarTopHeight,
+					Grid& grid,
+					SubsetHandler& sh);
+
 
 /// Function for creating a synaptic T-bar
 /** This function creates a synaptic T-bar inside a presynaptic bouton
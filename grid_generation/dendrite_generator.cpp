@@ -55,6 +55,13 @@
 #include "lib_grid/grid/grid_base_objects.h"                     // for Face, Edge, EdgeDescriptor
 #include "lib_grid/grid_objects/grid_objects_0d.h"               // for RegularVertex
 #include "lib_grid/tools/subset_handler_grid.h"                  // for SubsetHandler
+#include "../util/mesh_cache.h"                                 // for MeshCacheKey, mesh_cache_restore ...
+
+#ifdef UG_PARALLEL
+	#include "lib_grid/parallelization/distributed_grid.h"         // for DistributedGridManager
+	#include "pcl/pcl_base.h"                                    // for NumProcs, ProcRank
+	#include "pcl/pcl_process_communicator.h"                    // for ProcessCommunicator
+#endif
 
 
 namespace ug {
@@ -129,17 +136,46 @@ void DendriteGenerator::set_bobbel_er(size_t erSegLength, size_t holeSegLength)
 }
 
 
-void DendriteGenerator::create_dendrite_middle_influx(const std::string& filename)
+std::string DendriteGenerator::output_file_name(const std::string& filename) const
 {
-	typedef Grid::VertexAttachmentAccessor<APosition> AAPosition;
+	// check that filename ends in ".ugx"
+	std::string useFileName = filename;
+	if (GetFilenameExtension(filename) != std::string("ugx"))
+	{
+		UG_LOGN("File name extension needs to be '.ugx' - appending extension.")
+		useFileName.append(".ugx");
+	}
+	std::string filePath = FindDirInStandardPaths(PathFromFilename(useFileName).c_str());
+	if (filePath.empty())
+		UG_THROW("Directory '" << PathFromFilename(useFileName) << "' could not be located. "
+				"The file cannot be written there.");
+
+	return filePath + FilenameWithoutPath(useFileName);
+}
+
 
+void DendriteGenerator::add_params_to_cache_key(MeshCacheKey& key) const
+{
+	key.add(m_dendrite_length);
+	key.add(m_dendrite_radius);
+	key.add(m_er_radius);
+	key.add(m_synapse_width);
+	key.add(m_numSegments);
+	key.add(m_bBobbelER);
+	key.add(m_numERBlockSegments);
+	key.add(m_numHoleBlockSegments);
+}
+
+
+void DendriteGenerator::adjust_num_segments(bool periodicER)
+{
 	// if #segments has not been explicitly chosen, calculate a sensible number
 	if (!m_bNumSegSet)
 		m_numSegments = (size_t) floor(m_dendrite_length / m_dendrite_radius);
 
 	// number of segments must be multiple of 2
 	// or even of 2*periodLength in case of bobbel ER
-	if (m_bBobbelER)
+	if (periodicER)
 	{
 		size_t periodLength = m_numERBlockSegments + m_numHoleBlockSegments;
 		m_numSegments = 2*periodLength * m_numSegments / (2 * periodLength);
@@ -151,12 +187,98 @@ void DendriteGenerator::create_dendrite_middle_influx(const std::string& filenam
 		m_numSegments = 2 * m_numSegments / 2;
 		m_numSegments = std::max(m_numSegments, (size_t) 2);
 	}
+}
+
+
+void DendriteGenerator::adjust_num_segments_discreteRyR(number channelDistance)
+{
+	const size_t nSegMin = std::ceil(m_dendrite_length / channelDistance);
+	if (m_numSegments < nSegMin)
+		m_numSegments = nSegMin;
+
+	const size_t ryrElemDist = round(m_numSegments / nSegMin);
+	m_numSegments = ryrElemDist * nSegMin;
+}
+
+
+/// writes a generated grid to a .ugx file
+static void write_ugx(Grid& g, ISubsetHandler& sh, const std::string& outFileName)
+{
+	GridWriterUGX ugxWriter;
+	ugxWriter.add_grid(g, "defGrid", aPosition);
+	ugxWriter.add_subset_handler(sh, "defSH", 0);
+	if (!ugxWriter.write_to_file(outFileName.c_str()))
+		UG_THROW("Grid could not be written to file '" << outFileName << "'.");
+}
+
+
+/**
+ * Geometries are generated with 3d positions (z = 0 for the 2d ones). If they
+ * were generated into the grid of a lower-dimensional domain, the positions are
+ * moved to the domain's position attachment.
+ */
+static void move_to_domain_positions(Grid& g)
+{
+	typedef Grid::VertexAttachmentAccessor<APosition> AAPosition;
+	AAPosition aaPos(g, aPosition);
+
+	if (g.has_vertex_attachment(aPosition2))
+	{
+		Grid::VertexAttachmentAccessor<APosition2> aaPos2(g, aPosition2);
+		for (VertexIterator it = g.begin<Vertex>(); it != g.end<Vertex>(); ++it)
+			aaPos2[*it] = vector2(aaPos[*it][0], aaPos[*it][1]);
+	}
+	else if (g.has_vertex_attachment(aPosition1))
+	{
+		Grid::VertexAttachmentAccessor<APosition1> aaPos1(g, aPosition1);
+		for (VertexIterator it = g.begin<Vertex>(); it != g.end<Vertex>(); ++it)
+			aaPos1[*it] = vector1(aaPos[*it][0]);
+	}
+	else
+		return;
+
+	g.detach_from_vertices(aPosition);
+}
+
+
+void DendriteGenerator::create_dendrite_middle_influx(const std::string& filename)
+{
+	adjust_num_segments(m_bBobbelER);
+
+	// take result from mesh cache if available
+	const std::string outFileName = output_file_name(filename);
+	std::vector<std::string> vOutFileNames(1, outFileName);
+	MeshCacheKey cacheKey("DendriteGenerator::create_dendrite_middle_influx", "1");
+	add_params_to_cache_key(cacheKey);
+	if (mesh_cache_restore(cacheKey, vOutFileNames))
+		return;
 
 	// create grid etc.
 	Grid g;
 	SubsetHandler sh(g);
+	build_dendrite_middle_influx(g, sh);
+
+	write_ugx(g, sh, outFileName);
+	mesh_cache_store(cacheKey, vOutFileNames);
+}
+
+
+void DendriteGenerator::create_dendrite_middle_influx(Grid& g, ISubsetHandler& sh)
+{
+	adjust_num_segments(m_bBobbelER);
+	build_dendrite_middle_influx(g, sh);
+}
+
+
+
+void DendriteGenerator::build_dendrite_middle_influx(Grid& g, ISubsetHandler& sh)
+{
+	typedef Grid::VertexAttachmentAccessor<APosition> AAPosition;
+
 	sh.set_default_subset_index(0);
-	g.attach_to_vertices(aPosition);
+	const bool bHadPos = g.has_vertex_attachment(aPosition);
+	if (!bHadPos)
+		g.attach_to_vertices(aPosition);
 	AAPosition aaPos = AAPosition(g, aPosition);
 
 	// create start vertices and edges at left end
@@ -457,192 +579,268 @@ void DendriteGenerator::create_dendrite_middle_influx(const std::string& filenam
 	EraseEmptySubsets(sh);
 	AssignSubsetColors(sh);
 
-	// save to .ugx file
-	// check that filename ends in ".ugx"
-	std::string useFileName = filename;
-	if (GetFilenameExtension(filename) != std::string("ugx"))
-	{
-		UG_LOGN("File name extension needs to be '.ugx' - appending extension.")
-		useFileName.append(".ugx");
-	}
-	std::string filePath = FindDirInStandardPaths(PathFromFilename(useFileName).c_str());
-	if (filePath.empty())
-		UG_THROW("Directory '" << PathFromFilename(useFileName) << "' could not be located. "
-				"The file cannot be written there.");
-
-	std::string fileName = FilenameWithoutPath(useFileName);
-	GridWriterUGX ugxWriter;
-	ugxWriter.add_grid(g, "defGrid", aPosition);
-	ugxWriter.add_subset_handler(sh, "defSH", 0);
-	if (!ugxWriter.write_to_file((filePath+fileName).c_str()))
-		UG_THROW("Grid could not be written to file '" << filePath << fileName << "'.");
+	if (!bHadPos)
+		move_to_domain_positions(g);
 }
 
 
 
 void DendriteGenerator::create_dendrite(const std::string& filename)
 {
-	typedef Grid::VertexAttachmentAccessor<APosition> AAPosition;
+	adjust_num_segments(m_bBobbelER);
 
-	// if #segments has not been explicitly chosen, calculate a sensible number
-	if (!m_bNumSegSet)
-		m_numSegments = (size_t) floor(m_dendrite_length / m_dendrite_radius);
-
-	// number of segments must be multiple of 2
-	// or even of 2*periodLength in case of bobbel ER
-	if (m_bBobbelER)
-	{
-		size_t periodLength = m_numERBlockSegments + m_numHoleBlockSegments;
-		m_numSegments = 2*periodLength * m_numSegments / (2 * periodLength);
-
-		m_numSegments = std::max(m_numSegments, 2*periodLength);
-	}
-	else
-	{
-		m_numSegments = 2 * m_numSegments / 2;
-		m_numSegments = std::max(m_numSegments, (size_t) 2);
-	}
+	// take result from mesh cache if available
+	const std::string outFileName = output_file_name(filename);
+	std::vector<std::string> vOutFileNames(1, outFileName);
+	MeshCacheKey cacheKey("DendriteGenerator::create_dendrite", "2");
+	add_params_to_cache_key(cacheKey);
+	if (mesh_cache_restore(cacheKey, vOutFileNames))
+		return;
 
 	// create grid etc.
 	Grid g;
 	SubsetHandler sh(g);
-	sh.set_default_subset_index(0);
-	g.attach_to_vertices(aPosition);
-	AAPosition aaPos = AAPosition(g, aPosition);
+	build_dendrite(g, sh);
 
-	// create start vertices and edges at left end
-	Vertex* vTmpBndIn = *g.create<RegularVertex>();
-	aaPos[vTmpBndIn] = vector3(-0.5*m_dendrite_length, 0, 0);
-	int siTmpBndIn = ER_SI;
+	write_ugx(g, sh, outFileName);
+	mesh_cache_store(cacheKey, vOutFileNames);
+}
 
-	Vertex* vTmpERM = *g.create<RegularVertex>();
-	aaPos[vTmpERM] = vector3(-0.5*m_dendrite_length, m_er_radius, 0);
-	int siTmpERM = ERM_SI;
 
-	Vertex* vTmpPM = *g.create<RegularVertex>();
-	aaPos[vTmpPM] = vector3(-0.5*m_dendrite_length, m_dendrite_radius, 0);
-	int siTmpPM = PM_SI;
+void DendriteGenerator::create_dendrite(Grid& g, ISubsetHandler& sh)
+{
+	adjust_num_segments(m_bBobbelER);
+	build_dendrite(g, sh);
+}
 
-	Edge* eTmpER = *g.create<RegularEdge>(EdgeDescriptor(vTmpBndIn, vTmpERM));
-	int siTmpER = ER_SI;
 
-	Edge* eTmpCyt = *g.create<RegularEdge>(EdgeDescriptor(vTmpERM, vTmpPM));
-	int siTmpCyt = SYN_SI;
 
-// extrude left half
-	std::vector<Vertex*> vrts(3);
-	vrts[0] = vTmpBndIn;
-	vrts[1] = vTmpERM;
-	vrts[2] = vTmpPM;
-	std::vector<Edge*> edges(2);
-	edges[0] = eTmpER;
-	edges[1] = eTmpCyt;
+void DendriteGenerator::create_dendrite_distributed(Grid& g, ISubsetHandler& sh)
+{
+#ifdef UG_PARALLEL
+	const size_t numProcs = pcl::NumProcs();
+	if (numProcs > 1)
+	{
+		DistributedGridManager* dgm = g.distributed_grid_manager();
+		UG_COND_THROW(!dgm, "Rank-local dendrite generation needs a distributed multigrid.");
+
+		adjust_num_segments(m_bBobbelER);
+		const size_t numSeg = num_dendrite_segments();
+		UG_COND_THROW(numSeg < numProcs, "Dendrite with " << numSeg << " segments "
+			"cannot be distributed to " << numProcs << " processes.");
+
+		sh.set_default_subset_index(0);
+		const bool bHadPos = g.has_vertex_attachment(aPosition);
+		if (!bHadPos)
+			g.attach_to_vertices(aPosition);
+
+		// own range of segments
+		const size_t rank = pcl::ProcRank();
+		std::vector<Vertex*> vrtsBegin, vrtsEnd;
+		std::vector<Edge*> edgesBegin, edgesEnd;
+		build_dendrite_segments(g, sh, rank * numSeg / numProcs, (rank+1) * numSeg / numProcs,
+			vrtsBegin, edgesBegin, vrtsEnd, edgesEnd);
+
+		// cross-sections shared with the neighbors
+		GridLayoutMap& glm = dgm->grid_layout_map();
+		if (rank > 0)
+		{
+			for (size_t i = 0; i < vrtsBegin.size(); ++i)
+				glm.get_layout<Vertex>(INT_H_SLAVE).interface(rank-1, 0).push_back(vrtsBegin[i]);
+			for (size_t i = 0; i < edgesBegin.size(); ++i)
+				glm.get_layout<Edge>(INT_H_SLAVE).interface(rank-1, 0).push_back(edgesBegin[i]);
+		}
+		if (rank + 1 < numProcs)
+		{
+			for (size_t i = 0; i < vrtsEnd.size(); ++i)
+				glm.get_layout<Vertex>(INT_H_MASTER).interface(rank+1, 0).push_back(vrtsEnd[i]);
+			for (size_t i = 0; i < edgesEnd.size(); ++i)
+				glm.get_layout<Edge>(INT_H_MASTER).interface(rank+1, 0).push_back(edgesEnd[i]);
+		}
+		dgm->grid_layouts_changed(false);
+
+		// subset names (as in build_dendrite); only erase subsets empty on all processes
+		sh.set_subset_name("cyt", CYT_SI);
+		sh.set_subset_name("er", ER_SI);
+		sh.set_subset_name("pm", PM_SI);
+		sh.set_subset_name("erm", ERM_SI);
+		sh.set_subset_name("act", SYN_SI);
+		sh.set_subset_name("meas", BND_CYT_SI);
+
+		const int numSubsets = sh.num_subsets();
+		std::vector<int> vLocal(numSubsets, 0), vGlobal;
+		for (int si = 0; si < numSubsets; ++si)
+			vLocal[si] = sh.contains_vertices(si) || sh.contains_edges(si) || sh.contains_faces(si);
+		pcl::ProcessCommunicator com;
+		com.allreduce(vLocal, vGlobal, PCL_RO_MAX);
+		for (int si = numSubsets - 1; si >= 0; --si)
+			if (!vGlobal[si])
+				sh.erase_subset(si);
+		AssignSubsetColors(sh);
+
+		if (!bHadPos)
+			move_to_domain_positions(g);
+		return;
+	}
+#endif
+
+	create_dendrite(g, sh);
+}
+
 
-	vector3 extrudeDir(0.0);
-	extrudeDir.coord(0) = m_dendrite_length / m_numSegments;
 
+size_t DendriteGenerator::num_dendrite_segments() const
+{
+	if (!m_bBobbelER)
+		return m_numSegments;
+
+	const size_t numPeriods = m_numSegments / (m_numERBlockSegments + m_numHoleBlockSegments);
+	return numPeriods * 2 * m_numERBlockSegments;
+}
+
+
+bool DendriteGenerator::dendrite_segment_has_er(size_t seg) const
+{
 	if (!m_bBobbelER)
+		return true;
+
+	return seg % (2 * m_numERBlockSegments) < m_numERBlockSegments;
+}
+
+
+void DendriteGenerator::dendrite_boundary_subsets(size_t bnd, int vrtSI[3], int edgeSI[2]) const
+{
+	// left end (with activation)
+	if (bnd == 0)
 	{
-		// prepare subsets for extrusion of ER blocks
-		sh.assign_subset(vrts[0], ER_SI);
-		sh.assign_subset(vrts[1], ERM_SI);
-		sh.assign_subset(vrts[2], PM_SI);
-		sh.assign_subset(edges[0], ER_SI);
-		sh.assign_subset(edges[1], CYT_SI);
+		vrtSI[0] = ER_SI; vrtSI[1] = ERM_SI; vrtSI[2] = PM_SI;
+		edgeSI[0] = ER_SI; edgeSI[1] = SYN_SI;
+		return;
+	}
 
-		// extrude
-		for (size_t i = 0; i < m_numSegments; ++i)
-			Extrude(g, &vrts, &edges, NULL, extrudeDir, aaPos, EO_CREATE_FACES, NULL);
+	// right end (with measurement)
+	if (bnd == num_dendrite_segments())
+	{
+		const int endSI = m_bBobbelER ? CYT_SI : ER_SI;
+		vrtSI[0] = endSI; vrtSI[1] = m_bBobbelER ? CYT_SI : ERM_SI; vrtSI[2] = PM_SI;
+		edgeSI[0] = endSI; edgeSI[1] = BND_CYT_SI;
+		return;
+	}
 
-		// repair original subsets
-		sh.assign_subset(vTmpBndIn, siTmpBndIn);
-		sh.assign_subset(vTmpERM, siTmpERM);
-		sh.assign_subset(vTmpPM, siTmpPM);
-		sh.assign_subset(eTmpER, siTmpER);
-		sh.assign_subset(eTmpCyt, siTmpCyt);
+	// between blocks of ER and holes
+	if (m_bBobbelER && bnd % m_numERBlockSegments == 0)
+	{
+		vrtSI[0] = ERM_SI; vrtSI[1] = ERM_SI; vrtSI[2] = PM_SI;
+		edgeSI[0] = ERM_SI; edgeSI[1] = CYT_SI;
+		return;
+	}
 
-		// correct subsets at end
-		sh.assign_subset(vrts[0], ER_SI);
-		sh.assign_subset(vrts[1], ERM_SI);
-		sh.assign_subset(vrts[2], PM_SI);
-		sh.assign_subset(edges[0], ER_SI);
-		sh.assign_subset(edges[1], BND_CYT_SI);
+	// inside a block
+	if (dendrite_segment_has_er(bnd))
+	{
+		vrtSI[0] = ER_SI; vrtSI[1] = ERM_SI; vrtSI[2] = PM_SI;
+		edgeSI[0] = ER_SI; edgeSI[1] = CYT_SI;
 	}
 	else
 	{
-		size_t numPeriods =  m_numSegments / (m_numERBlockSegments + m_numHoleBlockSegments);
-		for (size_t i = 0; i < numPeriods; ++i)
-		{
-			// prepare subsets for extrusion of ER blocks
-			sh.assign_subset(vrts[0], ER_SI);
-			sh.assign_subset(vrts[1], ERM_SI);
-			sh.assign_subset(vrts[2], PM_SI);
-			sh.assign_subset(edges[0], ER_SI);
-			sh.assign_subset(edges[1], CYT_SI);
+		vrtSI[0] = CYT_SI; vrtSI[1] = CYT_SI; vrtSI[2] = PM_SI;
+		edgeSI[0] = CYT_SI; edgeSI[1] = CYT_SI;
+	}
+}
 
-			// extrude a block of ER
-			for (size_t j = 0; j < m_numERBlockSegments; ++j)
-				Extrude(g, &vrts, &edges, NULL, extrudeDir, aaPos, EO_CREATE_FACES, NULL);
 
-			// repair original subsets
-			sh.assign_subset(vTmpBndIn, siTmpBndIn);
-			sh.assign_subset(vTmpERM, siTmpERM);
-			sh.assign_subset(vTmpPM, siTmpPM);
-			sh.assign_subset(eTmpER, siTmpER);
-			sh.assign_subset(eTmpCyt, siTmpCyt);
+void DendriteGenerator::build_dendrite_segments
+(
+	Grid& g,
+	ISubsetHandler& sh,
+	size_t segBegin,
+	size_t segEnd,
+	std::vector<Vertex*>& vrtsBegin,
+	std::vector<Edge*>& edgesBegin,
+	std::vector<Vertex*>& vrtsEnd,
+	std::vector<Edge*>& edgesEnd
+)
+{
+	typedef Grid::VertexAttachmentAccessor<APosition> AAPosition;
+	AAPosition aaPos = AAPosition(g, aPosition);
 
-			// remember correct subsets for current end
-			vTmpBndIn = vrts[0];
-			vTmpERM = vrts[1];
-			vTmpPM = vrts[2];
-			eTmpER = edges[0];
-			eTmpCyt = edges[1];
-			siTmpBndIn = ERM_SI;
-			siTmpERM = ERM_SI;
-			siTmpPM = PM_SI;
-			siTmpER = ERM_SI;
-			siTmpCyt = CYT_SI;
+	const number segLength = m_dendrite_length / m_numSegments;
 
+	// create cross-section at the beginning of the range
+	const number radii[3] = {0.0, m_er_radius, m_dendrite_radius};
+	std::vector<Vertex*> vrts(3);
+	for (size_t i = 0; i < 3; ++i)
+	{
+		vrts[i] = *g.create<RegularVertex>();
+		aaPos[vrts[i]] = vector3(-0.5*m_dendrite_length + segBegin*segLength, radii[i], 0);
+	}
+	std::vector<Edge*> edges(2);
+	edges[0] = *g.create<RegularEdge>(EdgeDescriptor(vrts[0], vrts[1]));
+	edges[1] = *g.create<RegularEdge>(EdgeDescriptor(vrts[1], vrts[2]));
+	vrtsBegin = vrts;
+	edgesBegin = edges;
 
-			// prepare subsets for extrusion of hole blocks
-			sh.assign_subset(vrts[0], CYT_SI);
-			sh.assign_subset(vrts[1], CYT_SI);
-			sh.assign_subset(vrts[2], PM_SI);
-			sh.assign_subset(edges[0], CYT_SI);
-			sh.assign_subset(edges[1], CYT_SI);
+	vector3 extrudeDir(0.0);
+	extrudeDir.coord(0) = segLength;
 
-			// extrude a block of hole
-			for (size_t j = 0; j < m_numERBlockSegments; ++j)
-				Extrude(g, &vrts, &edges, NULL, extrudeDir, aaPos, EO_CREATE_FACES, NULL);
+	int vrtSI[3];
+	int edgeSI[2];
+	for (size_t seg = segBegin; seg < segEnd; ++seg)
+	{
+		// extruded elements inherit the subsets of the cross-section,
+		// so prepare it with the subsets of the segment interior
+		if (dendrite_segment_has_er(seg))
+		{
+			vrtSI[0] = ER_SI; vrtSI[1] = ERM_SI; vrtSI[2] = PM_SI;
+			edgeSI[0] = ER_SI; edgeSI[1] = CYT_SI;
+		}
+		else
+		{
+			vrtSI[0] = CYT_SI; vrtSI[1] = CYT_SI; vrtSI[2] = PM_SI;
+			edgeSI[0] = CYT_SI; edgeSI[1] = CYT_SI;
+		}
+		for (size_t i = 0; i < 3; ++i)
+			sh.assign_subset(vrts[i], vrtSI[i]);
+		for (size_t i = 0; i < 2; ++i)
+			sh.assign_subset(edges[i], edgeSI[i]);
 
-			// repair original subsets
-			sh.assign_subset(vTmpBndIn, siTmpBndIn);
-			sh.assign_subset(vTmpERM, siTmpERM);
-			sh.assign_subset(vTmpPM, siTmpPM);
-			sh.assign_subset(eTmpER, siTmpER);
-			sh.assign_subset(eTmpCyt, siTmpCyt);
+		std::vector<Vertex*> vrtsPrev = vrts;
+		std::vector<Edge*> edgesPrev = edges;
+		Extrude(g, &vrts, &edges, NULL, extrudeDir, aaPos, EO_CREATE_FACES, NULL);
 
-			// remember correct subsets for current end
-			vTmpBndIn = vrts[0];
-			vTmpERM = vrts[1];
-			vTmpPM = vrts[2];
-			eTmpER = edges[0];
-			eTmpCyt = edges[1];
-			siTmpBndIn = ERM_SI;
-			siTmpERM = ERM_SI;
-			siTmpPM = PM_SI;
-			siTmpER = ERM_SI;
-			siTmpCyt = CYT_SI;
-		}
+		// exact axial coordinate (neighboring ranges must match)
+		for (size_t i = 0; i < 3; ++i)
+			aaPos[vrts[i]][0] = -0.5*m_dendrite_length + (seg+1)*segLength;
 
-		// correct subsets at end
-		sh.assign_subset(vrts[0], CYT_SI);
-		sh.assign_subset(vrts[1], CYT_SI);
-		sh.assign_subset(vrts[2], PM_SI);
-		sh.assign_subset(edges[0], CYT_SI);
-		sh.assign_subset(edges[1], BND_CYT_SI);
+		// repair subsets of the previous cross-section
+		dendrite_boundary_subsets(seg, vrtSI, edgeSI);
+		for (size_t i = 0; i < 3; ++i)
+			sh.assign_subset(vrtsPrev[i], vrtSI[i]);
+		for (size_t i = 0; i < 2; ++i)
+			sh.assign_subset(edgesPrev[i], edgeSI[i]);
 	}
 
+	// subsets of the cross-section at the end of the range
+	dendrite_boundary_subsets(segEnd, vrtSI, edgeSI);
+	for (size_t i = 0; i < 3; ++i)
+		sh.assign_subset(vrts[i], vrtSI[i]);
+	for (size_t i = 0; i < 2; ++i)
+		sh.assign_subset(edges[i], edgeSI[i]);
+	vrtsEnd = vrts;
+	edgesEnd = edges;
+}
+
+
+void DendriteGenerator::build_dendrite(Grid& g, ISubsetHandler& sh)
+{
+	sh.set_default_subset_index(0);
+	const bool bHadPos = g.has_vertex_attachment(aPosition);
+	if (!bHadPos)
+		g.attach_to_vertices(aPosition);
+
+	std::vector<Vertex*> vrtsBegin, vrtsEnd;
+	std::vector<Edge*> edgesBegin, edgesEnd;
+	build_dendrite_segments(g, sh, 0, num_dendrite_segments(), vrtsBegin, edgesBegin, vrtsEnd, edgesEnd);
 
 	// subset names
 	sh.set_subset_name("cyt", CYT_SI);
@@ -654,46 +852,50 @@ void DendriteGenerator::create_dendrite(const std::string& filename)
 	EraseEmptySubsets(sh);
 	AssignSubsetColors(sh);
 
-	// save to .ugx file
-	// check that filename ends in ".ugx"
-	std::string useFileName = filename;
-	if (GetFilenameExtension(filename) != std::string("ugx"))
-	{
-		UG_LOGN("File name extension needs to be '.ugx' - appending extension.")
-		useFileName.append(".ugx");
-	}
-	std::string filePath = FindDirInStandardPaths(PathFromFilename(useFileName).c_str());
-	if (filePath.empty())
-		UG_THROW("Directory '" << PathFromFilename(useFileName) << "' could not be located. "
-				"The file cannot be written there.");
-
-	std::string fileName = FilenameWithoutPath(useFileName);
-	GridWriterUGX ugxWriter;
-	ugxWriter.add_grid(g, "defGrid", aPosition);
-	ugxWriter.add_subset_handler(sh, "defSH", 0);
-	if (!ugxWriter.write_to_file((filePath+fileName).c_str()))
-		UG_THROW("Grid could not be written to file '" << filePath << fileName << "'.");
+	if (!bHadPos)
+		move_to_domain_positions(g);
 }
 
 
 
 void DendriteGenerator::create_dendrite_1d(const std::string& filename)
 {
-	typedef Grid::VertexAttachmentAccessor<APosition> AAPosition;
+	adjust_num_segments(false);
 
-	// if #segments has not been explicitly chosen, calculate a sensible number
-	if (!m_bNumSegSet)
-		m_numSegments = (size_t) floor(m_dendrite_length / m_dendrite_radius);
-
-	// number of segments must be multiple of 2
-	m_numSegments = 2 * m_numSegments / 2;
-	m_numSegments = std::max(m_numSegments, (size_t) 2);
+	// take result from mesh cache if available
+	const std::string outFileName = output_file_name(filename);
+	std::vector<std::string> vOutFileNames(1, outFileName);
+	MeshCacheKey cacheKey("DendriteGenerator::create_dendrite_1d", "1");
+	add_params_to_cache_key(cacheKey);
+	if (mesh_cache_restore(cacheKey, vOutFileNames))
+		return;
 
 	// create grid etc.
 	Grid g;
 	SubsetHandler sh(g);
+	build_dendrite_1d(g, sh);
+
+	write_ugx(g, sh, outFileName);
+	mesh_cache_store(cacheKey, vOutFileNames);
+}
+
+
+void DendriteGenerator::create_dendrite_1d(Grid& g, ISubsetHandler& sh)
+{
+	adjust_num_segments(false);
+	build_dendrite_1d(g, sh);
+}
+
+
+
+void DendriteGenerator::build_dendrite_1d(Grid& g, ISubsetHandler& sh)
+{
+	typedef Grid::VertexAttachmentAccessor<APosition> AAPosition;
+
 	sh.set_default_subset_index(0);
-	g.attach_to_vertices(aPosition);
+	const bool bHadPos = g.has_vertex_attachment(aPosition);
+	if (!bHadPos)
+		g.attach_to_vertices(aPosition);
 	AAPosition aaPos = AAPosition(g, aPosition);
 
 	// create start vertiex at left end
@@ -720,45 +922,54 @@ void DendriteGenerator::create_dendrite_1d(const std::string& filename)
 	EraseEmptySubsets(sh);
 	AssignSubsetColors(sh);
 
-	// save to .ugx file
-	// check that filename ends in ".ugx"
-	std::string useFileName = filename;
-	if (GetFilenameExtension(filename) != std::string("ugx"))
-	{
-		UG_LOGN("File name extension needs to be '.ugx' - appending extension.")
-		useFileName.append(".ugx");
-	}
-	std::string filePath = FindDirInStandardPaths(PathFromFilename(useFileName).c_str());
-	if (filePath.empty())
-		UG_THROW("Directory '" << PathFromFilename(useFileName) << "' could not be located. "
-				"The file cannot be written there.");
-
-	std::string fileName = FilenameWithoutPath(useFileName);
-	GridWriterUGX ugxWriter;
-	ugxWriter.add_grid(g, "defGrid", aPosition);
-	ugxWriter.add_subset_handler(sh, "defSH", 0);
-	if (!ugxWriter.write_to_file((filePath+fileName).c_str()))
-		UG_THROW("Grid could not be written to file '" << filePath << fileName << "'.");
+	if (!bHadPos)
+		move_to_domain_positions(g);
 }
 
 
 void DendriteGenerator::create_dendrite_discreteRyR(const std::string& filename, number channelDistance)
 {
-	typedef Grid::VertexAttachmentAccessor<APosition> AAPosition;
+	adjust_num_segments_discreteRyR(channelDistance);
 
-	const size_t nSegMin = std::ceil(m_dendrite_length / channelDistance);
-	if (m_numSegments < nSegMin)
-		m_numSegments = nSegMin;
-
-	const size_t ryrElemDist = round(m_numSegments / nSegMin);
-	const number segLength = channelDistance / ryrElemDist;
-	m_numSegments = ryrElemDist * nSegMin;
+	// take result from mesh cache if available
+	const std::string outFileName = output_file_name(filename);
+	std::vector<std::string> vOutFileNames(1, outFileName);
+	MeshCacheKey cacheKey("DendriteGenerator::create_dendrite_discreteRyR", "1");
+	add_params_to_cache_key(cacheKey);
+	cacheKey.add(channelDistance);
+	if (mesh_cache_restore(cacheKey, vOutFileNames))
+		return;
 
 	// create grid etc.
 	Grid g;
 	SubsetHandler sh(g);
+	build_dendrite_discreteRyR(g, sh, channelDistance);
+
+	write_ugx(g, sh, outFileName);
+	mesh_cache_store(cacheKey, vOutFileNames);
+}
+
+
+void DendriteGenerator::create_dendrite_discreteRyR(Grid& g, ISubsetHandler& sh, number channelDistance)
+{
+	adjust_num_segments_discreteRyR(channelDistance);
+	build_dendrite_discreteRyR(g, sh, channelDistance);
+}
+
+
+
+void DendriteGenerator::build_dendrite_discreteRyR(Grid& g, ISubsetHandler& sh, number channelDistance)
+{
+	typedef Grid::VertexAttachmentAccessor<APosition> AAPosition;
+
+	const size_t nSegMin = std::ceil(m_dendrite_length / channelDistance);
+	const size_t ryrElemDist = m_numSegments / nSegMin;
+	const number segLength = channelDistance / ryrElemDist;
+
 	sh.set_default_subset_index(0);
-	g.attach_to_vertices(aPosition);
+	const bool bHadPos = g.has_vertex_attachment(aPosition);
+	if (!bHadPos)
+		g.attach_to_vertices(aPosition);
 	AAPosition aaPos = AAPosition(g, aPosition);
 
 	// create start vertices and edges at left end
@@ -823,26 +1034,8 @@ void DendriteGenerator::create_dendrite_discreteRyR(const std::string& filename,
 	EraseEmptySubsets(sh);
 	AssignSubsetColors(sh);
 
-
-	// save to .ugx file
-	// check that filename ends in ".ugx"
-	std::string useFileName = filename;
-	if (GetFilenameExtension(filename) != std::string("ugx"))
-	{
-		UG_LOGN("File name extension needs to be '.ugx' - appending extension.")
-		useFileName.append(".ugx");
-	}
-	std::string filePath = FindDirInStandardPaths(PathFromFilename(useFileName).c_str());
-	if (filePath.empty())
-		UG_THROW("Directory '" << PathFromFilename(useFileName) << "' could not be located. "
-				"The file cannot be written there.");
-
-	std::string fileName = FilenameWithoutPath(useFileName);
-	GridWriterUGX ugxWriter;
-	ugxWriter.add_grid(g, "defGrid", aPosition);
-	ugxWriter.add_subset_handler(sh, "defSH", 0);
-	if (!ugxWriter.write_to_file((filePath+fileName).c_str()))
-		UG_THROW("Grid could not be written to file '" << filePath << fileName << "'.");
+	if (!bHadPos)
+		move_to_domain_positions(g);
 }
 
 
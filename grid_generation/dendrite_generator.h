@@ -42,13 +42,22 @@
 
 #include <cstddef>                                               // for size_t
 #include <string>                                                // for string
+#include <vector>                                                // for vector
 
 #include "common/types.h"                                        // for number
 
 
 namespace ug {
+
+class Grid;
+class ISubsetHandler;
+class Vertex;
+class Edge;
+
 namespace neuro_collection {
 
+class MeshCacheKey;
+
 /**
  * @brief Creates cylindrical model dendrite geometries with ER
  *
@@ -104,6 +113,79 @@ class DendriteGenerator
 		/// creates a 2d rotationally symmetric dendrite with discrete RyR channel subsets
 		void create_dendrite_discreteRyR(const std::string& filename, number channelDistance);
 
+		/**
+		 * @brief in-memory variants of the above
+		 * The geometry is added to the given grid and subset handler instead of
+		 * being written to a file, e.g., to the grid and subset handler of a domain.
+		 * If the grid has no 3d position attachment, but a 2d or 1d one (as in a
+		 * 2d or 1d domain), the positions are stored there.
+		 * @{
+		 */
+		void create_dendrite_middle_influx(Grid& g, ISubsetHandler& sh);
+		void create_dendrite(Grid& g, ISubsetHandler& sh);
+		void create_dendrite_1d(Grid& g, ISubsetHandler& sh);
+		void create_dendrite_discreteRyR(Grid& g, ISubsetHandler& sh, number channelDistance);
+		/** @} */
+
+		/**
+		 * @brief rank-local variant of create_dendrite(Grid&, ISubsetHandler&)
+		 * Each process generates only its own contiguous range of segments into its
+		 * (distributed) multigrid, so that the dendrite never has to be held by one
+		 * process and no grid has to be loaded and distributed. The vertices and edges
+		 * of the cross-sections between neighboring ranges are put into horizontal
+		 * interfaces (master on the lower rank). Subsets are the same on all processes.
+		 * The result is the serial geometry cut into slices along the dendrite axis.
+		 * Must be called on all processes; without MPI, it is create_dendrite.
+		 */
+		void create_dendrite_distributed(Grid& g, ISubsetHandler& sh);
+
+	private:
+		/// choose a valid number of segments (periodic ER: multiple of the ER period)
+		void adjust_num_segments(bool periodicER);
+
+		/// choose a valid number of segments for discrete RyR channels
+		void adjust_num_segments_discreteRyR(number channelDistance);
+
+		/// actual geometry generation (for valid number of segments)
+		/// @{
+		void build_dendrite_middle_influx(Grid& g, ISubsetHandler& sh);
+		void build_dendrite(Grid& g, ISubsetHandler& sh);
+		void build_dendrite_1d(Grid& g, ISubsetHandler& sh);
+		void build_dendrite_discreteRyR(Grid& g, ISubsetHandler& sh, number channelDistance);
+		/// @}
+
+		/// number of segments extruded by build_dendrite()
+		size_t num_dendrite_segments() const;
+
+		/// whether a segment of build_dendrite() contains ER
+		bool dendrite_segment_has_er(size_t seg) const;
+
+		/// subsets of the cross-section (vertices, edges) at a segment boundary of build_dendrite()
+		void dendrite_boundary_subsets(size_t bnd, int vrtSI[3], int edgeSI[2]) const;
+
+		/**
+		 * @brief creates the segments [segBegin, segEnd) of build_dendrite()
+		 * The cross-sections at the beginning and end of the range are returned.
+		 * The grid must have a 3d position attachment.
+		 */
+		void build_dendrite_segments
+		(
+			Grid& g,
+			ISubsetHandler& sh,
+			size_t segBegin,
+			size_t segEnd,
+			std::vector<Vertex*>& vrtsBegin,
+			std::vector<Edge*>& edgesBegin,
+			std::vector<Vertex*>& vrtsEnd,
+			std::vector<Edge*>& edgesEnd
+		);
+
+		/// full output file name (with ".ugx" extension and located in standard paths)
+		std::string output_file_name(const std::string& filename) const;
+
+		/// add all geometry parameters to a mesh cache key
+		void add_params_to_cache_key(MeshCacheKey& key) const;
+
 	private:
 		number m_dendrite_length;
 		number m_dendrite_radius;
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__NEURITE_STORAGE_H
+#define UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__NEURITE_STORAGE_H
+
+#include <cstddef>                                               // for size_t
+#include <vector>                                                // for vector
+
+#include "common/assert.h"                                       // for UG_ASSERT
+#include "common/error.h"                                        // for UG_COND_THROW
+#include "common/math/ugmath_types.h"                            // for vector3
+#include "common/types.h"                                        // for number
+
+
+namespace ug {
+namespace neuro_collection {
+namespace neurites_from_swc {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/// read-only view of the entries of one neurite in a NeuriteArray
+template <typename T>
+class NeuriteRange
+{
+	public:
+		typedef const T* const_iterator;
+
+		NeuriteRange(const T* begin, const T* end)
+		: m_begin(begin), m_end(end) {}
+
+		size_t size() const {return (size_t) (m_end - m_begin);}
+		bool empty() const {return m_begin == m_end;}
+		const T& operator[](size_t i) const {UG_ASSERT(i < size(), "Index out of range."); return m_begin[i];}
+		const T& front() const {return *m_begin;}
+		const T& back() const {return *(m_end - 1);}
+		const_iterator begin() const {return m_begin;}
+		const_iterator end() const {return m_end;}
+
+	private:
+		const T* m_begin;
+		const T* m_end;
+};
+
+
+/**
+ * @brief Flat (CSR-like) storage of per-neurite sequences
+ *
+ * Replaces std::vector<std::vector<T> > for the intermediate neurite data
+ * of the 3d generation: All entries are stored contiguously, neurite n owns
+ * the entries [offset[n], offset[n+1]). Entries can only be appended to the
+ * last neurite (or to a new one behind it), which is how the neurites are
+ * assembled from SWC points anyway. Once reserved, the storage does not
+ * allocate again.
+ */
+template <typename T>
+class NeuriteArray
+{
+	public:
+		NeuriteArray() : m_vOffset(1, 0) {}
+
+		void clear() {m_vOffset.assign(1, 0); m_vEntry.clear();}
+
+		void reserve(size_t nNeurites, size_t nEntries)
+		{
+			m_vOffset.reserve(nNeurites + 1);
+			m_vEntry.reserve(nEntries);
+		}
+
+		/// number of neurites
+		size_t size() const {return m_vOffset.size() - 1;}
+
+		/// total number of entries of all neurites
+		size_t num_entries() const {return m_vEntry.size();}
+
+		/// appends empty neurites up to the given number of neurites (never shrinks)
+		void resize(size_t nNeurites)
+		{
+			if (nNeurites > size())
+				m_vOffset.resize(nNeurites + 1, m_vEntry.size());
+		}
+
+		/// appends an entry to neurite n (which must be the last or a new one)
+		void push_back(size_t n, const T& entry)
+		{
+			UG_ASSERT(n + 1 >= size(), "Entries can only be appended to the last neurite.");
+			resize(n + 1);
+			m_vEntry.push_back(entry);
+			m_vOffset.back() = m_vEntry.size();
+		}
+
+		NeuriteRange<T> operator[](size_t n) const
+		{
+			UG_ASSERT(n < size(), "Neurite index out of range.");
+			const T* base = m_vEntry.empty() ? NULL : &m_vEntry[0];
+			return NeuriteRange<T>(base + m_vOffset[n], base + m_vOffset[n+1]);
+		}
+
+		/// access to an entry by its global index (as returned by num_entries() before push_back)
+		T& entry(size_t globalInd) {return m_vEntry[globalInd];}
+		const T& entry(size_t globalInd) const {return m_vEntry[globalInd];}
+
+	private:
+		std::vector<size_t> m_vOffset;
+		std::vector<T> m_vEntry;
+};
+
+
+/// branching point of a neurite: position index and slots for the child neurites
+struct NeuriteBranchPoint
+{
+	size_t pos;          ///< index of the branching point in the neurite
+	size_t childBegin;   ///< index of the first child in NeuriteData::vBPChildren
+	size_t nChildren;    ///< number of child neurites registered so far
+};
+
+
+/**
+ * @brief Intermediate neurite data of the 3d generation
+ *
+ * Positions, radii and branching points of all neurites in a handful of
+ * contiguous buffers, which are reserved once per generation from the number
+ * of SWC points (instead of one small vector per neurite and branching point).
+ */
+struct NeuriteData
+{
+	NeuriteArray<vector3> pos;
+	NeuriteArray<number> rad;
+	NeuriteArray<NeuriteBranchPoint> bp;
+	std::vector<size_t> vBPChildren;
+
+	size_t num_neurites() const {return pos.size();}
+
+	void clear()
+	{
+		pos.clear();
+		rad.clear();
+		bp.clear();
+		vBPChildren.clear();
+	}
+
+	/**
+	 * @brief Reserves storage for the neurites of a point list
+	 * @param nPts       number of SWC points
+	 * @param nNeurites  (upper bound for the) number of neurites
+	 * @param nBPs       (upper bound for the) number of branching points
+	 */
+	void reserve(size_t nPts, size_t nNeurites, size_t nBPs)
+	{
+		// every non-root neurite additionally starts with its parent's branching point
+		pos.reserve(nNeurites, nPts + nNeurites);
+		rad.reserve(nNeurites, nPts + nNeurites);
+		bp.reserve(nNeurites, nBPs);
+		vBPChildren.reserve(nNeurites);
+	}
+
+	/// appends a new branching point to neurite n with room for nChildren children
+	size_t add_branch_point(size_t n, size_t posInd, size_t nChildren)
+	{
+		NeuriteBranchPoint newBP;
+		newBP.pos = posInd;
+		newBP.childBegin = vBPChildren.size();
+		newBP.nChildren = 0;
+		vBPChildren.resize(vBPChildren.size() + nChildren, (size_t) -1);
+
+		const size_t bpInd = bp.num_entries();
+		bp.push_back(n, newBP);
+		return bpInd;
+	}
+
+	/// registers a child neurite at the branching point with the given global index
+	void add_branch_child(size_t bpInd, size_t childNeurite)
+	{
+		NeuriteBranchPoint& brPt = bp.entry(bpInd);
+		const size_t nSlots = (bpInd + 1 < bp.num_entries() ? bp.entry(bpInd + 1).childBegin : vBPChildren.size())
+			- brPt.childBegin;
+		UG_COND_THROW(brPt.nChildren >= nSlots, "More child neurites than expected at branching point.");
+		vBPChildren[brPt.childBegin + brPt.nChildren] = childNeurite;
+		++brPt.nChildren;
+	}
+
+	/// children of a branching point
+	NeuriteRange<size_t> children(const NeuriteBranchPoint& brPt) const
+	{
+		const size_t* base = vBPChildren.empty() ? NULL : &vBPChildren[0];
+		return NeuriteRange<size_t>(base + brPt.childBegin, base + brPt.childBegin + brPt.nChildren);
+	}
+};
+
+///@}
+
+} // namespace neurites_from_swc
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__NEURITE_STORAGE_H
@@ -38,6 +38,9 @@
  */
 
 #include "neurites_from_swc.h"
+#include "neurite_storage.h"  // NeuriteData
+#include "swc_reader.h"  // load_swc_points
+#include "text_writer.h"  // TextFileWriter
 
 #include "common/math/math_vector_matrix/math_vector_functions.h"  // VecScale
 #include "common/util/file_util.h"  // FindFileInStandardPaths
@@ -53,7 +56,7 @@
 #include "lib_grid/algorithms/grid_generation/icosahedron.h" // icosahedron
 #include "lib_grid/file_io/file_io_ugx.h"  // GridWriterUGX
 #include "lib_grid/file_io/file_io.h"  // SaveGridHierarchyTransformed
-#include "lib_grid/file_io/file_io_swc.h"  // FileReaderSWC
+#include "lib_grid/file_io/file_io_swc.h"  // swc_types
 #include "lib_grid/global_attachments.h"
 #include "lib_grid/grid/geometry.h" // MakeGeometry3d
 #include "lib_grid/grid/neighborhood_util.h"  // for GetConnectedNeighbor
@@ -61,6 +64,7 @@
 #include "lib_grid/refinement/projectors/neurite_projector.h"
 #include "lib_grid/refinement/projectors/projection_handler.h"
 #include "lib_grid/refinement/regular_refinement.h"  // Refine
+#include "../util/mesh_cache.h"  // MeshCacheKey etc.
 
 #include <boost/lexical_cast.hpp>
 
@@ -351,27 +355,39 @@ static void collapse_short_edges(Grid& g, SubsetHandler& sh)
 static void convert_pointlist_to_neuritelist
 (
     const std::vector<swc_types::SWCPoint>& vPoints,
-    std::vector<std::vector<vector3> >& vPosOut,
-    std::vector<std::vector<number> >& vRadOut,
-    std::vector<std::vector<std::pair<size_t, std::vector<size_t> > > >& vBPInfoOut,
+    NeuriteData& ndOut,
     std::vector<size_t>& vRootNeuriteIndsOut
 )
 {
     // clear out vectors
-    vPosOut.clear();
-    vRadOut.clear();
-    vBPInfoOut.clear();
+    ndOut.clear();
     vRootNeuriteIndsOut.clear();
 
 	size_t nPts = vPoints.size();
+
+	// reserve all neurite storage at once:
+	// each neurite ends in an end point; branching points have more than two connections
+	size_t nEndPts = 0;
+	size_t nBPs = 0;
+	for (size_t i = 0; i < nPts; ++i)
+	{
+		const size_t nConn = vPoints[i].conns.size();
+		if (nConn == 1) ++nEndPts;
+		else if (nConn > 2) ++nBPs;
+	}
+	ndOut.reserve(nPts, nEndPts + 1, nBPs);
+
 	std::vector<bool> ptProcessed(nPts, false);
 	size_t nProcessed = 0;
 	size_t curNeuriteInd = 0;
+	size_t nNeurites = 0;
+	size_t somaSearchStart = 0;
 
 	while (nProcessed != nPts)
 	{
 		// find first soma's root point in geometry and save its index as i
-		size_t i = 0;
+		// (all points before the previous soma root have been processed already)
+		size_t i = somaSearchStart;
 		for (; i < nPts; ++i)
 		{
 			if (vPoints[i].type == swc_types::SWC_SOMA && !ptProcessed[i])
@@ -379,6 +395,7 @@ static void convert_pointlist_to_neuritelist
 		}
 		UG_COND_THROW(i == nPts, "No soma contained in (non-empty) list of unprocessed SWC points, \n"
 				"i.e., there is at least one SWC point not connected to any soma.");
+		somaSearchStart = i + 1;
 
 		// collect neurite root points
 		std::vector<std::pair<size_t, size_t> > rootPts;
@@ -406,9 +423,7 @@ static void convert_pointlist_to_neuritelist
 				rootPts.push_back(std::make_pair(pind, ind));
 		}
 
-		vPosOut.resize(vPosOut.size() + rootPts.size());
-		vRadOut.resize(vRadOut.size() + rootPts.size());
-		vBPInfoOut.resize(vBPInfoOut.size() + rootPts.size());
+		nNeurites += rootPts.size();
 
 		std::stack<std::pair<size_t, size_t> > processing_stack;
 		for (size_t i = 0; i < rootPts.size(); ++i)
@@ -417,8 +432,8 @@ static void convert_pointlist_to_neuritelist
 		vRootNeuriteIndsOut.push_back(curNeuriteInd);
 
 		// helper map to be used to correctly save BPs:
-		// maps branch root parent ID to neurite ID and BP ID
-		std::map<size_t, std::pair<size_t, size_t> > helperMap;
+		// maps branch root parent ID to (global) BP ID
+		std::map<size_t, size_t> helperMap;
 
 		while (!processing_stack.empty())
 		{
@@ -434,8 +449,8 @@ static void convert_pointlist_to_neuritelist
 			UG_COND_THROW(pt.type == swc_types::SWC_SOMA, "Detected neuron with more than one soma.");
 
 			// push back coords and radius information to proper neurite
-			vPosOut[curNeuriteInd].push_back(pt.coords);
-			vRadOut[curNeuriteInd].push_back(pt.radius);
+			ndOut.pos.push_back(curNeuriteInd, pt.coords);
+			ndOut.rad.push_back(curNeuriteInd, pt.radius);
 
 			size_t nConn = pt.conns.size();
 
@@ -471,15 +486,11 @@ static void convert_pointlist_to_neuritelist
 					}
 				}
 
-				// branching point info
-				std::pair<size_t, std::vector<size_t> > bp;
-				bp.first = vPosOut[curNeuriteInd].size()-1; // BP is located at this index of the neurite
-
-				// resize out vectors to accommodate new neurites starting here
-				size_t newSize = vPosOut.size() + nConn - 2;
-				vPosOut.resize(newSize);
-				vRadOut.resize(newSize);
-				vBPInfoOut.resize(newSize);
+				// add BP (located at the current index of the neurite) to BP storage,
+				// with room for the new neurites starting here
+				const size_t bpInd = ndOut.add_branch_point(curNeuriteInd,
+					ndOut.pos[curNeuriteInd].size()-1, nConn - 2);
+				nNeurites += nConn - 2;
 
 				for (size_t i = 0; i < nConn; ++i)
 				{
@@ -489,17 +500,13 @@ static void convert_pointlist_to_neuritelist
 					// push new neurite starting point index to stack
 					processing_stack.push(std::make_pair(ind, pt.conns[i]));
 
-					// save current point ID with current neurite ID and BP ID
+					// save current point ID with BP ID
 					// for later assignment of branching neurite ID to BP
-					// NOT: bp.second.push_back(++futureNeuriteInd);
-					helperMap[ind] = std::make_pair(curNeuriteInd, vBPInfoOut[curNeuriteInd].size());
+					helperMap[ind] = bpInd;
 				}
 
 				// push next index of the current neurite to stack
 				processing_stack.push(std::make_pair(ind, pt.conns[minAngleInd]));
-
-				// add BP to BP vector
-				vBPInfoOut[curNeuriteInd].push_back(bp);
 			}
 
 			// end point
@@ -513,17 +520,15 @@ static void convert_pointlist_to_neuritelist
 					size_t nextParentID = processing_stack.top().first;
 
 					// is this a root neurite? (this is the case if helper map does not contain next parent)
-					std::map<size_t, std::pair<size_t, size_t> >::const_iterator it = helperMap.find(nextParentID);
+					std::map<size_t, size_t>::const_iterator it = helperMap.find(nextParentID);
 					if (it != helperMap.end())
 					{
 						// push back parent position and radius to new neurite
-						vPosOut[curNeuriteInd].push_back(vPoints[nextParentID].coords);
-						vRadOut[curNeuriteInd].push_back(vPoints[nextParentID].radius);
+						ndOut.pos.push_back(curNeuriteInd, vPoints[nextParentID].coords);
+						ndOut.rad.push_back(curNeuriteInd, vPoints[nextParentID].radius);
 
 						// push back new neurite ID to BP at parent
-						size_t nextParentNeuriteID = it->second.first;
-						size_t nextParentBPID = it->second.second;
-						vBPInfoOut[nextParentNeuriteID][nextParentBPID].second.push_back(curNeuriteInd);
+						ndOut.add_branch_child(it->second, curNeuriteInd);
 					}
 					// else: the next point is the root point of a root neurite
 					else
@@ -548,6 +553,11 @@ static void convert_pointlist_to_neuritelist
 		++curNeuriteInd;
 	}
 
+	// neurites without any BP have not been created in the BP storage yet
+	ndOut.pos.resize(nNeurites);
+	ndOut.rad.resize(nNeurites);
+	ndOut.bp.resize(nNeurites);
+
 #if 0
     size_t numSomaPoints = vSomaPoints.size();
     UG_LOGN("Number of soma points: " << numSomaPoints);
@@ -562,36 +572,34 @@ static void convert_pointlist_to_neuritelist
 static void create_spline_data_for_neurites
 (
     std::vector<NeuriteProjector::Neurite>& vNeuritesOut,
-    const std::vector<std::vector<vector3> >& vPos,
-    const std::vector<std::vector<number> >& vR,
-    std::vector<std::vector<std::pair<size_t, std::vector<size_t> > > >* vBPInfo = NULL
+    const NeuriteData& nd
 )
 {
-    size_t nNeurites = vPos.size();
+    size_t nNeurites = nd.num_neurites();
     vNeuritesOut.resize(nNeurites);
 
     std::vector<vector3> parentDirections(nNeurites);
 
     // first: reserve memory for branching region vectors
     // (we will point to their elements in BranchingPoints and do not want the vectors to reallocate!)
-    if (vBPInfo)
-        for (size_t n = 0; n < nNeurites; ++n)
-            vNeuritesOut[n].vBR.reserve((*vBPInfo)[n].size()+1);
+    for (size_t n = 0; n < nNeurites; ++n)
+        vNeuritesOut[n].vBR.reserve(nd.bp[n].size()+1);
+
+    // helper vectors (re-used for all neurites)
+    std::vector<number> tSuppPos;
+    std::vector<number> dt;
 
     for (size_t n = 0; n < nNeurites; ++n)
     {
         NeuriteProjector::Neurite& neuriteOut = vNeuritesOut[n];
-        const std::vector<vector3>& pos = vPos[n];
-        std::vector<number> r = vR[n];
-        std::vector<std::pair<size_t, std::vector<size_t> > >* bpInfo = NULL;
-
-        if (vBPInfo)
-             bpInfo = &((*vBPInfo)[n]);
+        const NeuriteRange<vector3> pos = nd.pos[n];
+        const NeuriteRange<number> r = nd.rad[n];
+        const NeuriteRange<NeuriteBranchPoint> bpInfo = nd.bp[n];
 
         // parameterize to achieve constant velocity on piece-wise linear geom
         size_t nVrt = pos.size();
-        std::vector<number> tSuppPos(nVrt);
-        std::vector<number> dt(nVrt);
+        tSuppPos.assign(nVrt, 0.0);
+        dt.assign(nVrt, 0.0);
         number totalLength = 0.0;
         for (size_t i = 0; i < nVrt-1; ++i)
         {
@@ -721,15 +729,11 @@ static void create_spline_data_for_neurites
 
         // this will be 0 for root branches and 1 otherwise
         size_t brInd = neuriteOut.vBR.size();
-        std::vector<std::pair<size_t, std::vector<size_t> > >::const_iterator brIt;
-        std::vector<std::pair<size_t, std::vector<size_t> > >::const_iterator brIt_end;
-        if (bpInfo)
-        {
-            // vBR may already contain an initial BR; now resize to accommodate all others
-            neuriteOut.vBR.resize(brInd + bpInfo->size());
-            brIt = bpInfo->begin();
-            brIt_end = bpInfo->end();
-        }
+
+        // vBR may already contain an initial BR; now resize to accommodate all others
+        neuriteOut.vBR.resize(brInd + bpInfo.size());
+        NeuriteRange<NeuriteBranchPoint>::const_iterator brIt = bpInfo.begin();
+        NeuriteRange<NeuriteBranchPoint>::const_iterator brIt_end = bpInfo.end();
 
         for (size_t i = 0; i < nVrt-1; ++i)
         {
@@ -756,11 +760,12 @@ static void create_spline_data_for_neurites
             param[3] = r[i+1];
 
             // branching points?
-            if (bpInfo && brIt != brIt_end && brIt->first == i+1)
+            if (brIt != brIt_end && brIt->pos == i+1)
             {
                 NeuriteProjector::BranchingRegion& br = neuriteOut.vBR[brInd];
-                std::vector<size_t>::const_iterator itBranch = brIt->second.begin();
-                std::vector<size_t>::const_iterator itBranch_end = brIt->second.end();
+                const NeuriteRange<size_t> vChildren = nd.children(*brIt);
+                NeuriteRange<size_t>::const_iterator itBranch = vChildren.begin();
+                NeuriteRange<size_t>::const_iterator itBranch_end = vChildren.end();
 
                 // create BP for parent neurite's BR
                 br.bp = make_sp(new NeuriteProjector::BranchingPoint());
@@ -836,12 +841,18 @@ static void create_spline_data_for_neurites
 }
 
 
+/**
+ * integral from t_start to t_end over ||v(t)|| / r(t)^radiusExponent dt,
+ * i.e., the length in units of radius (default)
+ * or, for radiusExponent = 0.5, in units of sqrt(radius)
+ */
 number calculate_length_over_radius
 (
 	number t_start,
 	number t_end,
 	const NeuriteProjector::Neurite& neurite,
-	size_t startSec
+	size_t startSec,
+	number radiusExponent = 1.0
 )
 {
 	GaussLegendre gl(5);
@@ -898,7 +909,8 @@ number calculate_length_over_radius
 
 			UG_COND_THROW(r*r <= VecNormSquared(vel)*1e-12, "r = " << r << " at t = " << t << "!");
 
-			sec_integral += gl.weight(i) * sqrt(VecNormSquared(vel)) / r;
+			sec_integral += gl.weight(i) * sqrt(VecNormSquared(vel))
+				/ (radiusExponent == 1.0 ? r : pow(r, radiusExponent));
 		}
 
 		integral += dt * sec_integral;
@@ -921,7 +933,8 @@ void calculate_segment_axial_positions
 	number t_end,
 	const NeuriteProjector::Neurite& neurite,
 	size_t startSec,
-	number segLength
+	number segLength,
+	number radiusExponent = 1.0
 )
 {
 	const size_t nSeg = segAxPosOut.size();
@@ -980,7 +993,8 @@ void calculate_segment_axial_positions
 
 			UG_COND_THROW(r*r <= VecNormSquared(vel)*1e-12, "r = " << r << " at t = " << t << "!");
 
-			sec_integral += gl.weight(i) * sqrt(VecNormSquared(vel)) / r;
+			sec_integral += gl.weight(i) * sqrt(VecNormSquared(vel))
+				/ (radiusExponent == 1.0 ? r : pow(r, radiusExponent));
 		}
 		integral += dt * sec_integral;
 
@@ -1013,8 +1027,8 @@ void calculate_segment_axial_positions
 static void create_neurite
 (
 	const std::vector<NeuriteProjector::Neurite>& vNeurites,
-	const std::vector<std::vector<vector3> >& vPos,
-	const std::vector<std::vector<number> >& vR,
+	const NeuriteArray<vector3>& vPos,
+	const NeuriteArray<number>& vR,
 	size_t nid,
 	number anisotropy,
 	Grid& g,
@@ -1027,8 +1041,8 @@ static void create_neurite
 )
 {
 	const NeuriteProjector::Neurite& neurite = vNeurites[nid];
-	const std::vector<vector3>& pos = vPos[nid];
-	const std::vector<number>& r = vR[nid];
+	const NeuriteRange<vector3> pos = vPos[nid];
+	const NeuriteRange<number> r = vR[nid];
 
 	number neurite_length = 0.0;
 	for (size_t i = 1; i < pos.size(); ++i)
@@ -1136,6 +1150,10 @@ static void create_neurite
 	vector3 lastPos = pos[0];
 	size_t curSec = 0;
 
+	// per-section helper vectors (re-used for all sections)
+	std::vector<number> branchOffset;
+	std::vector<number> vSegAxPos;
+
 	while (true)
 	{
 		t_start = t_end;
@@ -1145,7 +1163,7 @@ static void create_neurite
 		number bp_end = 0.0;
 
 		// initial branch offsets (to prevent the first segment being shorter than the following)
-		std::vector<number> branchOffset;
+		branchOffset.clear();
 		number surfBPoffset;
 
 		// last section: create until tip
@@ -1242,7 +1260,7 @@ static void create_neurite
 		if (!nSeg)
 			nSeg = 1;
 		number segLength = lengthOverRadius / nSeg;	// segments are between 8 and 16 radii long
-		std::vector<number> vSegAxPos(nSeg);
+		vSegAxPos.assign(nSeg, 0.0);
 		calculate_segment_axial_positions(vSegAxPos, t_start, t_end, neurite, curSec, segLength);
 
 		// add the branching point to segment list (if present)
@@ -1588,8 +1606,8 @@ static void create_neurite
 static void create_neurite_with_er
 (
 	const std::vector<NeuriteProjector::Neurite>& vNeurites,
-	const std::vector<std::vector<vector3> >& vPos,
-	const std::vector<std::vector<number> >& vR,
+	const NeuriteArray<vector3>& vPos,
+	const NeuriteArray<number>& vR,
 	size_t nid,
 	number erScaleFactor,
 	number anisotropy,
@@ -1604,8 +1622,8 @@ static void create_neurite_with_er
 )
 {
 	const NeuriteProjector::Neurite& neurite = vNeurites[nid];
-	const std::vector<vector3>& pos = vPos[nid];
-	const std::vector<number>& r = vR[nid];
+	const NeuriteRange<vector3> pos = vPos[nid];
+	const NeuriteRange<number> r = vR[nid];
 
 	number neurite_length = 0.0;
 	for (size_t i = 1; i < pos.size(); ++i)
@@ -1753,6 +1771,10 @@ static void create_neurite_with_er
 	vector3 lastPos = pos[0];
 	size_t curSec = 0;
 
+	// per-section helper vectors (re-used for all sections)
+	std::vector<number> branchOffset;
+	std::vector<number> vSegAxPos;
+
 	while (true)
 	{
 		t_start = t_end;
@@ -1762,7 +1784,7 @@ static void create_neurite_with_er
 		number bp_end = 0.0;
 
 		// initial branch offsets (to prevent the first segment being shorter than the following)
-		std::vector<number> branchOffset;
+		branchOffset.clear();
 		number surfBPoffset;
 
 		// last section: create until tip
@@ -1859,7 +1881,7 @@ static void create_neurite_with_er
 		if (!nSeg)
 			nSeg = 1;
 		number segLength = lengthOverRadius / nSeg;	// segments are between 8 and 16 radii long
-		std::vector<number> vSegAxPos(nSeg);
+		vSegAxPos.assign(nSeg, 0.0);
 		calculate_segment_axial_positions(vSegAxPos, t_start, t_end, neurite, curSec, segLength);
 
 		// add the branching point to segment list (if present)
@@ -2562,13 +2584,49 @@ static void create_neurite_with_er
 
 
 
+/**
+ * How the axial segment lengths of 1d neurites are chosen:
+ * The length of a segment is measured in the local length unit
+ * unitScale * r^radiusExponent and the number of segments for a section
+ * between branching points is chosen such that the segments have (about)
+ * the target length therein. If roundUp is set, the segments are at most as
+ * long as the target length, otherwise at least.
+ */
+struct SegmentLengthRule
+{
+	number radiusExponent;
+	number unitScale;
+	number targetLength;
+	bool roundUp;
+
+	/// segments of a given anisotropy (edge length / radius) in the refinement limit
+	static SegmentLengthRule anisotropy(number anisotropy)
+	{
+		SegmentLengthRule rule = {1.0, 1.0, anisotropy*0.5*PI, false};
+		return rule;
+	}
+
+	/**
+	 * segments of at most a fraction (dLambda) of the local AC length constant
+	 * lambda_f = sqrt(r / (2 pi f Ra Cm)) at frequency f
+	 * with specific axial resistance Ra and specific membrane capacitance Cm
+	 */
+	static SegmentLengthRule electrotonic(number dLambda, number f, number Ra, number Cm)
+	{
+		SegmentLengthRule rule = {0.5, 1.0 / sqrt(2.0*PI*f*Ra*Cm), dLambda, true};
+		return rule;
+	}
+};
+
+
+
 static void create_neurite_1d
 (
     const std::vector<NeuriteProjector::Neurite>& vNeurites,
-    const std::vector<std::vector<vector3> >& vPos,
-    const std::vector<std::vector<number> >& vR,
+    const NeuriteArray<vector3>& vPos,
+    const NeuriteArray<number>& vR,
     size_t nid,
-	number anisotropy,
+	const SegmentLengthRule& segRule,
     Grid& g,
     Grid::VertexAttachmentAccessor<APosition>& aaPos,
     Grid::VertexAttachmentAccessor<Attachment<NeuriteProjector::SurfaceParams> >& aaSurfParams,
@@ -2577,8 +2635,8 @@ static void create_neurite_1d
 )
 {
     const NeuriteProjector::Neurite& neurite = vNeurites[nid];
-    const std::vector<vector3>& pos = vPos[nid];
-    const std::vector<number>& r = vR[nid];
+    const NeuriteRange<vector3> pos = vPos[nid];
+    const NeuriteRange<number> r = vR[nid];
 
     number neurite_length = 0.0;
     for (size_t i = 1; i < pos.size(); ++i)
@@ -2618,6 +2676,9 @@ static void create_neurite_1d
     number t_end = 0.0;
     size_t curSec = 0;
 
+    // per-section helper vector (re-used for all sections)
+    std::vector<number> vSegAxPos;
+
     while (true)
     {
     	t_start = t_end;
@@ -2630,18 +2691,23 @@ static void create_neurite_1d
     	else
     		t_end = brit->t;
 
-    	// calculate total length in units of radius
-    	// = integral from t_start to t_end over: ||v(t)|| / r(t) dt
-    	number lengthOverRadius = calculate_length_over_radius(t_start, t_end, neurite, curSec);
-
-    	// to reach the desired anisotropy on the surface in the refinement limit,
-		// it has to be multiplied by pi/2 h
-		size_t nSeg = (size_t) floor(lengthOverRadius / (anisotropy*0.5*PI));
+    	// calculate total length in units of the local length unit
+    	// = integral from t_start to t_end over: ||v(t)|| / (scale * r(t)^exp) dt
+    	number lengthOverRadius = calculate_length_over_radius(t_start, t_end, neurite, curSec,
+    		segRule.radiusExponent);
+    	const number localLength = lengthOverRadius / segRule.unitScale;
+
+    	// for the anisotropy rule, the target length is the desired anisotropy
+    	// on the surface in the refinement limit multiplied by pi/2 h
+    	size_t nSeg = segRule.roundUp
+    		? (size_t) ceil(localLength / segRule.targetLength)
+    		: (size_t) floor(localLength / segRule.targetLength);
     	if (nSeg < 1 || lengthOverRadius < 0)
     		nSeg = 1;
-    	number segLength = lengthOverRadius / nSeg;	// segments are between 8 and 16 radii long
-    	std::vector<number> vSegAxPos(nSeg);
-    	calculate_segment_axial_positions(vSegAxPos, t_start, t_end, neurite, curSec, segLength);
+    	number segLength = lengthOverRadius / nSeg;
+    	vSegAxPos.assign(nSeg, 0.0);
+    	calculate_segment_axial_positions(vSegAxPos, t_start, t_end, neurite, curSec, segLength,
+    		segRule.radiusExponent);
 
     	// create mesh for segments
     	Selector sel(g);
@@ -2721,7 +2787,7 @@ static void create_neurite_1d
 			aaSurfParams[connectingVrt].neuriteID += (brit - vBR.begin()) << 20;  // add branching region index
 			aaSurfParams[connectingVrt].neuriteID += 1 << 28;  // add child ID (always 0, since there can only be one child here)
 
-			create_neurite_1d(vNeurites, vPos, vR, child_nid, anisotropy,
+			create_neurite_1d(vNeurites, vPos, vR, child_nid, segRule,
 				g, aaPos, aaSurfParams, aaDiam, connectingVrt);
 		}
 
@@ -2824,15 +2890,15 @@ void export_to_swc
             start = q.front();
     }
 
-    // write the neuron to file
-    std::ofstream outFile(fileName.c_str(), std::ios::out);
-    UG_COND_THROW(!outFile.is_open(), "Could not open output file '" << fileName << "'.");
+    // write the neuron to file (buffered, in one depth-first traversal)
+    TextFileWriter outFile(fileName);
 
-    outFile << "# This file has been generated by UG4." << std::endl;
+    outFile.put("# This file has been generated by UG4.\n");
 
     std::stack<std::pair<Vertex*, int> > stack; // corresponds to depth-first
     stack.push(std::make_pair(start, -1));
 
+    Grid::traits<Edge>::secure_container edges;
     g.begin_marking();
     int ind = 0;   // by convention, swc starts with index 1
     bool all_types_identified = true;
@@ -2855,12 +2921,11 @@ void export_to_swc
         number radius = 0.5*aaDiam[v];
 
         // write line to file
-        outFile << ++ind << " " << type << " "
-            << coord[0] << " " << coord[1] << " " << coord[2] << " "
-            << radius << " " << conn << std::endl;
+        outFile.put_int(++ind).put(' ').put_int((long) type).put(' ')
+            .put_number(coord[0]).put(' ').put_number(coord[1]).put(' ').put_number(coord[2]).put(' ')
+            .put_number(radius).put(' ').put_int(conn).put('\n');
 
         // push neighboring elems to queue
-        Grid::traits<Edge>::secure_container edges;
         g.associated_elements(edges, v);
 
         size_t sz = edges.size();
@@ -2936,6 +3001,176 @@ void swc_points_to_grid
 
 
 
+/// appends all elements of a grid (with positions, surface params and subsets) to another grid
+static void append_grid
+(
+	Grid& dest,
+	SubsetHandler* destSH,
+	Grid& src,
+	SubsetHandler* srcSH,
+	Attachment<NeuriteProjector::SurfaceParams>& aSP
+)
+{
+	Grid::VertexAttachmentAccessor<APosition> aaPosSrc(src, aPosition);
+	Grid::VertexAttachmentAccessor<APosition> aaPosDest(dest, aPosition);
+	Grid::VertexAttachmentAccessor<Attachment<NeuriteProjector::SurfaceParams> > aaSPSrc(src, aSP);
+	Grid::VertexAttachmentAccessor<Attachment<NeuriteProjector::SurfaceParams> > aaSPDest(dest, aSP);
+
+	// elements are created in the order of the source grid
+	Attachment<Vertex*> aNewVrt;
+	src.attach_to_vertices(aNewVrt);
+	Grid::VertexAttachmentAccessor<Attachment<Vertex*> > aaNewVrt(src, aNewVrt);
+
+	for (VertexIterator it = src.begin<Vertex>(); it != src.end<Vertex>(); ++it)
+	{
+		Vertex* nv = *dest.create_by_cloning(*it);
+		aaNewVrt[*it] = nv;
+		aaPosDest[nv] = aaPosSrc[*it];
+		aaSPDest[nv] = aaSPSrc[*it];
+		if (srcSH && destSH)
+			destSH->assign_subset(nv, srcSH->get_subset_index(*it));
+	}
+
+	for (EdgeIterator it = src.begin<Edge>(); it != src.end<Edge>(); ++it)
+	{
+		Edge* e = *it;
+		Edge* ne = *dest.create_by_cloning(e, EdgeDescriptor(aaNewVrt[e->vertex(0)], aaNewVrt[e->vertex(1)]));
+		if (srcSH && destSH)
+			destSH->assign_subset(ne, srcSH->get_subset_index(e));
+	}
+
+	for (FaceIterator it = src.begin<Face>(); it != src.end<Face>(); ++it)
+	{
+		Face* f = *it;
+		const size_t nVrt = f->num_vertices();
+		FaceDescriptor fd(nVrt);
+		for (size_t i = 0; i < nVrt; ++i)
+			fd.set_vertex(i, aaNewVrt[f->vertex(i)]);
+		Face* nf = *dest.create_by_cloning(f, fd);
+		if (srcSH && destSH)
+			destSH->assign_subset(nf, srcSH->get_subset_index(f));
+	}
+
+	for (VolumeIterator it = src.begin<Volume>(); it != src.end<Volume>(); ++it)
+	{
+		Volume* v = *it;
+		const size_t nVrt = v->num_vertices();
+		VolumeDescriptor vd(nVrt);
+		for (size_t i = 0; i < nVrt; ++i)
+			vd.set_vertex(i, aaNewVrt[v->vertex(i)]);
+		Volume* nv = *dest.create_by_cloning(v, vd);
+		if (srcSH && destSH)
+			destSH->assign_subset(nv, srcSH->get_subset_index(v));
+	}
+
+	src.detach_from_vertices(aNewVrt);
+}
+
+
+/**
+ * @brief Creates the coarse grids for all root neurites (with their branches)
+ *
+ * Root neurites do not share any vertices, so each root neurite subtree is built
+ * in a grid of its own. With OpenMP, these grids are built in parallel (dynamically
+ * scheduled, as the subtrees differ largely in size). Afterwards, they are appended
+ * to the output grid in the order of the root neurites, so the result is the same
+ * as for a serial build, regardless of the number of threads.
+ *
+ * @param erScaleFactor  if given, neurites are built with ER (and subsets are assigned)
+ */
+static void create_root_neurites
+(
+	const std::vector<NeuriteProjector::Neurite>& vNeurites,
+	const NeuriteArray<vector3>& vPos,
+	const NeuriteArray<number>& vR,
+	const std::vector<size_t>& vRootNeuriteInds,
+	const number* erScaleFactor,
+	number anisotropy,
+	Grid& g,
+	SubsetHandler& sh,
+	Attachment<NeuriteProjector::SurfaceParams>& aSP
+)
+{
+	typedef NeuriteProjector::SurfaceParams NPSP;
+
+	const long nRoots = (long) vRootNeuriteInds.size();
+	std::vector<Grid*> vTaskGrid(nRoots, NULL);
+	std::vector<SubsetHandler*> vTaskSH(nRoots, NULL);
+	std::vector<std::string> vError(nRoots);
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (long i = 0; i < nRoots; ++i)
+	{
+		// exceptions must not leave the parallel region
+		try
+		{
+			Grid* tg = new Grid();
+			vTaskGrid[i] = tg;
+			tg->attach_to_vertices(aPosition);
+			tg->attach_to_vertices(aSP);
+			Grid::VertexAttachmentAccessor<APosition> aaPos(*tg, aPosition);
+			Grid::VertexAttachmentAccessor<Attachment<NPSP> > aaSurfParams(*tg, aSP);
+
+			if (erScaleFactor)
+			{
+				SubsetHandler* tsh = new SubsetHandler(*tg);
+				vTaskSH[i] = tsh;
+				tsh->set_default_subset_index(0);
+				create_neurite_with_er(vNeurites, vPos, vR, vRootNeuriteInds[i],
+					*erScaleFactor, anisotropy, *tg, aaPos, aaSurfParams, *tsh, NULL, NULL);
+			}
+			else
+				create_neurite(vNeurites, vPos, vR, vRootNeuriteInds[i],
+					anisotropy, *tg, aaPos, aaSurfParams, NULL, NULL);
+		}
+		catch (UGError& err) {vError[i] = err.get_msg();}
+		catch (std::exception& ex) {vError[i] = ex.what();}
+	}
+
+	// merge in the order of the root neurites
+	long firstError = -1;
+	for (long i = 0; i < nRoots; ++i)
+	{
+		if (vError[i].empty() && firstError < 0)
+			append_grid(g, &sh, *vTaskGrid[i], vTaskSH[i], aSP);
+		else if (!vError[i].empty() && firstError < 0)
+			firstError = i;
+
+		delete vTaskSH[i];
+		delete vTaskGrid[i];
+	}
+
+	UG_COND_THROW(firstError >= 0, "Creation of root neurite " << vRootNeuriteInds[firstError]
+		<< " failed: " << vError[firstError]);
+}
+
+
+
+/// names of the files written by the 3d SWC import functions (in cache order)
+static void swc_import_output_files
+(
+	const std::string& outFileNameBase,
+	size_t numRefs,
+	std::vector<std::string>& vFileNamesOut
+)
+{
+	vFileNamesOut.clear();
+	vFileNamesOut.push_back(outFileNameBase + ".ugx");
+	if (numRefs == 0)
+		return;
+
+	for (size_t i = 0; i <= numRefs; ++i)
+	{
+		std::ostringstream oss;
+		oss << outFileNameBase << "_refined_" << i << ".ugx";
+		vFileNamesOut.push_back(oss.str());
+	}
+}
+
+
+
 void import_neurites_from_swc
 (
 	const std::string& fileNameIn,
@@ -2949,20 +3184,29 @@ void import_neurites_from_swc
     UG_COND_THROW(inFileName == "", "File '" << fileNameIn
     	<< "' could not be located in standard paths.");
 
-	FileReaderSWC swcFileReader;
-	swcFileReader.load_file(inFileName.c_str());
-	std::vector<swc_types::SWCPoint>& vPoints = swcFileReader.swc_points();
+	// take result from mesh cache if available
+	std::string outFileNameBase = FilenameAndPathWithoutExtension(fileNameOut);
+	std::vector<std::string> vOutFileNames;
+	swc_import_output_files(outFileNameBase, numRefs, vOutFileNames);
+
+	MeshCacheKey cacheKey("import_neurites_from_swc", "1");
+	cacheKey.add_file_content(inFileName);
+	cacheKey.add(anisotropy);
+	cacheKey.add(numRefs);
+	if (mesh_cache_restore(cacheKey, vOutFileNames))
+		return;
+
+	std::vector<swc_types::SWCPoint> vPoints;
+	load_swc_points(inFileName, vPoints);
 
 	// preconditioning
 	//smoothing(vPoints, 5, 1.0, 1.0);
 
 	// convert intermediate structure to neurite data
-	std::vector<std::vector<vector3> > vPos;
-	std::vector<std::vector<number> > vRad;
-	std::vector<std::vector<std::pair<size_t, std::vector<size_t> > > > vBPInfo;
+	NeuriteData nd;
 	std::vector<size_t> vRootNeuriteIndsOut;
 
-	convert_pointlist_to_neuritelist(vPoints, vPos, vRad, vBPInfo, vRootNeuriteIndsOut);
+	convert_pointlist_to_neuritelist(vPoints, nd, vRootNeuriteIndsOut);
 
 	// prepare grid and projector
 	Grid g;
@@ -2993,12 +3237,11 @@ void import_neurites_from_swc
 
 	// create spline data
 	std::vector<NeuriteProjector::Neurite>& vNeurites = neuriteProj->neurites();
-	create_spline_data_for_neurites(vNeurites, vPos, vRad, &vBPInfo);
+	create_spline_data_for_neurites(vNeurites, nd);
 
 	// create coarse grid
-	for (size_t i = 0; i < vRootNeuriteIndsOut.size(); ++i)
-		create_neurite(vNeurites, vPos, vRad, vRootNeuriteIndsOut[i],
-			anisotropy, g, aaPos, aaSurfParams, NULL, NULL);
+	create_root_neurites(vNeurites, nd.pos, nd.rad, vRootNeuriteIndsOut, NULL,
+		anisotropy, g, sh, aSP);
 
 	// at branching points, we have not computed the correct positions yet,
 	// so project the complete geometry using the projector
@@ -3012,7 +3255,6 @@ void import_neurites_from_swc
 	sh.set_subset_name("neurites", 0);
 
 	// output
-	std::string outFileNameBase = FilenameAndPathWithoutExtension(fileNameOut);
 	std::string outFileName = outFileNameBase + ".ugx";
 	GridWriterUGX ugxWriter;
 	ugxWriter.add_grid(g, "defGrid", aPosition);
@@ -3022,7 +3264,10 @@ void import_neurites_from_swc
 		UG_THROW("Grid could not be written to file '" << outFileName << "'.");
 
 	if (numRefs == 0)
+	{
+		mesh_cache_store(cacheKey, vOutFileNames);
 		return;
+	}
 
 	// refinement
 	Domain3d dom;
@@ -3046,6 +3291,8 @@ void import_neurites_from_swc
 		try {SaveGridHierarchyTransformed(*dom.grid(), *dom.subset_handler(), curFileName.c_str(), offset);}
 		UG_CATCH_THROW("Grid could not be written to file '" << curFileName << "'.");
 	}
+
+	mesh_cache_store(cacheKey, vOutFileNames);
 }
 
 
@@ -3064,20 +3311,30 @@ void import_er_neurites_from_swc
 	UG_COND_THROW(inFileName == "", "File '" << fileNameIn
 		<< "' could not be located in standard paths.");
 
-	FileReaderSWC swcFileReader;
-	swcFileReader.load_file(inFileName.c_str());
-	std::vector<swc_types::SWCPoint>& vPoints = swcFileReader.swc_points();
+	// take result from mesh cache if available
+	std::string outFileNameBase = FilenameAndPathWithoutExtension(fileNameOut);
+	std::vector<std::string> vOutFileNames;
+	swc_import_output_files(outFileNameBase, numRefs, vOutFileNames);
+
+	MeshCacheKey cacheKey("import_er_neurites_from_swc", "1");
+	cacheKey.add_file_content(inFileName);
+	cacheKey.add(erScaleFactor);
+	cacheKey.add(anisotropy);
+	cacheKey.add(numRefs);
+	if (mesh_cache_restore(cacheKey, vOutFileNames))
+		return;
+
+	std::vector<swc_types::SWCPoint> vPoints;
+	load_swc_points(inFileName, vPoints);
 
 	// smoothing
 	//smoothing(vPoints, 5, 1.0, 1.0);
 
 	// convert intermediate structure to neurite data
-	std::vector<std::vector<vector3> > vPos;
-	std::vector<std::vector<number> > vRad;
-	std::vector<std::vector<std::pair<size_t, std::vector<size_t> > > > vBPInfo;
+	NeuriteData nd;
 	std::vector<size_t> vRootNeuriteIndsOut;
 
-	convert_pointlist_to_neuritelist(vPoints, vPos, vRad, vBPInfo, vRootNeuriteIndsOut);
+	convert_pointlist_to_neuritelist(vPoints, nd, vRootNeuriteIndsOut);
 
 	// prepare grid and projector
 	Grid g;
@@ -3109,12 +3366,11 @@ void import_er_neurites_from_swc
 
 	// create spline data
 	std::vector<NeuriteProjector::Neurite>& vNeurites = neuriteProj->neurites();
-	create_spline_data_for_neurites(vNeurites, vPos, vRad, &vBPInfo);
+	create_spline_data_for_neurites(vNeurites, nd);
 
 	// create coarse grid
-	for (size_t i = 0; i < vRootNeuriteIndsOut.size(); ++i)
-		create_neurite_with_er(vNeurites, vPos, vRad, vRootNeuriteIndsOut[i],
-			erScaleFactor, anisotropy, g, aaPos, aaSurfParams, sh, NULL, NULL);
+	create_root_neurites(vNeurites, nd.pos, nd.rad, vRootNeuriteIndsOut, &erScaleFactor,
+		anisotropy, g, sh, aSP);
 
 	// at branching points, we have not computed the correct positions yet,
 	// so project the complete geometry using the projector
@@ -3131,7 +3387,6 @@ void import_er_neurites_from_swc
 	sh.set_subset_name("erm", 3);
 
 	// output
-	std::string outFileNameBase = FilenameAndPathWithoutExtension(fileNameOut);
 	std::string outFileName = outFileNameBase + ".ugx";
 	GridWriterUGX ugxWriter;
 	ugxWriter.add_grid(g, "defGrid", aPosition);
@@ -3142,7 +3397,10 @@ void import_er_neurites_from_swc
 		UG_THROW("Grid could not be written to file '" << outFileName << "'.");
 
 	if (numRefs == 0)
+	{
+		mesh_cache_store(cacheKey, vOutFileNames);
 		return;
+	}
 
 	// refinement
 	Domain3d dom;
@@ -3167,15 +3425,17 @@ void import_er_neurites_from_swc
 		try {SaveGridHierarchyTransformed(*dom.grid(), *dom.subset_handler(), curFileName.c_str(), offset);}
 		UG_CATCH_THROW("Grid could not be written to file '" << curFileName << "'.");
 	}
+
+	mesh_cache_store(cacheKey, vOutFileNames);
 }
 
 
 
-void import_1d_neurites_from_swc
+static void import_1d_neurites
 (
 	const std::string& fileNameIn,
 	const std::string& fileNameOut,
-	number anisotropy,
+	const SegmentLengthRule& segRule,
 	size_t numRefs,
 	number scale
 )
@@ -3185,9 +3445,8 @@ void import_1d_neurites_from_swc
 	UG_COND_THROW(inFileName == "", "File '" << fileNameIn
 		<< "' could not be located in standard paths.");
 
-	FileReaderSWC swcFileReader;
-	swcFileReader.load_file(inFileName.c_str());
-	std::vector<swc_types::SWCPoint>& vPoints = swcFileReader.swc_points();
+	std::vector<swc_types::SWCPoint> vPoints;
+	load_swc_points(inFileName, vPoints);
 
 	// scale
 	const size_t sz = vPoints.size();
@@ -3201,12 +3460,10 @@ void import_1d_neurites_from_swc
 	//smoothing(vPoints, 5, 1.0, 1.0);
 
 	// convert intermediate structure to neurite data
-	std::vector<std::vector<vector3> > vPos;
-	std::vector<std::vector<number> > vRad;
-	std::vector<std::vector<std::pair<size_t, std::vector<size_t> > > > vBPInfo;
+	NeuriteData nd;
 	std::vector<size_t> vRootNeuriteIndsOut;
 
-	convert_pointlist_to_neuritelist(vPoints, vPos, vRad, vBPInfo, vRootNeuriteIndsOut);
+	convert_pointlist_to_neuritelist(vPoints, nd, vRootNeuriteIndsOut);
 
 	// prepare grid and projector
 	Grid g;
@@ -3244,12 +3501,15 @@ void import_1d_neurites_from_swc
 
 	// create spline data
 	std::vector<NeuriteProjector::Neurite>& vNeurites = neuriteProj->neurites();
-	create_spline_data_for_neurites(vNeurites, vPos, vRad, &vBPInfo);
+	create_spline_data_for_neurites(vNeurites, nd);
 
 	// create coarse grid
 	for (size_t i = 0; i < vRootNeuriteIndsOut.size(); ++i)
-		create_neurite_1d(vNeurites, vPos, vRad, vRootNeuriteIndsOut[i],
-			anisotropy, g, aaPos, aaSurfParams, aaDiam, NULL);
+		create_neurite_1d(vNeurites, nd.pos, nd.rad, vRootNeuriteIndsOut[i],
+			segRule, g, aaPos, aaSurfParams, aaDiam, NULL);
+
+	UG_LOGN("Created 1d grid with " << g.num<Vertex>() << " vertices and "
+		<< g.num<Edge>() << " edges.");
 
 
 	// subsets
@@ -3290,6 +3550,42 @@ void import_1d_neurites_from_swc
 }
 
 
+void import_1d_neurites_from_swc
+(
+	const std::string& fileNameIn,
+	const std::string& fileNameOut,
+	number anisotropy,
+	size_t numRefs,
+	number scale
+)
+{
+	import_1d_neurites(fileNameIn, fileNameOut, SegmentLengthRule::anisotropy(anisotropy),
+		numRefs, scale);
+}
+
+
+void import_1d_neurites_from_swc_electrotonic
+(
+	const std::string& fileNameIn,
+	const std::string& fileNameOut,
+	number dLambda,
+	number frequency,
+	number specAxialRes,
+	number specCap,
+	size_t numRefs,
+	number scale
+)
+{
+	UG_COND_THROW(dLambda <= 0.0, "Fraction of the length constant must be positive.");
+	UG_COND_THROW(frequency <= 0.0 || specAxialRes <= 0.0 || specCap <= 0.0,
+		"Frequency, specific axial resistance and specific capacitance must be positive.");
+
+	import_1d_neurites(fileNameIn, fileNameOut,
+		SegmentLengthRule::electrotonic(dLambda, frequency, specAxialRes, specCap),
+		numRefs, scale);
+}
+
+
 
 
 } // namespace neurites_from_swc
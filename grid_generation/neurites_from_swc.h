@@ -170,6 +170,41 @@ void import_1d_neurites_from_swc
 );
 
 
+/**
+ * @brief Generates a 1d grid from an SWC file, discretized by electrotonic length
+ *
+ * Same as import_1d_neurites_from_swc, but the edge lengths are chosen according
+ * to the local AC length constant lambda_f = sqrt(r / (2 pi f Ra Cm)) instead of
+ * the radius: For each section between branching points, the smallest number of
+ * equally long (in terms of electrotonic length) edges is used such that no edge
+ * is longer than dLambda * lambda_f (d_lambda rule). This gives fewer vertices in
+ * thick, electrotonically compact dendrites and more in thin ones.
+ *
+ * The membrane parameters have to be given in units consistent with the scaled
+ * geometry (SI units for the default scale).
+ *
+ * @param fileNameIn    input file (SWC)
+ * @param fileNameOut   output file (UGX)
+ * @param dLambda       maximal edge length as a fraction of lambda_f
+ * @param frequency     frequency f for the length constant (Hz)
+ * @param specAxialRes  specific axial resistance Ra (Ohm m)
+ * @param specCap       specific membrane capacitance Cm (F/m^2)
+ * @param numRefs       number of isotropic refinements to perform
+ * @param scale         factor for final scaling of the geometry
+ */
+void import_1d_neurites_from_swc_electrotonic
+(
+	const std::string& fileNameIn,
+	const std::string& fileNameOut,
+	number dLambda = 0.1,
+	number frequency = 100.0,
+	number specAxialRes = 1.0,
+	number specCap = 1e-2,
+	size_t numRefs = 0,
+	number scale = 1e-6
+);
+
+
 } // namespace neurites_from_swc
 } // namespace neuro_collection
 } // namespace ug
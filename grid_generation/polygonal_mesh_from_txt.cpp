@@ -38,8 +38,9 @@
  */
 
 #include "polygonal_mesh_from_txt.h"
+#include "text_scanner.h"
 #include "lib_grid/lib_grid.h"
-#include <fstream>
+#include <cstring>
 #include "common/math/ugmath_types.h"
 #include "lib_grid/refinement/regular_refinement.h"
 #include "lib_grid/algorithms/remeshing/delaunay_triangulation.h"
@@ -57,31 +58,102 @@ namespace ug {
 			const ug::vector3& p3,
 			const ug::vector3& p4
 		) {
-			/// setup grid
 			Grid g;
 			SubsetHandler sh(g);
+			polygonal_mesh_from_txt(fileName, p1, p2, p3, p4, g, sh);
+
+			/// save grid
+			std::string outFileName = FilenameWithoutExtension(fileName) + ".ugx";
+			SaveGridToFile(g, sh, outFileName.c_str());
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// read_polygon_txt
+		////////////////////////////////////////////////////////////////////////
+		void read_polygon_txt
+		(
+			const std::string& fileName,
+			std::vector<vector3>& vPosOut
+		) {
+			vPosOut.clear();
+
+			FileBuffer buf(fileName);
+			const char* p = buf.begin();
+			const char* const end = buf.end();
+
+			/// counting pass: one point per line is the usual layout
+			size_t nLines = 1;
+			for (const char* q = p; q != end; ++nLines) {
+				q = static_cast<const char*>(memchr(q, '\n', end - q));
+				if (!q) break;
+				++q;
+			}
+			vPosOut.reserve(nLines);
+
+			/// coordinates are whitespace-separated (x y pairs may span lines)
+			number coord[2];
+			size_t nCoords = 0;
+			size_t lineCnt = 0;
+			while (p != end) {
+				++lineCnt;
+				const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+				if (!lineEnd) lineEnd = end;
+
+				LineScanner scanner(p, lineEnd);
+				p = lineEnd == end ? end : lineEnd + 1;
+
+				while (!scanner.at_end()) {
+					UG_COND_THROW(!scanner.read_number(coord[nCoords]), "Error reading polygon file '"
+						<< fileName << "': Line " << lineCnt << " contains a token that is not a number.");
+					if (++nCoords == 2) {
+						vPosOut.push_back(vector3(coord[0], coord[1], 0.0));
+						nCoords = 0;
+					}
+				}
+			}
+			UG_COND_THROW(nCoords, "Error reading polygon file '" << fileName
+				<< "': Odd number of coordinates.");
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// polygonal_mesh_from_txt
+		////////////////////////////////////////////////////////////////////////
+		void polygonal_mesh_from_txt
+		(
+			const std::string& fileName,
+			const ug::vector3& p1,
+			const ug::vector3& p2,
+			const ug::vector3& p3,
+			const ug::vector3& p4,
+			Grid& g,
+			SubsetHandler& sh
+		) {
+			/// read polygon
+			std::vector<vector3> vPos;
+			read_polygon_txt(fileName, vPos);
+			UG_COND_THROW(vPos.size() < 3, "Polygon file '" << fileName
+				<< "' contains fewer than 3 points.");
+
+			/// setup grid
 			sh.set_default_subset_index(0);
-			g.attach_to_vertices(aPosition);
+			if (!g.has_vertex_attachment(aPosition))
+				g.attach_to_vertices(aPosition);
 			Grid::VertexAttachmentAccessor<APosition> aaPos(g, aPosition);
 			AInt aInt;
 			g.attach_to_vertices(aInt);
 			const size_t numRefs = 2;
 			const number minAngle = 20;
 
-			/// create vertices
-			double x, y;
-			const double z = 0;
-			std::vector<Vertex*> vertices;
-			std::ifstream infile(fileName.c_str());
-			while (infile >> x >> y)
-			{
-				Vertex* v = *g.create<RegularVertex>();
-				aaPos[v] = vector3(x, y, z);
-				vertices.push_back(v);
+			/// create vertices and edges (storage for all of them reserved at once)
+			const size_t nPts = vPos.size();
+			g.reserve<Vertex>(g.num<Vertex>() + nPts + 4);
+			g.reserve<Edge>(g.num<Edge>() + nPts + 4);
+			std::vector<Vertex*> vertices(nPts);
+			for (size_t i = 0; i < nPts; i++) {
+				vertices[i] = *g.create<RegularVertex>();
+				aaPos[vertices[i]] = vPos[i];
 			}
-
-			/// create edges
-			for (size_t i = 0; i < vertices.size()-1; i++) {
+			for (size_t i = 0; i < nPts-1; i++) {
 				*g.create<RegularEdge>(EdgeDescriptor(vertices[i], vertices[i+1]));
 			}
 			*g.create<RegularEdge>(EdgeDescriptor(vertices.front(), vertices.back()));
@@ -154,9 +226,7 @@ namespace ug {
 			sh.subset_info(5).name = "right";
 			sh.subset_info(6).name = "tower bnd";
 
-			/// save grid
-			std::string outFileName = FilenameWithoutExtension(fileName) + ".ugx";
-			SaveGridToFile(g, sh, outFileName.c_str());
+			g.detach_from_vertices(aInt);
 		}
 	} // neuro_collection
 } // ug
@@ -2,7 +2,10 @@
 #define UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__POLYGONAL_MESH_FROM_TXT_H
 
 #include <string>
+#include <vector>
 #include "common/math/ugmath_types.h"
+#include "lib_grid/grid/grid.h"
+#include "lib_grid/tools/subset_handler_grid.h"
 
 namespace ug {
 	namespace neuro_collection {
@@ -31,6 +34,36 @@ namespace ug {
 			const ug::vector3& p3,
 			const ug::vector3& p4
 		);
+
+		/*!
+		 * \brief same as above, but the grid is created in the given (empty)
+		 * grid and subset handler instead of being written to a UGX file
+		 */
+		void polygonal_mesh_from_txt
+		(
+			const std::string& fileName,
+			const ug::vector3& p1,
+			const ug::vector3& p2,
+			const ug::vector3& p3,
+			const ug::vector3& p4,
+			Grid& g,
+			SubsetHandler& sh
+		);
+
+		/*!
+		 * \brief reads the polygon points of a contour text file
+		 * The file contains whitespace-separated x y coordinate pairs (usually
+		 * one per line); '#' starts a comment. The file is memory-mapped (where
+		 * available) and parsed in one pass, storage for the points is reserved
+		 * from a first pass counting the lines.
+		 * \param[in] fileName  input file
+		 * \param[out] vPosOut  points (with z = 0)
+		 */
+		void read_polygon_txt
+		(
+			const std::string& fileName,
+			std::vector<ug::vector3>& vPosOut
+		);
 	} // neuro_collection
 } // ug
 
@@ -129,6 +129,27 @@ void BuildSpine
 	const std::vector<bool>& boolVector,
 	const std::string& fileName
 )
+{
+	// create grid and subset handler
+	Grid grid;
+	SubsetHandler sh(grid);
+	BuildSpine(paramVector, boolVector, grid, sh, fileName);
+
+	// write file
+	if (!SaveGridToFile(grid, sh, fileName.c_str()))
+		UG_THROW("Error while saving dendrite to file '" << fileName << "'");
+}
+
+
+
+void BuildSpine
+(
+	const std::vector<number>& paramVector,
+	const std::vector<bool>& boolVector,
+	Grid& grid,
+	SubsetHandler& sh,
+	const std::string& fileName
+)
 {
 	// geometric parameters
 	number cyt_radius = paramVector[0];
@@ -153,13 +174,11 @@ void BuildSpine
 
 
 
-	// create grid and subset handler
-	Grid grid;
-	SubsetHandler sh(grid);
 	sh.set_default_subset_index(0);
 
 	// setup coordinate attachments and accessors
-	grid.attach_to_vertices(aPosition);
+	if (!grid.has_vertex_attachment(aPosition))
+		grid.attach_to_vertices(aPosition);
 	Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPosition);
 
 	// prepare a selector
@@ -729,10 +748,6 @@ void BuildSpine
 		si.color.z() = col.z();
 		si.color.w() = 1.f;
 	}
-
-	// write file
-	if (!SaveGridToFile(grid, sh, fileName.c_str()))
-		UG_THROW("Error while saving dendrite to file '" << fileName << "'");
 }
 
 } // namespace ug
@@ -45,6 +45,8 @@
 #include <vector>
 
 #include "common/types.h"  // for number
+#include "lib_grid/grid/grid.h"  // for Grid
+#include "lib_grid/tools/subset_handler_grid.h"  // for SubsetHandler
 
 
 namespace ug {
@@ -92,6 +94,24 @@ void BuildSpine
 	const std::string& fileName
 );
 
+/**
+ * \brief Builds a 3D spine geometry in memory
+ *
+ * Same as above, but the geometry is created in the given (empty) grid and
+ * subset handler instead of being written to a file.
+ *
+ * \param fileName  Base name for the intermediate files written in debug mode
+ *                  (DG_DEBUG) only.
+ */
+void BuildSpine
+(
+	const std::vector<number>& paramVector,
+	const std::vector<bool>& boolVector,
+	Grid& grid,
+	SubsetHandler& sh,
+	const std::string& fileName = "spine"
+);
+
 
 } // namespace ug
 
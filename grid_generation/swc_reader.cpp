@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "swc_reader.h"
+
+#include <algorithm>                                             // for max
+#include <cstring>                                               // for memchr
+#include <map>                                                   // for map
+#include <sstream>                                               // for ostringstream
+
+#include "common/error.h"                                        // for UG_THROW, UG_COND_THROW
+#include "lib_grid/algorithms/subset_color_util.h"               // for AssignSubsetColors
+#include "lib_grid/algorithms/subset_util.h"                     // for EraseEmptySubsets
+#include "lib_grid/global_attachments.h"                         // for GlobalAttachments
+#include "text_scanner.h"                                        // for FileBuffer, LineScanner
+
+
+namespace ug {
+namespace neuro_collection {
+namespace neurites_from_swc {
+
+
+namespace {
+
+/// maps SWC point IDs to point indices (dense for the usual consecutive IDs)
+class SWCIndexMap
+{
+	public:
+		explicit SWCIndexMap(size_t expectedSize)
+		: m_maxDense(4*expectedSize + 1024) {}
+
+		void insert(long id, size_t ind)
+		{
+			if (id >= 0 && (size_t) id < m_maxDense)
+			{
+				if ((size_t) id >= m_vDense.size())
+					m_vDense.resize(std::max((size_t) id + 1, 2*m_vDense.size()), (size_t) -1);
+				m_vDense[id] = ind;
+			}
+			else
+				m_sparse[id] = ind;
+		}
+
+		bool find(long id, size_t& indOut) const
+		{
+			if (id >= 0 && (size_t) id < m_maxDense)
+			{
+				if ((size_t) id >= m_vDense.size() || m_vDense[id] == (size_t) -1)
+					return false;
+				indOut = m_vDense[id];
+				return true;
+			}
+
+			std::map<long, size_t>::const_iterator it = m_sparse.find(id);
+			if (it == m_sparse.end())
+				return false;
+			indOut = it->second;
+			return true;
+		}
+
+	private:
+		size_t m_maxDense;
+		std::vector<size_t> m_vDense;
+		std::map<long, size_t> m_sparse;
+};
+
+
+static swc_types::SWCType swc_type_from_int(long type)
+{
+	switch (type)
+	{
+		case 0: return swc_types::SWC_UNDF;
+		case 1: return swc_types::SWC_SOMA;
+		case 2: return swc_types::SWC_AXON;
+		case 3: return swc_types::SWC_DEND;
+		case 4: return swc_types::SWC_APIC;
+		case 5: return swc_types::SWC_FORK;
+		case 6: return swc_types::SWC_END;
+		default: return swc_types::SWC_CUSTOM;
+	}
+}
+
+
+/// counts the lines of a buffer (an upper bound for the number of points)
+static size_t count_lines(const char* p, const char* const end)
+{
+	size_t nLines = 1;
+	for (const char* q = p; q != end; ++nLines)
+	{
+		q = static_cast<const char*>(memchr(q, '\n', end - q));
+		if (!q) break;
+		++q;
+	}
+	return nLines;
+}
+
+} // anonymous namespace
+
+
+
+void load_swc_points
+(
+	const std::string& fileName,
+	std::vector<swc_types::SWCPoint>& vPtsOut
+)
+{
+	vPtsOut.clear();
+
+	FileBuffer buf(fileName);
+	const char* p = buf.begin();
+	const char* const end = buf.end();
+
+	// reserve once, so points (with their connection vectors) are never copied
+	const size_t nLines = count_lines(p, end);
+	vPtsOut.reserve(nLines);
+
+	SWCIndexMap indexMap(nLines);
+	size_t lineCnt = 0;
+	while (p != end)
+	{
+		++lineCnt;
+		const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+		if (!lineEnd) lineEnd = end;
+
+		LineScanner scanner(p, lineEnd);
+		p = lineEnd == end ? end : lineEnd + 1;
+
+		// empty lines and comments can be ignored
+		if (scanner.at_end())
+			continue;
+
+		long id, type, conn;
+		number x, y, z, r;
+		UG_COND_THROW(!(scanner.read_int(id) && scanner.read_int(type)
+			&& scanner.read_number(x) && scanner.read_number(y) && scanner.read_number(z)
+			&& scanner.read_number(r) && scanner.read_int(conn) && scanner.at_end()),
+			"Error reading SWC file '" << fileName << "': Line " << lineCnt
+			<< " does not contain exactly 7 values of the expected types.");
+
+		const size_t curInd = vPtsOut.size();
+		indexMap.insert(id, curInd);
+
+		vPtsOut.resize(curInd + 1);
+		swc_types::SWCPoint& pt = vPtsOut.back();
+		pt.type = swc_type_from_int(type);
+		pt.coords.x() = x;
+		pt.coords.y() = y;
+		pt.coords.z() = z;
+		pt.radius = r;
+
+		if (conn >= 0)
+		{
+			size_t parentInd;
+			UG_COND_THROW(!indexMap.find(conn, parentInd), "Error reading SWC file '" << fileName
+				<< "': Line " << lineCnt << " refers to unknown parent index " << conn << ".");
+
+			pt.conns.push_back(parentInd);
+			vPtsOut[parentInd].conns.push_back(curInd);
+		}
+	}
+}
+
+
+
+void load_swc_points
+(
+	const std::vector<std::string>& vFileNames,
+	std::vector<std::vector<swc_types::SWCPoint> >& vvPtsOut
+)
+{
+	const size_t nFiles = vFileNames.size();
+	vvPtsOut.clear();
+	vvPtsOut.resize(nFiles);
+
+	std::vector<std::string> vErrors(nFiles);
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (long i = 0; i < (long) nFiles; ++i)
+	{
+		try {load_swc_points(vFileNames[i], vvPtsOut[i]);}
+		catch (const UGError& err) {vErrors[i] = err.get_msg();}
+		catch (const std::exception& ex) {vErrors[i] = ex.what();}
+	}
+
+	std::ostringstream oss;
+	for (size_t i = 0; i < nFiles; ++i)
+		if (!vErrors[i].empty())
+			oss << "\n  " << vErrors[i];
+	UG_COND_THROW(!oss.str().empty(), "Errors reading SWC batch:" << oss.str());
+}
+
+
+
+
+void swc_file_to_grid
+(
+	const std::string& fileName,
+	Grid& g,
+	SubsetHandler& sh,
+	number scale_length
+)
+{
+	if (!g.has_vertex_attachment(aPosition))
+		g.attach_to_vertices(aPosition);
+	Grid::VertexAttachmentAccessor<APosition> aaPos(g, aPosition);
+
+	ANumber aDiam = GlobalAttachments::attachment<ANumber>("diameter");
+	if (!g.has_vertex_attachment(aDiam))
+		g.attach_to_vertices(aDiam);
+	Grid::AttachmentAccessor<Vertex, ANumber> aaDiam(g, aDiam);
+
+	FileBuffer buf(fileName);
+	const char* p = buf.begin();
+	const char* const end = buf.end();
+
+	// a tree has one edge less than it has vertices
+	const size_t nLines = count_lines(p, end);
+	g.reserve<Vertex>(g.num_vertices() + nLines);
+	g.reserve<Edge>(g.num_edges() + nLines);
+
+	std::vector<Vertex*> vrts;
+	vrts.reserve(nLines);
+
+	SWCIndexMap indexMap(nLines);
+	size_t lineCnt = 0;
+	while (p != end)
+	{
+		++lineCnt;
+		const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+		if (!lineEnd) lineEnd = end;
+
+		LineScanner scanner(p, lineEnd);
+		p = lineEnd == end ? end : lineEnd + 1;
+
+		// empty lines and comments can be ignored
+		if (scanner.at_end())
+			continue;
+
+		long id, type, conn;
+		number x, y, z, r;
+		UG_COND_THROW(!(scanner.read_int(id) && scanner.read_int(type)
+			&& scanner.read_number(x) && scanner.read_number(y) && scanner.read_number(z)
+			&& scanner.read_number(r) && scanner.read_int(conn) && scanner.at_end()),
+			"Error reading SWC file '" << fileName << "': Line " << lineCnt
+			<< " does not contain exactly 7 values of the expected types.");
+
+		indexMap.insert(id, vrts.size());
+
+		Vertex* v = *g.create<RegularVertex>();
+		vrts.push_back(v);
+		aaPos[v] = vector3(scale_length * x, scale_length * y, scale_length * z);
+		sh.assign_subset(v, swc_type_from_int(type) - 1);
+		aaDiam[v] = 2 * r * scale_length;
+
+		if (conn >= 0)
+		{
+			size_t parentInd;
+			UG_COND_THROW(!indexMap.find(conn, parentInd), "Error reading SWC file '" << fileName
+				<< "': Line " << lineCnt << " refers to unknown parent index " << conn << ".");
+
+			Vertex* parent = vrts[parentInd];
+			Edge* e = *g.create<RegularEdge>(EdgeDescriptor(parent, v));
+			sh.assign_subset(e, sh.get_subset_index(parent));
+		}
+	}
+
+	// final subset managment
+	AssignSubsetColors(sh);
+	sh.set_subset_name("soma", 0);
+	sh.set_subset_name("axon", 1);
+	sh.set_subset_name("dend", 2);
+	sh.set_subset_name("apic", 3);
+	sh.set_subset_name("fork", 4);
+	sh.set_subset_name("end", 5);
+	sh.set_subset_name("custom", 6);
+	EraseEmptySubsets(sh);
+}
+
+
+} // namespace neurites_from_swc
+} // namespace neuro_collection
+} // namespace ug
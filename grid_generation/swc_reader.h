@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__SWC_READER_H
+#define UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__SWC_READER_H
+
+#include <string>                                                // for string
+#include <vector>                                                // for vector
+
+#include "common/types.h"                                         // for number
+#include "lib_grid/file_io/file_io_swc.h"                        // for swc_types::SWCPoint
+#include "lib_grid/grid/grid.h"                                  // for Grid
+#include "lib_grid/tools/subset_handler_grid.h"                  // for SubsetHandler
+
+
+namespace ug {
+namespace neuro_collection {
+namespace neurites_from_swc {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/**
+ * @brief Reads the points of an SWC file
+ *
+ * Drop-in replacement for FileReaderSWC::load_file() for large reconstructions:
+ * The file is memory-mapped (where available) and parsed in one pass by a
+ * hand-written number scanner, without any stream or string copies of the lines.
+ * The resulting point list is identical to that of FileReaderSWC, i.e., points
+ * are stored in file order, connections are stored symmetrically as indices
+ * into the list and types other than soma, axon, dendrite and apical dendrite
+ * are mapped to undefined.
+ *
+ * @param fileName   name of the SWC file (must exist; no search in standard paths)
+ * @param vPtsOut    points read from the file
+ */
+void load_swc_points
+(
+	const std::string& fileName,
+	std::vector<swc_types::SWCPoint>& vPtsOut
+);
+
+/**
+ * @brief Reads the points of a batch of SWC files
+ *
+ * The files are parsed in parallel (if compiled with OpenMP).
+ * Errors in any of the files are reported after all files have been processed.
+ *
+ * @param vFileNames  names of the SWC files
+ * @param vvPtsOut    points read from each of the files
+ */
+void load_swc_points
+(
+	const std::vector<std::string>& vFileNames,
+	std::vector<std::vector<swc_types::SWCPoint> >& vvPtsOut
+);
+
+/**
+ * @brief Creates the 1d grid of an SWC file without intermediate point list
+ *
+ * Streaming counterpart to load_swc_points() followed by swc_points_to_grid()
+ * for large 1d networks: Vertices and edges are created while the file is
+ * being parsed, only a map from point IDs to vertices is held in memory.
+ * The result is identical to that of the two-step approach: Vertices are
+ * assigned the subset of their SWC type minus one, edges that of their parent
+ * vertex, diameters are stored in the global "diameter" attachment and
+ * subsets are named soma, axon, dend, apic, fork, end, custom.
+ *
+ * @param fileName      name of the SWC file (must exist; no search in standard paths)
+ * @param g             grid to create the network in
+ * @param sh            subset handler for the grid
+ * @param scale_length  scale factor for coordinates and diameters
+ */
+void swc_file_to_grid
+(
+	const std::string& fileName,
+	Grid& g,
+	SubsetHandler& sh,
+	number scale_length = 1.0
+);
+
+///@}
+
+} // namespace neurites_from_swc
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__SWC_READER_H
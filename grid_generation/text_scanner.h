@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__TEXT_SCANNER_H
+#define UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__TEXT_SCANNER_H
+
+#include <cstdio>                                                // for FILE, fopen, fread
+#include <cstdlib>                                               // for strtod
+#include <string>                                                // for string
+#include <vector>                                                // for vector
+
+#include "common/error.h"                                        // for UG_COND_THROW
+#include "common/types.h"                                        // for number
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <fcntl.h>                                           // for open
+	#include <sys/mman.h>                                        // for mmap, munmap
+	#include <sys/stat.h>                                        // for fstat
+	#include <unistd.h>                                          // for close
+	#define NC_TEXT_SCANNER_USE_MMAP
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+// Fast reading of large text-based geometry files (SWC, contour point lists).
+
+/// read-only view of the complete contents of a file (memory-mapped if possible)
+class FileBuffer
+{
+	public:
+		explicit FileBuffer(const std::string& fileName)
+		: m_data(NULL), m_size(0), m_bMapped(false)
+		{
+#ifdef NC_TEXT_SCANNER_USE_MMAP
+			int fd = open(fileName.c_str(), O_RDONLY);
+			if (fd != -1)
+			{
+				struct stat st;
+				if (fstat(fd, &st) == 0 && st.st_size > 0)
+				{
+					void* p = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (p != MAP_FAILED)
+					{
+						m_data = static_cast<const char*>(p);
+						m_size = (size_t) st.st_size;
+						m_bMapped = true;
+						madvise(p, m_size, MADV_SEQUENTIAL);
+					}
+				}
+				close(fd);
+				if (m_bMapped)
+					return;
+			}
+#endif
+			// fallback: read into memory
+			FILE* f = fopen(fileName.c_str(), "rb");
+			UG_COND_THROW(!f, "Input file '" << fileName << "' could not be opened for reading.");
+
+			char chunk[65536];
+			size_t n;
+			while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+				m_vBuf.insert(m_vBuf.end(), chunk, chunk + n);
+			const bool ok = !ferror(f);
+			fclose(f);
+			UG_COND_THROW(!ok, "Input file '" << fileName << "' could not be read.");
+
+			m_data = m_vBuf.empty() ? NULL : &m_vBuf[0];
+			m_size = m_vBuf.size();
+		}
+
+		~FileBuffer()
+		{
+#ifdef NC_TEXT_SCANNER_USE_MMAP
+			if (m_bMapped)
+				munmap(const_cast<char*>(m_data), m_size);
+#endif
+		}
+
+		const char* begin() const {return m_data;}
+		const char* end() const {return m_data + m_size;}
+		size_t size() const {return m_size;}
+
+	private:
+		// non-copyable
+		FileBuffer(const FileBuffer&);
+		FileBuffer& operator=(const FileBuffer&);
+
+	private:
+		const char* m_data;
+		size_t m_size;
+		bool m_bMapped;
+		std::vector<char> m_vBuf;
+};
+
+
+/// scanner for the whitespace-separated tokens of one line ('#' starts a comment)
+class LineScanner
+{
+	public:
+		LineScanner(const char* begin, const char* end)
+		: m_p(begin), m_end(end) {}
+
+		/// whether the line has no more tokens (end or comment reached)
+		bool at_end()
+		{
+			skip_blanks();
+			return m_p == m_end || *m_p == '#';
+		}
+
+		/// reads an integer
+		bool read_int(long& iOut)
+		{
+			skip_blanks();
+			const char* p = m_p;
+			bool neg = false;
+			if (p != m_end && (*p == '-' || *p == '+'))
+				neg = *p++ == '-';
+
+			if (p == m_end || !is_digit(*p))
+				return false;
+
+			long i = 0;
+			for (; p != m_end && is_digit(*p); ++p)
+				i = 10*i + (*p - '0');
+
+			if (!token_ends(p))
+				return false;
+
+			iOut = neg ? -i : i;
+			m_p = p;
+			return true;
+		}
+
+		/**
+		 * @brief reads a floating-point number
+		 * Numbers with at most 15 significant digits and decimal exponents of at
+		 * most 22 (which is virtually every number found in traced geometries) are exactly
+		 * converted here; everything else is handed to strtod.
+		 */
+		bool read_number(number& xOut)
+		{
+			skip_blanks();
+			const char* tokBegin = m_p;
+			const char* p = m_p;
+			bool neg = false;
+			if (p != m_end && (*p == '-' || *p == '+'))
+				neg = *p++ == '-';
+
+			unsigned long long mant = 0;
+			int nSigDigits = 0;
+			int exp10 = 0;
+			bool anyDigit = false;
+			bool exact = true;
+
+			for (; p != m_end && is_digit(*p); ++p)
+			{
+				anyDigit = true;
+				if (mant == 0 && *p == '0') continue;
+				if (nSigDigits < 19) {mant = 10*mant + (*p - '0'); ++nSigDigits;}
+				else {++exp10; exact = false;}
+			}
+			if (p != m_end && *p == '.')
+			{
+				for (++p; p != m_end && is_digit(*p); ++p)
+				{
+					anyDigit = true;
+					if (mant == 0 && *p == '0') {--exp10; continue;}
+					if (nSigDigits < 19) {mant = 10*mant + (*p - '0'); ++nSigDigits; --exp10;}
+					else exact = false;
+				}
+			}
+			if (!anyDigit)
+				return false;
+
+			if (p != m_end && (*p == 'e' || *p == 'E'))
+			{
+				++p;
+				bool expNeg = false;
+				if (p != m_end && (*p == '-' || *p == '+'))
+					expNeg = *p++ == '-';
+				if (p == m_end || !is_digit(*p))
+					return false;
+				int e = 0;
+				for (; p != m_end && is_digit(*p); ++p)
+					if (e < 10000) e = 10*e + (*p - '0');
+				exp10 += expNeg ? -e : e;
+			}
+
+			if (!token_ends(p))
+				return false;
+
+			double x;
+			if (exact && nSigDigits <= 15 && exp10 >= -22 && exp10 <= 22)
+			{
+				x = (double) mant;
+				if (exp10 < 0) x /= pow10(-exp10);
+				else x *= pow10(exp10);
+				if (neg) x = -x;
+			}
+			else
+			{
+				// slow path, correct rounding is left to the C library
+				const std::string tok(tokBegin, p);
+				x = strtod(tok.c_str(), NULL);
+			}
+
+			xOut = (number) x;
+			m_p = p;
+			return true;
+		}
+
+	private:
+		/// exactly representable powers of ten (for the fast path of number scanning)
+		static double pow10(int e)
+		{
+			static const double s_pow10[] =
+			{
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+			};
+			return s_pow10[e];
+		}
+
+		static bool is_digit(char c) {return c >= '0' && c <= '9';}
+		static bool is_blank(char c) {return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';}
+
+		bool token_ends(const char* p) const {return p == m_end || is_blank(*p) || *p == '#';}
+
+		void skip_blanks()
+		{
+			while (m_p != m_end && is_blank(*m_p))
+				++m_p;
+		}
+
+	private:
+		const char* m_p;
+		const char* m_end;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__TEXT_SCANNER_H
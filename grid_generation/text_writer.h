@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__TEXT_WRITER_H
+#define UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__TEXT_WRITER_H
+
+#include <cmath>                                                 // for floor
+#include <cstdio>                                                // for FILE, fopen, fwrite, snprintf
+#include <cstring>                                               // for strlen, memcpy
+#include <string>                                                // for string
+#include <vector>                                                // for vector
+
+#include "common/error.h"                                        // for UG_COND_THROW
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/**
+ * @brief Buffered text file output with fast formatting of numbers
+ *
+ * Counterpart of FileBuffer/LineScanner (text_scanner.h) for writing large
+ * text-based geometry files: Output is collected in a large buffer and written
+ * in blocks; integers and floating-point numbers are formatted by hand instead
+ * of by streams.
+ */
+class TextFileWriter
+{
+	public:
+		explicit TextFileWriter(const std::string& fileName)
+		: m_fileName(fileName), m_f(fopen(fileName.c_str(), "wb")), m_vBuf(1 << 20), m_pos(0), m_bError(false)
+		{
+			UG_COND_THROW(!m_f, "Could not open output file '" << fileName << "'.");
+		}
+
+		~TextFileWriter()
+		{
+			if (m_f)
+			{
+				flush();
+				fclose(m_f);
+			}
+		}
+
+		/// write remaining output and close the file
+		void close()
+		{
+			flush();
+			const bool ok = fclose(m_f) == 0 && !m_bError;
+			m_f = NULL;
+			UG_COND_THROW(!ok, "Output file '" << m_fileName << "' could not be written.");
+		}
+
+		TextFileWriter& put(char c)
+		{
+			reserve(1);
+			m_vBuf[m_pos++] = c;
+			return *this;
+		}
+
+		TextFileWriter& put(const char* s)
+		{
+			const size_t n = strlen(s);
+			if (n > m_vBuf.size())
+			{
+				flush();
+				m_bError |= fwrite(s, 1, n, m_f) != n;
+				return *this;
+			}
+			reserve(n);
+			memcpy(&m_vBuf[m_pos], s, n);
+			m_pos += n;
+			return *this;
+		}
+
+		TextFileWriter& put_int(long i)
+		{
+			reserve(24);
+			unsigned long u = i < 0 ? 0ul - (unsigned long) i : (unsigned long) i;
+			if (i < 0)
+				m_vBuf[m_pos++] = '-';
+
+			char d[24];
+			int n = 0;
+			do {d[n++] = (char) ('0' + u % 10); u /= 10;} while (u);
+			while (n)
+				m_vBuf[m_pos++] = d[--n];
+			return *this;
+		}
+
+		/**
+		 * @brief writes a floating-point number as printf("%g") does (6 significant digits)
+		 * Numbers with magnitudes in [1e-4, 1e6) are formatted here (unless they are
+		 * too close to a rounding tie to be sure about the last digit); everything
+		 * else is handed to snprintf.
+		 */
+		TextFileWriter& put_number(double x)
+		{
+			reserve(32);
+			const double a = x < 0 ? -x : x;
+			if (a >= 1e-4 && a < 1e6)
+			{
+				// decimal exponent e with 10^e <= a < 10^(e+1)
+				static const double pow10[] = {1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+					1e7, 1e8, 1e9};
+				int e = -4;
+				while (a >= pow10[e + 5]) ++e;
+
+				// six significant digits
+				const double scaled = a * pow10[9 - e];
+				const double fl = floor(scaled);
+				const double frac = scaled - fl;
+				unsigned long m = (unsigned long) fl + (frac >= 0.5 ? 1 : 0);
+				if (m == 1000000ul) {m = 100000ul; ++e;}
+				if (frac - 0.5 > 1e-6 || 0.5 - frac > 1e-6)
+				{
+					if (m >= 100000ul && e < 6)
+					{
+						char d[6];
+						for (int k = 5; k >= 0; --k) {d[k] = (char) ('0' + m % 10); m /= 10;}
+						int last = 5;
+						if (x < 0)
+							m_vBuf[m_pos++] = '-';
+						if (e >= 0)
+						{
+							for (int k = 0; k <= e; ++k)
+								m_vBuf[m_pos++] = d[k];
+							while (last > e && d[last] == '0') --last;
+							if (last > e)
+							{
+								m_vBuf[m_pos++] = '.';
+								for (int k = e + 1; k <= last; ++k)
+									m_vBuf[m_pos++] = d[k];
+							}
+						}
+						else
+						{
+							m_vBuf[m_pos++] = '0';
+							m_vBuf[m_pos++] = '.';
+							for (int k = -1; k > e; --k)
+								m_vBuf[m_pos++] = '0';
+							while (d[last] == '0') --last;
+							for (int k = 0; k <= last; ++k)
+								m_vBuf[m_pos++] = d[k];
+						}
+						return *this;
+					}
+				}
+			}
+
+			// slow path
+			m_pos += snprintf(&m_vBuf[m_pos], 32, "%g", x);
+			return *this;
+		}
+
+	private:
+		void reserve(size_t n)
+		{
+			if (m_vBuf.size() - m_pos < n)
+				flush();
+		}
+
+		void flush()
+		{
+			if (m_pos)
+				m_bError |= fwrite(&m_vBuf[0], 1, m_pos, m_f) != m_pos;
+			m_pos = 0;
+		}
+
+		// non-copyable
+		TextFileWriter(const TextFileWriter&);
+		TextFileWriter& operator=(const TextFileWriter&);
+
+	private:
+		std::string m_fileName;
+		FILE* m_f;
+		std::vector<char> m_vBuf;
+		size_t m_pos;
+		bool m_bError;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__GRID_GENERATION__TEXT_WRITER_H
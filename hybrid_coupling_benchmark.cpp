@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "hybrid_coupling_benchmark.h"
+
+#include "common/stopwatch.h"  // Stopwatch
+
+#include <fstream>   // std::ofstream
+#include <iomanip>   // std::setw
+#include <sstream>   // std::ostringstream
+
+#ifdef UG_PARALLEL
+#include "pcl/pcl_base.h"  // NumProcs, ProcRank
+#endif
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TDomain>
+HybridCouplingBenchmark<TDomain>::HybridCouplingBenchmark
+(
+	SmartPtr<ApproximationSpace<TDomain> > spApprox3d,
+	SmartPtr<ApproximationSpace<TDomain> > spApprox1d,
+	SmartPtr<synh_type> spSH,
+	const std::string& potFct
+)
+: m_spHNC(make_sp(new hnc_type(spApprox3d, spApprox1d))),
+  m_numReps(10),
+  m_synTime(0.0)
+{
+	UG_COND_THROW(!spSH.valid(), "Invalid synapse handler given.");
+
+	size_t potFctInd;
+	try {potFctInd = spApprox1d->fct_id_by_name(potFct.c_str());}
+	UG_CATCH_THROW("Potential function '" << potFct << "' not defined in 1d approximation space.");
+
+	// resting potential on the 1d grid
+	m_spU1d = make_sp(new grid_function_type(spApprox1d));
+	m_spU1d->set(-0.065);
+
+	m_spHNC->set_synapse_handler(spSH);
+	m_spHNC->set_solution_and_potential_index(m_spU1d, potFctInd);
+}
+
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::set_potential_subsets(const std::vector<std::string>& vSubset)
+{
+	m_spHNC->set_potential_subsets(vSubset);
+}
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::set_current_subsets(const std::vector<std::string>& vSubset)
+{
+	m_spHNC->set_current_subsets(vSubset);
+}
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::set_neuron_ids(const std::vector<uint>& vNid)
+{
+	m_spHNC->set_neuron_ids(vNid);
+}
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::set_coordinate_scale_factor_3d_to_1d(number scale)
+{
+	m_spHNC->set_coordinate_scale_factor_3d_to_1d(scale);
+}
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::set_distributed_potential_mapping(bool distr)
+{
+	m_spHNC->set_distributed_potential_mapping(distr);
+}
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::set_distributed_synapse_mapping(bool distr)
+{
+	m_spHNC->set_distributed_synapse_mapping(distr);
+}
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::set_potential_edge_interpolation(bool edgeInterp)
+{
+	m_spHNC->set_potential_edge_interpolation(edgeInterp);
+}
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::set_num_repetitions(size_t numReps)
+{
+	UG_COND_THROW(!numReps, "At least one repetition is required.");
+	m_numReps = numReps;
+}
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::set_synapse_time(number time)
+{
+	m_synTime = time;
+}
+
+
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::barrier() const
+{
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator procComm;
+		procComm.barrier();
+	}
+#endif
+}
+
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::add_timing(const std::string& name, number locTime)
+{
+	PhaseTiming pt;
+	pt.name = name;
+	pt.max = pt.min = pt.avg = locTime;
+
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator procComm;
+		pt.max = procComm.allreduce(locTime, PCL_RO_MAX);
+		pt.min = procComm.allreduce(locTime, PCL_RO_MIN);
+		pt.avg = procComm.allreduce(locTime, PCL_RO_SUM) / pcl::NumProcs();
+	}
+#endif
+
+	m_vTiming.push_back(pt);
+}
+
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::run()
+{
+	m_vTiming.clear();
+	Stopwatch sw;
+	number t;
+
+	// potential mapping (forced to be computed from scratch each time)
+	t = 0.0;
+	for (size_t r = 0; r < m_numReps; ++r)
+	{
+		m_spHNC->m_bPotentialMappingNeedsUpdate = true;
+		m_spHNC->m_bFullPotentialRemapNeeded = true;
+		barrier();
+		sw.start();
+		m_spHNC->reinit_potential_mapping();
+		t += sw.ms();
+	}
+	add_timing("reinit_potential_mapping", 1e-3 * t / m_numReps);
+
+	// synapse mapping
+	t = 0.0;
+	for (size_t r = 0; r < m_numReps; ++r)
+	{
+		m_spHNC->m_bSynapseMappingNeedsUpdate = true;
+		barrier();
+		sw.start();
+		m_spHNC->reinit_synapse_mapping();
+		t += sw.ms();
+	}
+	add_timing("reinit_synapse_mapping", 1e-3 * t / m_numReps);
+
+	// potential value exchange (mappings are up to date now)
+	t = 0.0;
+	for (size_t r = 0; r < m_numReps; ++r)
+	{
+		barrier();
+		sw.start();
+		m_spHNC->coordinate_potential_values();
+		t += sw.ms();
+	}
+	add_timing("coordinate_potential_values", 1e-3 * t / m_numReps);
+
+	// synaptic currents
+	std::vector<MathVector<TDomain::dim> > vActSynPos;
+	std::vector<number> vSynCurr;
+	std::vector<synapse_id> vSynID;
+	t = 0.0;
+	for (size_t r = 0; r < m_numReps; ++r)
+	{
+		barrier();
+		sw.start();
+		m_spHNC->gather_synaptic_currents(vActSynPos, vSynCurr, vSynID, m_synTime);
+		t += sw.ms();
+	}
+	add_timing("gather_synaptic_currents", 1e-3 * t / m_numReps);
+}
+
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::print_report() const
+{
+	int numProcs = 1;
+#ifdef UG_PARALLEL
+	numProcs = pcl::NumProcs();
+	if (pcl::ProcRank() != 0)
+		return;
+#endif
+
+	UG_LOGN("Hybrid coupling benchmark on " << numProcs << " process(es), "
+		<< m_numReps << " repetition(s) per phase (times in ms):");
+	UG_LOGN(std::setw(30) << std::left << "phase" << std::right
+		<< std::setw(14) << "max" << std::setw(14) << "min"
+		<< std::setw(14) << "avg" << std::setw(12) << "max/avg");
+	for (size_t i = 0; i < m_vTiming.size(); ++i)
+	{
+		const PhaseTiming& pt = m_vTiming[i];
+		UG_LOGN(std::setw(30) << std::left << pt.name << std::right
+			<< std::setw(14) << 1e3 * pt.max << std::setw(14) << 1e3 * pt.min
+			<< std::setw(14) << 1e3 * pt.avg
+			<< std::setw(12) << (pt.avg > 0.0 ? pt.max / pt.avg : 1.0));
+	}
+}
+
+
+template <typename TDomain>
+void HybridCouplingBenchmark<TDomain>::write_json(const std::string& fileName, const std::string& label) const
+{
+	int numProcs = 1;
+#ifdef UG_PARALLEL
+	numProcs = pcl::NumProcs();
+	if (pcl::ProcRank() != 0)
+		return;
+#endif
+
+	std::ofstream ofs(fileName.c_str(), std::ios_base::app);
+	UG_COND_THROW(!ofs.is_open(), "Could not open benchmark output file '" << fileName << "'.");
+
+	for (size_t i = 0; i < m_vTiming.size(); ++i)
+	{
+		const PhaseTiming& pt = m_vTiming[i];
+		ofs << "{\"label\": \"" << label << "\", \"procs\": " << numProcs
+			<< ", \"phase\": \"" << pt.name << "\", \"repetitions\": " << m_numReps
+			<< ", \"max_s\": " << pt.max << ", \"min_s\": " << pt.min
+			<< ", \"avg_s\": " << pt.avg << "}" << std::endl;
+	}
+}
+
+
+
+// explicit template specializations
+#ifdef UG_DIM_3
+	template class HybridCouplingBenchmark<Domain3d>;
+#endif
+
+
+} // namespace neuro_collection
+} // namespace ug
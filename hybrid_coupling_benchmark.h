@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__HYBRID_COUPLING_BENCHMARK_H
+#define UG__PLUGINS__NEURO_COLLECTION__HYBRID_COUPLING_BENCHMARK_H
+
+#include <string>
+#include <vector>
+
+#include "hybrid_neuron_communicator.h"
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/**
+ * @brief Scaling benchmark for the communication phases of hybrid 1d/3d simulations
+ *
+ * The benchmark sets up a HybridNeuronCommunicator for a given pair of 1d and 3d
+ * approximation spaces (and synapse handler) and times its phases separately:
+ *   - reinit_potential_mapping (forced to a full remapping),
+ *   - reinit_synapse_mapping,
+ *   - coordinate_potential_values,
+ *   - gather_synaptic_currents.
+ * Each phase is executed a given number of times, every execution preceded by a barrier.
+ * Per phase, the average local time is reduced over all processes to its
+ * maximum, minimum and average, so that load imbalance can be read off directly.
+ *
+ * A weak scaling study is done by loading geometries whose size grows with the number
+ * of processes (e.g., replicated copies of the neuron in data/test.swc and data/test_1d.ugx),
+ * a strong scaling study by loading the same geometry for all process counts.
+ * Results can be appended to a JSON lines file, one object per phase and run.
+ *
+ * All methods except the setters are collective.
+ */
+template <typename TDomain>
+class HybridCouplingBenchmark
+{
+	protected:
+		typedef HybridNeuronCommunicator<TDomain> hnc_type;
+		typedef CPUAlgebra algebra_t;
+		typedef GridFunction<TDomain, algebra_t> grid_function_type;
+		typedef cable_neuron::synapse_handler::SynapseHandler<TDomain> synh_type;
+
+	public:
+		/// timings of one phase (seconds per execution)
+		struct PhaseTiming
+		{
+			PhaseTiming() : max(0.0), min(0.0), avg(0.0) {}
+			std::string name;
+			number max;  ///< maximum over processes
+			number min;  ///< minimum over processes
+			number avg;  ///< average over processes
+		};
+
+	public:
+		/**
+		 * @brief constructor
+		 * @param spApprox3d    3d approximation space
+		 * @param spApprox1d    1d approximation space (containing the potential function)
+		 * @param spSH          synapse handler of the 1d network
+		 * @param potFct        name of the 1d potential function
+		 */
+		HybridCouplingBenchmark
+		(
+			SmartPtr<ApproximationSpace<TDomain> > spApprox3d,
+			SmartPtr<ApproximationSpace<TDomain> > spApprox1d,
+			SmartPtr<synh_type> spSH,
+			const std::string& potFct
+		);
+
+		/// set 3d subsets receiving potential values
+		void set_potential_subsets(const std::vector<std::string>& vSubset);
+
+		/// set 3d subsets receiving synaptic currents
+		void set_current_subsets(const std::vector<std::string>& vSubset);
+
+		/// set IDs of the neurons represented in 3d
+		void set_neuron_ids(const std::vector<uint>& vNid);
+
+		/// set scale factor from 3d to 1d coordinates
+		void set_coordinate_scale_factor_3d_to_1d(number scale);
+
+		/// set whether the potential mapping is computed in a distributed manner
+		void set_distributed_potential_mapping(bool distr);
+
+		/// set whether the synapse mapping is computed in a distributed manner
+		void set_distributed_synapse_mapping(bool distr);
+
+		/// set whether potential values are interpolated along 1d edges
+		void set_potential_edge_interpolation(bool edgeInterp);
+
+		/// set number of executions per phase (default: 10)
+		void set_num_repetitions(size_t numReps);
+
+		/// set time at which synaptic currents are gathered (default: 0)
+		void set_synapse_time(number time);
+
+		/// execute and time all phases
+		void run();
+
+		/// timings of the last run (in the order of execution)
+		const std::vector<PhaseTiming>& timings() const {return m_vTiming;}
+
+		/// print timings of the last run (only on process 0)
+		void print_report() const;
+
+		/**
+		 * @brief Append timings of the last run to a JSON lines file
+		 * Only process 0 writes. Each line contains the label, the number of processes,
+		 * the phase name and the max/min/avg execution time.
+		 */
+		void write_json(const std::string& fileName, const std::string& label) const;
+
+	protected:
+		/// reduce the average local time of a phase over all processes and store it
+		void add_timing(const std::string& name, number locTime);
+
+		/// synchronize all processes before the timing of an execution
+		void barrier() const;
+
+	protected:
+		SmartPtr<hnc_type> m_spHNC;
+		SmartPtr<grid_function_type> m_spU1d;
+
+		size_t m_numReps;
+		number m_synTime;
+
+		std::vector<PhaseTiming> m_vTiming;
+};
+
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__HYBRID_COUPLING_BENCHMARK_H
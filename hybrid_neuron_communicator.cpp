@@ -39,10 +39,14 @@
 
 #include "hybrid_neuron_communicator.h"
 #include "lib_grid/algorithms/debug_util.h" // ElementDebugInfo
+#include "lib_grid/grid/grid_util.h" // CollectVertices
 #include "../cable_neuron/util/functions.h"	// neuron_identification
 #include "common/util/vector_util.h" // GetDataPtr
+#include "util/kd_tree.h"  // KDTree
+#include "util/timeline_trace.h"  // NC_TRACE_SCOPE
 
 #include <algorithm>	// std::sort
+#include <cmath>        // sqrt
 #include <limits>       // std::numeric_limits
 #include <vector>
 
@@ -58,10 +62,7 @@ HybridNeuronCommunicator<TDomain>::HybridNeuronCommunicator
 )
 : m_spGridDistributionCallbackID(SPNULL),
   m_spSynHandler(SPNULL),
-#ifdef UG_PARALLEL
-  rcvSize(NULL), rcvFrom(NULL), rcvBuf(NULL),
-  sendSize(NULL), sendTo(NULL), sendBuf(NULL),
-#endif
+  m_potMappingGeneration(0),
   m_spApprox1d(spApprox1d), m_spApprox3d(spApprox3d),
   m_potFctInd(0),
   m_spGrid1d(m_spApprox1d->domain()->grid()), m_spGrid3d(m_spApprox3d->domain()->grid()),
@@ -71,6 +72,12 @@ HybridNeuronCommunicator<TDomain>::HybridNeuronCommunicator
   m_aaPos3d(m_spApprox3d->domain()->position_accessor()),
   m_aNID(GlobalAttachments::attachment<ANeuronID>("neuronID")),
   m_vNid(1,0),
+  m_bDistributedPotentialMapping(false),
+  m_bDistributedSynapseMapping(false),
+  m_bPotExchangeInProgress(false),
+  m_bIncrementalPotentialRemapping(false),
+  m_bPotEdgeInterpolation(false),
+  m_bFullPotentialRemapNeeded(true),
   m_bPotentialMappingNeedsUpdate(true),
   m_bSynapseMappingNeedsUpdate(true)
 {
@@ -78,17 +85,28 @@ HybridNeuronCommunicator<TDomain>::HybridNeuronCommunicator
 		m_spGrid1d->attach_to_vertices(m_aNID);
 	m_aaNID = Grid::VertexAttachmentAccessor<ANeuronID>(*m_spGrid1d, m_aNID);
 
+	// potential values are stored in an attachment (NaN meaning "not mapped")
+	m_spGrid3d->attach_to_vertices_dv(m_aPot, std::numeric_limits<number>::quiet_NaN());
+	m_aaPot = Grid::VertexAttachmentAccessor<ANumber>(*m_spGrid3d, m_aPot);
+	m_spGrid3d->attach_to_vertices(m_aPotPartner);
+	m_aaPotPartner = Grid::VertexAttachmentAccessor<APotPartner>(*m_spGrid3d, m_aPotPartner);
+
+	// instrumentation
+	NC_HOT_PATH_LABEL(m_hpStartExchange, "HybridNeuronCommunicator::start_potential_value_exchange", "HybridNeuronCommunicator", "");
+	NC_HOT_PATH_LABEL(m_hpFinishExchange, "HybridNeuronCommunicator::finish_potential_value_exchange", "HybridNeuronCommunicator", "");
+	NC_HOT_PATH_LABEL(m_hpGatherCurrents, "HybridNeuronCommunicator::gather_synaptic_currents", "HybridNeuronCommunicator", "");
+
 	// calculate identifiers for each neuron
 	cable_neuron::neuron_identification(*m_spGrid1d);
 
 	// set this object as listener for distribution events
-	m_spGridDistributionCallbackID = m_spGrid1d->message_hub()->register_class_callback(this,
+	m_spGridDistributionCallbackID1d = m_spGrid1d->message_hub()->register_class_callback(this,
 		&HybridNeuronCommunicator<TDomain>::grid_distribution_callback);
 	m_spGridDistributionCallbackID = m_spGrid3d->message_hub()->register_class_callback(this,
 		&HybridNeuronCommunicator<TDomain>::grid_distribution_callback);
 
-	m_spGridAdaptionCallbackID = m_spGrid1d->message_hub()->register_class_callback(this,
-		&HybridNeuronCommunicator<TDomain>::grid_adaption_callback);
+	m_spGridAdaptionCallbackID1d = m_spGrid1d->message_hub()->register_class_callback(this,
+		&HybridNeuronCommunicator<TDomain>::grid_adaption_callback_1d);
 	m_spGridAdaptionCallbackID = m_spGrid3d->message_hub()->register_class_callback(this,
 		&HybridNeuronCommunicator<TDomain>::grid_adaption_callback);
 }
@@ -98,16 +116,16 @@ template <typename TDomain>
 HybridNeuronCommunicator<TDomain>::~HybridNeuronCommunicator()
 {
 #ifdef UG_PARALLEL
-    if (rcvSize) delete[] rcvSize;
-    if (rcvFrom) delete[] rcvFrom;
-    if (rcvBuf) delete[] (char*) rcvBuf;
-    if (sendSize) delete[] sendSize;
-    if (sendTo) delete[] sendTo;
-    if (sendBuf)  delete[] (char*) sendBuf;
+    free_potential_comm_requests();
 #endif
 
-    m_spGrid1d->message_hub()->unregister_callback(m_spGridDistributionCallbackID);
-    m_spGrid1d->message_hub()->unregister_callback(m_spGridAdaptionCallbackID);
+    if (m_spGrid3d->has_vertex_attachment(m_aPot))
+    	m_spGrid3d->detach_from_vertices(m_aPot);
+    if (m_spGrid3d->has_vertex_attachment(m_aPotPartner))
+    	m_spGrid3d->detach_from_vertices(m_aPotPartner);
+
+    m_spGrid1d->message_hub()->unregister_callback(m_spGridDistributionCallbackID1d);
+    m_spGrid1d->message_hub()->unregister_callback(m_spGridAdaptionCallbackID1d);
     m_spGrid3d->message_hub()->unregister_callback(m_spGridDistributionCallbackID);
     m_spGrid3d->message_hub()->unregister_callback(m_spGridAdaptionCallbackID);
 }
@@ -148,6 +166,13 @@ template <typename TDomain>
 void HybridNeuronCommunicator<TDomain>::
 set_solution_and_potential_index(ConstSmartPtr<GridFunction<TDomain, algebra_t> > u, size_t fctInd)
 {
+    // interpolation operators hold DoF indices of the potential function
+    if (fctInd != m_potFctInd)
+    {
+    	m_bFullPotentialRemapNeeded = true;
+    	m_bPotentialMappingNeedsUpdate = true;
+    }
+
     m_spU = u;
     m_potFctInd = fctInd;
 }
@@ -167,12 +192,76 @@ void HybridNeuronCommunicator<TDomain>::set_neuron_ids(const std::vector<uint>&
 }
 
 
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::set_distributed_potential_mapping(bool distr)
+{
+	if (distr != m_bDistributedPotentialMapping)
+		m_bPotentialMappingNeedsUpdate = true;
+	m_bDistributedPotentialMapping = distr;
+}
+
+
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::set_distributed_synapse_mapping(bool distr)
+{
+	if (distr != m_bDistributedSynapseMapping)
+		m_bSynapseMappingNeedsUpdate = true;
+	m_bDistributedSynapseMapping = distr;
+}
+
+
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::set_incremental_potential_remapping(bool incr)
+{
+	m_bIncrementalPotentialRemapping = incr;
+}
+
+
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::set_potential_edge_interpolation(bool edgeInterp)
+{
+	if (edgeInterp != m_bPotEdgeInterpolation)
+	{
+		m_bFullPotentialRemapNeeded = true;
+		m_bPotentialMappingNeedsUpdate = true;
+	}
+	m_bPotEdgeInterpolation = edgeInterp;
+}
+
+
 template <typename TDomain>
 void HybridNeuronCommunicator<TDomain>::reinit_potential_mapping()
 {
 	if (!m_bPotentialMappingNeedsUpdate)
 		return;
 
+	UG_COND_THROW(m_bPotExchangeInProgress, "Potential mapping cannot be updated "
+		"while a potential value exchange is in progress.");
+
+	// an incremental update is only possible if the 1d grid has not been altered
+	// and the 3d grid has only been adapted (not redistributed) since the last update
+	int fullRemap = !m_bIncrementalPotentialRemapping || m_bFullPotentialRemapNeeded;
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator procComm;
+		fullRemap = procComm.allreduce(fullRemap, PCL_RO_MAX);
+	}
+#endif
+
+	if (fullRemap)
+		full_potential_remapping();
+	else
+		incremental_potential_remapping();
+
+	m_bFullPotentialRemapNeeded = false;
+	m_bPotentialMappingNeedsUpdate = false;
+}
+
+
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::full_potential_remapping()
+{
     typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator VmElemItType;
     typedef typename DoFDistribution::traits<Vertex>::const_iterator VrtItType;
     typedef typename TDomain::position_accessor_type posAccType;
@@ -182,8 +271,13 @@ void HybridNeuronCommunicator<TDomain>::reinit_potential_mapping()
     ConstSmartPtr<DoFDistribution> dd1 = m_spApprox1d->dof_distribution(GridLevel());
     ConstSmartPtr<DoFDistribution> dd3 = m_spApprox3d->dof_distribution(GridLevel());
 
-	// delete old potential value mappings
-	m_mElemPot.clear();
+	// invalidate old potential values and 1d partners
+	typedef typename geometry_traits<vm_grid_object>::iterator GridVmElemItType;
+	GridVmElemItType gIt = m_spGrid3d->template begin<vm_grid_object>();
+	GridVmElemItType gIt_end = m_spGrid3d->template end<vm_grid_object>();
+	for (; gIt != gIt_end; ++gIt)
+		m_aaPot[*gIt] = std::numeric_limits<number>::quiet_NaN();
+	++m_potMappingGeneration;
 
     // find all elements of the 3d geometry boundary on which the potential is defined
     // store their center coords in the same order
@@ -205,9 +299,10 @@ void HybridNeuronCommunicator<TDomain>::reinit_potential_mapping()
     }
 
     // find all 1d vertices for neuron IDs of interest and store them and their positions
-    // TODO: think about finding edges instead -> this would allow linear interpolation
-    std::vector<Vertex*> vLocVrt;
+    // (with edge interpolation, the closest adjacent edge is determined later on)
+    std::vector<Vertex*>& vLocVrt = m_vLocVrt1d;
     std::vector<posType> vLocVrtPos;
+    vLocVrt.clear();
 
     size_t nNid = m_vNid.size();
     VrtItType it = dd1->template begin<Vertex>();
@@ -232,265 +327,514 @@ void HybridNeuronCommunicator<TDomain>::reinit_potential_mapping()
         // TODO: somehow work with parameterization along the neurites
     	//       or do something like Voronoi tesselation of the 3d geom w.r.t. 1d vertices
 
-    	// communicate 1d positions to every proc (as there are probably much fewer of them)
-        std::vector<posType> vGlobVrtPos;
-        std::vector<int> vOffsets;
+        // find out which proc holds the nearest 1d vertex for each potential element
+        // and under which (local) index
         pcl::ProcessCommunicator procComm;
-        procComm.allgatherv(vGlobVrtPos, vLocVrtPos, NULL, &vOffsets);
+        size_t nPE = vLocPotElemPos.size();
+        size_t nProcs = procComm.size();
+        std::vector<int> vNearestProc(nPE);
+        std::vector<int> vNearestInd(nPE);
 
-        // local nearest neighbor search for all elem centers
-        std::vector<size_t> vNearest;
-        std::vector<typename posType::value_type> vDist;
-        int noNeighbors = nearest_neighbor_search(vLocPotElemPos, vGlobVrtPos, vNearest, vDist);
+        if (m_bDistributedPotentialMapping)
+        	distributed_nearest_neighbor_search(vLocPotElemPos, vLocVrtPos, vNearestProc, vNearestInd);
+        else
+        {
+			// communicate 1d positions to every proc (as there are probably much fewer of them)
+			std::vector<posType> vGlobVrtPos;
+			std::vector<int> vOffsets;
+			procComm.allgatherv(vGlobVrtPos, vLocVrtPos, NULL, &vOffsets);
+
+			// local nearest neighbor search for all elem centers
+			std::vector<size_t> vNearest;
+			std::vector<typename posType::value_type> vDist;
+			int noNeighbors = nearest_neighbor_search(vLocPotElemPos, vGlobVrtPos, vNearest, vDist);
+
+			// NN search returns 1 if no neighbors found
+			UG_COND_THROW(noNeighbors, "No 1d neighbors could be found for any potential element.\n"
+				"This means there are no 1d vertices for the given neuron IDs of interest.");
+
+			// construct (using vOffset) which proc holds the nearest 1d vertex and under which index
+			vOffsets.resize(nProcs+1, vGlobVrtPos.size());
+			for (size_t i = 0; i < nPE; ++i)
+			{
+				size_t pos = vNearest[i];
 
-        // NN search returns 1 if no neighbors found
-        UG_COND_THROW(noNeighbors, "No 1d neighbors could be found for any potential element.\n"
-        	"This means there are no 1d vertices for the given neuron IDs of interest.");
+				// perform a binary search for the largest entry in offset
+				// that is lower than or equal to pos
+				size_t proc = std::distance(vOffsets.begin(),
+					std::upper_bound(vOffsets.begin(), vOffsets.end(), pos)) - 1;
 
-        // construct (using vOffset) which proc holds the nearest 1d vertex and under which index
-        // at the same time, fill recvInfo
-        size_t nPE = vLocPotElemPos.size();
-        size_t nProcs = vOffsets.size();
-        vOffsets.resize(nProcs+1, vGlobVrtPos.size());
-        std::map<size_t, std::vector<int> > mIndex;
-        m_mReceiveInfo.clear();
+				vNearestProc[i] = (int) proc;
+				vNearestInd[i] = (int) pos - vOffsets[proc];
+			}
+        }
+
+        // remember 1d partners for incremental updates
         for (size_t i = 0; i < nPE; ++i)
         {
-        	size_t pos = vNearest[i];
+        	PotentialPartner& pp = m_aaPotPartner[vLocPotElems[i]];
+        	pp.proc = vNearestProc[i];
+        	pp.ind = vNearestInd[i];
+        	pp.generation = m_potMappingGeneration;
+        }
 
-        	// perform a binary search for the largest entry in offset
-        	// that is lower than or equal to pos
-        	size_t proc = std::distance(vOffsets.begin(),
-        		std::upper_bound(vOffsets.begin(), vOffsets.end(), pos)) - 1;
+        build_potential_comm_plan(vLocPotElems, vNearestProc, vNearestInd);
+    }
 
-        	mIndex[proc].push_back((int) pos - vOffsets[proc]);
+    return;
 
-        	// add to recvInfo
-        	m_mReceiveInfo[(int) proc].push_back(vLocPotElems[i]);
-        }
+serial_case:
+#endif
+	// local nearest neighbor search for all elem centers
+	std::vector<size_t> vNearest;
+	std::vector<typename posType::value_type> vDist;
+	int noNeighbors = nearest_neighbor_search(vLocPotElemPos, vLocVrtPos, vNearest, vDist);
+	UG_COND_THROW(noNeighbors, "No 1d vertices are present to map 3d potential elements to.");
+
+	// fill 3d->1d mapping
+	const size_t nPE = vLocPotElems.size();
+	m_vPotElems.swap(vLocPotElems);
+	m_potInterp.clear();
+	for (size_t i = 0; i < nPE; ++i)
+	{
+		Vertex* vrt1d = vLocVrt[vNearest[i]];
+		add_potential_interpolation_row(m_potInterp, vLocPotElemPos[i], vrt1d, dd1);
+
+		PotentialPartner& pp = m_aaPotPartner[m_vPotElems[i]];
+		pp.proc = 0;
+		pp.ind = (int) vNearest[i];
+		pp.vrt1d = vrt1d;
+		pp.generation = m_potMappingGeneration;
+	}
+	m_vPotBuf.resize(nPE);
+}
 
-        // fill m_vSendInfo (we need to communicate for that)
-        std::vector<int> recvBuffer;
-		std::vector<int> recvSizes;
-		std::vector<int> senderProcs;
-		int numSenderProcs = 0;
-		std::vector<int> sendBuffer;
-		std::vector<int> sendSizes;
-		std::vector<int> recverProcs;
-		int numRecverProcs = 0;
 
-		// step 1: who has how much for whom?
-        std::vector<int> vNumTo(nProcs, 0);
-        std::map<size_t, std::vector<int> >::const_iterator it = mIndex.begin();
-        std::map<size_t, std::vector<int> >::const_iterator itEnd = mIndex.end();
-		for (; it != itEnd; ++it)
+template <typename TDomain>
+bool HybridNeuronCommunicator<TDomain>::inherit_potential_partner(Vertex* vrt)
+{
+	PotentialPartner& pp = m_aaPotPartner[vrt];
+	if (pp.generation == m_potMappingGeneration)
+		return true;
+
+	GridObject* parent = m_spGrid3d->get_parent(vrt);
+	if (!parent)
+		return false;
+
+	// take over the partner of the closest parent corner
+	// (ancestors that have not been mapped themselves inherit first)
+	std::vector<Vertex*> vVrt;
+	CollectVertices(vVrt, *m_spGrid3d, parent);
+	number minDistSq = std::numeric_limits<number>::max();
+	for (size_t i = 0; i < vVrt.size(); ++i)
+	{
+		if (!inherit_potential_partner(vVrt[i]))
+			continue;
+
+		const number distSq = VecDistanceSq(m_aaPos3d[vVrt[i]], m_aaPos3d[vrt]);
+		if (distSq < minDistSq)
 		{
-			const size_t p = it->first;
-			int sz = it->second.size();
-			vNumTo[p] = sz;
-
-			++numRecverProcs;
-			recverProcs.push_back(p);
-			sendSizes.push_back(sz * sizeof(int));
-			for (size_t i = 0; i < (size_t) sz; ++i)
-				sendBuffer.push_back(it->second[i]);
+			minDistSq = distSq;
+			pp = m_aaPotPartner[vVrt[i]];
 		}
-	    std::vector<int> vNumFrom(nProcs);
-        procComm.alltoall(&vNumTo[0], 1, PCL_DT_INT, &vNumFrom[0], 1, PCL_DT_INT);
+	}
 
-        // step 2: exchange information on who has which minDist vertices of whom
-		size_t nRcv = 0;
-		for (size_t p = 0; p < nProcs; ++p)
+	return minDistSq != std::numeric_limits<number>::max();
+}
+
+
+template <typename TDomain>
+Vertex* HybridNeuronCommunicator<TDomain>::
+improve_potential_partner(vm_grid_object* elem, Vertex* vrt1d) const
+{
+	// walk along the 1d neurite as long as the distance decreases
+	posType pos3d = m_aaPos3d[elem];
+	pos3d *= m_scale_factor_from_3d_to_1d;
+	number distSq = VecDistanceSq(pos3d, m_aaPos1d[vrt1d]);
+
+	Grid::traits<Edge>::secure_container edges;
+	bool improved = true;
+	while (improved)
+	{
+		improved = false;
+		m_spGrid1d->associated_elements(edges, vrt1d);
+		for (size_t e = 0; e < edges.size(); ++e)
 		{
-			if (vNumFrom[p])
+			Vertex* nb = GetConnectedVertex(edges[e], vrt1d);
+			const number nbDistSq = VecDistanceSq(pos3d, m_aaPos1d[nb]);
+			if (nbDistSq < distSq)
 			{
-				++numSenderProcs;
-				senderProcs.push_back(p);
-				recvSizes.push_back(vNumFrom[p] * sizeof(int));
-				nRcv += vNumFrom[p];
+				distSq = nbDistSq;
+				vrt1d = nb;
+				improved = true;
 			}
 		}
-		recvBuffer.resize(nRcv);
+	}
 
-		procComm.distribute_data
-		(
-			GetDataPtr(recvBuffer),     // receive buffer (for all data to be received)
-			GetDataPtr(recvSizes),      // sizes of segments in receive buffer (in bytes)
-			GetDataPtr(senderProcs),    // processes from which data is received
-			numSenderProcs,             // number of procs from which data is received
-			GetDataPtr(sendBuffer),     // send buffer (for all data to be sent)
-			GetDataPtr(sendSizes),      // sizes of segments in send buffer (in bytes)
-			GetDataPtr(recverProcs),    // processes to send data to
-			numRecverProcs              // number of procs to send data to
-		);
+	return vrt1d;
+}
 
-		// step 3: fill the actual senderInfo
-		m_mSendInfo.clear();
-		size_t offset = 0;
-		for (int p = 0; p < numSenderProcs; ++p)
-		{
-			size_t sz = recvSizes[p] / sizeof(int);
-			std::vector<Vertex*>& senderVrts = m_mSendInfo[senderProcs[p]];
-			senderVrts.resize(sz);
-			for (size_t i = 0; i < sz; ++i)
-			{
-				size_t locVrtInd = recvBuffer[offset + i];
-				senderVrts[i] = vLocVrt[locVrtInd];
-			}
 
-			offset += sz;
-		}
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::incremental_potential_remapping()
+{
+    typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator VmElemItType;
+    ConstSmartPtr<DoFDistribution> dd3 = m_spApprox3d->dof_distribution(GridLevel());
+
+    // collect current potential elements; those without a valid 1d partner
+    // (new ones from refinement) inherit the partner of their parent
+    std::vector<vm_grid_object*> vLocPotElems;
+    std::vector<vm_grid_object*> vNewElems;
+    size_t numSs = m_vPotSubset3d.size();
+    for (size_t s = 0; s < numSs; ++s)
+    {
+        int si = m_vPotSubset3d[s];
+        VmElemItType it = dd3->template begin<vm_grid_object>(si);
+        VmElemItType it_end = dd3->template end<vm_grid_object>(si);
+
+        for (; it != it_end; ++it)
+        {
+        	vm_grid_object* elem = *it;
+        	vLocPotElems.push_back(elem);
+        	if (m_aaPotPartner[elem].generation != m_potMappingGeneration)
+        		vNewElems.push_back(elem);
+        }
+    }
 
+    // inherit partners
+    const size_t nNew = vNewElems.size();
+    int failure = 0;
+    for (size_t i = 0; i < nNew && !failure; ++i)
+    {
+		if (!inherit_potential_partner(vNewElems[i]))
+			failure = 1;
+    }
 
-        // at last, prepare communication arrays
-        // delete present ones if this is a re-initialization
-        if (rcvSize) delete[] rcvSize;
-        if (rcvFrom) delete[] rcvFrom;
-        if (rcvBuf) delete[] (char*) rcvBuf;
-        if (sendSize) delete[] sendSize;
-        if (sendTo) delete[] sendTo;
-        if (sendBuf)  delete[] (char*) sendBuf;
-
-        // receiving setup
-        size_t numRcv = m_mReceiveInfo.size();
-        rcvSize = new int[numRcv];
-        rcvFrom = new int[numRcv];
-        size_t rcvBytes = 0;
-
-        size_t i = 0;
-        typename std::map<int, std::vector<vm_grid_object*> >::const_iterator itRec = m_mReceiveInfo.begin();
-        typename std::map<int, std::vector<vm_grid_object*> >::const_iterator itRec_end = m_mReceiveInfo.end();
-        for (; itRec != itRec_end; ++itRec)
+#ifdef UG_PARALLEL
+    if (pcl::NumProcs() > 1)
+    {
+        pcl::ProcessCommunicator procComm;
+        if (procComm.allreduce(failure, PCL_RO_MAX))
         {
-            rcvFrom[i] = itRec->first;
-            rcvSize[i] = (int) (itRec->second.size() * sizeof(number));
-            rcvBytes += rcvSize[i];
-            ++i;
+        	// fall back to full remapping if any new element has no mapped ancestor
+        	full_potential_remapping();
+        	return;
         }
-        rcvBuf = new char[rcvBytes];
-
-        // sending setup
-        size_t numSend = m_mSendInfo.size();
-        sendSize = new int[numSend];
-        sendTo = new int[numSend];
-        size_t sendBytes = 0;
-
-        i = 0;
-        std::map<int, std::vector<Vertex*> >::const_iterator itSend = m_mSendInfo.begin();
-        std::map<int, std::vector<Vertex*> >::const_iterator itSend_end = m_mSendInfo.end();
-        for (; itSend != itSend_end; ++itSend)
+
+        // partners cannot be improved here as the 1d neurite might be distributed;
+        // only the communication plan needs to be rebuilt
+        const size_t nPE = vLocPotElems.size();
+        std::vector<int> vProc(nPE);
+        std::vector<int> vInd(nPE);
+        for (size_t i = 0; i < nPE; ++i)
         {
-            sendTo[i] = itSend->first;
-            sendSize[i] = (int) (itSend->second.size() * sizeof(number));
-            sendBytes += sendSize[i];
-            ++i;
+        	const PotentialPartner& pp = m_aaPotPartner[vLocPotElems[i]];
+        	vProc[i] = pp.proc;
+        	vInd[i] = pp.ind;
         }
-        sendBuf = new char[sendBytes];
+
+        build_potential_comm_plan(vLocPotElems, vProc, vInd);
+        return;
     }
+#endif
 
-    m_bPotentialMappingNeedsUpdate = false;
-    return;
+    if (failure)
+    {
+    	full_potential_remapping();
+    	return;
+    }
 
-serial_case:
-#endif
-	// local nearest neighbor search for all elem centers
-	std::vector<size_t> vNearest;
-	std::vector<typename posType::value_type> vDist;
-	int noNeighbors = nearest_neighbor_search(vLocPotElemPos, vLocVrtPos, vNearest, vDist);
-	UG_COND_THROW(noNeighbors, "No 1d vertices are present to map 3d potential elements to.");
+    // improve inherited partners locally
+    for (size_t i = 0; i < nNew; ++i)
+    {
+    	PotentialPartner& pp = m_aaPotPartner[vNewElems[i]];
+    	pp.vrt1d = improve_potential_partner(vNewElems[i], pp.vrt1d);
+    }
+
+    // fill 3d->1d mapping
+    ConstSmartPtr<DoFDistribution> dd1 = m_spApprox1d->dof_distribution(GridLevel());
+    const size_t nPE = vLocPotElems.size();
+    m_vPotElems.swap(vLocPotElems);
+    m_potInterp.clear();
+    for (size_t i = 0; i < nPE; ++i)
+    {
+    	posType pos = m_aaPos3d[m_vPotElems[i]];
+    	pos *= m_scale_factor_from_3d_to_1d;
+    	add_potential_interpolation_row(m_potInterp, pos, m_aaPotPartner[m_vPotElems[i]].vrt1d, dd1);
+    }
+    m_vPotBuf.resize(nPE);
+}
 
-	// delete old mapping
-	m_mPotElemToVertex.clear();
 
-	// fill 3d->1d map
-	size_t i = 0;
-	for (size_t s = 0; s < numSs; ++s)
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::add_potential_interpolation_row
+(
+	PotentialInterpolation& interp,
+	const posType& pos,
+	Vertex* vrt1d,
+	ConstSmartPtr<DoFDistribution> dd1
+) const
+{
+	// find the closest point on the edges adjacent to the nearest vertex;
+	// the nearest edge is one of them unless the 1d geometry is extremely irregular
+	Vertex* vrtOther = NULL;
+	number t = 0.0;
+	if (m_bPotEdgeInterpolation)
 	{
-		int si = m_vPotSubset3d[s];
-		VmElemItType it = dd3->template begin<vm_grid_object>(si);
-		VmElemItType it_end = dd3->template end<vm_grid_object>(si);
-		for (; it != it_end; ++it)
+		const posType& p0 = m_aaPos1d[vrt1d];
+		number minDistSq = VecDistanceSq(pos, p0);
+
+		Grid::traits<Edge>::secure_container edges;
+		m_spGrid1d->associated_elements(edges, vrt1d);
+		const size_t nEdges = edges.size();
+		for (size_t e = 0; e < nEdges; ++e)
 		{
-		    m_mPotElemToVertex[*it] = vLocVrt[vNearest[i]];
-			++i;
+			Vertex* nb = GetConnectedVertex(edges[e], vrt1d);
+			posType dir;
+			VecSubtract(dir, m_aaPos1d[nb], p0);
+			const number lenSq = VecTwoNormSq(dir);
+			if (lenSq <= 0.0)
+				continue;
+
+			posType diff;
+			VecSubtract(diff, pos, p0);
+			const number s = std::min(std::max(VecDot(diff, dir) / lenSq, 0.0), 1.0);
+
+			posType proj;
+			VecScaleAdd(proj, 1.0, p0, s, dir);
+			const number distSq = VecDistanceSq(pos, proj);
+			if (distSq < minDistSq)
+			{
+				minDistSq = distSq;
+				vrtOther = nb;
+				t = s;
+			}
 		}
 	}
 
-	m_bPotentialMappingNeedsUpdate = false;
+	std::vector<DoFIndex> vIndex;
+	dd1->inner_dof_indices(vrt1d, m_potFctInd, vIndex, true);
+	UG_COND_THROW(!vIndex.size(), "Potential function (index: "
+		<< m_potFctInd << ") is not defined for "
+		<< ElementDebugInfo(*m_spGrid1d, vrt1d) << ".")
+	UG_ASSERT(vIndex.size() == 1, "Apparently, shape functions different from P1 "
+		"are used in the 1d approximation space.\nThis is not supported.");
+
+	if (vrtOther && t > 0.0)
+	{
+		interp.vDoF.push_back(vIndex[0]);
+		interp.vWeight.push_back(1.0 - t);
+
+		dd1->inner_dof_indices(vrtOther, m_potFctInd, vIndex, true);
+		UG_COND_THROW(!vIndex.size(), "Potential function (index: "
+			<< m_potFctInd << ") is not defined for "
+			<< ElementDebugInfo(*m_spGrid1d, vrtOther) << ".")
+		interp.vDoF.push_back(vIndex[0]);
+		interp.vWeight.push_back(t);
+	}
+	else
+	{
+		interp.vDoF.push_back(vIndex[0]);
+		interp.vWeight.push_back(1.0);
+	}
+
+	interp.vRowStart.push_back(interp.vDoF.size());
 }
 
 
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::apply_potential_interpolation
+(
+	const PotentialInterpolation& interp,
+	std::vector<number>& vOut
+) const
+{
+	const GridFunction<TDomain, algebra_t>& u = *m_spU;
+	const size_t nRows = interp.num_rows();
+	UG_ASSERT(vOut.size() >= nRows, "Output vector too small for interpolation.");
+	for (size_t r = 0; r < nRows; ++r)
+	{
+		number val = 0.0;
+		for (size_t k = interp.vRowStart[r]; k < interp.vRowStart[r+1]; ++k)
+			val += interp.vWeight[k] * DoFRef(u, interp.vDoF[k]);
+		vOut[r] = val;
+	}
+}
+
+
+#ifdef UG_PARALLEL
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::build_potential_comm_plan
+(
+	const std::vector<vm_grid_object*>& vElems,
+	const std::vector<int>& vNearestProc,
+	const std::vector<int>& vNearestInd
+)
+{
+    pcl::ProcessCommunicator procComm;
+    const size_t nPE = vElems.size();
+    const size_t nProcs = procComm.size();
+
+    // fill recvInfo
+    // (with edge interpolation, the 1d side also needs to know the elem positions)
+    const size_t stride = m_bPotEdgeInterpolation ? dim + 1 : 1;
+    std::map<size_t, std::vector<number> > mIndex;
+    std::map<int, std::vector<vm_grid_object*> > mReceiveInfo;
+    for (size_t i = 0; i < nPE; ++i)
+    {
+    	std::vector<number>& vInfo = mIndex[vNearestProc[i]];
+    	vInfo.push_back((number) vNearestInd[i]);
+    	if (m_bPotEdgeInterpolation)
+    	{
+    		posType pos = m_aaPos3d[vElems[i]];
+    		pos *= m_scale_factor_from_3d_to_1d;
+    		for (size_t d = 0; d < (size_t) dim; ++d)
+    			vInfo.push_back(pos[d]);
+    	}
+    	mReceiveInfo[vNearestProc[i]].push_back(vElems[i]);
+    }
+
+    // fill send interpolation (we need to communicate for that)
+    std::vector<number> recvBuffer;
+	std::vector<int> recvSizes;
+	std::vector<int> senderProcs;
+	int numSenderProcs = 0;
+	std::vector<number> sendBuffer;
+	std::vector<int> sendSizes;
+	std::vector<int> recverProcs;
+	int numRecverProcs = 0;
+
+	// step 1: who has how much for whom?
+    std::vector<int> vNumTo(nProcs, 0);
+    std::map<size_t, std::vector<number> >::const_iterator it = mIndex.begin();
+    std::map<size_t, std::vector<number> >::const_iterator itEnd = mIndex.end();
+	for (; it != itEnd; ++it)
+	{
+		const size_t p = it->first;
+		int sz = it->second.size() / stride;
+		vNumTo[p] = sz;
+
+		++numRecverProcs;
+		recverProcs.push_back(p);
+		sendSizes.push_back(sz * stride * sizeof(number));
+		sendBuffer.insert(sendBuffer.end(), it->second.begin(), it->second.end());
+	}
+    std::vector<int> vNumFrom(nProcs);
+    procComm.alltoall(&vNumTo[0], 1, PCL_DT_INT, &vNumFrom[0], 1, PCL_DT_INT);
+
+    // step 2: exchange information on who has which minDist vertices of whom
+	size_t nRcv = 0;
+	for (size_t p = 0; p < nProcs; ++p)
+	{
+		if (vNumFrom[p])
+		{
+			++numSenderProcs;
+			senderProcs.push_back(p);
+			recvSizes.push_back(vNumFrom[p] * stride * sizeof(number));
+			nRcv += vNumFrom[p];
+		}
+	}
+	recvBuffer.resize(nRcv * stride);
+
+	procComm.distribute_data
+	(
+		GetDataPtr(recvBuffer),     // receive buffer (for all data to be received)
+		GetDataPtr(recvSizes),      // sizes of segments in receive buffer (in bytes)
+		GetDataPtr(senderProcs),    // processes from which data is received
+		numSenderProcs,             // number of procs from which data is received
+		GetDataPtr(sendBuffer),     // send buffer (for all data to be sent)
+		GetDataPtr(sendSizes),      // sizes of segments in send buffer (in bytes)
+		GetDataPtr(recverProcs),    // processes to send data to
+		numRecverProcs              // number of procs to send data to
+	);
+
+	// step 3: fill the send interpolation
+	// (rows are stored contiguously in the order of the send buffer)
+	ConstSmartPtr<DoFDistribution> dd1 = m_spApprox1d->dof_distribution(GridLevel());
+	m_sendInterp.clear();
+	posType pos;
+	VecSet(pos, 0.0);
+	for (size_t i = 0; i < nRcv; ++i)
+	{
+		const number* info = &recvBuffer[i*stride];
+		Vertex* vrt1d = m_vLocVrt1d[(size_t) info[0]];
+		if (m_bPotEdgeInterpolation)
+		{
+			for (size_t d = 0; d < (size_t) dim; ++d)
+				pos[d] = info[d+1];
+		}
+		add_potential_interpolation_row(m_sendInterp, pos, vrt1d, dd1);
+	}
+
+
+    // at last, prepare communication arrays
+    // receiving setup
+    // (receiving elems are stored contiguously in the order of the receive buffer)
+    size_t numRcv = mReceiveInfo.size();
+    m_vRcvSize.resize(numRcv);
+    m_vRcvFrom.resize(numRcv);
+    m_vRcvElems.clear();
+    m_vRcvElems.reserve(nPE);
+
+    size_t i = 0;
+    typename std::map<int, std::vector<vm_grid_object*> >::const_iterator itRec = mReceiveInfo.begin();
+    typename std::map<int, std::vector<vm_grid_object*> >::const_iterator itRec_end = mReceiveInfo.end();
+    for (; itRec != itRec_end; ++itRec)
+    {
+        m_vRcvFrom[i] = itRec->first;
+        m_vRcvSize[i] = (int) (itRec->second.size() * sizeof(number));
+        m_vRcvElems.insert(m_vRcvElems.end(), itRec->second.begin(), itRec->second.end());
+        ++i;
+    }
+    m_vRcvBuf.resize(m_vRcvElems.size());
+
+    // sending setup
+    // (one value for each entry received from each sender proc)
+    m_vSendTo = senderProcs;
+    m_vSendSize.resize(numSenderProcs);
+    for (int p = 0; p < numSenderProcs; ++p)
+    	m_vSendSize[p] = (int) (recvSizes[p] / stride);
+    m_vSendBuf.resize(nRcv);
+
+    // create persistent communication requests for the new buffers
+    init_potential_comm_requests();
+}
+#endif
+
+
 template <typename TDomain>
 void HybridNeuronCommunicator<TDomain>::coordinate_potential_values()
 {
+	NC_TRACE_SCOPE("HybridNeuronCommunicator::coordinate_potential_values");
+	start_potential_value_exchange();
+	finish_potential_value_exchange();
+}
+
+
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::start_potential_value_exchange()
+{
+	NC_HOT_PATH_SCOPE(m_hpStartExchange);
+	NC_TRACE_SCOPE("HybridNeuronCommunicator::start_potential_value_exchange");
+
+	UG_COND_THROW(m_bPotExchangeInProgress, "Potential value exchange has already been started.");
+
 	// perform 3d elem -> 1d vertex and 1d synapse -> 3d vertex mappings
 	// if not yet done
 	reinit_potential_mapping();
 
-    ConstSmartPtr<DoFDistribution> dd1 = m_spApprox1d->dof_distribution(GridLevel(), false);
-
 #ifdef UG_PARALLEL
     if (pcl::NumProcs() <= 1) goto serial_case;
 
     {
-         // collect potential values of this proc in send buffer
-         int numRcv = (int) m_mReceiveInfo.size();
-         int numSend = (int) m_mSendInfo.size();
-         number* curVal = (number*) sendBuf;
-
-         std::map<int, std::vector<Vertex*> >::const_iterator itSend = m_mSendInfo.begin();
-         std::map<int, std::vector<Vertex*> >::const_iterator itSend_end = m_mSendInfo.end();
-         for (; itSend != itSend_end; ++itSend)
-         {
-             const std::vector<Vertex*>& vVrts = itSend->second;
-             size_t sz = vVrts.size();
-             for (size_t j = 0; j < sz; ++j)
-             {
-                 // get DoFIndex for vertex
-                 std::vector<DoFIndex> vIndex;
-                 dd1->inner_dof_indices(vVrts[j], m_potFctInd, vIndex, false);
-
-                 UG_COND_THROW(!vIndex.size(), "Potential function (index: "
-                     << m_potFctInd << ") is not defined for "
-                     << ElementDebugInfo(*this->m_spApprox1d->domain()->grid(), vVrts[j]) << ".")
-
-                 UG_ASSERT(vIndex.size() == 1, "Apparently, shape functions different from P1 "
-                     "are used in the 1d approximation space.\nThis is not supported.");
-
-                 // save value in buffer
-                 *curVal = DoFRef(*m_spU, vIndex[0]);
-                 ++curVal;
-             }
-         }
-
-        // communicate
-        pcl::ProcessCommunicator procComm;
-        procComm.distribute_data
-        (
-            rcvBuf,     // receive buffer (for all data to be received)
-            rcvSize,    // sizes of segments in receive buffer
-            rcvFrom,    // processes from which data is received
-            numRcv,     // number of procs from which data is received
-            sendBuf,    // send buffer (for all data to be sent)
-            sendSize,   // sizes of segments in send buffer
-            sendTo,     // processes to send data to
-            numSend     // number of procs to send data to
-        );
-
-        // save values in map
-        curVal = (number*) rcvBuf;
-        typename std::map<int, std::vector<vm_grid_object*> >::const_iterator itRec = m_mReceiveInfo.begin();
-        typename std::map<int, std::vector<vm_grid_object*> >::const_iterator itRec_end = m_mReceiveInfo.end();
-        for (; itRec != itRec_end; ++itRec)
-        {
-            const std::vector<vm_grid_object*>& vElems = itRec->second;
-            size_t sz = vElems.size();
-            for (size_t j = 0; j < sz; ++j)
-            {
-                m_mElemPot[vElems[j]] = *curVal;
-                ++curVal;
-            }
-        }
+        // interpolate potential values of this proc into send buffer
+        apply_potential_interpolation(m_sendInterp, m_vSendBuf);
+
+        // start persistent (non-blocking) communication
+        if (!m_vPotCommRequests.empty())
+        	MPI_Startall((int) m_vPotCommRequests.size(), &m_vPotCommRequests[0]);
+
+        m_bPotExchangeInProgress = true;
     }
 
     return;
@@ -498,37 +842,97 @@ void HybridNeuronCommunicator<TDomain>::coordinate_potential_values()
 serial_case:
 #endif
 
-    typename std::map<vm_grid_object*, Vertex*>::iterator it = m_mPotElemToVertex.begin();
-    typename std::map<vm_grid_object*, Vertex*>::iterator it_end = m_mPotElemToVertex.end();
-    std::vector<DoFIndex> vIndex;
-    for (; it != it_end; ++it)
-    {
-        Vertex* vrt = it->second;
+    // interpolate potential values and save them in attachment
+    apply_potential_interpolation(m_potInterp, m_vPotBuf);
+    const size_t nPE = m_vPotElems.size();
+    for (size_t i = 0; i < nPE; ++i)
+        m_aaPot[m_vPotElems[i]] = m_vPotBuf[i];
+}
 
-        // get DoFIndex for vertex
-        dd1->inner_dof_indices(vrt, m_potFctInd, vIndex, true);
 
-        UG_COND_THROW(!vIndex.size(), "Potential function (index: "
-            << m_potFctInd << ") is not defined for "
-            << ElementDebugInfo(*this->m_spApprox1d->domain()->grid(), vrt) << ".")
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::finish_potential_value_exchange()
+{
+	NC_HOT_PATH_SCOPE(m_hpFinishExchange);
+	NC_TRACE_SCOPE("HybridNeuronCommunicator::finish_potential_value_exchange");
 
-        UG_ASSERT(vIndex.size() == 1, "Apparently, shape functions different from P1 "
-            "are used in the 1d approximation space.\nThis is not supported.");
+#ifdef UG_PARALLEL
+	if (!m_bPotExchangeInProgress)
+		return;
 
-        // save value in buffer
-        m_mElemPot[it->first] = DoFRef(*m_spU, vIndex[0]);
-    }
+	// wait for communication to finish
+	if (!m_vPotCommRequests.empty())
+	{
+		std::vector<MPI_Status> vStatus(m_vPotCommRequests.size());
+		MPI_Waitall((int) m_vPotCommRequests.size(), &m_vPotCommRequests[0], &vStatus[0]);
+	}
+
+	// save values in attachment
+	const size_t nRcv = m_vRcvElems.size();
+	for (size_t j = 0; j < nRcv; ++j)
+		m_aaPot[m_vRcvElems[j]] = m_vRcvBuf[j];
+
+	m_bPotExchangeInProgress = false;
+#endif
+}
+
+
+#ifdef UG_PARALLEL
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::free_potential_comm_requests()
+{
+	// requests cannot be freed any more after MPI has been finalized
+	int finalized = 0;
+	MPI_Finalized(&finalized);
+	if (!finalized)
+		for (size_t i = 0; i < m_vPotCommRequests.size(); ++i)
+			MPI_Request_free(&m_vPotCommRequests[i]);
+	m_vPotCommRequests.clear();
+}
+
+
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::init_potential_comm_requests()
+{
+	free_potential_comm_requests();
+
+	pcl::ProcessCommunicator procComm;
+	MPI_Comm comm = procComm.get_mpi_communicator();
+
+	// one persistent receive/send per neighbor proc, bound to the (fixed) buffers
+	size_t offset = 0;
+	for (size_t i = 0; i < m_vRcvFrom.size(); ++i)
+	{
+		const int cnt = m_vRcvSize[i] / (int) sizeof(number);
+		MPI_Request req;
+		MPI_Recv_init(GetDataPtr(m_vRcvBuf) + offset, cnt, MPI_DOUBLE, m_vRcvFrom[i],
+			m_potCommTag, comm, &req);
+		m_vPotCommRequests.push_back(req);
+		offset += cnt;
+	}
+
+	offset = 0;
+	for (size_t i = 0; i < m_vSendTo.size(); ++i)
+	{
+		const int cnt = m_vSendSize[i] / (int) sizeof(number);
+		MPI_Request req;
+		MPI_Send_init(GetDataPtr(m_vSendBuf) + offset, cnt, MPI_DOUBLE, m_vSendTo[i],
+			m_potCommTag, comm, &req);
+		m_vPotCommRequests.push_back(req);
+		offset += cnt;
+	}
 }
+#endif
 
 
 template <typename TDomain>
 number HybridNeuronCommunicator<TDomain>::potential(vm_grid_object* elem) const
 {
-	typename std::map<vm_grid_object*, number>::const_iterator it = m_mElemPot.find(elem);
-	UG_COND_THROW(it == m_mElemPot.end(), "No potential value available for "
+	const number pot = m_aaPot[elem];
+	UG_COND_THROW(pot != pot, "No potential value available for "
         << ElementDebugInfo(*m_spApprox3d->domain()->grid(), elem) << ".");
 
-    return it->second;
+    return pot;
 }
 
 
@@ -541,7 +945,6 @@ int HybridNeuronCommunicator<TDomain>::nearest_neighbor_search
 	std::vector<typename posType::value_type>& vDistOut
 ) const
 {
-	// TODO: speed might benefit from octree or some other spatial tree structure
     size_t qSz = queryPts.size();
     size_t dSz = dataPts.size();
 
@@ -551,32 +954,393 @@ int HybridNeuronCommunicator<TDomain>::nearest_neighbor_search
         return 1; // return that no neighbors could be found at all
     }
 
-    vNNout.clear();
-    vDistOut.clear();
-    vNNout.resize(qSz);
-    vDistOut.resize(qSz);
+    // build spatial index once for all queries
+    KDTree<dim> kdTree(dataPts);
+    kdTree.nearest(queryPts, vNNout, vDistOut);
 
-    for (size_t q = 0; q < qSz; ++q)
-    {
-        const posType& qp = queryPts[q];
-        typename posType::value_type& minDist = vDistOut[q];
-        size_t& minPt = vNNout[q];
+    return 0;
+}
 
-        minPt = 0;
-        minDist = VecDistanceSq(qp, dataPts[0]);
-        for (size_t d = 1; d < dSz; ++d)
-        {
-            number dist = VecDistanceSq(qp, dataPts[d]);
-            if (dist < minDist)
-            {
-                minDist = dist;
-                minPt = d;
-            }
-        }
-    }
 
-    return 0;
+
+#ifdef UG_PARALLEL
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::distributed_nearest_neighbor_search
+(
+	const std::vector<posType>& vQueryPts,
+	const std::vector<posType>& vLocDataPts,
+	std::vector<int>& vNNProcOut,
+	std::vector<int>& vNNIndOut
+) const
+{
+	pcl::ProcessCommunicator procComm;
+	const size_t nProcs = procComm.size();
+	const size_t nQ = vQueryPts.size();
+	const size_t nD = vLocDataPts.size();
+
+	// check that there are data points at all
+	unsigned long nDGlob = procComm.allreduce((unsigned long) nD, PCL_RO_SUM);
+	UG_COND_THROW(!nDGlob, "No 1d neighbors could be found for any potential element.\n"
+		"This means there are no 1d vertices for the given neuron IDs of interest.");
+
+	// exchange bounding boxes of query points (empty boxes have min > max)
+	std::vector<number> vLocBox(2*dim);
+	for (int d = 0; d < dim; ++d)
+	{
+		vLocBox[d] = std::numeric_limits<number>::max();
+		vLocBox[dim+d] = -std::numeric_limits<number>::max();
+	}
+	for (size_t i = 0; i < nQ; ++i)
+	{
+		for (int d = 0; d < dim; ++d)
+		{
+			vLocBox[d] = std::min(vLocBox[d], vQueryPts[i][d]);
+			vLocBox[dim+d] = std::max(vLocBox[dim+d], vQueryPts[i][d]);
+		}
+	}
+	std::vector<number> vGlobBox(2*dim*nProcs);
+	procComm.allgather(&vLocBox[0], 2*dim, PCL_DT_DOUBLE, &vGlobBox[0], 2*dim, PCL_DT_DOUBLE);
+
+	// global bounding box of all query and data points
+	std::vector<number> vLocExt(vLocBox);
+	for (size_t i = 0; i < nD; ++i)
+	{
+		for (int d = 0; d < dim; ++d)
+		{
+			vLocExt[d] = std::min(vLocExt[d], vLocDataPts[i][d]);
+			vLocExt[dim+d] = std::max(vLocExt[dim+d], vLocDataPts[i][d]);
+		}
+	}
+	for (int d = 0; d < dim; ++d)
+		vLocExt[dim+d] = -vLocExt[dim+d];
+	std::vector<number> vGlobExt(2*dim);
+	procComm.allreduce(&vLocExt[0], &vGlobExt[0], 2*dim, PCL_DT_DOUBLE, PCL_RO_MIN);
+	number extentSq = 0.0;
+	number maxBoxDiagSq = 0.0;
+	for (int d = 0; d < dim; ++d)
+		extentSq += (-vGlobExt[dim+d] - vGlobExt[d]) * (-vGlobExt[dim+d] - vGlobExt[d]);
+	for (size_t p = 0; p < nProcs; ++p)
+	{
+		const number* box = &vGlobBox[2*dim*p];
+		if (box[0] > box[dim]) continue;
+		number diagSq = 0.0;
+		for (int d = 0; d < dim; ++d)
+			diagSq += (box[dim+d] - box[d]) * (box[dim+d] - box[d]);
+		maxBoxDiagSq = std::max(maxBoxDiagSq, diagSq);
+	}
+
+	// Data points are sent to each proc whose query box, inflated by a margin, contains them.
+	// A query result is correct if the nearest neighbor found is no farther away than the margin.
+	// Otherwise, the margin is doubled and the exchange is repeated; this is guaranteed to end
+	// as soon as the margin exceeds the global extent.
+	number margin = std::max(0.1 * sqrt(maxBoxDiagSq), 1e-3 * sqrt(extentSq));
+	vNNProcOut.resize(nQ);
+	vNNIndOut.resize(nQ);
+	while (true)
+	{
+		// pack (coords, local index) of data points for each proc with overlapping box
+		std::vector<number> sendBuffer;
+		std::vector<int> sendSizes;
+		std::vector<int> recverProcs;
+		std::vector<int> vNumTo(nProcs, 0);
+		for (size_t p = 0; p < nProcs; ++p)
+		{
+			const number* box = &vGlobBox[2*dim*p];
+			if (box[0] > box[dim]) continue;
+
+			for (size_t i = 0; i < nD; ++i)
+			{
+				int d = 0;
+				for (; d < dim; ++d)
+					if (vLocDataPts[i][d] < box[d] - margin || vLocDataPts[i][d] > box[dim+d] + margin)
+						break;
+				if (d < dim) continue;
+
+				for (d = 0; d < dim; ++d)
+					sendBuffer.push_back(vLocDataPts[i][d]);
+				sendBuffer.push_back((number) i);
+				++vNumTo[p];
+			}
+
+			if (vNumTo[p])
+			{
+				recverProcs.push_back(p);
+				sendSizes.push_back(vNumTo[p] * (dim+1) * sizeof(number));
+			}
+		}
+
+		// who receives how much from whom?
+		std::vector<int> vNumFrom(nProcs);
+		procComm.alltoall(&vNumTo[0], 1, PCL_DT_INT, &vNumFrom[0], 1, PCL_DT_INT);
+
+		std::vector<int> recvSizes;
+		std::vector<int> senderProcs;
+		size_t nRcv = 0;
+		for (size_t p = 0; p < nProcs; ++p)
+		{
+			if (vNumFrom[p])
+			{
+				senderProcs.push_back(p);
+				recvSizes.push_back(vNumFrom[p] * (dim+1) * sizeof(number));
+				nRcv += vNumFrom[p];
+			}
+		}
+		std::vector<number> recvBuffer(nRcv * (dim+1));
+
+		procComm.distribute_data
+		(
+			GetDataPtr(recvBuffer), GetDataPtr(recvSizes), GetDataPtr(senderProcs), (int) senderProcs.size(),
+			GetDataPtr(sendBuffer), GetDataPtr(sendSizes), GetDataPtr(recverProcs), (int) recverProcs.size()
+		);
+
+		// unpack candidates
+		std::vector<posType> vCandPos(nRcv);
+		std::vector<int> vCandProc(nRcv);
+		std::vector<int> vCandInd(nRcv);
+		size_t c = 0;
+		for (size_t sp = 0; sp < senderProcs.size(); ++sp)
+		{
+			for (int k = 0; k < vNumFrom[senderProcs[sp]]; ++k, ++c)
+			{
+				for (int d = 0; d < dim; ++d)
+					vCandPos[c][d] = recvBuffer[c*(dim+1) + d];
+				vCandInd[c] = (int) recvBuffer[c*(dim+1) + dim];
+				vCandProc[c] = senderProcs[sp];
+			}
+		}
+
+		// local nearest neighbor search among candidates
+		int incomplete = 0;
+		if (nQ)
+		{
+			std::vector<size_t> vNearest;
+			std::vector<typename posType::value_type> vDistSq;
+			if (nearest_neighbor_search(vQueryPts, vCandPos, vNearest, vDistSq))
+				incomplete = 1;
+			else
+			{
+				for (size_t i = 0; i < nQ; ++i)
+				{
+					if (vDistSq[i] > margin*margin)
+					{
+						incomplete = 1;
+						break;
+					}
+					vNNProcOut[i] = vCandProc[vNearest[i]];
+					vNNIndOut[i] = vCandInd[vNearest[i]];
+				}
+			}
+		}
+
+		if (!procComm.allreduce(incomplete, PCL_RO_MAX))
+			break;
+
+		margin *= 2.0;
+	}
+}
+#endif
+
+
+#ifdef UG_PARALLEL
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::distributed_synapse_mapping
+(
+	const std::vector<posType>& vSynPos,
+	const std::vector<posType>& vLocVrtPos,
+	std::vector<posType>& vNearestPosOut
+) const
+{
+	pcl::ProcessCommunicator procComm;
+	const size_t nProcs = procComm.size();
+	const size_t nSyn = vSynPos.size();
+	const size_t nVrt = vLocVrtPos.size();
+
+	// check that there are membrane vertices at all
+	unsigned long nVrtGlob = procComm.allreduce((unsigned long) nVrt, PCL_RO_SUM);
+	UG_COND_THROW(!nVrtGlob, "No 3d vertex in defined plasma membrane subset present on any proc.");
+
+	// exchange bounding boxes of membrane vertices (empty boxes have min > max)
+	std::vector<number> vLocBox(2*dim);
+	for (int d = 0; d < dim; ++d)
+	{
+		vLocBox[d] = std::numeric_limits<number>::max();
+		vLocBox[dim+d] = -std::numeric_limits<number>::max();
+	}
+	for (size_t i = 0; i < nVrt; ++i)
+	{
+		for (int d = 0; d < dim; ++d)
+		{
+			vLocBox[d] = std::min(vLocBox[d], vLocVrtPos[i][d]);
+			vLocBox[dim+d] = std::max(vLocBox[dim+d], vLocVrtPos[i][d]);
+		}
+	}
+	std::vector<number> vGlobBox(2*dim*nProcs);
+	procComm.allgather(&vLocBox[0], 2*dim, PCL_DT_DOUBLE, &vGlobBox[0], 2*dim, PCL_DT_DOUBLE);
+
+	// global bounding box of all synapses and membrane vertices
+	std::vector<number> vLocExt(vLocBox);
+	for (size_t i = 0; i < nSyn; ++i)
+	{
+		for (int d = 0; d < dim; ++d)
+		{
+			vLocExt[d] = std::min(vLocExt[d], vSynPos[i][d]);
+			vLocExt[dim+d] = std::max(vLocExt[dim+d], vSynPos[i][d]);
+		}
+	}
+	for (int d = 0; d < dim; ++d)
+		vLocExt[dim+d] = -vLocExt[dim+d];
+	std::vector<number> vGlobExt(2*dim);
+	procComm.allreduce(&vLocExt[0], &vGlobExt[0], 2*dim, PCL_DT_DOUBLE, PCL_RO_MIN);
+	number extentSq = 0.0;
+	number maxBoxDiagSq = 0.0;
+	for (int d = 0; d < dim; ++d)
+		extentSq += (-vGlobExt[dim+d] - vGlobExt[d]) * (-vGlobExt[dim+d] - vGlobExt[d]);
+	for (size_t p = 0; p < nProcs; ++p)
+	{
+		const number* box = &vGlobBox[2*dim*p];
+		if (box[0] > box[dim]) continue;
+		number diagSq = 0.0;
+		for (int d = 0; d < dim; ++d)
+			diagSq += (box[dim+d] - box[d]) * (box[dim+d] - box[d]);
+		maxBoxDiagSq = std::max(maxBoxDiagSq, diagSq);
+	}
+
+	// Each synapse is sent to each proc whose vertex box is no farther away from it than a margin.
+	// The nearest vertex found among these procs is the global nearest one if it is no farther
+	// away than the margin. Otherwise, the margin is doubled and the synapse is sent again;
+	// this is guaranteed to end as soon as the margin exceeds the global extent.
+	// Ties between procs are resolved in favor of the lowest rank.
+	number margin = std::max(0.1 * sqrt(maxBoxDiagSq), 1e-3 * sqrt(extentSq));
+	std::vector<bool> vPending(nSyn, true);
+	std::vector<number> vBestDistSq(nSyn, std::numeric_limits<number>::max());
+	vNearestPosOut.resize(nSyn);
+	while (true)
+	{
+		// pack coords of pending synapses for each proc with a near enough box
+		std::vector<number> sendBuffer;
+		std::vector<int> sendSizes;
+		std::vector<int> recverProcs;
+		std::vector<int> vNumTo(nProcs, 0);
+		std::vector<size_t> vSentSyn;
+		for (size_t p = 0; p < nProcs; ++p)
+		{
+			const number* box = &vGlobBox[2*dim*p];
+			if (box[0] > box[dim]) continue;
+
+			for (size_t s = 0; s < nSyn; ++s)
+			{
+				if (!vPending[s]) continue;
+
+				number boxDistSq = 0.0;
+				for (int d = 0; d < dim; ++d)
+				{
+					const number dist = std::max(0.0, std::max(box[d] - vSynPos[s][d], vSynPos[s][d] - box[dim+d]));
+					boxDistSq += dist*dist;
+				}
+				if (boxDistSq > margin*margin) continue;
+
+				for (int d = 0; d < dim; ++d)
+					sendBuffer.push_back(vSynPos[s][d]);
+				vSentSyn.push_back(s);
+				++vNumTo[p];
+			}
+
+			if (vNumTo[p])
+			{
+				recverProcs.push_back(p);
+				sendSizes.push_back(vNumTo[p] * dim * sizeof(number));
+			}
+		}
+
+		// who receives how much from whom?
+		std::vector<int> vNumFrom(nProcs);
+		procComm.alltoall(&vNumTo[0], 1, PCL_DT_INT, &vNumFrom[0], 1, PCL_DT_INT);
+
+		std::vector<int> recvSizes;
+		std::vector<int> senderProcs;
+		size_t nRcv = 0;
+		for (size_t p = 0; p < nProcs; ++p)
+		{
+			if (vNumFrom[p])
+			{
+				senderProcs.push_back(p);
+				recvSizes.push_back(vNumFrom[p] * dim * sizeof(number));
+				nRcv += vNumFrom[p];
+			}
+		}
+		std::vector<number> recvBuffer(nRcv * dim);
+
+		procComm.distribute_data
+		(
+			GetDataPtr(recvBuffer), GetDataPtr(recvSizes), GetDataPtr(senderProcs), (int) senderProcs.size(),
+			GetDataPtr(sendBuffer), GetDataPtr(sendSizes), GetDataPtr(recverProcs), (int) recverProcs.size()
+		);
+
+		// answer with the nearest local vertex (coords and squared distance) for each received synapse
+		std::vector<posType> vQuery(nRcv);
+		for (size_t c = 0; c < nRcv; ++c)
+			for (int d = 0; d < dim; ++d)
+				vQuery[c][d] = recvBuffer[c*dim + d];
+
+		std::vector<number> answerBuffer(nRcv * (dim+1));
+		if (nRcv)
+		{
+			std::vector<size_t> vNearest;
+			std::vector<typename posType::value_type> vDistSq;
+			const bool failure = nearest_neighbor_search(vQuery, vLocVrtPos, vNearest, vDistSq);
+			for (size_t c = 0; c < nRcv; ++c)
+			{
+				for (int d = 0; d < dim; ++d)
+					answerBuffer[c*(dim+1) + d] = failure ? 0.0 : vLocVrtPos[vNearest[c]][d];
+				answerBuffer[c*(dim+1) + dim] = failure ? std::numeric_limits<number>::max() : vDistSq[c];
+			}
+		}
+
+		std::vector<int> answerSendSizes(senderProcs.size());
+		for (size_t sp = 0; sp < senderProcs.size(); ++sp)
+			answerSendSizes[sp] = vNumFrom[senderProcs[sp]] * (dim+1) * sizeof(number);
+		std::vector<int> answerRecvSizes(recverProcs.size());
+		for (size_t rp = 0; rp < recverProcs.size(); ++rp)
+			answerRecvSizes[rp] = vNumTo[recverProcs[rp]] * (dim+1) * sizeof(number);
+		std::vector<number> answerRecvBuffer(vSentSyn.size() * (dim+1));
+
+		procComm.distribute_data
+		(
+			GetDataPtr(answerRecvBuffer), GetDataPtr(answerRecvSizes), GetDataPtr(recverProcs), (int) recverProcs.size(),
+			GetDataPtr(answerBuffer), GetDataPtr(answerSendSizes), GetDataPtr(senderProcs), (int) senderProcs.size()
+		);
+
+		// keep the nearest answer for each synapse (answers are ordered by proc rank)
+		const size_t nSent = vSentSyn.size();
+		for (size_t k = 0; k < nSent; ++k)
+		{
+			const size_t s = vSentSyn[k];
+			const number distSq = answerRecvBuffer[k*(dim+1) + dim];
+			if (distSq < vBestDistSq[s])
+			{
+				vBestDistSq[s] = distSq;
+				for (int d = 0; d < dim; ++d)
+					vNearestPosOut[s][d] = answerRecvBuffer[k*(dim+1) + d];
+			}
+		}
+
+		int incomplete = 0;
+		for (size_t s = 0; s < nSyn; ++s)
+		{
+			if (!vPending[s]) continue;
+			if (vBestDistSq[s] <= margin*margin)
+				vPending[s] = false;
+			else
+				incomplete = 1;
+		}
+
+		if (!procComm.allreduce(incomplete, PCL_RO_MAX))
+			break;
+
+		margin *= 2.0;
+	}
 }
+#endif
 
 
 
@@ -590,6 +1354,26 @@ uint HybridNeuronCommunicator<TDomain>::get_postsyn_neuron_id(synapse_id id)
 	return m_aaNID[e->vertex(0)];
 }
 
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::report_memory(MemoryReport& rep) const
+{
+	if (m_spGrid3d.valid())
+	{
+		rep.add("attachment 3d potential", AttachmentMemory<Vertex>(*m_spGrid3d, m_aPot));
+		rep.add("attachment 1d potential partners", AttachmentMemory<Vertex>(*m_spGrid3d, m_aPotPartner));
+	}
+	rep.add("local 1d vertices", VectorMemory(m_vLocVrt1d) + VectorMemory(m_vNid));
+	rep.add("synapse coordinate map", MapMemory(m_mSynapse3dCoords));
+	rep.add("potential interpolation", m_potInterp.memory_bytes()
+		+ VectorMemory(m_vPotElems) + VectorMemory(m_vPotBuf));
+#ifdef UG_PARALLEL
+	rep.add("potential communication", m_sendInterp.memory_bytes()
+		+ VectorMemory(m_vRcvElems) + VectorMemory(m_vRcvSize) + VectorMemory(m_vRcvFrom)
+		+ VectorMemory(m_vRcvBuf) + VectorMemory(m_vSendSize) + VectorMemory(m_vSendTo)
+		+ VectorMemory(m_vSendBuf) + VectorMemory(m_vPotCommRequests));
+#endif
+}
+
 template <typename TDomain>
 void HybridNeuronCommunicator<TDomain>::reinit_synapse_mapping()
 {
@@ -647,7 +1431,16 @@ void HybridNeuronCommunicator<TDomain>::reinit_synapse_mapping()
 
 #ifdef UG_PARALLEL
 	size_t nProcs = pcl::NumProcs();
-	if (nProcs > 1)
+	if (nProcs > 1 && m_bDistributedSynapseMapping)
+	{
+		std::vector<posType> vNearestPos;
+		distributed_synapse_mapping(syn_coords_local, v3dVertexPos, vNearestPos);
+
+		const size_t nSyn1d = syn_coords_local.size();
+		for (size_t s = 0; s < nSyn1d; ++s)
+			m_mSynapse3dCoords[syn_ids_local[s]] = vNearestPos[s];
+	}
+	else if (nProcs > 1)
 	{
 		pcl::ProcessCommunicator com;
 		std::vector<MathVector<dim> > syn_coords_global; //synapses coords of neuron with given id
@@ -737,6 +1530,9 @@ void HybridNeuronCommunicator<TDomain>::gather_synaptic_currents
 	number time
 )
 {
+	NC_HOT_PATH_SCOPE(m_hpGatherCurrents);
+	NC_TRACE_SCOPE("HybridNeuronCommunicator::gather_synaptic_currents");
+
 	// reinit mappings if necessary
 	reinit_synapse_mapping();
 
@@ -782,7 +1578,11 @@ void HybridNeuronCommunicator<TDomain>::get_postsyn_coordinates(synapse_id id, M
 template <typename TDomain>
 void HybridNeuronCommunicator<TDomain>::grid_adaption_callback(const GridMessage_Adaption& gma)
 {
-	// after grid adaption, mappings need to be force-updated
+	// a pending potential exchange writes to 3d elements which might not survive
+	if (gma.adaption_begins())
+		finish_potential_value_exchange();
+
+	// after 3d grid adaption, mappings need to be force-updated
 	if (gma.adaption_ends())
 	{
 		m_bPotentialMappingNeedsUpdate = true;
@@ -791,13 +1591,35 @@ void HybridNeuronCommunicator<TDomain>::grid_adaption_callback(const GridMessage
 }
 
 
+template <typename TDomain>
+void HybridNeuronCommunicator<TDomain>::grid_adaption_callback_1d(const GridMessage_Adaption& gma)
+{
+	// finish a pending potential exchange while its mapping is still valid
+	if (gma.adaption_begins())
+		finish_potential_value_exchange();
+
+	// after 1d grid adaption, the potential mapping cannot be updated incrementally
+	if (gma.adaption_ends())
+	{
+		m_bPotentialMappingNeedsUpdate = true;
+		m_bFullPotentialRemapNeeded = true;
+		m_bSynapseMappingNeedsUpdate = true;
+	}
+}
+
+
 template <typename TDomain>
 void HybridNeuronCommunicator<TDomain>::grid_distribution_callback(const GridMessage_Distribution& gmd)
 {
+	// a pending potential exchange writes to elements which might be moved away
+	if (gmd.msg() == GMDT_DISTRIBUTION_STARTS)
+		finish_potential_value_exchange();
+
 	// after grid distribution, mappings need to be force-updated
 	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
 	{
 		m_bPotentialMappingNeedsUpdate = true;
+		m_bFullPotentialRemapNeeded = true;
 		m_bSynapseMappingNeedsUpdate = true;
 	}
 }
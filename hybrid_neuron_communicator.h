@@ -44,11 +44,19 @@
 #include "../cable_neuron/synapse_handling/synapses/base_synapse.h"
 #include "../cable_neuron/synapse_handling/synapses/post_synapse.h"
 #include "../cable_neuron/synapse_handling/synapses/pre_synapse.h"
+#include "util/hot_path_counters.h"  // for NC_HOT_PATH_COUNTER
+#include "util/memory_accounting.h"  // for IMemoryReporter
+
+#ifdef UG_PARALLEL
+#include "pcl/pcl_process_communicator.h"
+#endif
 
 
 namespace ug {
 namespace neuro_collection {
 
+template <typename TDomain> class HybridCouplingBenchmark;
+
 /**
  * @brief Class for communication between distributed 1d and 3d versions of the same cells
  *
@@ -74,6 +82,7 @@ namespace neuro_collection {
  */
 template <typename TDomain>
 class HybridNeuronCommunicator
+: public IMemoryReporter
 {
     protected:
         static const int dim = TDomain::dim;
@@ -85,6 +94,9 @@ class HybridNeuronCommunicator
     	typedef typename cable_neuron::synapse_handler::SynapseHandler<TDomain> synh_type;
     	typedef Attachment<uint> ANeuronID;
 
+        /// the scaling benchmark times the (protected) mapping phases separately
+        friend class HybridCouplingBenchmark<TDomain>;
+
     public:
         /// constructor
         HybridNeuronCommunicator
@@ -118,11 +130,65 @@ class HybridNeuronCommunicator
 
         void set_neuron_ids(const std::vector<uint>& vNid);
 
+        /**
+         * @brief Set whether the potential mapping is to be computed in a distributed manner.
+         * By default, the positions of all 1d vertices are gathered on every process.
+         * In distributed mode, processes exchange the bounding boxes of their 3d potential elements
+         * and send 1d vertex positions only to processes whose boxes are near enough.
+         * This scales much better with the number of processes.
+         */
+        void set_distributed_potential_mapping(bool distr);
+
+        /**
+         * @brief Set whether the potential mapping is to be updated incrementally after 3d grid adaption.
+         * In incremental mode, only new 3d vertices are mapped after an adaption of the 3d grid;
+         * they inherit the 1d partner of their parent (which is then locally improved
+         * by walking along the 1d neurite in the serial case).
+         * Any change of the 1d grid and any redistribution still trigger a full remapping.
+         */
+        void set_incremental_potential_remapping(bool incr);
+
+        /**
+         * @brief Set whether potential values are to be interpolated linearly along 1d edges.
+         * By default, each 3d potential elem is given the value of its nearest 1d vertex.
+         * With edge interpolation, the elem is projected onto the closest 1d edge adjacent
+         * to that vertex and the potential is interpolated linearly between the edge's corners.
+         * The interpolation weights are precomputed with the mapping, such that each exchange
+         * only costs one sparse matrix-vector product.
+         * This allows for a much coarser 1d grid.
+         */
+        void set_potential_edge_interpolation(bool edgeInterp);
+
+        /**
+         * @brief Set whether the synapse mapping is to be computed in a distributed manner.
+         * By default, the coordinates of all synapses of interest are gathered on every process.
+         * In distributed mode, processes exchange the bounding boxes of their 3d membrane vertices
+         * and each synapse is only sent to processes whose boxes are near enough to contain
+         * its nearest vertex; the closest of the answers is chosen by the synapse owner.
+         */
+        void set_distributed_synapse_mapping(bool distr);
+
         ConstSmartPtr<synh_type> synapse_handler() const {return m_spSynHandler;}
 
         /// communicate potential values
         void coordinate_potential_values();
 
+        /**
+         * @brief Start communication of potential values.
+         * The communication is non-blocking and uses a persistent communication plan
+         * that is set up with each potential mapping update.
+         * Local work can be done until finish_potential_value_exchange() is called.
+         * A pending exchange is finished automatically when adaption or redistribution
+         * of the 1d or 3d grid begins.
+         */
+        void start_potential_value_exchange();
+
+        /**
+         * @brief Finish communication of potential values.
+         * After this method has been called, potential() returns the communicated values.
+         */
+        void finish_potential_value_exchange();
+
         /// coordinate synaptic current values (only active post-synapses)
         void gather_synaptic_currents
 		(
@@ -157,6 +223,31 @@ class HybridNeuronCommunicator
 			std::vector<typename posType::value_type>& vDistOut
 		) const;
 
+#ifdef UG_PARALLEL
+        /// nearest neighbor search on distributed data; returns proc and local index of nearest
+        void distributed_nearest_neighbor_search
+		(
+			const std::vector<posType>& vQueryPts,
+			const std::vector<posType>& vLocDataPts,
+			std::vector<int>& vNNProcOut,
+			std::vector<int>& vNNIndOut
+		) const;
+
+        /// nearest 3d membrane vertex positions for local synapse positions without global gathering
+        void distributed_synapse_mapping
+		(
+			const std::vector<posType>& vSynPos,
+			const std::vector<posType>& vLocVrtPos,
+			std::vector<posType>& vNearestPosOut
+		) const;
+
+        /// set up persistent communication requests for current communication buffers
+        void init_potential_comm_requests();
+
+        /// free persistent communication requests
+        void free_potential_comm_requests();
+#endif
+
     public:
     	/**
     	 * Calculates real coordinates of given Synapse (by ID) and returns in vCoords
@@ -165,48 +256,132 @@ class HybridNeuronCommunicator
     	void get_postsyn_coordinates(synapse_id id, MathVector<dim>& vCoords);
     	uint get_postsyn_neuron_id(synapse_id id);
 
+        /// @copydoc IMemoryReporter::memory_owner_name()
+        virtual std::string memory_owner_name() const {return "HybridNeuronCommunicator";}
+
+        /// @copydoc IMemoryReporter::report_memory()
+        virtual void report_memory(MemoryReport& rep) const;
+
 
     protected:
         ///reinitialize mappings for 3d elem -> 1d vertex potential value mapping
         void reinit_potential_mapping();
 
+        /// compute 3d elem -> 1d vertex potential value mapping from scratch
+        void full_potential_remapping();
+
+        /// map only 3d elems without valid 1d partner
+        void incremental_potential_remapping();
+
+        /// let a vertex inherit the 1d partner of (the closest corner of) its parent
+        bool inherit_potential_partner(Vertex* vrt);
+
+        /// find a closer 1d partner in the neighborhood of the given one
+        Vertex* improve_potential_partner(vm_grid_object* elem, Vertex* vrt1d) const;
+
+#ifdef UG_PARALLEL
+        /// construct communication plan for potential values from the given partners
+        void build_potential_comm_plan
+        (
+			const std::vector<vm_grid_object*>& vElems,
+			const std::vector<int>& vNearestProc,
+			const std::vector<int>& vNearestInd
+		);
+#endif
+
 
         /// reinitialize mappings for 1d syn -> 3d vertex mapping
         void reinit_synapse_mapping();
 
 
 		MessageHub::SPCallbackId 	m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId 	m_spGridAdaptionCallbackID1d;
 		void grid_adaption_callback(const GridMessage_Adaption& msg);
+		void grid_adaption_callback_1d(const GridMessage_Adaption& msg);
 
 		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID1d;
 		void grid_distribution_callback(const GridMessage_Distribution& gmd);
 
+    private:
+        /// 1d partner of a 3d potential elem (valid if generation matches current mapping generation)
+        struct PotentialPartner
+        {
+        	PotentialPartner() : proc(-1), ind(-1), vrt1d(NULL), generation(0) {}
+        	int proc;
+        	int ind;
+        	Vertex* vrt1d;
+        	size_t generation;
+        };
+        typedef Attachment<PotentialPartner> APotPartner;
+
+        /// sparse interpolation operator from 1d potential DoFs to target values (CSR format)
+        struct PotentialInterpolation
+        {
+        	void clear() {vRowStart.assign(1, 0); vDoF.clear(); vWeight.clear();}
+        	size_t num_rows() const {return vRowStart.empty() ? 0 : vRowStart.size() - 1;}
+        	size_t memory_bytes() const
+        	{return VectorMemory(vRowStart) + VectorMemory(vDoF) + VectorMemory(vWeight);}
+
+        	std::vector<size_t> vRowStart;
+        	std::vector<DoFIndex> vDoF;
+        	std::vector<number> vWeight;
+        };
+
+        /// add interpolation row for a (scaled) 3d position whose nearest 1d vertex is given
+        void add_potential_interpolation_row
+        (
+        	PotentialInterpolation& interp,
+        	const posType& pos,
+        	Vertex* vrt1d,
+        	ConstSmartPtr<DoFDistribution> dd1
+        ) const;
+
+        /// apply interpolation operator to current solution
+        void apply_potential_interpolation(const PotentialInterpolation& interp, std::vector<number>& vOut) const;
+
     private:
         SmartPtr<synh_type> m_spSynHandler;
 
         /// memory for side element potential values
-        std::map<vm_grid_object*, number> m_mElemPot;
+        ANumber m_aPot;
+        Grid::VertexAttachmentAccessor<ANumber> m_aaPot;
+
+        /// 1d partners of 3d potential elems (for incremental remapping)
+        APotPartner m_aPotPartner;
+        Grid::VertexAttachmentAccessor<APotPartner> m_aaPotPartner;
+        size_t m_potMappingGeneration;
+
+        /// local 1d vertices of the neurons of interest (as of the last full remapping)
+        std::vector<Vertex*> m_vLocVrt1d;
 
         /// synapse to 3d coordinate vertex mapping
         std::map<synapse_id, MathVector<dim> > m_mSynapse3dCoords;
 
 #ifdef UG_PARALLEL
-        /// list of 1d sender vertices on this proc and who they send to
-        std::map<int, std::vector<Vertex*> > m_mSendInfo;
+        /// interpolation from 1d potential DoFs on this proc to the send buffer
+        PotentialInterpolation m_sendInterp;
+
+        /// 3d receiver elems on this proc (in the order of the receive buffer)
+        std::vector<vm_grid_object*> m_vRcvElems;
 
-        /// list of 3d receiver elems and who they receive from
-        std::map<int, std::vector<vm_grid_object*> > m_mReceiveInfo;
+        std::vector<int> m_vRcvSize;
+        std::vector<int> m_vRcvFrom;
+        std::vector<number> m_vRcvBuf;
 
-        int* rcvSize;
-        int* rcvFrom;
-        void* rcvBuf;
+        std::vector<int> m_vSendSize;
+        std::vector<int> m_vSendTo;
+        std::vector<number> m_vSendBuf;
 
-        int* sendSize;
-        int* sendTo;
-        void* sendBuf;
+        /// persistent communication requests for potential value exchange
+        std::vector<MPI_Request> m_vPotCommRequests;
+        static const int m_potCommTag = 4631;
 #endif
 
-        std::map<vm_grid_object*, Vertex*> m_mPotElemToVertex;  // direct map (only for the serial case)
+        /// 3d potential elems and their interpolation from 1d potential DoFs (only for the serial case)
+        std::vector<vm_grid_object*> m_vPotElems;
+        PotentialInterpolation m_potInterp;
+        std::vector<number> m_vPotBuf;
 
         SmartPtr<ApproximationSpace<TDomain> > m_spApprox1d;
         SmartPtr<ApproximationSpace<TDomain> > m_spApprox3d;
@@ -232,8 +407,19 @@ class HybridNeuronCommunicator
         std::vector<int> m_vPotSubset3d;
         std::vector<int> m_vCurrentSubset3d;
 
+        bool m_bDistributedPotentialMapping;
+        bool m_bDistributedSynapseMapping;
+        bool m_bPotExchangeInProgress;
+        bool m_bIncrementalPotentialRemapping;
+        bool m_bPotEdgeInterpolation;
+        bool m_bFullPotentialRemapNeeded;
         bool m_bPotentialMappingNeedsUpdate;
         bool m_bSynapseMappingNeedsUpdate;
+
+        /// instrumentation (if enabled)
+        NC_HOT_PATH_COUNTER(m_hpStartExchange)
+        NC_HOT_PATH_COUNTER(m_hpFinishExchange)
+        NC_HOT_PATH_COUNTER(m_hpGatherCurrents)
 };
 
 
@@ -48,6 +48,11 @@
 
 #include "lib_disc/spatial_disc/elem_disc/err_est_data.h"  // for MultipleSideAndElemErrEstData
 
+#include <functional>  // for std::greater
+#include <map>
+#include <queue>  // for std::priority_queue
+#include <utility>  // for std::pair
+
 namespace ug {
 namespace neuro_collection {
 
@@ -62,7 +67,9 @@ namespace neuro_collection {
  * The amount of released calcium is calculated as a fixed percentage of the synapse current,
  * which can be chosen by the user (set_current_percentage()).
  * The IP3 production, meanwhile, is described by simple exponentially decaying dynamics,
- * parameterizable by set_ip3_production_params().
+ * parameterizable by set_ip3_production_params(). Repeated activations of a synapse
+ * superpose: each activation adds the maximal production rate to the (decayed)
+ * current production rate of the synapse.
  *
  * As it is not clear, a priori, where the synapses are located, a fortiori not being
  * in a separate subset, this discretization is realized as a constraint.
@@ -175,7 +182,7 @@ class HybridSynapseCurrentAssembler : public IDomainConstraint<TDomain, TAlgebra
 
 		void set_current_percentage(number val) {m_current_percentage = val;}
 
-		void set_synaptic_radius(number r) {m_sqSynRadius = r*r;}
+		void set_synaptic_radius(number r) {m_sqSynRadius = r*r; m_mSynapseFootprint.clear(); m_bFootprintsLinked = false;}
 
 		void set_ip3_production_params(number j_max, number decayRate)
 		{
@@ -219,10 +226,104 @@ class HybridSynapseCurrentAssembler : public IDomainConstraint<TDomain, TAlgebra
 			m_spHNC->set_neuron_ids(vID);
 		}
 
+		/// set whether synapses are mapped to the 3d membrane without global gathering of synapse coordinates
+		void set_distributed_synapse_mapping(bool distr)
+		{
+			m_spHNC->set_distributed_synapse_mapping(distr);
+		}
+
 		//void set_ip3_duration(const number& dur) {m_j_ip3_duration = dur;}
 
 	protected:
-		number get_ip3(synapse_id vrt, number time);
+		/**
+		 * @brief Update the set of active synapses for the given time.
+		 * The set is only changed by events: Synapses are added when they become active
+		 * in 1d or removed when they become inactive, and IP3 production of a synapse
+		 * expires m_j_ip3_duration after its activation.
+		 * Only these changes (and the currents of active synapses) are communicated.
+		 * As synaptic currents only change with the 1d solution, the update is carried out
+		 * once per time point.
+		 */
+		void update_synapse_activity(number time);
+
+		/**
+		 * @brief Compute 3d footprints for all active synapses that do not have one yet.
+		 * The footprint of a synapse consists of the membrane sides within the synaptic radius
+		 * and the DoF indices of their vertices together with the area weights with which
+		 * the synaptic flux is distributed to them. Footprints are kept until the grid is
+		 * adapted or redistributed. Each active synapse is linked to its footprint,
+		 * so assembly does not need to look footprints up.
+		 */
+		void update_synapse_footprints(ConstSmartPtr<DoFDistribution> dd);
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	private:
+		struct SynapseFootprint;
+
+		/// state of a synapse that is active in 1d or still producing IP3
+		struct SynapseActivity
+		{
+			SynapseActivity()
+			: current(0.0), ip3Rate(0.0), ip3RefTime(0.0), ip3EndTime(0.0),
+			  bCurrentActive(false), bIP3Active(false), footprint(NULL) {}
+
+			MathVector<dim> pos;
+			number current;
+
+			/// IP3 production rate at ip3RefTime (the last activation), decaying exponentially
+			number ip3Rate;
+			number ip3RefTime;
+
+			/// time when IP3 production is turned off (see set_ip3_production_params())
+			number ip3EndTime;
+
+			bool bCurrentActive;
+			bool bIP3Active;
+
+			/// 3d footprint (valid after update_synapse_footprints())
+			const SynapseFootprint* footprint;
+		};
+		typedef std::map<synapse_id, SynapseActivity> activity_map_type;
+
+		typedef typename domain_traits<dim>::side_type side_type;
+
+		/// 3d membrane footprint of a synapse
+		struct SynapseFootprint
+		{
+			SynapseFootprint() : totalArea(0.0) {}
+
+			/// local membrane sides within synaptic radius (for error estimation)
+			std::vector<side_type*> vSide;
+
+			/// DoF indices of local footprint vertices (for ion species and IP3)
+			std::vector<DoFIndex> vDoF;
+			std::vector<DoFIndex> vDoFIP3;
+
+			/// area associated to each footprint vertex
+			std::vector<number> vWeight;
+
+			/// global area of the footprint
+			number totalArea;
+		};
+
+		/// IP3 production of a synapse at the given time
+		number ip3_production(const SynapseActivity& sa, number time) const;
+
+		/// add an activation to the IP3 production of a synapse
+		void activate_ip3_production(SynapseActivity& sa, synapse_id id, number time);
+
+		struct IndexCompare
+		{
+			IndexCompare(const std::vector<synapse_id>& _vID) : vID(_vID) {}
+			bool operator()(size_t a, size_t b) const {return vID[a] < vID[b];}
+
+			private:
+				const std::vector<synapse_id>& vID;
+		};
 
 	private:
 		/// function index of the carried ion species
@@ -258,7 +359,26 @@ class HybridSynapseCurrentAssembler : public IDomainConstraint<TDomain, TAlgebra
 		number m_j_ip3_decayRate; //in 1/s
 		number m_j_ip3_duration; //duration of ip3 influx until specified ip3 fraction of total is reached (in s)
 
-		std::map<synapse_id, number> m_mSynapseActivationTime; //maps a 3d vertex mapped synapse to their activation time for IP3 generation
+		/// all synapses with current or IP3 activity (identical on all procs)
+		activity_map_type m_mSynapseActivity;
+
+		/// synapses active in 1d for each proc (sorted by ID; order of current exchange)
+		std::vector<std::vector<synapse_id> > m_vvCurrentActiveSyn;
+
+		/// end times of IP3 production (earliest first; outdated entries are skipped on expiry)
+		typedef std::pair<number, synapse_id> ip3_expiry_type;
+		std::priority_queue<ip3_expiry_type, std::vector<ip3_expiry_type>, std::greater<ip3_expiry_type> >
+			m_qIP3Expiry;
+
+		number m_activityTime;
+		bool m_bActivityValid;
+
+		/// cached footprints of synapses (valid for DoF distribution m_spFootprintDD)
+		std::map<synapse_id, SynapseFootprint> m_mSynapseFootprint;
+		ConstSmartPtr<DoFDistribution> m_spFootprintDD;
+
+		/// whether all active synapses are linked to their footprints
+		bool m_bFootprintsLinked;
 };
 
 } // namespace neuro_collection
@@ -40,8 +40,10 @@
 #include "lib_grid/algorithms/debug_util.h"  // for ElementDebugInfo
 #include "lib_grid/algorithms/volume_calculation.h"  // for CalculateVolume
 #include "../cable_neuron/util/functions.h"  // for neuron_identification
+#include "util/timeline_trace.h"  // for NC_TRACE_SCOPE
 
-#include <algorithm>  // for std::find
+#include <algorithm>  // for std::find, std::sort, std::set_difference, std::set_intersection, std::merge, std::binary_search
+#include <iterator>  // for std::back_inserter
 #include <vector>
 
 namespace ug {
@@ -62,7 +64,8 @@ HybridSynapseCurrentAssembler
 : m_fctInd(0), m_fctInd_ip3(0), m_ip3_set(true), m_F(96485.309), m_valency(2), m_current_percentage(0.1),
   m_spHNC(new hnc_type(spApprox3d, spApprox1d)), m_spDom(spApprox3d->domain()), m_sqSynRadius(0.04),
   m_scaling_3d_to_1d_amount_of_substance(1e-15), m_scaling_3d_to_1d_electric_charge(1.0), m_scaling_3d_to_1d_coordinates(1e-6), m_scaling_3d_to_1d_ip3(1e-15),
-  m_j_ip3_max(6e-19), m_j_ip3_decayRate(1.188), m_j_ip3_duration(3.0 / m_j_ip3_decayRate)
+  m_j_ip3_max(6e-19), m_j_ip3_decayRate(1.188), m_j_ip3_duration(3.0 / m_j_ip3_decayRate),
+  m_activityTime(0.0), m_bActivityValid(false), m_bFootprintsLinked(false)
 {
 	// get function index of whatever it is that the current carries (in our case: calcium)
 	FunctionGroup fctGrp(spApprox3d->function_pattern());
@@ -81,6 +84,13 @@ HybridSynapseCurrentAssembler
 	m_spHNC->set_coordinate_scale_factor_3d_to_1d(m_scaling_3d_to_1d_coordinates);
 	m_spHNC->set_current_subsets(plasmaMembraneSubsetName);
 
+	// footprints need to be recomputed after grid adaption or redistribution
+	SmartPtr<MultiGrid> spGrid = spApprox3d->domain()->grid();
+	m_spGridAdaptionCallbackID = spGrid->message_hub()->register_class_callback(this,
+		&HybridSynapseCurrentAssembler<TDomain, TAlgebra>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = spGrid->message_hub()->register_class_callback(this,
+		&HybridSynapseCurrentAssembler<TDomain, TAlgebra>::grid_distribution_callback);
+
 	// also save plasma membrane subset indices
     SubsetGroup ssGrp;
     try {ssGrp = SubsetGroup(spApprox3d->domain()->subset_handler(), plasmaMembraneSubsetName);}
@@ -105,7 +115,8 @@ HybridSynapseCurrentAssembler
 : m_fctInd(0), m_fctInd_ip3(0), m_ip3_set(false), m_F(96485.309), m_valency(2), m_current_percentage(0.1),
   m_spHNC(new hnc_type(spApprox3d, spApprox1d)), m_spDom(spApprox3d->domain()), m_sqSynRadius(0.04),
   m_scaling_3d_to_1d_amount_of_substance(1e-15), m_scaling_3d_to_1d_electric_charge(1.0), m_scaling_3d_to_1d_coordinates(1e-6), m_scaling_3d_to_1d_ip3(1e-15),
-  m_j_ip3_max(6e-19), m_j_ip3_decayRate(1.188), m_j_ip3_duration(3.0 / m_j_ip3_decayRate)
+  m_j_ip3_max(6e-19), m_j_ip3_decayRate(1.188), m_j_ip3_duration(3.0 / m_j_ip3_decayRate),
+  m_activityTime(0.0), m_bActivityValid(false), m_bFootprintsLinked(false)
 {
 	// get function index of whatever it is that the current carries (in our case: calcium)
 	FunctionGroup fctGrp(spApprox3d->function_pattern());
@@ -117,94 +128,300 @@ HybridSynapseCurrentAssembler
 	m_spHNC->set_synapse_handler(spSH);
 	m_spHNC->set_coordinate_scale_factor_3d_to_1d(m_scaling_3d_to_1d_coordinates);
 	m_spHNC->set_current_subsets(plasmaMembraneSubsetName);
+
+	// footprints need to be recomputed after grid adaption or redistribution
+	SmartPtr<MultiGrid> spGrid = spApprox3d->domain()->grid();
+	m_spGridAdaptionCallbackID = spGrid->message_hub()->register_class_callback(this,
+		&HybridSynapseCurrentAssembler<TDomain, TAlgebra>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = spGrid->message_hub()->register_class_callback(this,
+		&HybridSynapseCurrentAssembler<TDomain, TAlgebra>::grid_distribution_callback);
 }
 
 
 template <typename TDomain, typename TAlgebra>
-number HybridSynapseCurrentAssembler<TDomain, TAlgebra>::get_ip3(synapse_id sid, number time)
+number HybridSynapseCurrentAssembler<TDomain, TAlgebra>::
+ip3_production(const SynapseActivity& sa, number time) const
 {
-	// check whether vrt is newly active
-	typename std::map<synapse_id, number>::iterator it = m_mSynapseActivationTime.find(sid);
-	if (it == m_mSynapseActivationTime.end())
-	{
-		m_mSynapseActivationTime[sid] = time;
-		return m_j_ip3_max;
-	}
-
-	// check whether v is still active
-	if (time >= it->second + m_j_ip3_duration)
-	{
-		// erase entry
-		m_mSynapseActivationTime.erase(sid);
+	if (!sa.bIP3Active || time >= sa.ip3EndTime)
 		return 0.0;
-	}
 
-	return m_j_ip3_max * std::exp(m_j_ip3_decayRate*(it->second - time));
+	return sa.ip3Rate * std::exp(m_j_ip3_decayRate*(sa.ip3RefTime - time));
 }
 
+
 template <typename TDomain, typename TAlgebra>
-void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::adjust_defect
-(
-    vector_type& d,
-    const vector_type& u,
-    ConstSmartPtr<DoFDistribution> dd,
-    int type,
-    number time,
-    ConstSmartPtr<VectorTimeSeries<vector_type> > vSol,
-    const std::vector<number>* vScaleMass,
-    const std::vector<number>* vScaleStiff
-)
+void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::
+activate_ip3_production(SynapseActivity& sa, synapse_id id, number time)
 {
-	// we want to add inward currents to the defect
-	// at all vertices representing an active synapse (or more)
+	// the production of all activations decays with the same rate,
+	// so their sum is again a decaying exponential
+	sa.ip3Rate = ip3_production(sa, time) + m_j_ip3_max;
+	sa.ip3RefTime = time;
+	sa.bIP3Active = true;
+
+	// production is turned off when it has decayed to what it is m_j_ip3_duration
+	// after a single activation
+	sa.ip3EndTime = time + std::log(sa.ip3Rate / m_j_ip3_max) / m_j_ip3_decayRate + m_j_ip3_duration;
+	m_qIP3Expiry.push(std::make_pair(sa.ip3EndTime, id));
+}
 
-	// Using the m_spHNC, get a list of all synapse positions
-	// that are mapped to a (locally) active (1d) synapse;
-	// also get the corresponding current values at the same time.
-	typename std::vector<MathVector<dim> > vActiveList;
-	std::vector<number> vSynCurrent;
-	std::vector<synapse_id> vSynID;
 
+template <typename TDomain, typename TAlgebra>
+void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::update_synapse_activity(number time)
+{
+	// synaptic currents only change with the 1d solution
+	if (m_bActivityValid && time == m_activityTime)
+		return;
+
+	int rank = 0;
+	size_t nProcs = 1;
 #ifdef UG_PARALLEL
-	if (pcl::NumProcs() > 1)
+	rank = pcl::ProcRank();
+	nProcs = pcl::NumProcs();
+#endif
+	m_vvCurrentActiveSyn.resize(nProcs);
+
+	// get locally active synapses (sorted by ID)
+	std::vector<MathVector<dim> > vLocPos;
+	std::vector<number> vLocCurr;
+	std::vector<synapse_id> vLocID;
+	m_spHNC->gather_synaptic_currents(vLocPos, vLocCurr, vLocID, time);
+
+	const size_t nLoc = vLocID.size();
+	std::vector<size_t> vPerm(nLoc);
+	for (size_t i = 0; i < nLoc; ++i)
+		vPerm[i] = i;
+	std::sort(vPerm.begin(), vPerm.end(), IndexCompare(vLocID));
+
+	std::vector<number> vLocSortedCurr(nLoc);
+	for (size_t i = 0; i < nLoc; ++i)
+		vLocSortedCurr[i] = vLocCurr[vPerm[i]];
+
+	// find local changes w.r.t. the last update
+	std::vector<synapse_id> vLocAddedID;
+	std::vector<MathVector<dim> > vLocAddedPos;
+	std::vector<synapse_id> vLocRemovedID;
+	const std::vector<synapse_id>& vOldLoc = m_vvCurrentActiveSyn[rank];
+	const size_t nOldLoc = vOldLoc.size();
+	size_t i = 0;
+	size_t j = 0;
+	while (i < nLoc || j < nOldLoc)
 	{
-		typename std::vector<MathVector<dim> > vLocActiveList;
-		std::vector<number> vLocSynCurrent;
-		std::vector<synapse_id> vLocSynID;
-		m_spHNC->gather_synaptic_currents(vLocActiveList, vLocSynCurrent, vLocSynID, time);
+		if (j == nOldLoc || (i < nLoc && vLocID[vPerm[i]] < vOldLoc[j]))
+		{
+			vLocAddedID.push_back(vLocID[vPerm[i]]);
+			vLocAddedPos.push_back(vLocPos[vPerm[i]]);
+			++i;
+		}
+		else if (i == nLoc || vOldLoc[j] < vLocID[vPerm[i]])
+		{
+			vLocRemovedID.push_back(vOldLoc[j]);
+			++j;
+		}
+		else
+		{
+			++i;
+			++j;
+		}
+	}
 
-		// make all (3d) active synapse positions known to all procs
+	// make changes and currents known to all procs
+	std::vector<synapse_id> vAddedID;
+	std::vector<MathVector<dim> > vAddedPos;
+	std::vector<synapse_id> vRemovedID;
+	std::vector<number> vCurr;
+	std::vector<int> vAddedSizes, vAddedOffsets, vRemovedSizes, vRemovedOffsets;
+#ifdef UG_PARALLEL
+	if (nProcs > 1)
+	{
+		NC_TRACE_SCOPE("HybridSynapseCurrentAssembler::allgather_synapse_activity");
 		pcl::ProcessCommunicator com;
-		com.allgatherv(vActiveList, vLocActiveList, NULL, NULL);
-		com.allgatherv(vSynCurrent, vLocSynCurrent, NULL, NULL);
-		com.allgatherv(vSynID, vLocSynID, NULL, NULL);
+		com.allgatherv(vAddedID, vLocAddedID, &vAddedSizes, &vAddedOffsets);
+		com.allgatherv(vAddedPos, vLocAddedPos, NULL, NULL);
+		com.allgatherv(vRemovedID, vLocRemovedID, &vRemovedSizes, &vRemovedOffsets);
+		com.allgatherv(vCurr, vLocSortedCurr, NULL, NULL);
 	}
 	else
 #endif
-		m_spHNC->gather_synaptic_currents(vActiveList, vSynCurrent, vSynID, time);
+	{
+		vAddedSizes.assign(1, (int) vLocAddedID.size());
+		vAddedOffsets.assign(1, 0);
+		vRemovedSizes.assign(1, (int) vLocRemovedID.size());
+		vRemovedOffsets.assign(1, 0);
+		vAddedID.swap(vLocAddedID);
+		vAddedPos.swap(vLocAddedPos);
+		vRemovedID.swap(vLocRemovedID);
+		vCurr.swap(vLocSortedCurr);
+	}
 
+	// expire IP3 production
+	// (entries are outdated if the synapse has been activated again in the meantime)
+	while (!m_qIP3Expiry.empty() && time >= m_qIP3Expiry.top().first)
+	{
+		typename activity_map_type::iterator it = m_mSynapseActivity.find(m_qIP3Expiry.top().second);
+		if (it != m_mSynapseActivity.end() && it->second.bIP3Active
+			&& it->second.ip3EndTime == m_qIP3Expiry.top().first)
+		{
+			it->second.bIP3Active = false;
+			it->second.ip3Rate = 0.0;
+			if (!it->second.bCurrentActive)
+				m_mSynapseActivity.erase(it);
+		}
+		m_qIP3Expiry.pop();
+	}
 
+	// synapses removed on one proc and added on another have only changed procs;
+	// they keep their activity (including their IP3 production)
+	std::vector<synapse_id> vMigratedID;
+	{
+		std::vector<synapse_id> vAddedSorted(vAddedID);
+		std::vector<synapse_id> vRemovedSorted(vRemovedID);
+		std::sort(vAddedSorted.begin(), vAddedSorted.end());
+		std::sort(vRemovedSorted.begin(), vRemovedSorted.end());
+		std::set_intersection(vAddedSorted.begin(), vAddedSorted.end(),
+			vRemovedSorted.begin(), vRemovedSorted.end(), std::back_inserter(vMigratedID));
+	}
 
-	// calculate dt
-	// if the following happens, get dt from elsewhere (to be set and updated by user)
-	UG_COND_THROW(!vScaleStiff, "No stiffness scales given.");
+	// remove deactivated synapses (for all procs first, as synapses may have changed procs)
+	std::vector<synapse_id> vTmp;
+	for (size_t p = 0; p < nProcs; ++p)
+	{
+		const typename std::vector<synapse_id>::const_iterator itBegin = vRemovedID.begin() + vRemovedOffsets[p];
+		const typename std::vector<synapse_id>::const_iterator itEnd = itBegin + vRemovedSizes[p];
+		for (typename std::vector<synapse_id>::const_iterator itRm = itBegin; itRm != itEnd; ++itRm)
+		{
+			if (std::binary_search(vMigratedID.begin(), vMigratedID.end(), *itRm))
+				continue;
 
-	// sum of stiffness factors should be dt (shouldn't it!?)
-	number dt = 0.0;
-	size_t ntp = vScaleStiff->size();
-	for (size_t tp = 0; tp < ntp; ++tp)
-		dt += (*vScaleStiff)[tp];
+			typename activity_map_type::iterator it = m_mSynapseActivity.find(*itRm);
+			if (it == m_mSynapseActivity.end())
+				continue;
+
+			it->second.bCurrentActive = false;
+			it->second.current = 0.0;
+			if (!it->second.bIP3Active)
+				m_mSynapseActivity.erase(it);
+		}
+
+		std::vector<synapse_id>& vAct = m_vvCurrentActiveSyn[p];
+		vTmp.clear();
+		std::set_difference(vAct.begin(), vAct.end(), itBegin, itEnd, std::back_inserter(vTmp));
+		vAct.swap(vTmp);
+	}
+
+	// add newly activated synapses
+	for (size_t p = 0; p < nProcs; ++p)
+	{
+		const size_t addedEnd = vAddedOffsets[p] + vAddedSizes[p];
+		for (size_t k = vAddedOffsets[p]; k < addedEnd; ++k)
+		{
+			SynapseActivity& sa = m_mSynapseActivity[vAddedID[k]];
+			sa.pos = vAddedPos[k];
+			sa.bCurrentActive = true;
+			if (m_ip3_set && !std::binary_search(vMigratedID.begin(), vMigratedID.end(), vAddedID[k]))
+				activate_ip3_production(sa, vAddedID[k], time);
+		}
+
+		std::vector<synapse_id>& vAct = m_vvCurrentActiveSyn[p];
+		vTmp.clear();
+		std::merge(vAct.begin(), vAct.end(), vAddedID.begin() + vAddedOffsets[p],
+			vAddedID.begin() + addedEnd, std::back_inserter(vTmp));
+		vAct.swap(vTmp);
+	}
+
+	// update currents (they are communicated in the order of the active lists)
+	size_t offset = 0;
+	for (size_t p = 0; p < nProcs; ++p)
+	{
+		const std::vector<synapse_id>& vAct = m_vvCurrentActiveSyn[p];
+		const size_t nAct = vAct.size();
+		UG_COND_THROW(offset + nAct > vCurr.size(), "Active synapse lists out of sync with synaptic currents.");
+		for (size_t k = 0; k < nAct; ++k)
+			m_mSynapseActivity[vAct[k]].current = vCurr[offset + k];
+		offset += nAct;
+	}
+
+	// new synapses need to be linked to their footprints
+	if (vAddedID.size())
+		m_bFootprintsLinked = false;
+
+	m_activityTime = time;
+	m_bActivityValid = true;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+	{
+		m_mSynapseFootprint.clear();
+		m_bFootprintsLinked = false;
+	}
+}
 
 
+template <typename TDomain, typename TAlgebra>
+void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+	{
+		m_mSynapseFootprint.clear();
+		m_bFootprintsLinked = false;
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::update_synapse_footprints
+(
+	ConstSmartPtr<DoFDistribution> dd
+)
+{
+	// DoF indices are only valid for the DoF distribution they were computed with
+	if (dd.get() != m_spFootprintDD.get())
+	{
+		m_mSynapseFootprint.clear();
+		m_spFootprintDD = dd;
+		m_bFootprintsLinked = false;
+	}
+
+	// nothing to do if neither the active set nor the footprints have changed
+	if (m_bFootprintsLinked)
+		return;
+
+	// link active synapses to their footprints and find those without one
+	// (the active set is the same on all procs, so this is, too)
+	std::vector<synapse_id> vNewID;
+	std::vector<MathVector<dim> > vNewPos;
+	std::vector<SynapseActivity*> vNewActivity;
+	typename activity_map_type::iterator itAct = m_mSynapseActivity.begin();
+	typename activity_map_type::iterator itActEnd = m_mSynapseActivity.end();
+	for (; itAct != itActEnd; ++itAct)
+	{
+		typename std::map<synapse_id, SynapseFootprint>::const_iterator itFp = m_mSynapseFootprint.find(itAct->first);
+		if (itFp != m_mSynapseFootprint.end())
+			itAct->second.footprint = &itFp->second;
+		else
+		{
+			vNewID.push_back(itAct->first);
+			vNewPos.push_back(itAct->second.pos);
+			vNewActivity.push_back(&itAct->second);
+		}
+	}
+
+	m_bFootprintsLinked = true;
+
+	const size_t nNew = vNewID.size();
+	if (!nNew)
+		return;
+
 	// loop all surface sides in membrane subsets
 	typename TDomain::position_accessor_type& aaPos = m_spDom->position_accessor();
-	SmartPtr<ISubsetHandler> sh = m_spDom->subset_handler();
-	typedef typename domain_traits<TDomain::dim>::side_type side_type;
 	typedef typename DoFDistribution::traits<side_type>::const_iterator const_side_iter;
 
-	const size_t nSyn = vActiveList.size();
-	std::vector<number> totalSynAreaLocal(nSyn, 0.0);
-	std::vector<std::vector<side_type*> > elemsForSyn(nSyn);
+	std::vector<number> totalSynAreaLocal(nNew, 0.0);
+	std::vector<std::vector<side_type*> > elemsForSyn(nNew);
 	const size_t nSs = m_vMembraneSI.size();
 	for (size_t ss = 0; ss < nSs; ++ss)
 	{
@@ -215,11 +432,11 @@ void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::adjust_defect
 		{
 			side_type* side = *it;
 
-			// loop all active synapse positions and find out whether
+			// loop all new synapse positions and find out whether
 			// the current element is in their range
-			for (size_t s = 0; s < nSyn; ++s)
+			for (size_t s = 0; s < nNew; ++s)
 			{
-				if (VecDistanceSq(vActiveList[s], CalculateCenter(side, aaPos)) < m_sqSynRadius)
+				if (VecDistanceSq(vNewPos[s], CalculateCenter(side, aaPos)) < m_sqSynRadius)
 				{
 					totalSynAreaLocal[s] += CalculateVolume(side, aaPos);
 					elemsForSyn[s].push_back(side);
@@ -230,7 +447,7 @@ void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::adjust_defect
 					const size_t nVrt = side->num_vertices();
 					for (size_t v = 0; v < nVrt; ++v)
 					{
-						if (VecDistanceSq(aaPos[side->vertex(v)], vActiveList[s]) < 1e-10*m_sqSynRadius)
+						if (VecDistanceSq(aaPos[side->vertex(v)], vNewPos[s]) < 1e-10*m_sqSynRadius)
 						{
 							totalSynAreaLocal[s] += CalculateVolume(side, aaPos);
 							elemsForSyn[s].push_back(side);
@@ -251,85 +468,127 @@ void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::adjust_defect
 	}
 #endif
 
-	// now treat all synapses
+	// each vertex of a footprint side gets an equal part of the side's area
 	std::vector<DoFIndex> vDoFIndex;
-	for (size_t s = 0; s < nSyn; ++s)
+	for (size_t s = 0; s < nNew; ++s)
 	{
-		const size_t nElems = elemsForSyn[s].size();
-		if (!nElems)
-			continue;
-
-		const std::vector<side_type*>& vElems = elemsForSyn[s];
+		SynapseFootprint& fp = m_mSynapseFootprint[vNewID[s]];
+		vNewActivity[s]->footprint = &fp;
+		fp.vSide.swap(elemsForSyn[s]);
+		fp.totalArea = totalSynArea[s];
 
-		// if the potential rises high, synaptic currents are reversed;
-		// we need to exclude calcium from this effect
-		// TODO: this is a bit awkward, better use proper Ca2+ entry modeling
-		if (vSynCurrent[s] < 0.0)
+		std::map<Vertex*, number> mVrtWeight;
+		const size_t nElems = fp.vSide.size();
+		for (size_t e = 0; e < nElems; ++e)
 		{
-			const number substanceCurrent = vSynCurrent[s] * m_current_percentage / (m_valency*m_F) / m_scaling_3d_to_1d_amount_of_substance;
-			const number fluxDensity = substanceCurrent / totalSynArea[s];
+			side_type* elem = fp.vSide[e];
+			const size_t nSynElemVrts = elem->num_vertices();
+			const number areaPerNode = CalculateVolume(elem, aaPos) / nSynElemVrts;
+			for (size_t n = 0; n < nSynElemVrts; ++n)
+				mVrtWeight[elem->vertex(n)] += areaPerNode;
+		}
 
-			// loop all elems participating in that synapse
-			for (size_t e = 0; e < nElems; ++e)
-			{
-				side_type* elem = vElems[e];
-				const size_t nSynElemVrts = elem->num_vertices();
+		typename std::map<Vertex*, number>::const_iterator itVrt = mVrtWeight.begin();
+		typename std::map<Vertex*, number>::const_iterator itVrtEnd = mVrtWeight.end();
+		for (; itVrt != itVrtEnd; ++itVrt)
+		{
+			Vertex* node = itVrt->first;
 
-				// each node gets an equal part of this synElem's current
-				const number currentPerNode = fluxDensity * CalculateVolume(elem, aaPos) / nSynElemVrts;
-				for (size_t n = 0; n < nSynElemVrts; ++n)
-				{
-					Vertex* node = elem->vertex(n);
+			// get the DoFIndex for this vertex
+			dd->inner_dof_indices(node, m_fctInd, vDoFIndex, true);
+			UG_COND_THROW(!vDoFIndex.size(), "Function for flowing substance is not defined for "
+				<< ElementDebugInfo(*m_spDom->grid(), node) << ".")
 
-					// get the DoFIndex for this vertex
-					dd->inner_dof_indices(node, m_fctInd, vDoFIndex, true);
-					UG_COND_THROW(!vDoFIndex.size(), "Function for flowing substance is not defined for "
-						<< ElementDebugInfo(*this->m_spApproxSpace->domain()->grid(), node) << ".")
+			UG_ASSERT(vDoFIndex.size() == 1, "Apparently, you are using shape functions different from P1,"
+				" this is not supported.");
+			fp.vDoF.push_back(vDoFIndex[0]);
 
-					UG_ASSERT(vDoFIndex.size() == 1, "Apparently, you are using shape functions different from P1,"
-						" this is not supported.");
-					const DoFIndex& dofInd = vDoFIndex[0];
+			if (m_ip3_set)
+			{
+				dd->inner_dof_indices(node, m_fctInd_ip3, vDoFIndex, true);
+				UG_COND_THROW(!vDoFIndex.size(), "Function for IP3 is not defined for "
+					<< ElementDebugInfo(*m_spDom->grid(), node) << ".")
 
-					// currents are outward in the synapse handler, so we _add_ to defect
-					DoFRef(d, dofInd) += dt * currentPerNode;
-				}
+				UG_ASSERT(vDoFIndex.size() == 1, "Apparently, you are using shape functions different from P1,"
+					" this is not supported.");
+				fp.vDoFIP3.push_back(vDoFIndex[0]);
 			}
+
+			fp.vWeight.push_back(itVrt->second);
 		}
+	}
+}
 
-		// same for IP3 currents
-		if (!m_ip3_set)
-			return;
 
-		const synapse_id sid = vSynID[s];
+template <typename TDomain, typename TAlgebra>
+void HybridSynapseCurrentAssembler<TDomain, TAlgebra>::adjust_defect
+(
+    vector_type& d,
+    const vector_type& u,
+    ConstSmartPtr<DoFDistribution> dd,
+    int type,
+    number time,
+    ConstSmartPtr<VectorTimeSeries<vector_type> > vSol,
+    const std::vector<number>* vScaleMass,
+    const std::vector<number>* vScaleStiff
+)
+{
+	// we want to add inward currents to the defect
+	// at all vertices representing an active synapse (or more)
 
-		const number substanceCurrent = get_ip3(sid, time) / m_scaling_3d_to_1d_ip3;
-		const number fluxDensity = substanceCurrent / totalSynArea[s];
+	// get all synapses that are active in 1d or still produce IP3
+	// (their positions and currents are known to all procs)
+	// and their 3d footprints
+	update_synapse_activity(time);
+	update_synapse_footprints(dd);
 
-		// loop all elems participating in that synapse
-		for (size_t e = 0; e < nElems; ++e)
-		{
-			side_type* elem = vElems[e];
-			const size_t nSynElemVrts = elem->num_vertices();
 
-			// each node gets an equal part of this synElem's current
-			const number currentPerNode = fluxDensity * CalculateVolume(elem, aaPos) / nSynElemVrts;
-			for (size_t n = 0; n < nSynElemVrts; ++n)
-			{
-				Vertex* node = elem->vertex(n);
+	// calculate dt
+	// if the following happens, get dt from elsewhere (to be set and updated by user)
+	UG_COND_THROW(!vScaleStiff, "No stiffness scales given.");
 
-				// get the DoFIndex for this vertex
-				dd->inner_dof_indices(node, m_fctInd_ip3, vDoFIndex, true);
-				UG_COND_THROW(!vDoFIndex.size(), "Function for IP3 is not defined for "
-					<< ElementDebugInfo(*this->m_spApproxSpace->domain()->grid(), node) << ".")
+	// sum of stiffness factors should be dt (shouldn't it!?)
+	number dt = 0.0;
+	size_t ntp = vScaleStiff->size();
+	for (size_t tp = 0; tp < ntp; ++tp)
+		dt += (*vScaleStiff)[tp];
 
-				UG_ASSERT(vDoFIndex.size() == 1, "Apparently, you are using shape functions different from P1,"
-					" this is not supported.");
-				const DoFIndex& dofInd = vDoFIndex[0];
 
-				// currents are inward here, so we _subtract_ from defect
-				DoFRef(d, dofInd) -= dt * currentPerNode;
-			}
+	// now treat all synapses
+	typename activity_map_type::const_iterator itAct = m_mSynapseActivity.begin();
+	typename activity_map_type::const_iterator itActEnd = m_mSynapseActivity.end();
+	for (; itAct != itActEnd; ++itAct)
+	{
+		const SynapseActivity& sa = itAct->second;
+		UG_ASSERT(sa.footprint, "Active synapse " << itAct->first << " is not linked to a footprint.");
+		const SynapseFootprint& fp = *sa.footprint;
+		const size_t nNodes = fp.vWeight.size();
+		if (!nNodes)
+			continue;
+
+		// if the potential rises high, synaptic currents are reversed;
+		// we need to exclude calcium from this effect
+		// TODO: this is a bit awkward, better use proper Ca2+ entry modeling
+		if (sa.bCurrentActive && sa.current < 0.0)
+		{
+			const number substanceCurrent = sa.current * m_current_percentage / (m_valency*m_F) / m_scaling_3d_to_1d_amount_of_substance;
+			const number fluxDensity = substanceCurrent / fp.totalArea;
+
+			// currents are outward in the synapse handler, so we _add_ to defect
+			for (size_t n = 0; n < nNodes; ++n)
+				DoFRef(d, fp.vDoF[n]) += dt * fluxDensity * fp.vWeight[n];
 		}
+
+		// same for IP3 currents
+		if (!m_ip3_set || !sa.bIP3Active)
+			continue;
+
+		const number substanceCurrent = ip3_production(sa, time) / m_scaling_3d_to_1d_ip3;
+		const number fluxDensity = substanceCurrent / fp.totalArea;
+
+		// currents are inward here, so we _subtract_ from defect
+		for (size_t n = 0; n < nNodes; ++n)
+			DoFRef(d, fp.vDoFIP3[n]) -= dt * fluxDensity * fp.vWeight[n];
 	}
 }
 
@@ -356,30 +615,11 @@ adjust_error
 		<< std::endl << "Make sure you handed the correct type of ErrEstData to this discretization.");
 
 
-	// Using the m_spHNC, get a list of all synapse positions
-	// that are mapped to a (locally) active (1d) synapse;
-	// also get the corresponding current values at the same time.
-	typename std::vector<MathVector<dim> > vActiveList;
-	std::vector<number> vSynCurrent;
-	std::vector<synapse_id> vSynID;
-
-#ifdef UG_PARALLEL
-	if (pcl::NumProcs() > 1)
-	{
-		typename std::vector<MathVector<dim> > vLocActiveList;
-		std::vector<number> vLocSynCurrent;
-		std::vector<synapse_id> vLocSynID;
-		m_spHNC->gather_synaptic_currents(vLocActiveList, vLocSynCurrent, vLocSynID, time);
-
-		// make all (3d) active synapse positions known to all procs
-		pcl::ProcessCommunicator com;
-		com.allgatherv(vActiveList, vLocActiveList, NULL, NULL);
-		com.allgatherv(vSynCurrent, vLocSynCurrent, NULL, NULL);
-		com.allgatherv(vSynID, vLocSynID, NULL, NULL);
-	}
-	else
-#endif
-		m_spHNC->gather_synaptic_currents(vActiveList, vSynCurrent, vSynID, time);
+	// get all synapses that are active in 1d or still produce IP3
+	// (their positions and currents are known to all procs)
+	// and their 3d footprints
+	update_synapse_activity(time);
+	update_synapse_footprints(dd);
 
 
 	// calculate dt
@@ -393,78 +633,27 @@ adjust_error
 		dt += (*vScaleStiff)[tp];
 
 
-	// loop all surface sides in membrane subsets
-	typename TDomain::position_accessor_type& aaPos = m_spDom->position_accessor();
-	SmartPtr<ISubsetHandler> sh = m_spDom->subset_handler();
-	typedef typename domain_traits<TDomain::dim>::side_type side_type;
-	typedef typename DoFDistribution::traits<side_type>::const_iterator const_side_iter;
-
-	const size_t nSyn = vActiveList.size();
-	std::vector<number> totalSynAreaLocal(nSyn, 0.0);
-	std::vector<std::vector<side_type*> > elemsForSyn(nSyn);
-	const size_t nSs = m_vMembraneSI.size();
-	for (size_t ss = 0; ss < nSs; ++ss)
-	{
-		const int si = m_vMembraneSI[ss];
-		const_side_iter it = dd->begin<side_type>(si);
-		const_side_iter itEnd = dd->end<side_type>(si);
-		for (; it != itEnd; ++it)
-		{
-			side_type* side = *it;
-
-			// loop all active synapse positions and find out whether
-			// the current element is in their range
-			for (size_t s = 0; s < nSyn; ++s)
-			{
-				if (VecDistanceSq(vActiveList[s], CalculateCenter(side, aaPos)) < m_sqSynRadius)
-				{
-					totalSynAreaLocal[s] += CalculateVolume(side, aaPos);
-					elemsForSyn[s].push_back(side);
-				}
-				// at least directly adjacent elements need to be used
-				else
-				{
-					const size_t nVrt = side->num_vertices();
-					for (size_t v = 0; v < nVrt; ++v)
-					{
-						if (VecDistanceSq(aaPos[side->vertex(v)], vActiveList[s]) < 1e-10*m_sqSynRadius)
-						{
-							totalSynAreaLocal[s] += CalculateVolume(side, aaPos);
-							elemsForSyn[s].push_back(side);
-							break;
-						}
-					}
-				}
-			}
-		}
-	}
-
-	std::vector<number> totalSynArea = totalSynAreaLocal;
-#ifdef UG_PARALLEL
-	if (pcl::NumProcs() > 1)
-	{
-		pcl::ProcessCommunicator pc;
-		pc.allreduce(totalSynAreaLocal, totalSynArea, PCL_RO_SUM);
-	}
-#endif
-
-
 	// now treat all synapses
-	for (size_t s = 0; s < nSyn; ++s)
+	typename activity_map_type::const_iterator itAct = m_mSynapseActivity.begin();
+	typename activity_map_type::const_iterator itActEnd = m_mSynapseActivity.end();
+	for (; itAct != itActEnd; ++itAct)
 	{
-		const size_t nElems = elemsForSyn[s].size();
+		const SynapseActivity& sa = itAct->second;
+		UG_ASSERT(sa.footprint, "Active synapse " << itAct->first << " is not linked to a footprint.");
+		const SynapseFootprint& fp = *sa.footprint;
+		const size_t nElems = fp.vSide.size();
 		if (!nElems)
 			continue;
 
-		const std::vector<side_type*>& vElems = elemsForSyn[s];
+		const std::vector<side_type*>& vElems = fp.vSide;
 
 		// if the potential rises high, synaptic currents are reversed;
 		// we need to exclude calcium from this effect
 		// TODO: this is a bit awkward, better use proper Ca2+ entry modeling
-		if (vSynCurrent[s] < 0.0)
+		if (sa.bCurrentActive && sa.current < 0.0)
 		{
-			const number substanceCurrent = vSynCurrent[s] * m_current_percentage / (m_valency*m_F) / m_scaling_3d_to_1d_amount_of_substance;
-			const number fluxDensity = substanceCurrent / totalSynArea[s];
+			const number substanceCurrent = sa.current * m_current_percentage / (m_valency*m_F) / m_scaling_3d_to_1d_amount_of_substance;
+			const number fluxDensity = substanceCurrent / fp.totalArea;
 
 			// loop all elems participating in that synapse
 			for (size_t e = 0; e < nElems; ++e)
@@ -474,10 +663,6 @@ adjust_error
 				// get reference object id
 				ReferenceObjectID roid = elem->reference_object_id();
 
-				// get corner coords (for later use in calculating global IPs)
-				std::vector<typename TDomain::position_type> vCoCo;
-				CollectCornerCoordinates(vCoCo, elem, *m_spDom, false);
-
 				// substract constant flux density value from every IP on the side
 				size_t numSideIPs;
 				try	{numSideIPs = err_est_data->get(m_fctInd)->num_side_ips(roid);}
@@ -489,13 +674,11 @@ adjust_error
 		}
 
 		// same for IP3 currents
-		if (!m_ip3_set)
-			return;
-
-		const synapse_id sid = vSynID[s];
+		if (!m_ip3_set || !sa.bIP3Active)
+			continue;
 
-		const number substanceCurrent = get_ip3(sid, time) / m_scaling_3d_to_1d_ip3;
-		const number fluxDensity = substanceCurrent / totalSynArea[s];
+		const number substanceCurrent = ip3_production(sa, time) / m_scaling_3d_to_1d_ip3;
+		const number fluxDensity = substanceCurrent / fp.totalArea;
 
 		// loop all elems participating in that synapse
 		for (size_t e = 0; e < nElems; ++e)
@@ -505,10 +688,6 @@ adjust_error
 			// get reference object id
 			ReferenceObjectID roid = elem->reference_object_id();
 
-			// get corner coords (for later use in calculating global IPs)
-			std::vector<typename TDomain::position_type> vCoCo;
-			CollectCornerCoordinates(vCoCo, elem, *m_spDom, false);
-
 			size_t numSideIPs;
 			try {numSideIPs = err_est_data->get(m_fctInd_ip3)->num_side_ips(roid);}
 			UG_CATCH_THROW("Number of side integration points for error estimator cannot be determined.");
@@ -0,0 +1,503 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "lumped_mitochondria_fv1.h"
+#include "bindings/lua/lua_user_data.h"
+#include "common/util/string_util.h"  // for TokenizeTrimString
+#include "lib_disc/spatial_disc/disc_util/geom_provider.h"
+#include "util/expression_user_data.h"  // for ExpressionUserData
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template<typename TDomain>
+LumpedMitochondriaFV1<TDomain>::LumpedMitochondriaFV1(const char* mitFcts, const char* subsets)
+: IElemDisc<TDomain>("", ""), m_nMitFct(0), m_volFrac(0.0), m_currSI(-1)
+{
+	this->IElemDisc<TDomain>::set_subsets(subsets);
+
+	TokenizeTrimString(std::string(mitFcts), m_vFct, ',');
+	m_nMitFct = m_vFct.size();
+	UG_COND_THROW(!m_nMitFct, "LumpedMitochondriaFV1: No mitochondrial functions given.");
+	this->IElemDisc<TDomain>::set_functions(m_vFct);
+}
+
+
+template<typename TDomain>
+LumpedMitochondriaFV1<TDomain>::LumpedMitochondriaFV1
+(
+	const std::vector<std::string>& mitFcts,
+	const std::vector<std::string>& subsets
+)
+: IElemDisc<TDomain>("", ""), m_vFct(mitFcts), m_nMitFct(mitFcts.size()), m_volFrac(0.0), m_currSI(-1)
+{
+	this->IElemDisc<TDomain>::set_subsets(subsets);
+
+	UG_COND_THROW(!m_nMitFct, "LumpedMitochondriaFV1: No mitochondrial functions given.");
+	this->IElemDisc<TDomain>::set_functions(m_vFct);
+}
+
+
+template<typename TDomain>
+LumpedMitochondriaFV1<TDomain>::~LumpedMitochondriaFV1()
+{}
+
+
+template<typename TDomain>
+void LumpedMitochondriaFV1<TDomain>::set_volume_fraction(number phi)
+{
+	UG_COND_THROW(phi <= 0.0 || phi >= 1.0, "LumpedMitochondriaFV1: Mitochondrial volume fraction "
+		"must be in (0,1), but " << phi << " was given.");
+	m_volFrac = phi;
+}
+
+
+template<typename TDomain>
+void LumpedMitochondriaFV1<TDomain>::add_membrane_transporter
+(
+	SmartPtr<IMembraneTransporter> mt,
+	SmartPtr<CplUserData<number,dim> > densityFct
+)
+{
+	UG_COND_THROW(!mt.valid(), "Invalid membrane transport mechanism given.");
+	UG_COND_THROW(!densityFct.valid(), "No density information given for "
+		<< mt->name() << " membrane transport mechanism.");
+
+	// check validity of transporter setup and then lock
+	mt->check_and_lock();
+
+	TransporterEntry te;
+	te.spMT = mt;
+	te.spDensityFct = densityFct;
+
+	// map supplied functions of the mechanism to functions of this disc
+	const std::vector<std::string>& vFct = mt->symb_fcts();
+	const size_t nFct = vFct.size();
+	te.vFctMap.resize(nFct);
+	for (size_t i = 0; i < nFct; ++i)
+	{
+		size_t j = 0;
+		for (; j < m_vFct.size(); ++j)
+			if (m_vFct[j] == vFct[i])
+				break;
+		if (j == m_vFct.size())
+			m_vFct.push_back(vFct[i]);
+		te.vFctMap[i] = j;
+	}
+
+	// flux directions
+	const size_t nFlux = mt->n_fluxes();
+	te.vFrom.resize(nFlux);
+	te.vTo.resize(nFlux);
+	for (size_t i = 0; i < nFlux; ++i)
+	{
+		const std::pair<size_t, size_t> fromTo = mt->flux_from_to(i);
+		te.vFrom[i] = fromTo.first == InnerBoundaryConstants::_IGNORE_ ? fromTo.first : te.vFctMap[fromTo.first];
+		te.vTo[i] = fromTo.second == InnerBoundaryConstants::_IGNORE_ ? fromTo.second : te.vFctMap[fromTo.second];
+	}
+
+	m_vTransporter.push_back(te);
+
+	this->IElemDisc<TDomain>::set_functions(m_vFct);
+}
+
+template<typename TDomain>
+void LumpedMitochondriaFV1<TDomain>::add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const number dens)
+{
+	add_membrane_transporter(mt, make_sp(new ConstUserNumber<dim>(dens)));
+}
+
+template<typename TDomain>
+void LumpedMitochondriaFV1<TDomain>::add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const char* name)
+{
+	// name must be a valid lua function name conforming to LuaUserNumber specs
+	if (LuaUserData<number, dim>::check_callback_returns(name))
+	{
+		add_membrane_transporter(mt, LuaUserDataFactory<number, dim>::create(name));
+		return;
+	}
+
+	// closed-form expression in x, y, z and t (evaluated natively)
+	if (ExpressionUserData<dim>::is_valid(name))
+	{
+		add_membrane_transporter(mt, make_sp(new ExpressionUserData<dim>(name)));
+		return;
+	}
+
+	// no match found
+	if (!CheckLuaCallbackName(name))
+		UG_THROW("Lua-Callback with name '" << name << "' does not exist.");
+
+	// name exists, but wrong signature
+	UG_THROW("Cannot find matching callback signature. Use:\n"
+			"Number - Callback\n" << (LuaUserData<number, dim>::signature()) << "\n");
+}
+
+
+template<typename TDomain>
+void LumpedMitochondriaFV1<TDomain>::
+prepare_setting(const std::vector<LFEID>& vLfeID, bool bNonRegularGrid)
+{
+	UG_COND_THROW(m_vTransporter.empty(), "No membrane transport mechanism has been added "
+		"to LumpedMitochondriaFV1. Please add using add_membrane_transporter().");
+	UG_COND_THROW(m_volFrac <= 0.0, "No mitochondrial volume fraction has been set "
+		"in LumpedMitochondriaFV1. Please set using set_volume_fraction().");
+
+	// check that Lagrange 1st order
+	for (size_t i = 0; i < vLfeID.size(); ++i)
+		if (vLfeID[i].type() != LFEID::LAGRANGE || vLfeID[i].order() != 1)
+			UG_THROW("LumpedMitochondriaFV1: 1st order Lagrange expected.");
+
+	// provide scratch buffers for all threads
+	m_batchScratch.ensure_capacity();
+	for (size_t t = 0; t < m_vTransporter.size(); ++t)
+		m_vTransporter[t].spMT->prepare_threads();
+
+	// update assemble functions
+	register_all_fv1_funcs();
+}
+
+template<typename TDomain>
+bool LumpedMitochondriaFV1<TDomain>::
+use_hanging() const
+{
+	return false;
+}
+
+
+template<typename TDomain>
+void LumpedMitochondriaFV1<TDomain>::prep_timestep
+(
+    number future_time,
+    number time,
+    VectorProxyBase* upb
+)
+{
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+		m_vTransporter[t].spMT->prepare_timestep(future_time, time, upb);
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+prep_elem_loop(const ReferenceObjectID roid, const int si)
+{
+	m_currSI = si;
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+fsh_elem_loop()
+{}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+prep_elem(const LocalVector& u, GridObject* elem, const ReferenceObjectID roid, const MathVector<dim> vCornerCoords[])
+{
+	// update geometry for this element
+	static TFVGeom& geo = GeomProvider<TFVGeom>::get();
+	try {geo.update(elem, vCornerCoords, &(this->subset_handler()));}
+	UG_CATCH_THROW("LumpedMitochondriaFV1::prep_elem: "
+						"Cannot update Finite Volume Geometry.");
+}
+
+
+template<typename TDomain>
+template<typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+gather_batch_input
+(
+	const TFVGeom& fvgeom,
+	const LocalVector& u,
+	GridObject* elem,
+	const TransporterEntry& te,
+	BatchScratch& bs
+) const
+{
+	// solution at SCV corners in structure-of-arrays layout
+	const size_t nFct = te.vFctMap.size();
+	const size_t nScv = fvgeom.num_scv();
+	bs.vU.resize(nFct * nScv);
+	bs.vElem.assign(nScv, elem);
+	for (size_t i = 0; i < nScv; ++i)
+	{
+		const int co = fvgeom.scv(i).node_id();
+		for (size_t fct = 0; fct < nFct; ++fct)
+			bs.vU[fct*nScv + i] = u(te.vFctMap[fct], co);
+	}
+}
+
+
+template<typename TDomain>
+template<typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+scv_scales(const TFVGeom& fvgeom, const TransporterEntry& te, BatchScratch& bs) const
+{
+	const size_t nScv = fvgeom.num_scv();
+	bs.vScale.resize(nScv);
+	for (size_t i = 0; i < nScv; ++i)
+	{
+		const typename TFVGeom::SCV& scv = fvgeom.scv(i);
+		number density;
+		(*te.spDensityFct)(density, scv.global_ip(), this->time(), m_currSI);
+		bs.vScale[i] = density * scv.volume();
+	}
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+add_jac_A_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{
+	// get finite volume geometry
+	static const TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const size_t nScv = fvgeom.num_scv();
+
+	BatchScratch& bs = m_batchScratch.local();
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+	{
+		const TransporterEntry& te = m_vTransporter[t];
+
+		// evaluate flux derivatives for all SCVs in one batch
+		gather_batch_input(fvgeom, u, elem, te, bs);
+		te.spMT->flux_deriv_batch(bs.vU, bs.vElem, bs.vDerivFct, bs.vDeriv);
+		scv_scales(fvgeom, te, bs);
+
+		const size_t nFlux = te.vFrom.size();
+		const size_t nDep = te.spMT->n_dependencies();
+		for (size_t i = 0; i < nScv; ++i)
+		{
+			const int co = fvgeom.scv(i).node_id();
+			const number scale = bs.vScale[i];
+
+			for (size_t j = 0; j < nFlux; ++j)
+			{
+				for (size_t k = 0; k < nDep; ++k)
+				{
+					const size_t fct = te.vFctMap[bs.vDerivFct[j*nDep + k]];
+					const number val = bs.vDeriv[(j*nDep + k)*nScv + i] * scale;
+					if (te.vFrom[j] != InnerBoundaryConstants::_IGNORE_)
+						J(te.vFrom[j], co, fct, co) += val;
+					if (te.vTo[j] != InnerBoundaryConstants::_IGNORE_)
+						J(te.vTo[j], co, fct, co) -= val;
+				}
+			}
+		}
+	}
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+add_jac_M_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{
+	// get finite volume geometry
+	static const TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+
+	// mitochondrial storage only
+	const size_t nScv = fvgeom.num_scv();
+	for (size_t i = 0; i < nScv; ++i)
+	{
+		const typename TFVGeom::SCV& scv = fvgeom.scv(i);
+		const int co = scv.node_id();
+		const number vol = m_volFrac * scv.volume();
+		for (size_t fct = 0; fct < m_nMitFct; ++fct)
+			J(fct, co, fct, co) += vol;
+	}
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+add_def_A_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{
+	// get finite volume geometry
+	static const TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const size_t nScv = fvgeom.num_scv();
+
+	BatchScratch& bs = m_batchScratch.local();
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+	{
+		const TransporterEntry& te = m_vTransporter[t];
+
+		// evaluate fluxes for all SCVs in one batch
+		gather_batch_input(fvgeom, u, elem, te, bs);
+		te.spMT->flux_batch(bs.vU, bs.vElem, bs.vFlux);
+		scv_scales(fvgeom, te, bs);
+
+		const size_t nFlux = te.vFrom.size();
+		for (size_t i = 0; i < nScv; ++i)
+		{
+			const int co = fvgeom.scv(i).node_id();
+			const number scale = bs.vScale[i];
+
+			for (size_t j = 0; j < nFlux; ++j)
+			{
+				const number flux = bs.vFlux[j*nScv + i] * scale;
+				if (te.vFrom[j] != InnerBoundaryConstants::_IGNORE_)
+					d(te.vFrom[j], co) += flux;
+				if (te.vTo[j] != InnerBoundaryConstants::_IGNORE_)
+					d(te.vTo[j], co) -= flux;
+			}
+		}
+	}
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+add_def_M_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{
+	// get finite volume geometry
+	static const TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+
+	// mitochondrial storage only
+	const size_t nScv = fvgeom.num_scv();
+	for (size_t i = 0; i < nScv; ++i)
+	{
+		const typename TFVGeom::SCV& scv = fvgeom.scv(i);
+		const int co = scv.node_id();
+		const number vol = m_volFrac * scv.volume();
+		for (size_t fct = 0; fct < m_nMitFct; ++fct)
+			d(fct, co) += u(fct, co) * vol;
+	}
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::
+add_rhs_elem(LocalVector& rhs, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{}
+
+
+
+// ////////////////////////////////////////////////////////////////////////////
+//	register assemble functions
+// ////////////////////////////////////////////////////////////////////////////
+
+#ifdef UG_DIM_1
+template <>
+void LumpedMitochondriaFV1<Domain1d>::register_all_fv1_funcs()
+{
+	// register prep_timestep function for all known algebra types
+	Register<bridge::CompileAlgebraList>(this);
+
+	register_fv1_func<RegularEdge, FV1Geometry<RegularEdge, dim> >();
+}
+#endif
+
+#ifdef UG_DIM_2
+template <>
+void LumpedMitochondriaFV1<Domain2d>::register_all_fv1_funcs()
+{
+	// register prep_timestep function for all known algebra types
+	Register<bridge::CompileAlgebraList>(this);
+
+	register_fv1_func<RegularEdge, FV1Geometry<RegularEdge, dim> >();
+	register_fv1_func<Triangle, FV1Geometry<Triangle, dim> >();
+	register_fv1_func<Quadrilateral, FV1Geometry<Quadrilateral, dim> >();
+}
+#endif
+
+#ifdef UG_DIM_3
+template <>
+void LumpedMitochondriaFV1<Domain3d>::register_all_fv1_funcs()
+{
+	// register prep_timestep function for all known algebra types
+	Register<bridge::CompileAlgebraList>(this);
+
+	register_fv1_func<RegularEdge, FV1Geometry<RegularEdge, dim> >();
+	register_fv1_func<Triangle, FV1Geometry<Triangle, dim> >();
+	register_fv1_func<Quadrilateral, FV1Geometry<Quadrilateral, dim> >();
+	register_fv1_func<Tetrahedron, FV1Geometry<Tetrahedron, dim> >();
+	register_fv1_func<Prism, FV1Geometry<Prism, dim> >();
+	register_fv1_func<Pyramid, FV1Geometry<Pyramid, dim> >();
+	register_fv1_func<Hexahedron, FV1Geometry<Hexahedron, dim> >();
+	register_fv1_func<Octahedron, FV1Geometry<Octahedron, dim> >();
+}
+#endif
+
+template<typename TDomain>
+template <typename TElem, typename TFVGeom>
+void LumpedMitochondriaFV1<TDomain>::register_fv1_func()
+{
+	ReferenceObjectID id = geometry_traits<TElem>::REFERENCE_OBJECT_ID;
+
+	this->clear_add_fct(id);
+	this->set_prep_elem_loop_fct(	id, &this_type::template prep_elem_loop<TElem, TFVGeom>);
+	this->set_prep_elem_fct(	 	id, &this_type::template prep_elem<TElem, TFVGeom>);
+	this->set_fsh_elem_loop_fct( 	id, &this_type::template fsh_elem_loop<TElem, TFVGeom>);
+	this->set_add_jac_A_elem_fct(	id, &this_type::template add_jac_A_elem<TElem, TFVGeom>);
+	this->set_add_jac_M_elem_fct(	id, &this_type::template add_jac_M_elem<TElem, TFVGeom>);
+	this->set_add_def_A_elem_fct(	id, &this_type::template add_def_A_elem<TElem, TFVGeom>);
+	this->set_add_def_M_elem_fct(	id, &this_type::template add_def_M_elem<TElem, TFVGeom>);
+	this->set_add_rhs_elem_fct(	 	id, &this_type::template add_rhs_elem<TElem, TFVGeom>);
+}
+
+
+
+// explicit template specializations
+#ifdef UG_DIM_1
+	template class LumpedMitochondriaFV1<Domain1d>;
+#endif
+#ifdef UG_DIM_2
+	template class LumpedMitochondriaFV1<Domain2d>;
+#endif
+#ifdef UG_DIM_3
+	template class LumpedMitochondriaFV1<Domain3d>;
+#endif
+
+
+} // end namespace neuro_collection
+} // end namespace ug
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__LUMPED_MITOCHONDRIA_FV1_H
+#define UG__PLUGINS__NEURO_COLLECTION__LUMPED_MITOCHONDRIA_FV1_H
+
+
+#include "common/util/smart_pointer.h"
+#include "lib_disc/spatial_disc/elem_disc/elem_disc_interface.h"
+#include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"  // for InnerBoundaryConstants
+#include "lib_disc/spatial_disc/disc_util/fv1_geom.h"
+#include "membrane_transporters/membrane_transporter_interface.h"
+#include "util/thread_scratch.h"  // for ThreadScratch
+
+#include <string>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/// Finite Volume discretization of mitochondria as a sub-grid compartment of the cytosol
+/**
+ * Instead of resolving mitochondria in the geometry, this discretization assumes
+ * that every control volume of the cytosolic subsets it is defined on contains
+ * a homogeneous population of mitochondria, described by
+ * <ul>
+ * <li> a volume fraction \f$ \phi \f$ (mitochondrial volume per volume of the control
+ *      volume, set_volume_fraction()) and
+ * <li> for each transport mechanism in the mitochondrial membrane (e.g., MCU, MNCX),
+ *      a volume density \f$ \sigma \f$ (number of mechanism units per volume of the
+ *      control volume, add_membrane_transporter()).
+ * </ul>
+ * The mitochondrial concentrations (e.g., matrix calcium) are vertex-wise unknowns
+ * without any spatial coupling; they are given as "mitochondrial functions" to the
+ * constructor and obey the ODE
+ * \f[
+ * 		\phi \, \partial_t c_{mit} = \sum \sigma j,
+ * \f]
+ * where \f$ j \f$ is the flux through a mechanism into the mitochondria (as in
+ * MembraneTransportFV1). The same fluxes are removed from the cytosolic functions,
+ * so that \f$ c_{cyt} + \phi c_{mit} \f$ is conserved.
+ *
+ * The functions of this discretization are the mitochondrial functions followed by
+ * all other functions of the transport mechanisms (in their order of appearance).
+ * Mass terms are only assembled for the mitochondrial functions; the cytosolic
+ * functions need another discretization providing their time derivative (diffusion).
+ *
+ * \note	The transport mechanisms are evaluated with the volume element as grid object.
+ * 			Mechanisms that keep states on membrane sides (e.g., VDCC_BG, RyRinstat)
+ * 			can therefore not be used here.
+ */
+template<typename TDomain>
+class LumpedMitochondriaFV1
+: public IElemDisc<TDomain>
+{
+	protected:
+		typedef LumpedMitochondriaFV1<TDomain> this_type;
+
+	public:
+	///	world dimension
+		static const int dim = TDomain::dim;
+
+	public:
+	/// constructor with c-strings
+		LumpedMitochondriaFV1(const char* mitFcts, const char* subsets);
+
+	/// constructor with vectors
+		LumpedMitochondriaFV1(const std::vector<std::string>& mitFcts, const std::vector<std::string>& subsets);
+
+	/// destructor
+		virtual ~LumpedMitochondriaFV1();
+
+	public:
+	/// set mitochondrial volume fraction
+		void set_volume_fraction(number phi);
+
+	/// add a transport mechanism in the mitochondrial membrane with its volume density
+		void add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, SmartPtr<CplUserData<number,dim> > densityFct);
+
+	/// add a transport mechanism in the mitochondrial membrane with constant volume density
+		void add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const number dens);
+
+	/// add a transport mechanism in the mitochondrial membrane with its volume density given as Lua function
+		void add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const char* name);
+
+	/// number of transport mechanisms
+		size_t num_membrane_transporters() const {return m_vTransporter.size();}
+
+	public:	// inherited from IElemDisc
+	///	type of trial space for each function used
+		virtual void prepare_setting(const std::vector<LFEID>& vLfeID, bool bNonRegularGrid);
+
+	///	returns if hanging nodes are used
+		virtual bool use_hanging() const;
+
+	/// @copydoc IElemDisc<TDomain>::prep_timestep()
+		void prep_timestep(number future_time, number time, VectorProxyBase* upb);
+
+	///	prepares the loop over all elements
+		template<typename TElem, typename TFVGeom>
+		void prep_elem_loop(const ReferenceObjectID roid, const int si);
+
+	///	prepares the element for assembling
+		template<typename TElem, typename TFVGeom>
+		void prep_elem(const LocalVector& u, GridObject* elem, const ReferenceObjectID roid, const MathVector<dim> vCornerCoords[]);
+
+	///	finishes the loop over all elements
+		template<typename TElem, typename TFVGeom>
+		void fsh_elem_loop();
+
+	///	assembles the local stiffness matrix using a finite volume scheme
+		template<typename TElem, typename TFVGeom>
+		void add_jac_A_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+	///	assembles the local mass matrix using a finite volume scheme
+		template<typename TElem, typename TFVGeom>
+		void add_jac_M_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+	///	assembles the stiffness part of the local defect
+		template<typename TElem, typename TFVGeom>
+		void add_def_A_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+	///	assembles the mass part of the local defect
+		template<typename TElem, typename TFVGeom>
+		void add_def_M_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+	///	assembles the local right hand side
+		template<typename TElem, typename TFVGeom>
+		void add_rhs_elem(LocalVector& rhs, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+	protected:
+		/// transport mechanism with its density and index mappings
+		struct TransporterEntry
+		{
+			SmartPtr<IMembraneTransporter> spMT;
+			SmartPtr<CplUserData<number,dim> > spDensityFct;
+
+			/// index of supplied functions of the mechanism in the functions of this disc
+			std::vector<size_t> vFctMap;
+
+			/// flux directions (in the functions of this disc)
+			std::vector<size_t> vFrom;
+			std::vector<size_t> vTo;
+		};
+
+		/// scratch buffers for batched flux evaluation
+		struct BatchScratch
+		{
+			std::vector<number> vU;
+			std::vector<GridObject*> vElem;
+			std::vector<number> vFlux;
+			std::vector<size_t> vDerivFct;
+			std::vector<number> vDeriv;
+			std::vector<number> vScale;
+		};
+
+		/// gather solution at all SCV corners for one mechanism (structure-of-arrays layout)
+		template <typename TFVGeom>
+		void gather_batch_input
+		(
+			const TFVGeom& fvgeom,
+			const LocalVector& u,
+			GridObject* elem,
+			const TransporterEntry& te,
+			BatchScratch& bs
+		) const;
+
+		/// density times SCV volume for all SCVs of an element
+		template <typename TFVGeom>
+		void scv_scales(const TFVGeom& fvgeom, const TransporterEntry& te, BatchScratch& bs) const;
+
+	private:
+		template <typename List>
+		struct Register
+		{
+			Register(this_type* p)
+			{
+				static const bool isEmpty = boost::mpl::empty<List>::value;
+				(typename boost::mpl::if_c<isEmpty, RegEnd, RegNext>::type (p));
+			}
+
+			struct RegEnd
+			{
+				RegEnd(this_type*) {}
+			};
+
+			struct RegNext
+			{
+				RegNext(this_type* p)
+				{
+					typedef typename boost::mpl::front<List>::type AlgebraType;
+					typedef typename boost::mpl::pop_front<List>::type NextList;
+
+					size_t aid = bridge::AlgebraTypeIDProvider::instance().id<AlgebraType>();
+					p->set_prep_timestep_fct(aid, &this_type::prep_timestep);
+
+					(Register<NextList> (p));
+				}
+			};
+		};
+
+		void register_all_fv1_funcs();
+		template <typename TElem, typename TFVGeom> void register_fv1_func();
+
+	private:
+		std::vector<TransporterEntry> m_vTransporter;
+
+		/// functions of this disc (mitochondrial functions first)
+		std::vector<std::string> m_vFct;
+		size_t m_nMitFct;
+
+		number m_volFrac;
+		int m_currSI;
+
+		/// scratch buffers for batched flux evaluation (one set per thread)
+		ThreadScratch<BatchScratch> m_batchScratch;
+};
+
+///@}
+
+} // end namespace neuro_collection
+} // end namespace ug
+
+
+#endif  // UG__PLUGINS__NEURO_COLLECTION__LUMPED_MITOCHONDRIA_FV1_H
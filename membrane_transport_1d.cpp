@@ -41,6 +41,7 @@
 #include "bindings/lua/lua_user_data.h"
 #include "lib_disc/spatial_disc/disc_util/geom_provider.h"
 #include "lib_grid/global_attachments.h"  // for GlobalAttachments
+#include "util/expression_user_data.h"  // for ExpressionUserData
 
 
 namespace ug {
@@ -52,7 +53,8 @@ template<typename TDomain>
 MembraneTransport1d<TDomain>::MembraneTransport1d(const char* subsets, SmartPtr<IMembraneTransporter> mt)
 : IElemDisc<TDomain>("", ""), m_radiusFactor(1.0), m_constRadius(1e-6), m_bConstRadiusSet(false),
   m_aDiameter(GlobalAttachments::attachment<ANumber>("diameter")),
-  m_spDensityFct(SPNULL), m_spMembraneTransporter(mt), m_currSI(-1)
+  m_spDensityFct(SPNULL), m_spMembraneTransporter(mt), m_currSI(-1),
+  m_bConstDensity(false), m_constDensity(0.0)
 {
 	// check validity of transporter setup and then lock
 	mt->check_and_lock();
@@ -66,7 +68,8 @@ template<typename TDomain>
 MembraneTransport1d<TDomain>::MembraneTransport1d(const std::vector<std::string>& subsets, SmartPtr<IMembraneTransporter> mt)
 : IElemDisc<TDomain>("", ""), m_radiusFactor(1.0), m_constRadius(1e-6), m_bConstRadiusSet(false),
   m_aDiameter(GlobalAttachments::attachment<ANumber>("diameter")),
-  m_spDensityFct(SPNULL), m_spMembraneTransporter(mt), m_currSI(-1)
+  m_spDensityFct(SPNULL), m_spMembraneTransporter(mt), m_currSI(-1),
+  m_bConstDensity(false), m_constDensity(0.0)
 {
 	// check validity of transporter setup and then lock
 	mt->check_and_lock();
@@ -103,6 +106,13 @@ void MembraneTransport1d<TDomain>::set_density_function(const char* name)
 		return;
 	}
 
+	// closed-form expression in x, y, z and t (evaluated natively)
+	if (ExpressionUserData<dim>::is_valid(name))
+	{
+		set_density_function(make_sp(new ExpressionUserData<dim>(name)));
+		return;
+	}
+
 	// no match found
 	if (!CheckLuaCallbackName(name))
 		UG_THROW("Lua-Callback with name '" << name << "' does not exist.");
@@ -123,6 +133,13 @@ template<typename TDomain>
 void MembraneTransport1d<TDomain>::set_radius_factor(number r)
 {
 	m_radiusFactor = r;
+	update_geometry_factors();
+}
+
+template<typename TDomain>
+void MembraneTransport1d<TDomain>::update_geometry_factors()
+{
+	m_vAreaFactorsValid.clear();
 }
 
 
@@ -243,6 +260,63 @@ void MembraneTransport1d<TDomain>::approximation_space_changed()
 	m_dah.set_grid(grid);
 
     m_aaDiameter = Grid::VertexAttachmentAccessor<ANumber>(*grid, m_aDiameter);
+
+	// membrane area factors (computed per subset on first use)
+	if (!grid->has_attachment<Edge>(m_aAreaFactors))
+		grid->attach_to_edges(m_aAreaFactors);
+	m_aaAreaFactors = Grid::EdgeAttachmentAccessor<AAreaFactors>(*grid, m_aAreaFactors);
+	m_vAreaFactorsValid.clear();
+
+	m_spGridAdaptionCallbackID = grid->message_hub()->register_class_callback(this,
+		&MembraneTransport1d<TDomain>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid->message_hub()->register_class_callback(this,
+		&MembraneTransport1d<TDomain>::grid_distribution_callback);
+}
+
+
+template<typename TDomain>
+void MembraneTransport1d<TDomain>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		m_vAreaFactorsValid.clear();
+}
+
+
+template<typename TDomain>
+void MembraneTransport1d<TDomain>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		m_vAreaFactorsValid.clear();
+}
+
+
+template<typename TDomain>
+void MembraneTransport1d<TDomain>::compute_area_factors(int si)
+{
+	SmartPtr<TDomain> dom = this->approx_space()->domain();
+	const typename TDomain::position_accessor_type& aaPos = dom->position_accessor();
+	ConstSmartPtr<MGSubsetHandler> sh = dom->subset_handler();
+
+	// the SCVs of an edge are its halves
+	typedef geometry_traits<Edge>::const_iterator EdgeIter;
+	const size_t nLvl = sh->num_levels();
+	for (size_t lvl = 0; lvl < nLvl; ++lvl)
+	{
+		EdgeIter it = sh->begin<Edge>(si, lvl);
+		EdgeIter itEnd = sh->end<Edge>(si, lvl);
+		for (; it != itEnd; ++it)
+		{
+			Edge* e = *it;
+			const number halfLength = 0.5 * VecDistance(aaPos[e->vertex(0)], aaPos[e->vertex(1)]);
+			MathVector<2>& factors = m_aaAreaFactors[e];
+			for (size_t co = 0; co < 2; ++co)
+				factors[co] = halfLength * PI * m_aaDiameter[e->vertex(co)] * m_radiusFactor;
+		}
+	}
+
+	if (m_vAreaFactorsValid.size() <= (size_t) si)
+		m_vAreaFactorsValid.resize(si + 1, false);
+	m_vAreaFactorsValid[si] = true;
 }
 
 
@@ -255,6 +329,10 @@ prepare_setting(const std::vector<LFEID>& vLfeID, bool bNonRegularGrid)
 		if (vLfeID[i].type() != LFEID::LAGRANGE || vLfeID[i].order() != 1)
 			UG_THROW("MembraneTransport1d: 1st order Lagrange expected.");
 
+	// provide scratch buffers for all threads
+	m_batchScratch.ensure_capacity();
+	m_spMembraneTransporter->prepare_threads();
+
 	// update assemble functions
 	register_assembling_funcs();
 }
@@ -295,6 +373,26 @@ void MembraneTransport1d<TDomain>::
 prep_elem_loop(const ReferenceObjectID roid, const int si)
 {
 	m_currSI = si;
+
+	if (!this->m_spDensityFct.valid())
+	{
+		UG_THROW("No density information available for " << m_spMembraneTransporter->name()
+				 << " membrane transport mechanism. Please set using set_density_function().");
+	}
+
+	// constant densities only need to be evaluated once
+	m_bConstDensity = this->m_spDensityFct->constant();
+	if (m_bConstDensity)
+		(*this->m_spDensityFct)(m_constDensity, MathVector<dim>(0.0), this->time(), si);
+
+	// the area factors are shared by all threads
+#ifdef _OPENMP
+	#pragma omp critical (nc_mt1d_area_factors)
+#endif
+	{
+		if (m_vAreaFactorsValid.size() <= (size_t) si || !m_vAreaFactorsValid[si])
+			compute_area_factors(si);
+	}
 }
 
 
@@ -317,6 +415,44 @@ prep_elem(const LocalVector& u, GridObject* elem, const ReferenceObjectID roid,
 						"Cannot update Finite Volume Geometry.");
 }
 
+template<typename TDomain>
+template<typename TFVGeom>
+void MembraneTransport1d<TDomain>::
+gather_batch_input(const TFVGeom& fvgeom, const LocalVector& u, GridObject* elem, BatchScratch& bs)
+{
+	// solution at SCV corners in structure-of-arrays layout
+	const size_t nFct = u.num_fct();
+	const size_t nScv = fvgeom.num_scv();
+	bs.vU.resize(nFct * nScv);
+	bs.vElem.assign(nScv, elem);
+	for (size_t i = 0; i < nScv; ++i)
+	{
+		const int co = fvgeom.scv(i).node_id();
+		for (size_t fct = 0; fct < nFct; ++fct)
+			bs.vU[fct*nScv + i] = u(fct, co);
+	}
+}
+
+template<typename TDomain>
+template<typename TFVGeom>
+void MembraneTransport1d<TDomain>::
+corner_densities(const TFVGeom& fvgeom, number* vDensity)
+{
+	const size_t nScv = fvgeom.num_scv();
+	if (m_bConstDensity)
+	{
+		for (size_t i = 0; i < nScv; ++i)
+			vDensity[i] = m_constDensity;
+		return;
+	}
+
+	// evaluate at all SCV corners in one call
+	MathVector<dim> vCoords[2];
+	for (size_t i = 0; i < nScv; ++i)
+		vCoords[i] = fvgeom.scv(i).global_corner(0);
+	(*this->m_spDensityFct)(vDensity, vCoords, this->time(), m_currSI, nScv);
+}
+
 // assemble stiffness part of Jacobian
 template<typename TDomain>
 template<typename TElem, typename TFVGeom>
@@ -326,14 +462,21 @@ add_jac_A_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const Mat
 	// get finite volume geometry
 	const static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
 
-	// cast elem to appropriate type (in order to allow access to attachments)
-	TElem* pElem = dynamic_cast<TElem*>(elem);
-	if (!pElem) {UG_THROW("Wrong element type.");}
+	// membrane area factors of this edge (only edges are registered)
+	const MathVector<2>& areaFactors = m_aaAreaFactors[static_cast<TElem*>(elem)];
 
-	FluxDerivCond fdc;
-	const size_t nFct = u.num_fct();
-	std::vector<LocalVector::value_type> uAtCorner(nFct);
-	for (size_t i = 0; i < fvgeom.num_scv(); ++i)
+	// evaluate flux derivatives for all SCVs in one batch
+	const size_t nScv = fvgeom.num_scv();
+	BatchScratch& bs = m_batchScratch.local();
+	gather_batch_input(fvgeom, u, elem, bs);
+	m_spMembraneTransporter->flux_deriv_batch(bs.vU, bs.vElem, bs.vDerivFct, bs.vDeriv);
+
+	number vDensity[2];
+	corner_densities(fvgeom, vDensity);
+
+	const size_t nFlux = m_spMembraneTransporter->n_fluxes();
+	const size_t nDep = m_spMembraneTransporter->n_dependencies();
+	for (size_t i = 0; i < nScv; ++i)
 	{
 		// get current SCV
 		const typename TFVGeom::SCV& scv = fvgeom.scv(i);
@@ -341,29 +484,21 @@ add_jac_A_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const Mat
 		// get associated node
 		const int co = scv.node_id();
 
-		// get solution at the corner of the scv
-		for (size_t fct = 0; fct < nFct; ++fct)
-			uAtCorner[fct] = u(fct, co);
-
-		// get corner coordinates
-		const MathVector<dim>& cc = scv.global_corner(0);
-
-		if (!fluxDensityDerivFct(uAtCorner, elem, cc, m_currSI, fdc))
-			UG_THROW("MembraneTransport1d::add_jac_A_elem:"
-				" Call to fluxDensityDerivFct resulted did not succeed.");
-
-		// scale with volume of SCV
-		const number scale = scv.volume() * PI * m_aaDiameter[pElem->vertex(co)] * m_radiusFactor;
+		// scale with density and membrane area of SCV
+		const number scale = vDensity[i] * areaFactors[co];
 
 		// add to Jacobian
-		for (size_t j = 0; j < fdc.fluxDeriv.size(); ++j)
+		for (size_t j = 0; j < nFlux; ++j)
 		{
-			for (size_t k = 0; k < fdc.fluxDeriv[j].size(); ++k)
+			const std::pair<size_t, size_t> fromTo = m_spMembraneTransporter->flux_from_to(j);
+			for (size_t k = 0; k < nDep; ++k)
 			{
-				if (fdc.from[j] != InnerBoundaryConstants::_IGNORE_)
-					J(fdc.from[j], co, fdc.fluxDeriv[j][k].first, co) += fdc.fluxDeriv[j][k].second * scale;
-				if (fdc.to[j] != InnerBoundaryConstants::_IGNORE_)
-					J(fdc.to[j], co, fdc.fluxDeriv[j][k].first, co)	-= fdc.fluxDeriv[j][k].second * scale;
+				const size_t fct = bs.vDerivFct[j*nDep + k];
+				const number val = bs.vDeriv[(j*nDep + k)*nScv + i] * scale;
+				if (fromTo.first != InnerBoundaryConstants::_IGNORE_)
+					J(fromTo.first, co, fct, co) += val;
+				if (fromTo.second != InnerBoundaryConstants::_IGNORE_)
+					J(fromTo.second, co, fct, co) -= val;
 			}
 		}
 	}
@@ -384,16 +519,20 @@ add_def_A_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const Mat
 	// get finite volume geometry
 	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
 
-	// cast elem to appropriate type (in order to allow access to attachments)
-	TElem* pElem = dynamic_cast<TElem*>(elem);
-	if (!pElem) {UG_THROW("Wrong element type.");}
+	// membrane area factors of this edge (only edges are registered)
+	const MathVector<2>& areaFactors = m_aaAreaFactors[static_cast<TElem*>(elem)];
 
-	FluxCond fc;
-	const size_t nFct = u.num_fct();
-	std::vector<LocalVector::value_type> uAtCorner(nFct);
+	// evaluate fluxes for all SCVs in one batch
+	const size_t nScv = fvgeom.num_scv();
+	BatchScratch& bs = m_batchScratch.local();
+	gather_batch_input(fvgeom, u, elem, bs);
+	m_spMembraneTransporter->flux_batch(bs.vU, bs.vElem, bs.vFlux);
+
+	number vDensity[2];
+	corner_densities(fvgeom, vDensity);
 
-	// loop boundary Faces
-	for (size_t i = 0; i < fvgeom.num_scv(); ++i)
+	const size_t nFlux = m_spMembraneTransporter->n_fluxes();
+	for (size_t i = 0; i < nScv; ++i)
 	{
 		// get current SCV
 		const typename TFVGeom::SCV& scv = fvgeom.scv(i);
@@ -401,30 +540,18 @@ add_def_A_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const Mat
 		// get associated node
 		const int co = scv.node_id();
 
-		// get solution at the corner of the scv
-		for (size_t fct = 0; fct < nFct; ++fct)
-			uAtCorner[fct] = u(fct, co);
-
-		// get corner coordinates
-		const MathVector<dim>& cc = scv.global_corner(0);
-
-		// get flux densities in that node
-		if (!fluxDensityFct(uAtCorner, elem, cc, m_currSI, fc))
-		{
-			UG_THROW("MembraneTransport1d::add_def_A_elem:"
-				" Call to fluxDensityFct did not succeed.");
-		}
-
-		// scale with volume of SCV
-		const number scale = scv.volume() * PI * m_aaDiameter[pElem->vertex(co)] * m_radiusFactor;
+		// scale with density and membrane area of SCV
+		const number scale = vDensity[i] * areaFactors[co];
 
 		// add to defect
-		for (size_t j = 0; j < fc.flux.size(); ++j)
+		for (size_t j = 0; j < nFlux; ++j)
 		{
-			if (fc.from[j] != InnerBoundaryConstants::_IGNORE_)
-				d(fc.from[j], co) += fc.flux[j] * scale;
-			if (fc.to[j] != InnerBoundaryConstants::_IGNORE_)
-				d(fc.to[j], co) -= fc.flux[j] * scale;
+			const std::pair<size_t, size_t> fromTo = m_spMembraneTransporter->flux_from_to(j);
+			const number flux = bs.vFlux[j*nScv + i] * scale;
+			if (fromTo.first != InnerBoundaryConstants::_IGNORE_)
+				d(fromTo.first, co) += flux;
+			if (fromTo.second != InnerBoundaryConstants::_IGNORE_)
+				d(fromTo.second, co) -= flux;
 		}
 	}
 }
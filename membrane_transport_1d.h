@@ -44,7 +44,9 @@
 //#include "bindings/lua/lua_user_data.h"
 #include "common/util/smart_pointer.h"
 #include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
 #include "membrane_transporters/membrane_transporter_interface.h"
+#include "util/thread_scratch.h"	// for ThreadScratch
 #include "../cable_neuron/util/diam_attachment_handler.h"	// attachment handling for diameter attachment
 
 
@@ -64,6 +66,13 @@ namespace neuro_collection {
  * rotationally symmetric membrane.
  * The radius at which the membrane is located must be provided, either as an explicit
  * constant or as a diameter attachment in the grid as in cable_neuron applications.
+ *
+ * The membrane area associated with each edge corner (depending on the diameter,
+ * the radius factor and the edge length) is computed once per subset and stored
+ * in an edge attachment. It is recomputed after grid adaption or redistribution
+ * and after a change of the radius factor; if diameters are changed otherwise,
+ * update_geometry_factors() has to be called.
+ * Constant densities are evaluated once per element loop.
  */
 template<typename TDomain>
 class MembraneTransport1d
@@ -101,6 +110,9 @@ class MembraneTransport1d
 		/// set plasma membrane radius fraction at which membrane (ERM or PM) is located
 		void set_radius_factor(number r);
 
+		/// recompute the membrane area factors (e.g., after the diameters have been changed)
+		void update_geometry_factors();
+
 		/// the flux function
 		/**	This is the actual flux function defining the flux density over the boundary
 		 *	depending on the unknowns on the boundary;
@@ -210,6 +222,31 @@ class MembraneTransport1d
 
 		void register_assembling_funcs();
 
+		/// scratch buffers for batched flux evaluation
+		struct BatchScratch
+		{
+			std::vector<number> vU;
+			std::vector<GridObject*> vElem;
+			std::vector<number> vFlux;
+			std::vector<size_t> vDerivFct;
+			std::vector<number> vDeriv;
+		};
+
+		/// gather solution at all SCV corners for batched flux evaluation
+		template <typename TFVGeom>
+		void gather_batch_input(const TFVGeom& fvgeom, const LocalVector& u, GridObject* elem, BatchScratch& bs);
+
+		/// densities at the SCV corners of the current element
+		template <typename TFVGeom>
+		void corner_densities(const TFVGeom& fvgeom, number* vDensity);
+
+		/// compute the membrane area factors for all edges of a subset
+		void compute_area_factors(int si);
+
+		/// grid change callbacks (invalidating the area factors)
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
 	protected:
 		number m_radiusFactor;
 		number m_constRadius;
@@ -223,6 +260,22 @@ class MembraneTransport1d
 
 	private:
 		int m_currSI;
+
+		/// membrane area (pi * diameter * radius factor * SCV length) for both edge corners
+		typedef Attachment<MathVector<2> > AAreaFactors;
+		AAreaFactors m_aAreaFactors;
+		Grid::EdgeAttachmentAccessor<AAreaFactors> m_aaAreaFactors;
+		std::vector<bool> m_vAreaFactorsValid;  ///< per subset
+
+		/// density value if the density function is constant
+		bool m_bConstDensity;
+		number m_constDensity;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+
+		/// scratch buffers for batched flux evaluation (one set per thread)
+		ThreadScratch<BatchScratch> m_batchScratch;
 };
 
 ///@}
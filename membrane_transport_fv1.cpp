@@ -39,6 +39,11 @@
 
 #include "membrane_transport_fv1.h"
 #include "bindings/lua/lua_user_data.h"
+#include "common/stopwatch.h"  // for Stopwatch
+#include "util/expression_user_data.h"  // for ExpressionUserData
+
+#include <algorithm>  // for std::max
+#include <cmath>  // for fabs
 
 
 namespace ug {
@@ -48,7 +53,8 @@ namespace neuro_collection {
 template<typename TDomain>
 MembraneTransportFV1<TDomain>::MembraneTransportFV1(const char* subsets, SmartPtr<IMembraneTransporter> mt)
 : FV1InnerBoundaryElemDisc<TDomain>(),
-  R(8.314), T(310.0), F(96485.0), m_spMembraneTransporter(mt), m_bNonRegularGrid(false)
+  R(8.314), T(310.0), F(96485.0), m_spMembraneTransporter(mt), m_nDep(0), m_bNonRegularGrid(false),
+  m_bDensityCaching(false), m_bCombinedFluxEval(false), m_frozenJacTol(0.0), m_paramRevision(0), m_bActivityMasking(false), m_costWindow(0)
 {
 	// check validity of transporter setup and then lock
 	mt->check_and_lock();
@@ -56,12 +62,16 @@ MembraneTransportFV1<TDomain>::MembraneTransportFV1(const char* subsets, SmartPt
 	// elem discs (subsets and) functions need only be set after the previous check
 	this->IElemDisc<TDomain>::set_subsets(subsets);
 	this->IElemDisc<TDomain>::set_functions(mt->symb_fcts());
+
+	update_flux_from_to();
+	label_hot_paths();
 }
 
 template<typename TDomain>
 MembraneTransportFV1<TDomain>::MembraneTransportFV1(const std::vector<std::string>& subsets, SmartPtr<IMembraneTransporter> mt)
 : FV1InnerBoundaryElemDisc<TDomain>(),
-  R(8.314), T(310.0), F(96485.0), m_spMembraneTransporter(mt), m_bNonRegularGrid(false)
+  R(8.314), T(310.0), F(96485.0), m_spMembraneTransporter(mt), m_nDep(0), m_bNonRegularGrid(false),
+  m_bDensityCaching(false), m_bCombinedFluxEval(false), m_frozenJacTol(0.0), m_paramRevision(0), m_bActivityMasking(false), m_costWindow(0)
 {
 	// check validity of transporter setup and then lock
 	mt->check_and_lock();
@@ -69,6 +79,9 @@ MembraneTransportFV1<TDomain>::MembraneTransportFV1(const std::vector<std::strin
 	// elem discs (subsets and) functions need only be set after the previous check
 	this->IElemDisc<TDomain>::set_subsets(subsets);
 	this->IElemDisc<TDomain>::set_functions(mt->symb_fcts());
+
+	update_flux_from_to();
+	label_hot_paths();
 }
 
 template<typename TDomain>
@@ -82,6 +95,8 @@ template<typename TDomain>
 void MembraneTransportFV1<TDomain>::set_density_function(SmartPtr<CplUserData<number,dim> > densityFct)
 {
 	this->m_spDensityFct = densityFct;
+	m_mDensityCache.clear();
+	m_activityMask.clear();
 }
 
 template<typename TDomain>
@@ -100,6 +115,13 @@ void MembraneTransportFV1<TDomain>::set_density_function(const char* name)
 		return;
 	}
 
+	// closed-form expression in x, y, z and t (evaluated natively)
+	if (ExpressionUserData<dim>::is_valid(name))
+	{
+		set_density_function(make_sp(new ExpressionUserData<dim>(name)));
+		return;
+	}
+
 	// no match found
 	if (!CheckLuaCallbackName(name))
 		UG_THROW("Lua-Callback with name '" << name << "' does not exist.");
@@ -113,6 +135,278 @@ template<typename TDomain>
 void MembraneTransportFV1<TDomain>::set_membrane_transporter(SmartPtr<IMembraneTransporter> mt)
 {
 	m_spMembraneTransporter = mt;
+	update_flux_from_to();
+	m_activityMask.clear();
+	m_mFluxDerivCache.clear();
+	label_hot_paths();
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::label_hot_paths()
+{
+#ifdef NC_WITH_INSTRUMENTATION
+	const std::string subsets = hot_path_subset_label(this->symb_subsets());
+	const std::string name = m_spMembraneTransporter->name();
+	NC_HOT_PATH_LABEL(m_hpFluxDensity, "MembraneTransportFV1::fluxDensityFct", name, subsets);
+	NC_HOT_PATH_LABEL(m_hpFluxDensityDeriv, "MembraneTransportFV1::fluxDensityDerivFct", name, subsets);
+#endif
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::set_density_caching(bool b)
+{
+	m_bDensityCaching = b;
+	m_mDensityCache.clear();
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::set_combined_flux_evaluation(bool b)
+{
+	m_bCombinedFluxEval = b;
+	m_mFluxDerivCache.clear();
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::set_frozen_jacobian(number relTol)
+{
+	m_frozenJacTol = relTol;
+	m_mFluxDerivCache.clear();
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::set_activity_masking(number fluxThresh, number wakeTol)
+{
+	m_bActivityMasking = true;
+	m_activityMask.set_flux_threshold(fluxThresh);
+	m_activityMask.set_wake_tolerance(wakeTol);
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::disable_activity_masking()
+{
+	m_bActivityMasking = false;
+	m_activityMask.clear();
+}
+
+
+template<typename TDomain>
+size_t MembraneTransportFV1<TDomain>::num_inactive_points() const
+{
+	return m_activityMask.num_inactive();
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::set_cost_measurement(size_t numSteps)
+{
+	m_costWindow = numSteps;
+	m_dCostHistory.clear();
+	for (size_t t = 0; t < m_costTally.size(); ++t)
+		m_costTally[t] = CostTally();
+}
+
+
+template<typename TDomain>
+number MembraneTransportFV1<TDomain>::measured_time_per_evaluation() const
+{
+	number seconds = 0.0;
+	size_t count = 0;
+	for (size_t i = 0; i < m_dCostHistory.size(); ++i)
+	{
+		seconds += m_dCostHistory[i].seconds;
+		count += m_dCostHistory[i].count;
+	}
+
+	if (!count)
+		return -1.0;
+	return seconds / count;
+}
+
+
+template<typename TDomain>
+number MembraneTransportFV1<TDomain>::element_cost() const
+{
+	return m_spMembraneTransporter->element_cost();
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::approximation_space_changed()
+{
+	m_mDensityCache.clear();
+	m_mFluxDerivCache.clear();
+	m_activityMask.clear();
+
+	SmartPtr<MultiGrid> grid = this->approx_space()->domain()->grid();
+	m_spGridAdaptionCallbackID = grid->message_hub()->register_class_callback(this,
+		&this_type::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid->message_hub()->register_class_callback(this,
+		&this_type::grid_distribution_callback);
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+	{
+		m_mDensityCache.clear();
+		m_mFluxDerivCache.clear();
+		m_activityMask.clear();
+	}
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+	{
+		m_mDensityCache.clear();
+		m_mFluxDerivCache.clear();
+		m_activityMask.clear();
+	}
+}
+
+
+template<typename TDomain>
+number MembraneTransportFV1<TDomain>::density(GridObject* e, const MathVector<dim>& coords, int si)
+{
+	if (!this->m_spDensityFct.valid())
+	{
+		UG_THROW("No density information available for " << m_spMembraneTransporter->name()
+				 << " membrane transport mechanism. Please set using set_density_function().");
+	}
+
+	number dens;
+	if (!m_bDensityCaching)
+	{
+		(*this->m_spDensityFct)(dens, coords, this->time(), si);
+		return dens;
+	}
+
+	// look up integration point in cached values for this element
+	// (the cache is shared by all threads)
+#ifdef _OPENMP
+	#pragma omp critical (nc_mt_density_cache)
+#endif
+	{
+		DensityCacheEntry& entry = m_mDensityCache[e];
+		const size_t nIP = entry.vCoords.size();
+		size_t k = 0;
+		for (; k < nIP; ++k)
+			if (VecDistanceSq(entry.vCoords[k], coords) == 0.0)
+				break;
+
+		if (k < nIP)
+			dens = entry.vDensity[k];
+		else
+		{
+			// not yet cached
+			(*this->m_spDensityFct)(dens, coords, this->time(), si);
+			entry.vCoords.push_back(coords);
+			entry.vDensity.push_back(dens);
+		}
+	}
+
+	return dens;
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::store_flux_derivs
+(
+	GridObject* e,
+	const MathVector<dim>& coords,
+	const std::vector<number>& u,
+	const std::vector<std::vector<std::pair<size_t, number> > >& vFluxDeriv
+)
+{
+	// (the cache is shared by all threads)
+#ifdef _OPENMP
+	#pragma omp critical (nc_mt_flux_deriv_cache)
+#endif
+	{
+		std::vector<FluxDerivCacheEntry>& vEntry = m_mFluxDerivCache[e];
+		const size_t nIP = vEntry.size();
+		size_t k = 0;
+		for (; k < nIP; ++k)
+			if (VecDistanceSq(vEntry[k].coords, coords) == 0.0)
+				break;
+		if (k == nIP)
+		{
+			vEntry.resize(nIP + 1);
+			vEntry[k].coords = coords;
+		}
+		vEntry[k].vU = u;
+		vEntry[k].vFluxDeriv = vFluxDeriv;
+	}
+}
+
+
+template<typename TDomain>
+bool MembraneTransportFV1<TDomain>::stored_flux_derivs
+(
+	GridObject* e,
+	const MathVector<dim>& coords,
+	const std::vector<number>& u,
+	number relTol,
+	std::vector<std::vector<std::pair<size_t, number> > >& vFluxDeriv
+)
+{
+	bool found = false;
+#ifdef _OPENMP
+	#pragma omp critical (nc_mt_flux_deriv_cache)
+#endif
+	{
+		typename std::map<GridObject*, std::vector<FluxDerivCacheEntry> >::const_iterator it
+			= m_mFluxDerivCache.find(e);
+		if (it != m_mFluxDerivCache.end())
+		{
+			const std::vector<FluxDerivCacheEntry>& vEntry = it->second;
+			const size_t nIP = vEntry.size();
+			for (size_t k = 0; k < nIP; ++k)
+			{
+				if (VecDistanceSq(vEntry[k].coords, coords) == 0.0)
+				{
+					// only valid for (nearly) the same unknowns
+					if (FrozenJacobianStore::inputs_within_tolerance(u, vEntry[k].vU, relTol))
+					{
+						const size_t nFlux = vEntry[k].vFluxDeriv.size();
+						for (size_t i = 0; i < nFlux; ++i)
+							std::copy(vEntry[k].vFluxDeriv[i].begin(), vEntry[k].vFluxDeriv[i].end(),
+								vFluxDeriv[i].begin());
+						found = true;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+
+template<typename TDomain>
+void MembraneTransportFV1<TDomain>::update_flux_from_to()
+{
+	const size_t n_flux = m_spMembraneTransporter->n_fluxes();
+	m_nDep = m_spMembraneTransporter->n_dependencies();
+	m_vFluxFrom.resize(n_flux);
+	m_vFluxTo.resize(n_flux);
+	for (size_t i = 0; i < n_flux; i++)
+	{
+		const std::pair<size_t, size_t> fromTo = m_spMembraneTransporter->flux_from_to(i);
+		m_vFluxFrom[i] = fromTo.first;
+		m_vFluxTo[i] = fromTo.second;
+	}
 }
 
 
@@ -126,29 +420,82 @@ bool MembraneTransportFV1<TDomain>::fluxDensityFct
 	FluxCond& fc
 )
 {
-	size_t n_flux = m_spMembraneTransporter->n_fluxes();
+	NC_HOT_PATH_SCOPE(m_hpFluxDensity);
+
+	// skip quiescent points
+	std::vector<number>& vActInd = m_vActivityInd.local();
+	if (m_bActivityMasking)
+	{
+		m_spMembraneTransporter->activity_indicators(u, e, vActInd);
+		bool inactive;
+#ifdef _OPENMP
+		#pragma omp critical (nc_mt_activity_mask)
+#endif
+		inactive = m_activityMask.is_inactive(e, coords, vActInd);
+		if (inactive)
+		{
+			fc.flux.clear();
+			fc.from.clear();
+			fc.to.clear();
+			return true;
+		}
+	}
+
+	const size_t n_flux = m_vFluxFrom.size();
 
 	// calculate single-channel flux
+	// (resizing does not allocate if fc is reused)
 	fc.flux.resize(n_flux);
 	fc.from.resize(n_flux);
 	fc.to.resize(n_flux);
 
-	m_spMembraneTransporter->flux(u, e, fc.flux);
+	// with combined evaluation, also compute (and keep) the derivatives
+	std::vector<std::vector<std::pair<size_t, number> > >* pFluxDeriv = NULL;
+	if (m_bCombinedFluxEval)
+	{
+		pFluxDeriv = &m_vFluxDerivScratch.local();
+		pFluxDeriv->resize(n_flux);
+		for (size_t i = 0; i < n_flux; i++)
+			(*pFluxDeriv)[i].resize(m_nDep);
+	}
 
-	// get density in membrane
-	if (!this->m_spDensityFct.valid())
+	Stopwatch sw;
+	if (m_costWindow)
+		sw.start();
+
+	if (pFluxDeriv)
+		m_spMembraneTransporter->flux_and_deriv(u, e, fc.flux, *pFluxDeriv);
+	else
+		m_spMembraneTransporter->flux(u, e, fc.flux);
+
+	if (m_costWindow)
 	{
-		UG_THROW("No density information available for " << m_spMembraneTransporter->name()
-				 << " membrane transport mechanism. Please set using set_density_function().");
+		CostTally& tally = m_costTally.local();
+		tally.seconds += sw.ms() / 1000.0;
+		++tally.count;
 	}
-	number density;
-	(*this->m_spDensityFct)(density, coords, this->time(), si);
 
+	if (pFluxDeriv)
+		store_flux_derivs(e, coords, u, *pFluxDeriv);
+
+	// get density in membrane
+	const number dens = density(e, coords, si);
+
+	number maxFlux = 0.0;
 	for (size_t i = 0; i < n_flux; i++)
 	{
-		fc.flux[i] *= density;
-		fc.from[i] = m_spMembraneTransporter->flux_from_to(i).first;
-		fc.to[i] = m_spMembraneTransporter->flux_from_to(i).second;
+		fc.flux[i] *= dens;
+		fc.from[i] = m_vFluxFrom[i];
+		fc.to[i] = m_vFluxTo[i];
+		maxFlux = std::max(maxFlux, fabs(fc.flux[i]));
+	}
+
+	if (m_bActivityMasking)
+	{
+#ifdef _OPENMP
+		#pragma omp critical (nc_mt_activity_mask)
+#endif
+		m_activityMask.record_flux(e, coords, vActInd, maxFlux);
 	}
 
 	return true;
@@ -165,33 +512,85 @@ bool MembraneTransportFV1<TDomain>::fluxDensityDerivFct
 	FluxDerivCond& fdc
 )
 {
-	size_t n_dep = m_spMembraneTransporter->n_dependencies();
-	size_t n_flux = m_spMembraneTransporter->n_fluxes();
+	NC_HOT_PATH_SCOPE(m_hpFluxDensityDeriv);
+
+	// skip quiescent points
+	std::vector<number>& vActInd = m_vActivityInd.local();
+	if (m_bActivityMasking)
+	{
+		m_spMembraneTransporter->activity_indicators(u, e, vActInd);
+		bool inactive;
+#ifdef _OPENMP
+		#pragma omp critical (nc_mt_activity_mask)
+#endif
+		inactive = m_activityMask.is_inactive(e, coords, vActInd);
+		if (inactive)
+		{
+			fdc.fluxDeriv.clear();
+			fdc.from.clear();
+			fdc.to.clear();
+			return true;
+		}
+	}
+
+	const size_t n_dep = m_nDep;
+	const size_t n_flux = m_vFluxFrom.size();
 
 	// calculate single-channel flux
+	// (resizing does not allocate if fdc is reused)
 	fdc.fluxDeriv.resize(n_flux);
 	fdc.from.resize(n_flux);
 	fdc.to.resize(n_flux);
 	for (size_t i = 0; i < n_flux; i++)
 		fdc.fluxDeriv[i].resize(n_dep);
 
-	m_spMembraneTransporter->flux_deriv(u, e, fdc.fluxDeriv);
-
-	number density;
-	if (this->m_spDensityFct.valid())
-		(*this->m_spDensityFct)(density, coords, this->time(), si);
-	else
+	// derivatives computed along with the defect for the same unknowns
+	// or (frozen Jacobian) in an earlier assembling for similar unknowns
+	const bool bFrozen = m_frozenJacTol > 0.0;
+	if (!(m_bCombinedFluxEval || bFrozen)
+		|| !stored_flux_derivs(e, coords, u, bFrozen ? m_frozenJacTol : 0.0, fdc.fluxDeriv))
 	{
-		UG_THROW("No density information available for " << m_spMembraneTransporter->name()
-				<< " membrane transport mechanism. Please set using set_density_function().");
+		if (m_costWindow)
+		{
+			Stopwatch sw;
+			sw.start();
+			m_spMembraneTransporter->flux_deriv(u, e, fdc.fluxDeriv);
+			CostTally& tally = m_costTally.local();
+			tally.seconds += sw.ms() / 1000.0;
+			++tally.count;
+		}
+		else
+			m_spMembraneTransporter->flux_deriv(u, e, fdc.fluxDeriv);
+
+		if (bFrozen)
+			store_flux_derivs(e, coords, u, fdc.fluxDeriv);
 	}
 
+	// get density in membrane
+	const number dens = density(e, coords, si);
+
+	number maxChange = 0.0;
 	for (size_t i = 0; i < n_flux; i++)
 	{
 		for (size_t j = 0; j < n_dep; j++)
-			fdc.fluxDeriv[i][j].second *= density;
-		fdc.from[i] = m_spMembraneTransporter->flux_from_to(i).first;
-		fdc.to[i] = m_spMembraneTransporter->flux_from_to(i).second;
+		{
+			fdc.fluxDeriv[i][j].second *= dens;
+
+			// flux change induced by a 100% change of the unknown
+			const size_t fct = fdc.fluxDeriv[i][j].first;
+			const number uVal = fct < u.size() ? fabs(u[fct]) : 1.0;
+			maxChange = std::max(maxChange, fabs(fdc.fluxDeriv[i][j].second) * uVal);
+		}
+		fdc.from[i] = m_vFluxFrom[i];
+		fdc.to[i] = m_vFluxTo[i];
+	}
+
+	if (m_bActivityMasking)
+	{
+#ifdef _OPENMP
+		#pragma omp critical (nc_mt_activity_mask)
+#endif
+		m_activityMask.record_deriv(e, coords, vActInd, maxChange);
 	}
 
 	return true;
@@ -206,6 +605,17 @@ void MembraneTransportFV1<TDomain>::prepare_setting(const std::vector<LFEID>& vL
 	// set assembling functions from base class first
 	this->FV1InnerBoundaryElemDisc<TDomain>::prepare_setting(vLfeID, bNonRegularGrid);
 
+	// flux directions do not change during assembling
+	update_flux_from_to();
+
+	// provide scratch buffers for all threads
+	m_vActivityInd.ensure_capacity();
+	m_vFluxDerivScratch.ensure_capacity();
+	m_costTally.ensure_capacity();
+	NC_HOT_PATH_PREPARE_THREADS(m_hpFluxDensity);
+	NC_HOT_PATH_PREPARE_THREADS(m_hpFluxDensityDeriv);
+	m_spMembraneTransporter->prepare_threads();
+
 	// update assemble functions
 	register_all_fv1_funcs();
 }
@@ -219,6 +629,38 @@ void MembraneTransportFV1<TDomain>::prep_timestep
     VectorProxyBase* upb
 )
 {
+	// close the measurement of the previous time step
+	if (m_costWindow)
+	{
+		CostTally step;
+		for (size_t t = 0; t < m_costTally.size(); ++t)
+		{
+			step.seconds += m_costTally[t].seconds;
+			step.count += m_costTally[t].count;
+			m_costTally[t] = CostTally();
+		}
+		if (step.count)
+		{
+			m_dCostHistory.push_back(step);
+			while (m_dCostHistory.size() > m_costWindow)
+				m_dCostHistory.pop_front();
+		}
+	}
+
+	// derivatives kept by the combined flux evaluation are only valid within a time step
+	// (frozen derivatives are kept as long as the unknowns do not change too much)
+	if (m_frozenJacTol <= 0.0)
+		m_mFluxDerivCache.clear();
+
+	// transporter parameters changed since the last time step:
+	// neither derivatives nor quiescence records are valid any more
+	if (m_spMembraneTransporter->parameter_revision() != m_paramRevision)
+	{
+		m_mFluxDerivCache.clear();
+		m_activityMask.clear();
+		m_paramRevision = m_spMembraneTransporter->parameter_revision();
+	}
+
 	m_spMembraneTransporter->prepare_timestep(future_time, time, upb);
 }
 
@@ -43,7 +43,15 @@
 
 #include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
 #include "common/util/smart_pointer.h"
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
 #include "membrane_transporters/membrane_transporter_interface.h"
+#include "util/activity_mask.h"
+#include "util/frozen_jacobian.h"  // for FrozenJacobianStore
+#include "util/thread_scratch.h"  // for ThreadScratch
+#include "util/hot_path_counters.h"  // for NC_HOT_PATH_COUNTER
+
+#include <deque>
+#include <map>
 
 
 namespace ug {
@@ -67,6 +75,21 @@ class IMembraneTransporter;
  * Such an object can be assigned to an object of this class using the method
  * set_membrane_transporter(). The density of the corresponding channels or pumps needs
  * to be set using set_density_function().
+ *
+ * If the density function does not depend on time, its values can be cached using
+ * set_density_caching(). The density is then only evaluated once per integration point
+ * and re-evaluated only after the grid has been adapted or redistributed.
+ *
+ * Integration points where flux and derivatives are negligible can be skipped during
+ * assembling using set_activity_masking(). They are woken up again as soon as the
+ * activity indicators of the transport mechanism (by default the unknowns the flux
+ * depends on) change significantly.
+ *
+ * The element loop of this discretization is that of FV1InnerBoundaryElemDisc, which
+ * requests fluxes one integration point at a time. Therefore, the batched flux
+ * evaluation of IMembraneTransporter (flux_batch(), flux_deriv_batch()) is not used
+ * here; it is only used by the 1d discretizations (MembraneTransport1d,
+ * MultiMembraneTransport1d) and LumpedMitochondriaFV1.
  */
 template<typename TDomain>
 class MembraneTransportFV1
@@ -108,6 +131,81 @@ class MembraneTransportFV1
 	/// set transport mechanism
 		void set_membrane_transporter(SmartPtr<IMembraneTransporter> mt);
 
+	/**
+	 * @brief Cache density values per integration point
+	 * Only use this if the density function is time-independent!
+	 * Cached values are discarded whenever the grid is adapted or redistributed
+	 * and whenever a new density function is set.
+	 * Default is no caching.
+	 */
+		void set_density_caching(bool b);
+
+	/**
+	 * @brief Evaluate flux derivatives together with the fluxes
+	 *
+	 * If switched on, the defect assembling evaluates fluxes and derivatives
+	 * in one call (IMembraneTransporter::flux_and_deriv()) and keeps the derivatives
+	 * per integration point. The following Jacobian assembling at the same solution
+	 * (as in a Newton step) uses them instead of evaluating the transport mechanism
+	 * again; points where the unknowns differ are evaluated as usual.
+	 * The derivatives are kept until the next time step (or grid change), which costs
+	 * memory proportional to the number of membrane integration points.
+	 * Default is off.
+	 */
+		void set_combined_flux_evaluation(bool b);
+
+	/**
+	 * @brief Reuse flux derivatives over Newton iterations and time steps (modified Newton)
+	 *
+	 * If set, the flux derivatives computed at an integration point are kept
+	 * together with the unknowns they were computed from and reused in later
+	 * Jacobian assemblings as long as none of these unknowns has changed by
+	 * more than the given relative tolerance. Fluxes (and thus the defect) are
+	 * always computed with the current solution, as is the density scaling.
+	 * Note that derivatives depending on internal transporter states (such as
+	 * gating variables) are frozen along with them.
+	 *
+	 * @param relTol  relative tolerance (a non-positive value disables reuse)
+	 */
+		void set_frozen_jacobian(number relTol);
+
+	/**
+	 * @brief Skip assembling at quiescent integration points
+	 * An integration point is skipped if the magnitudes of the flux densities as well as
+	 * the flux density changes a 100% change of any unknown would induce (estimated via
+	 * the derivatives) are below the threshold, and as long as the activity indicators
+	 * of the transport mechanism change by less than the given relative tolerance.
+	 * Default is no masking.
+	 *
+	 * @param fluxThresh   flux density threshold (in the units of the assembled flux)
+	 * @param wakeTol      relative change of the indicators that reactivates a point
+	 */
+		void set_activity_masking(number fluxThresh, number wakeTol);
+
+	/// switch off activity masking
+		void disable_activity_masking();
+
+	/// number of integration points currently skipped
+		size_t num_inactive_points() const;
+
+	/**
+	 * @brief Measure the time spent in flux evaluations
+	 *
+	 * If switched on, every call to fluxDensityFct() and fluxDensityDerivFct() is timed.
+	 * The measurements of the last numSteps time steps are kept (a time step ends with
+	 * the next call to prep_timestep()) and can be used to update load balancing weights
+	 * (see MembraneCostBalanceWeights::set_measured_costs()).
+	 *
+	 * @param numSteps  number of time steps to average over; 0 switches measurement off
+	 */
+		void set_cost_measurement(size_t numSteps);
+
+	/// average time (in s) per flux evaluation over the measurement window (negative if none)
+		number measured_time_per_evaluation() const;
+
+	/// relative cost of a membrane element as reported by the transport mechanism
+		number element_cost() const;
+
 	/// @copydoc FV1InnerBoundary<TDomain>::fluxDensityFct()
 		virtual bool fluxDensityFct
 		(
@@ -134,10 +232,51 @@ class MembraneTransportFV1
 	/// @copydoc IElemDisc<TDomain>::prep_timestep()
 		void prep_timestep(number future_time, number time, VectorProxyBase* upb);
 
+	protected:
+	/// @copydoc IElemDisc::approximation_space_changed()
+		virtual void approximation_space_changed();
+
+	/// density at integration point (from cache if caching is enabled)
+		number density(GridObject* e, const MathVector<dim>& coords, int si);
+
+	/// keep flux derivatives computed during defect assembling (combined flux evaluation)
+		void store_flux_derivs
+		(
+			GridObject* e,
+			const MathVector<dim>& coords,
+			const std::vector<number>& u,
+			const std::vector<std::vector<std::pair<size_t, number> > >& vFluxDeriv
+		);
+
+	/// look up flux derivatives kept for unknowns within a relative tolerance (0: the same unknowns)
+		bool stored_flux_derivs
+		(
+			GridObject* e,
+			const MathVector<dim>& coords,
+			const std::vector<number>& u,
+			number relTol,
+			std::vector<std::vector<std::pair<size_t, number> > >& vFluxDeriv
+		);
+
+	/// whether none of the optional assembling features (caching, masking, measurement) is active
+		bool plain_assembling() const
+		{
+			return !m_bCombinedFluxEval && m_frozenJacTol <= 0.0 && !m_bActivityMasking && !m_costWindow;
+		}
+
 	protected:
 		SmartPtr<CplUserData<number,dim> > m_spDensityFct;
 		SmartPtr<IMembraneTransporter> m_spMembraneTransporter;
 
+		/// flux directions and number of dependencies (computed once per setting)
+		std::vector<size_t> m_vFluxFrom;
+		std::vector<size_t> m_vFluxTo;
+		size_t m_nDep;
+
+		/// instrumentation (if enabled)
+		NC_HOT_PATH_COUNTER(m_hpFluxDensity)
+		NC_HOT_PATH_COUNTER(m_hpFluxDensityDeriv)
+
 	private:
 		template <typename List>
 		struct Register
@@ -171,8 +310,62 @@ class MembraneTransportFV1
 
 		void register_all_fv1_funcs();
 
+		/// compute flux direction table from the membrane transporter
+		void update_flux_from_to();
+
+		/// label hot path counters with transporter name and subsets
+		void label_hot_paths();
+
+		/// grid change callbacks (invalidating the density cache)
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
 	private:
 		bool m_bNonRegularGrid;
+
+		/// density values at the integration points of an element
+		struct DensityCacheEntry
+		{
+			std::vector<MathVector<dim> > vCoords;
+			std::vector<number> vDensity;
+		};
+
+		bool m_bDensityCaching;
+		std::map<GridObject*, DensityCacheEntry> m_mDensityCache;
+
+		/// (unscaled) flux derivatives at an integration point for given unknowns
+		struct FluxDerivCacheEntry
+		{
+			MathVector<dim> coords;
+			std::vector<number> vU;
+			std::vector<std::vector<std::pair<size_t, number> > > vFluxDeriv;
+		};
+
+		bool m_bCombinedFluxEval;
+		number m_frozenJacTol;
+
+		/// transporter parameter revision the cached flux data belong to
+		size_t m_paramRevision;
+		std::map<GridObject*, std::vector<FluxDerivCacheEntry> > m_mFluxDerivCache;
+		ThreadScratch<std::vector<std::vector<std::pair<size_t, number> > > > m_vFluxDerivScratch;
+
+		bool m_bActivityMasking;
+		ActivityMask<dim> m_activityMask;
+		ThreadScratch<std::vector<number> > m_vActivityInd;  ///< activity indicators (per thread)
+
+		/// flux evaluation timings
+		struct CostTally
+		{
+			CostTally() : seconds(0.0), count(0) {}
+			number seconds;
+			size_t count;
+		};
+		size_t m_costWindow;
+		ThreadScratch<CostTally> m_costTally;  ///< timings of the current time step (per thread)
+		std::deque<CostTally> m_dCostHistory;  ///< timings of the last m_costWindow steps
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
 };
 
 ///@}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORT_FV1_TYPED_H
+#define UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORT_FV1_TYPED_H
+
+
+#include "membrane_transport_fv1.h"
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/**
+ * @brief MembraneTransportFV1 for a transport mechanism type known at compile time
+ *
+ * Fluxes and flux derivatives are evaluated by calling calc_flux() and
+ * calc_flux_deriv() of TTransporter directly instead of via virtual dispatch
+ * (see IMembraneTransporter::flux_static()), so that small kernels (such as Leak
+ * or SERCA) can be inlined into the assembling.
+ * For this to take effect, the class is explicitly instantiated in the translation
+ * unit defining the transporter's kernels (by including the _impl header there).
+ *
+ * The direct path is only taken if none of the optional features of MembraneTransportFV1
+ * (combined flux evaluation, frozen Jacobian, activity masking, cost measurement)
+ * is active and the transport mechanism has not been replaced by one of a different
+ * type; otherwise, the polymorphic implementation of the base class is used.
+ */
+template <typename TDomain, typename TTransporter>
+class MembraneTransportFV1T
+: public MembraneTransportFV1<TDomain>
+{
+	protected:
+		typedef MembraneTransportFV1<TDomain> base_type;
+		typedef typename base_type::FluxCond FluxCond;
+		typedef typename base_type::FluxDerivCond FluxDerivCond;
+
+	public:
+	///	world dimension
+		static const int dim = TDomain::dim;
+
+	public:
+	/// constructor with c-string
+		MembraneTransportFV1T(const char* subsets, SmartPtr<TTransporter> mt);
+
+	/// constructor with vector
+		MembraneTransportFV1T(const std::vector<std::string>& subsets, SmartPtr<TTransporter> mt);
+
+	/// destructor
+		virtual ~MembraneTransportFV1T();
+
+	/// @copydoc MembraneTransportFV1<TDomain>::fluxDensityFct()
+		virtual bool fluxDensityFct
+		(
+			const std::vector<LocalVector::value_type>& u,
+			GridObject* e,
+			const MathVector<dim>& coords,
+			int si,
+			FluxCond& fc
+		);
+
+	/// @copydoc MembraneTransportFV1<TDomain>::fluxDensityDerivFct()
+		virtual bool fluxDensityDerivFct
+		(
+			const std::vector<LocalVector::value_type>& u,
+			GridObject* e,
+			const MathVector<dim>& coords,
+			int si,
+			FluxDerivCond& fdc
+		);
+
+	protected:
+	/// whether the typed transport mechanism is (still) the one assembled
+		bool direct_path() const;
+
+	protected:
+		SmartPtr<TTransporter> m_spTypedTransporter;
+};
+
+///@}
+
+} // end namespace neuro_collection
+} // end namespace ug
+
+
+#endif  // UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORT_FV1_TYPED_H
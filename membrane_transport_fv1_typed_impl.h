@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORT_FV1_TYPED_IMPL_H
+#define UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORT_FV1_TYPED_IMPL_H
+
+// This file is not included by membrane_transport_fv1_typed.h on purpose:
+// it is only to be included where MembraneTransportFV1T is instantiated,
+// i.e., in the translation unit defining the transporter's flux kernels.
+
+#include "membrane_transport_fv1_typed.h"
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TDomain, typename TTransporter>
+MembraneTransportFV1T<TDomain, TTransporter>::
+MembraneTransportFV1T(const char* subsets, SmartPtr<TTransporter> mt)
+: base_type(subsets, mt), m_spTypedTransporter(mt)
+{}
+
+template <typename TDomain, typename TTransporter>
+MembraneTransportFV1T<TDomain, TTransporter>::
+MembraneTransportFV1T(const std::vector<std::string>& subsets, SmartPtr<TTransporter> mt)
+: base_type(subsets, mt), m_spTypedTransporter(mt)
+{}
+
+template <typename TDomain, typename TTransporter>
+MembraneTransportFV1T<TDomain, TTransporter>::~MembraneTransportFV1T()
+{
+	// nothing to do
+}
+
+
+template <typename TDomain, typename TTransporter>
+bool MembraneTransportFV1T<TDomain, TTransporter>::direct_path() const
+{
+	return this->plain_assembling()
+		&& this->m_spMembraneTransporter.get() == m_spTypedTransporter.get();
+}
+
+
+template <typename TDomain, typename TTransporter>
+bool MembraneTransportFV1T<TDomain, TTransporter>::fluxDensityFct
+(
+	const std::vector<LocalVector::value_type>& u,
+	GridObject* e,
+	const MathVector<dim>& coords,
+	int si,
+	FluxCond& fc
+)
+{
+	if (!direct_path())
+		return base_type::fluxDensityFct(u, e, coords, si, fc);
+
+	NC_HOT_PATH_SCOPE(this->m_hpFluxDensity);
+
+	const size_t n_flux = this->m_vFluxFrom.size();
+	fc.flux.resize(n_flux);
+	fc.from.resize(n_flux);
+	fc.to.resize(n_flux);
+
+	m_spTypedTransporter->template flux_static<TTransporter>(u, e, fc.flux);
+
+	const number dens = this->density(e, coords, si);
+	for (size_t i = 0; i < n_flux; i++)
+	{
+		fc.flux[i] *= dens;
+		fc.from[i] = this->m_vFluxFrom[i];
+		fc.to[i] = this->m_vFluxTo[i];
+	}
+
+	return true;
+}
+
+
+template <typename TDomain, typename TTransporter>
+bool MembraneTransportFV1T<TDomain, TTransporter>::fluxDensityDerivFct
+(
+	const std::vector<LocalVector::value_type>& u,
+	GridObject* e,
+	const MathVector<dim>& coords,
+	int si,
+	FluxDerivCond& fdc
+)
+{
+	if (!direct_path())
+		return base_type::fluxDensityDerivFct(u, e, coords, si, fdc);
+
+	NC_HOT_PATH_SCOPE(this->m_hpFluxDensityDeriv);
+
+	const size_t n_dep = this->m_nDep;
+	const size_t n_flux = this->m_vFluxFrom.size();
+	fdc.fluxDeriv.resize(n_flux);
+	fdc.from.resize(n_flux);
+	fdc.to.resize(n_flux);
+	for (size_t i = 0; i < n_flux; i++)
+		fdc.fluxDeriv[i].resize(n_dep);
+
+	m_spTypedTransporter->template flux_deriv_static<TTransporter>(u, e, fdc.fluxDeriv);
+
+	const number dens = this->density(e, coords, si);
+	for (size_t i = 0; i < n_flux; i++)
+	{
+		for (size_t j = 0; j < n_dep; j++)
+			fdc.fluxDeriv[i][j].second *= dens;
+		fdc.from[i] = this->m_vFluxFrom[i];
+		fdc.to[i] = this->m_vFluxTo[i];
+	}
+
+	return true;
+}
+
+
+} // end namespace neuro_collection
+} // end namespace ug
+
+
+#endif  // UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORT_FV1_TYPED_IMPL_H
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "fused_er_membrane.h"
+#include "../util/int_pow.h"  // for IntPow
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+FusedERMembrane::FusedERMembrane(const std::vector<std::string>& fcts) : IMembraneTransporter(fcts),
+R(8.314), T(310.0), F(96485.0),
+VS(6.5e-24), KS(1.8e-4),
+KA(5.21e13), KB(3.89e9), KC(17.5), MU_RYR(5.0e-11),
+D1(1.3e-4), D2(1.05e-3), D3(9.4e-4), D5(8.23e-5), MU_IP3R(1.6e-12),
+REF_CA_ER(2.5e-1),
+m_densSERCA(0.0), m_densRyR(0.0), m_densIP3R(0.0), m_densLeak(0.0)
+{
+	update_kernel_constants();
+}
+
+
+FusedERMembrane::FusedERMembrane(const char* fcts) : IMembraneTransporter(fcts),
+R(8.314), T(310.0), F(96485.0),
+VS(6.5e-24), KS(1.8e-4),
+KA(5.21e13), KB(3.89e9), KC(17.5), MU_RYR(5.0e-11),
+D1(1.3e-4), D2(1.05e-3), D3(9.4e-4), D5(8.23e-5), MU_IP3R(1.6e-12),
+REF_CA_ER(2.5e-1),
+m_densSERCA(0.0), m_densRyR(0.0), m_densIP3R(0.0), m_densLeak(0.0)
+{
+	update_kernel_constants();
+}
+
+
+FusedERMembrane::~FusedERMembrane()
+{
+	// nothing to do
+}
+
+
+void FusedERMembrane::update_kernel_constants()
+{
+	const number channelPrefactor = R*T/(4*F*F) / REF_CA_ER;
+	m_cSERCA = m_densSERCA * VS;
+	m_cRyR = m_densRyR * channelPrefactor * MU_RYR;
+	m_cIP3R = m_densIP3R * channelPrefactor * MU_IP3R;
+
+	parameters_changed();
+}
+
+
+void FusedERMembrane::set_densities(number serca, number ryr, number ip3r, number leak)
+{
+	UG_COND_THROW(serca < 0.0 || ryr < 0.0 || ip3r < 0.0 || leak < 0.0,
+		"Densities of ER membrane mechanisms must not be negative.");
+
+	m_densSERCA = serca;
+	m_densRyR = ryr;
+	m_densIP3R = ip3r;
+	m_densLeak = leak;
+	update_kernel_constants();
+}
+
+
+void FusedERMembrane::set_leak_to_equilibrium(number caCyt, number caER, number ip3)
+{
+	UG_COND_THROW(caER <= caCyt, "Leakage cannot equilibrate the ER membrane fluxes "
+		"unless the ER calcium concentration is higher than the cytosolic one.");
+
+	m_densLeak = 0.0;
+	KernelTerms t;
+	kernel_terms(caCyt, caER, ip3, false, t);
+
+	const number netFlux = t.g * t.drive - t.serca;
+	UG_COND_THROW(netFlux > 0.0, "Leakage cannot equilibrate the ER membrane fluxes: "
+		"release already exceeds SERCA uptake at the given concentrations.");
+
+	m_densLeak = -netFlux / t.drive;
+	update_kernel_constants();
+}
+
+
+void FusedERMembrane::set_ryr_conductance(number g)
+{
+	MU_RYR = g;
+	update_kernel_constants();
+}
+
+
+void FusedERMembrane::set_ip3r_conductance(number g)
+{
+	MU_IP3R = g;
+	update_kernel_constants();
+}
+
+
+void FusedERMembrane::kernel_terms(number caCyt, number caER, number ip3, bool bDeriv, KernelTerms& t) const
+{
+	t.drive = caER - caCyt;
+	t.g = m_densLeak;
+	t.dg_dCyt = 0.0;
+	t.dg_dIP3 = 0.0;
+
+	// RyR open probability
+	if (m_cRyR != 0.0)
+	{
+		const number kbc3 = KB*IntPow<3>(caCyt);
+		const number s1 = 1.0 + kbc3;
+		const number s2 = 1.0 + KC + 1.0/(KA*IntPow<4>(caCyt)) + kbc3;
+		const number pOpen = s1 / s2;
+		t.g += m_cRyR * pOpen;
+		if (bDeriv)
+		{
+			const number kbc2 = 3.0*KB*caCyt*caCyt;
+			t.dg_dCyt += m_cRyR * (kbc2 + pOpen*(4.0/(KA*IntPow<5>(caCyt)) - kbc2)) / s2;
+		}
+	}
+
+	// IP3R open probability
+	if (m_cIP3R != 0.0)
+	{
+		const number s1 = caCyt*ip3 + ip3*D2 + D1*D2 + caCyt*D3;
+		const number s2 = s1 * (caCyt+D5);
+		const number s3 = (caCyt*ip3*D2) / s2;
+		t.g += m_cIP3R * IntPow<3>(s3);
+		if (bDeriv)
+		{
+			const number c = 3.0*s3*s3*D2 / s2;
+			t.dg_dCyt += m_cIP3R * c*ip3 * (1.0 - caCyt/s2 * ((ip3+D3)*(caCyt+D5) + s1));
+			t.dg_dIP3 = m_cIP3R * c*caCyt * (1.0 - ip3/s2 * (caCyt+D2)*(caCyt+D5));
+		}
+	}
+
+	// SERCA
+	const number ks = KS + caCyt;
+	t.serca = m_cSERCA*caCyt / (ks * caER);
+	if (bDeriv)
+	{
+		t.dSerca_dCyt = m_cSERCA*KS / (ks*ks*caER);
+		t.dSerca_dER = - t.serca / caER;
+	}
+}
+
+
+void FusedERMembrane::flux_derivs_from_terms
+(
+	const KernelTerms& t,
+	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+) const
+{
+	size_t i = 0;
+	if (!has_constant_value(_CCYT_))
+	{
+		flux_derivs[0][i].first = local_fct_index(_CCYT_);
+		flux_derivs[0][i].second = t.dg_dCyt * t.drive - t.g - t.dSerca_dCyt;
+		i++;
+	}
+	if (!has_constant_value(_CER_))
+	{
+		flux_derivs[0][i].first = local_fct_index(_CER_);
+		flux_derivs[0][i].second = t.g - t.dSerca_dER;
+		i++;
+	}
+	if (!has_constant_value(_IP3_))
+	{
+		flux_derivs[0][i].first = local_fct_index(_IP3_);
+		flux_derivs[0][i].second = t.dg_dIP3 * t.drive;
+	}
+}
+
+
+void FusedERMembrane::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const
+{
+	KernelTerms t;
+	kernel_terms(u[_CCYT_], u[_CER_], u[_IP3_], false, t);
+	flux[0] = t.g * t.drive - t.serca;
+}
+
+
+void FusedERMembrane::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const
+{
+	KernelTerms t;
+	kernel_terms(u[_CCYT_], u[_CER_], u[_IP3_], true, t);
+	flux_derivs_from_terms(t, flux_derivs);
+}
+
+
+void FusedERMembrane::calc_flux_and_deriv
+(
+	const std::vector<number>& u,
+	GridObject* e,
+	std::vector<number>& flux,
+	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+) const
+{
+	KernelTerms t;
+	kernel_terms(u[_CCYT_], u[_CER_], u[_IP3_], true, t);
+	flux[0] = t.g * t.drive - t.serca;
+	flux_derivs_from_terms(t, flux_derivs);
+}
+
+
+size_t FusedERMembrane::n_dependencies() const
+{
+	size_t n = 3;
+	for (size_t i = 0; i < 3; i++)
+	{
+		if (has_constant_value(i))
+			n--;
+	}
+
+	return n;
+}
+
+
+size_t FusedERMembrane::n_fluxes() const
+{
+	return 1;
+}
+
+
+const std::pair<size_t,size_t> FusedERMembrane::flux_from_to(size_t flux_i) const
+{
+	size_t from, to;
+	if (is_supplied(_CCYT_)) to = local_fct_index(_CCYT_); else to = InnerBoundaryConstants::_IGNORE_;
+	if (is_supplied(_CER_)) from = local_fct_index(_CER_); else from = InnerBoundaryConstants::_IGNORE_;
+
+	return std::pair<size_t, size_t>(from, to);
+}
+
+
+const std::string FusedERMembrane::name() const
+{
+	return std::string("FusedERMembrane");
+}
+
+
+void FusedERMembrane::check_supplied_functions() const
+{
+	// Check that not both, inner and outer calcium concentrations are not supplied;
+	// in that case, calculation of a flux would be of no consequence.
+	if (!is_supplied(_CCYT_) && !is_supplied(_CER_))
+	{
+		UG_THROW("Supplying neither cytosolic nor endoplasmic calcium concentrations is not allowed.\n"
+				"This would mean that the flux calculation would be of no consequence\n"
+				"and this mechanism would not do anything.");
+	}
+}
+
+
+void FusedERMembrane::print_units() const
+{
+	std::string nm = name();
+	size_t n = nm.size();
+	UG_LOG(std::endl);
+	UG_LOG("+------------------------------------------------------------------------------+"<< std::endl);
+	UG_LOG("|  Units used in the implementation of " << nm << std::string(n>=40?0:40-n, ' ') << "|" << std::endl);
+	UG_LOG("|------------------------------------------------------------------------------|"<< std::endl);
+	UG_LOG("|    Input                                                                     |"<< std::endl);
+	UG_LOG("|      [Ca_cyt]  mM (= mol/m^3)                                                |"<< std::endl);
+	UG_LOG("|      [Ca_er]   mM (= mol/m^3)                                                |"<< std::endl);
+	UG_LOG("|      [IP3]     mM (= mol/m^3)                                                |"<< std::endl);
+	UG_LOG("|                                                                              |"<< std::endl);
+	UG_LOG("|    Output                                                                    |"<< std::endl);
+	UG_LOG("|      Ca flux   mol/(m^2 s)                                                   |"<< std::endl);
+	UG_LOG("+------------------------------------------------------------------------------+"<< std::endl);
+	UG_LOG(std::endl);
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORTERS__FUSED_ER_MEMBRANE_H
+#define UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORTERS__FUSED_ER_MEMBRANE_H
+
+#include "membrane_transporter_interface.h"
+#include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/// Combined SERCA, RyR, IP3R and leakage fluxes through the ER membrane
+/**
+ * This class provides the net calcium flux (from ER to cytosol) of the standard
+ * ER membrane setup, i.e., of the SERCA, RyR (Keizer & Levine, stationary),
+ * IP3R (De Young & Keizer) and Leak transport mechanisms, with the same kinetics
+ * and default parameters as the SERCA, RyR, IP3R and Leak classes.
+ * As the four mechanisms are evaluated from one input vector, sharing the driving
+ * force c_er - c_cyt and the channel current prefactors, it can replace the four
+ * separate MembraneTransportFV1 instances (each integration point is then visited
+ * only once).
+ *
+ * As the mechanisms are summed up here, their densities (number of mechanism units
+ * per membrane area) have to be given to this class (set_densities()) instead of the
+ * membrane transport discretization; the latter should be given a density of 1.
+ * The leakage density is usually chosen to equilibrate the other fluxes at rest,
+ * which can be done by set_leak_to_equilibrium().
+ * A density of zero disables a mechanism.
+ *
+ * Units used in the implementation of this channel:
+ * [Ca_cyt]  mM (= mol/m^3)
+ * [Ca_er]   mM (= mol/m^3)
+ * [IP3]     mM (= mol/m^3)
+ *
+ * Ca flux   mol/(m^2 s)
+ */
+class FusedERMembrane : public IMembraneTransporter
+{
+	public:
+		enum{_CCYT_=0, _CER_, _IP3_};
+
+	protected:
+		const number R;			///< universal gas constant
+		const number T;			///< temperature
+		const number F;			///< Faraday constant
+
+		const number VS;		///< SERCA maximal flux
+		const number KS;		///< SERCA Ca2+ affinity
+
+		const number KA;		///< RyR calcium binding (C1 <--> O1)
+		const number KB;		///< RyR calcium binding (O1 <--> O2)
+		const number KC;		///< RyR O1 <--> C2
+		number MU_RYR;			///< RyR channel conductance
+
+		const number D1;		///< IP3R IP3 binding (w/o Ca2+ inhibition)
+		const number D2;		///< IP3R Ca2+ inhibiting binding
+		const number D3;		///< IP3R IP3 binding (w/ Ca2+ inhibition)
+		const number D5;		///< IP3R Ca2+ activating binding
+		number MU_IP3R;			///< IP3R channel conductance
+
+		const number REF_CA_ER;	///< reference endoplasmic Ca2+ concentration (for conductances)
+
+		/// @name densities of the single mechanisms
+		/// @{
+		number m_densSERCA;
+		number m_densRyR;
+		number m_densIP3R;
+		number m_densLeak;
+		/// @}
+
+		/// @name terms not depending on the unknowns (see update_kernel_constants())
+		/// @{
+		number m_cSERCA;      // densSERCA * VS
+		number m_cRyR;        // densRyR * RT/(4F^2) * MU_RYR/REF_CA_ER
+		number m_cIP3R;       // densIP3R * RT/(4F^2) * MU_IP3R/REF_CA_ER
+		/// @}
+
+		/// terms shared by calc_flux() and calc_flux_deriv()
+		struct KernelTerms
+		{
+			number drive;      // caER - caCyt
+			number g;          // total channel and leak conductance (times density)
+			number serca;      // SERCA flux (times density)
+			number dg_dCyt;    // derivative of g w.r.t. caCyt
+			number dg_dIP3;    // derivative of g w.r.t. ip3
+			number dSerca_dCyt;
+			number dSerca_dER;
+		};
+
+		/// compute shared terms (derivative terms only if bDeriv)
+		void kernel_terms(number caCyt, number caER, number ip3, bool bDeriv, KernelTerms& t) const;
+
+		/// flux derivatives from the shared terms
+		void flux_derivs_from_terms
+		(
+			const KernelTerms& t,
+			std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+		) const;
+
+		/// fold all terms that only depend on parameters (called by constructors and setters)
+		void update_kernel_constants();
+
+	public:
+		/// @copydoc IMembraneTransporter::IMembraneTransporter(const std::vector<std::string)
+		FusedERMembrane(const std::vector<std::string>& fcts);
+
+		/// @copydoc IMembraneTransporter::IMembraneTransporter()
+		FusedERMembrane(const char* fcts);
+
+		/// @copydoc IMembraneTransporter::IMembraneTransporter()
+		virtual ~FusedERMembrane();
+
+		/// set the densities of SERCA, RyR, IP3R and leakage (in units/m^2)
+		void set_densities(number serca, number ryr, number ip3r, number leak);
+
+		/// set the leakage density such that the net flux vanishes for the given concentrations
+		void set_leak_to_equilibrium(number caCyt, number caER, number ip3);
+
+		/// leakage density
+		number leak_density() const {return m_densLeak;}
+
+		/// set RyR channel conductance
+		void set_ryr_conductance(number g);
+
+		/// set IP3R channel conductance
+		void set_ip3r_conductance(number g);
+
+		/// @copydoc IMembraneTransporter::calc_flux()
+		virtual void calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const;
+
+		/// @copydoc IMembraneTransporter::calc_flux_deriv()
+		virtual void calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const;
+
+		/// @copydoc IMembraneTransporter::calc_flux_and_deriv()
+		virtual void calc_flux_and_deriv
+		(
+			const std::vector<number>& u,
+			GridObject* e,
+			std::vector<number>& flux,
+			std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+		) const;
+
+		/// @copydoc IMembraneTransporter::n_dependencies()
+		virtual size_t n_dependencies() const;
+
+		/// @copydoc IMembraneTransporter::n_fluxes()
+		virtual size_t n_fluxes() const;
+
+		/// @copydoc IMembraneTransporter::flux_from_to()
+		virtual const std::pair<size_t,size_t> flux_from_to(size_t flux_i) const;
+
+		/// @copydoc IMembraneTransporter::name()
+		virtual const std::string name() const;
+
+		/// @copydoc IMembraneTransporter::check_supplied_functions()
+		virtual void check_supplied_functions() const;
+
+		/// @copydoc IMembraneTransporter::print_units()
+		virtual void print_units() const;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORTERS__FUSED_ER_MEMBRANE_H
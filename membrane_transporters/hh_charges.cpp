@@ -80,7 +80,7 @@ void HHCharges<TDomain>::use_exact_gating_mode(number timeStep)
 template <typename TDomain>
 void HHCharges<TDomain>::use_gating_explicit_current_mode()
 {
-	m_bGatingExplicitCurrentMode = true;
+	set_frozen_gating_jacobian(true);
 }
 
 
@@ -91,10 +91,11 @@ HHCharges<TDomain>::HHCharges(const std::vector<std::string>& fcts, const std::v
   m_eK(-0.077), m_eNa(0.05),
   m_refTime(1.0),
   m_bVoltageExplicitDiscMode(false),
-  m_bGatingExplicitCurrentMode(false),
   m_VEDMdt(1e-5),
+  m_bUseRateTables(false),
   m_bNonRegularGrid(false),
-  m_bCurrElemIsHSlave(false)
+  m_bCurrElemIsHSlave(false),
+  m_pCurrGeom(NULL)
 {
 	// nothing to do
 }
@@ -107,10 +108,11 @@ HHCharges<TDomain>::HHCharges(const char* fcts, const char* subsets)
   m_eK(-0.077), m_eNa(0.05),
   m_refTime(1.0),
   m_bVoltageExplicitDiscMode(false),
-  m_bGatingExplicitCurrentMode(false),
   m_VEDMdt(1e-5),
+  m_bUseRateTables(false),
   m_bNonRegularGrid(false),
-  m_bCurrElemIsHSlave(false)
+  m_bCurrElemIsHSlave(false),
+  m_pCurrGeom(NULL)
 {
 	// nothing to do
 }
@@ -160,7 +162,7 @@ void HHCharges<TDomain>::calc_flux_deriv(const std::vector<number>& u, GridObjec
 		++i;
 	}
 
-	if (!m_bGatingExplicitCurrentMode)
+	if (!frozen_gating_jacobian())
 	{
 		flux_derivs[0][i].first = local_fct_index(_N_);
 		flux_derivs[0][i].second = m_gK * 4.0*n*n*n * (vm - m_eK);
@@ -447,6 +449,50 @@ static number d_tau_h_d_vm(number vm)
 }
 
 
+// gating functions in the order given by the gating function indices
+static const RateTable::RateFct gatingFcts[] =
+{
+	&n_infty, &tau_n, &m_infty, &tau_m, &h_infty, &tau_h,
+	&d_n_infty_d_vm, &d_tau_n_d_vm, &d_m_infty_d_vm, &d_tau_m_d_vm, &d_h_infty_d_vm, &d_tau_h_d_vm
+};
+
+
+template <typename TDomain>
+void HHCharges<TDomain>::use_rate_tables(bool b, number relTol)
+{
+	m_bUseRateTables = b;
+	if (!b)
+		return;
+
+	// tabulate for membrane potentials between -200mV and 150mV
+	const std::vector<RateTable::RateFct> vFct(gatingFcts, gatingFcts + _NGATEFCTS_);
+	m_rateTable.init(vFct, -0.2, 0.15, relTol);
+
+	UG_LOG(name() << ": Gating functions tabulated on " << m_rateTable.num_nodes()
+		<< " nodes (max. relative interpolation error: " << m_rateTable.max_error() << ")." << std::endl);
+}
+
+
+template <typename TDomain>
+void HHCharges<TDomain>::gating_fcts(number vm, number* g, bool withDerivs) const
+{
+	if (m_bUseRateTables)
+	{
+		m_rateTable.eval(vm, g);
+		return;
+	}
+
+	const size_t nFct = withDerivs ? (size_t) _NGATEFCTS_ : (size_t) _DNINF_;
+	for (size_t f = 0; f < nFct; ++f)
+		g[f] = gatingFcts[f](vm);
+}
+
+
+template <typename TDomain>
+void HHCharges<TDomain>::set_geometry_cache(SmartPtr<ManifoldGeometryCache<TDomain> > spCache)
+{
+	m_spGeomCache = spCache;
+}
 
 
 template <typename TDomain>
@@ -495,10 +541,13 @@ prep_elem(const LocalVector& u, GridObject* elem, const ReferenceObjectID roid,
 	// on horizontal interfaces: only treat hmasters
 	if (m_bCurrElemIsHSlave) return;
 
-	// update geometry for this element
-	static TFVGeom& geo = GeomProvider<TFVGeom>::get();
-	try {geo.update(elem, vCornerCoords, &(this->subset_handler()));}
-	UG_CATCH_THROW("HH::prep_elem: Cannot update finite volume geometry.");
+	// update geometry for this element (or take it from the cache)
+	try
+	{
+		m_pCurrGeom = prepare_manifold_geometry<TFVGeom>(m_spGeomCache.get(), m_localGeom,
+			elem, vCornerCoords, &(this->subset_handler()));
+	}
+	UG_CATCH_THROW("HHCharges::prep_elem: Cannot update finite volume geometry.");
 }
 
 
@@ -516,14 +565,14 @@ void HHCharges<TDomain>::add_def_A_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -533,17 +582,22 @@ void HHCharges<TDomain>::add_def_A_elem
 		const number m = u(_M_, co);
 		const number h = u(_H_, co);
 
+		number g[_NGATEFCTS_];
+		gating_fcts(vm, g, false);
+
 		if (!m_bVoltageExplicitDiscMode)
 		{
-			d(_N_, co) -= (n_infty(vm) - n) / tau_n(vm) * m_refTime * bf.volume();
-			d(_M_, co) -= (m_infty(vm) - m) / tau_m(vm) * m_refTime * bf.volume();
-			d(_H_, co) -= (h_infty(vm) - h) / tau_h(vm) * m_refTime * bf.volume();
+			d(_N_, co) -= (g[_NINF_] - n) / g[_TAUN_] * m_refTime * bf.volume();
+			d(_M_, co) -= (g[_MINF_] - m) / g[_TAUM_] * m_refTime * bf.volume();
+			d(_H_, co) -= (g[_HINF_] - h) / g[_TAUH_] * m_refTime * bf.volume();
 		}
 		else
 		{
-			d(_N_, co) -= (n_infty(vm) - n) * (1.0 - exp(-m_VEDMdt*m_refTime/tau_n(vm))) * bf.volume() / m_VEDMdt;
-			d(_M_, co) -= (m_infty(vm) - m) * (1.0 - exp(-m_VEDMdt*m_refTime/tau_m(vm))) * bf.volume() / m_VEDMdt;
-			d(_H_, co) -= (h_infty(vm) - h) * (1.0 - exp(-m_VEDMdt*m_refTime/tau_h(vm))) * bf.volume() / m_VEDMdt;
+			// Rush-Larsen step: u_new - u = (u_inf - u) * (1 - f)
+			const number dt = m_VEDMdt*m_refTime;
+			d(_N_, co) -= (g[_NINF_] - n) * (1.0 - gating_decay_factor(g[_TAUN_], dt, GIS_RUSH_LARSEN)) * bf.volume() / m_VEDMdt;
+			d(_M_, co) -= (g[_MINF_] - m) * (1.0 - gating_decay_factor(g[_TAUM_], dt, GIS_RUSH_LARSEN)) * bf.volume() / m_VEDMdt;
+			d(_H_, co) -= (g[_HINF_] - h) * (1.0 - gating_decay_factor(g[_TAUH_], dt, GIS_RUSH_LARSEN)) * bf.volume() / m_VEDMdt;
 		}
 	}
 }
@@ -563,14 +617,14 @@ void HHCharges<TDomain>::add_def_M_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -602,14 +656,14 @@ void HHCharges<TDomain>::add_jac_A_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -619,25 +673,53 @@ void HHCharges<TDomain>::add_jac_A_elem
 		const number m = u(_M_, co);
 		const number h = u(_H_, co);
 
-		const number t_n = tau_n(vm);
-		const number t_m = tau_m(vm);
-		const number t_h = tau_h(vm);
+		number g[_NGATEFCTS_];
+		gating_fcts(vm, g, true);
 
-		const number dn_dvm = (d_n_infty_d_vm(vm) * t_n - (n_infty(vm) - n) * d_tau_n_d_vm(vm)) / (t_n*t_n);
-		const number dm_dvm = (d_m_infty_d_vm(vm) * t_m - (m_infty(vm) - m) * d_tau_m_d_vm(vm)) / (t_m*t_m);
-		const number dh_dvm = (d_h_infty_d_vm(vm) * t_h - (h_infty(vm) - h) * d_tau_h_d_vm(vm)) / (t_h*t_h);
+		const number t_n = g[_TAUN_];
+		const number t_m = g[_TAUM_];
+		const number t_h = g[_TAUH_];
+
+		// rates (u_inf - u) * r of the assembled gating ODEs,
+		// their derivatives w.r.t. the gating values (dr) and Vm (du_dvm)
+		number rn, rm, rh, dn_dvm, dm_dvm, dh_dvm;
+		if (!m_bVoltageExplicitDiscMode)
+		{
+			rn = m_refTime / t_n;
+			rm = m_refTime / t_m;
+			rh = m_refTime / t_h;
+
+			dn_dvm = (g[_DNINF_] * t_n - (g[_NINF_] - n) * g[_DTAUN_]) / (t_n*t_n) * m_refTime;
+			dm_dvm = (g[_DMINF_] * t_m - (g[_MINF_] - m) * g[_DTAUM_]) / (t_m*t_m) * m_refTime;
+			dh_dvm = (g[_DHINF_] * t_h - (g[_HINF_] - h) * g[_DTAUH_]) / (t_h*t_h) * m_refTime;
+		}
+		else
+		{
+			// Rush-Larsen: r = (1 - f) / dt
+			const number dt = m_VEDMdt*m_refTime;
+			rn = (1.0 - gating_decay_factor(t_n, dt, GIS_RUSH_LARSEN)) / m_VEDMdt;
+			rm = (1.0 - gating_decay_factor(t_m, dt, GIS_RUSH_LARSEN)) / m_VEDMdt;
+			rh = (1.0 - gating_decay_factor(t_h, dt, GIS_RUSH_LARSEN)) / m_VEDMdt;
+
+			dn_dvm = g[_DNINF_] * rn - (g[_NINF_] - n)
+				* gating_decay_factor_deriv_tau(t_n, dt, GIS_RUSH_LARSEN) * g[_DTAUN_] / m_VEDMdt;
+			dm_dvm = g[_DMINF_] * rm - (g[_MINF_] - m)
+				* gating_decay_factor_deriv_tau(t_m, dt, GIS_RUSH_LARSEN) * g[_DTAUM_] / m_VEDMdt;
+			dh_dvm = g[_DHINF_] * rh - (g[_HINF_] - h)
+				* gating_decay_factor_deriv_tau(t_h, dt, GIS_RUSH_LARSEN) * g[_DTAUH_] / m_VEDMdt;
+		}
 
-		J(_N_, co, _N_, co) += 1.0 / t_n * m_refTime * bf.volume();
-		J(_N_, co, _PHII_, co) -= dn_dvm * scale_input(_PHII_) * m_refTime * bf.volume();
-		J(_N_, co, _PHIO_, co) += dn_dvm * scale_input(_PHIO_) * m_refTime * bf.volume();
+		J(_N_, co, _N_, co) += rn * bf.volume();
+		J(_N_, co, _PHII_, co) -= dn_dvm * scale_input(_PHII_) * bf.volume();
+		J(_N_, co, _PHIO_, co) += dn_dvm * scale_input(_PHIO_) * bf.volume();
 
-		J(_M_, co, _M_, co) += 1.0 / t_m * m_refTime * bf.volume();
-		J(_M_, co, _PHII_, co) -= dm_dvm * scale_input(_PHII_) * m_refTime * bf.volume();
-		J(_M_, co, _PHIO_, co) += dm_dvm * scale_input(_PHIO_) * m_refTime * bf.volume();
+		J(_M_, co, _M_, co) += rm * bf.volume();
+		J(_M_, co, _PHII_, co) -= dm_dvm * scale_input(_PHII_) * bf.volume();
+		J(_M_, co, _PHIO_, co) += dm_dvm * scale_input(_PHIO_) * bf.volume();
 
-		J(_H_, co, _H_, co) += 1.0 / t_h * m_refTime * bf.volume();
-		J(_H_, co, _PHII_, co) -= dh_dvm * scale_input(_PHII_) * m_refTime * bf.volume();
-		J(_H_, co, _PHIO_, co) += dh_dvm * scale_input(_PHIO_) * m_refTime * bf.volume();
+		J(_H_, co, _H_, co) += rh * bf.volume();
+		J(_H_, co, _PHII_, co) -= dh_dvm * scale_input(_PHII_) * bf.volume();
+		J(_H_, co, _PHIO_, co) += dh_dvm * scale_input(_PHIO_) * bf.volume();
 	}
 }
 
@@ -656,14 +738,14 @@ void HHCharges<TDomain>::add_jac_M_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -43,6 +43,9 @@
 #include "membrane_transporter_interface.h"
 #include "lib_disc/spatial_disc/elem_disc/elem_disc_interface.h"
 #include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
+#include "../util/rate_table.h"
+#include "../util/gating_integrator.h"
+#include "../util/manifold_geometry_cache.h"  // for ManifoldGeometryCache
 
 
 namespace ug {
@@ -131,8 +134,24 @@ class HHCharges
 		 */
 		void use_exact_gating_mode(number timeStep);
 
+		/// use gates of the current iterate as constants in the current derivatives
+		/** Equivalent to set_frozen_gating_jacobian(true). **/
 		void use_gating_explicit_current_mode();
 
+		/**
+		 * @brief Use tabulated gating functions
+		 *
+		 * If enabled, gating limit values and time constants (and their derivatives
+		 * w.r.t. the membrane potential) are no longer evaluated exactly, but interpolated
+		 * from a table on a fine voltage grid (cf. RateTable), which is computed here
+		 * such that the relative interpolation error is below the given tolerance.
+		 * The exact evaluation (default) can be used for validation.
+		 *
+		 * @param b       whether to use tabulated gating functions
+		 * @param relTol  relative interpolation tolerance
+		 */
+		void use_rate_tables(bool b, number relTol);
+
 	// inheritances from IMembraneTransporter
 	public:
 		/// @copydoc IMembraneTransporter::calc_flux()
@@ -159,6 +178,18 @@ class HHCharges
 		/// @copydoc IMembraneTransporter::print_units()
 		virtual void print_units() const;
 
+	public:
+		/**
+		 * @brief Use a (shared) cache for the membrane element geometry
+		 *
+		 * If set, the boundary faces of each membrane element are computed only once
+		 * instead of in every assembling (until the grid is adapted or redistributed).
+		 * The same cache can be given to all membrane discs working on the grid.
+		 *
+		 * @param spCache  geometry cache (an invalid pointer disables caching)
+		 */
+		void set_geometry_cache(SmartPtr<ManifoldGeometryCache<TDomain> > spCache);
+
 	// inheritances from IElemDisc
 	public:
 		/// type of trial space for each function used
@@ -220,6 +251,13 @@ class HHCharges
 		template <typename TElem, typename TFVGeom>
 		void register_fv1_func();
 
+		/// indices of gating functions
+		enum{_NINF_ = 0, _TAUN_, _MINF_, _TAUM_, _HINF_, _TAUH_,
+			_DNINF_, _DTAUN_, _DMINF_, _DTAUM_, _DHINF_, _DTAUH_, _NGATEFCTS_};
+
+		/// evaluate gating functions (exact or tabulated; derivatives only if requested)
+		void gating_fcts(number vm, number* g, bool withDerivs) const;
+
 	protected:
 		number m_gK;    ///< potassium single-channel conductance [C/Vs]
 		number m_gNa;   ///< sodium single-channel conductance [C/Vs]
@@ -229,12 +267,19 @@ class HHCharges
 		number m_refTime;
 
 		bool m_bVoltageExplicitDiscMode;
-		bool m_bGatingExplicitCurrentMode;
 		number m_VEDMdt;
 
+		bool m_bUseRateTables;
+		RateTable m_rateTable;
+
 	protected:
 		bool m_bNonRegularGrid;
 		bool m_bCurrElemIsHSlave;
+
+		/// geometry of the current element (from cache or local)
+		SmartPtr<ManifoldGeometryCache<TDomain> > m_spGeomCache;
+		ManifoldElemGeometry m_localGeom;
+		const ManifoldElemGeometry* m_pCurrGeom;
 };
 
 ///@}
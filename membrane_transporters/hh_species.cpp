@@ -103,9 +103,12 @@ HHSpecies<TDomain>::HHSpecies
   m_initTime(0.0),
   m_oldTime(0.0),
   m_bInitiated(false),
-  m_bVoltageExplicitDiscMode(false)
+  m_bVoltageExplicitDiscMode(false),
+  m_bUseRateTables(false)
 {
-	// nothing to do
+	m_gatingStore.set_num_states(_GS_NUM_);
+	if (m_spSH.valid() && m_spSH->grid())
+		m_gatingStore.register_grid_callbacks(*m_spSH->grid());
 }
 
 
@@ -124,9 +127,12 @@ HHSpecies<TDomain>::HHSpecies(const char* fcts, const char* subsets, ConstSmartP
   m_initTime(0.0),
   m_oldTime(0.0),
   m_bInitiated(false),
-  m_bVoltageExplicitDiscMode(false)
+  m_bVoltageExplicitDiscMode(false),
+  m_bUseRateTables(false)
 {
-	// nothing to do
+	m_gatingStore.set_num_states(_GS_NUM_);
+	if (m_spSH.valid() && m_spSH->grid())
+		m_gatingStore.register_grid_callbacks(*m_spSH->grid());
 }
 
 
@@ -297,6 +303,16 @@ const std::string HHSpecies<TDomain>::name() const
 }
 
 
+template<typename TDomain>
+void HHSpecies<TDomain>::report_memory(MemoryReport& rep) const
+{
+	rep.add("gating map", MapMemory(m_mGating));
+	rep.add("gating state store", m_gatingStore.memory_bytes()
+		+ VectorMemory(m_vGatingSlotInfo));
+	rep.add("rate table", m_rateTable.memory_bytes());
+}
+
+
 template <typename TDomain>
 void HHSpecies<TDomain>::check_supplied_functions() const
 {
@@ -414,6 +430,156 @@ static number tau_h(number u)
 }
 
 
+// gating functions in the order given by the gating function indices
+static const RateTable::RateFct gatingFcts[] =
+{
+	&n_infty, &tau_n, &m_infty, &tau_m, &h_infty, &tau_h
+};
+
+
+template <typename TDomain>
+void HHSpecies<TDomain>::use_rate_tables(bool b, number relTol)
+{
+	m_bUseRateTables = b;
+	if (!b)
+		return;
+
+	// tabulate for membrane potentials between -200mV and 150mV
+	const std::vector<RateTable::RateFct> vFct(gatingFcts, gatingFcts + _NGATEFCTS_);
+	m_rateTable.init(vFct, -0.2, 0.15, relTol);
+
+	UG_LOG(name() << ": Gating functions tabulated on " << m_rateTable.num_nodes()
+		<< " nodes (max. relative interpolation error: " << m_rateTable.max_error() << ")." << std::endl);
+}
+
+
+template <typename TDomain>
+SmartPtr<ICheckpointState> HHSpecies<TDomain>::checkpoint_state()
+{
+	return make_sp(new MemberCheckpointState<HHSpecies<TDomain> >(this));
+}
+
+
+template <typename TDomain>
+size_t HHSpecies<TDomain>::num_checkpoint_values() const
+{
+	// n, m, h and whether the gates have been initialized
+	return 4;
+}
+
+
+template <typename TDomain>
+void HHSpecies<TDomain>::collect_checkpoint_objects(std::vector<GridObject*>& vObj)
+{
+	vObj.clear();
+
+	const MultiGrid* mg = dynamic_cast<const MultiGrid*>(m_spSH->grid());
+	UG_COND_THROW(!mg, "Underlying grid is not a multigrid.");
+
+	SubsetGroup ssGrp;
+	try {ssGrp = SubsetGroup(m_spSH, this->m_vSubset);}
+	UG_CATCH_THROW("Subset group creation failed.");
+
+	// surface elements of all channel subsets
+	const size_t nSs = ssGrp.size();
+	for (size_t s = 0; s < nSs; ++s)
+	{
+		const int si = ssGrp[s];
+		const int ssDim = DimensionOfSubset(*m_spSH, si);
+		GridObjectCollection goc = m_spSH->get_grid_objects_in_subset(si);
+		for (size_t lvl = 0; lvl < goc.num_levels(); ++lvl)
+		{
+			if (ssDim == 0)
+				collect_surface_objects<Vertex>(*mg, goc, lvl, vObj);
+			else if (ssDim == 1)
+				collect_surface_objects<Edge>(*mg, goc, lvl, vObj);
+			else if (ssDim == 2)
+				collect_surface_objects<Face>(*mg, goc, lvl, vObj);
+			else if (ssDim == 3)
+				collect_surface_objects<Volume>(*mg, goc, lvl, vObj);
+			else UG_THROW("Subset dimension " << ssDim << " is not supported.");
+		}
+	}
+}
+
+
+template <typename TDomain>
+template <typename TElem>
+void HHSpecies<TDomain>::collect_surface_objects
+(
+	const MultiGrid& mg,
+	GridObjectCollection& goc,
+	size_t lvl,
+	std::vector<GridObject*>& vObj
+) const
+{
+	typedef typename geometry_traits<TElem>::iterator it_type;
+	it_type it = goc.begin<TElem>(lvl);
+	it_type itEnd = goc.end<TElem>(lvl);
+	for (; it != itEnd; ++it)
+		if (!mg.has_children(*it))
+			vObj.push_back(*it);
+}
+
+
+template <typename TDomain>
+void HHSpecies<TDomain>::get_checkpoint_values(GridObject* o, number* vals) const
+{
+	typename GatingMap::const_iterator it = m_mGating.find(o);
+	if (it == m_mGating.end())
+	{
+		vals[0] = vals[1] = vals[2] = vals[3] = 0.0;
+		return;
+	}
+
+	vals[0] = it->second.n;
+	vals[1] = it->second.m;
+	vals[2] = it->second.h;
+	vals[3] = 1.0;
+}
+
+
+template <typename TDomain>
+void HHSpecies<TDomain>::set_checkpoint_values(GridObject* o, const number* vals)
+{
+	// gates that had not been initialized are initialized as usual
+	if (vals[3] == 0.0)
+		return;
+
+	GatingInfo& gatings = m_mGating[o];
+	gatings.n = vals[0];
+	gatings.m = vals[1];
+	gatings.h = vals[2];
+	m_bInitiated = true;
+}
+
+
+template <typename TDomain>
+void HHSpecies<TDomain>::checkpoint_restored(number time)
+{
+	if (m_bInitiated)
+	{
+		m_time = time;
+		m_oldTime = time;
+		m_initTime = time;
+	}
+}
+
+
+template <typename TDomain>
+void HHSpecies<TDomain>::gating_fcts(number vm, number* g) const
+{
+	if (m_bUseRateTables)
+	{
+		m_rateTable.eval(vm, g);
+		return;
+	}
+
+	for (size_t f = 0; f < (size_t) _NGATEFCTS_; ++f)
+		g[f] = gatingFcts[f](vm);
+}
+
+
 
 template<typename TDomain>
 template <typename TAlgebra, int locDim>
@@ -488,56 +654,98 @@ void HHSpecies<TDomain>::update_potential
 
 
 template<typename TDomain>
-void HHSpecies<TDomain>::init_gating(GridObject* elem)
+void HHSpecies<TDomain>::init_all_gating()
 {
-	// calculate corresponding start condition for gates and save them
-	typename GatingMap::iterator it = m_mGating.find(elem);
-	UG_COND_THROW(it == m_mGating.end(), "No gating value available on element.");
-	GatingInfo& gatings = it->second;
-	const number& vm = gatings.vm;
-	number& n = gatings.n;
-	number& m = gatings.m;
-	number& h = gatings.h;
+	const long nSlots = (long) m_gatingStore.size();
+
+	// gather
+	number* vm = m_gatingStore.state(_GS_VM_);
+	for (long k = 0; k < nSlots; ++k)
+		vm[k] = m_vGatingSlotInfo[k]->vm;
+
+	// equilibria (only the steady-state gating functions are needed)
+	const size_t vInfFct[3] = {_NINF_, _MINF_, _HINF_};
+	for (size_t i = 0; i < 3; ++i)
+	{
+		const size_t f = vInfFct[i];
+		number* g = m_gatingStore.state(_GS_FCT_ + f);
+		if (m_bUseRateTables)
+			m_rateTable.eval_batch(vm, (size_t) nSlots, f, g);
+		else
+		{
+			for (long k = 0; k < nSlots; ++k)
+				g[k] = gatingFcts[f](vm[k]);
+		}
+	}
 
-	n = n_infty(vm);
-	m = m_infty(vm);
-	h = h_infty(vm);
+	// scatter
+	const number* ninf = m_gatingStore.state(_GS_FCT_ + _NINF_);
+	const number* minf = m_gatingStore.state(_GS_FCT_ + _MINF_);
+	const number* hinf = m_gatingStore.state(_GS_FCT_ + _HINF_);
+	for (long k = 0; k < nSlots; ++k)
+	{
+		GatingInfo& gatings = *m_vGatingSlotInfo[k];
+		gatings.n = ninf[k];
+		gatings.m = minf[k];
+		gatings.h = hinf[k];
+	}
 }
 
 
 template<typename TDomain>
-void HHSpecies<TDomain>::update_gating(GridObject* elem)
+void HHSpecies<TDomain>::update_all_gating(number dt)
 {
-	// time step
-	number dt = m_refTime * (m_time - m_oldTime);
-	typename GatingMap::iterator it = m_mGating.find(elem);
-	UG_COND_THROW(it == m_mGating.end(), "No gating value available on element.");
-	GatingInfo& gatings = it->second;
-	const number& vm = gatings.vm;
-	number& n = gatings.n;
-	number& m = gatings.m;
-	number& h = gatings.h;
-
-	const number ninf = n_infty(vm);
-	const number minf = m_infty(vm);
-	const number hinf = h_infty(vm);
-	const number taun = tau_n(vm);
-	const number taum = tau_m(vm);
-	const number tauh = tau_h(vm);
-
-	if (m_bVoltageExplicitDiscMode)
+	dt *= m_refTime;
+	const long nSlots = (long) m_gatingStore.size();
+
+	// gather
+	number* vm = m_gatingStore.state(_GS_VM_);
+	number* n = m_gatingStore.state(_GS_N_);
+	number* m = m_gatingStore.state(_GS_M_);
+	number* h = m_gatingStore.state(_GS_H_);
+	for (long k = 0; k < nSlots; ++k)
 	{
-		// solve gating ODEs directly
-		n = ninf + (n - ninf) * exp(-dt/taun);
-		m = minf + (m - minf) * exp(-dt/taum);
-		h = hinf + (h - hinf) * exp(-dt/tauh);
+		const GatingInfo& gatings = *m_vGatingSlotInfo[k];
+		vm[k] = gatings.vm;
+		n[k] = gatings.n;
+		m[k] = gatings.m;
+		h[k] = gatings.h;
 	}
-	else
+
+	// gating functions
+	number* g[_NGATEFCTS_];
+	for (size_t f = 0; f < (size_t) _NGATEFCTS_; ++f)
+	{
+		g[f] = m_gatingStore.state(_GS_FCT_ + f);
+		if (m_bUseRateTables)
+			m_rateTable.eval_batch(vm, (size_t) nSlots, f, g[f]);
+		else
+		{
+			for (long k = 0; k < nSlots; ++k)
+				g[f][k] = gatingFcts[f](vm[k]);
+		}
+	}
+
+	const number* ninf = g[_NINF_];
+	const number* minf = g[_MINF_];
+	const number* hinf = g[_HINF_];
+	const number* taun = g[_TAUN_];
+	const number* taum = g[_TAUM_];
+	const number* tauh = g[_TAUH_];
+
+	// solve gating ODEs directly (Rush-Larsen) or using implicit Euler
+	const GatingIntegrationScheme scheme = m_bVoltageExplicitDiscMode ? GIS_RUSH_LARSEN : GIS_IMPLICIT_EULER;
+	gating_step_batch(n, ninf, taun, (size_t) nSlots, dt, scheme);
+	gating_step_batch(m, minf, taum, (size_t) nSlots, dt, scheme);
+	gating_step_batch(h, hinf, tauh, (size_t) nSlots, dt, scheme);
+
+	// scatter
+	for (long k = 0; k < nSlots; ++k)
 	{
-		// solve gating ODEs using implicit Euler
-		n = (taun * n + dt * ninf) / (dt + taun);
-		m = (taum * m + dt * minf) / (dt + taum);
-		h = (tauh * h + dt * hinf) / (dt + tauh);
+		GatingInfo& gatings = *m_vGatingSlotInfo[k];
+		gatings.n = n[k];
+		gatings.m = m[k];
+		gatings.h = h[k];
 	}
 }
 
@@ -554,10 +762,8 @@ void HHSpecies<TDomain>::update_time(const number newTime)
 
 template <typename TDomain>
 template <typename TAlgebra, int locDim>
-void HHSpecies<TDomain>::prep_timestep_with_algebra_type_and_dim
+void HHSpecies<TDomain>::prepare_gating_slots_for_subset
 (
-	number future_time,
-	const number time,
 	const typename TAlgebra::vector_type& u,
 	int si
 )
@@ -573,56 +779,99 @@ void HHSpecies<TDomain>::prep_timestep_with_algebra_type_and_dim
 	// update or init potential values
 	update_potential<TAlgebra, locDim>(dd, si, u);
 
-	// initiate gatings if this has not already been done (or init again; stationary case)
-	if (!m_bInitiated || future_time == m_initTime)
+	// assign sides to gating store slots (if necessary)
+	if (!m_gatingStore.valid())
 	{
-		m_time = time;
-		m_initTime = time;
-
 		it_type it = dd->begin<elem_t>(si);
 		it_type it_end = dd->end<elem_t>(si);
 		for (; it != it_end; ++it)
-			init_gating(*it);
+		{
+			m_gatingStore.add(*it);
+			m_vGatingSlotInfo.push_back(&m_mGating[*it]);
+		}
 	}
-
-	update_time(future_time);
-
-	// loop sides and update gatings
-	it_type it = dd->begin<elem_t>(si);
-	it_type it_end = dd->end<elem_t>(si);
-	for (; it != it_end; ++it)
-		update_gating(*it);
 }
 
 
 template <typename TDomain>
 template <typename TAlgebra>
-void HHSpecies<TDomain>::prep_timestep_with_algebra_type
-(
-	number future_time,
-	const number time,
-	const typename TAlgebra::vector_type& u
-)
+void HHSpecies<TDomain>::prepare_gating_slots(const typename TAlgebra::vector_type& u)
 {
 	SubsetGroup ssGrp;
 	try {ssGrp = SubsetGroup(m_spSH, this->m_vSubset);}
 	UG_CATCH_THROW("Subset group creation failed.");
 
+	// the gating store is rebuilt while looping the subsets if it is outdated
+	const bool rebuildGatingStore = !m_gatingStore.valid();
+	if (rebuildGatingStore)
+	{
+		m_gatingStore.clear();
+		m_vGatingSlotInfo.clear();
+	}
+
 	const size_t nSs = ssGrp.size();
 	for (std::size_t si = 0; si < nSs; ++si)
 	{
 		int ssDim = DimensionOfSubset(*m_spSH, ssGrp[si]);
 		if (ssDim == 3)
-			prep_timestep_with_algebra_type_and_dim<TAlgebra, 3>(future_time, time, u, ssGrp[si]);
+			prepare_gating_slots_for_subset<TAlgebra, 3>(u, ssGrp[si]);
 		else if (ssDim == 2)
-			prep_timestep_with_algebra_type_and_dim<TAlgebra, 2>(future_time, time, u, ssGrp[si]);
+			prepare_gating_slots_for_subset<TAlgebra, 2>(u, ssGrp[si]);
 		else if (ssDim == 1)
-			prep_timestep_with_algebra_type_and_dim<TAlgebra, 1>(future_time, time, u, ssGrp[si]);
+			prepare_gating_slots_for_subset<TAlgebra, 1>(u, ssGrp[si]);
 		else if (ssDim == 0)
-			prep_timestep_with_algebra_type_and_dim<TAlgebra, 0>(future_time, time, u, ssGrp[si]);
+			prepare_gating_slots_for_subset<TAlgebra, 0>(u, ssGrp[si]);
 		else UG_THROW("Subset dimension " << ssDim << " is not supported.");
 	}
 
+	if (rebuildGatingStore)
+		m_gatingStore.set_valid();
+}
+
+
+template <typename TDomain>
+template <typename TAlgebra>
+void HHSpecies<TDomain>::prep_timestep_with_algebra_type
+(
+	number future_time,
+	const number time,
+	const typename TAlgebra::vector_type& u
+)
+{
+	prepare_gating_slots<TAlgebra>(u);
+
+	// initiate gatings if this has not already been done (or init again; stationary case)
+	if (!m_bInitiated || future_time == m_initTime)
+	{
+		m_time = time;
+		m_initTime = time;
+		init_all_gating();
+	}
+
+	update_time(future_time);
+
+	// update gatings
+	update_all_gating(m_time - m_oldTime);
+
+	m_bInitiated = true;
+}
+
+
+template <typename TDomain>
+template <typename TAlgebra>
+void HHSpecies<TDomain>::init_to_steady_state_with_algebra_type
+(
+	const number time,
+	const typename TAlgebra::vector_type& u
+)
+{
+	prepare_gating_slots<TAlgebra>(u);
+
+	m_time = time;
+	m_oldTime = time;
+	m_initTime = time;
+	init_all_gating();
+
 	m_bInitiated = true;
 }
 
@@ -661,6 +910,29 @@ void HHSpecies<TDomain>::prepare_timestep(number future_time, const number time,
 }
 
 
+template <typename TDomain>
+void HHSpecies<TDomain>::init_to_steady_state(number time, VectorProxyBase* upb)
+{
+#ifdef UG_CPU_1
+	if (vector_from_algebra_type<CPUAlgebra>(upb))
+	{
+		init_to_steady_state_with_algebra_type<CPUAlgebra>(time,
+			(dynamic_cast<VectorProxy<typename CPUAlgebra::vector_type>*>(upb))->m_v);
+		return;
+	}
+#endif
+#ifdef UG_CPU_5
+	if (vector_from_algebra_type<CPUBlockAlgebra<5> >(upb))
+	{
+		init_to_steady_state_with_algebra_type<CPUBlockAlgebra<5> >(time,
+			(dynamic_cast<VectorProxy<typename CPUBlockAlgebra<5>::vector_type>*>(upb))->m_v);
+		return;
+	}
+#endif
+	UG_THROW("Given algebra type is not treated by this class.");
+}
+
+
 
 // explicit template specializations
 #ifdef UG_DIM_1
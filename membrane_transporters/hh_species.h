@@ -42,6 +42,10 @@
 
 #include "membrane_transporter_interface.h"
 #include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
+#include "../util/rate_table.h"
+#include "../util/gating_state_store.h"
+#include "../util/gating_integrator.h"
+#include "../util/checkpoint_state.h"
 
 
 namespace ug {
@@ -59,6 +63,7 @@ namespace neuro_collection {
  *
  * The gating parameters are kept internally and need to be updated before each step.
  * This means, they are discretized explicitly w.r.t. the membrane potential.
+ * The update is performed in one batched loop over contiguous arrays (see GatingStateStore).
  *
  * Units used in the implementation of this channel:
  * membrane potential     V
@@ -143,8 +148,49 @@ class HHSpecies
 		 */
 		void use_exact_gating_mode();
 
+		/**
+		 * @brief Use tabulated gating functions
+		 *
+		 * If enabled, gating limit values and time constants are no longer evaluated
+		 * exactly, but interpolated from a table on a fine voltage grid (cf. RateTable),
+		 * which is computed here such that the relative interpolation error is below
+		 * the given tolerance.
+		 * The exact evaluation (default) can be used for validation.
+		 *
+		 * @param b       whether to use tabulated gating functions
+		 * @param relTol  relative interpolation tolerance
+		 */
+		void use_rate_tables(bool b, number relTol);
+
+		/**
+		 * @brief State object for a SolutionCheckpoint
+		 *
+		 * Stores the gating states (n, m, h; kept per membrane element) in checkpoints and marks
+		 * the channel as initialized on restart, so that the gates are not reset
+		 * to their steady states. The channel must outlive the returned object.
+		 */
+		SmartPtr<ICheckpointState> checkpoint_state();
+
+		/// @name methods used by the checkpoint state object (see MemberCheckpointState)
+		/// @{
+		size_t num_checkpoint_values() const;
+		void collect_checkpoint_objects(std::vector<GridObject*>& vObj);
+		void get_checkpoint_values(GridObject* o, number* vals) const;
+		void set_checkpoint_values(GridObject* o, const number* vals);
+		void checkpoint_restored(number time);
+		/// @}
+
 
 	private:
+		template <typename TElem>
+		void collect_surface_objects
+		(
+			const MultiGrid& mg,
+			GridObjectCollection& goc,
+			size_t lvl,
+			std::vector<GridObject*>& vObj
+		) const;
+
 		template <typename TAlgebra, int locDim>
 		void update_potential
 		(
@@ -153,31 +199,38 @@ class HHSpecies
 			const typename TAlgebra::vector_type& u
 		);
 
-        /// initializes the defined channel type
-        /**
-         * During the initialization, the gating parameters are set to the equilibrium state
-         * for the start membrane potential.
-        **/
-		void init_gating(GridObject* elem);
+		/// sets the gating parameters of all elements in the gating store to their equilibria
+		/**
+		 * The potentials are gathered from the gating map, the steady states
+		 * calculated in one batched loop and scattered back.
+		 */
+		void init_all_gating();
 
-		/// updates the gating parameters
+		/// updates the gating parameters of all elements in the gating store
 		/**
 		 * This method needs to be called before calc_flux().
-		 * @param newTime new point in time
+		 * States are gathered from the gating map, updated in one batched loop
+		 * and scattered back.
+		 * @param dt  time step size (in units of the reference time)
 		 */
-		void update_gating(GridObject* elem);
+		void update_all_gating(number dt);
 
 		/// updates internal time if necessary
 		void update_time(number newTime);
 
+		/// indices of gating functions
+		enum{_NINF_ = 0, _TAUN_, _MINF_, _TAUM_, _HINF_, _TAUH_, _NGATEFCTS_};
+
+		/// evaluate gating functions (exact or tabulated)
+		void gating_fcts(number vm, number* g) const;
+
+		/// updates the potentials and (if outdated) the gating store for one subset
 		template <typename TAlgebra, int dim>
-		void prep_timestep_with_algebra_type_and_dim
-		(
-			number future_time,
-			const number time,
-			const typename TAlgebra::vector_type& u,
-			int si
-		);
+		void prepare_gating_slots_for_subset(const typename TAlgebra::vector_type& u, int si);
+
+		/// updates the potentials and (if outdated) the gating store for all subsets
+		template <typename TAlgebra>
+		void prepare_gating_slots(const typename TAlgebra::vector_type& u);
 
 		template <typename TAlgebra>
 		void prep_timestep_with_algebra_type
@@ -187,12 +240,18 @@ class HHSpecies
 			const typename TAlgebra::vector_type& u
 		);
 
+		template <typename TAlgebra>
+		void init_to_steady_state_with_algebra_type(const number time, const typename TAlgebra::vector_type& u);
+
 
 	// inheritances from IMembraneTransporter
 	public:
 		/// @copydoc IMembraneTransporter::prep_timestep()
 		virtual void prepare_timestep(number future_time, const number time, VectorProxyBase* upb) override;
 
+		/// @copydoc IMembraneTransporter::init_to_steady_state()
+		virtual void init_to_steady_state(number time, VectorProxyBase* upb) override;
+
 		/// @copydoc IMembraneTransporter::calc_flux()
 		virtual void calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const override;
 
@@ -211,6 +270,9 @@ class HHSpecies
 		/// @copydoc IMembraneTransporter::name()
 		virtual const std::string name() const override;
 
+		/// @copydoc IMembraneTransporter::report_memory()
+		virtual void report_memory(MemoryReport& rep) const override;
+
 		/// @copydoc IMembraneTransporter::check_supplied_functions()
 		virtual void check_supplied_functions() const override;
 
@@ -228,16 +290,22 @@ class HHSpecies
 
 		number m_T;
 
+		/// states are stored as gating_storage_type (cf. NCFloatGatingStorage)
 		struct GatingInfo
 		{
-			number vm;
-			number n;
-			number m;
-			number h;
+			gating_storage_type vm;
+			gating_storage_type n;
+			gating_storage_type m;
+			gating_storage_type h;
 		};
 		typedef std::map<GridObject*, GatingInfo> GatingMap;
 		GatingMap m_mGating;                        //!< current values for Vm and n, m, h
 
+		/// contiguous gating states (and gating function values) for batched updates
+		enum {_GS_VM_ = 0, _GS_N_, _GS_M_, _GS_H_, _GS_FCT_, _GS_NUM_ = _GS_FCT_ + _NGATEFCTS_};
+		GatingStateStore<GridObject> m_gatingStore;
+		std::vector<GatingInfo*> m_vGatingSlotInfo;  //!< gating map entry for each store slot
+
 		ConstSmartPtr<ISubsetHandler> m_spSH;       //!< subset handler
 		std::vector<std::string> m_vSubset;         //!< subsets this channel exists on
 
@@ -249,6 +317,9 @@ class HHSpecies
 		bool m_bInitiated;							//!< indicates whether channel has been initialized by init()
 
 		bool m_bVoltageExplicitDiscMode;
+
+		bool m_bUseRateTables;
+		RateTable m_rateTable;
 };
 
 ///@}
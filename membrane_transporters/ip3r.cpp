@@ -38,6 +38,7 @@
  */
 
 #include "ip3r.h"
+#include "../util/int_pow.h"  // for IntPow
 
 
 namespace ug{
@@ -83,7 +84,7 @@ void IP3R::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<nu
 	number current = R*T/(4*F*F) * MU_IP3R/REF_CA_ER * (caER - caCyt);
 
 	// open probability
-	number pOpen = pow(caCyt*ip3*D2 / ((caCyt*ip3 + ip3*D2 + D1*D2 + caCyt*D3) * (caCyt+D5)),3);
+	number pOpen = IntPow<3>(caCyt*ip3*D2 / ((caCyt*ip3 + ip3*D2 + D1*D2 + caCyt*D3) * (caCyt+D5)));
 
 	flux[0] = pOpen * current;
 }
@@ -105,7 +106,7 @@ void IP3R::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vec
 	number schlonz1 = caCyt*ip3 + ip3*D2 + D1*D2 + caCyt*D3;
 	number schlonz2 = schlonz1 * (caCyt+D5);
 	number schlonz3 = (caCyt*ip3*D2) / schlonz2;
-	number pOpen = pow(schlonz3,3);
+	number pOpen = IntPow<3>(schlonz3);
 
 	number dOpen_dCyt = 3.0*schlonz3*schlonz3*ip3*D2 * (1.0 - caCyt/schlonz2 * ( (ip3+D3)*(caCyt+D5) + schlonz1 )) / schlonz2;
 	number dOpen_dIP3 = 3.0*schlonz3*schlonz3*caCyt*D2 * (1.0 - ip3/schlonz2 * (caCyt+D2)*(caCyt+D5)) / schlonz2;
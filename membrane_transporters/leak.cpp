@@ -38,6 +38,7 @@
  */
 
 #include "leak.h"
+#include "../membrane_transport_fv1_typed_impl.h"  // for MembraneTransportFV1T
 
 
 namespace ug{
@@ -184,6 +185,146 @@ void Leak::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vec
 }
 
 
+void Leak::calc_flux_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<number>& flux
+) const
+{
+	const size_t nPts = vElem.size();
+	const number* cs = &u[_S_*nPts];	// source concentrations
+	const number* ct = &u[_T_*nPts];	// target concentrations
+	number* f = &flux[0];
+	const number perm = m_perm;
+#ifdef NC_WITH_DEVICE_OFFLOAD
+	const bool bOffload = offload_batch(nPts);
+#endif
+	if (m_bNoVoltage)
+	{
+#ifdef NC_WITH_DEVICE_OFFLOAD
+		#pragma omp target teams distribute parallel for if(bOffload) \
+			map(to: cs[0:nPts], ct[0:nPts]) map(from: f[0:nPts])
+#endif
+		for (size_t k = 0; k < nPts; ++k)
+			f[k] = perm * (cs[k] - ct[k]);
+		return;
+	}
+
+	const number* ps = &u[_PHIS_*nPts];	// source potentials
+	const number* pt = &u[_PHIT_*nPts];	// target potentials
+
+	const number zfrt = m_z*96485.0 / (8.31451 * m_temp);
+#ifdef NC_WITH_DEVICE_OFFLOAD
+	#pragma omp target teams distribute parallel for if(bOffload) \
+		map(to: cs[0:nPts], ct[0:nPts], ps[0:nPts], pt[0:nPts]) map(from: f[0:nPts])
+#endif
+	for (size_t k = 0; k < nPts; ++k)
+	{
+		const number v = pt[k] - ps[k];
+		if (fabs(v) < 1e-8)
+			f[k] = perm * (cs[k] - ct[k]) * (1.0 - 0.5*v*zfrt);
+		else
+		{
+			const number ex = exp(zfrt*v);
+			f[k] = - perm * zfrt * v * (cs[k] - ct[k] * ex) / (1.0 - ex);
+		}
+	}
+}
+
+
+void Leak::calc_flux_deriv_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<size_t>& vDerivFct,
+	std::vector<number>& vDeriv
+) const
+{
+	const size_t nPts = vElem.size();
+
+	// derivatives w.r.t. constant values are written to a dummy array
+	number* dummy = batch_dummy(nPts);
+	number* dcs = dummy;
+	number* dct = dummy;
+	number* dps = dummy;
+	number* dpt = dummy;
+
+	size_t i = 0;
+	if (!has_constant_value(_S_))
+	{
+		vDerivFct[i] = local_fct_index(_S_);
+		dcs = &vDeriv[i*nPts];
+		++i;
+	}
+	if (!has_constant_value(_T_))
+	{
+		vDerivFct[i] = local_fct_index(_T_);
+		dct = &vDeriv[i*nPts];
+		++i;
+	}
+
+	if (m_bNoVoltage)
+	{
+		for (size_t k = 0; k < nPts; ++k)
+		{
+			dcs[k] = m_perm;
+			dct[k] = -m_perm;
+		}
+		return;
+	}
+
+	if (!has_constant_value(_PHIS_))
+	{
+		vDerivFct[i] = local_fct_index(_PHIS_);
+		dps = &vDeriv[i*nPts];
+		++i;
+	}
+	if (!has_constant_value(_PHIT_))
+	{
+		vDerivFct[i] = local_fct_index(_PHIT_);
+		dpt = &vDeriv[i*nPts];
+	}
+
+	const number* cs = &u[_S_*nPts];	// source concentrations
+	const number* ct = &u[_T_*nPts];	// target concentrations
+	const number* ps = &u[_PHIS_*nPts];	// source potentials
+	const number* pt = &u[_PHIT_*nPts];	// target potentials
+
+	const number zfrt = m_z*96485.0 / (8.31451 * m_temp);
+	for (size_t k = 0; k < nPts; ++k)
+	{
+		const number v = pt[k] - ps[k];
+		if (fabs(v) < 1e-8)
+		{
+			const number dc = m_perm * (1.0 - 0.5*v*zfrt);
+			const number dp = 0.5 * m_perm * (cs[k] - ct[k]) * zfrt;
+			dcs[k] = dc;
+			dct[k] = -dc;
+			dps[k] = dp;
+			dpt[k] = -dp;
+		}
+		else
+		{
+			const number in = zfrt*v;
+			const number ex = exp(in);
+			dcs[k] = - m_perm * in / (1.0 - ex);
+			dct[k] = - m_perm * in / (1.0 - 1.0/ex);
+			const number dp = m_perm * zfrt * (cs[k]*(1.0 - (1.0 - in)*ex) + ct[k]*ex*(ex - 1.0 - in))
+							/ ((1.0 - ex) * (1.0 - ex));
+			dps[k] = dp;
+			dpt[k] = -dp;
+		}
+	}
+}
+
+
+bool Leak::has_device_kernels() const
+{
+	return true;
+}
+
+
 // return number of unknowns this transport mechanism depends on
 size_t Leak::n_dependencies() const
 {
@@ -259,6 +400,19 @@ void Leak::print_units() const
 }
 
 
+// explicit template specializations of the discretization with devirtualized
+// kernel calls (instantiated here so that the kernels can be inlined)
+#ifdef UG_DIM_1
+	template class MembraneTransportFV1T<Domain1d, Leak>;
+#endif
+#ifdef UG_DIM_2
+	template class MembraneTransportFV1T<Domain2d, Leak>;
+#endif
+#ifdef UG_DIM_3
+	template class MembraneTransportFV1T<Domain3d, Leak>;
+#endif
+
+
 } // namespace neuro_collection
 } // namespace ug
 
@@ -115,6 +115,21 @@ class Leak : public IMembraneTransporter
 		/// @copydoc IMembraneTransporter::calc_flux_deriv()
 		virtual void calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const;
 
+		/// @copydoc IMembraneTransporter::calc_flux_batch()
+		virtual void calc_flux_batch(const std::vector<number>& u, const std::vector<GridObject*>& vElem, std::vector<number>& flux) const;
+
+		/// @copydoc IMembraneTransporter::calc_flux_deriv_batch()
+		virtual void calc_flux_deriv_batch
+		(
+			const std::vector<number>& u,
+			const std::vector<GridObject*>& vElem,
+			std::vector<size_t>& vDerivFct,
+			std::vector<number>& vDeriv
+		) const;
+
+		/// @copydoc IMembraneTransporter::has_device_kernels()
+		virtual bool has_device_kernels() const;
+
 		/// @copydoc IMembraneTransporter::n_dependencies()
 		virtual size_t n_dependencies() const;
 
@@ -38,6 +38,7 @@
  */
 
 #include "mcu.h"
+#include "../util/int_pow.h"  // for IntPow
 
 namespace ug{
 namespace neuro_collection{
@@ -59,6 +60,8 @@ K_C(3.965e-6), K_M(0.655e-3), K_Pi(0.2e-3), g(3.9), nH(2.65)
 
 	m_mit_volume  = 0.0;
 	m_mit_surface = 0.0;
+
+	update_kernel_constants();
 }
 
 MCU::MCU(const char* fcts) : IMembraneTransporter(fcts),
@@ -77,6 +80,8 @@ K_C(3.965e-6), K_M(0.655e-3), K_Pi(0.2e-3), g(3.9), nH(2.65)
 
 	m_mit_volume  = 0.0;
 	m_mit_surface = 0.0;
+
+	update_kernel_constants();
 }
 
 
@@ -86,42 +91,46 @@ MCU::~MCU()
 }
 
 
-void MCU::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const
+void MCU::update_kernel_constants()
 {
-	if(m_mit_volume == 0.0 || m_mit_surface == 0.0)
-		UG_THROW("ERROR in MCU membrane transport: mitochondrial volume or surface not specified.");
+	const double phi = 2.0 * F * m_psi / RT;
 
-// 	get values of the unknowns in associated node
-	number caCyt = u[_CCYT_];	// cytosolic Ca2+ concentration
-	number caMit = u[_CMIT_];	// mitochondrial Ca2+ concentration
+	const double beta_e = 0.5 * (1 + nH/phi * log((phi/nH) / (sinh(phi/nH))));
+	const double beta_x = 0.5 * (1 - nH/phi * log((phi/nH) / (sinh(phi/nH))));
 
-	number mgCyt = m_mg_cyt;
-	number mgMit = m_mg_mit;
+	m_kIn = m_k * exp(2*beta_e*phi);
+	m_kOut = m_k * exp(-2*beta_x*phi);
 
-	double phi = 2.0 * F * m_psi / RT;
+	const number KCC2 = K_CC*K_CC;
+	const number KMM2 = K_MM*K_MM;
+	const number g4KK = IntPow<4>(g) * KCC2 * KMM2;
+	m_invKCC2 = 1.0 / KCC2;
+	m_invKC2 = 1.0 / (K_C*K_C);
+	m_cMgCyt = m_mg_cyt*m_mg_cyt / g4KK;
+	m_cMgMit = m_mg_mit*m_mg_mit / g4KK;
+	m_D0 = 1.0 + (m_mg_cyt*m_mg_cyt + m_mg_mit*m_mg_mit) / KMM2;
 
-	double beta_e = 0.5 * (1 + nH/phi * log((phi/nH) / (sinh(phi/nH))));
-	double beta_x = 0.5 * (1 - nH/phi * log((phi/nH) / (sinh(phi/nH))));
+	// 1um^3 mitochondrial volume = 1e-9mg mitochondrial protein, nmol = 1e-9 mol
+	m_fluxScale = m_mit_surface == 0.0 ? 0.0 : 1e-9 * m_mit_volume / m_mit_surface * 1e-9;
 
-	double k_i = m_k * exp(2*beta_e*phi);
-	double k_o = m_k * exp(-2*beta_x*phi);
+	parameters_changed();
+}
 
-	double D = 	1 + ((caCyt*caCyt)/(K_CC*K_CC)) + ((caMit*caMit)/(K_CC*K_CC)) +
-					((mgCyt*mgCyt)/(K_MM*K_MM)) + ((mgMit*mgMit)/(K_MM*K_MM)) +
-					((caCyt*caCyt*mgCyt*mgCyt)/(pow(g, 4)*K_CC*K_CC*K_MM*K_MM)) +
-					((caMit*caMit*mgMit*mgMit)/(pow(g, 4)*K_CC*K_CC*K_MM*K_MM));
 
-	flux[0] = 1/D * (k_i*((caCyt*caCyt)/(K_CC*K_CC)) - k_o*((caMit*caMit)/(K_CC*K_CC)));	// in nmol/mg/s
+void MCU::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const
+{
+	if(m_mit_volume == 0.0 || m_mit_surface == 0.0)
+		UG_THROW("ERROR in MCU membrane transport: mitochondrial volume or surface not specified.");
 
-//	Transform original flux nmol/mg/s to mitochondrial flux nmol/s
-//	1um^3 mitochondrial volume = 1e-9mg mitochondrial protein
-	flux[0] *= 1e-9 * m_mit_volume;
+// 	get values of the unknowns in associated node
+	number caCyt = u[_CCYT_];	// cytosolic Ca2+ concentration
+	number caMit = u[_CMIT_];	// mitochondrial Ca2+ concentration
 
-//  Transform mitochondrial flux nmol/s to flux nmol/um^2/s
-	flux[0] *= 1.0 / m_mit_surface;
+	KernelTerms t;
+	kernel_terms(caCyt, caMit, t);
 
-//  Transform mitochondrial flux nmol/um^2/s to mol/um^2/s
-	flux[0] *= 1e-9;
+//	flux in nmol/mg/s, transformed to mol/um^2/s
+	flux[0] = t.numer / t.D * m_fluxScale;
 }
 
 
@@ -134,29 +143,51 @@ void MCU::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vect
 	number caCyt = u[_CCYT_];	// cytosolic Ca2+ concentration
 	number caMit = u[_CMIT_];	// mitochondrial Ca2+ concentration
 
-	number mgCyt = m_mg_cyt;
-	number mgMit = m_mg_mit;
+	KernelTerms t;
+	kernel_terms(caCyt, caMit, t);
+	flux_derivs_from_terms(caCyt, caMit, t, flux_derivs);
+}
 
-	double phi = 2.0 * F * m_psi / RT;
 
-	double beta_e = 0.5 * (1 + nH/phi * log((phi/nH) / (sinh(phi/nH))));
-	double beta_x = 0.5 * (1 - nH/phi * log((phi/nH) / (sinh(phi/nH))));
+void MCU::calc_flux_and_deriv
+(
+	const std::vector<number>& u,
+	GridObject* e,
+	std::vector<number>& flux,
+	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+) const
+{
+	if(m_mit_volume == 0.0 || m_mit_surface == 0.0)
+		UG_THROW("ERROR in MCU membrane transport: mitochondrial volume or surface not specified.");
 
-	double k_o = m_k * exp(-2*beta_x*phi);
-	double k_i = m_k * exp(2*beta_e*phi);
+	number caCyt = u[_CCYT_];	// cytosolic Ca2+ concentration
+	number caMit = u[_CMIT_];	// mitochondrial Ca2+ concentration
 
-	double D = 	1 + ((caCyt*caCyt)/(K_CC*K_CC)) + ((caMit*caMit)/(K_CC*K_CC)) +
-					((mgCyt*mgCyt)/(K_MM*K_MM)) + ((mgMit*mgMit)/(K_MM*K_MM)) +
-					((caCyt*caCyt*mgCyt*mgCyt)/(pow(g, 4)*K_CC*K_CC*K_MM*K_MM)) +
-					((caMit*caMit*mgMit*mgMit)/(pow(g, 4)*K_CC*K_CC*K_MM*K_MM));
+	KernelTerms t;
+	kernel_terms(caCyt, caMit, t);
+	flux[0] = t.numer / t.D * m_fluxScale;
+	flux_derivs_from_terms(caCyt, caMit, t, flux_derivs);
+}
+
+
+void MCU::flux_derivs_from_terms
+(
+	number caCyt,
+	number caMit,
+	const KernelTerms& t,
+	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+) const
+{
+	const number invD = 1.0 / t.D;
+	const number numerInvD2 = t.numer * invD * invD;
 
-	double dD_caCyt = 2*caCyt/(K_C*K_C) + 2*caCyt*mgCyt*mgCyt/(pow(g, 4)*K_CC*K_CC*K_MM*K_MM);
-	double dFlux_caCyt = 2*k_i*caCyt/(K_CC*K_CC)/D - dD_caCyt*(k_i*caCyt*caCyt/(K_CC*K_CC) - k_o*caMit*caMit/(K_CC*K_CC))/(D*D);
-	dFlux_caCyt *= 1e-9 * m_mit_volume / m_mit_surface * 1e-9;
+	double dD_caCyt = 2*caCyt*(m_invKC2 + m_cMgCyt);
+	double dFlux_caCyt = 2*m_kIn*caCyt*m_invKCC2*invD - dD_caCyt*numerInvD2;
+	dFlux_caCyt *= m_fluxScale;
 
-	double dD_caMit = 2*caMit/(K_C*K_C) + 2*caMit*mgMit*mgMit/(pow(g, 4)*K_CC*K_CC*K_MM*K_MM);
-	double dFlux_caMit = -2*k_o*caMit/(K_CC*K_CC)/D - dD_caMit*(k_i*caCyt*caCyt/(K_CC*K_CC) - k_o*caMit*caMit/(K_CC*K_CC))/(D*D);
-	dFlux_caMit *= 1e-9 * m_mit_volume / m_mit_surface * 1e-9;
+	double dD_caMit = 2*caMit*(m_invKC2 + m_cMgMit);
+	double dFlux_caMit = -2*m_kOut*caMit*m_invKCC2*invD - dD_caMit*numerInvD2;
+	dFlux_caMit *= m_fluxScale;
 
 	size_t i = 0;
 	if (!has_constant_value(_CCYT_))
@@ -241,12 +272,14 @@ void MCU::print_units() const
 void MCU::set_mit_volume(number mit_volume)
 {
 	m_mit_volume  = mit_volume;
+	update_kernel_constants();
 }
 
 
 void MCU::set_mit_surface(number mit_surface)
 {
 	m_mit_surface = mit_surface;
+	update_kernel_constants();
 }
 
 
@@ -256,29 +289,34 @@ void MCU::set_pi_cyt(number pi_cyt)
 
 	K_CC 	= K_C * (1 + m_pi_cyt/(K_Pi+m_pi_cyt));
 	K_MM 	= K_M / (1 + m_pi_cyt/(K_Pi+m_pi_cyt));
+	update_kernel_constants();
 }
 
 
 void MCU::set_psi(number psi)
 {
 	m_psi = psi;
+	update_kernel_constants();
 }
 
 
 void MCU::set_mg_cyt(number mg_cyt)
 {
 	m_mg_cyt = mg_cyt;
+	update_kernel_constants();
 }
 
 
 void MCU::set_mg_mit(number mg_mit)
 {
 	m_mg_mit = mg_mit;
+	update_kernel_constants();
 }
 
 void MCU::set_rate_constant(number k)
 {
 	m_k = k;
+	update_kernel_constants();
 }
 
 number MCU::get_flux(number ca_cyt, number ca_mit, number pi, number mg_cyt, number mg_mit, number psi)
@@ -303,8 +341,8 @@ number MCU::get_flux(number ca_cyt, number ca_mit, number pi, number mg_cyt, num
 
 	double D = 	1 + ((caCyt*caCyt)/(KC*KC)) + ((caMit*caMit)/(KC*KC)) +
 					((mgCyt*mgCyt)/(KM*KM)) + ((mgMit*mgMit)/(KM*KM)) +
-					((caCyt*caCyt*mgCyt*mgCyt)/(pow(g, 4)*KC*KC*KM*KM)) +
-					((caMit*caMit*mgMit*mgMit)/(pow(g, 4)*KC*KC*KM*KM));
+					((caCyt*caCyt*mgCyt*mgCyt)/(IntPow<4>(g)*KC*KC*KM*KM)) +
+					((caMit*caMit*mgMit*mgMit)/(IntPow<4>(g)*KC*KC*KM*KM));
 
 	double flux = 1/D * (k_i*((caCyt*caCyt)/(KC*KC)) - k_o*((caMit*caMit)/(KC*KC)));	// in nmol/mg/s
 	return flux;
@@ -134,6 +134,44 @@ class MCU : public IMembraneTransporter
         number m_mit_volume;  // in um^3
 		number m_mit_surface; // in um^2
 
+		/// @name terms not depending on the unknowns (see update_kernel_constants())
+		/// @{
+		number m_kIn;         // k_i
+		number m_kOut;        // k_o
+		number m_invKCC2;     // 1/K_CC^2
+		number m_invKC2;      // 1/K_C^2
+		number m_cMgCyt;      // mgCyt^2 / (g^4 K_CC^2 K_MM^2)
+		number m_cMgMit;      // mgMit^2 / (g^4 K_CC^2 K_MM^2)
+		number m_D0;          // 1 + (mgCyt^2 + mgMit^2) / K_MM^2
+		number m_fluxScale;   // conversion nmol/mg/s -> mol/um^2/s
+		/// @}
+
+		/// terms shared by calc_flux() and calc_flux_deriv()
+		struct KernelTerms
+		{
+			number D;      // denominator
+			number numer;  // numerator (k_i caCyt^2 - k_o caMit^2) / K_CC^2
+		};
+
+		inline void kernel_terms(number caCyt, number caMit, KernelTerms& t) const
+		{
+			const number caCyt2 = caCyt*caCyt;
+			const number caMit2 = caMit*caMit;
+			t.D = m_D0 + caCyt2 * (m_invKCC2 + m_cMgCyt) + caMit2 * (m_invKCC2 + m_cMgMit);
+			t.numer = (m_kIn*caCyt2 - m_kOut*caMit2) * m_invKCC2;
+		}
+
+		/// flux derivatives from the shared terms
+		void flux_derivs_from_terms
+		(
+			number caCyt,
+			number caMit,
+			const KernelTerms& t,
+			std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+		) const;
+
+		/// fold all terms that only depend on parameters (called by constructors and setters)
+		void update_kernel_constants();
 
 
     public:
@@ -152,6 +190,15 @@ class MCU : public IMembraneTransporter
 		/// @copydoc IMembraneTransporter::calc_flux_deriv()
 		virtual void calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const;
 
+		/// @copydoc IMembraneTransporter::calc_flux_and_deriv()
+		virtual void calc_flux_and_deriv
+		(
+			const std::vector<number>& u,
+			GridObject* e,
+			std::vector<number>& flux,
+			std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+		) const;
+
 		/// @copydoc IMembraneTransporter::n_dependencies()
 		virtual size_t n_dependencies() const;
 
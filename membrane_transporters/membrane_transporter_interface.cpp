@@ -40,12 +40,17 @@
 
 #include "membrane_transporter_interface.h"
 
+#include <limits>  // for std::numeric_limits
+
 namespace ug {
 namespace neuro_collection {
 
 
 IMembraneTransporter::IMembraneTransporter(const std::vector<std::string>& vFct)
-: n_fct(vFct.size()), m_bLocked(false)
+: m_vfInd(vFct.size(), -1), m_vbConst(vFct.size(), false), m_vConstVal(vFct.size(), 0.0),
+  n_fct(vFct.size()), m_bLocked(false), m_elemCost(-1.0), m_paramRevision(0), m_bDeviceOffload(false),
+  m_offloadMinBatch(4096),
+  m_bFrozenGatingJacobian(false)
 {
 	// check all unknowns given
 	for (size_t i = 0; i < n_fct; i++)
@@ -53,7 +58,7 @@ IMembraneTransporter::IMembraneTransporter(const std::vector<std::string>& vFct)
 		// the corresponding unknown has been given
 		if (vFct[i] != "")
 		{
-			m_mfInd[i] = m_vFct.size();
+			m_vfInd[i] = (int) m_vFct.size();
 			m_vfIndInv.resize(m_vfIndInv.size()+1, i);
 			m_vFct.push_back(vFct[i]);
 		}
@@ -68,18 +73,25 @@ IMembraneTransporter::IMembraneTransporter(const std::vector<std::string>& vFct)
 };
 
 IMembraneTransporter::IMembraneTransporter(const char* fct)
-: n_fct(TokenizeString(fct).size()), m_bLocked(false)
+: n_fct(TokenizeString(fct).size()), m_bLocked(false), m_elemCost(-1.0), m_paramRevision(0), m_bDeviceOffload(false),
+  m_offloadMinBatch(4096),
+  m_bFrozenGatingJacobian(false)
 {
 	// convert fct string to vector
 	const std::vector<std::string> vFct = TokenizeString(fct);
 
+	m_vfInd.assign(n_fct, -1);
+	m_vbConst.assign(n_fct, false);
+	m_vConstVal.assign(n_fct, 0.0);
+
 	// check all unknowns given
 	for (size_t i = 0; i < n_fct; i++)
 	{
 		// the corresponding unknown has been given
 		if (vFct[i] != "")
 		{
-			m_mfInd[i] = m_vFct.size();
+			m_vfInd[i] = (int) m_vFct.size();
+			m_vfIndInv.resize(m_vfIndInv.size()+1, i);
 			m_vFct.push_back(vFct[i]);
 		}
 		// else: nothing
@@ -107,15 +119,19 @@ void IMembraneTransporter::prepare_timestep
 }
 
 
+void IMembraneTransporter::init_to_steady_state(number time, VectorProxyBase* upb)
+{
+	// do nothing here; only in derived classes if need be
+}
+
+
 void IMembraneTransporter::flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const
 {
-	// construct input vector for flux calculation with constant values
-	std::vector<number> u_with_consts(n_fct);
-	create_local_vector_with_constants(u, u_with_consts);
+	NC_HOT_PATH_SCOPE(m_hpFlux);
 
-	// scale each entry
-	for (size_t i = 0; i < n_fct; ++i)
-		u_with_consts[i] *= m_vScaleInputs[i];
+	// construct (scaled) input vector for flux calculation with constant values
+	std::vector<number>& u_with_consts = m_scratch.local().vUWithConsts;
+	create_local_vector_with_constants(u, u_with_consts);
 
 	// calculate fluxes
 	calc_flux(u_with_consts, e, flux);
@@ -128,13 +144,11 @@ void IMembraneTransporter::flux(const std::vector<number>& u, GridObject* e, std
 
 void IMembraneTransporter::flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const
 {
-	// construct input vector for flux derivative calculation with constant values
-	std::vector<number> u_with_consts(n_fct);
-	create_local_vector_with_constants(u, u_with_consts);
+	NC_HOT_PATH_SCOPE(m_hpFluxDeriv);
 
-	// scale each entry
-	for (size_t i = 0; i < n_fct; ++i)
-		u_with_consts[i] *= m_vScaleInputs[i];
+	// construct (scaled) input vector for flux derivative calculation with constant values
+	std::vector<number>& u_with_consts = m_scratch.local().vUWithConsts;
+	create_local_vector_with_constants(u, u_with_consts);
 
 	// calculate flux derivatives
 	calc_flux_deriv(u_with_consts, e, flux_derivs);
@@ -152,18 +166,293 @@ void IMembraneTransporter::flux_deriv(const std::vector<number>& u, GridObject*
 }
 
 
+void IMembraneTransporter::flux_and_deriv
+(
+	const std::vector<number>& u,
+	GridObject* e,
+	std::vector<number>& flux,
+	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+) const
+{
+	NC_HOT_PATH_SCOPE(m_hpFluxAndDeriv);
+
+	// construct (scaled) input vector with constant values (only once for both)
+	std::vector<number>& u_with_consts = m_scratch.local().vUWithConsts;
+	create_local_vector_with_constants(u, u_with_consts);
+
+	calc_flux_and_deriv(u_with_consts, e, flux, flux_derivs);
+
+	// scale each flux and flux deriv
+	for (size_t i = 0; i < flux.size(); ++i)
+		flux[i] *= m_vScaleFluxes[i];
+	for (size_t i = 0; i < flux_derivs.size(); ++i)
+	{
+		for (size_t j = 0; j < flux_derivs[i].size(); ++j)
+		{
+			UG_COND_THROW(flux_derivs[i][j].first >= m_vfIndInv.size(),
+				"Supplied function index " << flux_derivs[i][j].first << " does not exist.");
+			flux_derivs[i][j].second *= m_vScaleFluxes[i] * m_vScaleInputs[m_vfIndInv[flux_derivs[i][j].first]];
+		}
+	}
+}
+
+
+void IMembraneTransporter::calc_flux_and_deriv
+(
+	const std::vector<number>& u,
+	GridObject* e,
+	std::vector<number>& flux,
+	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+) const
+{
+	calc_flux(u, e, flux);
+	calc_flux_deriv(u, e, flux_derivs);
+}
+
+
+void IMembraneTransporter::flux_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<number>& flux
+) const
+{
+	NC_HOT_PATH_SCOPE(m_hpFluxBatch);
+
+	const size_t nPts = vElem.size();
+	const size_t nFlux = n_fluxes();
+	if (!nPts)
+	{
+		flux.clear();
+		return;
+	}
+
+	// construct input vector for flux calculation with constant values
+	std::vector<number>& u_with_consts = m_scratch.local().vBatchUWithConsts;
+	create_scaled_batch_with_constants(u, nPts, u_with_consts);
+
+	// calculate fluxes
+	flux.resize(nFlux * nPts);
+	calc_flux_batch(u_with_consts, vElem, flux);
+
+	// scale each flux
+	for (size_t i = 0; i < nFlux; ++i)
+	{
+		const number scale = m_vScaleFluxes[i];
+		number* f = &flux[i*nPts];
+		for (size_t k = 0; k < nPts; ++k)
+			f[k] *= scale;
+	}
+}
+
+
+void IMembraneTransporter::flux_deriv_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<size_t>& vDerivFct,
+	std::vector<number>& vDeriv
+) const
+{
+	NC_HOT_PATH_SCOPE(m_hpFluxDerivBatch);
+
+	const size_t nPts = vElem.size();
+	const size_t nFlux = n_fluxes();
+	const size_t nDep = n_dependencies();
+	if (!nPts)
+	{
+		vDerivFct.assign(nFlux * nDep, 0);
+		vDeriv.clear();
+		return;
+	}
+
+	// construct input vector for flux derivative calculation with constant values
+	std::vector<number>& u_with_consts = m_scratch.local().vBatchUWithConsts;
+	create_scaled_batch_with_constants(u, nPts, u_with_consts);
+
+	// calculate flux derivatives
+	vDerivFct.assign(nFlux * nDep, 0);
+	vDeriv.assign(nFlux * nDep * nPts, 0.0);
+	calc_flux_deriv_batch(u_with_consts, vElem, vDerivFct, vDeriv);
+
+	// scale each flux deriv
+	for (size_t i = 0; i < nFlux; ++i)
+	{
+		for (size_t j = 0; j < nDep; ++j)
+		{
+			const size_t fct = vDerivFct[i*nDep + j];
+			UG_COND_THROW(fct >= m_vfIndInv.size(), "Supplied function index " << fct << " does not exist.");
+			const number scale = m_vScaleFluxes[i] * m_vScaleInputs[m_vfIndInv[fct]];
+			number* fd = &vDeriv[(i*nDep + j)*nPts];
+			for (size_t k = 0; k < nPts; ++k)
+				fd[k] *= scale;
+		}
+	}
+}
+
+
+void IMembraneTransporter::activity_indicators
+(
+	const std::vector<number>& u,
+	GridObject* e,
+	std::vector<number>& vInd
+) const
+{
+	vInd = u;
+}
+
+
+void IMembraneTransporter::calc_flux_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<number>& flux
+) const
+{
+	const size_t nPts = vElem.size();
+	const size_t nFlux = n_fluxes();
+
+	// fall back to point-wise evaluation
+	FluxScratch& scratch = m_scratch.local();
+	std::vector<number>& uPt = scratch.vUWithConsts;
+	std::vector<number>& fluxPt = scratch.vFluxPt;
+	uPt.resize(n_fct);
+	fluxPt.resize(nFlux);
+	for (size_t k = 0; k < nPts; ++k)
+	{
+		for (size_t i = 0; i < n_fct; ++i)
+			uPt[i] = u[i*nPts + k];
+
+		calc_flux(uPt, vElem[k], fluxPt);
+
+		for (size_t i = 0; i < nFlux; ++i)
+			flux[i*nPts + k] = fluxPt[i];
+	}
+}
+
+
+void IMembraneTransporter::calc_flux_deriv_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<size_t>& vDerivFct,
+	std::vector<number>& vDeriv
+) const
+{
+	const size_t nPts = vElem.size();
+	const size_t nFlux = n_fluxes();
+	const size_t nDep = n_dependencies();
+
+	// fall back to point-wise evaluation
+	FluxScratch& scratch = m_scratch.local();
+	std::vector<number>& uPt = scratch.vUWithConsts;
+	std::vector<std::vector<std::pair<size_t, number> > >& fdPt = scratch.vFluxDerivPt;
+	uPt.resize(n_fct);
+	fdPt.resize(nFlux);
+	for (size_t k = 0; k < nPts; ++k)
+	{
+		for (size_t i = 0; i < n_fct; ++i)
+			uPt[i] = u[i*nPts + k];
+
+		for (size_t i = 0; i < nFlux; ++i)
+			fdPt[i].assign(nDep, std::pair<size_t, number>(0, 0.0));
+
+		calc_flux_deriv(uPt, vElem[k], fdPt);
+
+		for (size_t i = 0; i < nFlux; ++i)
+		{
+			for (size_t j = 0; j < nDep; ++j)
+			{
+				vDerivFct[i*nDep + j] = fdPt[i][j].first;
+				vDeriv[(i*nDep + j)*nPts + k] = fdPt[i][j].second;
+			}
+		}
+	}
+}
+
+
+number* IMembraneTransporter::batch_dummy(size_t nPts) const
+{
+	std::vector<number>& vDummy = m_scratch.local().vBatchDummy;
+	if (vDummy.size() < nPts)
+		vDummy.resize(nPts);
+	return nPts ? &vDummy[0] : NULL;
+}
+
+
+void IMembraneTransporter::create_scaled_batch_with_constants
+(
+	const std::vector<number>& u,
+	size_t nPts,
+	std::vector<number>& u_wc
+) const
+{
+	UG_COND_THROW(!m_bLocked, "Membrane transport mechanism of type \"" << name() << "\" needs to be "
+		"locked (using check_and_lock()) before fluxes can be calculated.");
+
+	u_wc.resize(n_fct * nPts);
+
+	// constant values
+	const size_t nConst = m_vInputConstInd.size();
+	for (size_t c = 0; c < nConst; ++c)
+	{
+		const size_t i = m_vInputConstInd[c];
+		const number val = m_vInputFill[i];
+		number* uwc = &u_wc[i*nPts];
+		for (size_t k = 0; k < nPts; ++k)
+			uwc[k] = val;
+	}
+
+	// gathered (and scaled) supplied values
+	const size_t nGather = m_vInputGather.size();
+	for (size_t g = 0; g < nGather; ++g)
+	{
+		const InputGather& ig = m_vInputGather[g];
+		const number* ui = &u[ig.src * nPts];
+		number* uwc = &u_wc[ig.dst * nPts];
+		for (size_t k = 0; k < nPts; ++k)
+			uwc[k] = ig.scale * ui[k];
+	}
+}
+
+
 void IMembraneTransporter::create_local_vector_with_constants(const std::vector<number>& u, std::vector<number>& u_wc) const
 {
+	UG_COND_THROW(!m_bLocked, "Membrane transport mechanism of type \"" << name() << "\" needs to be "
+		"locked (using check_and_lock()) before fluxes can be calculated.");
+
+	// fill with (scaled) constants, then gather (and scale) supplied values
+	u_wc = m_vInputFill;
+	const size_t nGather = m_vInputGather.size();
+	for (size_t g = 0; g < nGather; ++g)
+	{
+		const InputGather& ig = m_vInputGather[g];
+		u_wc[ig.dst] = ig.scale * u[ig.src];
+	}
+}
+
+
+void IMembraneTransporter::update_input_tables()
+{
+	m_vInputFill.assign(n_fct, 0.0);
+	m_vInputConstInd.clear();
+	m_vInputGather.clear();
 	for (size_t i = 0; i < n_fct; i++)
 	{
-		// check if not constant
-		if (!has_constant_value(i, u_wc[i]))
+		// constants take precedence over supplied values
+		if (m_vbConst[i])
 		{
-			UG_ASSERT(m_mfInd.find(i) != m_mfInd.end(), "Neither function supplied nor constant. "
-					  "This is not supposed to happen! Check implementation!");
-			u_wc[i] = u[m_mfInd.find(i)->second];
+			m_vInputFill[i] = m_vConstVal[i] * m_vScaleInputs[i];
+			m_vInputConstInd.push_back(i);
+		}
+		else
+		{
+			InputGather ig;
+			ig.src = (size_t) m_vfInd[i];
+			ig.dst = i;
+			ig.scale = m_vScaleInputs[i];
+			m_vInputGather.push_back(ig);
 		}
-		// else: the constant is already written to u_with_consts by has_constant_value()
 	}
 }
 
@@ -174,13 +463,12 @@ const std::vector<std::string>& IMembraneTransporter::symb_fcts() const
 
 size_t IMembraneTransporter::local_fct_index(const size_t i) const
 {
-	std::map<size_t,size_t>::const_iterator it = m_mfInd.find(i);
-	if (it == m_mfInd.end())
+	if (i >= n_fct || m_vfInd[i] < 0)
 	{
 		UG_THROW("Requested local function index of function " << i << ", which is not supplied.")
 	}
 
-	return it->second;
+	return (size_t) m_vfInd[i];
 }
 
 
@@ -192,45 +480,50 @@ void IMembraneTransporter::check_supplied_functions() const
 
 void IMembraneTransporter::set_constant(const size_t i, const number val)
 {
-	// check that not already locked
+	UG_COND_THROW(i >= n_fct, "Tried to set constant for unknown " << i << ", but the membrane "
+		"transport mechanism of type \"" << name() << "\" only has " << n_fct << " unknowns.");
+
+	// after locking, only values of constants can be changed (the dependencies are fixed)
 	if (m_bLocked)
 	{
-		UG_THROW("The membrane transport mechanism of type \"" << name() << "\" is locked "
-				 "and cannot be altered after that.\n"
-				 "Please set any constants before passing to "
-				 "an instance of TwoSidedMembraneTransport.");
+		UG_COND_THROW(!m_vbConst[i], "The membrane transport mechanism of type \"" << name() << "\" is locked.\n"
+			"Its unknown " << i << " cannot be set constant any more; please set any new constants "
+			"before passing to an instance of MembraneTransportFV1.\n"
+			"(Values of unknowns already set constant can still be changed.)");
+
+		m_vConstVal[i] = val;
+		update_input_tables();
+		parameters_changed();
+		return;
 	}
 
-	m_mConstVal[i] = val;
+	m_vbConst[i] = true;
+	m_vConstVal[i] = val;
 }
 
 bool IMembraneTransporter::has_constant_value(const size_t i, number& val) const
 {
-	std::map<size_t, number>::const_iterator mit = m_mConstVal.find(i);
-	if (mit == m_mConstVal.end())
+	if (i >= n_fct || !m_vbConst[i])
 		return false;
 
-	val = mit->second;
+	val = m_vConstVal[i];
 
 	return true;
 }
 
 bool IMembraneTransporter::has_constant_value(const size_t i) const
 {
-	if (m_mConstVal.find(i) == m_mConstVal.end())
-		return false;
-
-	return true;
+	return i < n_fct && m_vbConst[i];
 }
 
 bool IMembraneTransporter::is_supplied(const size_t i) const
 {
-	return m_mfInd.find(i) != m_mfInd.end();
+	return i < n_fct && m_vfInd[i] >= 0;
 }
 
 bool IMembraneTransporter::allows_flux(const size_t i) const
 {
-	return m_mfInd.find(i) != m_mfInd.end();
+	return is_supplied(i);
 }
 
 void IMembraneTransporter::print_units() const
@@ -252,6 +545,10 @@ void IMembraneTransporter::set_scale_inputs(const std::vector<number>& scale)
 
 	for (size_t i = 0; i < n_fct; i++)
 		m_vScaleInputs[i] = scale[i];
+
+	if (m_bLocked)
+		update_input_tables();
+	parameters_changed();
 }
 
 void IMembraneTransporter::set_scale_input(const size_t i, const number scale)
@@ -263,6 +560,10 @@ void IMembraneTransporter::set_scale_input(const size_t i, const number scale)
 				 " for transport mechanism of type \"" << name() << "\".\n");
 	}
 	m_vScaleInputs[i] = scale;
+
+	if (m_bLocked)
+		update_input_tables();
+	parameters_changed();
 }
 
 number IMembraneTransporter::scale_input(const size_t i) const
@@ -284,6 +585,7 @@ void IMembraneTransporter::set_scale_fluxes(const std::vector<number>& scale)
 
 	for (size_t i = 0; i < n_fluxes(); i++)
 		m_vScaleFluxes[i] = scale[i];
+	parameters_changed();
 }
 
 void IMembraneTransporter::set_scale_flux(const size_t i, const number scale)
@@ -296,6 +598,7 @@ void IMembraneTransporter::set_scale_flux(const size_t i, const number scale)
 				 " for transport mechanism of type \"" << name() << "\".\n");
 	}
 	m_vScaleFluxes[i] = scale;
+	parameters_changed();
 }
 
 void IMembraneTransporter::check_and_lock()
@@ -307,8 +610,7 @@ void IMembraneTransporter::check_and_lock()
 	std::vector<size_t> not_ok_ind;
 	for (size_t i = 0; i < n_fct; i++)
 	{
-		if (m_mfInd.find(i) == m_mfInd.end()
-			&& m_mConstVal.find(i) == m_mConstVal.end())
+		if (m_vfInd[i] < 0 && !m_vbConst[i])
 		{
 			not_ok_ind.push_back(i);
 		}
@@ -331,6 +633,16 @@ void IMembraneTransporter::check_and_lock()
 	// resize fluxes scaling vector (if necessary)
 	m_vScaleFluxes.resize(n_fluxes(), 1.0);
 
+	// set up input tables (constants cannot change any more from here on)
+	update_input_tables();
+
+	// label the hot path counters (name() is not available on construction)
+	NC_HOT_PATH_LABEL(m_hpFlux, "IMembraneTransporter::flux", name(), "");
+	NC_HOT_PATH_LABEL(m_hpFluxDeriv, "IMembraneTransporter::flux_deriv", name(), "");
+	NC_HOT_PATH_LABEL(m_hpFluxAndDeriv, "IMembraneTransporter::flux_and_deriv", name(), "");
+	NC_HOT_PATH_LABEL(m_hpFluxBatch, "IMembraneTransporter::flux_batch", name(), "");
+	NC_HOT_PATH_LABEL(m_hpFluxDerivBatch, "IMembraneTransporter::flux_deriv_batch", name(), "");
+
 	// lock
 	m_bLocked = true;
 }
@@ -340,5 +652,55 @@ bool IMembraneTransporter::is_locked() const
 	return m_bLocked;
 }
 
+void IMembraneTransporter::set_device_offload(bool b)
+{
+#ifndef NC_WITH_DEVICE_OFFLOAD
+	UG_COND_THROW(b, "Device offload of membrane transport mechanism of type \"" << name() << "\" "
+		"requested,\nbut neuro_collection has not been built with the NCDeviceOffload option.");
+#endif
+	UG_COND_THROW(b && !has_device_kernels(), "Device offload requested, but membrane transport "
+		"mechanism of type \"" << name() << "\" has no device kernels.");
+	m_bDeviceOffload = b;
+}
+
+
+void IMembraneTransporter::set_frozen_gating_jacobian(bool b)
+{
+	m_bFrozenGatingJacobian = b;
+	parameters_changed();
+}
+
+void IMembraneTransporter::prepare_threads()
+{
+	m_scratch.ensure_capacity();
+	NC_HOT_PATH_PREPARE_THREADS(m_hpFlux);
+	NC_HOT_PATH_PREPARE_THREADS(m_hpFluxDeriv);
+	NC_HOT_PATH_PREPARE_THREADS(m_hpFluxAndDeriv);
+	NC_HOT_PATH_PREPARE_THREADS(m_hpFluxBatch);
+	NC_HOT_PATH_PREPARE_THREADS(m_hpFluxDerivBatch);
+}
+
+void IMembraneTransporter::set_element_cost(number cost)
+{
+	m_elemCost = cost;
+}
+
+number IMembraneTransporter::element_cost() const
+{
+	if (m_elemCost >= 0.0)
+		return m_elemCost;
+	return estimated_element_cost();
+}
+
+number IMembraneTransporter::estimated_element_cost() const
+{
+	return 1.0 + (number) (n_fluxes() * (1 + n_dependencies()));
+}
+
+number IMembraneTransporter::characteristic_time_scale() const
+{
+	return std::numeric_limits<number>::max();
+}
+
 } // namespace neuro_collection
 } // namespace ug
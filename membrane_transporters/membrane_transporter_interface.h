@@ -45,6 +45,10 @@
 #include "lib_grid/grid/grid_base_objects.h"
 #include "lib_disc/common/local_algebra.h"
 #include "lib_disc/spatial_disc/elem_disc/elem_disc_interface.h"	// VectorProxyBase
+#include "../util/thread_scratch.h"	// for ThreadScratch
+#include "../util/hot_path_counters.h"	// for NC_HOT_PATH_COUNTER
+#include "../util/memory_accounting.h"	// for IMemoryReporter
+#include "nc_config.h"	// for NC_WITH_DEVICE_OFFLOAD
 
 #include <utility>      	// for std::pair
 #include <string>
@@ -88,6 +92,7 @@ namespace neuro_collection {
  * @date    07.01.2015
  */
 class IMembraneTransporter
+: public IMemoryReporter
 {
 	public:
 		/**
@@ -143,6 +148,21 @@ class IMembraneTransporter
 			number future_time, const number time, VectorProxyBase* upb
 		);
 
+		/**
+		 * @brief Initializes all internal gating states to their steady state
+		 *
+		 * Gating states that are kept by the mechanism itself (e.g., in attachments)
+		 * are set to their local equilibria for the membrane potential and concentrations
+		 * given by the solution, and the mechanism is marked as initialized, so that
+		 * the following call to prepare_timestep() does not initialize them again.
+		 * Gating states that are unknowns of the problem are not touched.
+		 * The default implementation does nothing.
+		 *
+		 * @param time   point in time of initialization
+		 * @param upb    wrapper for the current solution vector
+		 */
+		virtual void init_to_steady_state(number time, VectorProxyBase* upb);
+
 		/**
 		 * @brief Calculates the fluxes through this mechanism (same for all mechanisms)
 		 *
@@ -190,6 +210,87 @@ class IMembraneTransporter
 		 */
 		void flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const;
 
+		/**
+		 * @brief Calculates fluxes and flux derivatives in one go
+		 *
+		 * Equivalent to calling flux() and flux_deriv() with the same arguments,
+		 * but the input vector is only constructed once and passed to calc_flux_and_deriv(),
+		 * which mechanisms can override to share intermediate terms.
+		 *
+		 * @param u             vector containing values from known grid functions
+		 * @param e             element the fluxes are assembled on
+		 * @param flux          output vector containing the calculated fluxes (as in flux())
+		 * @param flux_derivs   output matrix containing the flux derivatives (as in flux_deriv())
+		 */
+		void flux_and_deriv
+		(
+			const std::vector<number>& u,
+			GridObject* e,
+			std::vector<number>& flux,
+			std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+		) const;
+
+		/**
+		 * @brief Calculates the flux without dynamic dispatch of calc_flux()
+		 *
+		 * Same as flux(), but calls calc_flux() of the given derived type directly,
+		 * so it can be inlined wherever its definition is visible
+		 * (see MembraneTransportFV1T). This object must be of type TImpl.
+		 */
+		template <typename TImpl>
+		void flux_static(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const;
+
+		/**
+		 * @brief Calculates the flux derivatives without dynamic dispatch of calc_flux_deriv()
+		 * @copydetails flux_static()
+		 */
+		template <typename TImpl>
+		void flux_deriv_static
+		(
+			const std::vector<number>& u,
+			GridObject* e,
+			std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+		) const;
+
+		/**
+		 * @brief Calculates the fluxes through this mechanism for a batch of points
+		 *
+		 * This is the batched version of flux(). Inputs and outputs are given in
+		 * structure-of-arrays layout, i.e., the values of one function (or flux)
+		 * for all points are stored contiguously.
+		 * The values are complemented by constants and scaled as in flux() before being
+		 * passed to calc_flux_batch().
+		 *
+		 * @param u      values of the supplied functions; u[i*nPts + k] is the value
+		 *               of the i-th supplied function at the k-th point
+		 * @param vElem  elements the fluxes are assembled on (one for each point)
+		 * @param flux   output vector; flux[i*nPts + k] is the i-th flux at the k-th point
+		 */
+		void flux_batch(const std::vector<number>& u, const std::vector<GridObject*>& vElem, std::vector<number>& flux) const;
+
+		/**
+		 * @brief Calculates the flux derivatives through this mechanism for a batch of points
+		 *
+		 * This is the batched version of flux_deriv(). Inputs are given as in flux_batch().
+		 * As the unknowns a flux depends on are the same for all points, they are returned
+		 * only once.
+		 *
+		 * @param u          values of the supplied functions (as in flux_batch())
+		 * @param vElem      elements the flux derivatives are assembled on (one for each point)
+		 * @param vDerivFct  output vector; vDerivFct[i*n_dependencies() + j] is the local index
+		 *                   of the function the j-th derivative of the i-th flux is taken
+		 *                   with regard to
+		 * @param vDeriv     output vector; vDeriv[(i*n_dependencies() + j)*nPts + k] is
+		 *                   the value of that derivative at the k-th point
+		 */
+		void flux_deriv_batch
+		(
+			const std::vector<number>& u,
+			const std::vector<GridObject*>& vElem,
+			std::vector<size_t>& vDerivFct,
+			std::vector<number>& vDeriv
+		) const;
+
 		/**
 		 * @brief Calculates the flux through a membrane transport system (system-specific)
 		 *
@@ -222,6 +323,76 @@ class IMembraneTransporter
 		 */
 		virtual void calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const = 0;
 
+		/**
+		 * @brief Calculates fluxes and flux derivatives (system-specific)
+		 *
+		 * The default implementation calls calc_flux() and calc_flux_deriv().
+		 * Mechanisms whose fluxes and derivatives share expensive terms
+		 * (exponentials, common denominators) should override this.
+		 *
+		 * @param u             vector with values for all involved unknowns (created by flux_and_deriv())
+		 * @param e             element the fluxes are assembled on
+		 * @param flux          output vector (as in calc_flux())
+		 * @param flux_derivs   output matrix (as in calc_flux_deriv())
+		 */
+		virtual void calc_flux_and_deriv
+		(
+			const std::vector<number>& u,
+			GridObject* e,
+			std::vector<number>& flux,
+			std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+		) const;
+
+		/**
+		 * @brief Calculates the fluxes through a membrane transport system for a batch of points
+		 *
+		 * The default implementation calls calc_flux() for each point.
+		 * Derived classes can override this with a loop over all points that the compiler
+		 * is able to vectorize. Currently, only Leak, PMCA, NCX and SERCA do so;
+		 * all other mechanisms use the point-wise fallback.
+		 *
+		 * @param u      values for all involved unknowns (created by flux_batch());
+		 *               u[i*nPts + k] is the value of the i-th unknown at the k-th point
+		 * @param vElem  elements the fluxes are assembled on (one for each point)
+		 * @param flux   output vector (already sized); flux[i*nPts + k] is the i-th flux
+		 *               at the k-th point (not yet scaled)
+		 */
+		virtual void calc_flux_batch(const std::vector<number>& u, const std::vector<GridObject*>& vElem, std::vector<number>& flux) const;
+
+		/**
+		 * @brief Calculates the flux derivatives through a membrane transport system for a batch of points
+		 *
+		 * The default implementation calls calc_flux_deriv() for each point.
+		 *
+		 * @param u          values for all involved unknowns (created by flux_deriv_batch())
+		 * @param vElem      elements the flux derivatives are assembled on (one for each point)
+		 * @param vDerivFct  output vector (already sized); see flux_deriv_batch()
+		 * @param vDeriv     output vector (already sized); see flux_deriv_batch() (not yet scaled)
+		 */
+		virtual void calc_flux_deriv_batch
+		(
+			const std::vector<number>& u,
+			const std::vector<GridObject*>& vElem,
+			std::vector<size_t>& vDerivFct,
+			std::vector<number>& vDeriv
+		) const;
+
+		/**
+		 * @brief Values indicating a possible change of the flux at a point
+		 *
+		 * This method is used by the activity masking of MembraneTransportFV1:
+		 * A point where flux and derivatives have been found negligible is skipped
+		 * as long as these values do not change significantly.
+		 * The default implementation returns the given unknowns, which suffices for all
+		 * mechanisms whose flux only depends on them. Mechanisms with internal states
+		 * (such as gating attachments) need to add those.
+		 *
+		 * @param u      vector containing values from known grid functions (as in flux())
+		 * @param e      element the flux is assembled on
+		 * @param vInd   output vector of indicator values
+		 */
+		virtual void activity_indicators(const std::vector<number>& u, GridObject* e, std::vector<number>& vInd) const;
+
 		/**
 		 * @brief Gives information about how many variables the flux depends on
 		 *
@@ -243,7 +414,7 @@ class IMembraneTransporter
 		 * @brief Information on the direction of the i-th flux
 		 *
 		 * The ordering is the same as for the constructor for parameter i.
-		 * The ordering of the return indices is that of m_mfInd.
+		 * The ordering of the return indices is that of m_vfInd.
 		 * If one of the indices is to be ignored (in the case of a unilateral flux) this can be
 		 * achieved by setting the index to the value InnerBoundaryConstants::_IGNORE_.
 		 *
@@ -263,6 +434,17 @@ class IMembraneTransporter
 		 */
 		virtual const std::string name() const = 0;
 
+		/// memory is reported under the name of the mechanism
+		virtual std::string memory_owner_name() const {return name();}
+
+		/**
+		 * @brief Report the memory held by the transport mechanism
+		 *
+		 * The default implementation reports nothing; mechanisms holding
+		 * per-element data (attachments, maps, caches) should override this.
+		 */
+		virtual void report_memory(MemoryReport& rep) const {}
+
 		/**
 		 * @brief Return supplied function names
 		 *
@@ -280,7 +462,7 @@ class IMembraneTransporter
 		 * this is the same index as in the constructor.
 		 * Otherwise the method will invoke an error if the specified index i does not belong
 		 * to a supplied function. If it does belong to one then the index according to the
-		 * local map m_mfInd is returned.
+		 * local index table m_vfInd is returned.
 		 *
 		 * This method is useful when implementing the flux_from_to() method for any transport
 		 * mechanism.
@@ -314,6 +496,10 @@ class IMembraneTransporter
 		 * as "" to the constructor. However, replacing a supplied function by a constant means
 		 * that the dependency on this function is effectively eliminated!
 		 *
+		 * Once the mechanism is locked, only the values of unknowns already set constant
+		 * can be changed (which can be done between time steps); unknowns that are
+		 * supplied functions can no longer be set constant.
+		 *
 		 * The ordering of indices corresponds to that of the constructor.
 		 *
 		 * @param i     index of the unknown to be set constant
@@ -455,9 +641,144 @@ class IMembraneTransporter
 		 */
 		bool is_locked() const;
 
+		/**
+		 * @brief Provide scratch buffers for the current number of threads
+		 *
+		 * Flux evaluation (flux(), flux_deriv() and their batched versions) is re-entrant,
+		 * i.e., it may be called concurrently from several threads, as every thread uses
+		 * its own scratch buffers. This method makes sure such buffers exist for each thread.
+		 * It is not thread-safe itself and is to be called from outside any parallel region
+		 * whenever the number of threads may have changed (e.g. on preparation of an assembling).
+		 */
+		void prepare_threads();
+
+		/**
+		 * @brief Set the relative assembling cost of a membrane element using this mechanism
+		 *
+		 * The cost is relative to a bulk element (cost 1) and used for load balancing
+		 * (see MembraneCostBalanceWeights). A negative value restores the built-in estimate.
+		 *
+		 * @param cost  relative cost per membrane element
+		 */
+		void set_element_cost(number cost);
+
+		/**
+		 * @brief Relative assembling cost of a membrane element using this mechanism
+		 *
+		 * @return  the user-defined cost if set, estimated_element_cost() otherwise
+		 */
+		number element_cost() const;
+
+		/**
+		 * @brief Revision counter of the physical parameters
+		 *
+		 * Parameters (constant values, scaling factors and the physical parameters
+		 * of the implementations, such as rates or conductances) can be changed on a
+		 * locked mechanism between time steps, e.g. for parameter sweeps, without
+		 * rebuilding the discretization. Every such change increments this counter,
+		 * so that users keeping data derived from the fluxes (such as cached flux
+		 * derivatives) can invalidate it.
+		 *
+		 * @return  number of parameter changes so far
+		 */
+		size_t parameter_revision() const {return m_paramRevision;}
+
+		/**
+		 * @brief Evaluate batched fluxes on an offload device
+		 *
+		 * If set, implementations supporting it (see has_device_kernels()) evaluate
+		 * calc_flux_batch() (and possibly calc_flux_deriv_batch()) in an OpenMP target
+		 * region, i.e. on an accelerator if one is available. Inputs and outputs are
+		 * copied to and from the device for every batch (parameters are passed by value),
+		 * so this only pays off for large batches: Batches smaller than the minimal
+		 * offload batch size (see set_device_offload_min_batch_size()) are always
+		 * evaluated on the host. Note that the element discretizations call the batched
+		 * methods element by element (i.e., with only a few points per batch), so their
+		 * assembling is not offloaded with the default minimal batch size.
+		 * Only available if the plugin is built with the NCDeviceOffload option and
+		 * only for implementations with device kernels; otherwise an error is thrown.
+		 *
+		 * @param b  whether to offload
+		 */
+		void set_device_offload(bool b);
+
+		/// whether batched fluxes are to be evaluated on an offload device
+		bool device_offload() const {return m_bDeviceOffload;}
+
+		/// set the minimal number of points for a batch to be offloaded (default: 4096)
+		void set_device_offload_min_batch_size(size_t n) {m_offloadMinBatch = n;}
+
+		/// whether this implementation has device kernels for its batched fluxes
+		virtual bool has_device_kernels() const {return false;}
+
+		/**
+		 * @brief Treat gating as constant in the flux derivatives
+		 *
+		 * If set, derivatives of the fluxes w.r.t. gating unknowns are assembled as
+		 * zero (the sparsity pattern is retained), i.e., the Jacobian is that of a
+		 * flux with frozen gates. The fluxes themselves are still evaluated with the
+		 * gates of the current iterate, so this results in an inexact Newton method
+		 * (the solution is not changed, only the convergence of the Newton iteration).
+		 * It trades accuracy of the linearization (and possibly the number of
+		 * iterations) for simpler and better reusable Jacobians.
+		 * Mechanisms without gating unknowns ignore this setting.
+		 *
+		 * @param b  whether to freeze gating in the Jacobian
+		 */
+		void set_frozen_gating_jacobian(bool b);
+
+		/// whether gating is treated as constant in the flux derivatives
+		bool frozen_gating_jacobian() const {return m_bFrozenGatingJacobian;}
+
+		/**
+		 * @brief Characteristic time scale of the internal states (in s)
+		 *
+		 * Time in which the internal states of the mechanism (e.g., gates kept
+		 * in attachments) would change by an amount of order one at their current
+		 * rate of change, minimized over all locations of this process.
+		 * This is large if the mechanism is close to equilibrium and small during
+		 * events, so it can be used to control the time step size
+		 * (see TimeStepController).
+		 * The default implementation returns the largest number, i.e.,
+		 * it does not restrict the time step.
+		 */
+		virtual number characteristic_time_scale() const;
+
+	protected:
+		/**
+		 * @brief Notify a change of physical parameters
+		 *
+		 * Implementations are to call this in any setter of a parameter that
+		 * influences fluxes or derivatives.
+		 */
+		void parameters_changed() {++m_paramRevision;}
+
+		/// whether a batch of the given size is to be evaluated on the offload device
+		bool offload_batch(size_t nPts) const {return m_bDeviceOffload && nPts >= m_offloadMinBatch;}
+
+		/**
+		 * @brief Per-thread buffer for batched derivatives that are not needed
+		 *
+		 * Batched derivative kernels can write derivatives w.r.t. functions set constant
+		 * to this buffer instead of branching in their point loop.
+		 * The buffer is valid until the next call on the same thread.
+		 *
+		 * @param nPts   number of points
+		 */
+		number* batch_dummy(size_t nPts) const;
+
+		/**
+		 * @brief Structural estimate of the relative cost of a membrane element
+		 *
+		 * The default assumes one unit for the element itself plus one unit per flux
+		 * and flux derivative. Mechanisms with expensive rate functions or internal
+		 * state updates may override this.
+		 */
+		virtual number estimated_element_cost() const;
+
 	private:
 		/**
-		 * @brief Add values set constant to supplied values
+		 * @brief Add values set constant to supplied values and scale
 		 *
 		 * This is a private helper function used in flux() and flux_deriv().
 		 *
@@ -467,19 +788,32 @@ class IMembraneTransporter
 		 */
 		void create_local_vector_with_constants(const std::vector<number>& u, std::vector<number>& u_wc) const;
 
+		/**
+		 * @brief Add values set constant to supplied values and scale (batched version)
+		 *
+		 * @param u      vector of given function values (structure-of-arrays layout)
+		 * @param nPts   number of points
+		 * @param u_wc   output vector complemented by constant values and scaled
+		 */
+		void create_scaled_batch_with_constants(const std::vector<number>& u, size_t nPts, std::vector<number>& u_wc) const;
+
+		/// set up input gather tables from supplied functions, constants and input scaling
+		void update_input_tables();
+
 	protected:
 		/// local vector of supplied function names
 		std::vector<std::string> m_vFct;
 
 	private:
-		/// indices of unknowns in local vector (of supplied functions), if existent
-		std::map<size_t, size_t> m_mfInd;
+		/// indices of unknowns in local vector (of supplied functions), -1 if not supplied
+		std::vector<int> m_vfInd;
 
 		/// indices of supplied functions in list of all participating unknowns (as in constructor)
 		std::vector<size_t> m_vfIndInv;
 
-		/// constant values map
-		std::map<size_t, number> m_mConstVal;
+		/// constant values (only valid where m_vbConst is set)
+		std::vector<bool> m_vbConst;
+		std::vector<number> m_vConstVal;
 
 		/// number of functions in total (supplied or constant)
 		const size_t n_fct;
@@ -492,8 +826,122 @@ class IMembraneTransporter
 
 		/// lock status
 		bool m_bLocked;
+
+		/// user-defined relative element cost (negative: use estimate)
+		number m_elemCost;
+
+		/// revision of the physical parameters
+		size_t m_paramRevision;
+
+		/// whether batched kernels are offloaded
+		bool m_bDeviceOffload;
+
+		/// minimal batch size for offloading
+		size_t m_offloadMinBatch;
+
+		/// whether gating is treated as constant in the flux derivatives
+		bool m_bFrozenGatingJacobian;
+
+		/// gather entry: supplied value src is scaled and written to unknown dst
+		struct InputGather
+		{
+			size_t src;
+			size_t dst;
+			number scale;
+		};
+
+		/// input tables (set on lock and on input scaling changes)
+		std::vector<number> m_vInputFill;       ///< scaled constants (0 for supplied unknowns)
+		std::vector<size_t> m_vInputConstInd;   ///< unknowns set constant
+		std::vector<InputGather> m_vInputGather;
+
+		/// scratch buffers for flux calculation (avoiding allocation in every call)
+		struct FluxScratch
+		{
+			std::vector<number> vUWithConsts;
+			std::vector<number> vBatchUWithConsts;
+			std::vector<number> vBatchDummy;
+			std::vector<number> vFluxPt;
+			std::vector<std::vector<std::pair<size_t, number> > > vFluxDerivPt;
+		};
+		ThreadScratch<FluxScratch> m_scratch;  ///< one set of buffers per thread
+
+		/// instrumentation of flux calculation (if enabled)
+		NC_HOT_PATH_COUNTER(m_hpFlux)
+		NC_HOT_PATH_COUNTER(m_hpFluxDeriv)
+		NC_HOT_PATH_COUNTER(m_hpFluxAndDeriv)
+		NC_HOT_PATH_COUNTER(m_hpFluxBatch)
+		NC_HOT_PATH_COUNTER(m_hpFluxDerivBatch)
 };
 
+
+template <typename TImpl>
+inline void IMembraneTransporter::flux_static
+(
+	const std::vector<number>& u,
+	GridObject* e,
+	std::vector<number>& flux
+) const
+{
+	NC_HOT_PATH_SCOPE(m_hpFlux);
+
+	std::vector<number>& u_with_consts = m_scratch.local().vUWithConsts;
+	create_local_vector_with_constants(u, u_with_consts);
+
+	// qualified call: no virtual dispatch
+	static_cast<const TImpl*>(this)->TImpl::calc_flux(u_with_consts, e, flux);
+
+	for (size_t i = 0; i < flux.size(); ++i)
+		flux[i] *= m_vScaleFluxes[i];
+}
+
+
+template <typename TImpl>
+inline void IMembraneTransporter::flux_deriv_static
+(
+	const std::vector<number>& u,
+	GridObject* e,
+	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+) const
+{
+	NC_HOT_PATH_SCOPE(m_hpFluxDeriv);
+
+	std::vector<number>& u_with_consts = m_scratch.local().vUWithConsts;
+	create_local_vector_with_constants(u, u_with_consts);
+
+	// qualified call: no virtual dispatch
+	static_cast<const TImpl*>(this)->TImpl::calc_flux_deriv(u_with_consts, e, flux_derivs);
+
+	for (size_t i = 0; i < flux_derivs.size(); ++i)
+		for (size_t j = 0; j < flux_derivs[i].size(); ++j)
+			flux_derivs[i][j].second *= m_vScaleFluxes[i] * m_vScaleInputs[m_vfIndInv[flux_derivs[i][j].first]];
+}
+
+
+/**
+ * @brief Initializes the gating states of a membrane transport mechanism to steady state
+ *
+ * Convenience function calling IMembraneTransporter::init_to_steady_state()
+ * with the given solution, e.g., at the beginning of a simulation or after a change of
+ * the resting potential.
+ *
+ * @param spTransporter  membrane transport mechanism
+ * @param u              solution (grid function)
+ * @param time           point in time of initialization
+ */
+template <typename TGridFunction>
+void InitToSteadyState
+(
+	SmartPtr<IMembraneTransporter> spTransporter,
+	ConstSmartPtr<TGridFunction> u,
+	number time
+)
+{
+	UG_COND_THROW(!spTransporter.valid(), "Invalid membrane transport mechanism given.");
+	VectorProxy<typename TGridFunction::vector_type> up(*u);
+	spTransporter->init_to_steady_state(time, &up);
+}
+
 ///@}
 
 } // namespace neuro_collection
@@ -65,6 +65,8 @@ K_C(2.1e-6), K_N(8.2e-3), k(1.41e-3)  // Pradhan 2008 <- reproduces data correct
 
 	m_mit_volume  = 0.0;
 	m_mit_surface = 0.0;
+
+	update_kernel_constants();
 }
 
 MNCX::MNCX(const char* fcts) : IMembraneTransporter(fcts),
@@ -76,6 +78,8 @@ K_C(2.1e-6), K_N(8.2e-3), k(1.41e-3)  // Pradhan 2008 <- reproduces data correct
 
 	m_mit_volume  = 0.0;
 	m_mit_surface = 0.0;
+
+	update_kernel_constants();
 }
 
 
@@ -85,6 +89,24 @@ MNCX::~MNCX()
 }
 
 
+void MNCX::update_kernel_constants()
+{
+	const double phi = F * m_psi / RT;
+
+	m_kIn = k * exp(0.5*phi);
+	m_kOut = k * exp(-0.5*phi);
+
+	m_invKC = 1.0 / K_C;
+	m_invKN3 = 1.0 / IntPow<3>(K_N);
+	m_invKCKN3 = m_invKC * m_invKN3;
+
+	// 1um^3 mitochondrial volume = 1e-9mg mitochondrial protein, umol = 1e-6 mol
+	m_fluxScale = m_mit_surface == 0.0 ? 0.0 : 1e-9 * m_mit_volume / m_mit_surface * 1e-6;
+
+	parameters_changed();
+}
+
+
 void MNCX::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const
 {
 	if(m_mit_volume == 0.0 || m_mit_surface == 0.0)
@@ -97,30 +119,11 @@ void MNCX::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<nu
 	number naCyt = u[_NCYT_];	// cytosolic Na+ concentration
 	number naMit = u[_NMIT_];	// mitochondrial Na2+ concentration
 
-	double phi = F * m_psi / RT;
-
-	double k_i  = k * exp(0.5*phi);
-	double k_o  = k * exp(-0.5*phi);
-
-	double in_term  = pow(naCyt, 3)/pow(K_N, 3) + caMit/K_C + caMit*pow(naCyt, 3)/(K_C*(pow(K_N, 3)));
-	double out_term = pow(naMit, 3)/pow(K_N, 3) + caCyt/K_C + caCyt*pow(naMit, 3)/(K_C*(pow(K_N, 3)));
-
-	double D = 1 + in_term + out_term;
-
-	double flux_in =  caMit*pow(naCyt, 3)/(K_C*pow(K_N, 3)) * k_i;
-	double flux_out = caCyt*pow(naMit, 3)/(K_C*pow(K_N, 3)) * k_o;
-
-	double fluxes = 1/D*(flux_in - flux_out);
-
-//	Transform original flux umol/mg/s to mitochondrial flux umol/s
-//	1um^3 mitochondrial volume = 1e-9mg mitochondrial protein
-	fluxes *= 1e-9 * m_mit_volume;
+	KernelTerms t;
+	kernel_terms(caCyt, caMit, naCyt, naMit, t);
 
-//  Transform mitochondrial flux umol/s to flux umol/um^2/s
-	fluxes *= 1.0 / m_mit_surface;
-
-//  Transform mitochondrial flux umol/um^2/s to mol/um^2/s
-	fluxes *= 1e-6;
+//	flux in umol/mg/s, transformed to mol/um^2/s
+	const number fluxes = t.netFlux / t.D * m_fluxScale;
 
 //	Ca2+ flux
 	flux[0] = fluxes;
@@ -142,39 +145,73 @@ void MNCX::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vec
 	number naCyt = u[_NCYT_];	// cytosolic Na+ concentration
 	number naMit = u[_NMIT_];	// mitochondrial Na2+ concentration
 
-	double phi = F * m_psi / RT;
+	KernelTerms t;
+	kernel_terms(caCyt, caMit, naCyt, naMit, t);
+	flux_derivs_from_terms(caCyt, caMit, naCyt, naMit, t, flux_derivs);
+}
 
-	double k_i  = k * exp(0.5*phi);
-	double k_o  = k * exp(-0.5*phi);
 
-	double in_term  = pow(naCyt, 3)/pow(K_N, 3) + caMit/K_C + caMit*pow(naCyt, 3)/(K_C*(pow(K_N, 3)));
-	double out_term = pow(naMit, 3)/pow(K_N, 3) + caCyt/K_C + caCyt*pow(naMit, 3)/(K_C*(pow(K_N, 3)));
+void MNCX::calc_flux_and_deriv
+(
+	const std::vector<number>& u,
+	GridObject* e,
+	std::vector<number>& flux,
+	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+) const
+{
+	if(m_mit_volume == 0.0 || m_mit_surface == 0.0)
+		UG_THROW("ERROR in MNCX membrane transport: mitochondrial volume or surface not specified.");
 
-	double D = 1 + in_term + out_term;
+	number caCyt = u[_CCYT_];	// cytosolic Ca2+ concentration
+	number caMit = u[_CMIT_];	// mitochondrial Ca2+ concentration
+	number naCyt = u[_NCYT_];	// cytosolic Na+ concentration
+	number naMit = u[_NMIT_];	// mitochondrial Na2+ concentration
+
+	KernelTerms t;
+	kernel_terms(caCyt, caMit, naCyt, naMit, t);
 
-	double flux_in =  caMit*pow(naCyt, 3)/(K_C*pow(K_N, 3)) * k_i;
-	double flux_out = caCyt*pow(naMit, 3)/(K_C*pow(K_N, 3)) * k_o;
+	const number fluxes = t.netFlux / t.D * m_fluxScale;
+	flux[0] = fluxes;
+	flux[1] = fluxes*3;
 
+	flux_derivs_from_terms(caCyt, caMit, naCyt, naMit, t, flux_derivs);
+}
+
+
+void MNCX::flux_derivs_from_terms
+(
+	number caCyt,
+	number caMit,
+	number naCyt,
+	number naMit,
+	const KernelTerms& t,
+	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+) const
+{
+	const number invD = 1.0 / t.D;
+	const number netInvD2 = t.netFlux * invD * invD;
 
 //  flux[0] (Ca2+ flux) derivative w.r.t caCyt
-	double dD_caCyt = 1.0/K_C + pow(naMit, 3)/(K_C*pow(K_N, 3));
-	double dFlux0_caCyt = -k_o*pow(naMit, 3)/(K_C*pow(K_N, 3))/D - ((flux_in-flux_out)*dD_caCyt)/(D*D);
-	dFlux0_caCyt *= 1e-9 * m_mit_volume / m_mit_surface * 1e-6;
+	double dD_caCyt = m_invKC + t.naMit3*m_invKCKN3;
+	double dFlux0_caCyt = -m_kOut*t.naMit3*m_invKCKN3*invD - netInvD2*dD_caCyt;
+	dFlux0_caCyt *= m_fluxScale;
 
 //  flux[0] (Ca2+ flux) derivative w.r.t caMit
-	double dD_caMit = 1.0/K_C + pow(naCyt, 3)/(K_C*pow(K_N, 3));
-	double dFlux0_caMit = k_i*pow(naCyt, 3)/(K_C*pow(K_N, 3))/D - ((flux_in-flux_out)*dD_caMit)/(D*D);
-	dFlux0_caMit *= 1e-9 * m_mit_volume / m_mit_surface * 1e-6;
+	double dD_caMit = m_invKC + t.naCyt3*m_invKCKN3;
+	double dFlux0_caMit = m_kIn*t.naCyt3*m_invKCKN3*invD - netInvD2*dD_caMit;
+	dFlux0_caMit *= m_fluxScale;
 
 //  flux[0] (Ca2+ flux) derivative w.r.t naCyt
-	double dD_naCyt = 1.0/pow(K_N, 3) + 3*pow(naCyt, 2)*caMit/(K_C*pow(K_N, 3));
-	double dFlux0_naCyt = k_i*caMit*3*pow(naCyt, 2)/(K_C*pow(K_N, 3))/D - ((flux_in-flux_out)*dD_naCyt)/(D*D);
-	dFlux0_naCyt *= 1e-9 * m_mit_volume / m_mit_surface * 1e-6;
+	const number naCyt2x3 = 3*naCyt*naCyt;
+	double dD_naCyt = m_invKN3 + naCyt2x3*caMit*m_invKCKN3;
+	double dFlux0_naCyt = m_kIn*caMit*naCyt2x3*m_invKCKN3*invD - netInvD2*dD_naCyt;
+	dFlux0_naCyt *= m_fluxScale;
 
 //  flux[0] (Ca2+ flux) derivative w.r.t naMit
-	double dD_naMit = 1.0/pow(K_N, 3) + 3*pow(naMit, 2)*caCyt/(K_C*pow(K_N, 3));
-	double dFlux0_naMit = -k_o*caCyt*3*pow(naMit, 2)/(K_C*pow(K_N, 3))/D - ((flux_in-flux_out)*dD_naMit)/(D*D);
-	dFlux0_naMit *= 1e-9 * m_mit_volume / m_mit_surface * 1e-6;
+	const number naMit2x3 = 3*naMit*naMit;
+	double dD_naMit = m_invKN3 + naMit2x3*caCyt*m_invKCKN3;
+	double dFlux0_naMit = -m_kOut*caCyt*naMit2x3*m_invKCKN3*invD - netInvD2*dD_naMit;
+	dFlux0_naMit *= m_fluxScale;
 
 //  flux[1] (Na2+ flux) derivative w.r.t caCyt
 	double dFlux1_caCyt = dFlux0_caCyt*3;
@@ -315,18 +352,21 @@ void MNCX::print_units() const
 void MNCX::set_mit_volume(number mit_volume)
 {
 	m_mit_volume  = mit_volume;
+	update_kernel_constants();
 }
 
 
 void MNCX::set_mit_surface(number mit_surface)
 {
 	m_mit_surface = mit_surface;
+	update_kernel_constants();
 }
 
 
 void MNCX::set_psi(number psi)
 {
 	m_psi = psi;
+	update_kernel_constants();
 }
 
 number MNCX::get_flux(number ca_cyt, number ca_mit, number na_cyt, number na_mit, number psi)
@@ -343,13 +383,13 @@ number MNCX::get_flux(number ca_cyt, number ca_mit, number na_cyt, number na_mit
 	double k_i  = k * exp(0.5*phi);
 	double k_o  = k * exp(-0.5*phi);
 
-	double in_term  = pow(naCyt, 3)/pow(K_N, 3) + caMit/K_C + caMit*pow(naCyt, 3)/(K_C*(pow(K_N, 3)));
-	double out_term = pow(naMit, 3)/pow(K_N, 3) + caCyt/K_C + caCyt*pow(naMit, 3)/(K_C*(pow(K_N, 3)));
+	double in_term  = IntPow<3>(naCyt)/IntPow<3>(K_N) + caMit/K_C + caMit*IntPow<3>(naCyt)/(K_C*(IntPow<3>(K_N)));
+	double out_term = IntPow<3>(naMit)/IntPow<3>(K_N) + caCyt/K_C + caCyt*IntPow<3>(naMit)/(K_C*(IntPow<3>(K_N)));
 
 	double D = 1 + in_term + out_term;
 
-	double flux_in =  caMit*pow(naCyt, 3)/(K_C*pow(K_N, 3)) * k_i;
-	double flux_out = caCyt*pow(naMit, 3)/(K_C*pow(K_N, 3)) * k_o;
+	double flux_in =  caMit*IntPow<3>(naCyt)/(K_C*IntPow<3>(K_N)) * k_i;
+	double flux_out = caCyt*IntPow<3>(naMit)/(K_C*IntPow<3>(K_N)) * k_o;
 
 	double fluxes = 1/D*(flux_in - flux_out);
 
@@ -55,6 +55,7 @@
 
 #include "membrane_transporter_interface.h"
 #include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
+#include "../util/int_pow.h"  // for IntPow
 
 
 namespace ug {
@@ -137,6 +138,48 @@ class MNCX : public IMembraneTransporter
         number m_mit_volume;  	// in um^3
 		number m_mit_surface; 	// in um^2
 
+		/// @name terms not depending on the unknowns (see update_kernel_constants())
+		/// @{
+		number m_kIn;			// k_i
+		number m_kOut;			// k_o
+		number m_invKC;			// 1/K_C
+		number m_invKN3;		// 1/K_N^3
+		number m_invKCKN3;		// 1/(K_C K_N^3)
+		number m_fluxScale;		// conversion umol/mg/s -> mol/um^2/s
+		/// @}
+
+		/// terms shared by calc_flux() and calc_flux_deriv()
+		struct KernelTerms
+		{
+			number naCyt3;		// naCyt^3
+			number naMit3;		// naMit^3
+			number D;			// denominator
+			number netFlux;		// flux_in - flux_out (before division by D)
+		};
+
+		inline void kernel_terms(number caCyt, number caMit, number naCyt, number naMit, KernelTerms& t) const
+		{
+			t.naCyt3 = IntPow<3>(naCyt);
+			t.naMit3 = IntPow<3>(naMit);
+			t.D = 1.0 + (t.naCyt3 + t.naMit3) * m_invKN3 + (caMit + caCyt) * m_invKC
+				+ (caMit*t.naCyt3 + caCyt*t.naMit3) * m_invKCKN3;
+			t.netFlux = (caMit*t.naCyt3*m_kIn - caCyt*t.naMit3*m_kOut) * m_invKCKN3;
+		}
+
+		/// flux derivatives from the shared terms
+		void flux_derivs_from_terms
+		(
+			number caCyt,
+			number caMit,
+			number naCyt,
+			number naMit,
+			const KernelTerms& t,
+			std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+		) const;
+
+		/// fold all terms that only depend on parameters (called by constructors and setters)
+		void update_kernel_constants();
+
     public:
 		/// @copydoc IMembraneTransporter::IMembraneTransporter(const std::vector<std::string)
         MNCX(const std::vector<std::string>& fcts);
@@ -153,6 +196,15 @@ class MNCX : public IMembraneTransporter
 		/// @copydoc IMembraneTransporter::calc_flux_deriv()
 		virtual void calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const;
 
+		/// @copydoc IMembraneTransporter::calc_flux_and_deriv()
+		virtual void calc_flux_and_deriv
+		(
+			const std::vector<number>& u,
+			GridObject* e,
+			std::vector<number>& flux,
+			std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
+		) const;
+
 		/// @copydoc IMembraneTransporter::n_dependencies()
 		virtual size_t n_dependencies() const;
 
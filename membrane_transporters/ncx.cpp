@@ -38,6 +38,7 @@
  */
 
 #include "ncx.h"
+#include "../membrane_transport_fv1_typed_impl.h"  // for MembraneTransportFV1T
 
 namespace ug {
 namespace neuro_collection {
@@ -82,7 +83,8 @@ void NCX::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vect
 	// get values of the unknowns in associated node
 	number caCyt = u[_CCYT_];	// cytosolic Ca2+ concentration
 
-	number dGating_dCyt = KD_N / std::pow(KD_N + caCyt, 2);
+	const number denom = KD_N + caCyt;
+	number dGating_dCyt = KD_N / (denom*denom);
 
 	if (!has_constant_value(_CCYT_))
 	{
@@ -92,6 +94,50 @@ void NCX::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vect
 }
 
 
+void NCX::calc_flux_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<number>& flux
+) const
+{
+	const size_t nPts = vElem.size();
+	const number* caCyt = &u[_CCYT_*nPts];	// cytosolic Ca2+ concentrations
+	number* f = &flux[0];
+
+	const number kd = KD_N;
+	const number imax = IMAX_N;
+	for (size_t k = 0; k < nPts; ++k)
+		f[k] = caCyt[k] / (kd + caCyt[k]) * imax;
+}
+
+
+void NCX::calc_flux_deriv_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<size_t>& vDerivFct,
+	std::vector<number>& vDeriv
+) const
+{
+	if (has_constant_value(_CCYT_))
+		return;
+
+	const size_t nPts = vElem.size();
+	const number* caCyt = &u[_CCYT_*nPts];	// cytosolic Ca2+ concentrations
+	number* fd = &vDeriv[0];
+
+	vDerivFct[0] = local_fct_index(_CCYT_);
+	const number kd = KD_N;
+	const number imax = IMAX_N;
+	for (size_t k = 0; k < nPts; ++k)
+	{
+		const number denom = kd + caCyt[k];
+		fd[k] = kd / (denom*denom) * imax;
+	}
+}
+
+
 size_t NCX::n_dependencies() const
 {
 	return 1;
@@ -152,6 +198,34 @@ void NCX::print_units() const
 }
 
 
+void NCX::set_dissociation_constant(number kd)
+{
+	UG_COND_THROW(kd <= 0.0, "NCX: Dissociation constant must be positive (is " << kd << ").");
+	KD_N = kd;
+	parameters_changed();
+}
+
+
+void NCX::set_max_flux(number imax)
+{
+	IMAX_N = imax;
+	parameters_changed();
+}
+
+
+// explicit template specializations of the discretization with devirtualized
+// kernel calls (instantiated here so that the kernels can be inlined)
+#ifdef UG_DIM_1
+	template class MembraneTransportFV1T<Domain1d, NCX>;
+#endif
+#ifdef UG_DIM_2
+	template class MembraneTransportFV1T<Domain2d, NCX>;
+#endif
+#ifdef UG_DIM_3
+	template class MembraneTransportFV1T<Domain3d, NCX>;
+#endif
+
+
 } // namespace neuro_collection
 } // namespace ug
 
@@ -74,8 +74,8 @@ class NCX : public IMembraneTransporter
 
 
     protected:
-		const number KD_N;			// mol*m^-3
-		const number IMAX_N;		// mol*s^-1
+		number KD_N;			// mol*m^-3
+		number IMAX_N;		// mol*s^-1
 
 	public:
 		/// @copydoc IMembraneTransporter::IMembraneTransporter(const std::vector<std::string)
@@ -93,6 +93,18 @@ class NCX : public IMembraneTransporter
 		/// @copydoc IMembraneTransporter::calc_flux_deriv()
 		virtual void calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const;
 
+		/// @copydoc IMembraneTransporter::calc_flux_batch()
+		virtual void calc_flux_batch(const std::vector<number>& u, const std::vector<GridObject*>& vElem, std::vector<number>& flux) const;
+
+		/// @copydoc IMembraneTransporter::calc_flux_deriv_batch()
+		virtual void calc_flux_deriv_batch
+		(
+			const std::vector<number>& u,
+			const std::vector<GridObject*>& vElem,
+			std::vector<size_t>& vDerivFct,
+			std::vector<number>& vDeriv
+		) const;
+
 		/// @copydoc IMembraneTransporter::n_dependencies()
 		virtual size_t n_dependencies() const;
 
@@ -110,6 +122,12 @@ class NCX : public IMembraneTransporter
 
 		/// @copydoc IMembraneTransporter::print_units()
 		virtual void print_units() const;
+	public:
+		/// set the calcium dissociation constant (in mM; can be changed between time steps)
+		void set_dissociation_constant(number kd);
+
+		/// set the maximal flux (in mol/s; can be changed between time steps)
+		void set_max_flux(number imax);
 };
 
 ///@}
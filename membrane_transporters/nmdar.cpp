@@ -106,12 +106,24 @@ void NMDAR::prepare_timestep(number future_time, const number time, VectorProxyB
 }
 
 
+number NMDAR::open_probability(GridObject* e) const
+{
+	return (m_time >= m_t0) ? exp(-(m_time - m_t0) / m_tau) : 0.0;
+}
+
+
 void NMDAR::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const
 {
+	const number p_open = open_probability(e);
+	if (p_open == 0.0)
+	{
+		flux[0] = 0.0;
+		return;
+	}
+
 	const number c_ext = u[_EXT_];	// source concentration
 	const number c_int = u[_CYT_];	// target concentration
 
-	const number p_open = (m_time >= m_t0) ? exp(-(m_time - m_t0) / m_tau) : 0.0;
 	const number current = (fabs(m_vm) < 1e-8) ?
 		m_perm * ((c_ext - c_int) - m_z*m_F/(2*m_R*m_T) * (c_ext + c_int) * m_vm)
 		: -m_perm * m_z*m_F/(m_R*m_T) * m_vm * (c_ext - c_int*exp(m_z*m_F/(m_R*m_T)*m_vm)) / (1.0 - exp(m_z*m_F/(m_R*m_T)*m_vm));
@@ -126,19 +138,23 @@ void NMDAR::calc_flux_deriv
 	std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs
 ) const
 {
-	number deriv_ext;
-	number deriv_cyt;
-	const number p_open = (m_time >= m_t0) ? exp(-(m_time - m_t0) / m_tau) : 0.0;
-	if (fabs(m_vm) < 1e-8)
-	{
-		deriv_ext = -p_open * m_perm * (-1.0 + m_z*m_F/(2*m_R*m_T) * m_vm);
-		deriv_cyt = -p_open * m_perm * (1.0 + m_z*m_F/(2*m_R*m_T) * m_vm);
-	}
-	else
+	number deriv_ext = 0.0;
+	number deriv_cyt = 0.0;
+	const number p_open = open_probability(e);
+	// (inactive channels have vanishing derivatives)
+	if (p_open != 0.0)
 	{
-		const number zFRTVm = m_z*m_F/(m_R*m_T) * m_vm;
-		deriv_ext = -p_open * m_perm * zFRTVm / (1.0 - exp(zFRTVm));
-		deriv_cyt = -p_open * m_perm * zFRTVm / (1.0 - exp(-zFRTVm));
+		if (fabs(m_vm) < 1e-8)
+		{
+			deriv_ext = -p_open * m_perm * (-1.0 + m_z*m_F/(2*m_R*m_T) * m_vm);
+			deriv_cyt = -p_open * m_perm * (1.0 + m_z*m_F/(2*m_R*m_T) * m_vm);
+		}
+		else
+		{
+			const number zFRTVm = m_z*m_F/(m_R*m_T) * m_vm;
+			deriv_ext = -p_open * m_perm * zFRTVm / (1.0 - exp(zFRTVm));
+			deriv_cyt = -p_open * m_perm * zFRTVm / (1.0 - exp(-zFRTVm));
+		}
 	}
 
 	size_t i = 0;
@@ -142,7 +142,11 @@ class NMDAR : public IMembraneTransporter
 		/// @copydoc IMembraneTransporter::print_units()
 		virtual void print_units() const override;
 
-	private:
+	protected:
+		/// open probability at the current time (for the membrane element e)
+		virtual number open_probability(GridObject* e) const;
+
+	protected:
 		const number m_z;
 		const number m_F;
 		const number m_R;
@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "nmdar_multi_synapse.h"
+
+#include "common/util/string_util.h"  // for RemoveWhitespaceFromString
+#include "lib_disc/common/subset_group.h"  // for SubsetGroup
+#include "lib_grid/algorithms/geom_obj_util/misc_util.h"  // for CalculateCenter
+#include "../util/kd_tree.h"  // for KDTree
+
+#ifdef UG_PARALLEL
+	#include "lib_grid/parallelization/distributed_grid.h"  // for DistributedGridManager
+	#include "pcl/pcl_base.h"  // for NumProcs, ProcRank
+	#include "pcl/pcl_process_communicator.h"  // for ProcessCommunicator
+#endif
+
+#include <algorithm>  // for std::sort
+#include <cmath>  // for exp
+#include <limits>  // for numeric_limits
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TDomain>
+NMDARMultiSynapse<TDomain>::NMDARMultiSynapse
+(
+	const std::vector<std::string>& fcts,
+	const std::vector<std::string>& subsets,
+	SmartPtr<TDomain> dom
+)
+: NMDAR(fcts),
+  m_bLocated(false), m_actBegin(0), m_bActSorted(true), m_expiry(10.0)
+{
+	construct(subsets, dom);
+}
+
+
+template <typename TDomain>
+NMDARMultiSynapse<TDomain>::NMDARMultiSynapse(const char* fcts, const char* subsets, SmartPtr<TDomain> dom)
+: NMDAR(fcts),
+  m_bLocated(false), m_actBegin(0), m_bActSorted(true), m_expiry(10.0)
+{
+	construct(TokenizeString(subsets), dom);
+}
+
+
+template <typename TDomain>
+NMDARMultiSynapse<TDomain>::~NMDARMultiSynapse()
+{}
+
+
+template <typename TDomain>
+void NMDARMultiSynapse<TDomain>::construct(const std::vector<std::string>& subsets, SmartPtr<TDomain> dom)
+{
+	UG_COND_THROW(!dom.valid(), "NMDARMultiSynapse: Invalid domain given.");
+	m_spDom = dom;
+
+	std::vector<std::string> vsSubset(subsets);
+	for (size_t i = 0; i < vsSubset.size(); ++i)
+		RemoveWhitespaceFromString(vsSubset[i]);
+	if (vsSubset.size() == 1 && vsSubset[0].empty())
+		vsSubset.clear();
+
+	SubsetGroup ssGrp;
+	try {ssGrp = SubsetGroup(dom->subset_handler(), vsSubset);}
+	UG_CATCH_THROW("NMDARMultiSynapse: Subset group creation failed.");
+	for (size_t si = 0; si < ssGrp.size(); ++si)
+		m_vSubset.push_back(ssGrp[si]);
+
+	// synapses need to be located anew after grid changes
+	MultiGrid& mg = *dom->grid();
+	m_spGridAdaptionCallbackID = mg.message_hub()->register_class_callback(this,
+		&NMDARMultiSynapse<TDomain>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = mg.message_hub()->register_class_callback(this,
+		&NMDARMultiSynapse<TDomain>::grid_distribution_callback);
+}
+
+
+template <typename TDomain>
+size_t NMDARMultiSynapse<TDomain>::add_synapse(const std::vector<number>& coords)
+{
+	UG_COND_THROW(coords.size() != (size_t) dim, "NMDARMultiSynapse: Synapse position needs "
+		<< dim << " coordinates, but " << coords.size() << " were given.");
+
+	MathVector<dim> pos;
+	for (size_t d = 0; d < (size_t) dim; ++d)
+		pos[d] = coords[d];
+
+	m_vSynPos.push_back(pos);
+	m_vSynElem.push_back(NULL);
+	m_bLocated = false;
+
+	return m_vSynPos.size() - 1;
+}
+
+
+template <typename TDomain>
+void NMDARMultiSynapse<TDomain>::add_activation(size_t synapse, number t0)
+{
+	UG_COND_THROW(synapse >= m_vSynPos.size(), "NMDARMultiSynapse: Synapse " << synapse
+		<< " does not exist (only " << m_vSynPos.size() << " synapses defined).");
+
+	Activation act;
+	act.t0 = t0;
+	act.synapse = synapse;
+	if (m_bActSorted && m_vAct.size() > m_actBegin && t0 < m_vAct.back().t0)
+		m_bActSorted = false;
+	m_vAct.push_back(act);
+}
+
+
+template <typename TDomain>
+void NMDARMultiSynapse<TDomain>::set_expiry(number nDecayTimes)
+{
+	UG_COND_THROW(nDecayTimes <= 0.0, "NMDARMultiSynapse: Expiry must be positive.");
+	m_expiry = nDecayTimes;
+}
+
+
+template <typename TDomain>
+void NMDARMultiSynapse<TDomain>::locate_synapses()
+{
+	const size_t nSyn = m_vSynPos.size();
+	m_vSynElem.assign(nSyn, NULL);
+
+	// centers of all surface membrane elements
+	MultiGrid& mg = *m_spDom->grid();
+	MGSubsetHandler& sh = *m_spDom->subset_handler();
+	typename TDomain::position_accessor_type& aaPos = m_spDom->position_accessor();
+#ifdef UG_PARALLEL
+	DistributedGridManager& dgm = *mg.distributed_grid_manager();
+#endif
+
+	std::vector<side_t*> vSide;
+	std::vector<MathVector<dim> > vCenter;
+	for (size_t s = 0; s < m_vSubset.size(); ++s)
+	{
+		typedef typename geometry_traits<side_t>::iterator it_type;
+		it_type it = sh.template begin<side_t>(m_vSubset[s]);
+		it_type it_end = sh.template end<side_t>(m_vSubset[s]);
+		for (; it != it_end; ++it)
+		{
+			side_t* side = *it;
+			if (mg.has_children(side))
+				continue;
+#ifdef UG_PARALLEL
+			if (dgm.is_ghost(side))
+				continue;
+#endif
+			vSide.push_back(side);
+			vCenter.push_back(CalculateCenter(side, aaPos));
+		}
+	}
+
+	// nearest element for each synapse
+	std::vector<size_t> vNN(nSyn, 0);
+	std::vector<number> vDistSq(nSyn, std::numeric_limits<number>::max());
+	if (!vCenter.empty() && nSyn)
+	{
+		KDTree<dim> tree(vCenter);
+		tree.nearest(m_vSynPos, vNN, vDistSq);
+	}
+
+#ifdef UG_PARALLEL
+	// only the process holding the globally nearest element keeps the synapse
+	// (on ties, the one with the lowest rank)
+	if (pcl::NumProcs() > 1 && nSyn)
+	{
+		pcl::ProcessCommunicator com;
+		std::vector<number> vMinDistSq(nSyn);
+		com.allreduce(&vDistSq[0], &vMinDistSq[0], (int) nSyn, PCL_DT_DOUBLE, PCL_RO_MIN);
+
+		const int rank = pcl::ProcRank();
+		std::vector<int> vRank(nSyn), vMinRank(nSyn);
+		for (size_t i = 0; i < nSyn; ++i)
+			vRank[i] = (!vCenter.empty() && vDistSq[i] == vMinDistSq[i]) ? rank : pcl::NumProcs();
+		com.allreduce(&vRank[0], &vMinRank[0], (int) nSyn, PCL_DT_INT, PCL_RO_MIN);
+
+		for (size_t i = 0; i < nSyn; ++i)
+			if (vMinRank[i] == rank)
+				m_vSynElem[i] = vSide[vNN[i]];
+
+		m_bLocated = true;
+		return;
+	}
+#endif
+
+	if (!vCenter.empty())
+		for (size_t i = 0; i < nSyn; ++i)
+			m_vSynElem[i] = vSide[vNN[i]];
+
+	m_bLocated = true;
+}
+
+
+template <typename TDomain>
+void NMDARMultiSynapse<TDomain>::prepare_timestep(number future_time, const number time, VectorProxyBase* upb)
+{
+	NMDAR::prepare_timestep(future_time, time, upb);
+
+	if (!m_bLocated)
+		locate_synapses();
+
+	if (!m_bActSorted)
+	{
+		std::sort(m_vAct.begin() + m_actBegin, m_vAct.end());
+		m_bActSorted = true;
+	}
+
+	// drop expired activations (keeping the array compact)
+	const number tExpired = m_time - m_expiry * m_tau;
+	const size_t nAct = m_vAct.size();
+	while (m_actBegin < nAct && m_vAct[m_actBegin].t0 < tExpired)
+		++m_actBegin;
+	if (m_actBegin && 2*m_actBegin >= nAct)
+	{
+		m_vAct.erase(m_vAct.begin(), m_vAct.begin() + m_actBegin);
+		m_actBegin = 0;
+	}
+
+	// sum up open probabilities of active synapses per element
+	m_mActive.clear();
+	for (size_t k = m_actBegin; k < m_vAct.size() && m_vAct[k].t0 <= m_time; ++k)
+	{
+		GridObject* e = m_vSynElem[m_vAct[k].synapse];
+		if (e)
+			m_mActive[e] += exp(-(m_time - m_vAct[k].t0) / m_tau);
+	}
+}
+
+
+template <typename TDomain>
+number NMDARMultiSynapse<TDomain>::open_probability(GridObject* e) const
+{
+	typename std::map<GridObject*, number>::const_iterator it = m_mActive.find(e);
+	return it == m_mActive.end() ? 0.0 : it->second;
+}
+
+
+template <typename TDomain>
+const std::string NMDARMultiSynapse<TDomain>::name() const
+{
+	return std::string("NMDARMultiSynapse");
+}
+
+
+template <typename TDomain>
+void NMDARMultiSynapse<TDomain>::report_memory(MemoryReport& rep) const
+{
+	rep.add("synapses", VectorMemory(m_vSynPos) + VectorMemory(m_vSynElem));
+	rep.add("activations", VectorMemory(m_vAct));
+	rep.add("active elements", MapMemory(m_mActive));
+}
+
+
+template <typename TDomain>
+void NMDARMultiSynapse<TDomain>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+	{
+		m_bLocated = false;
+		m_mActive.clear();
+	}
+}
+
+
+template <typename TDomain>
+void NMDARMultiSynapse<TDomain>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+	{
+		m_bLocated = false;
+		m_mActive.clear();
+	}
+}
+
+
+// explicit template specializations
+#ifdef UG_DIM_1
+	template class NMDARMultiSynapse<Domain1d>;
+#endif
+#ifdef UG_DIM_2
+	template class NMDARMultiSynapse<Domain2d>;
+#endif
+#ifdef UG_DIM_3
+	template class NMDARMultiSynapse<Domain3d>;
+#endif
+
+
+} // namespace neuro_collection
+} // namespace ug
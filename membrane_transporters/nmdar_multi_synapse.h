@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORTERS__NMDAR_MULTI_SYNAPSE_H
+#define UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORTERS__NMDAR_MULTI_SYNAPSE_H
+
+#include "nmdar.h"
+#include "common/math/ugmath.h"  // for MathVector
+#include "lib_disc/domain.h"  // for Domain1d, ...
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
+#include "lib_grid/multi_grid.h"  // for MultiGrid
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/// NMDA receptor channels of many synapses, activated by events
+/**
+ * This class works like NMDAR, but instead of one global activation time,
+ * any number of synapses can be defined by their position, and each synapse
+ * can be activated any number of times. The open probability in a membrane
+ * element is the sum of
+ *   p_o(t) = exp(-(t-t0)/tau)
+ * over all activations (at times t0 <= t) of the synapses located in this element.
+ *
+ * Each synapse is located in the membrane element (of the given subsets)
+ * whose center is closest to the synapse position; this is redetermined
+ * whenever the grid is adapted or redistributed.
+ *
+ * Only activations that are younger than a given multiple of the decay time
+ * (see set_expiry()) are considered; the set of elements with active synapses
+ * is updated once per time step, so one disc can assemble all synapses while
+ * the flux evaluation in elements without active synapses costs a single lookup.
+ *
+ * Note that flux densities are given per synapse (the channel density of the
+ * MembraneTransportFV1 should account for the element area, or be given
+ * as the number of channels per synapse divided by the element area).
+ */
+template <typename TDomain>
+class NMDARMultiSynapse : public NMDAR
+{
+	public:
+		static const int dim = TDomain::dim;	//!< world dimension
+
+		typedef typename GeomObjBaseTypeByDim<dim>::base_obj_type elem_t;
+		typedef typename elem_t::side side_t;
+
+	public:
+		/// constructor with vectors
+		NMDARMultiSynapse
+		(
+			const std::vector<std::string>& fcts,
+			const std::vector<std::string>& subsets,
+			SmartPtr<TDomain> dom
+		);
+
+		/// constructor with c-style strings
+		NMDARMultiSynapse(const char* fcts, const char* subsets, SmartPtr<TDomain> dom);
+
+		/// destructor
+		virtual ~NMDARMultiSynapse();
+
+	public:
+		/**
+		 * @brief Define a synapse
+		 * @param coords  position of the synapse (dim coordinates)
+		 * @return        index of the synapse
+		 */
+		size_t add_synapse(const std::vector<number>& coords);
+
+		/// activate a synapse at the given time
+		void add_activation(size_t synapse, number t0);
+
+		/// set after how many decay times an activation is no longer considered (default: 10)
+		void set_expiry(number nDecayTimes);
+
+		/// number of membrane elements with an active synapse in the current time step
+		size_t num_active_elements() const {return m_mActive.size();}
+
+	public:
+		/// @copydoc IMembraneTransporter::prepare_timestep()
+		virtual void prepare_timestep(number future_time, const number time, VectorProxyBase* upb) override;
+
+		/// @copydoc IMembraneTransporter::name()
+		virtual const std::string name() const override;
+
+		/// @copydoc IMembraneTransporter::report_memory()
+		virtual void report_memory(MemoryReport& rep) const override;
+
+	protected:
+		/// @copydoc NMDAR::open_probability()
+		virtual number open_probability(GridObject* e) const override;
+
+	private:
+		void construct(const std::vector<std::string>& subsets, SmartPtr<TDomain> dom);
+
+		/// locate each synapse in its membrane element
+		void locate_synapses();
+
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	private:
+		/// activation of a synapse (ordered by time)
+		struct Activation
+		{
+			number t0;
+			size_t synapse;
+			bool operator<(const Activation& other) const {return t0 < other.t0;}
+		};
+
+		SmartPtr<TDomain> m_spDom;
+		std::vector<int> m_vSubset;
+
+		/// synapse positions and elements (NULL if located on another process)
+		std::vector<MathVector<dim> > m_vSynPos;
+		std::vector<GridObject*> m_vSynElem;
+		bool m_bLocated;
+
+		/// activations (sorted by time from m_actBegin on; older ones have expired)
+		std::vector<Activation> m_vAct;
+		size_t m_actBegin;
+		bool m_bActSorted;
+		number m_expiry;
+
+		/// summed open probabilities of elements with active synapses
+		std::map<GridObject*, number> m_mActive;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+};
+
+///@}
+
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORTERS__NMDAR_MULTI_SYNAPSE_H
@@ -39,6 +39,7 @@
 
 
 #include "pmca.h"
+#include "../membrane_transport_fv1_typed_impl.h"  // for MembraneTransportFV1T
 
 namespace ug {
 namespace neuro_collection {
@@ -83,7 +84,8 @@ void PMCA::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vec
 	// get values of the unknowns in associated node
 	number caCyt = u[_CCYT_];	// cytosolic Ca2+ concentration
 
-	number dGating_dCyt = 2*KD_P*KD_P*caCyt / std::pow(KD_P*KD_P + caCyt*caCyt, 2);
+	const number denom = KD_P*KD_P + caCyt*caCyt;
+	number dGating_dCyt = 2*KD_P*KD_P*caCyt / (denom*denom);
 
 	if (!has_constant_value(_CCYT_))
 	{
@@ -93,6 +95,69 @@ void PMCA::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vec
 }
 
 
+void PMCA::calc_flux_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<number>& flux
+) const
+{
+	const size_t nPts = vElem.size();
+	const number* caCyt = &u[_CCYT_*nPts];	// cytosolic Ca2+ concentrations
+	number* f = &flux[0];
+
+	const number kd2 = KD_P*KD_P;
+	const number imax = IMAX_P;
+#ifdef NC_WITH_DEVICE_OFFLOAD
+	const bool bOffload = offload_batch(nPts);
+	#pragma omp target teams distribute parallel for if(bOffload) \
+		map(to: caCyt[0:nPts]) map(from: f[0:nPts])
+#endif
+	for (size_t k = 0; k < nPts; ++k)
+	{
+		const number ca2 = caCyt[k]*caCyt[k];
+		f[k] = ca2 / (kd2 + ca2) * imax;
+	}
+}
+
+
+void PMCA::calc_flux_deriv_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<size_t>& vDerivFct,
+	std::vector<number>& vDeriv
+) const
+{
+	if (has_constant_value(_CCYT_))
+		return;
+
+	const size_t nPts = vElem.size();
+	const number* caCyt = &u[_CCYT_*nPts];	// cytosolic Ca2+ concentrations
+	number* fd = &vDeriv[0];
+
+	vDerivFct[0] = local_fct_index(_CCYT_);
+	const number kd2 = KD_P*KD_P;
+	const number imax = IMAX_P;
+#ifdef NC_WITH_DEVICE_OFFLOAD
+	const bool bOffload = offload_batch(nPts);
+	#pragma omp target teams distribute parallel for if(bOffload) \
+		map(to: caCyt[0:nPts]) map(from: fd[0:nPts])
+#endif
+	for (size_t k = 0; k < nPts; ++k)
+	{
+		const number denom = kd2 + caCyt[k]*caCyt[k];
+		fd[k] = 2.0*kd2*caCyt[k] / (denom*denom) * imax;
+	}
+}
+
+
+bool PMCA::has_device_kernels() const
+{
+	return true;
+}
+
+
 size_t PMCA::n_dependencies() const
 {
 	return 1;
@@ -153,6 +218,34 @@ void PMCA::print_units() const
 }
 
 
+void PMCA::set_dissociation_constant(number kd)
+{
+	UG_COND_THROW(kd <= 0.0, "PMCA: Dissociation constant must be positive (is " << kd << ").");
+	KD_P = kd;
+	parameters_changed();
+}
+
+
+void PMCA::set_max_flux(number imax)
+{
+	IMAX_P = imax;
+	parameters_changed();
+}
+
+
+// explicit template specializations of the discretization with devirtualized
+// kernel calls (instantiated here so that the kernels can be inlined)
+#ifdef UG_DIM_1
+	template class MembraneTransportFV1T<Domain1d, PMCA>;
+#endif
+#ifdef UG_DIM_2
+	template class MembraneTransportFV1T<Domain2d, PMCA>;
+#endif
+#ifdef UG_DIM_3
+	template class MembraneTransportFV1T<Domain3d, PMCA>;
+#endif
+
+
 } // namespace neuro_collection
 } // namespace ug
 
@@ -182,5 +182,12 @@ void RyR::print_units() const
 }
 
 
+void RyR::set_conductance(number mu)
+{
+	MU_RYR = mu;
+	parameters_changed();
+}
+
+
 } // namespace neuro_collection
 } // namespace ug
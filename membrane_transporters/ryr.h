@@ -78,7 +78,7 @@ class RyR : public IMembraneTransporter
 		const number KA;		// calcium binding (C1 <--> O1)
 		const number KB;		// calcium binding (O1 <--> O2)
 		const number KC;		// O1 <--> C2
-		const number MU_RYR;	// RyR channel conductance
+		number MU_RYR;	// RyR channel conductance
 
 		const number REF_CA_ER;	// reference endoplasmatic Ca2+ concentration (for conductances)
 
@@ -115,6 +115,10 @@ class RyR : public IMembraneTransporter
 
 		/// @copydoc IMembraneTransporter::print_units()
 		virtual void print_units() const;
+
+	public:
+		/// set the channel conductance (in m^3/s; can be changed between time steps)
+		void set_conductance(number mu);
 };
 
 ///@}
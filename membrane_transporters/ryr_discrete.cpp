@@ -39,6 +39,12 @@
 
 #include "ryr_discrete.h"
 
+#include <algorithm>  // for std::push_heap, std::pop_heap, std::sort
+#include <cmath>  // for log, sqrt, exp
+#include <functional>  // for std::greater
+#include <limits>  // for std::numeric_limits
+#include <utility>  // for std::pair, std::make_pair
+
 #include "common/error.h"  // for UG_THROW
 #include "common/util/string_util.h"  // for TokenizeTrimString
 #include "lib_disc/common/function_group.h"  // for FunctionGroup
@@ -46,6 +52,9 @@
 #include "lib_disc/spatial_disc/ass_tuner.h"  // for CT_CONSTRAINTS
 #include "lib_grid/algorithms/debug_util.h"  // for ElementDebugInfo
 #include "lib_grid/tools/subset_group.h"  // for SubsetGroup
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_base.h"  // for ProcRank
+#endif
 
 
 
@@ -62,8 +71,24 @@ RyRDiscrete<TDomain, TAlgebra>::RyRDiscrete(const char* functions, const char* s
   MU_RYR(5.0e-11), REF_CA_ER(2.5e-1),
   m_vSubsetNames(TokenizeTrimString(subsets)),
   m_vFunctionNames(TokenizeTrimString(functions)),
-  m_cutoffOpenProb(0.002)
-{}
+  m_cutoffOpenProb(0.002),
+  m_pIndexCacheDD(NULL),
+  m_bIndexCacheValid(false),
+  m_bStochastic(false),
+  m_nChPerCluster(1),
+  m_tauLeapThreshold(50),
+  m_caRescaleTol(1e-3),
+  m_rngState(0),
+  m_stochTime(0.0),
+  m_bClustersInit(false),
+  m_snapshotRngState(0),
+  m_snapshotTime(0.0),
+  m_bSnapshotValid(false),
+  m_mfRadius(0.0),
+  m_ndFactor(0.0)
+{
+	set_random_seed(0);
+}
 
 
 template <typename TDomain, typename TAlgebra>
@@ -75,8 +100,24 @@ RyRDiscrete(const std::vector<std::string>& functions, const std::vector<std::st
   MU_RYR(5.0e-11), REF_CA_ER(2.5e-1),
   m_vSubsetNames(subsets),
   m_vFunctionNames(functions),
-  m_cutoffOpenProb(0.002)
-{}
+  m_cutoffOpenProb(0.002),
+  m_pIndexCacheDD(NULL),
+  m_bIndexCacheValid(false),
+  m_bStochastic(false),
+  m_nChPerCluster(1),
+  m_tauLeapThreshold(50),
+  m_caRescaleTol(1e-3),
+  m_rngState(0),
+  m_stochTime(0.0),
+  m_bClustersInit(false),
+  m_snapshotRngState(0),
+  m_snapshotTime(0.0),
+  m_bSnapshotValid(false),
+  m_mfRadius(0.0),
+  m_ndFactor(0.0)
+{
+	set_random_seed(0);
+}
 
 
 template <typename TDomain, typename TAlgebra>
@@ -98,11 +139,9 @@ void RyRDiscrete<TDomain, TAlgebra>::adjust_defect
 	const std::vector<number>* vScaleStiff
 )
 {
-	std::vector<DoFIndex> vDI(5);
-
-#ifdef UG_PARALLEL
-	const DistributedGridManager& dgm = *dd->multi_grid()->distributed_grid_manager();
-#endif
+	// make sure the index cache is up to date for this DoF distribution
+	if (!m_bIndexCacheValid || dd.get() != m_pIndexCacheDD)
+		update_index_cache(dd);
 
 	// get number of stages of time stepping scheme (or 1 in stationary case)
 	size_t nTimes = 1;
@@ -116,115 +155,99 @@ void RyRDiscrete<TDomain, TAlgebra>::adjust_defect
 			nTimes = std::min(vScaleMass->size(), vScaleStiff->size());
 	}
 
-	// loop subsets
-	typedef typename DoFDistribution::traits<Vertex>::const_iterator vrt_it_type;
-	const size_t nSI = m_vSI.size();
-	const size_t nFct = m_vFctMap.size();
+	if (m_bStochastic)
+	{
+		adjust_defect_stochastic(d, u, time, vSol, vScaleStiff, nTimes);
+		return;
+	}
 
-	for (size_t i = 0; i < nSI; ++i)
+	if (m_mfRadius > 0.0)
 	{
-		int si = m_vSI[i];
+		adjust_defect_mean_field(d, u, vSol, vScaleMass, vScaleStiff, nTimes);
+		return;
+	}
 
-		// loop all vertices in the subset
-		vrt_it_type it = dd->begin<Vertex>(si);
-		vrt_it_type itEnd = dd->end<Vertex>(si);
-		for (; it != itEnd; ++it)
-		{
-			Vertex* vrt = *it;
+	// loop all channel vertices
+	const size_t nVrt = m_vCachedDI.size() / 5;
+	for (size_t v = 0; v < nVrt; ++v)
+	{
+		const DoFIndex* vDI = &m_vCachedDI[5*v];
 
-#ifdef UG_PARALLEL
-			// do not process horizontal slaves in the parallel case to prevent double counting
-			if (dgm.get_status(vrt) & ES_H_SLAVE)
+		// add stiffness defect for cytosolic calcium / ER calcium, gating params
+		for (size_t k = 0; k < nTimes; ++k)
+		{
+			if (vScaleStiff && !(*vScaleStiff)[k])
 				continue;
-#endif
 
-			// get all DoF indices that concern us here
-			vDI.clear();
-			for (size_t j = 0; j < nFct; ++j)
-			{
-				size_t fct = m_vFctMap[j];
+			number caCyt;
+			number caER;
+			number o2;
+			number c1;
+			number c2;
 
-				// we do not need hanging vertices as all transport mechanism
-				// vertices must be in the coarse grid
-				dd->dof_indices(vrt, fct, vDI, false, false);
+			if (vSol.valid())
+			{
+				caCyt = 1e3 * DoFRef(*vSol->solution(k), vDI[_CCYT_]);   // scale from M to mM
+				caER = 1e3 * DoFRef(*vSol->solution(k), vDI[_CER_]);   // scale from M to mM
+				o2 = DoFRef(*vSol->solution(k), vDI[_O2_]);
+				c1 = DoFRef(*vSol->solution(k), vDI[_C1_]);
+				c2 = DoFRef(*vSol->solution(k), vDI[_C2_]);
 			}
-			UG_COND_THROW(vDI.size() != 5, "Not exactly 5 DoF indices for vertex.");
-
-
-			// add stiffness defect for cytosolic calcium / ER calcium, gating params
-			for (size_t k = 0; k < nTimes; ++k)
+			else
 			{
-				if (vScaleStiff && !(*vScaleStiff)[k])
-					continue;
+				caCyt = 1e3 * DoFRef(u, vDI[_CCYT_]);   // scale from M to mM
+				caER = 1e3 * DoFRef(u, vDI[_CER_]);   // scale from M to mM
+				o2 = DoFRef(u, vDI[_O2_]);
+				c1 = DoFRef(u, vDI[_C1_]);
+				c2 = DoFRef(u, vDI[_C2_]);
+			}
+			const number o1 = 1.0 - (o2 + c1 + c2);
 
-				number caCyt;
-				number caER;
-				number o2;
-				number c1;
-				number c2;
+			number pOpen = 1.0 - (c1 + c2);
 
-				if (vSol.valid())
+			// really close channels below cutoff (0.002 corresponds to equil. cy_cyt of ~8e-5mM)
+			// using a cubic spline between x0=cutoff and x1=2*cutoff
+			// satisfying f'(x0) = 0; f(x0) = 0, f'(x1) = 1, f(x1) = x1
+			if (pOpen < 2*m_cutoffOpenProb)
+			{
+				if (pOpen > m_cutoffOpenProb)
 				{
-					caCyt = 1e3 * DoFRef(*vSol->solution(k), vDI[_CCYT_]);   // scale from M to mM
-					caER = 1e3 * DoFRef(*vSol->solution(k), vDI[_CER_]);   // scale from M to mM
-					o2 = DoFRef(*vSol->solution(k), vDI[_O2_]);
-					c1 = DoFRef(*vSol->solution(k), vDI[_C1_]);
-					c2 = DoFRef(*vSol->solution(k), vDI[_C2_]);
+					const number x0 = m_cutoffOpenProb;
+					const number x1 = 2*m_cutoffOpenProb;
+					const number sa = - (x1-x0) / ((x1+x0)*(x1+x0)*(x1+x0));
+					const number sb = 2.0*(x1*x1 + x1*x0 + x0*x0) / ((x1+x0)*(x1+x0)*(x1+x0));
+					const number sc = -3.0*x0*x0*sa - 2*x0*sb;
+					const number sd = -x0*x0*x0*sa - x0*x0*sb - x0*sc;
+					pOpen = sa*pOpen*pOpen*pOpen + sb*pOpen*pOpen + sc*pOpen + sd;
 				}
 				else
-				{
-					caCyt = 1e3 * DoFRef(u, vDI[_CCYT_]);   // scale from M to mM
-					caER = 1e3 * DoFRef(u, vDI[_CER_]);   // scale from M to mM
-					o2 = DoFRef(u, vDI[_O2_]);
-					c1 = DoFRef(u, vDI[_C1_]);
-					c2 = DoFRef(u, vDI[_C2_]);
-				}
-				const number o1 = 1.0 - (o2 + c1 + c2);
-
-				number pOpen = 1.0 - (c1 + c2);
-
-				// really close channels below cutoff (0.002 corresponds to equil. cy_cyt of ~8e-5mM)
-				// using a cubic spline between x0=cutoff and x1=2*cutoff
-				// satisfying f'(x0) = 0; f(x0) = 0, f'(x1) = 1, f(x1) = x1
-				if (pOpen < 2*m_cutoffOpenProb)
-				{
-					if (pOpen > m_cutoffOpenProb)
-					{
-						const number x0 = m_cutoffOpenProb;
-						const number x1 = 2*m_cutoffOpenProb;
-						const number sa = - (x1-x0) / ((x1+x0)*(x1+x0)*(x1+x0));
-						const number sb = 2.0*(x1*x1 + x1*x0 + x0*x0) / ((x1+x0)*(x1+x0)*(x1+x0));
-						const number sc = -3.0*x0*x0*sa - 2*x0*sb;
-						const number sd = -x0*x0*x0*sa - x0*x0*sb - x0*sc;
-						pOpen = sa*pOpen*pOpen*pOpen + sb*pOpen*pOpen + sc*pOpen + sd;
-					}
-					else
-						pOpen = 0.0;
-				}
+					pOpen = 0.0;
+			}
 
-				number current = pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt);
+			number current = pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt);
 
-				number dt = 1.0;
-				if (vScaleStiff)
-					dt = (*vScaleStiff)[k];
+			number dt = 1.0;
+			if (vScaleStiff)
+				dt = (*vScaleStiff)[k];
 
-				DoFRef(d, vDI[_CCYT_]) -= current * dt * 1e15;  // scale from mol to mol (um/dm)^3
-				DoFRef(d, vDI[_CER_]) += current * dt * 1e15;  // scale from mol to mol (um/dm)^3
+			DoFRef(d, vDI[_CCYT_]) -= current * dt * 1e15;  // scale from mol to mol (um/dm)^3
+			DoFRef(d, vDI[_CER_]) += current * dt * 1e15;  // scale from mol to mol (um/dm)^3
 
-				DoFRef(d, vDI[_O2_]) -= dt * (KBplus * caCyt*caCyt*caCyt * o1 - KBminus * o2);
-				DoFRef(d, vDI[_C1_]) -= dt * (KAminus * o1 - KAplus * caCyt*caCyt*caCyt*caCyt * c1);
-				DoFRef(d, vDI[_C2_]) -= dt * (KCplus * o1 - KCminus * c2);
-			}
+			// gating sees the calcium concentration at the channel mouth
+			const number caG = channel_mouth_calcium(caCyt, caER, pOpen);
+			DoFRef(d, vDI[_O2_]) -= dt * (KBplus * caG*caG*caG * o1 - KBminus * o2);
+			DoFRef(d, vDI[_C1_]) -= dt * (KAminus * o1 - KAplus * caG*caG*caG*caG * c1);
+			DoFRef(d, vDI[_C2_]) -= dt * (KCplus * o1 - KCminus * c2);
+		}
 
-			// add mass defects for gating parameters
-			if (vSol.valid() && vScaleMass)
+		// add mass defects for gating parameters
+		if (vSol.valid() && vScaleMass)
+		{
+			for (size_t k = 0; k < nTimes; ++k)
 			{
-				for (size_t k = 0; k < nTimes; ++k)
-				{
-					DoFRef(d, vDI[_O2_]) += (*vScaleMass)[k] * DoFRef(*vSol->solution(k), vDI[_O2_]);
-					DoFRef(d, vDI[_C1_]) += (*vScaleMass)[k] * DoFRef(*vSol->solution(k), vDI[_C1_]);
-					DoFRef(d, vDI[_C2_]) += (*vScaleMass)[k] * DoFRef(*vSol->solution(k), vDI[_C2_]);
-				}
+				DoFRef(d, vDI[_O2_]) += (*vScaleMass)[k] * DoFRef(*vSol->solution(k), vDI[_O2_]);
+				DoFRef(d, vDI[_C1_]) += (*vScaleMass)[k] * DoFRef(*vSol->solution(k), vDI[_C1_]);
+				DoFRef(d, vDI[_C2_]) += (*vScaleMass)[k] * DoFRef(*vSol->solution(k), vDI[_C2_]);
 			}
 		}
 	}
@@ -243,114 +266,114 @@ void RyRDiscrete<TDomain, TAlgebra>::adjust_jacobian
 	const number s_a0
 )
 {
-	std::vector<DoFIndex> vDI(5);
+	// make sure the index cache is up to date for this DoF distribution
+	if (!m_bIndexCacheValid || dd.get() != m_pIndexCacheDD)
+		update_index_cache(dd);
 
-#ifdef UG_PARALLEL
-	const DistributedGridManager& dgm = *dd->multi_grid()->distributed_grid_manager();
-#endif
+	if (m_bStochastic)
+	{
+		adjust_jacobian_stochastic(J, u, s_a0);
+		return;
+	}
 
-	// loop subsets
-	typedef typename DoFDistribution::traits<Vertex>::const_iterator vrt_it_type;
-	const size_t nSI = m_vSI.size();
-	const size_t nFct = m_vFctMap.size();
+	if (m_mfRadius > 0.0)
+	{
+		adjust_jacobian_mean_field(J, u, s_a0);
+		return;
+	}
 
-	for (size_t i = 0; i < nSI; ++i)
+	// loop all channel vertices
+	const size_t nVrt = m_vCachedDI.size() / 5;
+	for (size_t v = 0; v < nVrt; ++v)
 	{
-		int si = m_vSI[i];
+		const DoFIndex* vDI = &m_vCachedDI[5*v];
 
-		// loop all vertices in the subset
-		vrt_it_type it = dd->begin<Vertex>(si);
-		vrt_it_type itEnd = dd->end<Vertex>(si);
-		for (; it != itEnd; ++it)
+		// add stiffness entries for cytosolic calcium / ER calcium, gating params
+		if (s_a0)
 		{
-			Vertex* vrt = *it;
-
-#ifdef UG_PARALLEL
-			// do not process horizontal slaves in the parallel case to prevent double counting
-			if (dgm.get_status(vrt) & ES_H_SLAVE)
-				continue;
-#endif
-
-			// get all DoF indices that concern us here
-			vDI.clear();
-			for (size_t j = 0; j < nFct; ++j)
+			const number caCyt = 1e3 * DoFRef(u, vDI[_CCYT_]);   // scale from M to mM
+			const number caER = 1e3 * DoFRef(u, vDI[_CER_]);   // scale from M to mM
+			const number o2 = DoFRef(u, vDI[_O2_]);
+			const number c1 = DoFRef(u, vDI[_C1_]);
+			const number c2 = DoFRef(u, vDI[_C2_]);
+			const number o1 = 1.0 - (o2 + c1 + c2);
+
+			number pOpen = 1.0 - (c1 + c2);
+			number dPOdC12 = -1.0;
+
+			// really close channels below cutoff (0.002 corresponds to equil. cy_cyt of ~8e-5mM)
+			// using a cubic spline between x0=cutoff and x1=2*cutoff
+			// satisfying f'(x0) = 0; f(x0) = 0, f'(x1) = 1, f(x1) = x1
+			if (pOpen < 2*m_cutoffOpenProb)
 			{
-				size_t fct = m_vFctMap[j];
-
-				// we do not need hanging vertices as all transport mechanism
-				// vertices must be in the coarse grid
-				dd->dof_indices(vrt, fct, vDI, false, false);
+				if (pOpen > m_cutoffOpenProb)
+				{
+					const number x0 = m_cutoffOpenProb;
+					const number x1 = 2*m_cutoffOpenProb;
+					const number sa = - (x1-x0) / ((x1+x0)*(x1+x0)*(x1+x0));
+					const number sb = 2.0*(x1*x1 + x1*x0 + x0*x0) / ((x1+x0)*(x1+x0)*(x1+x0));
+					const number sc = -3.0*x0*x0*sa - 2*x0*sb;
+					const number sd = -x0*x0*x0*sa - x0*x0*sb - x0*sc;
+
+					dPOdC12 = -(3.0*sa*pOpen*pOpen + 2*sb*pOpen + sc);
+					pOpen = sa*pOpen*pOpen*pOpen + sb*pOpen*pOpen + sc*pOpen + sd;
+				}
+				else
+				{
+					pOpen = 0.0;
+					dPOdC12 = 0.0;
+				}
 			}
-			UG_COND_THROW(vDI.size() != 5, "Not exactly 5 DoF indices for vertex.");
 
-
-			// add stiffness entries for cytosolic calcium / ER calcium, gating params
-			if (s_a0)
+			DoFRef(J, vDI[_CCYT_], vDI[_CCYT_]) += pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * s_a0 * 1e18;
+			DoFRef(J, vDI[_CCYT_], vDI[_CER_]) -= pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * s_a0 * 1e18;
+			DoFRef(J, vDI[_CCYT_], vDI[_C1_]) -= dPOdC12 * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt) * s_a0 * 1e15;
+			DoFRef(J, vDI[_CCYT_], vDI[_C2_]) -= dPOdC12 * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt) * s_a0 * 1e15;
+
+			DoFRef(J, vDI[_CER_], vDI[_CCYT_]) -= pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * s_a0 * 1e18;
+			DoFRef(J, vDI[_CER_], vDI[_CER_]) += pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * s_a0 * 1e18;
+			DoFRef(J, vDI[_CER_], vDI[_C1_]) += dPOdC12 * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt) * s_a0 * 1e15;
+			DoFRef(J, vDI[_CER_], vDI[_C2_]) += dPOdC12 * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt) * s_a0 * 1e15;
+
+			// gating sees the calcium concentration at the channel mouth
+			const number caG = channel_mouth_calcium(caCyt, caER, pOpen);
+			const number dO2dCa = s_a0 * KBplus * 3.0*caG*caG * o1;
+			const number dC1dCa = s_a0 * KAplus * 4.0*caG*caG*caG * c1;
+
+			DoFRef(J, vDI[_O2_], vDI[_CCYT_]) -= dO2dCa * 1e3 * (1.0 - m_ndFactor * pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER);
+			DoFRef(J, vDI[_O2_], vDI[_O2_]) += s_a0 * (KBminus + KBplus * caG*caG*caG);
+			DoFRef(J, vDI[_O2_], vDI[_C1_]) += s_a0 * KBplus * caG*caG*caG;
+			DoFRef(J, vDI[_O2_], vDI[_C2_]) += s_a0 * KBplus * caG*caG*caG;
+
+			DoFRef(J, vDI[_C1_], vDI[_CCYT_]) += dC1dCa * 1e3 * (1.0 - m_ndFactor * pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER);
+			DoFRef(J, vDI[_C1_], vDI[_O2_]) += s_a0 * KAminus;
+			DoFRef(J, vDI[_C1_], vDI[_C1_]) += s_a0 * (KAminus + KAplus * caG*caG*caG*caG);
+			DoFRef(J, vDI[_C1_], vDI[_C2_]) += s_a0 * KAminus;
+
+			// dependency of the channel mouth concentration on ER calcium and channel states
+			if (m_ndFactor != 0.0)
 			{
-				const number caCyt = 1e3 * DoFRef(u, vDI[_CCYT_]);   // scale from M to mM
-				const number caER = 1e3 * DoFRef(u, vDI[_CER_]);   // scale from M to mM
-				const number o2 = DoFRef(u, vDI[_O2_]);
-				const number c1 = DoFRef(u, vDI[_C1_]);
-				const number c2 = DoFRef(u, vDI[_C2_]);
-				const number o1 = 1.0 - (o2 + c1 + c2);
-
-				number pOpen = 1.0 - (c1 + c2);
-				number dPOdC12 = -1.0;
-
-				// really close channels below cutoff (0.002 corresponds to equil. cy_cyt of ~8e-5mM)
-				// using a cubic spline between x0=cutoff and x1=2*cutoff
-				// satisfying f'(x0) = 0; f(x0) = 0, f'(x1) = 1, f(x1) = x1
-				if (pOpen < 2*m_cutoffOpenProb)
-				{
-					if (pOpen > m_cutoffOpenProb)
-					{
-						const number x0 = m_cutoffOpenProb;
-						const number x1 = 2*m_cutoffOpenProb;
-						const number sa = - (x1-x0) / ((x1+x0)*(x1+x0)*(x1+x0));
-						const number sb = 2.0*(x1*x1 + x1*x0 + x0*x0) / ((x1+x0)*(x1+x0)*(x1+x0));
-						const number sc = -3.0*x0*x0*sa - 2*x0*sb;
-						const number sd = -x0*x0*x0*sa - x0*x0*sb - x0*sc;
-
-						dPOdC12 = -(3.0*sa*pOpen*pOpen + 2*sb*pOpen + sc);
-						pOpen = sa*pOpen*pOpen*pOpen + sb*pOpen*pOpen + sc*pOpen + sd;
-					}
-					else
-					{
-						pOpen = 0.0;
-						dPOdC12 = 0.0;
-					}
-				}
+				const number dCaGdER = 1e3 * m_ndFactor * pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER;
+				const number dCaGdC12 = m_ndFactor * dPOdC12 * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt);
 
-				DoFRef(J, vDI[_CCYT_], vDI[_CCYT_]) += pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * s_a0 * 1e18;
-				DoFRef(J, vDI[_CCYT_], vDI[_CER_]) -= pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * s_a0 * 1e18;
-				DoFRef(J, vDI[_CCYT_], vDI[_C1_]) -= dPOdC12 * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt) * s_a0 * 1e15;
-				DoFRef(J, vDI[_CCYT_], vDI[_C2_]) -= dPOdC12 * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt) * s_a0 * 1e15;
-
-				DoFRef(J, vDI[_CER_], vDI[_CCYT_]) -= pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * s_a0 * 1e18;
-				DoFRef(J, vDI[_CER_], vDI[_CER_]) += pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * s_a0 * 1e18;
-				DoFRef(J, vDI[_CER_], vDI[_C1_]) += dPOdC12 * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt) * s_a0 * 1e15;
-				DoFRef(J, vDI[_CER_], vDI[_C2_]) += dPOdC12 * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt) * s_a0 * 1e15;
-
-				DoFRef(J, vDI[_O2_], vDI[_CCYT_]) -= s_a0 * KBplus * 3.0*caCyt*caCyt * o1 * 1e3;
-				DoFRef(J, vDI[_O2_], vDI[_O2_]) += s_a0 * (KBminus + KBplus * caCyt*caCyt*caCyt);
-				DoFRef(J, vDI[_O2_], vDI[_C1_]) += s_a0 * KBplus * caCyt*caCyt*caCyt;
-				DoFRef(J, vDI[_O2_], vDI[_C2_]) += s_a0 * KBplus * caCyt*caCyt*caCyt;
-
-				DoFRef(J, vDI[_C1_], vDI[_CCYT_]) += s_a0 * KAplus * 4.0*caCyt*caCyt*caCyt * c1 * 1e3;
-				DoFRef(J, vDI[_C1_], vDI[_O2_]) += s_a0 * KAminus;
-				DoFRef(J, vDI[_C1_], vDI[_C1_]) += s_a0 * (KAminus + KAplus * caCyt*caCyt*caCyt*caCyt);
-				DoFRef(J, vDI[_C1_], vDI[_C2_]) += s_a0 * KAminus;
-
-				DoFRef(J, vDI[_C2_], vDI[_O2_]) += s_a0 * KCplus;
-				DoFRef(J, vDI[_C2_], vDI[_C1_]) += s_a0 * KCplus;
-				DoFRef(J, vDI[_C2_], vDI[_C2_]) += s_a0 * (KCminus + KCplus);
+				DoFRef(J, vDI[_O2_], vDI[_CER_]) -= dO2dCa * dCaGdER;
+				DoFRef(J, vDI[_O2_], vDI[_C1_]) -= dO2dCa * dCaGdC12;
+				DoFRef(J, vDI[_O2_], vDI[_C2_]) -= dO2dCa * dCaGdC12;
+
+				DoFRef(J, vDI[_C1_], vDI[_CER_]) += dC1dCa * dCaGdER;
+				DoFRef(J, vDI[_C1_], vDI[_C1_]) += dC1dCa * dCaGdC12;
+				DoFRef(J, vDI[_C1_], vDI[_C2_]) += dC1dCa * dCaGdC12;
 			}
 
-			// add mass defects for gating parameters
-			DoFRef(J, vDI[_O2_], vDI[_O2_]) += 1.0;
-			DoFRef(J, vDI[_C1_], vDI[_C1_]) += 1.0;
-			DoFRef(J, vDI[_C2_], vDI[_C2_]) += 1.0;
+			DoFRef(J, vDI[_C2_], vDI[_O2_]) += s_a0 * KCplus;
+			DoFRef(J, vDI[_C2_], vDI[_C1_]) += s_a0 * KCplus;
+			DoFRef(J, vDI[_C2_], vDI[_C2_]) += s_a0 * (KCminus + KCplus);
 		}
+
+		// add mass defects for gating parameters
+		DoFRef(J, vDI[_O2_], vDI[_O2_]) += 1.0;
+		DoFRef(J, vDI[_C1_], vDI[_C1_]) += 1.0;
+		DoFRef(J, vDI[_C2_], vDI[_C2_]) += 1.0;
 	}
 }
 
@@ -428,6 +451,181 @@ set_approximation_space(SmartPtr<ApproximationSpace<TDomain> > approxSpace)
 	UG_CATCH_THROW("Functions could not be added to function group.");
 	for (size_t i = 0; i < nFct; ++i)
 		m_vFctMap[i] = fg[i];
+
+	// index cache needs to be rebuilt after adaption or redistribution
+	m_bIndexCacheValid = false;
+	Grid& grid = *this->m_spApproxSpace->domain()->grid();
+	m_spGridAdaptionCallbackID = grid.message_hub()->register_class_callback(this,
+		&RyRDiscrete<TDomain, TAlgebra>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid.message_hub()->register_class_callback(this,
+		&RyRDiscrete<TDomain, TAlgebra>::grid_distribution_callback);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::update_index_cache(ConstSmartPtr<DoFDistribution> dd)
+{
+	m_vCachedDI.clear();
+
+#ifdef UG_PARALLEL
+	const DistributedGridManager& dgm = *dd->multi_grid()->distributed_grid_manager();
+#endif
+
+	// loop subsets
+	typedef typename DoFDistribution::traits<Vertex>::const_iterator vrt_it_type;
+	const size_t nSI = m_vSI.size();
+	const size_t nFct = m_vFctMap.size();
+	std::vector<DoFIndex> vDI(5);
+
+	// positions of channel vertices are only needed for mean-field clustering
+	std::vector<MathVector<dim> > vPos;
+	const typename TDomain::position_accessor_type& aaPos =
+		this->m_spApproxSpace->domain()->position_accessor();
+
+	for (size_t i = 0; i < nSI; ++i)
+	{
+		int si = m_vSI[i];
+
+		// loop all vertices in the subset
+		vrt_it_type it = dd->begin<Vertex>(si);
+		vrt_it_type itEnd = dd->end<Vertex>(si);
+		for (; it != itEnd; ++it)
+		{
+			Vertex* vrt = *it;
+
+#ifdef UG_PARALLEL
+			// do not process horizontal slaves in the parallel case to prevent double counting
+			if (dgm.get_status(vrt) & ES_H_SLAVE)
+				continue;
+#endif
+
+			// get all DoF indices that concern us here
+			vDI.clear();
+			for (size_t j = 0; j < nFct; ++j)
+			{
+				size_t fct = m_vFctMap[j];
+
+				// we do not need hanging vertices as all transport mechanism
+				// vertices must be in the coarse grid
+				dd->dof_indices(vrt, fct, vDI, false, false);
+			}
+			UG_COND_THROW(vDI.size() != 5, "Not exactly 5 DoF indices for vertex "
+				<< ElementDebugInfo(*dd->multi_grid(), vrt) << ".");
+
+			m_vCachedDI.insert(m_vCachedDI.end(), vDI.begin(), vDI.end());
+
+			if (m_mfRadius > 0.0)
+				vPos.push_back(aaPos[vrt]);
+		}
+	}
+
+	if (m_mfRadius > 0.0)
+		build_mean_field_clusters(vPos);
+
+	m_pIndexCacheDD = dd.get();
+	m_bIndexCacheValid = true;
+
+	// cluster states are re-initialized from the solution
+	m_bClustersInit = false;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::build_mean_field_clusters(const std::vector<MathVector<dim> >& vPos)
+{
+	const size_t nVrt = vPos.size();
+	const number radiusSq = m_mfRadius * m_mfRadius;
+
+	// sort vertices by first coordinate so that only a narrow window has to be searched
+	std::vector<std::pair<number, size_t> > vSorted(nVrt);
+	for (size_t v = 0; v < nVrt; ++v)
+		vSorted[v] = std::make_pair(vPos[v][0], v);
+	std::sort(vSorted.begin(), vSorted.end());
+
+	// greedily assign all unassigned vertices within radius of a seed to the seed's cluster
+	std::vector<bool> vAssigned(nVrt, false);
+	m_vMFClusterOffset.clear();
+	m_vMFClusterVrt.clear();
+	m_vMFClusterVrt.reserve(nVrt);
+	for (size_t i = 0; i < nVrt; ++i)
+	{
+		const size_t seed = vSorted[i].second;
+		if (vAssigned[seed])
+			continue;
+
+		m_vMFClusterOffset.push_back(m_vMFClusterVrt.size());
+		m_vMFClusterVrt.push_back(seed);
+		vAssigned[seed] = true;
+
+		for (size_t j = i+1; j < nVrt && vSorted[j].first - vSorted[i].first <= m_mfRadius; ++j)
+		{
+			const size_t v = vSorted[j].second;
+			if (!vAssigned[v] && VecDistanceSq(vPos[seed], vPos[v]) <= radiusSq)
+			{
+				m_vMFClusterVrt.push_back(v);
+				vAssigned[v] = true;
+			}
+		}
+	}
+	m_vMFClusterOffset.push_back(m_vMFClusterVrt.size());
+}
+
+
+template <typename TDomain, typename TAlgebra>
+number RyRDiscrete<TDomain, TAlgebra>::cutoff_open_probability(number pOpen, number& dPOdC12) const
+{
+	dPOdC12 = -1.0;
+
+	// really close channels below cutoff
+	// using a cubic spline between x0=cutoff and x1=2*cutoff
+	// satisfying f'(x0) = 0; f(x0) = 0, f'(x1) = 1, f(x1) = x1
+	if (pOpen < 2*m_cutoffOpenProb)
+	{
+		if (pOpen > m_cutoffOpenProb)
+		{
+			const number x0 = m_cutoffOpenProb;
+			const number x1 = 2*m_cutoffOpenProb;
+			const number sa = - (x1-x0) / ((x1+x0)*(x1+x0)*(x1+x0));
+			const number sb = 2.0*(x1*x1 + x1*x0 + x0*x0) / ((x1+x0)*(x1+x0)*(x1+x0));
+			const number sc = -3.0*x0*x0*sa - 2*x0*sb;
+			const number sd = -x0*x0*x0*sa - x0*x0*sb - x0*sc;
+
+			dPOdC12 = -(3.0*sa*pOpen*pOpen + 2*sb*pOpen + sc);
+			return sa*pOpen*pOpen*pOpen + sb*pOpen*pOpen + sc*pOpen + sd;
+		}
+
+		dPOdC12 = 0.0;
+		return 0.0;
+	}
+
+	return pOpen;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+number RyRDiscrete<TDomain, TAlgebra>::channel_mouth_calcium(number caCyt, number caER, number pOpen) const
+{
+	if (m_ndFactor == 0.0)
+		return caCyt;
+
+	// channel current (mol/s) times nanodomain concentration increase per current
+	return caCyt + m_ndFactor * pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		m_bIndexCacheValid = false;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		m_bIndexCacheValid = false;
 }
 
 
@@ -556,6 +754,684 @@ void RyRDiscrete<TDomain, TAlgebra>::set_cutoff_open_probability(number cutoffPr
 }
 
 
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::set_stochastic_mode(bool b, size_t nChannelsPerCluster)
+{
+	UG_COND_THROW(b && !nChannelsPerCluster, "Channel clusters must contain at least one channel.");
+	UG_COND_THROW(b && m_mfRadius > 0.0, "Stochastic mode cannot be combined with mean-field clustering.");
+	m_bStochastic = b;
+	m_nChPerCluster = nChannelsPerCluster;
+	m_bClustersInit = false;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::set_tau_leaping_threshold(size_t nChannels)
+{
+	m_tauLeapThreshold = nChannels;
+	m_bClustersInit = false;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::set_random_seed(size_t seed)
+{
+	// different streams on different processes
+	uint64_t s = (uint64_t) seed;
+#ifdef UG_PARALLEL
+	s += (uint64_t) pcl::ProcRank() << 32;
+#endif
+
+	// splitmix64 to obtain a non-zero, well-mixed xorshift state
+	s += 0x9E3779B97F4A7C15ULL;
+	s = (s ^ (s >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	s = (s ^ (s >> 27)) * 0x94D049BB133111EBULL;
+	s = s ^ (s >> 31);
+	m_rngState = s ? s : 0x2545F4914F6CDD1DULL;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::set_calcium_rescale_tolerance(number tol)
+{
+	m_caRescaleTol = tol;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::set_mean_field_clustering(number radius)
+{
+	UG_COND_THROW(radius < 0.0, "Cluster radius must not be negative.");
+	UG_COND_THROW(radius > 0.0 && m_bStochastic, "Mean-field clustering cannot be combined with stochastic mode.");
+	m_mfRadius = radius;
+
+	// clusters are built together with the index cache
+	m_bIndexCacheValid = false;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::set_nanodomain_correction
+(
+	number mouthRadius,
+	number meshRadius,
+	number diffCoeff,
+	number bufferRate
+)
+{
+	if (mouthRadius <= 0.0)
+	{
+		m_ndFactor = 0.0;
+		return;
+	}
+
+	UG_COND_THROW(meshRadius <= mouthRadius, "Mesh radius (" << meshRadius
+		<< ") must be larger than channel mouth radius (" << mouthRadius << ").");
+	UG_COND_THROW(diffCoeff <= 0.0, "Diffusion coefficient must be positive.");
+	UG_COND_THROW(bufferRate < 0.0, "Buffer binding rate must not be negative.");
+
+	// point source in half-space with excess buffer: c(r) = i / (2 pi D r) * exp(-r/lambda);
+	// only the part between mouth radius and mesh radius is added to the grid value
+	const number lambdaInv = sqrt(bufferRate / diffCoeff);
+	m_ndFactor = 1e18 / (2.0 * 3.14159265358979323846 * diffCoeff)  // scale from mol/um^3 to mM
+		* (exp(-mouthRadius*lambdaInv) / mouthRadius - exp(-meshRadius*lambdaInv) / meshRadius);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+number RyRDiscrete<TDomain, TAlgebra>::rand_uniform()
+{
+	// xorshift64*, result in [0,1)
+	m_rngState ^= m_rngState >> 12;
+	m_rngState ^= m_rngState << 25;
+	m_rngState ^= m_rngState >> 27;
+	return (number) ((m_rngState * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+number RyRDiscrete<TDomain, TAlgebra>::rand_normal()
+{
+	// Box-Muller
+	const number u1 = 1.0 - rand_uniform();
+	const number u2 = rand_uniform();
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * 3.14159265358979323846 * u2);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+size_t RyRDiscrete<TDomain, TAlgebra>::rand_poisson(number mean)
+{
+	if (mean <= 0.0)
+		return 0;
+
+	// normal approximation for large means
+	if (mean > 30.0)
+	{
+		const number k = floor(mean + sqrt(mean) * rand_normal() + 0.5);
+		return k > 0.0 ? (size_t) k : 0;
+	}
+
+	// Knuth's multiplication method
+	const number L = exp(-mean);
+	size_t k = 0;
+	number p = rand_uniform();
+	while (p > L)
+	{
+		++k;
+		p *= rand_uniform();
+	}
+	return k;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+number RyRDiscrete<TDomain, TAlgebra>::cluster_propensities(const ChannelCluster& cl, number ca, number* a) const
+{
+	const number ca3 = ca*ca*ca;
+	a[0] = cl.n[_SC1_] * KAplus * ca3*ca;	// C1 --> O1
+	a[1] = cl.n[_SO1_] * KAminus;			// O1 --> C1
+	a[2] = cl.n[_SO1_] * KBplus * ca3;		// O1 --> O2
+	a[3] = cl.n[_SO2_] * KBminus;			// O2 --> O1
+	a[4] = cl.n[_SO1_] * KCplus;			// O1 --> C2
+	a[5] = cl.n[_SC2_] * KCminus;			// C2 --> O1
+
+	return a[0] + a[1] + a[2] + a[3] + a[4] + a[5];
+}
+
+
+// source and target states of the six transitions
+static const size_t ryrTransFrom[6] = {0, 1, 1, 2, 1, 3};
+static const size_t ryrTransTo[6] = {1, 0, 2, 1, 3, 1};
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::fire_transition(ChannelCluster& cl)
+{
+	number a[6];
+	const number a0 = cluster_propensities(cl, cl.ca, a);
+	if (a0 <= 0.0)
+		return;
+
+	number r = rand_uniform() * a0;
+	size_t j = 0;
+	for (; j < 5; ++j)
+	{
+		if (r < a[j])
+			break;
+		r -= a[j];
+	}
+
+	// guard against rounding choosing an empty transition
+	while (!cl.n[ryrTransFrom[j]])
+		j = (j + 1) % 6;
+
+	--cl.n[ryrTransFrom[j]];
+	++cl.n[ryrTransTo[j]];
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::tau_leap(ChannelCluster& cl, number dt)
+{
+	// restrict the leap size such that the expected number of transitions
+	// out of a state stays below 10% of its occupancy
+	const number ca3 = cl.ca*cl.ca*cl.ca;
+	const number maxRate = std::max(std::max(KAplus * ca3*cl.ca, KAminus + KBplus * ca3 + KCplus),
+		std::max(KBminus, KCminus));
+	const size_t nLeaps = std::max((size_t) 1, (size_t) ceil(dt * maxRate / 0.1));
+	const number tau = dt / nLeaps;
+
+	number a[6];
+	for (size_t l = 0; l < nLeaps; ++l)
+	{
+		cluster_propensities(cl, cl.ca, a);
+
+		// apply transitions one after another, never emptying a state below zero
+		for (size_t j = 0; j < 6; ++j)
+		{
+			const size_t k = std::min(rand_poisson(a[j] * tau), cl.n[ryrTransFrom[j]]);
+			cl.n[ryrTransFrom[j]] -= k;
+			cl.n[ryrTransTo[j]] += k;
+		}
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::init_clusters(const vector_type& u, number time)
+{
+	const size_t nVrt = m_vCachedDI.size() / 5;
+	const number nCh = (number) m_nChPerCluster;
+	const number inf = std::numeric_limits<number>::infinity();
+
+	m_vCluster.resize(nVrt);
+	m_vEventQueue.clear();
+	for (size_t v = 0; v < nVrt; ++v)
+	{
+		const DoFIndex* vDI = &m_vCachedDI[5*v];
+		ChannelCluster& cl = m_vCluster[v];
+
+		// round state fractions to channel numbers
+		const number o2 = std::max(DoFRef(u, vDI[_O2_]), 0.0);
+		const number c1 = std::max(DoFRef(u, vDI[_C1_]), 0.0);
+		const number c2 = std::max(DoFRef(u, vDI[_C2_]), 0.0);
+		cl.n[_SO2_] = std::min((size_t) floor(o2 * nCh + 0.5), m_nChPerCluster);
+		cl.n[_SC1_] = std::min((size_t) floor(c1 * nCh + 0.5), m_nChPerCluster - cl.n[_SO2_]);
+		cl.n[_SC2_] = std::min((size_t) floor(c2 * nCh + 0.5), m_nChPerCluster - cl.n[_SO2_] - cl.n[_SC1_]);
+		cl.n[_SO1_] = m_nChPerCluster - cl.n[_SO2_] - cl.n[_SC1_] - cl.n[_SC2_];
+
+		number a[6];
+		cl.ca = cluster_calcium(u, v, cl);
+		cl.a0 = cluster_propensities(cl, cl.ca, a);
+		cl.nextEventTime = inf;
+
+		// schedule first event for event-driven clusters
+		if (m_nChPerCluster < m_tauLeapThreshold && cl.a0 > 0.0)
+		{
+			cl.nextEventTime = time - log(1.0 - rand_uniform()) / cl.a0;
+			m_vEventQueue.push_back(event_type(cl.nextEventTime, v));
+		}
+	}
+	std::make_heap(m_vEventQueue.begin(), m_vEventQueue.end(), std::greater<event_type>());
+
+	m_stochTime = time;
+	m_bClustersInit = true;
+	m_bSnapshotValid = false;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::save_clusters()
+{
+	m_vClusterSnapshot = m_vCluster;
+	m_vEventQueueSnapshot = m_vEventQueue;
+	m_snapshotRngState = m_rngState;
+	m_snapshotTime = m_stochTime;
+	m_bSnapshotValid = true;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::restore_clusters()
+{
+	m_vCluster = m_vClusterSnapshot;
+	m_vEventQueue = m_vEventQueueSnapshot;
+	m_rngState = m_snapshotRngState;
+	m_stochTime = m_snapshotTime;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::advance_clusters(const vector_type& u, number tEnd)
+{
+	const number t0 = m_stochTime;
+	const number dt = tEnd - t0;
+	const number inf = std::numeric_limits<number>::infinity();
+	const size_t nVrt = m_vCluster.size();
+	std::greater<event_type> cmp;
+	number a[6];
+
+	// tau-leaping for crowded clusters
+	if (m_nChPerCluster >= m_tauLeapThreshold)
+	{
+		for (size_t v = 0; v < nVrt; ++v)
+		{
+			ChannelCluster& cl = m_vCluster[v];
+			cl.ca = cluster_calcium(u, v, cl);
+			tau_leap(cl, dt);
+		}
+		m_stochTime = tEnd;
+		return;
+	}
+
+	// rescale scheduled events of clusters whose calcium has changed significantly
+	// (next-reaction method: remaining waiting time scales with a0_old / a0_new)
+	for (size_t v = 0; v < nVrt; ++v)
+	{
+		ChannelCluster& cl = m_vCluster[v];
+		const number ca = cluster_calcium(u, v, cl);
+		if (fabs(ca - cl.ca) <= m_caRescaleTol * fabs(cl.ca))
+			continue;
+
+		const number a0Old = cl.a0;
+		cl.ca = ca;
+		cl.a0 = cluster_propensities(cl, ca, a);
+
+		const number tOld = cl.nextEventTime;
+		if (cl.a0 <= 0.0)
+			cl.nextEventTime = inf;
+		else if (a0Old > 0.0 && tOld != inf)
+			cl.nextEventTime = t0 + a0Old / cl.a0 * (tOld - t0);
+		else
+			cl.nextEventTime = t0 - log(1.0 - rand_uniform()) / cl.a0;
+
+		if (cl.nextEventTime != tOld && cl.nextEventTime != inf)
+		{
+			m_vEventQueue.push_back(event_type(cl.nextEventTime, v));
+			std::push_heap(m_vEventQueue.begin(), m_vEventQueue.end(), cmp);
+		}
+	}
+
+	// drop outdated entries if they have accumulated too much
+	if (m_vEventQueue.size() > 4*nVrt)
+	{
+		m_vEventQueue.clear();
+		for (size_t v = 0; v < nVrt; ++v)
+			if (m_vCluster[v].nextEventTime != inf)
+				m_vEventQueue.push_back(event_type(m_vCluster[v].nextEventTime, v));
+		std::make_heap(m_vEventQueue.begin(), m_vEventQueue.end(), cmp);
+	}
+
+	// process all events in the time step
+	while (!m_vEventQueue.empty() && m_vEventQueue.front().first < tEnd)
+	{
+		const event_type ev = m_vEventQueue.front();
+		std::pop_heap(m_vEventQueue.begin(), m_vEventQueue.end(), cmp);
+		m_vEventQueue.pop_back();
+
+		// outdated entry (event has been rescheduled)
+		ChannelCluster& cl = m_vCluster[ev.second];
+		if (ev.first != cl.nextEventTime)
+			continue;
+
+		fire_transition(cl);
+
+		cl.a0 = cluster_propensities(cl, cl.ca, a);
+		if (cl.a0 <= 0.0)
+		{
+			cl.nextEventTime = inf;
+			continue;
+		}
+		cl.nextEventTime = ev.first - log(1.0 - rand_uniform()) / cl.a0;
+		m_vEventQueue.push_back(event_type(cl.nextEventTime, ev.second));
+		std::push_heap(m_vEventQueue.begin(), m_vEventQueue.end(), cmp);
+	}
+
+	m_stochTime = tEnd;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::adjust_defect_stochastic
+(
+	vector_type& d,
+	const vector_type& u,
+	number time,
+	ConstSmartPtr<VectorTimeSeries<vector_type> > vSol,
+	const std::vector<number>* vScaleStiff,
+	size_t nTimes
+)
+{
+	// the channel states are advanced using the solution of the previous time step
+	const bool bOldSol = vSol.valid() && vSol->size() > 1;
+	const vector_type& uOld = bOldSol ? *vSol->solution(1) : u;
+	if (!m_bClustersInit)
+		init_clusters(uOld, bOldSol ? vSol->time(1) : time);
+
+	// a rejected step is repeated (with a smaller step size) from the cluster
+	// states and random numbers at its beginning
+	if (time < m_stochTime)
+	{
+		if (m_bSnapshotValid && m_snapshotTime <= time)
+			restore_clusters();
+		else
+			init_clusters(uOld, bOldSol ? vSol->time(1) : time);
+	}
+	if (time > m_stochTime)
+	{
+		save_clusters();
+		advance_clusters(uOld, time);
+	}
+
+	const number nChInv = 1.0 / m_nChPerCluster;
+	const size_t nVrt = m_vCluster.size();
+	for (size_t v = 0; v < nVrt; ++v)
+	{
+		const DoFIndex* vDI = &m_vCachedDI[5*v];
+		const ChannelCluster& cl = m_vCluster[v];
+
+		// calcium current through open channels
+		for (size_t k = 0; k < nTimes; ++k)
+		{
+			if (vScaleStiff && !(*vScaleStiff)[k])
+				continue;
+
+			const vector_type& uk = vSol.valid() ? *vSol->solution(k) : u;
+			const number caCyt = 1e3 * DoFRef(uk, vDI[_CCYT_]);   // scale from M to mM
+			const number caER = 1e3 * DoFRef(uk, vDI[_CER_]);   // scale from M to mM
+			const number pOpen = 1.0 - (DoFRef(uk, vDI[_C1_]) + DoFRef(uk, vDI[_C2_]));
+
+			const number current = pOpen * R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt);
+
+			number dt = 1.0;
+			if (vScaleStiff)
+				dt = (*vScaleStiff)[k];
+
+			DoFRef(d, vDI[_CCYT_]) -= current * dt * 1e15;  // scale from mol to mol (um/dm)^3
+			DoFRef(d, vDI[_CER_]) += current * dt * 1e15;  // scale from mol to mol (um/dm)^3
+		}
+
+		// gating unknowns are fixed to the cluster state fractions
+		DoFRef(d, vDI[_O2_]) += DoFRef(u, vDI[_O2_]) - cl.n[_SO2_] * nChInv;
+		DoFRef(d, vDI[_C1_]) += DoFRef(u, vDI[_C1_]) - cl.n[_SC1_] * nChInv;
+		DoFRef(d, vDI[_C2_]) += DoFRef(u, vDI[_C2_]) - cl.n[_SC2_] * nChInv;
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::adjust_jacobian_stochastic
+(
+	matrix_type& J,
+	const vector_type& u,
+	const number s_a0
+)
+{
+	const size_t nVrt = m_vCachedDI.size() / 5;
+	for (size_t v = 0; v < nVrt; ++v)
+	{
+		const DoFIndex* vDI = &m_vCachedDI[5*v];
+
+		if (s_a0)
+		{
+			const number caCyt = 1e3 * DoFRef(u, vDI[_CCYT_]);   // scale from M to mM
+			const number caER = 1e3 * DoFRef(u, vDI[_CER_]);   // scale from M to mM
+			const number pOpen = 1.0 - (DoFRef(u, vDI[_C1_]) + DoFRef(u, vDI[_C2_]));
+			const number fac = R*T/(4*F*F) * MU_RYR/REF_CA_ER * s_a0;
+
+			DoFRef(J, vDI[_CCYT_], vDI[_CCYT_]) += pOpen * fac * 1e18;
+			DoFRef(J, vDI[_CCYT_], vDI[_CER_]) -= pOpen * fac * 1e18;
+			DoFRef(J, vDI[_CCYT_], vDI[_C1_]) += fac * (caER - caCyt) * 1e15;
+			DoFRef(J, vDI[_CCYT_], vDI[_C2_]) += fac * (caER - caCyt) * 1e15;
+
+			DoFRef(J, vDI[_CER_], vDI[_CCYT_]) -= pOpen * fac * 1e18;
+			DoFRef(J, vDI[_CER_], vDI[_CER_]) += pOpen * fac * 1e18;
+			DoFRef(J, vDI[_CER_], vDI[_C1_]) -= fac * (caER - caCyt) * 1e15;
+			DoFRef(J, vDI[_CER_], vDI[_C2_]) -= fac * (caER - caCyt) * 1e15;
+		}
+
+		DoFRef(J, vDI[_O2_], vDI[_O2_]) += 1.0;
+		DoFRef(J, vDI[_C1_], vDI[_C1_]) += 1.0;
+		DoFRef(J, vDI[_C2_], vDI[_C2_]) += 1.0;
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+number RyRDiscrete<TDomain, TAlgebra>::cluster_calcium
+(
+	const vector_type& u,
+	size_t v,
+	const ChannelCluster& cl
+) const
+{
+	const number caCyt = 1e3 * DoFRef(u, m_vCachedDI[5*v + _CCYT_]);   // scale from M to mM
+	if (m_ndFactor == 0.0)
+		return caCyt;
+
+	const number caER = 1e3 * DoFRef(u, m_vCachedDI[5*v + _CER_]);   // scale from M to mM
+	const number pOpen = (number) (cl.n[_SO1_] + cl.n[_SO2_]) / m_nChPerCluster;
+	return channel_mouth_calcium(caCyt, caER, pOpen);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::adjust_defect_mean_field
+(
+	vector_type& d,
+	const vector_type& u,
+	ConstSmartPtr<VectorTimeSeries<vector_type> > vSol,
+	const std::vector<number>* vScaleMass,
+	const std::vector<number>* vScaleStiff,
+	size_t nTimes
+)
+{
+	const number fac = R*T/(4*F*F) * MU_RYR/REF_CA_ER;
+
+	// loop all clusters
+	const size_t nCl = m_vMFClusterOffset.size() - 1;
+	for (size_t c = 0; c < nCl; ++c)
+	{
+		const size_t* vMember = &m_vMFClusterVrt[m_vMFClusterOffset[c]];
+		const size_t nMember = m_vMFClusterOffset[c+1] - m_vMFClusterOffset[c];
+		const DoFIndex* repDI = &m_vCachedDI[5*vMember[0]];
+
+		for (size_t k = 0; k < nTimes; ++k)
+		{
+			if (vScaleStiff && !(*vScaleStiff)[k])
+				continue;
+
+			const vector_type& uk = vSol.valid() ? *vSol->solution(k) : u;
+
+			const number o2 = DoFRef(uk, repDI[_O2_]);
+			const number c1 = DoFRef(uk, repDI[_C1_]);
+			const number c2 = DoFRef(uk, repDI[_C2_]);
+			const number o1 = 1.0 - (o2 + c1 + c2);
+
+			number dPOdC12;
+			const number pOpen = cutoff_open_probability(1.0 - (c1 + c2), dPOdC12);
+
+			number dt = 1.0;
+			if (vScaleStiff)
+				dt = (*vScaleStiff)[k];
+
+			// channel currents on all cluster vertices, mean cytosolic calcium
+			number caMean = 0.0;
+			for (size_t m = 0; m < nMember; ++m)
+			{
+				const DoFIndex* vDI = &m_vCachedDI[5*vMember[m]];
+				const number caCyt = 1e3 * DoFRef(uk, vDI[_CCYT_]);   // scale from M to mM
+				const number caER = 1e3 * DoFRef(uk, vDI[_CER_]);   // scale from M to mM
+				caMean += channel_mouth_calcium(caCyt, caER, pOpen);
+
+				const number current = pOpen * fac * (caER - caCyt);
+				DoFRef(d, vDI[_CCYT_]) -= current * dt * 1e15;  // scale from mol to mol (um/dm)^3
+				DoFRef(d, vDI[_CER_]) += current * dt * 1e15;  // scale from mol to mol (um/dm)^3
+			}
+			caMean /= nMember;
+
+			// cluster gating driven by mean channel mouth calcium
+			DoFRef(d, repDI[_O2_]) -= dt * (KBplus * caMean*caMean*caMean * o1 - KBminus * o2);
+			DoFRef(d, repDI[_C1_]) -= dt * (KAminus * o1 - KAplus * caMean*caMean*caMean*caMean * c1);
+			DoFRef(d, repDI[_C2_]) -= dt * (KCplus * o1 - KCminus * c2);
+		}
+
+		// add mass defects for cluster gating parameters
+		if (vSol.valid() && vScaleMass)
+		{
+			for (size_t k = 0; k < nTimes; ++k)
+			{
+				DoFRef(d, repDI[_O2_]) += (*vScaleMass)[k] * DoFRef(*vSol->solution(k), repDI[_O2_]);
+				DoFRef(d, repDI[_C1_]) += (*vScaleMass)[k] * DoFRef(*vSol->solution(k), repDI[_C1_]);
+				DoFRef(d, repDI[_C2_]) += (*vScaleMass)[k] * DoFRef(*vSol->solution(k), repDI[_C2_]);
+			}
+		}
+
+		// slave gating parameters of other cluster vertices to the representative
+		for (size_t m = 1; m < nMember; ++m)
+		{
+			const DoFIndex* vDI = &m_vCachedDI[5*vMember[m]];
+			for (size_t j = _O2_; j <= _C2_; ++j)
+				DoFRef(d, vDI[j]) += DoFRef(u, vDI[j]) - DoFRef(u, repDI[j]);
+		}
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRDiscrete<TDomain, TAlgebra>::adjust_jacobian_mean_field
+(
+	matrix_type& J,
+	const vector_type& u,
+	const number s_a0
+)
+{
+	const number fac = R*T/(4*F*F) * MU_RYR/REF_CA_ER;
+
+	// loop all clusters
+	const size_t nCl = m_vMFClusterOffset.size() - 1;
+	for (size_t c = 0; c < nCl; ++c)
+	{
+		const size_t* vMember = &m_vMFClusterVrt[m_vMFClusterOffset[c]];
+		const size_t nMember = m_vMFClusterOffset[c+1] - m_vMFClusterOffset[c];
+		const DoFIndex* repDI = &m_vCachedDI[5*vMember[0]];
+
+		if (s_a0)
+		{
+			const number o2 = DoFRef(u, repDI[_O2_]);
+			const number c1 = DoFRef(u, repDI[_C1_]);
+			const number c2 = DoFRef(u, repDI[_C2_]);
+			const number o1 = 1.0 - (o2 + c1 + c2);
+
+			number dPOdC12;
+			const number pOpen = cutoff_open_probability(1.0 - (c1 + c2), dPOdC12);
+
+			number caMean = 0.0;
+			number dCaMeandC12 = 0.0;
+			for (size_t m = 0; m < nMember; ++m)
+			{
+				const DoFIndex* vDI = &m_vCachedDI[5*vMember[m]];
+				const number caCyt = 1e3 * DoFRef(u, vDI[_CCYT_]);   // scale from M to mM
+				const number caER = 1e3 * DoFRef(u, vDI[_CER_]);   // scale from M to mM
+				caMean += channel_mouth_calcium(caCyt, caER, pOpen);
+				dCaMeandC12 += m_ndFactor * dPOdC12 * fac * (caER - caCyt);
+			}
+			caMean /= nMember;
+			dCaMeandC12 /= nMember;
+
+			// derivatives of mean channel mouth calcium w.r.t. cytosolic and ER calcium of each member
+			const number dCaMeandCyt = 1e3 * (1.0 - m_ndFactor * pOpen * fac) / nMember;
+			const number dCaMeandER = 1e3 * m_ndFactor * pOpen * fac / nMember;
+			const number dO2dCa = s_a0 * KBplus * 3.0*caMean*caMean * o1;
+			const number dC1dCa = s_a0 * KAplus * 4.0*caMean*caMean*caMean * c1;
+
+			for (size_t m = 0; m < nMember; ++m)
+			{
+				const DoFIndex* vDI = &m_vCachedDI[5*vMember[m]];
+				const number caCyt = 1e3 * DoFRef(u, vDI[_CCYT_]);   // scale from M to mM
+				const number caER = 1e3 * DoFRef(u, vDI[_CER_]);   // scale from M to mM
+
+				DoFRef(J, vDI[_CCYT_], vDI[_CCYT_]) += pOpen * fac * s_a0 * 1e18;
+				DoFRef(J, vDI[_CCYT_], vDI[_CER_]) -= pOpen * fac * s_a0 * 1e18;
+				DoFRef(J, vDI[_CCYT_], repDI[_C1_]) -= dPOdC12 * fac * (caER - caCyt) * s_a0 * 1e15;
+				DoFRef(J, vDI[_CCYT_], repDI[_C2_]) -= dPOdC12 * fac * (caER - caCyt) * s_a0 * 1e15;
+
+				DoFRef(J, vDI[_CER_], vDI[_CCYT_]) -= pOpen * fac * s_a0 * 1e18;
+				DoFRef(J, vDI[_CER_], vDI[_CER_]) += pOpen * fac * s_a0 * 1e18;
+				DoFRef(J, vDI[_CER_], repDI[_C1_]) += dPOdC12 * fac * (caER - caCyt) * s_a0 * 1e15;
+				DoFRef(J, vDI[_CER_], repDI[_C2_]) += dPOdC12 * fac * (caER - caCyt) * s_a0 * 1e15;
+
+				// cluster gating depends on calcium of all cluster vertices via the mean
+				DoFRef(J, repDI[_O2_], vDI[_CCYT_]) -= dO2dCa * dCaMeandCyt;
+				DoFRef(J, repDI[_C1_], vDI[_CCYT_]) += dC1dCa * dCaMeandCyt;
+				if (m_ndFactor != 0.0)
+				{
+					DoFRef(J, repDI[_O2_], vDI[_CER_]) -= dO2dCa * dCaMeandER;
+					DoFRef(J, repDI[_C1_], vDI[_CER_]) += dC1dCa * dCaMeandER;
+				}
+			}
+
+			if (m_ndFactor != 0.0)
+			{
+				DoFRef(J, repDI[_O2_], repDI[_C1_]) -= dO2dCa * dCaMeandC12;
+				DoFRef(J, repDI[_O2_], repDI[_C2_]) -= dO2dCa * dCaMeandC12;
+				DoFRef(J, repDI[_C1_], repDI[_C1_]) += dC1dCa * dCaMeandC12;
+				DoFRef(J, repDI[_C1_], repDI[_C2_]) += dC1dCa * dCaMeandC12;
+			}
+
+			DoFRef(J, repDI[_O2_], repDI[_O2_]) += s_a0 * (KBminus + KBplus * caMean*caMean*caMean);
+			DoFRef(J, repDI[_O2_], repDI[_C1_]) += s_a0 * KBplus * caMean*caMean*caMean;
+			DoFRef(J, repDI[_O2_], repDI[_C2_]) += s_a0 * KBplus * caMean*caMean*caMean;
+
+			DoFRef(J, repDI[_C1_], repDI[_O2_]) += s_a0 * KAminus;
+			DoFRef(J, repDI[_C1_], repDI[_C1_]) += s_a0 * (KAminus + KAplus * caMean*caMean*caMean*caMean);
+			DoFRef(J, repDI[_C1_], repDI[_C2_]) += s_a0 * KAminus;
+
+			DoFRef(J, repDI[_C2_], repDI[_O2_]) += s_a0 * KCplus;
+			DoFRef(J, repDI[_C2_], repDI[_C1_]) += s_a0 * KCplus;
+			DoFRef(J, repDI[_C2_], repDI[_C2_]) += s_a0 * (KCminus + KCplus);
+		}
+
+		// add mass defects for cluster gating parameters
+		DoFRef(J, repDI[_O2_], repDI[_O2_]) += 1.0;
+		DoFRef(J, repDI[_C1_], repDI[_C1_]) += 1.0;
+		DoFRef(J, repDI[_C2_], repDI[_C2_]) += 1.0;
+
+		// slaved gating parameters of other cluster vertices
+		for (size_t m = 1; m < nMember; ++m)
+		{
+			const DoFIndex* vDI = &m_vCachedDI[5*vMember[m]];
+			for (size_t j = _O2_; j <= _C2_; ++j)
+			{
+				DoFRef(J, vDI[j], vDI[j]) += 1.0;
+				DoFRef(J, vDI[j], repDI[j]) -= 1.0;
+			}
+		}
+	}
+}
+
+
 // explicit template specializations
 #ifdef UG_CPU_1
 	#ifdef UG_DIM_1
@@ -41,9 +41,13 @@
 #define UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORTERS__RYR_DISCRETE_H
 
 
+#include "common/math/ugmath.h"  // for MathVector
 #include "common/util/smart_pointer.h"
+#include "lib_disc/common/multi_index.h"  // for DoFIndex
 #include "lib_disc/spatial_disc/constraints/constraint_interface.h"  // for IDomainConstraint
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
 
+#include <stdint.h>  // for uint64_t
 #include <string>
 #include <vector>
 
@@ -68,6 +72,32 @@ namespace neuro_collection {
  *  supply a method set_cutoff_open_probability that set open probability below which
  *  the channel is supposed to be certainly closed.
  *
+ *  Alternatively, channel gating can be simulated stochastically (set_stochastic_mode).
+ *  Each channel vertex then represents a cluster of channels whose state transitions
+ *  are simulated using the calcium concentration of the previous time step. Small
+ *  clusters are treated event-driven (next-reaction method with one event queue for
+ *  all clusters), so only clusters with an event in the current time step are touched;
+ *  clusters of at least the tau-leaping threshold size are advanced by tau-leaping.
+ *  The state fractions of the clusters are written to the o2, c1, c2 unknowns.
+ *  If a time step is rejected and repeated with a smaller step size, the clusters
+ *  (and the random number generator) are reset to their states at its beginning.
+ *
+ *  As a cheaper deterministic alternative for densely packed channels, neighboring
+ *  channel vertices can be aggregated to mean-field clusters (set_mean_field_clustering).
+ *  The occupancy fractions of a cluster are then only evolved on one representative
+ *  vertex, driven by the mean cytosolic calcium concentration over all cluster vertices;
+ *  the gating unknowns of the other cluster vertices are slaved to the representative.
+ *  The cluster's open probability is used for the flux on every cluster vertex.
+ *
+ *  On coarse meshes, the calcium concentration at a channel vertex underestimates the
+ *  concentration at the channel mouth by far. An analytic sub-grid correction can be
+ *  switched on (set_nanodomain_correction) that adds the steady-state point-source
+ *  solution of a channel in a half-space with excess buffer (Neher 1986) to the grid
+ *  value, minus the part of it that is already resolved by the mesh, i.e.
+ *    c_mouth = c + i / (2 pi D) * (exp(-r/lambda)/r - exp(-h/lambda)/h),
+ *  lambda = sqrt(D / (k_on B_tot)). The corrected concentration is only used for the
+ *  gating kinetics; the flux is unaffected.
+ *
  */
 template <typename TDomain, typename TAlgebra>
 class RyRDiscrete
@@ -199,6 +229,140 @@ class RyRDiscrete
 		/// set open probability below which the channel is supposed to be certainly closed
 		void set_cutoff_open_probability(number cutoffProb);
 
+		/**
+		 * @brief switch stochastic channel gating on or off
+		 * @param b                     whether to use stochastic gating
+		 * @param nChannelsPerCluster   number of channels represented by each channel vertex
+		 */
+		void set_stochastic_mode(bool b, size_t nChannelsPerCluster);
+
+		/// set cluster size from which on clusters are advanced by tau-leaping (default: 50)
+		void set_tau_leaping_threshold(size_t nChannels);
+
+		/// set seed for the random number generator
+		void set_random_seed(size_t seed);
+
+		/**
+		 * @brief set relative calcium change below which scheduled events are kept
+		 * Transition rates of a cluster are only re-evaluated (and its next event time
+		 * rescaled) if the cytosolic calcium concentration at its vertex has changed
+		 * by more than this fraction since the last evaluation (default: 1e-3).
+		 */
+		void set_calcium_rescale_tolerance(number tol);
+
+		/**
+		 * @brief aggregate channel vertices to mean-field clusters
+		 * Channel vertices within the given distance of a cluster seed vertex are grouped
+		 * into one cluster sharing a single set of gating states (see class description).
+		 * Clusters are built whenever the DoF index cache is rebuilt; in the parallel case
+		 * clusters do not extend across process boundaries.
+		 * A radius of 0 (default) switches clustering off.
+		 *
+		 * @param radius   cluster radius (in units of the grid coordinates)
+		 */
+		void set_mean_field_clustering(number radius);
+
+		/**
+		 * @brief switch on sub-grid correction of the calcium concentration seen by the gating
+		 * See class description. A mouth radius of 0 (default) switches the correction off.
+		 *
+		 * @param mouthRadius   distance of the calcium sensor from the channel pore (um)
+		 * @param meshRadius    distance from which on the calcium field is resolved by the mesh (um),
+		 *                      typically about half the edge length around channel vertices
+		 * @param diffCoeff     calcium diffusion coefficient (um^2/s)
+		 * @param bufferRate    pseudo-first-order buffer binding rate k_on * B_tot (1/s)
+		 */
+		void set_nanodomain_correction(number mouthRadius, number meshRadius, number diffCoeff, number bufferRate);
+
+	protected:
+		/// collect DoF indices of all channel vertices for the given DoF distribution
+		void update_index_cache(ConstSmartPtr<DoFDistribution> dd);
+
+		/// group channel vertices (given by their positions) to mean-field clusters
+		void build_mean_field_clusters(const std::vector<MathVector<dim> >& vPos);
+
+		/// mean-field cluster versions of defect and Jacobian adjustment
+		void adjust_defect_mean_field
+		(
+			vector_type& d,
+			const vector_type& u,
+			ConstSmartPtr<VectorTimeSeries<vector_type> > vSol,
+			const std::vector<number>* vScaleMass,
+			const std::vector<number>* vScaleStiff,
+			size_t nTimes
+		);
+		void adjust_jacobian_mean_field(matrix_type& J, const vector_type& u, const number s_a0);
+
+		/// apply open probability cutoff, derivative w.r.t. c1 (and c2) written to dPOdC12
+		number cutoff_open_probability(number pOpen, number& dPOdC12) const;
+
+		/// calcium concentration (mM) at the channel mouth (equals caCyt if no correction is used)
+		number channel_mouth_calcium(number caCyt, number caER, number pOpen) const;
+
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	protected:
+		/// channel states of a stochastic cluster
+		enum
+		{
+			_SC1_ = 0,
+			_SO1_ = 1,
+			_SO2_ = 2,
+			_SC2_ = 3
+		};
+
+		/// stochastic channel cluster
+		struct ChannelCluster
+		{
+			size_t n[4];			///< number of channels in each state
+			number ca;				///< cytosolic calcium (mM) the propensities are evaluated for
+			number a0;				///< total propensity
+			number nextEventTime;	///< time of next transition (event-driven clusters only)
+		};
+
+		typedef std::pair<number, size_t> event_type;
+
+		/// stochastic versions of defect and Jacobian adjustment
+		void adjust_defect_stochastic
+		(
+			vector_type& d,
+			const vector_type& u,
+			number time,
+			ConstSmartPtr<VectorTimeSeries<vector_type> > vSol,
+			const std::vector<number>* vScaleStiff,
+			size_t nTimes
+		);
+		void adjust_jacobian_stochastic(matrix_type& J, const vector_type& u, const number s_a0);
+
+		/// initialize cluster states from gating unknowns
+		void init_clusters(const vector_type& u, number time);
+
+		/// advance all clusters to the given time
+		void advance_clusters(const vector_type& u, number tEnd);
+
+		/// remember cluster states, event queue and random number generator state
+		void save_clusters();
+
+		/// reset clusters to the states remembered by save_clusters()
+		void restore_clusters();
+
+		/// calculate transition propensities for a cluster, returns total propensity
+		number cluster_propensities(const ChannelCluster& cl, number ca, number* a) const;
+
+		/// perform one randomly chosen transition in a cluster
+		void fire_transition(ChannelCluster& cl);
+
+		/// advance a cluster by tau-leaping
+		void tau_leap(ChannelCluster& cl, number dt);
+
+		/// channel mouth calcium (mM) for a stochastic cluster at the given channel vertex
+		number cluster_calcium(const vector_type& u, size_t v, const ChannelCluster& cl) const;
+
+		number rand_uniform();
+		number rand_normal();
+		size_t rand_poisson(number mean);
+
 	protected:
 		std::vector<std::string> m_vSubsetNames;
 		std::vector<int> m_vSI;
@@ -207,6 +371,37 @@ class RyRDiscrete
 		std::vector<size_t> m_vFctMap;
 
 		number m_cutoffOpenProb;
+
+		/// DoF indices of all channel vertices (5 consecutive entries per vertex)
+		std::vector<DoFIndex> m_vCachedDI;
+		const DoFDistribution* m_pIndexCacheDD;
+		bool m_bIndexCacheValid;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+
+		bool m_bStochastic;
+		size_t m_nChPerCluster;
+		size_t m_tauLeapThreshold;
+		number m_caRescaleTol;
+		uint64_t m_rngState;
+
+		std::vector<ChannelCluster> m_vCluster;		///< clusters in order of m_vCachedDI
+		std::vector<event_type> m_vEventQueue;		///< heap of (event time, cluster index)
+		number m_stochTime;
+		bool m_bClustersInit;
+
+		std::vector<ChannelCluster> m_vClusterSnapshot;		///< cluster states at the beginning of the current step
+		std::vector<event_type> m_vEventQueueSnapshot;		///< event queue at the beginning of the current step
+		uint64_t m_snapshotRngState;
+		number m_snapshotTime;
+		bool m_bSnapshotValid;
+
+		number m_mfRadius;
+		std::vector<size_t> m_vMFClusterOffset;		///< start of each cluster in m_vMFClusterVrt (plus end)
+		std::vector<size_t> m_vMFClusterVrt;		///< channel vertices (in order of m_vCachedDI) by cluster, representative first
+
+		number m_ndFactor;		///< nanodomain concentration increase per channel current (mM s / mol)
 };
 
 ///@}
@@ -60,7 +60,8 @@ RyRImplicit(const std::vector<std::string>& fcts, const std::vector<std::string>
   m_nTSteps(1),
 #endif
   m_bNonRegularGrid(false),
-  m_bCurrElemIsHSlave(false)
+  m_bCurrElemIsHSlave(false),
+  m_pCurrGeom(NULL)
 {}
 
 template <typename TDomain>
@@ -77,7 +78,8 @@ RyRImplicit<TDomain>::RyRImplicit(const char* fcts, const char* subsets)
   m_nTSteps(1),
 #endif
   m_bNonRegularGrid(false),
-  m_bCurrElemIsHSlave(false)
+  m_bCurrElemIsHSlave(false),
+  m_pCurrGeom(NULL)
 {}
 
 
@@ -148,7 +150,8 @@ void RyRImplicit<TDomain>::calc_flux_deriv(const std::vector<number>& u, GridObj
 	number pOpenPart = 1.0 - (c1 + c2);
 	number calciumPart = caER - caCyt;
 	number deriv_value_ca = pOpenPart * constFactor;
-	number deriv_value_states = calciumPart * constFactor;
+	// frozen gating Jacobian: open probability is constant within the linearization
+	number deriv_value_states = frozen_gating_jacobian() ? 0.0 : calciumPart * constFactor;
 
 	size_t i = 0;
 	if (!has_constant_value(_CCYT_))
@@ -210,6 +213,16 @@ const std::string RyRImplicit<TDomain>::name() const
 };
 
 
+template<typename TDomain>
+void RyRImplicit<TDomain>::report_memory(MemoryReport& rep) const
+{
+	if (m_spGeomCache.valid())
+		rep.add("geometry cache (shared)", m_spGeomCache->memory_bytes());
+	if (m_frozenJac.enabled())
+		rep.add("frozen Jacobian entries", m_frozenJac.memory_bytes());
+}
+
+
 template <typename TDomain>
 void RyRImplicit<TDomain>::check_supplied_functions() const
 {
@@ -254,6 +267,28 @@ void RyRImplicit<TDomain>::print_units() const
 
 
 
+template <typename TDomain>
+void RyRImplicit<TDomain>::set_geometry_cache(SmartPtr<ManifoldGeometryCache<TDomain> > spCache)
+{
+	m_spGeomCache = spCache;
+}
+
+
+template <typename TDomain>
+void RyRImplicit<TDomain>::set_frozen_jacobian(number relTol)
+{
+	m_frozenJac.set_tolerance(relTol);
+}
+
+
+template <typename TDomain>
+void RyRImplicit<TDomain>::set_conductance(number mu)
+{
+	MU_RYR = mu;
+	parameters_changed();
+}
+
+
 template <typename TDomain>
 void RyRImplicit<TDomain>::prepare_setting(const std::vector<LFEID>& vLfeID, bool bNonRegularGrid)
 {
@@ -265,6 +300,15 @@ void RyRImplicit<TDomain>::prepare_setting(const std::vector<LFEID>& vLfeID, boo
 	// update assemble functions
 	m_bNonRegularGrid = bNonRegularGrid;
 	register_all_fv1_funcs();
+
+	m_vFrozenJacIn.ensure_capacity();
+	m_vFrozenJacEntries.ensure_capacity();
+
+	// instrumentation
+	NC_HOT_PATH_LABEL(m_hpDefA, "RyRImplicit::add_def_A_elem", this->name(), hot_path_subset_label(this->symb_subsets()));
+	NC_HOT_PATH_LABEL(m_hpJacA, "RyRImplicit::add_jac_A_elem", this->name(), hot_path_subset_label(this->symb_subsets()));
+	NC_HOT_PATH_PREPARE_THREADS(m_hpDefA);
+	NC_HOT_PATH_PREPARE_THREADS(m_hpJacA);
 }
 
 
@@ -274,10 +318,15 @@ bool RyRImplicit<TDomain>::use_hanging() const
 	return true;
 }
 
-#if 0
+
 template <typename TDomain>
 void RyRImplicit<TDomain>::approximation_space_changed()
 {
+	// stored Jacobian entries do not survive grid changes
+	m_frozenJac.clear();
+	m_frozenJac.register_grid(*this->approx_space()->domain()->grid());
+
+#if 0
 	m_dd = this->approx_space()->dof_distribution(GridLevel(), false);
 
     // get global fct index for ccyt function
@@ -288,8 +337,9 @@ void RyRImplicit<TDomain>::approximation_space_changed()
     m_globInd[_O2_] = fctGrp.unique_id(_O2_);
     m_globInd[_C1_] = fctGrp.unique_id(_C1_);
     m_globInd[_C2_] = fctGrp.unique_id(_C2_);
-}
 #endif
+}
+
 
 template <typename TDomain>
 template <typename TElem, typename TFVGeom>
@@ -316,9 +366,12 @@ prep_elem(const LocalVector& u, GridObject* elem, const ReferenceObjectID roid,
 	// on horizontal interfaces: only treat hmasters
 	if (m_bCurrElemIsHSlave) return;
 
-	// update geometry for this element
-	static TFVGeom& geo = GeomProvider<TFVGeom>::get();
-	try {geo.update(elem, vCornerCoords, &(this->subset_handler()));}
+	// update geometry for this element (or take it from the cache)
+	try
+	{
+		m_pCurrGeom = prepare_manifold_geometry<TFVGeom>(m_spGeomCache.get(), m_localGeom,
+			elem, vCornerCoords, &(this->subset_handler()));
+	}
 	UG_CATCH_THROW("RyRImplicit::prep_elem: Cannot update finite volume geometry.");
 }
 
@@ -333,18 +386,20 @@ void RyRImplicit<TDomain>::add_def_A_elem
 	const MathVector<dim> vCornerCoords[]
 )
 {
+	NC_HOT_PATH_SCOPE(m_hpDefA);
+
 	// on horizontal interfaces: only treat hmasters
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -426,14 +481,14 @@ void RyRImplicit<TDomain>::add_def_M_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -461,18 +516,44 @@ void RyRImplicit<TDomain>::add_jac_A_elem
 	const MathVector<dim> vCornerCoords[]
 )
 {
+	NC_HOT_PATH_SCOPE(m_hpJacA);
+
 	// on horizontal interfaces: only treat hmasters
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
+	const size_t nBF = fvgeom.num_bf();
+
+	// frozen Jacobian: reuse stored entries if the unknowns have not changed much
+	// (11 entries per boundary face, in the order they are added below)
+	const bool bFrozen = m_frozenJac.enabled();
+	bool bReuse = false;
+	std::vector<number>& vIn = m_vFrozenJacIn.local();
+	std::vector<number>& vEntries = m_vFrozenJacEntries.local();
+	number localJac[11];
+	if (bFrozen)
+	{
+		vIn.resize(4*nBF);
+		for (size_t i = 0; i < nBF; ++i)
+		{
+			const int co = fvgeom.bf(i).node_id();
+			vIn[4*i] = u(_CCYT_, co);
+			vIn[4*i+1] = u(_O2_, co);
+			vIn[4*i+2] = u(_C1_, co);
+			vIn[4*i+3] = u(_C2_, co);
+		}
+		bReuse = m_frozenJac.lookup(elem, vIn, vEntries) && vEntries.size() == 11*nBF;
+		if (!bReuse)
+			vEntries.resize(11*nBF);
+	}
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
-	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
+	for (size_t i = 0; i < nBF; ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -544,23 +625,44 @@ void RyRImplicit<TDomain>::add_jac_A_elem
 			J(_C2_, co, _C2_, co) += (KCplus + KCminus) * fac1;
 		}
 #endif
-		number ca_cyt = u(_CCYT_, co) * scale_input(_CCYT_);
-		number o1 = 1.0 - (u(_O2_, co) + u(_C1_, co) + u(_C2_, co));
+		number* jac = bFrozen ? &vEntries[i * 11] : localJac;
+		if (!bReuse)
+		{
+			number ca_cyt = u(_CCYT_, co) * scale_input(_CCYT_);
+			number o1 = 1.0 - (u(_O2_, co) + u(_C1_, co) + u(_C2_, co));
+
+			jac[0] = -KBplus * 3.0 * ca_cyt*ca_cyt * scale_input(_CCYT_) * o1 * bf.volume();
+			jac[1] = (KBminus + KBplus * ca_cyt*ca_cyt*ca_cyt) * bf.volume();
+			jac[2] = KBplus * ca_cyt*ca_cyt*ca_cyt * bf.volume();
+			jac[3] = KBplus * ca_cyt*ca_cyt*ca_cyt * bf.volume();
+
+			jac[4] = KAplus * 4.0 * ca_cyt*ca_cyt*ca_cyt * scale_input(_CCYT_) * u(_C1_, co) * bf.volume();
+			jac[5] = KAminus * bf.volume();
+			jac[6] = (KAminus + KAplus * ca_cyt*ca_cyt*ca_cyt*ca_cyt) * bf.volume();
+			jac[7] = KAminus * bf.volume();
+
+			jac[8] = KCplus * bf.volume();
+			jac[9] = KCplus * bf.volume();
+			jac[10] = (KCplus + KCminus) * bf.volume();
+		}
 
-		J(_O2_, co, _CCYT_, co) -= KBplus * 3.0 * ca_cyt*ca_cyt * scale_input(_CCYT_) * o1 * bf.volume();
-		J(_O2_, co, _O2_, co) += (KBminus + KBplus * ca_cyt*ca_cyt*ca_cyt) * bf.volume();
-		J(_O2_, co, _C1_, co) += KBplus * ca_cyt*ca_cyt*ca_cyt * bf.volume();
-		J(_O2_, co, _C2_, co) += KBplus * ca_cyt*ca_cyt*ca_cyt * bf.volume();
+		J(_O2_, co, _CCYT_, co) += jac[0];
+		J(_O2_, co, _O2_, co) += jac[1];
+		J(_O2_, co, _C1_, co) += jac[2];
+		J(_O2_, co, _C2_, co) += jac[3];
 
-		J(_C1_, co, _CCYT_, co) += KAplus * 4.0 * ca_cyt*ca_cyt*ca_cyt * scale_input(_CCYT_) * u(_C1_, co) * bf.volume();
-		J(_C1_, co, _O2_, co) += KAminus * bf.volume();
-		J(_C1_, co, _C1_, co) += (KAminus + KAplus * ca_cyt*ca_cyt*ca_cyt*ca_cyt) * bf.volume();
-		J(_C1_, co, _C2_, co) += KAminus * bf.volume();
+		J(_C1_, co, _CCYT_, co) += jac[4];
+		J(_C1_, co, _O2_, co) += jac[5];
+		J(_C1_, co, _C1_, co) += jac[6];
+		J(_C1_, co, _C2_, co) += jac[7];
 
-		J(_C2_, co, _O2_, co) += KCplus * bf.volume();
-		J(_C2_, co, _C1_, co) += KCplus * bf.volume();
-		J(_C2_, co, _C2_, co) += (KCplus + KCminus) * bf.volume();
+		J(_C2_, co, _O2_, co) += jac[8];
+		J(_C2_, co, _C1_, co) += jac[9];
+		J(_C2_, co, _C2_, co) += jac[10];
 	}
+
+	if (bFrozen && !bReuse)
+		m_frozenJac.store(elem, vIn, vEntries);
 }
 
 
@@ -578,14 +680,14 @@ void RyRImplicit<TDomain>::add_jac_M_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
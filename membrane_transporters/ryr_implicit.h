@@ -43,6 +43,8 @@
 #include "membrane_transporter_interface.h"
 #include "lib_disc/spatial_disc/elem_disc/elem_disc_interface.h"
 #include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
+#include "../util/manifold_geometry_cache.h"  // for ManifoldGeometryCache
+#include "../util/frozen_jacobian.h"  // for FrozenJacobianStore
 
 
 namespace ug {
@@ -106,7 +108,7 @@ class RyRImplicit
 		const number KAminus;	// C1 <-- O1
 		const number KBminus;	// O1 <-- O2
 		const number KCminus;	// O1 <-- C2
-		const number MU_RYR;	// RyR channel conductance
+		number MU_RYR;	// RyR channel conductance
 
 		const number REF_CA_ER;		// reference endoplasmic Ca2+ concentration (for conductances)
 
@@ -144,6 +146,9 @@ class RyRImplicit
 		/// @copydoc IMembraneTransporter::name()
 		virtual const std::string name() const override;
 
+		/// @copydoc IMembraneTransporter::report_memory()
+		virtual void report_memory(MemoryReport& rep) const override;
+
 		/// @copydoc IMembraneTransporter::check_supplied_functions()
 		virtual void check_supplied_functions() const override;
 
@@ -155,6 +160,34 @@ class RyRImplicit
 		template <typename TGridFunction> // this is supposed to be some algebra_type::vector_type
 		void calculate_steady_state(SmartPtr<TGridFunction> u) const;
 
+	public:
+		/**
+		 * @brief Use a (shared) cache for the membrane element geometry
+		 *
+		 * If set, the boundary faces of each membrane element are computed only once
+		 * instead of in every assembling (until the grid is adapted or redistributed).
+		 * The same cache can be given to all membrane discs working on the grid.
+		 *
+		 * @param spCache  geometry cache (an invalid pointer disables caching)
+		 */
+		void set_geometry_cache(SmartPtr<ManifoldGeometryCache<TDomain> > spCache);
+
+		/**
+		 * @brief Reuse the local Jacobian of the channel state equations (modified Newton)
+		 *
+		 * If set, the stiffness Jacobian assembled for an element is kept together
+		 * with the unknowns it was computed from and added again instead of being
+		 * recomputed as long as none of these unknowns has changed by more than
+		 * the given relative tolerance (also across time steps).
+		 * The defect is always assembled with the current solution.
+		 *
+		 * @param relTol  relative tolerance (a non-positive value disables reuse)
+		 */
+		void set_frozen_jacobian(number relTol);
+
+		/// set the channel conductance (in m^3/s; can be changed between time steps)
+		void set_conductance(number mu);
+
 	// inheritances from IElemDisc
 	public:
 		/// type of trial space for each function used
@@ -162,10 +195,9 @@ class RyRImplicit
 
 		/// returns if hanging nodes are used
 		virtual bool use_hanging() const override;
-#if 0
+
 		/// @copydoc IElemDisc::approximation_space_changed()
 		virtual void approximation_space_changed() override;
-#endif
 
 	// assembling functions
 	protected:
@@ -230,6 +262,20 @@ class RyRImplicit
 #endif
 		bool m_bNonRegularGrid;
 		bool m_bCurrElemIsHSlave;
+
+		/// geometry of the current element (from cache or local)
+		SmartPtr<ManifoldGeometryCache<TDomain> > m_spGeomCache;
+		ManifoldElemGeometry m_localGeom;
+		const ManifoldElemGeometry* m_pCurrGeom;
+
+		/// stiffness Jacobian entries kept for reuse (frozen Jacobian)
+		FrozenJacobianStore m_frozenJac;
+		ThreadScratch<std::vector<number> > m_vFrozenJacIn;
+		ThreadScratch<std::vector<number> > m_vFrozenJacEntries;
+
+		/// instrumentation (if enabled)
+		NC_HOT_PATH_COUNTER(m_hpDefA)
+		NC_HOT_PATH_COUNTER(m_hpJacA)
 };
 
 
@@ -0,0 +1,584 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "ryr_implicit_condensed.h"
+
+#include <algorithm>                    // for std::swap
+#include <cmath>                        // for fabs
+
+#include "lib_grid/algorithms/debug_util.h"   // for ElementDebugInfo
+#include "lib_grid/grid/grid_base_objects.h"  // for VERTEX ...
+#include "lib_grid/tools/surface_view.h"      // for MG_ALL
+
+namespace ug {
+namespace neuro_collection {
+
+
+// solves M x = b for a 3x3 system using Gaussian elimination with partial pivoting;
+// M is overwritten, b receives the solution
+static void Solve3x3(number M[3][3], number b[3])
+{
+	for (size_t k = 0; k < 3; ++k)
+	{
+		size_t piv = k;
+		for (size_t i = k+1; i < 3; ++i)
+			if (fabs(M[i][k]) > fabs(M[piv][k]))
+				piv = i;
+		if (piv != k)
+		{
+			for (size_t j = k; j < 3; ++j)
+				std::swap(M[k][j], M[piv][j]);
+			std::swap(b[k], b[piv]);
+		}
+
+		UG_COND_THROW(M[k][k] == 0.0, "Singular local system for RyR channel states.");
+		for (size_t i = k+1; i < 3; ++i)
+		{
+			const number f = M[i][k] / M[k][k];
+			for (size_t j = k+1; j < 3; ++j)
+				M[i][j] -= f * M[k][j];
+			b[i] -= f * b[k];
+		}
+	}
+
+	for (size_t k = 3; k-- > 0;)
+	{
+		for (size_t j = k+1; j < 3; ++j)
+			b[k] -= M[k][j] * b[j];
+		b[k] /= M[k][k];
+	}
+}
+
+
+template<typename TDomain>
+RyRImplicitCondensed<TDomain>::
+RyRImplicitCondensed
+(
+	const std::vector<std::string>& fcts,
+	const std::vector<std::string>& subsets,
+	SmartPtr<ApproximationSpace<TDomain> > approx
+)
+: IMembraneTransporter(fcts),
+R(8.314), T(310.0), F(96485.0),
+KAplus(1500.0e12), KBplus(1500.0e9), KCplus(1.75),
+KAminus(28.8), KBminus(385.9), KCminus(0.1),
+MU_RYR(5.0e-11), REF_CA_ER(2.5e-1),
+m_stateTime(0.0), m_dt(0.0), m_initTime(0.0), m_initiated(false)
+{
+	construct(subsets, approx);
+}
+
+template<typename TDomain>
+RyRImplicitCondensed<TDomain>::
+RyRImplicitCondensed
+(
+	const char* fcts,
+	const char* subsets,
+	SmartPtr<ApproximationSpace<TDomain> > approx
+)
+: IMembraneTransporter(fcts),
+R(8.314), T(310.0), F(96485.0),
+KAplus(1500.0e12), KBplus(1500.0e9), KCplus(1.75),
+KAminus(28.8), KBminus(385.9), KCminus(0.1),
+MU_RYR(5.0e-11), REF_CA_ER(2.5e-1),
+m_stateTime(0.0), m_dt(0.0), m_initTime(0.0), m_initiated(false)
+{
+	construct(TokenizeString(subsets), approx);
+}
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::construct
+(
+	const std::vector<std::string>& subsets,
+	SmartPtr<ApproximationSpace<TDomain> > approx
+)
+{
+	m_dom = approx->domain();
+	m_mg = m_dom->grid();
+	m_dd = approx->dof_distribution(GridLevel(), true);
+
+// process subsets
+	std::vector<std::string> vsSubset(subsets);
+
+	//	remove white space
+	for (size_t i = 0; i < vsSubset.size(); ++i)
+		RemoveWhitespaceFromString(vsSubset[i]);
+
+	//	if no subset passed, clear subsets
+	if (vsSubset.size() == 1 && vsSubset[0].empty())
+		vsSubset.clear();
+
+	//	if subsets passed with separator, but not all tokens filled, throw error
+	for (size_t i = 0; i < vsSubset.size(); ++i)
+	{
+		if (vsSubset[i].empty())
+		{
+			UG_THROW("Error while setting subsets in " << name() << ": passed "
+					 "subset string lacks a subset specification at position "
+					 << i << "(of " << vsSubset.size()-1 << ")");
+		}
+	}
+
+	SubsetGroup ssGrp;
+	try { ssGrp = SubsetGroup(m_dom->subset_handler(), vsSubset);}
+	UG_CATCH_THROW("Subset group creation failed.");
+
+	for (std::size_t si = 0; si < ssGrp.size(); si++)
+		m_vSubset.push_back(ssGrp[si]);
+
+// manage attachments
+	if (m_mg->template has_attachment<Vertex>(this->m_aO2))
+		UG_THROW("Attachment necessary for RyR channel dynamics "
+				 "could not be created, since it already exists.");
+	m_mg->template attach_to<Vertex>(this->m_aO2);
+
+	if (m_mg->template has_attachment<Vertex>(this->m_aC1))
+		UG_THROW("Attachment necessary for RyR channel dynamics "
+				 "could not be created, since it already exists.");
+	m_mg->template attach_to<Vertex>(this->m_aC1);
+
+	if (m_mg->template has_attachment<Vertex>(this->m_aC2))
+		UG_THROW("Attachment necessary for RyR channel dynamics "
+				 "could not be created, since it already exists.");
+	m_mg->template attach_to<Vertex>(this->m_aC2);
+
+	m_aaO2 = Grid::AttachmentAccessor<Vertex, ADouble>(*m_mg, m_aO2);
+	m_aaC1 = Grid::AttachmentAccessor<Vertex, ADouble>(*m_mg, m_aC1);
+	m_aaC2 = Grid::AttachmentAccessor<Vertex, ADouble>(*m_mg, m_aC2);
+}
+
+
+template<typename TDomain>
+RyRImplicitCondensed<TDomain>::~RyRImplicitCondensed()
+{
+	m_mg->template detach_from<Vertex>(this->m_aO2);
+	m_mg->template detach_from<Vertex>(this->m_aC1);
+	m_mg->template detach_from<Vertex>(this->m_aC2);
+}
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::solve_states(number x[3], number caCyt, number dt, number* dxdca) const
+{
+	const number ca2 = caCyt*caCyt;
+	const number a = KAplus * ca2*ca2;		// C1 --> O1
+	const number b = KBplus * ca2*caCyt;	// O1 --> O2
+
+	// the Markov chain is linear in the states (with o1 = 1 - o2 - c1 - c2):
+	//     d/dt (o2 c1 c2)^T = A (o2 c1 c2)^T + r
+	const number A[3][3] =
+	{
+		{-(b + KBminus), -b, -b},
+		{-KAminus, -(KAminus + a), -KAminus},
+		{-KCplus, -KCplus, -(KCplus + KCminus)}
+	};
+	const number r[3] = {b, KAminus, KCplus};
+
+	// backward step (explicit)
+	if (dt < 0.0)
+	{
+		const number xOld[3] = {x[0], x[1], x[2]};
+		for (size_t i = 0; i < 3; ++i)
+			x[i] = xOld[i] + dt * (A[i][0]*xOld[0] + A[i][1]*xOld[1] + A[i][2]*xOld[2] + r[i]);
+
+		if (dxdca)
+		{
+			const number o1 = 1.0 - (xOld[0] + xOld[1] + xOld[2]);
+			dxdca[0] = dt * 3.0*KBplus*ca2 * o1;
+			dxdca[1] = -dt * 4.0*KAplus*ca2*caCyt * xOld[1];
+			dxdca[2] = 0.0;
+		}
+		return;
+	}
+
+	// forward step (implicit): (I - dt A) x_new = x_old + dt r
+	number M[3][3];
+	for (size_t i = 0; i < 3; ++i)
+	{
+		for (size_t j = 0; j < 3; ++j)
+			M[i][j] = -dt * A[i][j];
+		M[i][i] += 1.0;
+		x[i] += dt * r[i];
+	}
+
+	// keep the matrix for the derivative
+	number M2[3][3];
+	if (dxdca)
+		for (size_t i = 0; i < 3; ++i)
+			for (size_t j = 0; j < 3; ++j)
+				M2[i][j] = M[i][j];
+
+	Solve3x3(M, x);
+
+	// derivative: (I - dt A) dx/dca = dt (dA/dca x_new + dr/dca)
+	if (dxdca)
+	{
+		const number o1 = 1.0 - (x[0] + x[1] + x[2]);
+		dxdca[0] = dt * 3.0*KBplus*ca2 * o1;
+		dxdca[1] = -dt * 4.0*KAplus*ca2*caCyt * x[1];
+		dxdca[2] = 0.0;
+		Solve3x3(M2, dxdca);
+	}
+}
+
+
+template <typename TDomain>
+void RyRImplicitCondensed<TDomain>::prepare_timestep(number future_time, const number time, VectorProxyBase* upb)
+{
+	// before the first step: initiate to equilibrium (or init again; stationary case)
+	if (!m_initiated || future_time == m_initTime)
+		init(time, upb);
+
+	// the solution given is the converged one for the start of the new step:
+	// bring the states to this point in time (unless they already are)
+	if (time != m_stateTime)
+		update_states(time, upb);
+
+	m_dt = future_time - time;
+}
+
+
+template <typename TDomain>
+void RyRImplicitCondensed<TDomain>::init_to_steady_state(number time, VectorProxyBase* upb)
+{
+	init(time, upb);
+}
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::update_states(number time, VectorProxyBase* upb)
+{
+	const number dt = time - m_stateTime;
+
+	// get global fct index for ccyt function
+	FunctionGroup fctGrp(m_dd->dof_distribution_info());
+	fctGrp.add(this->m_vFct);
+	size_t ind_ccyt = fctGrp.unique_id(_CCYT_);
+
+	// for DoF index storage
+	std::vector<DoFIndex> dofIndex;
+
+	typedef typename DoFDistribution::traits<Vertex>::const_iterator it_type;
+	size_t si_sz = m_vSubset.size();
+	for (size_t si = 0; si < si_sz; ++si)
+	{
+		it_type it = m_dd->begin<Vertex>(m_vSubset[si], SurfaceView::MG_ALL); // shadow rim copy are required!
+		it_type it_end = m_dd->end<Vertex>(m_vSubset[si], SurfaceView::MG_ALL);
+
+		for (; it != it_end; ++it)
+		{
+			// get ca_cyt
+			number ca_cyt = 0.0;
+			if (!this->has_constant_value(_CCYT_, ca_cyt))
+			{
+				// we suppose our approx space to be 1st order Lagrange (linear, DoFs in the vertices)
+				m_dd->dof_indices(*it, ind_ccyt, dofIndex, true, true);
+				UG_ASSERT(dofIndex.size() == 1, "Not exactly 1 DoF found for function " << ind_ccyt
+					<< " in vertex " << ElementDebugInfo(*m_mg, *it));
+				ca_cyt = upb->evaluate(dofIndex[0]);
+			}
+			// else the constant value has been written to ca_cyt by has_constant_value()
+
+			// scale by appropriate factor for correct unit
+			ca_cyt *= this->scale_input(_CCYT_);
+
+			number x[3] = {m_aaO2[*it], m_aaC1[*it], m_aaC2[*it]};
+			solve_states(x, ca_cyt, dt);
+			m_aaO2[*it] = x[0];
+			m_aaC1[*it] = x[1];
+			m_aaC2[*it] = x[2];
+		}
+	}
+
+	m_stateTime = time;
+}
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::init(number time, VectorProxyBase* upb)
+{
+	m_stateTime = time;
+	m_initTime = time;
+	m_dt = 0.0;
+
+	// get global fct index for ccyt function
+	FunctionGroup fctGrp(m_dd->dof_distribution_info());
+	fctGrp.add(this->m_vFct);
+	size_t ind_ccyt = fctGrp.unique_id(_CCYT_);
+
+	// for DoF index storage
+	std::vector<DoFIndex> dofIndex;
+
+	typedef typename DoFDistribution::traits<Vertex>::const_iterator it_type;
+	size_t si_sz = m_vSubset.size();
+	for (size_t si = 0; si < si_sz; ++si)
+	{
+		it_type it = m_dd->begin<Vertex>(m_vSubset[si], SurfaceView::MG_ALL); // shadow rim copy are required!
+		it_type it_end = m_dd->end<Vertex>(m_vSubset[si], SurfaceView::MG_ALL);
+
+		for (; it != it_end; ++it)
+		{
+			// get ca_cyt
+			number ca_cyt = 0.0;
+			if (!this->has_constant_value(_CCYT_, ca_cyt))
+			{
+				// we suppose our approx space to be 1st order Lagrange (linear, DoFs in the vertices)
+				m_dd->dof_indices(*it, ind_ccyt, dofIndex, true, true);
+				UG_ASSERT(dofIndex.size() == 1, "Not exactly 1 DoF found for function " << ind_ccyt
+					<< " in vertex " << ElementDebugInfo(*m_mg, *it));
+				ca_cyt = upb->evaluate(dofIndex[0]);
+			}
+			// else the constant value has been written to ca_cyt by has_constant_value()
+
+			// scale by appropriate factor for correct unit
+			ca_cyt *= this->scale_input(_CCYT_);
+
+			// calculate equilibrium
+			number KA = KAplus/KAminus * ca_cyt*ca_cyt*ca_cyt*ca_cyt;
+			number KB = KBplus/KBminus * ca_cyt*ca_cyt*ca_cyt;
+			number KC = KCplus/KCminus;
+
+			number denom_inv = 1.0 / (1.0 + KC + 1.0/KA + KB);
+
+			m_aaO2[*it] = KB * denom_inv;
+			m_aaC1[*it] = denom_inv / KA;
+			m_aaC2[*it] = KC * denom_inv;
+		}
+	}
+
+	m_initiated = true;
+}
+
+
+template<typename TDomain>
+template<typename TBaseElem>
+void RyRImplicitCondensed<TDomain>::old_states(GridObject* o, number x[3]) const
+{
+	TBaseElem* e = static_cast<TBaseElem*>(o);
+	x[0] = x[1] = x[2] = 0.0;
+	const size_t nVrt = e->num_vertices();
+	for (size_t v = 0; v < nVrt; ++v)
+	{
+		Vertex* vrt = e->vertex(v);
+		x[0] += m_aaO2[vrt];
+		x[1] += m_aaC1[vrt];
+		x[2] += m_aaC2[vrt];
+	}
+	for (size_t i = 0; i < 3; ++i)
+		x[i] /= nVrt;
+}
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::old_states_for_grid_object(GridObject* o, number x[3]) const
+{
+	switch (o->base_object_id())
+	{
+		case VERTEX:
+		{
+			Vertex* vrt = static_cast<Vertex*>(o);
+			x[0] = m_aaO2[vrt];
+			x[1] = m_aaC1[vrt];
+			x[2] = m_aaC2[vrt];
+			return;
+		}
+		case EDGE:
+			old_states<Edge>(o, x);
+			return;
+		case FACE:
+			old_states<Face>(o, x);
+			return;
+		default:
+		{
+			UG_THROW("Base object id must be VERTEX, EDGE or FACE, but is "
+				<< o->base_object_id() << ".");
+		}
+	}
+}
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const
+{
+	number caCyt = u[_CCYT_];	// cytosolic Ca2+ concentration
+	number caER = u[_CER_];		// ER Ca2+ concentration
+
+	// membrane current corresponding to diffusion pressure
+	number current = R*T/(4*F*F) * MU_RYR/REF_CA_ER * (caER - caCyt);
+
+	// channel states at the new time
+	number x[3];
+	old_states_for_grid_object(e, x);
+	solve_states(x, caCyt, m_dt);
+
+	// open probability
+	number pOpen = 1.0 - (x[1] + x[2]);
+
+	flux[0] = pOpen * current;
+}
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const
+{
+	number caCyt = u[_CCYT_];	// cytosolic Ca2+ concentration
+	number caER = u[_CER_];		// ER Ca2+ concentration
+
+	// channel states at the new time and their derivatives w.r.t. cytosolic calcium
+	number x[3];
+	number dxdca[3];
+	old_states_for_grid_object(e, x);
+	solve_states(x, caCyt, m_dt, dxdca);
+
+	number constFactor = R*T/(4*F*F) * MU_RYR/REF_CA_ER;
+	number pOpen = 1.0 - (x[1] + x[2]);
+	number dpOpen_dca = -(dxdca[1] + dxdca[2]);
+	number deriv_value = pOpen * constFactor;
+
+	size_t i = 0;
+	if (!has_constant_value(_CCYT_))
+	{
+		flux_derivs[0][i].first = local_fct_index(_CCYT_);
+		flux_derivs[0][i].second = -deriv_value + dpOpen_dca * constFactor * (caER - caCyt);
+		++i;
+	}
+	if (!has_constant_value(_CER_))
+	{
+		flux_derivs[0][i].first = local_fct_index(_CER_);
+		flux_derivs[0][i].second = deriv_value;
+		++i;
+	}
+}
+
+
+template<typename TDomain>
+size_t RyRImplicitCondensed<TDomain>::n_dependencies() const
+{
+	size_t n = 2;
+	if (has_constant_value(_CCYT_))
+		n--;
+	if (has_constant_value(_CER_))
+		n--;
+
+	return n;
+}
+
+
+template<typename TDomain>
+size_t RyRImplicitCondensed<TDomain>::n_fluxes() const
+{
+	return 1;
+};
+
+
+template<typename TDomain>
+const std::pair<size_t,size_t> RyRImplicitCondensed<TDomain>::flux_from_to(size_t flux_i) const
+{
+    size_t from, to;
+    if (is_supplied(_CCYT_)) to = local_fct_index(_CCYT_); else to = InnerBoundaryConstants::_IGNORE_;
+    if (is_supplied(_CER_)) from = local_fct_index(_CER_); else from = InnerBoundaryConstants::_IGNORE_;
+
+    return std::pair<size_t, size_t>(from, to);
+}
+
+
+template<typename TDomain>
+const std::string RyRImplicitCondensed<TDomain>::name() const
+{
+	return std::string("RyRImplicitCondensed");
+};
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::check_supplied_functions() const
+{
+	// Check that not both, inner and outer calcium concentrations are not supplied;
+	// in that case, calculation of a flux would be of no consequence.
+	if (!is_supplied(_CCYT_) && !is_supplied(_CER_))
+	{
+		UG_THROW("Supplying neither cytosolic nor endoplasmic calcium concentrations is not allowed.\n"
+				"This would mean that the flux calculation would be of no consequence\n"
+				"and this channel would not do anything.");
+	}
+}
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::print_units() const
+{
+	std::string nm = name();
+	size_t n = nm.size();
+	UG_LOG(std::endl);
+	UG_LOG("+------------------------------------------------------------------------------+"<< std::endl);
+	UG_LOG("|  Units used in the implementation of " << nm << std::string(n>=40?0:40-n, ' ') << "|" << std::endl);
+	UG_LOG("|------------------------------------------------------------------------------|"<< std::endl);
+	UG_LOG("|    Input                                                                     |"<< std::endl);
+	UG_LOG("|      [Ca_cyt]  mM (= mol/m^3)                                                |"<< std::endl);
+	UG_LOG("|      [Ca_er]   mM (= mol/m^3)                                                |"<< std::endl);
+	UG_LOG("|                                                                              |"<< std::endl);
+	UG_LOG("|    Output                                                                    |"<< std::endl);
+	UG_LOG("|      Ca flux   mol/s                                                         |"<< std::endl);
+	UG_LOG("+------------------------------------------------------------------------------+"<< std::endl);
+	UG_LOG(std::endl);
+}
+
+
+template<typename TDomain>
+void RyRImplicitCondensed<TDomain>::set_conductance(number mu)
+{
+	MU_RYR = mu;
+	parameters_changed();
+}
+
+
+// explicit template specializations
+#ifdef UG_DIM_1
+	template class RyRImplicitCondensed<Domain1d>;
+#endif
+#ifdef UG_DIM_2
+	template class RyRImplicitCondensed<Domain2d>;
+#endif
+#ifdef UG_DIM_3
+	template class RyRImplicitCondensed<Domain3d>;
+#endif
+
+
+} // namespace neuro_collection
+} // namespace ug
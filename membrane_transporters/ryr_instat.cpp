@@ -43,6 +43,9 @@
 #include "lib_grid/grid/grid_base_objects.h"  // for VERTEX ...
 #include "lib_grid/tools/surface_view.h"      // for MG_ALL
 
+#include <algorithm>                          // for std::min
+#include <limits>                             // for std::numeric_limits
+
 namespace ug {
 namespace neuro_collection {
 
@@ -164,6 +167,10 @@ void RyRinstat<TDomain>::construct
 	m_aaC2 = Grid::AttachmentAccessor<Vertex, ADouble>(*m_mg, m_aC2);
 	m_aaOavg = Grid::AttachmentAccessor<Vertex, ANumber>(*m_mg, m_aOavg);
 	m_aaCaOld = Grid::AttachmentAccessor<Vertex, ANumber>(*m_mg, m_aCaOld);
+
+	// vertex slots (and their calcium DoFs) are set up anew after each grid change
+	m_stateStore.set_num_states(_GS_NUM_);
+	m_stateStore.register_grid_callbacks(*m_mg);
 }
 
 
@@ -179,27 +186,22 @@ RyRinstat<TDomain>::~RyRinstat()
 
 
 template <typename TDomain>
-void RyRinstat<TDomain>::prepare_timestep(number future_time, const number time, VectorProxyBase* upb)
+void RyRinstat<TDomain>::rebuild_state_store()
 {
-	// before the first step: initiate to equilibrium (or init again; stationary case)
-	if (!m_initiated || future_time == m_initTime)
-		init(time, upb);
+	// get global fct index for ccyt function
+	FunctionGroup fctGrp(m_dd->dof_distribution_info());
+	fctGrp.add(this->m_vFct);
+	const size_t ind_ccyt = fctGrp.unique_id(_CCYT_);
+	const bool bCaConst = this->has_constant_value(_CCYT_);
 
-    // get global fct index for ccyt function
-    FunctionGroup fctGrp(m_dd->dof_distribution_info());
-    fctGrp.add(this->m_vFct);
-    size_t ind_ccyt = fctGrp.unique_id(_CCYT_);
+	m_stateStore.clear();
+	m_vCaDoF.clear();
 
-	// for DoF index storage
 	std::vector<DoFIndex> dofIndex;
-
-	// update time
-	m_time = future_time;
-	number dt = m_time - time;
-
-	// loop sides and update potential and then gatings
 	typedef typename DoFDistribution::traits<Vertex>::const_iterator it_type;
 
+	// vertices shared by several subsets are only updated once
+	m_mg->begin_marking();
 	size_t si_sz = m_vSubset.size();
 	for (size_t si = 0; si < si_sz; ++si)
 	{
@@ -208,190 +210,259 @@ void RyRinstat<TDomain>::prepare_timestep(number future_time, const number time,
 
 		for (; it != it_end; ++it)
 		{
-			number& pO2 = m_aaO2[*it];
-			number& pC2 = m_aaC2[*it];
-			number& pC1 = m_aaC1[*it];
-			number& pOavg = m_aaOavg[*it];
-			number pO1 = 1.0 - (pO2 + pC1 + pC2);
-			number& pCaOld = m_aaCaOld[*it];
-
-			// get ca_cyt
+			if (m_mg->is_marked(*it))
+				continue;
+			m_mg->mark(*it);
+			m_stateStore.add(*it);
+
+			if (bCaConst)
+				continue;
+
 			// we suppose our approx space to be 1st order Lagrange (linear, DoFs in the vertices)
-			// and interpolate value at the center of the element
-			number ca_cyt = 0.0;
-            if (!this->has_constant_value(_CCYT_, ca_cyt))
-            {
-                // we suppose our approx space to be 1st order Lagrange (linear, DoFs in the vertices)
-                m_dd->dof_indices(*it, ind_ccyt, dofIndex, true, true);
-                UG_ASSERT(dofIndex.size() == 1, "Not exactly 1 DoF found for function " << ind_ccyt
-                	<< " in vertex " << ElementDebugInfo(*m_mg, *it));
-                ca_cyt = upb->evaluate(dofIndex[0]);
-            }
-            // else the constant value has been written to ca_cyt by has_constant_value()
-
-            // scale by appropriate factor for correct unit
-            ca_cyt *= this->scale_input(_CCYT_);
-
-            // approximate the Ca derivative and retain the calcium value for future time step
-            const number caDeriv = (ca_cyt - pCaOld) / dt;
-            pCaOld = ca_cyt;
-
-
-			// We use backwards Euler here to evolve o1, o2, c1, c2:
-			// the following relation must hold:
-			//
-			//     u_new = u_old + dt * Au_new
-			//
-			// where u_new, u_old are three-component vectors belonging to o2, c1, c2,
-			// A is a 3x4 matrix defined by the Markov model and u is the vector
-			// (1 o2_new c1_new c2_new)^T.
-			// Additionally, we always need o1+o2+c1+c2 = 1, which becomes the first equation.
-			// This is equivalent to solving the system:
-			//
-			//     (  1    1    1    1   )  (o1_new)   (   1  )
-			//     ( -b1  1+b2  0    0   )  (o2_new)   (o2_old)
-			//     ( -a2   0   1+a1  0   )  (c1_new) = (c1_old)
-			//     ( -c1   0    0   1+c2 )  (c2_new)   (c2_old)
-			//
-			// with coefficients as defined in the code directly below.
-			// We solve this by transformation into a lower-left triangular matrix
-			// (i.e., solving for o1_new) and then inverting the rest iteratively.
-            number inner_dt = dt;
-            size_t nSteps = 1;
-            const number thresh = 1e-6;
-            if (fabs(inner_dt) > thresh)
-            {
-            	nSteps = (size_t) ceil(fabs(dt) / thresh);
-            	inner_dt = dt / nSteps;
-            }
-
-            // forward step (implicit)
-            if (inner_dt > 0)
-            {
-            	pOavg = 0.0;
-				for (size_t i = 0; i < nSteps; ++i)
-				{
-					// estimate current calcium
-					ca_cyt += caDeriv*inner_dt;
-
-					const number a1 = inner_dt * KAplus * ca_cyt*ca_cyt*ca_cyt*ca_cyt;
-					const number a2 = inner_dt * KAminus;
-					const number b1 = inner_dt * KBplus * ca_cyt*ca_cyt*ca_cyt;
-					const number b2 = inner_dt * KBminus;
-					const number c1 = inner_dt * KCplus;
-					const number c2 = inner_dt * KCminus;
-
-					pO1 = (1.0 - pO2/(1.0+b2) - pC1/(1.0+a1) - pC2/(1.0+c2))
-						/ (1.0 + b1/(1.0+b2)  + a2/(1.0+a1)  + c1/(1.0+c2));
-
-					pO2 = (pO2 + b1*pO1) / (1.0 + b2);
-					pC1 = (pC1 + a2*pO1) / (1.0 + a1);
-					pC2 = 1.0 - (pO1 + pO2 + pC1); // make sure sum is 1;
-
-					pOavg += inner_dt * (pO1 + pO2);
-				}
-				pOavg /= dt;
-            }
-
-            // backward step (explicit)
-            else if (inner_dt < 0)
-            {
-            	for (size_t i = 0; i < nSteps; ++i)
-				{
-            		// TODO: this might be very wrong if the previous forward step was large
-					// estimate current calcium
-					ca_cyt -= caDeriv*inner_dt;
-
-					const number a1 = inner_dt * KAplus * ca_cyt*ca_cyt*ca_cyt*ca_cyt;
-					const number a2 = inner_dt * KAminus;
-					const number b1 = inner_dt * KBplus * ca_cyt*ca_cyt*ca_cyt;
-					const number b2 = inner_dt * KBminus;
-					const number c1 = inner_dt * KCplus;
-					const number c2 = inner_dt * KCminus;
-
-					pC2 += c2 * pC2 - c1 * pO1;
-					pC1 += a1 * pC1 - a2 * pO1;
-					pO2 += b2 * pO2 - b1 * pO1;
-					pO1 = 1.0 - (pO2 + pC1 + pC2);
-				}
-
-            	// TODO: How is pOavg to be treated? Atm, take constant pO1+pO2.
-            	pOavg = pO1 + pO2;
-            }
-
-            // if time step is zero, do nothing
+			m_dd->dof_indices(*it, ind_ccyt, dofIndex, true, true);
+			UG_ASSERT(dofIndex.size() == 1, "Not exactly 1 DoF found for function " << ind_ccyt
+				<< " in vertex " << ElementDebugInfo(*m_mg, *it));
+			m_vCaDoF.push_back(dofIndex[0]);
 		}
 	}
+	m_mg->end_marking();
+
+	m_stateStore.set_valid();
 }
 
 
-template<typename TDomain>
-void RyRinstat<TDomain>::init(number time, VectorProxyBase* upb)
+template <typename TDomain>
+void RyRinstat<TDomain>::gather_calcium(VectorProxyBase* upb, number* ca) const
 {
-	this->m_time = time;
-	this->m_initTime = time;
+	const long nSlots = (long) m_stateStore.size();
+	const number scale = this->scale_input(_CCYT_);
 
-	/*
-	// get solution u with which to prepare time step (this code only accepts CPUAlgebra type)
-	typedef CPUAlgebra::vector_type v_type;
-	typedef VectorProxy<v_type> vp_type;
-	vp_type* up = dynamic_cast<vp_type*>(upb);
-	UG_COND_THROW(!up, "Wrong algebra type!");
-	const v_type& u = up->m_v;
-	*/
+	number caConst = 0.0;
+	if (this->has_constant_value(_CCYT_, caConst))
+	{
+		for (long k = 0; k < nSlots; ++k)
+			ca[k] = caConst * scale;
+		return;
+	}
 
-	// get global fct index for ccyt function
-	FunctionGroup fctGrp(m_dd->dof_distribution_info());
-	fctGrp.add(this->m_vFct);
-	size_t ind_ccyt = fctGrp.unique_id(_CCYT_);
+	for (long k = 0; k < nSlots; ++k)
+		ca[k] = upb->evaluate(m_vCaDoF[k]) * scale;
+}
 
-	// for DoF index storage
-	std::vector<DoFIndex> dofIndex;
 
-	typedef typename DoFDistribution::traits<Vertex>::const_iterator it_type;
+template <typename TDomain>
+void RyRinstat<TDomain>::prepare_timestep(number future_time, const number time, VectorProxyBase* upb)
+{
+	// before the first step: initiate to equilibrium (or init again; stationary case)
+	if (!m_initiated || future_time == m_initTime)
+		init(time, upb);
 
-	size_t si_sz = m_vSubset.size();
-	for (size_t si = 0; si < si_sz; ++si)
+	if (!m_stateStore.valid())
+		rebuild_state_store();
+
+	// update time
+	m_time = future_time;
+	number dt = m_time - time;
+
+	// if time step is zero, only retain the calcium values
+	const long nSlots = (long) m_stateStore.size();
+	number* ca = m_stateStore.state(_GS_CA_);
+	gather_calcium(upb, ca);
+	if (dt == 0.0)
 	{
-		it_type it = m_dd->begin<Vertex>(m_vSubset[si], SurfaceView::MG_ALL); // shadow rim copy are required!
-		it_type it_end = m_dd->end<Vertex>(m_vSubset[si], SurfaceView::MG_ALL);
+		for (long k = 0; k < nSlots; ++k)
+			m_aaCaOld[m_stateStore.elem(k)] = ca[k];
+		return;
+	}
 
-		for (; it != it_end; ++it)
+	// gather channel states,
+	// approximate the Ca derivative and retain the calcium value for future time step
+	number* pO1 = m_stateStore.state(_GS_O1_);
+	number* pO2 = m_stateStore.state(_GS_O2_);
+	number* pC1 = m_stateStore.state(_GS_C1_);
+	number* pC2 = m_stateStore.state(_GS_C2_);
+	number* pOavg = m_stateStore.state(_GS_OAVG_);
+	number* caDeriv = m_stateStore.state(_GS_CA_DERIV_);
+	for (long k = 0; k < nSlots; ++k)
+	{
+		Vertex* vrt = m_stateStore.elem(k);
+		pO2[k] = m_aaO2[vrt];
+		pC1[k] = m_aaC1[vrt];
+		pC2[k] = m_aaC2[vrt];
+		pO1[k] = 1.0 - (pO2[k] + pC1[k] + pC2[k]);
+
+		number& pCaOld = m_aaCaOld[vrt];
+		caDeriv[k] = (ca[k] - pCaOld) / dt;
+		pCaOld = ca[k];
+	}
+
+	// We use backwards Euler here to evolve o1, o2, c1, c2:
+	// the following relation must hold:
+	//
+	//     u_new = u_old + dt * Au_new
+	//
+	// where u_new, u_old are three-component vectors belonging to o2, c1, c2,
+	// A is a 3x4 matrix defined by the Markov model and u is the vector
+	// (1 o2_new c1_new c2_new)^T.
+	// Additionally, we always need o1+o2+c1+c2 = 1, which becomes the first equation.
+	// This is equivalent to solving the system:
+	//
+	//     (  1    1    1    1   )  (o1_new)   (   1  )
+	//     ( -b1  1+b2  0    0   )  (o2_new)   (o2_old)
+	//     ( -a2   0   1+a1  0   )  (c1_new) = (c1_old)
+	//     ( -c1   0    0   1+c2 )  (c2_new)   (c2_old)
+	//
+	// with coefficients as defined in markov_step_batch().
+	// We solve this by transformation into a lower-left triangular matrix
+	// (i.e., solving for o1_new) and then inverting the rest iteratively.
+	number inner_dt = dt;
+	size_t nSteps = 1;
+	const number thresh = 1e-6;
+	if (fabs(inner_dt) > thresh)
+	{
+		nSteps = (size_t) ceil(fabs(dt) / thresh);
+		inner_dt = dt / nSteps;
+	}
+
+	// the substeps are performed blockwise, so that the states of a block
+	// stay in cache over all substeps; the loops over a block are free of
+	// branches and can be vectorized
+	const long blockSize = 256;
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (long b = 0; b < nSlots; b += blockSize)
+	{
+		const long bEnd = std::min(b + blockSize, nSlots);
+		markov_step_batch(b, bEnd, nSteps, inner_dt);
+	}
+
+	// scatter channel states
+	for (long k = 0; k < nSlots; ++k)
+	{
+		Vertex* vrt = m_stateStore.elem(k);
+		m_aaO2[vrt] = pO2[k];
+		m_aaC1[vrt] = pC1[k];
+		m_aaC2[vrt] = pC2[k];
+		m_aaOavg[vrt] = pOavg[k];
+	}
+}
+
+
+template <typename TDomain>
+void RyRinstat<TDomain>::markov_step_batch(long kBegin, long kEnd, size_t nSteps, number inner_dt)
+{
+	number* pO1 = m_stateStore.state(_GS_O1_);
+	number* pO2 = m_stateStore.state(_GS_O2_);
+	number* pC1 = m_stateStore.state(_GS_C1_);
+	number* pC2 = m_stateStore.state(_GS_C2_);
+	number* pOavg = m_stateStore.state(_GS_OAVG_);
+	number* ca = m_stateStore.state(_GS_CA_);
+	const number* caDeriv = m_stateStore.state(_GS_CA_DERIV_);
+
+	const number a2 = inner_dt * KAminus;
+	const number b2 = inner_dt * KBminus;
+	const number c1 = inner_dt * KCplus;
+	const number c2 = inner_dt * KCminus;
+
+	// forward step (implicit)
+	if (inner_dt > 0)
+	{
+		for (long k = kBegin; k < kEnd; ++k)
+			pOavg[k] = 0.0;
+
+		for (size_t i = 0; i < nSteps; ++i)
 		{
-			number& pO2 = m_aaO2[*it];
-			number& pC2 = m_aaC2[*it];
-			number& pC1 = m_aaC1[*it];
-			number& pOavg = m_aaOavg[*it];
-			number& pCaOld = m_aaCaOld[*it];
-
-			// get ca_cyt
-			number ca_cyt = 0.0;
-			if (!this->has_constant_value(_CCYT_, ca_cyt))
+			for (long k = kBegin; k < kEnd; ++k)
 			{
-				// we suppose our approx space to be 1st order Lagrange (linear, DoFs in the vertices)
-				m_dd->dof_indices(*it, ind_ccyt, dofIndex, true, true);
-                UG_ASSERT(dofIndex.size() == 1, "Not exactly 1 DoF found for function " << ind_ccyt
-                	<< " in vertex " << ElementDebugInfo(*m_mg, *it));
-                ca_cyt = upb->evaluate(dofIndex[0]);
-			}
-			// else the constant value has been written to ca_cyt by has_constant_value()
+				// estimate current calcium
+				ca[k] += caDeriv[k]*inner_dt;
 
-			// scale by appropriate factor for correct unit
-			ca_cyt *= this->scale_input(_CCYT_);
-			pCaOld = ca_cyt;
+				const number ca3 = ca[k]*ca[k]*ca[k];
+				const number a1 = inner_dt * KAplus * ca3*ca[k];
+				const number b1 = inner_dt * KBplus * ca3;
 
-			// calculate equilibrium
-			number KA = KAplus/KAminus * ca_cyt*ca_cyt*ca_cyt*ca_cyt;
-			number KB = KBplus/KBminus * ca_cyt*ca_cyt*ca_cyt;
-			number KC = KCplus/KCminus;
+				pO1[k] = (1.0 - pO2[k]/(1.0+b2) - pC1[k]/(1.0+a1) - pC2[k]/(1.0+c2))
+					/ (1.0 + b1/(1.0+b2)  + a2/(1.0+a1)  + c1/(1.0+c2));
 
-			number denom_inv = 1.0 / (1.0 + KC + 1.0/KA + KB);
+				pO2[k] = (pO2[k] + b1*pO1[k]) / (1.0 + b2);
+				pC1[k] = (pC1[k] + a2*pO1[k]) / (1.0 + a1);
+				pC2[k] = 1.0 - (pO1[k] + pO2[k] + pC1[k]); // make sure sum is 1;
 
-			pO2 = KB * denom_inv;
-			pC1 = denom_inv / KA;
-			pC2 = KC * denom_inv;
-			pOavg = 1.0 - (pC1 + pC2);
+				pOavg[k] += inner_dt * (pO1[k] + pO2[k]);
+			}
 		}
+
+		const number dt = inner_dt * nSteps;
+		for (long k = kBegin; k < kEnd; ++k)
+			pOavg[k] /= dt;
+	}
+
+	// backward step (explicit)
+	else if (inner_dt < 0)
+	{
+		for (size_t i = 0; i < nSteps; ++i)
+		{
+			for (long k = kBegin; k < kEnd; ++k)
+			{
+				// TODO: this might be very wrong if the previous forward step was large
+				// estimate current calcium
+				ca[k] -= caDeriv[k]*inner_dt;
+
+				const number ca3 = ca[k]*ca[k]*ca[k];
+				const number a1 = inner_dt * KAplus * ca3*ca[k];
+				const number b1 = inner_dt * KBplus * ca3;
+
+				pC2[k] += c2 * pC2[k] - c1 * pO1[k];
+				pC1[k] += a1 * pC1[k] - a2 * pO1[k];
+				pO2[k] += b2 * pO2[k] - b1 * pO1[k];
+				pO1[k] = 1.0 - (pO2[k] + pC1[k] + pC2[k]);
+			}
+		}
+
+		// TODO: How is pOavg to be treated? Atm, take constant pO1+pO2.
+		for (long k = kBegin; k < kEnd; ++k)
+			pOavg[k] = pO1[k] + pO2[k];
+	}
+}
+
+
+template <typename TDomain>
+void RyRinstat<TDomain>::init_to_steady_state(number time, VectorProxyBase* upb)
+{
+	init(time, upb);
+}
+
+
+template<typename TDomain>
+void RyRinstat<TDomain>::init(number time, VectorProxyBase* upb)
+{
+	this->m_time = time;
+	this->m_initTime = time;
+
+	if (!m_stateStore.valid())
+		rebuild_state_store();
+
+	const long nSlots = (long) m_stateStore.size();
+	number* ca = m_stateStore.state(_GS_CA_);
+	gather_calcium(upb, ca);
+
+	// calculate equilibrium
+	const number KC = KCplus/KCminus;
+	for (long k = 0; k < nSlots; ++k)
+	{
+		const number ca3 = ca[k]*ca[k]*ca[k];
+		const number KA = KAplus/KAminus * ca3*ca[k];
+		const number KB = KBplus/KBminus * ca3;
+
+		const number denom_inv = 1.0 / (1.0 + KC + 1.0/KA + KB);
+
+		Vertex* vrt = m_stateStore.elem(k);
+		m_aaO2[vrt] = KB * denom_inv;
+		m_aaC1[vrt] = denom_inv / KA;
+		m_aaC2[vrt] = KC * denom_inv;
+		m_aaOavg[vrt] = 1.0 - (m_aaC1[vrt] + m_aaC2[vrt]);
+		m_aaCaOld[vrt] = ca[k];
 	}
 
 	m_initiated = true;
@@ -528,6 +599,47 @@ const std::string RyRinstat<TDomain>::name() const
 };
 
 
+template<typename TDomain>
+void RyRinstat<TDomain>::report_memory(MemoryReport& rep) const
+{
+	rep.add("attachments channel states",
+		AttachmentMemory<Vertex>(*m_mg, m_aO2) + AttachmentMemory<Vertex>(*m_mg, m_aC1)
+		+ AttachmentMemory<Vertex>(*m_mg, m_aC2));
+	rep.add("attachment avg. open probability", AttachmentMemory<Vertex>(*m_mg, m_aOavg));
+	rep.add("attachment old calcium", AttachmentMemory<Vertex>(*m_mg, m_aCaOld));
+	rep.add("state store", m_stateStore.memory_bytes() + VectorMemory(m_vCaDoF));
+}
+
+
+template<typename TDomain>
+number RyRinstat<TDomain>::characteristic_time_scale() const
+{
+	if (!m_initiated)
+		return std::numeric_limits<number>::max();
+
+	// largest rate of change of the channel states (with the latest calcium values)
+	number maxRate = 0.0;
+	const size_t nSlots = m_stateStore.size();
+	for (size_t k = 0; k < nSlots; ++k)
+	{
+		Vertex* vrt = m_stateStore.elem(k);
+		const number o2 = m_aaO2[vrt];
+		const number c1 = m_aaC1[vrt];
+		const number c2 = m_aaC2[vrt];
+		const number o1 = 1.0 - (o2 + c1 + c2);
+		const number ca = m_aaCaOld[vrt];
+		const number ca3 = ca*ca*ca;
+
+		const number dO2 = KBplus*ca3*o1 - KBminus*o2;
+		const number dC1 = KAminus*o1 - KAplus*ca3*ca*c1;
+		const number dC2 = KCplus*o1 - KCminus*c2;
+		maxRate = std::max(maxRate, std::max(fabs(dO2), std::max(fabs(dC1), fabs(dC2))));
+	}
+
+	return maxRate > 0.0 ? 1.0 / maxRate : std::numeric_limits<number>::max();
+}
+
+
 template<typename TDomain>
 void RyRinstat<TDomain>::check_supplied_functions() const
 {
@@ -562,6 +674,87 @@ void RyRinstat<TDomain>::print_units() const
 }
 
 
+template<typename TDomain>
+void RyRinstat<TDomain>::set_conductance(number mu)
+{
+	MU_RYR = mu;
+	parameters_changed();
+}
+
+
+template<typename TDomain>
+SmartPtr<ICheckpointState> RyRinstat<TDomain>::checkpoint_state()
+{
+	return make_sp(new MemberCheckpointState<RyRinstat<TDomain> >(this));
+}
+
+
+template<typename TDomain>
+size_t RyRinstat<TDomain>::num_checkpoint_values() const
+{
+	// O2, C1, C2, Oavg, CaOld and whether the states have been initialized
+	return 6;
+}
+
+
+template<typename TDomain>
+void RyRinstat<TDomain>::collect_checkpoint_objects(std::vector<GridObject*>& vObj)
+{
+	vObj.clear();
+
+	typedef DoFDistribution::traits<Vertex>::const_iterator it_type;
+	const size_t nSs = m_vSubset.size();
+	for (size_t s = 0; s < nSs; ++s)
+	{
+		it_type it = m_dd->begin<Vertex>(m_vSubset[s]);
+		it_type it_end = m_dd->end<Vertex>(m_vSubset[s]);
+		for (; it != it_end; ++it)
+			vObj.push_back(*it);
+	}
+}
+
+
+template<typename TDomain>
+void RyRinstat<TDomain>::get_checkpoint_values(GridObject* o, number* vals) const
+{
+	Vertex* vrt = static_cast<Vertex*>(o);
+	vals[0] = m_aaO2[vrt];
+	vals[1] = m_aaC1[vrt];
+	vals[2] = m_aaC2[vrt];
+	vals[3] = m_aaOavg[vrt];
+	vals[4] = m_aaCaOld[vrt];
+	vals[5] = m_initiated ? 1.0 : 0.0;
+}
+
+
+template<typename TDomain>
+void RyRinstat<TDomain>::set_checkpoint_values(GridObject* o, const number* vals)
+{
+	// states that had not been initialized are initialized as usual
+	if (vals[5] == 0.0)
+		return;
+
+	Vertex* vrt = static_cast<Vertex*>(o);
+	m_aaO2[vrt] = vals[0];
+	m_aaC1[vrt] = vals[1];
+	m_aaC2[vrt] = vals[2];
+	m_aaOavg[vrt] = vals[3];
+	m_aaCaOld[vrt] = vals[4];
+	m_initiated = true;
+}
+
+
+template<typename TDomain>
+void RyRinstat<TDomain>::checkpoint_restored(number time)
+{
+	if (m_initiated)
+	{
+		m_time = time;
+		m_initTime = time;
+	}
+}
+
+
 // explicit template specializations
 #ifdef UG_DIM_1
 	template class RyRinstat<Domain1d>;
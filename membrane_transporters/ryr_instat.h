@@ -42,6 +42,8 @@
 
 #include "membrane_transporter_interface.h"
 #include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
+#include "../util/gating_state_store.h"  // for GatingStateStore
+#include "../util/checkpoint_state.h"  // for ICheckpointState
 
 
 namespace ug {
@@ -86,7 +88,7 @@ class RyRinstat : public IMembraneTransporter
 		const number KAminus;		// C1 <-- O1
 		const number KBminus;		// O1 <-- O2
 		const number KCminus;		// O1 <-- C2
-		const number MU_RYR;	// RyR channel conductance
+		number MU_RYR;	// RyR channel conductance
 
 		const number REF_CA_ER;	// reference endoplasmatic Ca2+ concentration (for conductances)
 
@@ -103,6 +105,9 @@ class RyRinstat : public IMembraneTransporter
 		/// @copydoc IMembraneTransporter::prepare_timestep()
 		virtual void prepare_timestep(number future_time, const number time, VectorProxyBase* upb);
 
+		/// @copydoc IMembraneTransporter::init_to_steady_state()
+		virtual void init_to_steady_state(number time, VectorProxyBase* upb);
+
 		/// @copydoc IMembraneTransporter::calc_flux()
 		virtual void calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const;
 
@@ -121,12 +126,41 @@ class RyRinstat : public IMembraneTransporter
 		/// @copydoc IMembraneTransporter::name()
 		virtual const std::string name() const;
 
+		/// @copydoc IMembraneTransporter::report_memory()
+		virtual void report_memory(MemoryReport& rep) const;
+
+		/// @copydoc IMembraneTransporter::characteristic_time_scale()
+		virtual number characteristic_time_scale() const;
+
 		/// @copydoc IMembraneTransporter::check_supplied_functions()
 		virtual void check_supplied_functions() const;
 
 		/// @copydoc IMembraneTransporter::print_units()
 		virtual void print_units() const;
 
+	public:
+		/// set the channel conductance (in m^3/s; can be changed between time steps)
+		void set_conductance(number mu);
+
+		/**
+		 * @brief State object for a SolutionCheckpoint (or a ChannelStateMigration)
+		 *
+		 * Stores the Markov states (O2, C1, C2, avg. open probability and old calcium;
+		 * kept in vertex attachments) and marks the channel as initialized on restart,
+		 * so that the states are not reset to equilibrium.
+		 * The channel must outlive the returned object.
+		 */
+		SmartPtr<ICheckpointState> checkpoint_state();
+
+		/// @name methods used by the checkpoint state object (see MemberCheckpointState)
+		/// @{
+		size_t num_checkpoint_values() const;
+		void collect_checkpoint_objects(std::vector<GridObject*>& vObj);
+		void get_checkpoint_values(GridObject* o, number* vals) const;
+		void set_checkpoint_values(GridObject* o, const number* vals);
+		void checkpoint_restored(number time);
+		/// @}
+
 	protected:
 		// constructing directives to be called from every constructor
 		void construct(const std::vector<std::string>& subsets, SmartPtr<ApproximationSpace<TDomain> > approx);
@@ -134,6 +168,15 @@ class RyRinstat : public IMembraneTransporter
 		// init gating variables to equilibrium
 		void init(number time, VectorProxyBase* upb);
 
+		/// assign store slots (and calcium DoF indices) to the vertices of the subsets
+		void rebuild_state_store();
+
+		/// evaluate (scaled) cytosolic calcium for all store slots
+		void gather_calcium(VectorProxyBase* upb, number* ca) const;
+
+		/// perform the implicit (or explicit) Markov substeps for store slots [kBegin, kEnd)
+		void markov_step_batch(long kBegin, long kEnd, size_t nSteps, number inner_dt);
+
 		// calculate open probability at grid object
 		template <typename TBaseElem>
 		number open_prob(GridObject* o) const;
@@ -159,6 +202,10 @@ class RyRinstat : public IMembraneTransporter
 		Grid::AttachmentAccessor<Vertex, ANumber> m_aaOavg;		//!< accessor for avg. open prob.
 		Grid::AttachmentAccessor<Vertex, ANumber> m_aaCaOld;	//!< accessor for old calcium value
 
+		enum {_GS_O1_ = 0, _GS_O2_, _GS_C1_, _GS_C2_, _GS_OAVG_, _GS_CA_, _GS_CA_DERIV_, _GS_NUM_};
+		GatingStateStore<Vertex> m_stateStore;		//!< contiguous channel states for batched updates
+		std::vector<DoFIndex> m_vCaDoF;				//!< cytosolic calcium DoF for each store slot
+
 		number m_time;								//!< current time
 		number m_initTime;							//!< time of initialization
 		bool m_initiated;							//!< indicates whether channel has been initialized by init()
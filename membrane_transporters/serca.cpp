@@ -38,6 +38,7 @@
  */
 
 #include "serca.h"
+#include "../membrane_transport_fv1_typed_impl.h"  // for MembraneTransportFV1T
 
 namespace ug {
 namespace neuro_collection {
@@ -86,7 +87,7 @@ void SERCA::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::ve
 	if (!has_constant_value(_CCYT_))
 	{
 		flux_derivs[0][i].first = local_fct_index(_CCYT_);
-		flux_derivs[0][i].second = (VS*KS) / (pow(KS+caCyt,2)*caER);
+		flux_derivs[0][i].second = (VS*KS) / ((KS+caCyt)*(KS+caCyt)*caER);
 		i++;
 	}
 	if (!has_constant_value(_CER_))
@@ -98,6 +99,67 @@ void SERCA::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::ve
 }
 
 
+void SERCA::calc_flux_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<number>& flux
+) const
+{
+	const size_t nPts = vElem.size();
+	const number* caCyt = &u[_CCYT_*nPts];	// cytosolic Ca2+ concentrations
+	const number* caER = &u[_CER_*nPts];	// ER Ca2+ concentrations
+	number* f = &flux[0];
+
+	const number vs = VS;
+	const number ks = KS;
+	for (size_t k = 0; k < nPts; ++k)
+		f[k] = vs*caCyt[k] / ((ks + caCyt[k]) * caER[k]);
+}
+
+
+void SERCA::calc_flux_deriv_batch
+(
+	const std::vector<number>& u,
+	const std::vector<GridObject*>& vElem,
+	std::vector<size_t>& vDerivFct,
+	std::vector<number>& vDeriv
+) const
+{
+	const size_t nPts = vElem.size();
+
+	// derivatives w.r.t. constant values are written to a dummy array
+	number* dummy = batch_dummy(nPts);
+	number* dcyt = dummy;
+	number* der = dummy;
+
+	size_t i = 0;
+	if (!has_constant_value(_CCYT_))
+	{
+		vDerivFct[i] = local_fct_index(_CCYT_);
+		dcyt = &vDeriv[i*nPts];
+		++i;
+	}
+	if (!has_constant_value(_CER_))
+	{
+		vDerivFct[i] = local_fct_index(_CER_);
+		der = &vDeriv[i*nPts];
+	}
+
+	const number* caCyt = &u[_CCYT_*nPts];	// cytosolic Ca2+ concentrations
+	const number* caER = &u[_CER_*nPts];	// ER Ca2+ concentrations
+
+	const number vs = VS;
+	const number ks = KS;
+	for (size_t k = 0; k < nPts; ++k)
+	{
+		const number denom = (ks + caCyt[k]) * caER[k];
+		dcyt[k] = vs*ks / ((ks + caCyt[k]) * denom);
+		der[k] = - vs*caCyt[k] / (denom * caER[k]);
+	}
+}
+
+
 size_t SERCA::n_dependencies() const
 {
 	size_t n = 2;
@@ -162,7 +224,20 @@ void SERCA::print_units() const
 	UG_LOG("+------------------------------------------------------------------------------+"<< std::endl);
 	UG_LOG(std::endl);
 }
-    
-    
+
+
+// explicit template specializations of the discretization with devirtualized
+// kernel calls (instantiated here so that the kernels can be inlined)
+#ifdef UG_DIM_1
+	template class MembraneTransportFV1T<Domain1d, SERCA>;
+#endif
+#ifdef UG_DIM_2
+	template class MembraneTransportFV1T<Domain2d, SERCA>;
+#endif
+#ifdef UG_DIM_3
+	template class MembraneTransportFV1T<Domain3d, SERCA>;
+#endif
+
+
 } // namespace neuro_collection
 } // namespace ug
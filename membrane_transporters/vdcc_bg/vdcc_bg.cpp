@@ -43,6 +43,9 @@
 #include "lib_disc/spatial_disc/disc_util/geom_provider.h"  // for GeomProvider
 #include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"	// InnerBoundaryConstants
 
+#include <algorithm>  // for std::max
+#include <limits>  // for std::numeric_limits
+
 namespace ug {
 namespace neuro_collection {
 
@@ -73,10 +76,15 @@ VDCC_BG<TDomain>::VDCC_BG
   m_localIndicesOffset(0),
   m_gpMGate(3.4, -21.0, 1.5), m_gpHGate(-2.0, -40.0, 75.0),
   m_spVtkOutput(SPNULL), m_spVmGF(SPNULL),
+  m_vtkStride(1), m_bAsyncVtk(false), m_spAsyncVtkWriter(SPNULL),
   m_time(0.0), m_oldTime(0.0),
   m_perm(3.8e-19), m_mp(2), m_hp(1), m_channelType(BG_Ltype),
   m_bUseGatingAttachments(true),
-  m_initiated(false)
+  m_gatingScheme(GIS_IMPLICIT_EULER),
+  m_nMultirateSubsteps(0),
+  m_initiated(false),
+  m_bUniformPotential(false), m_uniformVm(0.0), m_uniformM(0.0), m_uniformH(1.0),
+  m_uniformOAvg(0.0)
 {
 	after_construction();
 }
@@ -96,10 +104,15 @@ VDCC_BG<TDomain>::VDCC_BG
   m_localIndicesOffset(0),
   m_gpMGate(3.4, -21.0, 1.5), m_gpHGate(-2.0, -40.0, 75.0),
   m_spVtkOutput(SPNULL), m_spVmGF(SPNULL),
+  m_vtkStride(1), m_bAsyncVtk(false), m_spAsyncVtkWriter(SPNULL),
   m_time(0.0), m_oldTime(0.0),
   m_perm(3.8e-19), m_mp(2), m_hp(1), m_channelType(BG_Ltype),
   m_bUseGatingAttachments(true),
-  m_initiated(false)
+  m_gatingScheme(GIS_IMPLICIT_EULER),
+  m_nMultirateSubsteps(0),
+  m_initiated(false),
+  m_bUniformPotential(false), m_uniformVm(0.0), m_uniformM(0.0), m_uniformH(1.0),
+  m_uniformOAvg(0.0)
 {
 	after_construction();
 }
@@ -107,6 +120,9 @@ VDCC_BG<TDomain>::VDCC_BG
 template<typename TDomain>
 void VDCC_BG<TDomain>::after_construction()
 {
+	m_bCurrElemIsHSlave = false;
+	m_pCurrGeom = NULL;
+
 	// process subsets
 
 	//	remove white space
@@ -154,9 +170,13 @@ void VDCC_BG<TDomain>::after_construction()
 		}
 
 		// create attachment accessors
-		m_aaMGate = Grid::AttachmentAccessor<vm_grid_object, ADouble>(*m_mg, m_MGate);
+		m_aaMGate = attachment_accessor_type(*m_mg, m_MGate);
 		if (has_hGate())
-			m_aaHGate = Grid::AttachmentAccessor<vm_grid_object, ADouble>(*m_mg, m_HGate);
+			m_aaHGate = attachment_accessor_type(*m_mg, m_HGate);
+
+		// contiguous store for batched gating updates
+		m_gatingStore.set_num_states(_GS_NUM_);
+		m_gatingStore.register_grid_callbacks(*m_mg);
 	}
 
 
@@ -165,7 +185,7 @@ void VDCC_BG<TDomain>::after_construction()
 		UG_THROW("Attachment necessary for Borg-Graham channel dynamics "
 				 "could not be made, since it already exists.");
 	m_mg->template attach_to<vm_grid_object>(this->m_Vm, true);
-	m_aaVm = Grid::AttachmentAccessor<vm_grid_object, ADouble>(*m_mg, m_Vm);
+	m_aaVm = attachment_accessor_type(*m_mg, m_Vm);
 
 	// check whether necessary functions are given
 	check_supplied_functions();
@@ -179,6 +199,8 @@ VDCC_BG<TDomain>::~VDCC_BG()
 	{
 		m_mg->template detach_from<vm_grid_object>(this->m_MGate);
 		m_mg->template detach_from<vm_grid_object>(this->m_HGate);
+		if (m_mg->template has_attachment<vm_grid_object>(this->m_OAvg))
+			m_mg->template detach_from<vm_grid_object>(this->m_OAvg);
 	}
 	m_mg->template detach_from<vm_grid_object>(this->m_Vm);
 }
@@ -271,6 +293,66 @@ void VDCC_BG<TDomain>::calc_gating_step(GatingParams& gp, number Vm, number dt,
 }
 
 
+template<typename TDomain>
+number VDCC_BG<TDomain>::gating_step_factor(const GatingParams& gp, number dt) const
+{
+	// exact solution for constant potential
+	if (m_gatingScheme == GIS_RUSH_LARSEN && dt >= 0)
+		return gating_decay_factor(gp.tau_0, dt, GIS_RUSH_LARSEN);
+
+	// the exact same sequence of (sub-)steps as in calc_gating_step(),
+	// applied to the deviation from equilibrium (initially 1)
+	number fac = 1.0;
+
+	// forward step: implicit
+	if (dt >= 0)
+	{
+		if (dt > 1e-2)
+		{
+			number vdcc_dt = 1e-2;
+			number t0 = 0.0;
+			while (t0 < dt)
+			{
+				number t = t0 + vdcc_dt;
+				if (t > dt)
+				{
+					t = dt;
+					vdcc_dt = dt - t0;
+				}
+				fac *= gp.tau_0 / (gp.tau_0 + vdcc_dt);
+				t0 = t;
+			}
+		}
+		else
+			fac = gp.tau_0 / (gp.tau_0 + dt);
+	}
+
+	// backward step: explicit
+	else
+	{
+		if (dt < -1e-2)
+		{
+			number vdcc_dt = -1e-2;
+			number t0 = 0.0;
+			while (t0 > dt)
+			{
+				number t = t0 + vdcc_dt;
+				if (t < dt)
+				{
+					t = dt;
+					vdcc_dt = dt - t0;
+				}
+				fac *= 1.0 - vdcc_dt/gp.tau_0;
+				t0 = t;
+			}
+		}
+		fac *= 1.0 - dt/gp.tau_0;
+	}
+
+	return fac;
+}
+
+
 template <typename TDomain>
 number VDCC_BG<TDomain>::average_attachment_value_on_grid_object
 (
@@ -320,19 +402,21 @@ number VDCC_BG<TDomain>::average_attachment_value_on_grid_object
 template<typename TDomain>
 void VDCC_BG<TDomain>::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const
 {
-	const number mGate = m_bUseGatingAttachments ?
-		average_attachment_value_on_grid_object(m_aaMGate, e) : u[_M_];
-	number gating = pow(mGate, m_mp);
-	if (has_hGate())
+	number gating;
+	if (m_nMultirateSubsteps)
+		gating = gate_value(m_aaOAvg, m_uniformOAvg, e);
+	else
 	{
-		const number hGate = m_bUseGatingAttachments ?
-			average_attachment_value_on_grid_object(m_aaHGate, e) : u[_H_];
-		gating *= pow(hGate, m_hp);
+		const number mGate = m_bUseGatingAttachments ?
+			gate_value(m_aaMGate, m_uniformM, e) : u[_M_];
+		const number hGate = (has_hGate() && m_bUseGatingAttachments) ?
+			gate_value(m_aaHGate, m_uniformH, e) : (has_hGate() ? u[_H_] : 1.0);
+		gating = open_probability(mGate, hGate);
 	}
 
 	// flux derived from Goldman-Hodgkin-Katz equation,
 	number maxFlux;
-	const number vm = average_attachment_value_on_grid_object(m_aaVm, e);
+	const number vm = gate_value(m_aaVm, m_uniformVm, e);
 	const number caCyt = u[_CCYT_];		// cytosolic Ca2+ concentration
 	const number caExt = u[_CEXT_];		// extracellular Ca2+ concentration
 
@@ -354,21 +438,25 @@ template<typename TDomain>
 void VDCC_BG<TDomain>::calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const
 {
 	const number mGate = m_bUseGatingAttachments ?
-		average_attachment_value_on_grid_object(m_aaMGate, e) : u[_M_];
+		gate_value(m_aaMGate, m_uniformM, e) : u[_M_];
 	number gating = pow(mGate, m_mp);
 	number dGatingdM = m_mp * pow(mGate, m_mp - 1);
 	number dGatingdH = gating;
 	if (has_hGate())
 	{
 		const number hGate = m_bUseGatingAttachments ?
-			average_attachment_value_on_grid_object(m_aaHGate, e) : u[_H_];
+			gate_value(m_aaHGate, m_uniformH, e) : u[_H_];
 		gating *= pow(hGate, m_hp);
 		dGatingdM *= pow(hGate, m_hp);
 		dGatingdH *= m_hp * pow(hGate, m_hp - 1);
 	}
 
+	// multirate mode: gates are attachments, so only the gating value itself is replaced
+	if (m_nMultirateSubsteps)
+		gating = gate_value(m_aaOAvg, m_uniformOAvg, e);
+
 	number dMaxFlux_dCyt, dMaxFlux_dExt;
-	number vm = average_attachment_value_on_grid_object(m_aaVm, e);
+	number vm = gate_value(m_aaVm, m_uniformVm, e);
 	number maxFlux;
 	const number caCyt = u[_CCYT_];		// cytosolic Ca2+ concentration
 	const number caExt = u[_CEXT_];		// extracellular Ca2+ concentration
@@ -402,15 +490,18 @@ void VDCC_BG<TDomain>::calc_flux_deriv(const std::vector<number>& u, GridObject*
 
 	if (!m_bUseGatingAttachments)
 	{
+		// frozen gating Jacobian: gates are constant within the linearization
+		const number frozenFac = frozen_gating_jacobian() ? 0.0 : 1.0;
+
 		++i;
 		flux_derivs[0][i].first = local_fct_index(_M_);
-		flux_derivs[0][i].second = dGatingdM * maxFlux;
+		flux_derivs[0][i].second = frozenFac * dGatingdM * maxFlux;
 
 		if (has_hGate())
 		{
 			++i;
 			flux_derivs[0][i].first = local_fct_index(_H_);
-			flux_derivs[0][i].second = dGatingdH * maxFlux;
+			flux_derivs[0][i].second = frozenFac * dGatingdH * maxFlux;
 		}
 	}
 }
@@ -457,6 +548,65 @@ const std::string VDCC_BG<TDomain>::name() const
 }
 
 
+template<typename TDomain>
+void VDCC_BG<TDomain>::report_memory(MemoryReport& rep) const
+{
+	rep.add("attachment m gate", AttachmentMemory<vm_grid_object>(*m_mg, m_MGate));
+	rep.add("attachment h gate", AttachmentMemory<vm_grid_object>(*m_mg, m_HGate));
+	rep.add("attachment Vm", AttachmentMemory<vm_grid_object>(*m_mg, m_Vm));
+	if (m_mg->template has_attachment<vm_grid_object>(m_OAvg))
+		rep.add("attachment averaged open probability", AttachmentMemory<vm_grid_object>(*m_mg, m_OAvg));
+	rep.add("gating state store", m_gatingStore.memory_bytes());
+	rep.add("vtk output buffers", VectorMemory(m_vVtkCoord) + VectorMemory(m_vVtkVal));
+	if (m_spGeomCache.valid())
+		rep.add("geometry cache (shared)", m_spGeomCache->memory_bytes());
+}
+
+
+template<typename TDomain>
+number VDCC_BG<TDomain>::characteristic_time_scale() const
+{
+	// gates that are unknowns of the system are not known here
+	if (!m_initiated || !m_bUseGatingAttachments)
+		return std::numeric_limits<number>::max();
+
+	// the gates change at a rate of |g_inf - g| / tau (tau in ms, potential in mV)
+	const number scale = 1e-3*F/(R*T);
+	const bool bHGate = has_hGate();
+	number maxRate = 0.0;
+	if (m_bUniformPotential)
+	{
+		const number vm = 1e3*m_uniformVm;
+		const number mInf = 1.0 / (1.0 + exp(-m_gpMGate.z * scale * (vm - m_gpMGate.V_12)));
+		maxRate = fabs(mInf - m_uniformM) / m_gpMGate.tau_0;
+		if (bHGate)
+		{
+			const number hInf = 1.0 / (1.0 + exp(-m_gpHGate.z * scale * (vm - m_gpHGate.V_12)));
+			maxRate = std::max(maxRate, fabs(hInf - m_uniformH) / m_gpHGate.tau_0);
+		}
+	}
+	else
+	{
+		const size_t nSlots = m_gatingStore.size();
+		for (size_t k = 0; k < nSlots; ++k)
+		{
+			vm_grid_object* vrt = m_gatingStore.elem(k);
+			const number vm = 1e3*m_aaVm[vrt];
+			const number mInf = 1.0 / (1.0 + exp(-m_gpMGate.z * scale * (vm - m_gpMGate.V_12)));
+			maxRate = std::max(maxRate, fabs(mInf - m_aaMGate[vrt]) / m_gpMGate.tau_0);
+			if (bHGate)
+			{
+				const number hInf = 1.0 / (1.0 + exp(-m_gpHGate.z * scale * (vm - m_gpHGate.V_12)));
+				maxRate = std::max(maxRate, fabs(hInf - m_aaHGate[vrt]) / m_gpHGate.tau_0);
+			}
+		}
+	}
+
+	// rate is per ms
+	return maxRate > 0.0 ? 1e-3 / maxRate : std::numeric_limits<number>::max();
+}
+
+
 template<typename TDomain>
 void VDCC_BG<TDomain>::check_supplied_functions() const
 {
@@ -476,6 +626,26 @@ void VDCC_BG<TDomain>::check_supplied_functions() const
 }
 
 
+template<typename TDomain>
+void VDCC_BG<TDomain>::activity_indicators
+(
+	const std::vector<number>& u,
+	GridObject* e,
+	std::vector<number>& vInd
+) const
+{
+	// the flux also depends on the potential and the gating states held in attachments
+	vInd = u;
+	vInd.push_back(gate_value(m_aaVm, m_uniformVm, e));
+	if (m_bUseGatingAttachments)
+	{
+		vInd.push_back(gate_value(m_aaMGate, m_uniformM, e));
+		if (has_hGate())
+			vInd.push_back(gate_value(m_aaHGate, m_uniformH, e));
+	}
+}
+
+
 template<typename TDomain>
 void VDCC_BG<TDomain>::print_units() const
 {
@@ -501,6 +671,59 @@ template<typename TDomain>
 void VDCC_BG<TDomain>::set_permeability(const number perm)
 {
 	m_perm = perm;
+	this->parameters_changed();
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::use_exact_gating_mode(bool b)
+{
+	m_gatingScheme = b ? GIS_RUSH_LARSEN : GIS_IMPLICIT_EULER;
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::set_multirate_substeps(size_t n)
+{
+	UG_COND_THROW(n && !m_bUseGatingAttachments, "Multirate mode is only possible "
+		"if the gates are realized as attachments, not as unknowns of the system.");
+
+	m_nMultirateSubsteps = n;
+	if (!n || m_bUniformPotential)
+	{
+		reset_open_probability_average();
+		return;
+	}
+
+	if (!m_mg->template has_attachment<vm_grid_object>(this->m_OAvg))
+	{
+		m_mg->template attach_to<vm_grid_object>(this->m_OAvg);
+		m_aaOAvg = attachment_accessor_type(*m_mg, m_OAvg);
+	}
+
+	if (m_initiated)
+		reset_open_probability_average();
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::reset_open_probability_average()
+{
+	if (m_bUniformPotential)
+	{
+		m_uniformOAvg = open_probability(m_uniformM, m_uniformH);
+		return;
+	}
+
+	if (!m_nMultirateSubsteps)
+		return;
+
+	const size_t nSlots = m_gatingStore.size();
+	for (size_t k = 0; k < nSlots; ++k)
+	{
+		vm_grid_object* vrt = m_gatingStore.elem(k);
+		m_aaOAvg[vrt] = open_probability(m_aaMGate[vrt], has_hGate() ? number(m_aaHGate[vrt]) : 1.0);
+	}
 }
 
 
@@ -510,6 +733,34 @@ void VDCC_BG<TDomain>::init(number time)
 	m_time = time;
 	m_initTime = time;
 
+	if (m_bUniformPotential)
+	{
+		m_uniformVm = uniform_potential();
+		m_uniformM = calc_gating_start(m_gpMGate, 1e3*m_uniformVm);
+		m_uniformH = has_hGate() ? calc_gating_start(m_gpHGate, 1e3*m_uniformVm) : 1.0;
+		reset_open_probability_average();
+
+		this->m_initiated = true;
+		return;
+	}
+
+	if (m_bUseGatingAttachments)
+	{
+		if (!m_gatingStore.valid())
+			rebuild_gating_store();
+
+		// update potentials, then calculate corresponding start condition for gates
+		const size_t nSlots = m_gatingStore.size();
+		for (size_t k = 0; k < nSlots; ++k)
+			update_potential(m_gatingStore.elem(k));
+		init_all_gating();
+		reset_open_probability_average();
+
+		this->m_initiated = true;
+		return;
+	}
+
+	// we simply update all potentials
 	typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator itType;
 	SubsetGroup ssGrp;
 	try { ssGrp = SubsetGroup(m_dom->subset_handler(), this->m_vSubset);}
@@ -520,18 +771,7 @@ void VDCC_BG<TDomain>::init(number time)
 		itType iterBegin = m_dd->template begin<vm_grid_object>(ssGrp[si]);
 		itType iterEnd = m_dd->template end<vm_grid_object>(ssGrp[si]);
 		for (itType iter = iterBegin; iter != iterEnd; ++iter)
-		{
 			update_potential(*iter);
-
-			if (m_bUseGatingAttachments)
-			{
-				// calculate corresponding start condition for gates
-				const number vm = m_aaVm[*iter];
-				m_aaMGate[*iter] = calc_gating_start(m_gpMGate, 1e3*vm);
-				if (has_hGate())
-					m_aaHGate[*iter] = calc_gating_start(m_gpHGate, 1e3*vm);
-			}
-		}
 	}
 
 	this->m_initiated = true;
@@ -539,17 +779,187 @@ void VDCC_BG<TDomain>::init(number time)
 
 
 template<typename TDomain>
-void VDCC_BG<TDomain>::update_gating(vm_grid_object* elem)
+void VDCC_BG<TDomain>::init_to_steady_state(number time, VectorProxyBase* upb)
+{
+	init(time);
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::rebuild_gating_store()
+{
+	m_gatingStore.clear();
+
+	typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator it_type;
+	SubsetGroup ssGrp;
+	try { ssGrp = SubsetGroup(m_dom->subset_handler(), this->m_vSubset);}
+	UG_CATCH_THROW("Subset group creation failed.");
+	const size_t nSs = ssGrp.size();
+	for (size_t si = 0; si < nSs; ++si)
+	{
+		it_type it = m_dd->begin<vm_grid_object>(ssGrp[si]);
+		it_type it_end = m_dd->end<vm_grid_object>(ssGrp[si]);
+		for (; it != it_end; ++it)
+			m_gatingStore.add(*it);
+	}
+
+	m_gatingStore.set_valid();
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::update_all_gating(number dt)
 {
 	if (!this->m_initiated)
 		UG_THROW("Borg-Graham not initialized.\n"
 			<< "Do not forget to do so before any updates by calling init(initTime).");
 
-	// set new gating particle values
-	number dt = 1e3*(m_time - m_oldTime);   // calculating in ms
-	calc_gating_step(m_gpMGate, 1e3*m_aaVm[elem], dt, m_aaMGate[elem]);
-	if (has_hGate())
-		calc_gating_step(m_gpHGate, 1e3*m_aaVm[elem], dt, m_aaHGate[elem]);
+	NC_HOT_PATH_LABEL(m_hpGating, "VDCC_BG::update_all_gating", name(), hot_path_subset_label(this->symb_subsets()));
+	NC_HOT_PATH_SCOPE(m_hpGating);
+
+	const long nSlots = (long) m_gatingStore.size();
+	const bool bHGate = has_hGate();
+
+	// gather potentials (in mV) and gating values
+	number* vm = m_gatingStore.state(_GS_VM_);
+	number* mGate = m_gatingStore.state(_GS_M_);
+	number* hGate = m_gatingStore.state(_GS_H_);
+	for (long k = 0; k < nSlots; ++k)
+	{
+		vm_grid_object* vrt = m_gatingStore.elem(k);
+		vm[k] = 1e3 * m_aaVm[vrt];
+		mGate[k] = m_aaMGate[vrt];
+		if (bHGate)
+			hGate[k] = m_aaHGate[vrt];
+	}
+
+	// batched update
+	const number scale = 1e-3*F/(R*T);
+	const number zM = m_gpMGate.z * scale;
+	const number v12M = m_gpMGate.V_12;
+
+	// multirate mode: sub-steps with frozen potential, averaging the open probability
+	if (m_nMultirateSubsteps && dt > 0)
+	{
+		number* oAvg = m_gatingStore.state(_GS_OAVG_);
+		const size_t nSub = m_nMultirateSubsteps;
+		const number subFacM = gating_step_factor(m_gpMGate, dt / nSub);
+		const number subFacH = bHGate ? gating_step_factor(m_gpHGate, dt / nSub) : 0.0;
+		const number zH = m_gpHGate.z * scale;
+		const number v12H = m_gpHGate.V_12;
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(static)
+#endif
+		for (long k = 0; k < nSlots; ++k)
+		{
+			const number mInf = 1.0 / (1.0 + exp(-zM * (vm[k] - v12M)));
+			const number hInf = bHGate ? 1.0 / (1.0 + exp(-zH * (vm[k] - v12H))) : 1.0;
+			number m = mGate[k];
+			number h = bHGate ? hGate[k] : 1.0;
+
+			// trapezoidal rule over the sub-steps
+			number sum = 0.5 * open_probability(m, h);
+			for (size_t s = 1; s <= nSub; ++s)
+			{
+				m = mInf + subFacM * (m - mInf);
+				if (bHGate)
+					h = hInf + subFacH * (h - hInf);
+				sum += (s == nSub ? 0.5 : 1.0) * open_probability(m, h);
+			}
+			mGate[k] = m;
+			if (bHGate)
+				hGate[k] = h;
+			oAvg[k] = sum / nSub;
+		}
+
+		// scatter gating values and averaged open probabilities
+		for (long k = 0; k < nSlots; ++k)
+		{
+			vm_grid_object* vrt = m_gatingStore.elem(k);
+			m_aaMGate[vrt] = mGate[k];
+			if (bHGate)
+				m_aaHGate[vrt] = hGate[k];
+			m_aaOAvg[vrt] = oAvg[k];
+		}
+		return;
+	}
+
+	const number facM = gating_step_factor(m_gpMGate, dt);
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (long k = 0; k < nSlots; ++k)
+	{
+		const number inf = 1.0 / (1.0 + exp(-zM * (vm[k] - v12M)));
+		mGate[k] = inf + facM * (mGate[k] - inf);
+	}
+
+	if (bHGate)
+	{
+		const number zH = m_gpHGate.z * scale;
+		const number v12H = m_gpHGate.V_12;
+		const number facH = gating_step_factor(m_gpHGate, dt);
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(static)
+#endif
+		for (long k = 0; k < nSlots; ++k)
+		{
+			const number inf = 1.0 / (1.0 + exp(-zH * (vm[k] - v12H)));
+			hGate[k] = inf + facH * (hGate[k] - inf);
+		}
+	}
+
+	// scatter gating values
+	for (long k = 0; k < nSlots; ++k)
+	{
+		vm_grid_object* vrt = m_gatingStore.elem(k);
+		m_aaMGate[vrt] = mGate[k];
+		if (bHGate)
+			m_aaHGate[vrt] = hGate[k];
+	}
+
+	// backward step in multirate mode: no averaging
+	reset_open_probability_average();
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::init_all_gating()
+{
+	const long nSlots = (long) m_gatingStore.size();
+	const bool bHGate = has_hGate();
+
+	// gather potentials (in mV)
+	number* vm = m_gatingStore.state(_GS_VM_);
+	number* mGate = m_gatingStore.state(_GS_M_);
+	number* hGate = m_gatingStore.state(_GS_H_);
+	for (long k = 0; k < nSlots; ++k)
+		vm[k] = 1e3 * m_aaVm[m_gatingStore.elem(k)];
+
+	// batched equilibria (same as calc_gating_start())
+	const number scale = 1e-3*F/(R*T);
+	const number zM = m_gpMGate.z * scale;
+	const number v12M = m_gpMGate.V_12;
+	const number zH = m_gpHGate.z * scale;
+	const number v12H = m_gpHGate.V_12;
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (long k = 0; k < nSlots; ++k)
+	{
+		mGate[k] = 1.0 / (1.0 + exp(-zM * (vm[k] - v12M)));
+		if (bHGate)
+			hGate[k] = 1.0 / (1.0 + exp(-zH * (vm[k] - v12H)));
+	}
+
+	// scatter gating values
+	for (long k = 0; k < nSlots; ++k)
+	{
+		vm_grid_object* vrt = m_gatingStore.elem(k);
+		m_aaMGate[vrt] = mGate[k];
+		if (bHGate)
+			m_aaHGate[vrt] = hGate[k];
+	}
 }
 
 
@@ -568,6 +978,42 @@ template<typename TDomain>
 void VDCC_BG<TDomain>::export_membrane_potential_to_vtk
 (const std::string& fileName, size_t step, number time)
 {
+	if (step % m_vtkStride)
+		return;
+
+	if (m_bAsyncVtk)
+	{
+		// (re-)create writer if necessary
+		if (!m_spAsyncVtkWriter.valid() || m_spAsyncVtkWriter->base_name() != fileName)
+			m_spAsyncVtkWriter = make_sp(new AsyncPointVTKWriter(fileName, "Vm"));
+
+		// copy positions and potentials of all membrane vertices
+		m_vVtkCoord.clear();
+		m_vVtkVal.clear();
+
+		typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator it_type;
+		SubsetGroup ssGrp;
+		try {ssGrp = SubsetGroup(m_dom->subset_handler(), this->m_vSubset);}
+		UG_CATCH_THROW("Subset group creation failed.");
+		const size_t nSs = ssGrp.size();
+		for (size_t si = 0; si < nSs; ++si)
+		{
+			it_type it = m_dd->begin<vm_grid_object>(ssGrp[si]);
+			it_type it_end = m_dd->end<vm_grid_object>(ssGrp[si]);
+			for (; it != it_end; ++it)
+			{
+				const typename TDomain::position_type& pos = m_aaPos[*it];
+				for (int d = 0; d < 3; ++d)
+					m_vVtkCoord.push_back(d < dim ? pos[d] : 0.0);
+				m_vVtkVal.push_back(m_bUniformPotential ? m_uniformVm : m_aaVm[*it]);
+			}
+		}
+
+		try {m_spAsyncVtkWriter->write(step, time, m_vVtkCoord, m_vVtkVal);}
+		UG_CATCH_THROW("VTK output files prefixed '" << fileName << "' could not be written to.");
+		return;
+	}
+
 	// when called for the first time, initiate vtk output object and transfer grid function
 	if (!m_spVtkOutput.valid())
 	{
@@ -605,7 +1051,7 @@ void VDCC_BG<TDomain>::export_membrane_potential_to_vtk
 		{
 			spdd->inner_dof_indices(*it, 0, dofInd, true);
 			UG_ASSERT(dofInd.size() == 1, "Unexpected number of DoF indices.");
-			DoFRef(*m_spVmGF, dofInd[0]) = m_aaVm[*it];
+			DoFRef(*m_spVmGF, dofInd[0]) = m_bUniformPotential ? m_uniformVm : m_aaVm[*it];
 		}
 	}
 
@@ -620,6 +1066,23 @@ void VDCC_BG<TDomain>::export_membrane_potential_to_vtk
 
 
 
+template<typename TDomain>
+void VDCC_BG<TDomain>::set_vtk_output_stride(size_t stride)
+{
+	UG_COND_THROW(!stride, "The output stride must be positive.");
+	m_vtkStride = stride;
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::set_async_vtk_output(bool b)
+{
+	m_bAsyncVtk = b;
+	if (!b)
+		m_spAsyncVtkWriter = SPNULL;
+}
+
+
 template<typename TDomain>
 void VDCC_BG<TDomain>::prepare_timestep
 (
@@ -633,9 +1096,78 @@ void VDCC_BG<TDomain>::prepare_timestep
 	update_time(future_time);
 	const bool backwardsStep = m_time < m_oldTime;
 
+	// spatially uniform potential: one potential and one set of gates for all vertices
+	if (m_bUniformPotential)
+	{
+		if (!m_bUseGatingAttachments)
+		{
+			m_uniformVm = uniform_potential();
+			return;
+		}
+
+		// same order of updates as in the non-uniform case (see below)
+		const number dt = 1e3*(m_time - m_oldTime);   // calculating in ms
+		if (!backwardsStep)
+			m_uniformVm = uniform_potential();
+		const number mInf = calc_gating_start(m_gpMGate, 1e3*m_uniformVm);
+		const number hInf = has_hGate() ? calc_gating_start(m_gpHGate, 1e3*m_uniformVm) : 1.0;
+		if (m_nMultirateSubsteps && dt > 0)
+		{
+			// sub-steps with frozen potential, averaging the open probability
+			const size_t nSub = m_nMultirateSubsteps;
+			const number subFacM = gating_step_factor(m_gpMGate, dt / nSub);
+			const number subFacH = has_hGate() ? gating_step_factor(m_gpHGate, dt / nSub) : 0.0;
+			number sum = 0.5 * open_probability(m_uniformM, m_uniformH);
+			for (size_t s = 1; s <= nSub; ++s)
+			{
+				m_uniformM = mInf + subFacM * (m_uniformM - mInf);
+				if (has_hGate())
+					m_uniformH = hInf + subFacH * (m_uniformH - hInf);
+				sum += (s == nSub ? 0.5 : 1.0) * open_probability(m_uniformM, m_uniformH);
+			}
+			m_uniformOAvg = sum / nSub;
+		}
+		else
+		{
+			m_uniformM = mInf + gating_step_factor(m_gpMGate, dt) * (m_uniformM - mInf);
+			if (has_hGate())
+				m_uniformH = hInf + gating_step_factor(m_gpHGate, dt) * (m_uniformH - hInf);
+			m_uniformOAvg = open_probability(m_uniformM, m_uniformH);
+		}
+		if (backwardsStep)
+			m_uniformVm = uniform_potential();
+		return;
+	}
+
     // TODO: Think about updating only on the base level and then propagating upwards.
     //       Typically, the potential does not need very fine resolution.
     //       This would save a lot of work for very fine surface levels.
+	if (m_bUseGatingAttachments)
+	{
+		if (!m_gatingStore.valid())
+			rebuild_gating_store();
+
+		// in case of a backwards step, we have to first rewind the gating
+		// with the latest potential, then the potential itself,
+		// otherwise, we can update the potential and then the gatings
+		const number dt = 1e3*(m_time - m_oldTime);   // calculating in ms
+		const size_t nSlots = m_gatingStore.size();
+		if (backwardsStep)
+		{
+			update_all_gating(dt);
+			for (size_t k = 0; k < nSlots; ++k)
+				update_potential(m_gatingStore.elem(k));
+		}
+		else
+		{
+			for (size_t k = 0; k < nSlots; ++k)
+				update_potential(m_gatingStore.elem(k));
+			update_all_gating(dt);
+		}
+		return;
+	}
+
+	// we simply update all potentials
 	typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator it_type;
 	SubsetGroup ssGrp;
 	try { ssGrp = SubsetGroup(m_dom->subset_handler(), this->m_vSubset);}
@@ -643,45 +1175,131 @@ void VDCC_BG<TDomain>::prepare_timestep
 	const size_t nSs = ssGrp.size();
 	for (size_t si = 0; si < nSs; ++si)
 	{
-		// loop sides and update potential (and gatings, if needed)
 		it_type it = m_dd->begin<vm_grid_object>(ssGrp[si]);
 		it_type it_end = m_dd->end<vm_grid_object>(ssGrp[si]);
-		if (m_bUseGatingAttachments)
-		{
-			// in case of a backwards step, we have to first rewind the gating
-			// with the latest potential, then the potential itself,
-			// otherwise, we can update the potential and then the gatings
-			//
-			if (backwardsStep)
-			{
-				for (; it != it_end; ++it)
-				{
-					update_gating(*it);
-					update_potential(*it);
-				}
-			}
-			else
-			{
-				for (; it != it_end; ++it)
-				{
-					update_potential(*it);
-					update_gating(*it);
-				}
-			}
-		}
-		else
-		{
-			// we simply update all potentials
-			for (; it != it_end; ++it)
-				update_potential(*it);
-		}
+		for (; it != it_end; ++it)
+			update_potential(*it);
+	}
+}
+
+
+
+
+
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::set_uniform_potential_mode(bool b)
+{
+	if (b != m_bUniformPotential)
+		m_initiated = false;
+	m_bUniformPotential = b;
+}
+
+
+template<typename TDomain>
+number VDCC_BG<TDomain>::uniform_potential()
+{
+	UG_THROW("Spatially uniform potential mode is not supported by " << name() << ".");
+	return 0.0;
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::set_geometry_cache(SmartPtr<ManifoldGeometryCache<TDomain> > spCache)
+{
+	m_spGeomCache = spCache;
+}
+
+
+template<typename TDomain>
+SmartPtr<ICheckpointState> VDCC_BG<TDomain>::checkpoint_state()
+{
+	return make_sp(new MemberCheckpointState<VDCC_BG<TDomain> >(this));
+}
+
+
+template<typename TDomain>
+size_t VDCC_BG<TDomain>::num_checkpoint_values() const
+{
+	// m, h and whether the gates have been initialized
+	return 3;
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::collect_checkpoint_objects(std::vector<GridObject*>& vObj)
+{
+	vObj.clear();
+
+	// gating variables given as unknowns are part of the solution
+	if (!m_bUseGatingAttachments)
+		return;
+
+	typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator it_type;
+	SubsetGroup ssGrp;
+	try { ssGrp = SubsetGroup(m_dom->subset_handler(), this->m_vSubset);}
+	UG_CATCH_THROW("Subset group creation failed.");
+	const size_t nSs = ssGrp.size();
+	for (size_t si = 0; si < nSs; ++si)
+	{
+		it_type it = m_dd->begin<vm_grid_object>(ssGrp[si]);
+		it_type it_end = m_dd->end<vm_grid_object>(ssGrp[si]);
+		for (; it != it_end; ++it)
+			vObj.push_back(*it);
 	}
 }
 
 
+template<typename TDomain>
+void VDCC_BG<TDomain>::get_checkpoint_values(GridObject* o, number* vals) const
+{
+	vm_grid_object* vrt = static_cast<vm_grid_object*>(o);
+	vals[0] = gate_value(m_aaMGate, m_uniformM, vrt);
+	vals[1] = has_hGate() ? gate_value(m_aaHGate, m_uniformH, vrt) : 0.0;
+	vals[2] = m_initiated ? 1.0 : 0.0;
+}
+
+
+template<typename TDomain>
+void VDCC_BG<TDomain>::set_checkpoint_values(GridObject* o, const number* vals)
+{
+	// gates that had not been initialized are initialized as usual
+	if (vals[2] == 0.0)
+		return;
+
+	if (m_bUniformPotential)
+	{
+		m_uniformM = vals[0];
+		m_uniformH = has_hGate() ? vals[1] : 1.0;
+		m_initiated = true;
+		return;
+	}
+
+	vm_grid_object* vrt = static_cast<vm_grid_object*>(o);
+	m_aaMGate[vrt] = vals[0];
+	if (has_hGate())
+		m_aaHGate[vrt] = vals[1];
+	m_initiated = true;
+}
 
 
+template<typename TDomain>
+void VDCC_BG<TDomain>::checkpoint_restored(number time)
+{
+	// gating variables given as unknowns are restored with the solution
+	if (!m_bUseGatingAttachments)
+		m_initiated = true;
 
+	if (m_initiated)
+	{
+		m_time = time;
+		m_oldTime = time;
+		m_initTime = time;
+		if (m_bUniformPotential)
+			m_uniformVm = uniform_potential();
+	}
+}
 
 
 template<typename TDomain>
@@ -749,9 +1367,12 @@ void VDCC_BG<TDomain>::prep_elem
 	// on horizontal interfaces: only treat hmasters
 	if (m_bCurrElemIsHSlave) return;
 
-	// update geometry for this element
-	static TFVGeom& geo = GeomProvider<TFVGeom>::get();
-	try {geo.update(elem, vCornerCoords, &(this->subset_handler()));}
+	// update geometry for this element (or take it from the cache)
+	try
+	{
+		m_pCurrGeom = prepare_manifold_geometry<TFVGeom>(m_spGeomCache.get(), m_localGeom,
+			elem, vCornerCoords, &(this->subset_handler()));
+	}
 	UG_CATCH_THROW("VDCC_BG::prep_elem: Cannot update finite volume geometry.");
 }
 
@@ -770,16 +1391,16 @@ void VDCC_BG<TDomain>::add_def_A_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
-	const number vm = average_attachment_value_on_grid_object(m_aaVm, elem);
+	const number vm = gate_value(m_aaVm, m_uniformVm, elem);
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -810,14 +1431,14 @@ void VDCC_BG<TDomain>::add_def_M_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -854,14 +1475,14 @@ void VDCC_BG<TDomain>::add_jac_A_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -887,14 +1508,14 @@ void VDCC_BG<TDomain>::add_jac_M_elem
 	if (m_bCurrElemIsHSlave) return;
 
 	// get finite volume geometry
-	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+	const ManifoldElemGeometry& fvgeom = *m_pCurrGeom;
 
 	// strictly speaking, we only need ODE assemblings here,
 	// but it does not hurt to integrate over the boxes either
 	for (size_t i = 0; i < fvgeom.num_bf(); ++i)
 	{
 		// get current BF
-		const typename TFVGeom::BF& bf = fvgeom.bf(i);
+		const ManifoldElemGeometry::BF& bf = fvgeom.bf(i);
 
 		// get associated node
 		const int co = bf.node_id();
@@ -45,6 +45,12 @@
 #include "lib_disc/spatial_disc/disc_util/fv1_geom.h"  // for FV1ManifoldGeometry
 #include "lib_disc/spatial_disc/disc_util/hfv1_geom.h"  // for HFV1ManifoldGeometry
 #include "lib_disc/spatial_disc/elem_disc/elem_disc_interface.h"  // for IElemDisc
+#include "../../util/gating_state_store.h"
+#include "../../util/gating_integrator.h"
+#include "../../util/manifold_geometry_cache.h"  // for ManifoldGeometryCache
+#include "../../util/checkpoint_state.h"  // for ICheckpointState
+#include "../../util/async_vtk_writer.h"  // for AsyncPointVTKWriter
+#include "../../util/hot_path_counters.h"  // for NC_HOT_PATH_COUNTER
 
 
 
@@ -70,6 +76,8 @@ namespace neuro_collection {
  *	schema once per time step. This will be done automatically, provided the user
  *	calls the ITimeDiscretization method prepare_step() before the execution of any
  *	time step assembling in the Lua script.
+ *	For this update, potential and gating values are gathered into contiguous arrays
+ *	(see GatingStateStore), on which the update is performed in one batched loop.
  *	It is also possible to handle the gating variables as real unknown functions
  *	by providing them as such in the approximation space and handing their names
  *	to the constructor in addition to interior and exterior calcium concentrations.
@@ -183,6 +191,13 @@ class VDCC_BG
 			number future_time, const number time, VectorProxyBase* upb
 		);
 
+		/// @copydoc IMembraneTransporter::init_to_steady_state()
+		/**
+		 * This is the same as init(time). If the gates are unknowns of the problem,
+		 * use calculate_steady_state() to initialize them.
+		 */
+		virtual void init_to_steady_state(number time, VectorProxyBase* upb);
+
 		/// @copydoc IMembraneTransporter::calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const
 		virtual void calc_flux(const std::vector<number>& u, GridObject* e, std::vector<number>& flux) const;
 
@@ -193,6 +208,9 @@ class VDCC_BG
 		/// @copydoc IMembraneTransporter::calc_flux_deriv()
 		virtual void calc_flux_deriv(const std::vector<number>& u, GridObject* e, std::vector<std::vector<std::pair<size_t, number> > >& flux_derivs) const;
 
+		/// @copydoc IMembraneTransporter::activity_indicators()
+		virtual void activity_indicators(const std::vector<number>& u, GridObject* e, std::vector<number>& vInd) const;
+
 		/// @copydoc IMembraneTransporter::n_dependencies()
 		virtual size_t n_dependencies() const;
 
@@ -205,6 +223,12 @@ class VDCC_BG
 		/// @copydoc IMembraneTransporter::name()
 		virtual const std::string name() const;
 
+		/// @copydoc IMembraneTransporter::report_memory()
+		virtual void report_memory(MemoryReport& rep) const;
+
+		/// @copydoc IMembraneTransporter::characteristic_time_scale()
+		virtual number characteristic_time_scale() const;
+
 		/// @copydoc IMembraneTransporter::check_supplied_functions()
 		virtual void check_supplied_functions() const;
 
@@ -217,10 +241,34 @@ class VDCC_BG
 
         /**
          * @brief Sets the permeability of this channel
+         * This can also be done between time steps.
          * @param perm    permeability values
          */
 		void set_permeability(const number perm);
 
+		/// use the exact (Rush-Larsen) solution for the gating updates
+		/**
+		 * By default, gating values are updated by implicit Euler sub-steps.
+		 * As the time constants do not depend on the potential, the Rush-Larsen step
+		 * is exact for a potential that is constant over the time step
+		 * and needs no sub-stepping.
+		 * @param b  whether to use the exact gating updates
+		 */
+		void use_exact_gating_mode(bool b = true);
+
+		/// use time-averaged open probabilities in the flux (multirate mode)
+		/**
+		 * The gates evolve on a much faster time scale than calcium diffusion.
+		 * In multirate mode, each (macro) time step is subdivided into n sub-steps
+		 * for the gating variables (with frozen potential), and the flux for the
+		 * whole step is calculated from the open probability m^p h^q averaged
+		 * (trapezoidal rule) over the sub-steps instead of its end-of-step value.
+		 * This allows for considerably larger time steps for the diffusion system.
+		 * Only possible if gates are realized as attachments.
+		 * @param n  number of gating sub-steps per time step (0 disables multirate mode)
+		 */
+		void set_multirate_substeps(size_t n);
+
         /// initializes the defined channel type
         /** During the initialization, the necessary attachments are attached to the vertices
          *  and their values calculated by the equilibrium state for the start membrane potential.
@@ -229,7 +277,7 @@ class VDCC_BG
 
 		/// updates the potential values in the corresponding attachments to new time.
 		/**
-		 * This method needs to be called before update_gating() if potential is non-constant.
+		 * This method needs to be called before update_all_gating() if potential is non-constant.
 		 * @param newTime new point in time
 		 */
 		virtual void update_potential(vm_grid_object* elem) = 0;
@@ -238,8 +286,49 @@ class VDCC_BG
 		virtual void update_time(number newTime);
 
 		/// export voltage data to vtk
+		/**
+		 * Only steps that are multiples of the output stride are written.
+		 * In asynchronous mode, potentials and vertex positions are copied and written
+		 * by a background thread (one piece per process plus pvtu and pvd files).
+		 */
 		void export_membrane_potential_to_vtk(const std::string& fileName, size_t step, number time);
 
+		/// only export every n-th step in export_membrane_potential_to_vtk() (default: 1)
+		void set_vtk_output_stride(size_t stride);
+
+		/// write the membrane potential vtk output asynchronously
+		void set_async_vtk_output(bool b);
+
+	public:
+		/**
+		 * @brief Use a (shared) cache for the membrane element geometry
+		 *
+		 * If set, the boundary faces of each membrane element are computed only once
+		 * instead of in every assembling (until the grid is adapted or redistributed).
+		 * The same cache can be given to all membrane discs working on the grid.
+		 *
+		 * @param spCache  geometry cache (an invalid pointer disables caching)
+		 */
+		void set_geometry_cache(SmartPtr<ManifoldGeometryCache<TDomain> > spCache);
+
+		/**
+		 * @brief State object for a SolutionCheckpoint
+		 *
+		 * Stores the gating states (m, h; kept in vertex attachments) in checkpoints and marks
+		 * the channel as initialized on restart, so that the gates are not reset
+		 * to their steady states. The channel must outlive the returned object.
+		 */
+		SmartPtr<ICheckpointState> checkpoint_state();
+
+		/// @name methods used by the checkpoint state object (see MemberCheckpointState)
+		/// @{
+		size_t num_checkpoint_values() const;
+		void collect_checkpoint_objects(std::vector<GridObject*>& vObj);
+		void get_checkpoint_values(GridObject* o, number* vals) const;
+		void set_checkpoint_values(GridObject* o, const number* vals);
+		void checkpoint_restored(number time);
+		/// @}
+
 		// inheritances from IElemDisc
 	public:
 		/// type of trial space for each function used
@@ -309,6 +398,11 @@ class VDCC_BG
 		bool m_bNonRegularGrid;
 		bool m_bCurrElemIsHSlave;
 
+		/// geometry of the current element (from cache or local)
+		SmartPtr<ManifoldGeometryCache<TDomain> > m_spGeomCache;
+		ManifoldElemGeometry m_localGeom;
+		const ManifoldElemGeometry* m_pCurrGeom;
+
 
 	protected:
 		/// calculates the equilibrium state of a gating "particle"
@@ -326,6 +420,48 @@ class VDCC_BG
 		**/
 		void calc_gating_step(GatingParams& gp, number Vm, number dt, number& currVal);
 
+		/// factor by which the deviation from equilibrium is multiplied in calc_gating_step()
+		/** As tau_0 does not depend on the potential, one time step (to be specified in [ms])
+		 *  maps a gating value g to g_inf + f * (g - g_inf) with the same factor f for all
+		 *  locations. In exact gating mode, f is the Rush-Larsen factor exp(-dt/tau_0).
+		**/
+		number gating_step_factor(const GatingParams& gp, number dt) const;
+
+		/// updates the gating parameters for all vertices in the gating store
+		/**
+		 * This method needs to be called before calc_flux().
+		 * It is only needed when gates are realized as attachments.
+		 * Potentials and gating values are gathered from the vertex attachments,
+		 * updated in one batched loop and the gating values scattered back.
+		 * In multirate mode, the gates are sub-stepped and the averaged open
+		 * probabilities are scattered, too.
+		 * @param dt  time step size (in ms)
+		 */
+		void update_all_gating(number dt);
+
+		/// sets the gating parameters for all vertices in the gating store to their equilibria
+		/**
+		 * It is only needed when gates are realized as attachments.
+		 * Potentials are gathered from the vertex attachments, the equilibria calculated
+		 * in one batched loop and scattered to the gating attachments.
+		 */
+		void init_all_gating();
+
+		/// (re-)assigns the plasma membrane vertices to slots of the gating store
+		void rebuild_gating_store();
+
+		/// open probability for given gating values
+		number open_probability(number mGate, number hGate) const
+		{
+			number gating = pow(mGate, m_mp);
+			if (has_hGate())
+				gating *= pow(hGate, m_hp);
+			return gating;
+		}
+
+		/// sets the averaged open probabilities to those of the current gating values
+		void reset_open_probability_average();
+
 
 	public:
 		/// init gating variables to equilibrium
@@ -335,18 +471,13 @@ class VDCC_BG
 	private:
 		void after_construction();
 
-		/// updates the gating parameters
-		/**
-		 * This method needs to be called before calc_flux().
-		 * It is only needed when gates are realized as attachments.
-		 */
-		void update_gating(vm_grid_object* elem);
-
 	protected:
 		/// whether this channel has an inactivating gate
 		bool has_hGate() const {return this->m_channelType == BG_Ntype || this->m_channelType == BG_Ttype;}
 
-		typedef Grid::AttachmentAccessor<vm_grid_object, ADouble> attachment_accessor_type;
+		/// gates and potential are stored as gating_storage_type (cf. NCFloatGatingStorage)
+		typedef Attachment<gating_storage_type> AGatingStorage;
+		typedef Grid::AttachmentAccessor<vm_grid_object, AGatingStorage> attachment_accessor_type;
 		number average_attachment_value_on_grid_object
 		(
 			const attachment_accessor_type& aa,
@@ -360,6 +491,25 @@ class VDCC_BG
 			GridObject* o
 		) const;
 
+		/// value of potential or gate on a grid object (the shared value in uniform mode)
+		number gate_value(const attachment_accessor_type& aa, number uniformVal, GridObject* o) const
+		{
+			return m_bUniformPotential ? uniformVal : average_attachment_value_on_grid_object(aa, o);
+		}
+
+		/**
+		 * @brief Use one potential (and one set of gates) for all vertices
+		 *
+		 * In this mode, the potential is given by uniform_potential() (which derived
+		 * classes must implement then), the gating ODEs are integrated once per time step
+		 * and the vertex attachments for potential and gates are neither written nor read.
+		 * Switching the mode requires re-initialization.
+		 */
+		void set_uniform_potential_mode(bool b);
+
+		/// potential (in V) at the current time in uniform potential mode
+		virtual number uniform_potential();
+
 	protected:
 		SmartPtr<TDomain> m_dom;							//!< underlying domain
 		SmartPtr<Grid> m_mg;								//!< underlying multigrid
@@ -370,19 +520,31 @@ class VDCC_BG
 		std::vector<std::string> m_vSubset;					//!< subsets this channel exists on
 		size_t m_localIndicesOffset;
 
-		ADouble m_MGate;                            //!< activating gating "particle"
-		ADouble m_HGate;                            //!< inactivating gating "particle"
-		ADouble m_Vm;                               //!< membrane voltage (in Volt)
+		AGatingStorage m_MGate;                     //!< activating gating "particle"
+		AGatingStorage m_HGate;                     //!< inactivating gating "particle"
+		AGatingStorage m_Vm;                        //!< membrane voltage (in Volt)
 
 		attachment_accessor_type m_aaMGate;  //!< accessor for activating gate
 		attachment_accessor_type m_aaHGate;  //!< accessor for inactivating gate
 		attachment_accessor_type m_aaVm;     //!< accessor for membrane potential
 
+		AGatingStorage m_OAvg;                      //!< open probability averaged over the last time step
+		attachment_accessor_type m_aaOAvg;   //!< accessor for averaged open probability
+
+		enum {_GS_VM_ = 0, _GS_M_, _GS_H_, _GS_OAVG_, _GS_NUM_};
+		GatingStateStore<vm_grid_object> m_gatingStore;  //!< contiguous gating states for batched updates
+		NC_HOT_PATH_COUNTER(m_hpGating)                  //!< instrumentation of gating updates (if enabled)
+
 		GatingParams m_gpMGate;						//!< gating parameter set for activating gate
 		GatingParams m_gpHGate;						//!< gating parameter set for inactivating gate
 
 		SmartPtr<VTKOutput<TDomain::dim> > m_spVtkOutput;
 		SmartPtr<GridFunction<TDomain, CPUAlgebra> > m_spVmGF;  //!< grid function for Vm vtk output
+		size_t m_vtkStride;                                    //!< output stride for Vm vtk output
+		bool m_bAsyncVtk;                                      //!< whether Vm vtk output is asynchronous
+		SmartPtr<AsyncPointVTKWriter> m_spAsyncVtkWriter;      //!< writer for asynchronous Vm vtk output
+		std::vector<number> m_vVtkCoord;                       //!< vertex coordinates for asynchronous output
+		std::vector<number> m_vVtkVal;                         //!< potentials for asynchronous output
 
 		number m_time;								//!< current time
 		number m_initTime;							//!< time of initialization
@@ -394,8 +556,16 @@ class VDCC_BG
 		int m_channelType;							//!< channel type
 
 		bool m_bUseGatingAttachments;
+		GatingIntegrationScheme m_gatingScheme;		//!< scheme for gating updates
+		size_t m_nMultirateSubsteps;				//!< gating sub-steps per time step in multirate mode (0: off)
 
 		bool m_initiated;							//!< indicates whether channel has been initialized by init()
+
+		bool m_bUniformPotential;					//!< whether the potential is the same on all vertices
+		number m_uniformVm;							//!< potential in uniform mode (in V)
+		number m_uniformM;							//!< activating gate in uniform mode
+		number m_uniformH;							//!< inactivating gate in uniform mode
+		number m_uniformOAvg;						//!< averaged open probability in uniform mode
 };
 
 
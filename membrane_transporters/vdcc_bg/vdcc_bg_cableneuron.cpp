@@ -43,6 +43,9 @@
 #include "lib_disc/operator/composite_conv_check.h"
 #include "lib_algebra/operator/operator_util.h" // ApplyLinearSolver
 #include "lib_disc/function_spaces/interpolate.h"
+#include "../../util/timeline_trace.h"  // NC_TRACE_SCOPE
+
+#include <algorithm>  // std::max, std::min
 
 namespace ug {
 namespace neuro_collection {
@@ -66,11 +69,21 @@ VDCC_BG_CN<TDomain>::VDCC_BG_CN
   m_spSolTimeSeries(SPNULL), m_spVTKOut(SPNULL),
   m_potFctInd(0),
   m_scaleFactor3dTo1d(1.0),
+  m_bDistributedPotentialMapping(false),
+  m_bIncrementalPotentialRemapping(false),
+  m_bPotEdgeInterpolation(false),
   m_bSolverVerboseOutput(false), m_bVTKOutput(false),
   m_vtkFileName(std::string("")), m_pstep(1e-3),
   m_vNID(1,0),
   m_curTime(0.0), m_dt(1e-4), m_stepLv(0),
-  m_dt_potentialUpdate(1e-4), m_timeSinceLastPotentialUpdate(0.0)
+  m_dt_potentialUpdate(1e-4), m_timeSinceLastPotentialUpdate(0.0),
+  m_bPipelinedCoupling(false),
+  m_cflReuseTol(0.0), m_lastCfl(0.0), m_spUCfl(SPNULL),
+  m_bAdaptiveSubstepping(false), m_dtSafety(0.8), m_dtMaxGrowth(2.0),
+  m_dtMax(1e-4), m_dtCtrl(1e-4),
+  m_nSteps(0), m_nSubstepsLast(0), m_nSubstepsMax(0), m_nSubstepsTotal(0),
+  m_nCflEstimates(0), m_nCflReuses(0),
+  m_bPotExchangePending(false)
 {
     m_potFctInd = approx1d->fct_id_by_name(potFctName.c_str());
 }
@@ -125,6 +138,36 @@ void VDCC_BG_CN<TDomain>::set_coordinate_scale_factor_3d_to_1d(number scale)
 }
 
 
+template <typename TDomain>
+void VDCC_BG_CN<TDomain>::set_distributed_potential_mapping(bool distr)
+{
+    m_bDistributedPotentialMapping = distr;
+
+    if (m_spHNC.valid())
+    	m_spHNC->set_distributed_potential_mapping(distr);
+}
+
+
+template <typename TDomain>
+void VDCC_BG_CN<TDomain>::set_incremental_potential_remapping(bool incr)
+{
+    m_bIncrementalPotentialRemapping = incr;
+
+    if (m_spHNC.valid())
+    	m_spHNC->set_incremental_potential_remapping(incr);
+}
+
+
+template <typename TDomain>
+void VDCC_BG_CN<TDomain>::set_potential_edge_interpolation(bool edgeInterp)
+{
+    m_bPotEdgeInterpolation = edgeInterp;
+
+    if (m_spHNC.valid())
+    	m_spHNC->set_potential_edge_interpolation(edgeInterp);
+}
+
+
 template <typename TDomain>
 void VDCC_BG_CN<TDomain>::set_solver_output_verbose(bool verbose)
 {
@@ -157,6 +200,8 @@ template <typename TDomain>
 void VDCC_BG_CN<TDomain>::set_time_steps_for_simulation_and_potential_update(number dtSim, number dtPot)
 {
     m_dt = dtSim;
+    m_dtMax = dtSim;
+    m_dtCtrl = dtSim;
     m_dt_potentialUpdate = dtPot;
 
     if (m_dt_potentialUpdate < m_dt)
@@ -169,6 +214,139 @@ void VDCC_BG_CN<TDomain>::set_time_steps_for_simulation_and_potential_update(num
 
 
 
+template <typename TDomain>
+void VDCC_BG_CN<TDomain>::set_pipelined_coupling(bool pipelined)
+{
+    // an exchange started in pipelined mode must still be finished
+    if (!pipelined && m_bPotExchangePending)
+    {
+        m_spHNC->finish_potential_value_exchange();
+        m_bPotExchangePending = false;
+    }
+
+    m_bPipelinedCoupling = pipelined;
+}
+
+
+
+template <typename TDomain>
+void VDCC_BG_CN<TDomain>::set_cfl_reuse_tolerance(number relTol)
+{
+    UG_COND_THROW(relTol < 0.0, "CFL reuse tolerance must not be negative.");
+    m_cflReuseTol = relTol;
+}
+
+
+template <typename TDomain>
+void VDCC_BG_CN<TDomain>::set_adaptive_substepping(number safety, number maxGrowth)
+{
+    UG_COND_THROW(safety <= 0.0 || safety > 1.0, "Safety factor must be in (0,1].");
+    UG_COND_THROW(maxGrowth <= 1.0, "Maximal growth factor must be larger than 1.");
+
+    m_bAdaptiveSubstepping = true;
+    m_dtSafety = safety;
+    m_dtMaxGrowth = maxGrowth;
+}
+
+
+template <typename TDomain>
+void VDCC_BG_CN<TDomain>::reset_substep_statistics()
+{
+    m_nSteps = 0;
+    m_nSubstepsLast = 0;
+    m_nSubstepsMax = 0;
+    m_nSubstepsTotal = 0;
+    m_nCflEstimates = 0;
+    m_nCflReuses = 0;
+}
+
+
+template <typename TDomain>
+number VDCC_BG_CN<TDomain>::cfl_estimate()
+{
+    ConstSmartPtr<vec_t> spU = m_spSolTimeSeries->latest();
+
+    // reuse last estimate if the solution has hardly changed since
+    if (m_cflReuseTol > 0.0 && m_spUCfl.valid() && m_spUCfl->size() == spU->size())
+    {
+        const vec_t& u = *spU;
+        const vec_t& uCfl = *m_spUCfl;
+        double maxDiff = 0.0;
+        double maxVal = 0.0;
+        const size_t sz = u.size();
+        for (size_t i = 0; i < sz; ++i)
+        {
+            maxDiff = std::max(maxDiff, (double) fabs(u[i] - uCfl[i]));
+            maxVal = std::max(maxVal, (double) fabs(uCfl[i]));
+        }
+
+        // all processes must take the same decision (estimation is collective)
+#ifdef UG_PARALLEL
+        if (pcl::NumProcs() > 1)
+        {
+            pcl::ProcessCommunicator com;
+            double local[2] = {maxDiff, maxVal};
+            double global[2];
+            com.allreduce(local, global, 2, PCL_DT_DOUBLE, PCL_RO_MAX);
+            maxDiff = global[0];
+            maxVal = global[1];
+        }
+#endif
+
+        if (maxDiff <= m_cflReuseTol * maxVal)
+        {
+            ++m_nCflReuses;
+            return m_lastCfl;
+        }
+    }
+
+    m_lastCfl = m_spCableDisc->template estimate_cfl_cond<vec_t>(spU);
+    ++m_nCflEstimates;
+
+    // remember the solution the estimate belongs to
+    if (m_cflReuseTol > 0.0)
+    {
+        if (!m_spUCfl.valid() || m_spUCfl->size() != spU->size())
+            m_spUCfl = spU->clone();
+        else
+        {
+#ifdef UG_PARALLEL
+            VecAssign(*m_spUCfl, *spU);
+#else
+            *m_spUCfl = *spU;
+#endif
+        }
+    }
+
+    return m_lastCfl;
+}
+
+
+template <typename TDomain>
+bool VDCC_BG_CN<TDomain>::adapt_substep_size(number cfl, number timeLeft)
+{
+    const number dtOld = m_dt;
+
+    // shrink immediately if the CFL condition is violated,
+    // grow smoothly (and only noticeably, so that the matrix can be reused in between)
+    const number dtTarget = std::min(m_dtSafety * cfl, m_dtMax);
+    if (m_dtCtrl > cfl)
+        m_dtCtrl = dtTarget;
+    else if (dtTarget > 1.25 * m_dtCtrl)
+        m_dtCtrl = std::min(dtTarget, m_dtMaxGrowth * m_dtCtrl);
+
+    UG_COND_THROW(m_dtCtrl < 1e-5 * m_dtMax, "Time step for 1d cable simulation too small.");
+
+    // do not step over the end of the 3d time step
+    m_dt = std::min(m_dtCtrl, timeLeft);
+
+    if (m_bSolverVerboseOutput && m_dt != dtOld)
+        UG_LOGN("estimated CFL condition: dt < " << cfl << " - changing time step to " << m_dt);
+
+    return m_dt != dtOld;
+}
+
+
 template <typename TDomain>
 void VDCC_BG_CN<TDomain>::init(number time)
 {
@@ -246,6 +424,9 @@ void VDCC_BG_CN<TDomain>::init(number time)
     m_spHNC->set_potential_subsets(this->m_vSubset);
     m_spHNC->set_solution_and_potential_index(m_spU, m_potFctInd);
 	m_spHNC->set_neuron_ids(m_vNID);
+	m_spHNC->set_distributed_potential_mapping(m_bDistributedPotentialMapping);
+	m_spHNC->set_incremental_potential_remapping(m_bIncrementalPotentialRemapping);
+	m_spHNC->set_potential_edge_interpolation(m_bPotEdgeInterpolation);
 
     // ... and communicate current membrane potential values
     m_spHNC->coordinate_potential_values();
@@ -259,10 +440,20 @@ void VDCC_BG_CN<TDomain>::init(number time)
 template <typename TDomain>
 void VDCC_BG_CN<TDomain>::prepare_timestep(number future_time, const number time, VectorProxyBase* upb)
 {
+    NC_TRACE_SCOPE("VDCC_BG_CN::prepare_timestep");
+
     // initiate if this has not already been done
     if (!this->m_initiated)
         init(time);
 
+    // finish a potential exchange started at the end of the previous step (pipelined mode);
+    // potentials are now those of the 1d solution at the start of the 3d step
+    if (m_bPotExchangePending)
+    {
+        m_spHNC->finish_potential_value_exchange();
+        m_bPotExchangePending = false;
+    }
+
     // do nothing if new time is older than we are
     // (might happen in case of external reset due to non-convergence)
     if (future_time <= m_curTime)
@@ -277,12 +468,21 @@ void VDCC_BG_CN<TDomain>::prepare_timestep(number future_time, const number time
         return;
     }
 
+    // pipelined mode: integrate gating with the (lagged) potentials from the start of the step
+    if (m_bPipelinedCoupling)
+        VDCC_BG<TDomain>::prepare_timestep(future_time, time, upb);
+
     // the 1d simulation needs to be updated to the given time
     // modify time step size if needed
-    number nsteps = floor((future_time - m_curTime) / m_dt);
-    if (future_time - (m_curTime + nsteps*m_dt) > 1e-3)
-        m_dt = (future_time - m_curTime) / nsteps;
+    // (the adaptive controller does so in every substep)
+    if (!m_bAdaptiveSubstepping)
+    {
+        number nsteps = floor((future_time - m_curTime) / m_dt);
+        if (future_time - (m_curTime + nsteps*m_dt) > 1e-3)
+            m_dt = (future_time - m_curTime) / nsteps;
+    }
 
+    size_t nSubsteps = 0;
     while (future_time - m_curTime > 1e-4*m_dt)
     {
         // setup time disc for old solutions and time step
@@ -291,32 +491,37 @@ void VDCC_BG_CN<TDomain>::prepare_timestep(number future_time, const number time
         // reduce time step if cfl < m_dt
         // (this needs to be done AFTER prepare_step as channels are updated there)
         bool dtChanged = false;
-        number cfl = m_spCableDisc->template estimate_cfl_cond<vec_t>(m_spSolTimeSeries->latest());
+        number cfl = cfl_estimate();
         if (m_bSolverVerboseOutput)
             UG_LOGN("estimated CFL condition: dt < " << cfl)
-        while (m_dt > cfl)
-        {
-            m_dt = m_dt/2.0;
-
-            UG_COND_THROW(m_stepLv+1 > 15, "Time step for 1d cable simulation too small.");
-
-            ++m_stepLv;
-            m_StepCheckBackCounter[m_stepLv] = 0;
-            if (m_bSolverVerboseOutput)
-                UG_LOGN("estimated CFL condition: dt < " << cfl << " - reducing time step to " << m_dt);
-            dtChanged = true;
-        }
-
-        // increase time step if cfl > m_dt / 2.0 (and if time is aligned with new bigger step size)
-        while (m_dt*2.0 < cfl && m_stepLv > 0 && m_StepCheckBackCounter[m_stepLv] % 2 == 0)
+        if (m_bAdaptiveSubstepping)
+            dtChanged = adapt_substep_size(cfl, future_time - m_curTime);
+        else
         {
-            m_dt *= 2.0;
-            --m_stepLv;
-            m_StepCheckBackCounter[m_stepLv] += m_StepCheckBackCounter[m_stepLv+1]/2.0;
-            m_StepCheckBackCounter[m_stepLv+1] = 0;
-            if (m_bSolverVerboseOutput)
-                UG_LOGN("estimated CFL condition: dt < " << cfl << " - increasing time step to " << m_dt);
-            dtChanged = true;
+            while (m_dt > cfl)
+            {
+                m_dt = m_dt/2.0;
+
+                UG_COND_THROW(m_stepLv+1 > 15, "Time step for 1d cable simulation too small.");
+
+                ++m_stepLv;
+                m_StepCheckBackCounter[m_stepLv] = 0;
+                if (m_bSolverVerboseOutput)
+                    UG_LOGN("estimated CFL condition: dt < " << cfl << " - reducing time step to " << m_dt);
+                dtChanged = true;
+            }
+
+            // increase time step if cfl > m_dt / 2.0 (and if time is aligned with new bigger step size)
+            while (m_dt*2.0 < cfl && m_stepLv > 0 && m_StepCheckBackCounter[m_stepLv] % 2 == 0)
+            {
+                m_dt *= 2.0;
+                --m_stepLv;
+                m_StepCheckBackCounter[m_stepLv] += m_StepCheckBackCounter[m_stepLv+1]/2.0;
+                m_StepCheckBackCounter[m_stepLv+1] = 0;
+                if (m_bSolverVerboseOutput)
+                    UG_LOGN("estimated CFL condition: dt < " << cfl << " - increasing time step to " << m_dt);
+                dtChanged = true;
+            }
         }
 
         if (m_bSolverVerboseOutput)
@@ -340,17 +545,11 @@ void VDCC_BG_CN<TDomain>::prepare_timestep(number future_time, const number time
         m_curTime = m_spSolTimeSeries->time(0) + m_dt;
         m_timeSinceLastPotentialUpdate += m_dt;
 
-        // update potential values and integrate gating params
-        if (m_timeSinceLastPotentialUpdate >= m_dt_potentialUpdate)
-        {
-            // communicate current membrane potential values
-            m_spHNC->coordinate_potential_values();
-
-            // call regular prep timestep from base class
-            VDCC_BG<TDomain>::prepare_timestep(future_time, time, upb);
-
-            m_timeSinceLastPotentialUpdate -= m_dt_potentialUpdate;
-        }
+        // start communication of current membrane potential values (if update is due);
+        // communication is carried out while the remaining 1d work for this step is done
+        const bool potUpdate = !m_bPipelinedCoupling && m_timeSinceLastPotentialUpdate >= m_dt_potentialUpdate;
+        if (potUpdate)
+            m_spHNC->start_potential_value_exchange();
 
         // vtk output, if required
         if (m_bVTKOutput && fabs(m_curTime / m_pstep - floor(m_curTime / m_pstep + 0.5)) < 1e-5)
@@ -365,13 +564,38 @@ void VDCC_BG_CN<TDomain>::prepare_timestep(number future_time, const number time
 #endif
         m_spSolTimeSeries->push_discard_oldest(m_spUOld, m_curTime);
 
+        // update potential values and integrate gating params
+        if (potUpdate)
+        {
+            m_spHNC->finish_potential_value_exchange();
+
+            // call regular prep timestep from base class
+            VDCC_BG<TDomain>::prepare_timestep(future_time, time, upb);
+
+            m_timeSinceLastPotentialUpdate -= m_dt_potentialUpdate;
+        }
+
         // increment check-back counter
         ++m_StepCheckBackCounter[m_stepLv];
+        ++nSubsteps;
 
         if (m_bSolverVerboseOutput)
             UG_LOGN("++++++ POINT IN TIME " << floor(m_curTime / m_dt + 0.5) * m_dt << "  END ++++++");
     }
 
+    // substepping statistics
+    ++m_nSteps;
+    m_nSubstepsLast = nSubsteps;
+    m_nSubstepsMax = std::max(m_nSubstepsMax, nSubsteps);
+    m_nSubstepsTotal += nSubsteps;
+
+    // pipelined mode: communicate potentials while the 3d problem is solved
+    if (m_bPipelinedCoupling)
+    {
+        m_spHNC->start_potential_value_exchange();
+        m_bPotExchangePending = true;
+    }
+
     // end timeseries, produce gathering file if required
     if (m_bVTKOutput)
         m_spVTKOut->write_time_pvd(m_vtkFileName.c_str(), *m_spU);
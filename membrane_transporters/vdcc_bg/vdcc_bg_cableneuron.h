@@ -107,6 +107,15 @@ class VDCC_BG_CN
          */
         void set_coordinate_scale_factor_3d_to_1d(number scale);
 
+        /// set whether the 3d->1d potential mapping is to be computed in a distributed manner
+        void set_distributed_potential_mapping(bool distr);
+
+        /// set whether the 3d->1d potential mapping is to be updated incrementally after 3d grid adaption
+        void set_incremental_potential_remapping(bool incr);
+
+        /// set whether 1d potential values are to be interpolated linearly along 1d edges
+        void set_potential_edge_interpolation(bool edgeInterp);
+
         /// set whether solver output is to be verbose
         void set_solver_output_verbose(bool verbose);
 
@@ -116,6 +125,60 @@ class VDCC_BG_CN
         /// set time step
         void set_time_steps_for_simulation_and_potential_update(number dtSim, number dtPot);
 
+        /**
+         * @brief Set whether 1d and 3d problems are coupled in a pipelined manner.
+         * In pipelined mode, the gating of the 3d step from t_n to t_{n+1} is computed
+         * with the potentials of the 1d solution at t_n (coupling lag of one 3d step).
+         * The 1d problem is then advanced to t_{n+1} and the communication of its
+         * potentials is only started; it is finished at the beginning of the next
+         * 3d step and thus overlaps the 3d solve of the current step.
+         * The potential update interval is the 3d time step in this mode.
+         * Only the communication overlaps the 3d solve; the 1d and 3d problems are
+         * still solved one after the other by the same processes, and the coupling
+         * lag is fixed to one 3d step.
+         * If the grids are adapted or redistributed between two steps, the pending
+         * exchange is finished before the grid changes.
+         */
+        void set_pipelined_coupling(bool pipelined);
+
+        /**
+         * @brief Set a tolerance for the reuse of CFL estimates between 1d substeps.
+         * The CFL estimate of the last substep is reused as long as the 1d solution
+         * has not changed by more than the given tolerance relative to its maximum norm
+         * since the last estimate. A tolerance of 0 (default) disables reuse.
+         */
+        void set_cfl_reuse_tolerance(number relTol);
+
+        /**
+         * @brief Use a continuous adaptive substep size controller for the 1d problem.
+         * The substep size is set to the CFL estimate times a safety factor
+         * (never larger than the simulation time step), growing by at most the given
+         * factor per substep. Without this controller (default), the substep size is
+         * halved or doubled in powers of two of the simulation time step.
+         * @param safety     safety factor (0 < safety <= 1) applied to the CFL estimate
+         * @param maxGrowth  maximal growth factor per substep (> 1)
+         */
+        void set_adaptive_substepping(number safety, number maxGrowth);
+
+        /// number of 1d substeps in the last 3d time step
+        size_t num_substeps_last_step() const {return m_nSubstepsLast;}
+
+        /// maximal number of 1d substeps in a 3d time step
+        size_t max_substeps_per_step() const {return m_nSubstepsMax;}
+
+        /// average number of 1d substeps per 3d time step
+        number average_substeps_per_step() const
+        {return m_nSteps ? (number) m_nSubstepsTotal / m_nSteps : 0.0;}
+
+        /// number of CFL estimates computed
+        size_t num_cfl_estimates() const {return m_nCflEstimates;}
+
+        /// number of CFL estimates reused
+        size_t num_cfl_reuses() const {return m_nCflReuses;}
+
+        /// reset the substepping statistics
+        void reset_substep_statistics();
+
         /// set a communicator object for hybrid neuron treatment
         //unused
         //void set_hybrid_neuron_communicator(SmartPtr<HybridNeuronCommunicator<TDomain> > spHNC);
@@ -136,6 +199,13 @@ class VDCC_BG_CN
         /// @copydoc IMembraneTransporter::print_units()
         virtual void print_units() const;
 
+    protected:
+        /// estimate CFL condition for the latest 1d solution (or reuse the last estimate)
+        number cfl_estimate();
+
+        /// adapt the substep size to the CFL condition; returns whether it changed
+        bool adapt_substep_size(number cfl, number timeLeft);
+
     private:
         SmartPtr<ApproximationSpace<TDomain> > m_spApprox1d;
         SmartPtr<ApproximationSpace<TDomain> > m_spApprox3d;
@@ -155,6 +225,9 @@ class VDCC_BG_CN
 
         size_t m_potFctInd;
         number m_scaleFactor3dTo1d;
+        bool m_bDistributedPotentialMapping;
+        bool m_bIncrementalPotentialRemapping;
+        bool m_bPotEdgeInterpolation;
         bool m_bSolverVerboseOutput;
         bool m_bVTKOutput;
         std::string m_vtkFileName;
@@ -170,6 +243,26 @@ class VDCC_BG_CN
 
         number m_dt_potentialUpdate;
         number m_timeSinceLastPotentialUpdate;
+
+        bool m_bPipelinedCoupling;
+
+        number m_cflReuseTol;
+        number m_lastCfl;
+        SmartPtr<vec_t> m_spUCfl;    ///< 1d solution of the last CFL estimate
+
+        bool m_bAdaptiveSubstepping;
+        number m_dtSafety;
+        number m_dtMaxGrowth;
+        number m_dtMax;              ///< maximal substep size (simulation time step)
+        number m_dtCtrl;             ///< substep size proposed by the controller
+
+        size_t m_nSteps;
+        size_t m_nSubstepsLast;
+        size_t m_nSubstepsMax;
+        size_t m_nSubstepsTotal;
+        size_t m_nCflEstimates;
+        size_t m_nCflReuses;
+        bool m_bPotExchangePending;  ///< whether a potential exchange has been started, but not finished
 };
 
 } // namespace neuro_collection
@@ -72,7 +72,7 @@ void VDCC_BG<TDomain>::set_channel_type()
 		{
 			if (!m_mg->template has_attachment<vm_grid_object>(this->m_HGate))
 				m_mg->template attach_to<vm_grid_object>(this->m_HGate);
-			m_aaHGate = Grid::AttachmentAccessor<vm_grid_object, ADouble>(*m_mg, m_HGate);
+			m_aaHGate = attachment_accessor_type(*m_mg, m_HGate);
 		}
 		else if (!has_hGate() && had_hGate)
 		{
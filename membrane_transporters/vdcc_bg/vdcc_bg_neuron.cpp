@@ -39,6 +39,8 @@
 
 #include "vdcc_bg_neuron.h"
 
+#include "../../util/kd_tree.h"  // for KDTree
+
 namespace ug{
 namespace neuro_collection{
 
@@ -84,12 +86,82 @@ VDCC_BG_VM2UG_NEURON<TDomain>::VDCC_BG_VM2UG_NEURON
 template <typename TDomain>
 VDCC_BG_VM2UG_NEURON<TDomain>::~VDCC_BG_VM2UG_NEURON()
 {
-	// nothing to do
+	if (this->m_mg.valid() && this->m_mg->template has_attachment<vm_grid_object>(m_aVmBufferIndex))
+		this->m_mg->template detach_from<vm_grid_object>(m_aVmBufferIndex);
+}
+
+
+template <typename TDomain>
+void VDCC_BG_VM2UG_NEURON<TDomain>::set_shared_vm_buffer(SmartPtr<SharedVmBuffer<TDomain::dim> > buffer)
+{
+	m_spVmBuffer = buffer;
+}
+
+
+template <typename TDomain>
+void VDCC_BG_VM2UG_NEURON<TDomain>::map_to_vm_buffer()
+{
+	UG_COND_THROW(!m_spVmBuffer->num_points(), "Shared membrane potential buffer has no points.");
+
+	if (!this->m_mg->template has_attachment<vm_grid_object>(m_aVmBufferIndex))
+		this->m_mg->template attach_to<vm_grid_object>(m_aVmBufferIndex);
+	m_aaVmBufferIndex = Grid::AttachmentAccessor<vm_grid_object, AIndex>(*this->m_mg, m_aVmBufferIndex);
+
+	KDTree<TDomain::dim> tree(m_spVmBuffer->points());
+
+	typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator itType;
+	SubsetGroup ssGrp;
+	try {ssGrp = SubsetGroup(this->m_dom->subset_handler(), this->m_vSubset);}
+	UG_CATCH_THROW("Subset group creation failed.");
+
+	const typename TDomain::position_accessor_type& aaPos = this->m_dom->position_accessor();
+	for (std::size_t si = 0; si < ssGrp.size(); si++)
+	{
+		itType iter = this->m_dd->template begin<vm_grid_object>(ssGrp[si]);
+		itType iterEnd = this->m_dd->template end<vm_grid_object>(ssGrp[si]);
+		for (; iter != iterEnd; ++iter)
+		{
+			number distSq;
+			m_aaVmBufferIndex[*iter] = tree.nearest(CalculateCenter(*iter, aaPos), distSq);
+		}
+	}
 }
 
 template<typename TDomain>
 void VDCC_BG_VM2UG_NEURON<TDomain>::init(number time)
 {
+	// potentials from in-memory buffer: map once, then only read values
+	if (m_spVmBuffer.valid())
+	{
+		this->m_time = time;
+		map_to_vm_buffer();
+
+		typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator itType;
+		SubsetGroup ssGrp;
+		try {ssGrp = SubsetGroup(this->m_dom->subset_handler(), this->m_vSubset);}
+		UG_CATCH_THROW("Subset group creation failed.");
+
+		for (std::size_t si = 0; si < ssGrp.size(); si++)
+		{
+			itType iter = this->m_dd->template begin<vm_grid_object>(ssGrp[si]);
+			itType iterEnd = this->m_dd->template end<vm_grid_object>(ssGrp[si]);
+			for (; iter != iterEnd; ++iter)
+			{
+				const number vm = m_spVmBuffer->value(m_aaVmBufferIndex[*iter]);
+				if (this->m_bUseGatingAttachments)
+				{
+					this->m_aaMGate[*iter] = this->calc_gating_start(this->m_gpMGate, vm);
+					if (has_hGate())
+						this->m_aaHGate[*iter] = this->calc_gating_start(this->m_gpHGate, vm);
+				}
+				this->m_aaVm[*iter] = 0.001 * vm; // mV -> V
+			}
+		}
+
+		this->m_initiated = true;
+		return;
+	}
+
 	try
 	{
 		/// init to -65 mV (or to the finalize value supplied to the transformator instance)
@@ -149,6 +221,14 @@ void VDCC_BG_VM2UG_NEURON<TDomain>::update_time(number newTime) {
 	/// only work if really necessary
 	if (newTime == this->m_time) return;
 
+	/// with an in-memory buffer, NEURON is advanced (and the buffer written) elsewhere
+	if (m_spVmBuffer.valid())
+	{
+		this->m_oldTime = this->m_time;
+		this->m_time = newTime;
+		return;
+	}
+
 	/// get dt from NEURON
 	number dt = m_NrnInterpreter.get()->get_dt();
 
@@ -172,6 +252,13 @@ void VDCC_BG_VM2UG_NEURON<TDomain>::update_time(number newTime) {
 template<typename TDomain>
 void VDCC_BG_VM2UG_NEURON<TDomain>::update_potential(vm_grid_object* elem)
 {
+	// read membrane potential from the in-memory buffer (nearest point mapped in init())
+	if (m_spVmBuffer.valid())
+	{
+		this->m_aaVm[elem] = 0.001 * m_spVmBuffer->value(m_aaVmBufferIndex[elem]); // mV -> V
+		return;
+	}
+
 	// retrieve membrane potential via NEURON and the VMProvider/Mapper
 	number vm;
 	try
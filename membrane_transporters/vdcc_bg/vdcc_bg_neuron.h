@@ -44,6 +44,7 @@
 #include "../../plugins/MembranePotentialMapping/neuron_mpm.h"
 
 #include "vdcc_bg.h"
+#include "../../util/shared_vm_buffer.h"  // for SharedVmBuffer
 
 
 namespace ug{
@@ -56,6 +57,12 @@ namespace neuro_collection{
 /** This class is a specialization of the Borg-Graham interface.
  *	It supplies the channel with the necessary membrane potential values by a Vm2uG object,
  *	that has to be fed file names for the files containing the V_m values produced by Neuron.
+ *
+ *	Alternatively, potentials can be taken from a SharedVmBuffer that the NEURON side
+ *	(running in the same process) writes to (set_shared_vm_buffer()). The nearest
+ *	buffer point of each channel location is then determined once in init(), and
+ *	updates only read the current values from the buffer; NEURON is not advanced by
+ *	this class in that case.
 **/
 template<typename TDomain>
 class VDCC_BG_VM2UG_NEURON : public VDCC_BG<TDomain>
@@ -158,14 +165,29 @@ private:
 			this->m_mapper = mapper;
 		}
 
+		/**
+		 * @brief take membrane potentials from an in-memory buffer
+		 * The buffer's point layout must be set before init() is called
+		 * (and init() must be called again if it changes or the grid is adapted).
+		 */
+		void set_shared_vm_buffer(SmartPtr<SharedVmBuffer<TDomain::dim> > buffer);
+
 	private:
 		/// whether this channel has an inactivating gate
 		bool has_hGate() {return this->m_channelType == VDCC_BG<TDomain>::BG_Ntype
 								|| this->m_channelType == VDCC_BG<TDomain>::BG_Ttype;}
 
+		/// map channel locations to their nearest shared buffer points
+		void map_to_vm_buffer();
+
 	private:
 		std::string m_tFmt;				//!< time format for the membrane potential files
 		number m_vmTime;
+
+		typedef Attachment<size_t> AIndex;
+		SmartPtr<SharedVmBuffer<TDomain::dim> > m_spVmBuffer;	//!< in-memory potential source (if set)
+		AIndex m_aVmBufferIndex;									//!< nearest buffer point per channel location
+		Grid::AttachmentAccessor<vm_grid_object, AIndex> m_aaVmBufferIndex;
 };
 
 
@@ -38,6 +38,7 @@
  */
 
 #include "vdcc_bg_userdata.h"
+#include "../../util/expression_user_data.h"  // for ExpressionUserData
 
 
 namespace ug{
@@ -84,6 +85,13 @@ void VDCC_BG_UserData<TDomain>::set_potential_function(const char* name)
 		return;
 	}
 
+	// closed-form expression in x, y, z and t (evaluated natively)
+	if (ExpressionUserData<dim>::is_valid(name))
+	{
+		set_potential_function(make_sp(new ExpressionUserData<dim>(name)));
+		return;
+	}
+
 	// no match found
 	if (!CheckLuaCallbackName(name))
 		UG_THROW("Lua-Callback with name '" << name << "' does not exist.");
@@ -101,13 +109,31 @@ void VDCC_BG_UserData<TDomain>::set_potential_function(const number value)
 	else set_potential_function(make_sp(new ConstUserNumber<dim>(value)));
 
 	m_bIsConstData = true;
+	this->set_uniform_potential_mode(true);
 }
 
 template<typename TDomain>
 void VDCC_BG_UserData<TDomain>::set_potential_function(SmartPtr<CplUserData<number, dim> > spPotFct)
 {
 	m_spPotential = spPotFct;
+	m_spAPTrain = SPNULL;
 	m_bIsConstData = false;
+	this->set_uniform_potential_mode(false);
+}
+
+template<typename TDomain>
+void VDCC_BG_UserData<TDomain>::set_potential_function(SmartPtr<ActionPotentialTrain> spAPTrain)
+{
+	m_spPotential = SPNULL;
+	m_spAPTrain = spAPTrain;
+	m_bIsConstData = false;
+	this->set_uniform_potential_mode(true);
+}
+
+template<typename TDomain>
+void VDCC_BG_UserData<TDomain>::set_isopotential(bool b)
+{
+	this->set_uniform_potential_mode(b);
 }
 
 
@@ -120,7 +146,9 @@ void VDCC_BG_UserData<TDomain>::update_potential(vm_grid_object* elem)
 	// fill attachments with renewed values
 	const typename TDomain::position_type& coords = CalculateCenter(elem, this->m_aaPos);
 	number vm = -0.065;
-	if (this->m_spPotential.valid())
+	if (m_spAPTrain.valid())
+		vm = 1e-3 * m_spAPTrain->membrane_potential(this->m_time);
+	else if (this->m_spPotential.valid())
 		(*this->m_spPotential)(vm, coords, this->m_time, this->m_sh->get_subset_index(elem));
 
 	// set membrane potential value
@@ -129,6 +157,26 @@ void VDCC_BG_UserData<TDomain>::update_potential(vm_grid_object* elem)
 
 
 
+template<typename TDomain>
+number VDCC_BG_UserData<TDomain>::uniform_potential()
+{
+	if (m_spAPTrain.valid())
+		return 1e-3 * m_spAPTrain->membrane_potential(this->m_time);
+
+	// the function is independent of space; evaluate anywhere on the first subset
+	number vm = -0.065;
+	if (this->m_spPotential.valid())
+	{
+		UG_COND_THROW(this->m_vSubset.empty(), "No subsets given for " << this->name() << ".");
+		const int si = this->m_sh->get_subset_index(this->m_vSubset[0].c_str());
+		const typename TDomain::position_type x(0.0);
+		(*this->m_spPotential)(vm, x, this->m_time, si);
+	}
+
+	return vm;
+}
+
+
 // explicit template specializations
 #ifdef UG_DIM_1
 	template class VDCC_BG_UserData<Domain1d>;
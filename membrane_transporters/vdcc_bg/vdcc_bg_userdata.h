@@ -41,6 +41,7 @@
 #define UG__PLUGINS__NEURO_COLLECTION__MEMBRANE_TRANSPORTERS__VDCC_BG__VDCC_BG_USERDATA_H
 
 #include "vdcc_bg.h"
+#include "../../stimulation/action_potential_train.h"  // for ActionPotentialTrain
 
 namespace ug{
 namespace neuro_collection{
@@ -105,11 +106,32 @@ class VDCC_BG_UserData : public VDCC_BG<TDomain>
 		void set_potential_function(const number value);
 		void set_potential_function(SmartPtr<CplUserData<number, dim> > spPotFct);
 
+		/// use an (isopotential) action potential train as potential
+		/**
+		 * The train is evaluated once per time step (not per vertex);
+		 * use ActionPotentialTrain::set_tabulation() for a cheaper evaluation.
+		 */
+		void set_potential_function(SmartPtr<ActionPotentialTrain> spAPTrain);
+
+		/// declare the potential function to be independent of space
+		/**
+		 * For constant potentials and action potential trains, this is detected
+		 * automatically. For a (Lua) function depending on the time only, it can be
+		 * declared here (after setting the function). The potential is then evaluated
+		 * only once per time step and the gates are integrated for all vertices at once.
+		**/
+		void set_isopotential(bool b);
+
 		/// @copydoc VDCC_BG<TDomain>::update_potential()
 		virtual void update_potential(vm_grid_object* elem);
 
+	protected:
+		/// @copydoc VDCC_BG<TDomain>::uniform_potential()
+		virtual number uniform_potential();
+
 	private:
 		SmartPtr<CplUserData<number,dim> > m_spPotential;		//!< the UserData for potential
+		SmartPtr<ActionPotentialTrain> m_spAPTrain;				//!< AP train for potential (in mV)
 		bool m_bIsConstData;
 };
 
@@ -39,7 +39,9 @@
 
 #include "vdcc_bg_vm2ug.h"
 
-#include <locale>	// for control over the decimal separator (point instead of comma, please!)
+#include <algorithm>	// for std::min
+#include <limits>	// for std::numeric_limits
+
 
 
 namespace ug {
@@ -63,10 +65,10 @@ VDCC_BG_VM2UG<TDomain>::VDCC_BG_VM2UG
 )
 : VDCC_BG<TDomain>(fcts, subsets, approx),
  /// m_vmProvider(baseName, ext, !posCanChange), m_tFmt(timeFmt),
-  m_vmProvider(), m_tFmt(timeFmt),
+  m_curProvider(0), m_interpWeight(0.0), m_bInterpolate(false), m_tFmt(timeFmt),
   m_fileInterval(0.0), m_fileOffset(0.0), m_baseName(baseName), m_ext(ext)
 {
-	// nothing further to do
+	m_vProviderTime[0] = m_vProviderTime[1] = std::numeric_limits<number>::quiet_NaN();
 }
 
 template <typename TDomain>
@@ -82,10 +84,10 @@ VDCC_BG_VM2UG<TDomain>::VDCC_BG_VM2UG
 )
 : VDCC_BG<TDomain>(fcts, subsets, approx),
  /// m_vmProvider(baseName, ext, !posCanChange), m_tFmt(timeFmt),
-  m_vmProvider(), m_tFmt(timeFmt),
+  m_curProvider(0), m_interpWeight(0.0), m_bInterpolate(false), m_tFmt(timeFmt),
   m_fileInterval(0.0), m_fileOffset(0.0), m_baseName(baseName), m_ext(ext)
 {
-	// nothing further to do
+	m_vProviderTime[0] = m_vProviderTime[1] = std::numeric_limits<number>::quiet_NaN();
 }
 
 
@@ -97,34 +99,20 @@ VDCC_BG_VM2UG<TDomain>::~VDCC_BG_VM2UG()
 
 
 template<typename TDomain>
-void VDCC_BG_VM2UG<TDomain>::init(number time)
+void VDCC_BG_VM2UG<TDomain>::set_binary_potential_file(const std::string& fileName)
 {
-	// fill attachments with initial values
+	try {m_vmSeries.open(fileName);}
+	UG_CATCH_THROW("Binary potential file could not be opened.");
+}
 
-	// truncate time to last time that data exists for (if known)
-	number vm_time;
-	if (m_fileInterval >= 1e-9)
-		vm_time = floor((time-m_fileOffset)/m_fileInterval)*m_fileInterval;
-	else
-		vm_time = time;
 
-	try
-	{
-		char buffer[100];
-		char* oldLocale = setlocale (LC_ALL, NULL);
-		setlocale(LC_NUMERIC, "C");		// ensure decimal point is a . (not a ,)
-		sprintf(buffer, m_tFmt.c_str(), vm_time);
-		setlocale(LC_NUMERIC, oldLocale);
-		m_timeAsString = buffer;
-	}
-	UG_CATCH_THROW("Time format string provided does not meet requirements.\n"
-				<< "It must contain exactly one placeholder (which has to convert a floating point number)"
-				<< "and must not produce an output string longer than 100 chars.");
+template<typename TDomain>
+void VDCC_BG_VM2UG<TDomain>::init(number time)
+{
+	// fill attachments with initial values
 
-	try {m_vmProvider.build_tree(m_baseName + m_timeAsString + m_ext);}
-	UG_CATCH_THROW("Underlying Vm2uG object could not build its tree on given file.\n"
-		<< "If this is due to an inappropriate point in time, you might consider\n"
-		"using set_file_times(fileInterval, fileOffset).");
+	this->m_time = time;
+	update_files();
 
 	typedef typename DoFDistribution::traits<vm_grid_object>::const_iterator itType;
 	SubsetGroup ssGrp;
@@ -144,7 +132,7 @@ void VDCC_BG_VM2UG<TDomain>::init(number time)
 			try
 			{
 				const typename TDomain::position_type& coords = CalculateCenter(*iter, aaPos);
-				vm = m_vmProvider.get_vm(coords);
+				vm = vm_at(coords);
 			}
 			UG_CATCH_THROW("Vm2uG object failed to retrieve a membrane potential for the vertex.");
 
@@ -158,7 +146,6 @@ void VDCC_BG_VM2UG<TDomain>::init(number time)
 		}
 	}
 
-	this->m_time = time;
 	this->m_initiated = true;
 }
 
@@ -170,29 +157,93 @@ void VDCC_BG_VM2UG<TDomain>::update_time(number newTime)
 	if (newTime == this->m_time)
 		return;
 
+	this->m_oldTime = this->m_time;
+	this->m_time = newTime;
+	update_files();
+}
+
+
+template<typename TDomain>
+number VDCC_BG_VM2UG<TDomain>::file_time(number t) const
+{
 	// truncate time to last time that data exists for (if known)
-	number vm_time;
 	if (m_fileInterval >= 1e-9)
-		vm_time = floor((newTime-m_fileOffset)/m_fileInterval)*m_fileInterval;
-	else
-		vm_time = newTime;
+		return m_fileOffset + floor((t-m_fileOffset)/m_fileInterval + 1e-9)*m_fileInterval;
+	return t;
+}
 
-	try
+
+template<typename TDomain>
+size_t VDCC_BG_VM2UG<TDomain>::load_potential_file(number fileTime)
+{
+	// already loaded
+	for (size_t i = 0; i < 2; ++i)
+		if (fabs(m_vProviderTime[i] - fileTime) < 1e-12)
+			return i;
+
+	// load into the slot not holding the current file (time NaN if no file loaded)
+	const size_t slot = (m_vProviderTime[m_curProvider] == m_vProviderTime[m_curProvider])
+		? 1 - m_curProvider : m_curProvider;
+
+	try {m_timeAsString = FormatVmFileTime(m_tFmt, fileTime);}
+	UG_CATCH_THROW("Could not format time for potential file name.");
+
+	m_vProviderTime[slot] = std::numeric_limits<number>::quiet_NaN();
+	try {m_vmProvider[slot].build_tree(m_baseName + m_timeAsString + m_ext);}
+	UG_CATCH_THROW("Underlying Vm2uG object could not build its tree on file '"
+		<< m_baseName + m_timeAsString + m_ext << "'.\n"
+		<< "If this is due to an inappropriate point in time, you might consider\n"
+		"using set_file_times(fileInterval, fileOffset).");
+	m_vProviderTime[slot] = fileTime;
+
+	return slot;
+}
+
+
+template<typename TDomain>
+void VDCC_BG_VM2UG<TDomain>::update_files()
+{
+	const number t = this->m_time;
+
+	if (m_vmSeries.is_open())
+	{
+		// only swaps the value arrays
+		if (m_bInterpolate)
+			m_vmSeries.select_time_interpolated(t);
+		else
+			m_vmSeries.select_time(m_vmSeries.time_index(t));
+		return;
+	}
+
+	UG_COND_THROW(m_bInterpolate && m_fileInterval < 1e-9,
+		"Interpolation between potential files requires the file times to be set.\n"
+		"Use set_file_times(fileInterval, fileOffset).");
+
+	// only (re-)build trees if the file changes
+	const number fileTime = file_time(t);
+	m_curProvider = load_potential_file(fileTime);
+	m_interpWeight = 0.0;
+
+	if (m_bInterpolate && t > fileTime)
 	{
-		char buffer[100];
-		char* oldLocale = setlocale (LC_ALL, NULL);
-		setlocale(LC_NUMERIC, "C");		// ensure decimal point is a . (not a ,)
-		sprintf(buffer, m_tFmt.c_str(), vm_time);
-		setlocale(LC_NUMERIC, oldLocale);
-		m_timeAsString = buffer;
+		// keeps the current file, as it is not in the slot to be loaded into
+		load_potential_file(fileTime + m_fileInterval);
+		m_interpWeight = std::min((t - fileTime) / m_fileInterval, 1.0);
 	}
-	UG_CATCH_THROW("Time format string provided does not meet requirements.\n"
-				<< "It must contain exactly one placeholder (which has to convert a floating point number)"
-				<< "and must not produce an output string longer than 100 chars.");
+}
 
-	m_vmProvider.build_tree(m_baseName + m_timeAsString + m_ext);
-	this->m_oldTime = this->m_time;
-	this->m_time = newTime;
+
+template<typename TDomain>
+number VDCC_BG_VM2UG<TDomain>::vm_at(const typename TDomain::position_type& coords)
+{
+	if (m_vmSeries.is_open())
+		return m_vmSeries.vm(coords);
+
+	const number vm = m_vmProvider[m_curProvider].get_vm(coords);
+	if (!m_interpWeight)
+		return vm;
+
+	return vm + m_interpWeight * (m_vmProvider[1 - m_curProvider].get_vm(coords) - vm);
 }
 
 
@@ -204,7 +255,7 @@ void VDCC_BG_VM2UG<TDomain>::update_potential(vm_grid_object* elem)
 	try
 	{
 		const typename TDomain::position_type& coords = CalculateCenter(elem, this->m_aaPos);
-		vm = m_vmProvider.get_vm(coords);
+		vm = vm_at(coords);
 	}
 	UG_CATCH_THROW("Vm2uG object failed to retrieve a membrane potential for the vertex.");
 
@@ -44,6 +44,7 @@
 #include "../../plugins/MembranePotentialMapping/neuron_mpm.h"
 
 #include "vdcc_bg.h"
+#include "../../util/vm_time_series.h"
 
 
 namespace ug {
@@ -148,12 +149,55 @@ class VDCC_BG_VM2UG : public VDCC_BG<TDomain>
 			m_fileOffset = fileOffset;
 		}
 
+		/**
+		 * @brief use a preprocessed binary potential file instead of text files
+		 * The binary file contains the potential values for all points in time
+		 * (cf. VmTimeSeries). It is memory-mapped and its search tree is built once,
+		 * so changing the point in time does not read or parse any file.
+		 * The file times set by set_file_times() are ignored in this case;
+		 * the times of the binary file are used instead.
+		 *
+		 * @param fileName	name of the binary potential file
+		 */
+		void set_binary_potential_file(const std::string& fileName);
+
+		/**
+		 * @brief linearly interpolate potentials between two consecutive files
+		 * By default, the potential of the last file not after the current time is used.
+		 * With interpolation, the potentials of this and the following file are
+		 * interpolated linearly, so that potentials can be stored at coarser intervals.
+		 * For text files, this requires the file times to be set (set_file_times()).
+		 *
+		 * @param b		whether to interpolate
+		 */
+		void set_time_interpolation(bool b) {m_bInterpolate = b;}
+
 	private:
-		membrane_potential_mapping::Vm2uGMPM<TDomain::dim> m_vmProvider;		    //!< the Vm2uG object
+		/// last point in time not after t for which a potential file exists
+		number file_time(number t) const;
+
+		/// make sure the potential text file for the given time is loaded in one of the two slots
+		size_t load_potential_file(number fileTime);
+
+		/// select the potential data for the current time (loading files if necessary)
+		void update_files();
+
+		/// potential (in mV) at the given coordinates
+		number vm_at(const typename TDomain::position_type& coords);
+
+	private:
+		/// the Vm2uG objects: double buffer for the current and the following file
+		membrane_potential_mapping::Vm2uGMPM<TDomain::dim> m_vmProvider[2];
+		number m_vProviderTime[2];		//!< file times loaded into the Vm2uG objects (NaN: none)
+		size_t m_curProvider;			//!< Vm2uG object for the current file
+		number m_interpWeight;			//!< interpolation weight of the following file
+		bool m_bInterpolate;			//!< whether to interpolate between files
 		std::string m_tFmt;				//!< time format for the membrane potential files
 		number m_fileInterval;			//!< intervals in which voltage files are available
 		number m_fileOffset;			//!< offset of time intervals for which voltage files are available
 
+		VmTimeSeries<TDomain::dim> m_vmSeries;	//!< binary potential time series (if used)
+
 		std::string m_timeAsString;
 		std::string m_baseName;
 		std::string m_ext;
@@ -0,0 +1,630 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+
+#include "multi_membrane_transport_1d.h"
+#include "bindings/lua/lua_user_data.h"
+#include "lib_disc/spatial_disc/disc_util/geom_provider.h"
+#include "lib_grid/global_attachments.h"  // for GlobalAttachments
+#include "util/expression_user_data.h"  // for ExpressionUserData
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template<typename TDomain>
+MultiMembraneTransport1d<TDomain>::MultiMembraneTransport1d(const char* subsets)
+: IElemDisc<TDomain>("", ""), m_radiusFactor(1.0), m_constRadius(1e-6), m_bConstRadiusSet(false),
+  m_aDiameter(GlobalAttachments::attachment<ANumber>("diameter")),
+  m_bVolumeScaling(false), m_currSI(-1)
+{
+	this->IElemDisc<TDomain>::set_subsets(subsets);
+}
+
+
+template<typename TDomain>
+MultiMembraneTransport1d<TDomain>::MultiMembraneTransport1d(const std::vector<std::string>& subsets)
+: IElemDisc<TDomain>("", ""), m_radiusFactor(1.0), m_constRadius(1e-6), m_bConstRadiusSet(false),
+  m_aDiameter(GlobalAttachments::attachment<ANumber>("diameter")),
+  m_bVolumeScaling(false), m_currSI(-1)
+{
+	this->IElemDisc<TDomain>::set_subsets(subsets);
+}
+
+
+template<typename TDomain>
+MultiMembraneTransport1d<TDomain>::~MultiMembraneTransport1d()
+{}
+
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::add_membrane_transporter
+(
+	SmartPtr<IMembraneTransporter> mt,
+	SmartPtr<CplUserData<number,dim> > densityFct
+)
+{
+	UG_COND_THROW(!mt.valid(), "Invalid membrane transport mechanism given.");
+	UG_COND_THROW(!densityFct.valid(), "No density information given for "
+		<< mt->name() << " membrane transport mechanism.");
+
+	// check validity of transporter setup and then lock
+	mt->check_and_lock();
+
+	TransporterEntry te;
+	te.spMT = mt;
+	te.spDensityFct = densityFct;
+	te.bConstDensity = false;
+	te.constDensity = 0.0;
+
+	// map supplied functions of the mechanism to functions of this disc
+	const std::vector<std::string>& vFct = mt->symb_fcts();
+	const size_t nFct = vFct.size();
+	te.vFctMap.resize(nFct);
+	for (size_t i = 0; i < nFct; ++i)
+	{
+		size_t j = 0;
+		for (; j < m_vFct.size(); ++j)
+			if (m_vFct[j] == vFct[i])
+				break;
+		if (j == m_vFct.size())
+		{
+			m_vFct.push_back(vFct[i]);
+			m_vVolFrac.push_back(1.0);
+		}
+		te.vFctMap[i] = j;
+	}
+
+	m_vTransporter.push_back(te);
+
+	this->IElemDisc<TDomain>::set_functions(m_vFct);
+}
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const number dens)
+{
+	add_membrane_transporter(mt, make_sp(new ConstUserNumber<dim>(dens)));
+}
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const char* name)
+{
+	// name must be a valid lua function name conforming to LuaUserNumber specs
+	if (LuaUserData<number, dim>::check_callback_returns(name))
+	{
+		add_membrane_transporter(mt, LuaUserDataFactory<number, dim>::create(name));
+		return;
+	}
+
+	// closed-form expression in x, y, z and t (evaluated natively)
+	if (ExpressionUserData<dim>::is_valid(name))
+	{
+		add_membrane_transporter(mt, make_sp(new ExpressionUserData<dim>(name)));
+		return;
+	}
+
+	// no match found
+	if (!CheckLuaCallbackName(name))
+		UG_THROW("Lua-Callback with name '" << name << "' does not exist.");
+
+	// name exists, but wrong signature
+	UG_THROW("Cannot find matching callback signature. Use:\n"
+			"Number - Callback\n" << (LuaUserData<number, dim>::signature()) << "\n");
+}
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::set_radius(number r)
+{
+	m_constRadius = r;
+	m_bConstRadiusSet = true;
+}
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::set_radius_factor(number r)
+{
+	m_radiusFactor = r;
+	update_geometry_factors();
+}
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::update_geometry_factors()
+{
+	m_vGeomFactorsValid.clear();
+}
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::set_volume_scaling(bool b)
+{
+	m_bVolumeScaling = b;
+}
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::set_volume_fraction(const char* fct, number frac)
+{
+	UG_COND_THROW(frac <= 0.0, "Volume fraction must be positive.");
+
+	const size_t nFct = m_vFct.size();
+	for (size_t i = 0; i < nFct; ++i)
+	{
+		if (m_vFct[i] == fct)
+		{
+			m_vVolFrac[i] = frac;
+			return;
+		}
+	}
+
+	UG_THROW("Function '" << fct << "' is not used by any of the membrane transport mechanisms "
+		"added to MultiMembraneTransport1d so far.");
+}
+
+
+template<typename TDomain>
+size_t MultiMembraneTransport1d<TDomain>::map_fct(const TransporterEntry& te, size_t i) const
+{
+	if (i == (size_t) InnerBoundaryConstants::_IGNORE_)
+		return i;
+
+	UG_ASSERT(i < te.vFctMap.size(), "Local function index " << i << " of "
+		<< te.spMT->name() << " membrane transport mechanism out of range.");
+	return te.vFctMap[i];
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::approximation_space_changed()
+{
+	SmartPtr<MultiGrid> grid = this->approx_space()->domain()->grid();
+
+	// handle diameter attachment
+	if (!grid->has_attachment<Vertex>(m_aDiameter))
+	{
+		if (!m_bConstRadiusSet)
+			UG_LOG("HINT: The geometry you are using does not contain diameter information\n"
+				"and you did not provide radius information either. Using default radius of "
+				<< m_constRadius << "m.");
+
+		grid->attach_to_vertices_dv(m_aDiameter, 2.0 * m_constRadius);
+	}
+	else
+	{
+		if (m_bConstRadiusSet)
+		{
+			UG_LOG("HINT: Even though you have explicitly set a constant diameter to the domain\n"
+				   "      MultiMembraneTransport1d will use the diameter information attached to the grid\n"
+				   "      you specified.\n");
+		}
+	}
+
+	// this will distribute the attachment values to the whole grid
+	m_dah.set_attachment(m_aDiameter);
+	m_dah.set_grid(grid);
+
+	m_aaDiameter = Grid::VertexAttachmentAccessor<ANumber>(*grid, m_aDiameter);
+
+	// geometry factors (computed per subset on first use)
+	if (!grid->has_attachment<Edge>(m_aAreaFactors))
+		grid->attach_to_edges(m_aAreaFactors);
+	m_aaAreaFactors = Grid::EdgeAttachmentAccessor<AGeomFactors>(*grid, m_aAreaFactors);
+	if (!grid->has_attachment<Edge>(m_aCrossSections))
+		grid->attach_to_edges(m_aCrossSections);
+	m_aaCrossSections = Grid::EdgeAttachmentAccessor<AGeomFactors>(*grid, m_aCrossSections);
+	m_vGeomFactorsValid.clear();
+
+	m_spGridAdaptionCallbackID = grid->message_hub()->register_class_callback(this,
+		&MultiMembraneTransport1d<TDomain>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid->message_hub()->register_class_callback(this,
+		&MultiMembraneTransport1d<TDomain>::grid_distribution_callback);
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		m_vGeomFactorsValid.clear();
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		m_vGeomFactorsValid.clear();
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::compute_geometry_factors(int si)
+{
+	SmartPtr<TDomain> dom = this->approx_space()->domain();
+	const typename TDomain::position_accessor_type& aaPos = dom->position_accessor();
+	ConstSmartPtr<MGSubsetHandler> sh = dom->subset_handler();
+
+	// the SCVs of an edge are its halves
+	typedef geometry_traits<Edge>::const_iterator EdgeIter;
+	const size_t nLvl = sh->num_levels();
+	for (size_t lvl = 0; lvl < nLvl; ++lvl)
+	{
+		EdgeIter it = sh->begin<Edge>(si, lvl);
+		EdgeIter itEnd = sh->end<Edge>(si, lvl);
+		for (; it != itEnd; ++it)
+		{
+			Edge* e = *it;
+			const number halfLength = 0.5 * VecDistance(aaPos[e->vertex(0)], aaPos[e->vertex(1)]);
+			MathVector<2>& area = m_aaAreaFactors[e];
+			MathVector<2>& crossSection = m_aaCrossSections[e];
+			for (size_t co = 0; co < 2; ++co)
+			{
+				const number diam = m_aaDiameter[e->vertex(co)];
+				area[co] = halfLength * PI * diam * m_radiusFactor;
+				crossSection[co] = 0.25 * PI * diam * diam;
+			}
+		}
+	}
+
+	if (m_vGeomFactorsValid.size() <= (size_t) si)
+		m_vGeomFactorsValid.resize(si + 1, false);
+	m_vGeomFactorsValid[si] = true;
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::corner_scales(Edge* e, std::vector<number>& vScale) const
+{
+	const MathVector<2>& area = m_aaAreaFactors[e];
+	const size_t nFct = m_vFct.size();
+	vScale.resize(2*nFct);
+	if (!m_bVolumeScaling)
+	{
+		for (size_t f = 0; f < nFct; ++f)
+		{
+			vScale[2*f] = area[0];
+			vScale[2*f + 1] = area[1];
+		}
+		return;
+	}
+
+	const MathVector<2>& crossSection = m_aaCrossSections[e];
+	for (size_t f = 0; f < nFct; ++f)
+	{
+		vScale[2*f] = area[0] / (m_vVolFrac[f] * crossSection[0]);
+		vScale[2*f + 1] = area[1] / (m_vVolFrac[f] * crossSection[1]);
+	}
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::
+prepare_setting(const std::vector<LFEID>& vLfeID, bool bNonRegularGrid)
+{
+	UG_COND_THROW(m_vTransporter.empty(), "No membrane transport mechanism has been added "
+		"to MultiMembraneTransport1d. Please add using add_membrane_transporter().");
+
+	// check that Lagrange 1st order
+	for (size_t i = 0; i < vLfeID.size(); ++i)
+		if (vLfeID[i].type() != LFEID::LAGRANGE || vLfeID[i].order() != 1)
+			UG_THROW("MultiMembraneTransport1d: 1st order Lagrange expected.");
+
+	// provide scratch buffers for all threads
+	m_batchScratch.ensure_capacity();
+	m_scaleScratch.ensure_capacity();
+	for (size_t t = 0; t < m_vTransporter.size(); ++t)
+		m_vTransporter[t].spMT->prepare_threads();
+
+	// update assemble functions
+	register_assembling_funcs();
+}
+
+template<typename TDomain>
+bool MultiMembraneTransport1d<TDomain>::
+use_hanging() const
+{
+	return false;
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::prep_timestep
+(
+    number future_time,
+    number time,
+    VectorProxyBase* upb
+)
+{
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+		m_vTransporter[t].spMT->prepare_timestep(future_time, time, upb);
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+prep_elem_loop(const ReferenceObjectID roid, const int si)
+{
+	m_currSI = si;
+
+	// constant densities only need to be evaluated once
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+	{
+		TransporterEntry& te = m_vTransporter[t];
+		te.bConstDensity = te.spDensityFct->constant();
+		if (te.bConstDensity)
+			(*te.spDensityFct)(te.constDensity, MathVector<dim>(0.0), this->time(), si);
+	}
+
+	// the geometry factors are shared by all threads
+#ifdef _OPENMP
+	#pragma omp critical (nc_mmt1d_geom_factors)
+#endif
+	{
+		if (m_vGeomFactorsValid.size() <= (size_t) si || !m_vGeomFactorsValid[si])
+			compute_geometry_factors(si);
+	}
+}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+fsh_elem_loop()
+{}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+prep_elem(const LocalVector& u, GridObject* elem, const ReferenceObjectID roid, const MathVector<dim> vCornerCoords[])
+{
+	// update geometry for this element
+	static TFVGeom& geo = GeomProvider<TFVGeom>::get();
+	try {geo.update(elem, vCornerCoords, &(this->subset_handler()));}
+	UG_CATCH_THROW("MultiMembraneTransport1d::prep_elem: "
+						"Cannot update Finite Volume Geometry.");
+}
+
+template<typename TDomain>
+template<typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+gather_batch_input
+(
+	const TransporterEntry& te,
+	const TFVGeom& fvgeom,
+	const LocalVector& u,
+	GridObject* elem,
+	BatchScratch& bs
+)
+{
+	// solution of the functions supplied to the mechanism at SCV corners
+	// in structure-of-arrays layout
+	const size_t nFct = te.vFctMap.size();
+	const size_t nScv = fvgeom.num_scv();
+	bs.vU.resize(nFct * nScv);
+	bs.vElem.assign(nScv, elem);
+	for (size_t i = 0; i < nScv; ++i)
+	{
+		const int co = fvgeom.scv(i).node_id();
+		for (size_t fct = 0; fct < nFct; ++fct)
+			bs.vU[fct*nScv + i] = u(te.vFctMap[fct], co);
+	}
+}
+
+template<typename TDomain>
+template<typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+corner_densities(const TransporterEntry& te, const TFVGeom& fvgeom, number* vDensity)
+{
+	const size_t nScv = fvgeom.num_scv();
+	if (te.bConstDensity)
+	{
+		for (size_t i = 0; i < nScv; ++i)
+			vDensity[i] = te.constDensity;
+		return;
+	}
+
+	// evaluate at all SCV corners in one call
+	MathVector<dim> vCoords[2];
+	for (size_t i = 0; i < nScv; ++i)
+		vCoords[i] = fvgeom.scv(i).global_corner(0);
+	(*te.spDensityFct)(vDensity, vCoords, this->time(), m_currSI, nScv);
+}
+
+// assemble stiffness part of Jacobian
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+add_jac_A_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{
+	// get finite volume geometry
+	const static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+
+	// scales of the fluxes into each function at both corners (only edges are registered)
+	std::vector<number>& vScale = m_scaleScratch.local();
+	corner_scales(static_cast<TElem*>(elem), vScale);
+
+	const size_t nScv = fvgeom.num_scv();
+	BatchScratch& bs = m_batchScratch.local();
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+	{
+		const TransporterEntry& te = m_vTransporter[t];
+		IMembraneTransporter& mt = *te.spMT;
+
+		// evaluate flux derivatives of this mechanism for all SCVs in one batch
+		gather_batch_input(te, fvgeom, u, elem, bs);
+		mt.flux_deriv_batch(bs.vU, bs.vElem, bs.vDerivFct, bs.vDeriv);
+
+		number vDensity[2];
+		corner_densities(te, fvgeom, vDensity);
+
+		const size_t nFlux = mt.n_fluxes();
+		const size_t nDep = mt.n_dependencies();
+		for (size_t i = 0; i < nScv; ++i)
+		{
+			// get associated node
+			const int co = fvgeom.scv(i).node_id();
+
+			// add to Jacobian
+			for (size_t j = 0; j < nFlux; ++j)
+			{
+				const std::pair<size_t, size_t> fromTo = mt.flux_from_to(j);
+				const size_t from = map_fct(te, fromTo.first);
+				const size_t to = map_fct(te, fromTo.second);
+				for (size_t k = 0; k < nDep; ++k)
+				{
+					const size_t fct = te.vFctMap[bs.vDerivFct[j*nDep + k]];
+					const number val = bs.vDeriv[(j*nDep + k)*nScv + i] * vDensity[i];
+					if (from != InnerBoundaryConstants::_IGNORE_)
+						J(from, co, fct, co) += val * vScale[2*from + co];
+					if (to != InnerBoundaryConstants::_IGNORE_)
+						J(to, co, fct, co) -= val * vScale[2*to + co];
+				}
+			}
+		}
+	}
+}
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+add_jac_M_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{}
+
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+add_def_A_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{
+	// get finite volume geometry
+	static TFVGeom& fvgeom = GeomProvider<TFVGeom>::get();
+
+	// scales of the fluxes into each function at both corners (only edges are registered)
+	std::vector<number>& vScale = m_scaleScratch.local();
+	corner_scales(static_cast<TElem*>(elem), vScale);
+
+	const size_t nScv = fvgeom.num_scv();
+	BatchScratch& bs = m_batchScratch.local();
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+	{
+		const TransporterEntry& te = m_vTransporter[t];
+		IMembraneTransporter& mt = *te.spMT;
+
+		// evaluate fluxes of this mechanism for all SCVs in one batch
+		gather_batch_input(te, fvgeom, u, elem, bs);
+		mt.flux_batch(bs.vU, bs.vElem, bs.vFlux);
+
+		number vDensity[2];
+		corner_densities(te, fvgeom, vDensity);
+
+		const size_t nFlux = mt.n_fluxes();
+		for (size_t i = 0; i < nScv; ++i)
+		{
+			// get associated node
+			const int co = fvgeom.scv(i).node_id();
+
+			// add to defect
+			for (size_t j = 0; j < nFlux; ++j)
+			{
+				const std::pair<size_t, size_t> fromTo = mt.flux_from_to(j);
+				const size_t from = map_fct(te, fromTo.first);
+				const size_t to = map_fct(te, fromTo.second);
+				const number flux = bs.vFlux[j*nScv + i] * vDensity[i];
+				if (from != InnerBoundaryConstants::_IGNORE_)
+					d(from, co) += flux * vScale[2*from + co];
+				if (to != InnerBoundaryConstants::_IGNORE_)
+					d(to, co) -= flux * vScale[2*to + co];
+			}
+		}
+	}
+}
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+add_def_M_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{}
+
+template<typename TDomain>
+template<typename TElem, typename TFVGeom>
+void MultiMembraneTransport1d<TDomain>::
+add_rhs_elem(LocalVector& rhs, GridObject* elem, const MathVector<dim> vCornerCoords[])
+{}
+
+
+
+template<typename TDomain>
+void MultiMembraneTransport1d<TDomain>::register_assembling_funcs()
+{
+	// register prep_timestep function for all known algebra types
+	RegisterPrepTimestepFct<bridge::CompileAlgebraList>(this);
+
+	// register assembling functionality
+	typedef RegularEdge TElem;
+	typedef FV1Geometry<TElem, dim> TFVGeom;
+	typedef MultiMembraneTransport1d<TDomain> T;
+	const ReferenceObjectID id = geometry_traits<TElem>::REFERENCE_OBJECT_ID;
+
+	this->clear_add_fct(id);
+	this->set_prep_elem_loop_fct(id, &T::template prep_elem_loop<TElem, TFVGeom>);
+	this->set_prep_elem_fct(id, &T::template prep_elem<TElem, TFVGeom>);
+	this->set_add_def_A_elem_fct(id, &T::template add_def_A_elem<TElem, TFVGeom>);
+	this->set_add_def_M_elem_fct(id, &T::template add_def_M_elem<TElem, TFVGeom>);
+	this->set_add_rhs_elem_fct(id, &T::template add_rhs_elem<TElem, TFVGeom>);
+	this->set_add_jac_A_elem_fct(id, &T::template add_jac_A_elem<TElem, TFVGeom>);
+	this->set_add_jac_M_elem_fct(id, &T::template add_jac_M_elem<TElem, TFVGeom>);
+	this->set_fsh_elem_loop_fct(id, &T::template fsh_elem_loop<TElem, TFVGeom>);
+}
+
+
+// explicit template specializations
+#ifdef UG_DIM_1
+	template class MultiMembraneTransport1d<Domain1d>;
+#endif
+#ifdef UG_DIM_2
+	template class MultiMembraneTransport1d<Domain2d>;
+#endif
+#ifdef UG_DIM_3
+	template class MultiMembraneTransport1d<Domain3d>;
+#endif
+
+
+} // end namespace neuro_collection
+} // end namespace ug
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__MULTI_MEMBRANE_TRANSPORT_1D_H
+#define UG__PLUGINS__NEURO_COLLECTION__MULTI_MEMBRANE_TRANSPORT_1D_H
+
+
+#include "common/util/smart_pointer.h"
+#include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
+#include "membrane_transporters/membrane_transporter_interface.h"
+#include "util/thread_scratch.h"	// for ThreadScratch
+#include "../cable_neuron/util/diam_attachment_handler.h"	// attachment handling for diameter attachment
+
+#include <string>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/// 1d discretization for several membrane transport mechanisms on a rotationally symmetric membrane
+/**
+ * This class does the same as a set of MembraneTransport1d objects (one per transport
+ * mechanism) defined on the same subsets, but it visits each edge of the membrane only
+ * once, evaluating all transport mechanisms (with their densities) in batches for both
+ * edge corners. Mechanisms are added as in MultiMembraneTransportFV1; the functions of
+ * this discretization are the union of the functions of all mechanisms.
+ *
+ * The membrane area (depending on the diameter, the radius factor and the SCV length)
+ * and the cross section (depending on the diameter) associated with each edge corner
+ * are computed once per subset and stored in edge attachments. They are recomputed
+ * after grid adaption or redistribution and after a change of the radius factor;
+ * if diameters are changed otherwise, update_geometry_factors() has to be called.
+ *
+ * By default, fluxes are integrated over the membrane area of an SCV, so the bulk
+ * discretizations (diffusion, buffering) have to be scaled by the cross section of
+ * their compartment. If volume scaling is enabled (cf. set_volume_scaling()), the
+ * fluxes into and out of each function are divided by the cross section of the
+ * compartment of the function (volume fraction times cable cross section) instead,
+ * so that unscaled bulk discretizations (e.g. BufferFV1) can be used for the
+ * reduced model.
+ */
+template<typename TDomain>
+class MultiMembraneTransport1d
+: public IElemDisc<TDomain>
+{
+	public:
+		///	world dimension
+		static const int dim = IElemDisc<TDomain>::dim;
+
+	public:
+		/// constructor with c-string
+		MultiMembraneTransport1d(const char* subsets);
+
+		/// constructor with vector
+		MultiMembraneTransport1d(const std::vector<std::string>& subsets);
+
+		/// destructor
+		virtual ~MultiMembraneTransport1d();
+
+		/// add a transport mechanism with its density in the membrane
+		void add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, SmartPtr<CplUserData<number,dim> > densityFct);
+
+		/// add a transport mechanism with constant density in the membrane
+		void add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const number dens);
+
+		/// add a transport mechanism with its density in the membrane given as Lua function
+		void add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const char* name);
+
+		/// number of transport mechanisms
+		size_t num_membrane_transporters() const {return m_vTransporter.size();}
+
+		/// set radius of plasma membrane
+		void set_radius(number r);
+
+		/// set plasma membrane radius fraction at which membrane (ERM or PM) is located
+		void set_radius_factor(number r);
+
+		/// recompute the membrane area and cross section factors (e.g., after the diameters have been changed)
+		void update_geometry_factors();
+
+		/// divide fluxes by the cross section of the compartment of the respective function
+		void set_volume_scaling(bool b);
+
+		/// set the fraction of the cable cross section occupied by the compartment of a function (default: 1)
+		void set_volume_fraction(const char* fct, number frac);
+
+	public:	// inherited from IElemDisc
+		/// @copydoc IElemDisc::approximation_space_changed()
+		virtual void approximation_space_changed();
+
+		///	type of trial space for each function used
+		virtual void prepare_setting(const std::vector<LFEID>& vLfeID, bool bNonRegularGrid);
+
+		///	returns if hanging nodes are used
+		virtual bool use_hanging() const;
+
+		/// @copydoc IElemDisc<TDomain>::prepare_timestep()
+		void prep_timestep(number future_time, number time, VectorProxyBase* upb);
+
+		///	prepares the loop over all elements
+		template<typename TElem, typename TFVGeom>
+		void prep_elem_loop(const ReferenceObjectID roid, const int si);
+
+		///	prepares the element for assembling
+		template<typename TElem, typename TFVGeom>
+		void prep_elem(const LocalVector& u, GridObject* elem, const ReferenceObjectID roid, const MathVector<dim> vCornerCoords[]);
+
+		///	finishes the loop over all elements
+		template<typename TElem, typename TFVGeom>
+		void fsh_elem_loop();
+
+		///	assembles the local stiffness matrix using a finite volume scheme
+		template<typename TElem, typename TFVGeom>
+		void add_jac_A_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+		///	assembles the local mass matrix using a finite volume scheme
+		template<typename TElem, typename TFVGeom>
+		void add_jac_M_elem(LocalMatrix& J, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+		///	assembles the stiffness part of the local defect
+		template<typename TElem, typename TFVGeom>
+		void add_def_A_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+		///	assembles the mass part of the local defect
+		template<typename TElem, typename TFVGeom>
+		void add_def_M_elem(LocalVector& d, const LocalVector& u, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+		///	assembles the local right hand side
+		template<typename TElem, typename TFVGeom>
+		void add_rhs_elem(LocalVector& rhs, GridObject* elem, const MathVector<dim> vCornerCoords[]);
+
+	private:
+		template <typename List>
+		struct RegisterPrepTimestepFct
+		{
+			RegisterPrepTimestepFct(MultiMembraneTransport1d* p)
+			{
+				static const bool isEmpty = boost::mpl::empty<List>::value;
+				(typename boost::mpl::if_c<isEmpty, RegEnd, RegNext>::type (p));
+			}
+
+			struct RegEnd
+			{
+				RegEnd(MultiMembraneTransport1d*) {}
+			};
+
+			struct RegNext
+			{
+				RegNext(MultiMembraneTransport1d* p)
+				{
+					typedef typename boost::mpl::front<List>::type AlgebraType;
+					typedef typename boost::mpl::pop_front<List>::type NextList;
+
+					size_t aid = bridge::AlgebraTypeIDProvider::instance().id<AlgebraType>();
+					p->set_prep_timestep_fct(aid, &MultiMembraneTransport1d::prep_timestep);
+
+					(RegisterPrepTimestepFct<NextList> (p));
+				}
+			};
+		};
+
+		void register_assembling_funcs();
+
+		/// transport mechanism with its density and function mapping
+		struct TransporterEntry
+		{
+			SmartPtr<IMembraneTransporter> spMT;
+			SmartPtr<CplUserData<number,dim> > spDensityFct;
+
+			/// index of supplied functions of the mechanism in the functions of this disc
+			std::vector<size_t> vFctMap;
+
+			/// density value if the density function is constant (in the current subset)
+			bool bConstDensity;
+			number constDensity;
+		};
+
+		/// scratch buffers for batched flux evaluation
+		struct BatchScratch
+		{
+			std::vector<number> vU;
+			std::vector<GridObject*> vElem;
+			std::vector<number> vFlux;
+			std::vector<size_t> vDerivFct;
+			std::vector<number> vDeriv;
+		};
+
+		/// gather solution at all SCV corners for batched flux evaluation of one mechanism
+		template <typename TFVGeom>
+		void gather_batch_input
+		(
+			const TransporterEntry& te,
+			const TFVGeom& fvgeom,
+			const LocalVector& u,
+			GridObject* elem,
+			BatchScratch& bs
+		);
+
+		/// densities of a mechanism at the SCV corners of the current element
+		template <typename TFVGeom>
+		void corner_densities(const TransporterEntry& te, const TFVGeom& fvgeom, number* vDensity);
+
+		/// factors by which fluxes into the functions are scaled at both corners of an edge
+		void corner_scales(Edge* e, std::vector<number>& vScale) const;
+
+		/// map a transporter-local function index to a local index of this disc
+		size_t map_fct(const TransporterEntry& te, size_t i) const;
+
+		/// compute the geometry factors for all edges of a subset
+		void compute_geometry_factors(int si);
+
+		/// grid change callbacks (invalidating the geometry factors)
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	protected:
+		number m_radiusFactor;
+		number m_constRadius;
+		bool m_bConstRadiusSet;
+		ANumber m_aDiameter;									 ///< diameter attachment
+		Grid::AttachmentAccessor<Vertex, ANumber> m_aaDiameter;  ///< diameter attachment accessor
+		cable_neuron::DiamAttachmentHandler m_dah;				 ///< handler for multigrid usage of diameter attachment
+
+	private:
+		std::vector<TransporterEntry> m_vTransporter;
+
+		/// union of the functions of all mechanisms
+		std::vector<std::string> m_vFct;
+
+		/// volume scaling and volume fractions of the compartments (per function)
+		bool m_bVolumeScaling;
+		std::vector<number> m_vVolFrac;
+
+		int m_currSI;
+
+		/// membrane area (pi * diameter * radius factor * SCV length) for both edge corners
+		typedef Attachment<MathVector<2> > AGeomFactors;
+		AGeomFactors m_aAreaFactors;
+		Grid::EdgeAttachmentAccessor<AGeomFactors> m_aaAreaFactors;
+
+		/// cable cross section (pi * diameter^2 / 4) for both edge corners
+		AGeomFactors m_aCrossSections;
+		Grid::EdgeAttachmentAccessor<AGeomFactors> m_aaCrossSections;
+		std::vector<bool> m_vGeomFactorsValid;  ///< per subset
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+
+		/// scratch buffers for batched flux evaluation and scales (one set per thread)
+		ThreadScratch<BatchScratch> m_batchScratch;
+		ThreadScratch<std::vector<number> > m_scaleScratch;
+};
+
+///@}
+
+} // end namespace neuro_collection
+} // end namespace ug
+
+
+#endif  // UG__PLUGINS__NEURO_COLLECTION__MULTI_MEMBRANE_TRANSPORT_1D_H
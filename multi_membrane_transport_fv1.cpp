@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "multi_membrane_transport_fv1.h"
+#include "bindings/lua/lua_user_data.h"
+#include "util/expression_user_data.h"  // for ExpressionUserData
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template<typename TDomain>
+MultiMembraneTransportFV1<TDomain>::MultiMembraneTransportFV1(const char* subsets)
+: FV1InnerBoundaryElemDisc<TDomain>()
+{
+	this->IElemDisc<TDomain>::set_subsets(subsets);
+}
+
+template<typename TDomain>
+MultiMembraneTransportFV1<TDomain>::MultiMembraneTransportFV1(const std::vector<std::string>& subsets)
+: FV1InnerBoundaryElemDisc<TDomain>()
+{
+	this->IElemDisc<TDomain>::set_subsets(subsets);
+}
+
+template<typename TDomain>
+MultiMembraneTransportFV1<TDomain>::~MultiMembraneTransportFV1()
+{
+	// nothing to do
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransportFV1<TDomain>::add_membrane_transporter
+(
+	SmartPtr<IMembraneTransporter> mt,
+	SmartPtr<CplUserData<number,dim> > densityFct
+)
+{
+	UG_COND_THROW(!mt.valid(), "Invalid membrane transport mechanism given.");
+	UG_COND_THROW(!densityFct.valid(), "No density information given for "
+		<< mt->name() << " membrane transport mechanism.");
+
+	// check validity of transporter setup and then lock
+	mt->check_and_lock();
+
+	TransporterEntry te;
+	te.spMT = mt;
+	te.spDensityFct = densityFct;
+
+	// map supplied functions of the mechanism to functions of this disc
+	const std::vector<std::string>& vFct = mt->symb_fcts();
+	const size_t nFct = vFct.size();
+	te.vFctMap.resize(nFct);
+	for (size_t i = 0; i < nFct; ++i)
+	{
+		size_t j = 0;
+		for (; j < m_vFct.size(); ++j)
+			if (m_vFct[j] == vFct[i])
+				break;
+		if (j == m_vFct.size())
+			m_vFct.push_back(vFct[i]);
+		te.vFctMap[i] = j;
+	}
+
+	// prepare scratch buffers
+	te.prepare_scratch();
+
+	m_vTransporter.push_back(te);
+
+	this->IElemDisc<TDomain>::set_functions(m_vFct);
+
+	update_flux_slots();
+}
+
+template<typename TDomain>
+void MultiMembraneTransportFV1<TDomain>::add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const number dens)
+{
+	add_membrane_transporter(mt, make_sp(new ConstUserNumber<dim>(dens)));
+}
+
+template<typename TDomain>
+void MultiMembraneTransportFV1<TDomain>::add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const char* name)
+{
+	// name must be a valid lua function name conforming to LuaUserNumber specs
+	if (LuaUserData<number, dim>::check_callback_returns(name))
+	{
+		add_membrane_transporter(mt, LuaUserDataFactory<number, dim>::create(name));
+		return;
+	}
+
+	// closed-form expression in x, y, z and t (evaluated natively)
+	if (ExpressionUserData<dim>::is_valid(name))
+	{
+		add_membrane_transporter(mt, make_sp(new ExpressionUserData<dim>(name)));
+		return;
+	}
+
+	// no match found
+	if (!CheckLuaCallbackName(name))
+		UG_THROW("Lua-Callback with name '" << name << "' does not exist.");
+
+	// name exists, but wrong signature
+	UG_THROW("Cannot find matching callback signature. Use:\n"
+			"Number - Callback\n" << (LuaUserData<number, dim>::signature()) << "\n");
+}
+
+
+template<typename TDomain>
+size_t MultiMembraneTransportFV1<TDomain>::map_fct(const TransporterEntry& te, size_t i) const
+{
+	if (i == (size_t) InnerBoundaryConstants::_IGNORE_)
+		return i;
+
+	UG_ASSERT(i < te.vFctMap.size(), "Local function index " << i << " of "
+		<< te.spMT->name() << " membrane transport mechanism out of range.");
+	return te.vFctMap[i];
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransportFV1<TDomain>::update_flux_slots()
+{
+	m_vSlotFrom.clear();
+	m_vSlotTo.clear();
+
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+	{
+		TransporterEntry& te = m_vTransporter[t];
+		const size_t nFlux = te.spMT->n_fluxes();
+		te.vFluxSlot.resize(nFlux);
+		for (size_t i = 0; i < nFlux; ++i)
+		{
+			const std::pair<size_t, size_t> fromTo = te.spMT->flux_from_to(i);
+			const size_t from = map_fct(te, fromTo.first);
+			const size_t to = map_fct(te, fromTo.second);
+
+			// merge with an existing flux between the same functions
+			size_t s = 0;
+			for (; s < m_vSlotFrom.size(); ++s)
+				if (m_vSlotFrom[s] == from && m_vSlotTo[s] == to)
+					break;
+			if (s == m_vSlotFrom.size())
+			{
+				m_vSlotFrom.push_back(from);
+				m_vSlotTo.push_back(to);
+			}
+			te.vFluxSlot[i] = s;
+		}
+	}
+}
+
+
+template<typename TDomain>
+bool MultiMembraneTransportFV1<TDomain>::fluxDensityFct
+(
+	const std::vector<LocalVector::value_type>& u,
+	GridObject* e,
+	const MathVector<dim>& coords,
+	int si,
+	FluxCond& fc
+)
+{
+	const size_t nSlot = m_vSlotFrom.size();
+
+	// (resizing does not allocate if fc is reused)
+	fc.flux.assign(nSlot, 0.0);
+	fc.from.resize(nSlot);
+	fc.to.resize(nSlot);
+	for (size_t s = 0; s < nSlot; ++s)
+	{
+		fc.from[s] = m_vSlotFrom[s];
+		fc.to[s] = m_vSlotTo[s];
+	}
+
+	const number time = this->time();
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+	{
+		TransporterEntry& te = m_vTransporter[t];
+		typename TransporterEntry::Scratch& ts = te.scratch.local();
+
+		// gather values of the functions supplied to the mechanism
+		const size_t nFct = te.vFctMap.size();
+		for (size_t i = 0; i < nFct; ++i)
+			ts.vU[i] = u[te.vFctMap[i]];
+
+		// single-channel flux
+		te.spMT->flux(ts.vU, e, ts.vFlux);
+
+		// density in membrane
+		number density;
+		(*te.spDensityFct)(density, coords, time, si);
+
+		const size_t nFlux = ts.vFlux.size();
+		for (size_t i = 0; i < nFlux; ++i)
+			fc.flux[te.vFluxSlot[i]] += density * ts.vFlux[i];
+	}
+
+	return true;
+}
+
+
+template<typename TDomain>
+bool MultiMembraneTransportFV1<TDomain>::fluxDensityDerivFct
+(
+	const std::vector<LocalVector::value_type>& u,
+	GridObject* e,
+	const MathVector<dim>& coords,
+	int si,
+	FluxDerivCond& fdc
+)
+{
+	const size_t nSlot = m_vSlotFrom.size();
+	const size_t nFctAll = m_vFct.size();
+
+	// merged fluxes may depend on any function of this disc
+	// (resizing does not allocate if fdc is reused)
+	fdc.fluxDeriv.resize(nSlot);
+	fdc.from.resize(nSlot);
+	fdc.to.resize(nSlot);
+	for (size_t s = 0; s < nSlot; ++s)
+	{
+		fdc.fluxDeriv[s].resize(nFctAll);
+		for (size_t c = 0; c < nFctAll; ++c)
+		{
+			fdc.fluxDeriv[s][c].first = c;
+			fdc.fluxDeriv[s][c].second = 0.0;
+		}
+		fdc.from[s] = m_vSlotFrom[s];
+		fdc.to[s] = m_vSlotTo[s];
+	}
+
+	const number time = this->time();
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+	{
+		TransporterEntry& te = m_vTransporter[t];
+		typename TransporterEntry::Scratch& ts = te.scratch.local();
+
+		// gather values of the functions supplied to the mechanism
+		const size_t nFct = te.vFctMap.size();
+		for (size_t i = 0; i < nFct; ++i)
+			ts.vU[i] = u[te.vFctMap[i]];
+
+		// single-channel flux derivatives
+		te.spMT->flux_deriv(ts.vU, e, ts.vFluxDeriv);
+
+		// density in membrane
+		number density;
+		(*te.spDensityFct)(density, coords, time, si);
+
+		const size_t nFlux = ts.vFluxDeriv.size();
+		for (size_t i = 0; i < nFlux; ++i)
+		{
+			const size_t nDep = ts.vFluxDeriv[i].size();
+			std::vector<std::pair<size_t, number> >& slotDeriv = fdc.fluxDeriv[te.vFluxSlot[i]];
+			for (size_t j = 0; j < nDep; ++j)
+			{
+				const std::pair<size_t, number>& d = ts.vFluxDeriv[i][j];
+				slotDeriv[te.vFctMap[d.first]].second += density * d.second;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransportFV1<TDomain>::prepare_setting(const std::vector<LFEID>& vLfeID, bool bNonRegularGrid)
+{
+	UG_COND_THROW(m_vTransporter.empty(), "No membrane transport mechanism has been added "
+		"to MultiMembraneTransportFV1. Please add using add_membrane_transporter().");
+
+	// set assembling functions from base class first
+	this->FV1InnerBoundaryElemDisc<TDomain>::prepare_setting(vLfeID, bNonRegularGrid);
+
+	// flux directions do not change during assembling
+	update_flux_slots();
+
+	// provide scratch buffers for all threads
+	for (size_t t = 0; t < m_vTransporter.size(); ++t)
+		m_vTransporter[t].prepare_scratch();
+
+	// update assemble functions
+	register_all_fv1_funcs();
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransportFV1<TDomain>::prep_timestep
+(
+    number future_time,
+    number time,
+    VectorProxyBase* upb
+)
+{
+	const size_t nMT = m_vTransporter.size();
+	for (size_t t = 0; t < nMT; ++t)
+		m_vTransporter[t].spMT->prepare_timestep(future_time, time, upb);
+}
+
+
+template<typename TDomain>
+void MultiMembraneTransportFV1<TDomain>::register_all_fv1_funcs()
+{
+	// register prep_timestep function for all known algebra types
+	Register<bridge::CompileAlgebraList>(this);
+}
+
+
+
+// explicit template specializations
+#ifdef UG_DIM_1
+	template class MultiMembraneTransportFV1<Domain1d>;
+#endif
+#ifdef UG_DIM_2
+	template class MultiMembraneTransportFV1<Domain2d>;
+#endif
+#ifdef UG_DIM_3
+	template class MultiMembraneTransportFV1<Domain3d>;
+#endif
+
+
+} // end namespace neuro_collection
+} // end namespace ug
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__MULTI_MEMBRANE_TRANSPORT_FV1_H
+#define UG__PLUGINS__NEURO_COLLECTION__MULTI_MEMBRANE_TRANSPORT_FV1_H
+
+
+#include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
+#include "common/util/smart_pointer.h"
+#include "membrane_transporters/membrane_transporter_interface.h"
+#include "util/thread_scratch.h"  // for ThreadScratch
+
+#include <string>
+#include <utility>  // for std::pair
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/// Finite Volume discretization for several membrane transport mechanisms on the same membrane
+/**
+ * This class does the same as a set of MembraneTransportFV1 objects (one per transport
+ * mechanism) defined on the same subsets, but it visits each integration point of the
+ * membrane only once, evaluating all transport mechanisms (and their densities) there and
+ * accumulating their fluxes and flux derivatives.
+ *
+ * Transport mechanisms are added together with their densities using
+ * add_membrane_transporter(). The functions of this discretization are the union of the
+ * functions of all transport mechanisms (in their order of appearance).
+ * Fluxes of different mechanisms between the same pair of functions are merged,
+ * e.g. the PMCA, NCX and leakage fluxes from cytosol to extracellular space are handed
+ * to the assembling as one single flux.
+ */
+template<typename TDomain>
+class MultiMembraneTransportFV1
+: public FV1InnerBoundaryElemDisc<TDomain>
+{
+	protected:
+		typedef MultiMembraneTransportFV1<TDomain> this_type;
+		typedef typename FV1InnerBoundaryElemDisc<TDomain>::FluxCond FluxCond;
+		typedef typename FV1InnerBoundaryElemDisc<TDomain>::FluxDerivCond FluxDerivCond;
+
+	public:
+	///	world dimension
+		static const int dim = TDomain::dim;
+
+	public:
+	/// constructor with c-string
+		MultiMembraneTransportFV1(const char* subsets);
+
+	/// constructor with vector
+		MultiMembraneTransportFV1(const std::vector<std::string>& subsets);
+
+	/// destructor
+		virtual ~MultiMembraneTransportFV1();
+
+	public:
+	/// add a transport mechanism with its density in the membrane
+		void add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, SmartPtr<CplUserData<number,dim> > densityFct);
+
+	/// add a transport mechanism with constant density in the membrane
+		void add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const number dens);
+
+	/// add a transport mechanism with its density in the membrane given as Lua function
+		void add_membrane_transporter(SmartPtr<IMembraneTransporter> mt, const char* name);
+
+	/// number of transport mechanisms
+		size_t num_membrane_transporters() const {return m_vTransporter.size();}
+
+	/// @copydoc FV1InnerBoundary<TDomain>::fluxDensityFct()
+		virtual bool fluxDensityFct
+		(
+			const std::vector<LocalVector::value_type>& u,
+			GridObject* e,
+			const MathVector<dim>& coords,
+			int si,
+			FluxCond& fc
+		);
+
+	/// @copydoc FV1InnerBoundary<TDomain>::fluxDensityDerivFct()
+		virtual bool fluxDensityDerivFct
+		(
+			const std::vector<LocalVector::value_type>& u,
+			GridObject* e,
+			const MathVector<dim>& coords,
+			int si,
+			FluxDerivCond& fdc
+		);
+
+	/// @copydoc IElemDisc<TDomain>::prepare_setting()
+		virtual void prepare_setting(const std::vector<LFEID>& vLfeID, bool bNonRegularGrid);
+
+	/// @copydoc IElemDisc<TDomain>::prep_timestep()
+		void prep_timestep(number future_time, number time, VectorProxyBase* upb);
+
+	protected:
+		/// transport mechanism with its density and index mappings
+		struct TransporterEntry
+		{
+			SmartPtr<IMembraneTransporter> spMT;
+			SmartPtr<CplUserData<number,dim> > spDensityFct;
+
+			/// index of supplied functions of the mechanism in the functions of this disc
+			std::vector<size_t> vFctMap;
+
+			/// index of mechanism fluxes in the (merged) fluxes of this disc
+			std::vector<size_t> vFluxSlot;
+
+			/// scratch buffers (avoiding allocation in every call)
+			struct Scratch
+			{
+				std::vector<number> vU;
+				std::vector<number> vFlux;
+				std::vector<std::vector<std::pair<size_t, number> > > vFluxDeriv;
+			};
+			ThreadScratch<Scratch> scratch;  ///< one set of buffers per thread
+
+			/// size scratch buffers of all threads
+			void prepare_scratch()
+			{
+				scratch.ensure_capacity();
+				const size_t nFct = vFctMap.size();
+				const size_t nFlux = spMT->n_fluxes();
+				const size_t nDep = spMT->n_dependencies();
+				for (size_t t = 0; t < scratch.size(); ++t)
+				{
+					Scratch& ts = scratch[t];
+					ts.vU.resize(nFct);
+					ts.vFlux.resize(nFlux);
+					ts.vFluxDeriv.resize(nFlux);
+					for (size_t i = 0; i < nFlux; ++i)
+						ts.vFluxDeriv[i].resize(nDep);
+				}
+				spMT->prepare_threads();
+			}
+		};
+
+	private:
+		template <typename List>
+		struct Register
+		{
+			Register(this_type* p)
+			{
+				static const bool isEmpty = boost::mpl::empty<List>::value;
+				(typename boost::mpl::if_c<isEmpty, RegEnd, RegNext>::type (p));
+			}
+
+			struct RegEnd
+			{
+				RegEnd(this_type*) {}
+			};
+
+			struct RegNext
+			{
+				RegNext(this_type* p)
+				{
+					typedef typename boost::mpl::front<List>::type AlgebraType;
+					typedef typename boost::mpl::pop_front<List>::type NextList;
+
+					size_t aid = bridge::AlgebraTypeIDProvider::instance().id<AlgebraType>();
+					p->set_prep_timestep_fct(aid, &this_type::prep_timestep);
+
+					(Register<NextList> (p));
+				}
+			};
+		};
+
+		void register_all_fv1_funcs();
+
+		/// compute merged flux directions and the flux mappings of all mechanisms
+		void update_flux_slots();
+
+		/// map a transporter-local function index to a local index of this disc
+		size_t map_fct(const TransporterEntry& te, size_t i) const;
+
+	private:
+		std::vector<TransporterEntry> m_vTransporter;
+
+		/// union of the functions of all mechanisms
+		std::vector<std::string> m_vFct;
+
+		/// directions of merged fluxes
+		std::vector<size_t> m_vSlotFrom;
+		std::vector<size_t> m_vSlotTo;
+};
+
+///@}
+
+} // end namespace neuro_collection
+} // end namespace ug
+
+
+#endif  // UG__PLUGINS__NEURO_COLLECTION__MULTI_MEMBRANE_TRANSPORT_FV1_H
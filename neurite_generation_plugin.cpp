@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "neurite_generation_plugin.h"
+
+#include "bridge/util.h"
+#include "lib_grid/global_attachments.h"  // for GlobalAttachments::declare_attachment
+#include "lib_grid/refinement/projectors/neurite_projector.h"  // for NeuriteProjector
+
+// configuration file for compile options
+#include "nc_config.h"
+
+#include "grid_generation/neurites_from_swc.h"
+#include "grid_generation/polygonal_mesh_from_txt.h"
+#include "test/test_neurite_proj.h"
+#include "test/neurite_math_util.h"
+#include "test/grid_generation_stages.h"
+#include "test/grid_generation_benchmark.h"
+#include "test/tetrahedralize_util.h"
+
+
+using namespace std;
+using namespace ug::bridge;
+
+namespace ug {
+namespace neuro_collection {
+
+
+void RegisterNeuriteGeneration(Registry& reg, string grp)
+{
+	// neurites from swc
+	{
+		reg.add_function("import_neurites_from_swc", &neurites_from_swc::import_neurites_from_swc, "",
+			"file name # anisotropy # refinements", "");
+		reg.add_function("import_er_neurites_from_swc", &neurites_from_swc::import_er_neurites_from_swc, "",
+			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements", "");
+		reg.add_function("import_1d_neurites_from_swc", &neurites_from_swc::import_1d_neurites_from_swc, "",
+			"file name # anisotropy # refinements", "");
+		reg.add_function("import_1d_neurites_from_swc_electrotonic", &neurites_from_swc::import_1d_neurites_from_swc_electrotonic, "",
+			"input file name # output file name # max edge length / lambda_f # frequency (Hz) # "
+			"specific axial resistance (Ohm m) # specific capacitance (F/m^2) # refinements # scale",
+			"Generates a 1d grid with edge lengths chosen by the d_lambda rule.");
+	}
+
+	// grid generation
+	{
+		reg.add_function("polygonal_mesh_from_txt", static_cast<void (*)(const std::string&, const vector3&, const vector3&,
+			const vector3&, const vector3&)>(&polygonal_mesh_from_txt), "", "TXT input file|string");
+		reg.add_function("polygonal_mesh_from_txt", static_cast<void (*)(const std::string&, const vector3&, const vector3&,
+			const vector3&, const vector3&, Grid&, SubsetHandler&)>(&polygonal_mesh_from_txt), "",
+			"TXT input file|string # p1 # p2 # p3 # p4 # grid # subset handler",
+			"Creates the polygonal mesh in the given (empty) grid instead of a UGX file.");
+	}
+
+	// test neurite projector
+	{
+		reg.add_function("test_neurite_projector", &test_neurite_projector_with_four_section_tube, "", "", "");
+		reg.add_function("test_neurite_projector_with_bp", &test_neurite_projector_with_four_section_tube_and_branch_point, "", "", "");
+		reg.add_function("test_import_swc_with_er", &test_import_swc_with_er, "",
+			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize", "");
+		reg.add_function("test_import_swc_general", &test_import_swc_general, "",
+			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements", "");
+		reg.add_function("test_import_swc_general_var", &test_import_swc_general_var, "",
+			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize # blow up factor # for VR # dryRun# option # segLength", "");
+		reg.add_function("set_grid_generation_dump_stages", &SetGridGenerationDumpStages, "",
+			"comma-separated stage names or \"all\" (swc correction, soma creation, neurite connection, tetrahedralization, projection)",
+			"Enables intermediate grid dumps for stages of test_import_swc_general_var (default: none).");
+		reg.add_function("set_tetrahedralize_sub_volumes", &SetTetrahedralizeSubVolumes, "",
+			"enable",
+			"Tetrahedralizes independent sub-volumes of the soma concurrently in the SWC grid generation (default: false).");
+		reg.add_function("run_grid_generation_benchmark", &RunGridGenerationBenchmark, "",
+			"benchmark suite file # JSON output file",
+			"Runs all SWC files of a benchmark suite with all its parameter sets and writes timings, element counts and quality statistics to JSON.");
+		reg.add_function("run_batch_grid_generation", &RunBatchGridGeneration, "",
+			"suite file # output directory # JSON report file",
+			"Generates grids for all SWC files of a suite with all its parameter sets (distributed over MPI processes, failures isolated per case), using the mesh cache, and writes a JSON report.");
+		reg.add_function("test_import_swc_general_var_benchmark", &test_import_swc_general_var_benchmark, "",
+			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize # blow up factor # for VR # dryRun# option # segLength", "");
+		reg.add_function("test_import_swc_general_var_benchmark_var", &test_import_swc_general_var_benchmark_var, "",
+			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize # blow up factor # for VR # dryRun# option # segLength", "");
+		reg.add_function("test_import_swc_general_var_for_vr", &test_import_swc_general_var_for_vr, "",
+			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize # blow up factor", "");
+		reg.add_function("test_import_swc_surf", &test_import_swc_surf, "", "file name", "");
+		reg.add_function("test_import_swc_1d", &test_import_swc_1d, "", "file name # anisotropy # refinements", "");
+		reg.add_function("test_convert_swc_to_ugx", &test_convert_swc_to_ugx, "", "file name");
+		reg.add_function("refine_swc_grid", &refine_swc_grid, "", "");
+		reg.add_function("refine_swc_grid_variant", &refine_swc_grid_variant, "input file name # output file name", "");
+		reg.add_function("coarsen_1d_grid", &coarsen_1d_grid, "input file name", "output file name");
+		reg.add_function("test_import_swc_vr", &test_import_swc_vr, "Filename # anisotropy # numRefs");
+		reg.add_function("test_import_swc_general_var_for_vr_var", &test_import_swc_general_var_for_vr_var, "");
+		reg.add_function("test_import_swc_general_var_for_vr_var_benchmark", &test_import_swc_general_var_for_vr_var_benchmark, "");
+		reg.add_function("create_branches_from_swc", static_cast<void (*)(const std::string&, number, size_t, bool)>(&create_branches_from_swc), "", "input file name # ER scale factor # number of refinements # create measurement subsets", "");
+		reg.add_function("create_branches_from_swc", static_cast<void (*)(const std::string&, number, size_t)>(&create_branches_from_swc), "", "input file name # ER scale factor # number of refinements", "");
+		reg.add_function("test_import_swc_and_regularize", static_cast<void (*)(const std::string&, number, const std::string&, const size_t, const bool, const bool)>(&test_import_swc_and_regularize), "", "file name # desired segment length", "");
+		reg.add_function("test_import_swc_and_regularize", static_cast<void (*)(const std::string&, number, const std::string&, const size_t, const bool, const bool, const number)>(&test_import_swc_and_regularize), "", "file name # desired segment length", "");
+		reg.add_function("test_import_swc_and_regularize", static_cast<void (*)(const std::string&)>(&test_import_swc_and_regularize), "", "file name # desired segment length", "");
+		reg.add_function("test_import_swc_and_regularize", static_cast<void (*)(const std::string&, const bool, const bool)>(&test_import_swc_and_regularize), "", "file name # desired segment length # soma Included", "");
+		reg.add_function("test_import_swc_and_regularize_var", (&test_import_swc_and_regularize_var), "", "file name", "");
+		reg.add_function("GetNumberOfTriangleIntersections", &GetNumberOfTriangleIntersections, "", "gridName#snapThreshold", "");
+	}
+
+	/// statistics (temporary)
+	{
+		reg.add_function("test_statistics", &test_statistics);
+		reg.add_function("test_statistics_soma", &test_statistics_soma);
+	}
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
+
+
+#ifdef NC_WITH_NEURITE_GENERATION_MODULE
+/**
+ * This function is called when the neurite generation plugin is loaded.
+ * It requires the neuro_collection plugin (which it is linked against).
+ */
+extern "C" void
+InitUGPlugin_neuro_collection_neurite_generation(ug::bridge::Registry* reg, string grp)
+{
+	using namespace ug;
+	grp.append("/neuro_collection");
+
+	// the attachments are also declared by neuro_collection, loading order is not defined
+	typedef Attachment<NeuriteProjector::SurfaceParams> NPSurfParam;
+	typedef Attachment<NeuriteProjector::Mapping> NPMappingParam;
+	if (!GlobalAttachments::is_declared("diameter"))
+		GlobalAttachments::declare_attachment<ANumber>("diameter", true);
+	if (!GlobalAttachments::is_declared("npNormals"))
+		GlobalAttachments::declare_attachment<ANormal3>("npNormals", true);
+	if (!GlobalAttachments::is_declared("npSurfParams"))
+		GlobalAttachments::declare_attachment<NPSurfParam>("npSurfParams", true);
+	if (!GlobalAttachments::is_declared("npMapping"))
+		GlobalAttachments::declare_attachment<NPMappingParam>("npMapping", true);
+
+	try
+	{
+		neuro_collection::RegisterNeuriteGeneration(*reg, grp);
+	}
+	UG_REGISTRY_CATCH_THROW(grp);
+}
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__NEURITE_GENERATION_PLUGIN_H
+#define UG__PLUGINS__NEURO_COLLECTION__NEURITE_GENERATION_PLUGIN_H
+
+#include <string>
+
+#include "bridge/registry.h"  // for Registry
+
+
+namespace ug {
+namespace neuro_collection {
+
+/**
+ * @brief Registration of the neurite generation from SWC files and its test utilities
+ *
+ * This code (neurite generation in test/, grid_generation/neurites_from_swc, ...) is large and pulls in
+ * the tetrahedralization, but is not needed for simulations on existing grids.
+ * With the build option NCNeuriteGenerationModule, it is compiled into a separate
+ * plugin library (neuro_collection_neurite_generation), which calls this function
+ * when loaded; simulation-only installations can simply omit that library.
+ * Otherwise, it is part of the neuro_collection plugin and registered from there
+ * (as group "neurite_generation", see require_neuro_collection_group()).
+ *
+ * @param reg		registry
+ * @param grp		group for sorting of functionality
+ */
+void RegisterNeuriteGeneration(bridge::Registry& reg, std::string grp);
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__NEURITE_GENERATION_PLUGIN_H
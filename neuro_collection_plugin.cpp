@@ -52,11 +52,16 @@
 
 #include "lib_grid/global_attachments.h"  // for GlobalAttachments::declare_attachment
 
+#include <map>  // for std::map
+
 // configuration file for compile options
 #include "nc_config.h"
 
 #include "buffer_fv1.h"
 #include "membrane_transport_fv1.h"
+#include "membrane_transport_fv1_typed.h"
+#include "multi_membrane_transport_fv1.h"
+#include "lumped_mitochondria_fv1.h"
 #include "user_flux_bnd_fv1.h"
 #include "membrane_transporters/membrane_transporter_interface.h"
 #include "membrane_transporters/hh.h"
@@ -67,7 +72,9 @@
 #include "membrane_transporters/ryr.h"
 #include "membrane_transporters/ryr_discrete.h"
 #include "membrane_transporters/ryr_implicit.h"
+#include "membrane_transporters/ryr_implicit_condensed.h"
 #include "membrane_transporters/serca.h"
+#include "membrane_transporters/fused_er_membrane.h"
 #include "membrane_transporters/leak.h"
 #include "membrane_transporters/pmca.h"
 #include "membrane_transporters/ncx.h"
@@ -78,8 +85,10 @@
 #ifdef NC_WITH_CABLENEURON
 	//#include "hybrid_neuron_communicator.h"
 	#include "hybrid_synapse_current_assembler.h"
+	#include "hybrid_coupling_benchmark.h"
     #include "membrane_transporters/vdcc_bg/vdcc_bg_cableneuron.h"
 	#include "membrane_transport_1d.h"
+	#include "multi_membrane_transport_1d.h"
 #endif
 
 #ifdef NC_WITH_MPM
@@ -92,26 +101,49 @@
 #include "membrane_transporters/mcu.h"
 #include "membrane_transporters/mncx.h"
 #include "membrane_transporters/nmdar.h"
+#include "membrane_transporters/nmdar_multi_synapse.h"
 #include "stimulation/action_potential_train.h"
-#include "grid_generation/bouton_generator.h"
-#include "grid_generation/dendrite_generator.h"
-#include "grid_generation/spine_generation.h"
-#include "grid_generation/neurites_from_swc.h"
-#include "grid_generation/polygonal_mesh_from_txt.h"
+#ifdef NC_WITH_GRID_GENERATION
+	#include "grid_generation/bouton_generator.h"
+	#include "grid_generation/dendrite_generator.h"
+	#include "grid_generation/spine_generation.h"
+#endif
+#ifdef NC_WITH_NEURITE_GENERATION
+	#include "neurite_generation_plugin.h"
+#endif
 
 #include "lib_grid/refinement/projectors/neurite_projector.h"
-#include "test/test_neurite_proj.h"
 
 #include "util/measurement.h"
 #include "util/ca_wave_util.h"
 #include "util/axon_util.h"
 #include "util/hh_util.h"
 #include "util/misc_util.h"
+#include "util/vm_time_series.h"
 #include "util/neurite_axial_refinement_marker.h"
 #include "util/solution_impexp_util.h"
+#include "util/ryr_block_jacobi.h"
+#include "util/manifold_geometry_cache.h"
+#include "util/async_record_writer.h"
+#include "util/compressed_series.h"
+#include "util/wave_front_refinement.h"
+#include "util/checkpoint.h"
+#include "util/in_situ_analysis.h"
+#include "util/channel_state_migration.h"
+#include "util/mesh_cache.h"
+#include "util/membrane_cost_balance_weights.h"
+#include "util/neuron_network_partitioning.h"
+#include "util/partitioned_domain_io.h"
+#include "util/hot_path_counters.h"
+#include "util/memory_accounting.h"
+#include "util/timeline_trace.h"
+#include "util/assembly_benchmark.h"
+#include "util/time_step_controller.h"
+#include "util/shared_vm_buffer.h"
+#include "util/simulation_driver.h"
+#include "util/expression_user_data.h"
 #include "lib_disc/function_spaces/grid_function.h"
 
-#include "test/neurite_math_util.h"
 
 
 using namespace std;
@@ -128,6 +160,114 @@ namespace neuro_collection{
  *  \{
  */
 
+/**
+ * Registration of the RyRBlockJacobi preconditioner.
+ * The preconditioner only works on scalar algebra,
+ * so it is only registered for CPUAlgebra.
+ */
+template <typename TDomain, typename TAlgebra>
+struct RegisterRyRBlockJacobi
+{
+	static void reg(Registry& reg, const string& grp, const string& suffix, const string& tag) {}
+};
+
+template <typename TDomain>
+struct RegisterRyRBlockJacobi<TDomain, CPUAlgebra>
+{
+	static void reg(Registry& reg, const string& grp, const string& suffix, const string& tag)
+	{
+		typedef RyRBlockJacobi<TDomain, CPUAlgebra> T;
+		typedef IPreconditioner<CPUAlgebra> TBase;
+		string name = string("RyRBlockJacobi").append(suffix);
+		reg.add_class_<T, TBase>(name, grp, "Vertex-block Jacobi preconditioner for implicit RyR problems")
+			.template add_constructor<void (*)(const char*, const char*)>
+				("function names coupled in each vertex block (comma-separated c-string) # "
+				 "subset names (comma-separated c-string)")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "RyRBlockJacobi", tag);
+	}
+};
+
+
+/**
+ * Registration of MembraneTransportFV1T for a built-in transport mechanism.
+ * The class is registered as a subclass of MembraneTransportFV1,
+ * so all of its configuration methods are available.
+ */
+template <typename TDomain, typename TTransporter>
+struct RegisterMembraneTransportFV1T
+{
+	static void reg(Registry& reg, const string& grp, const string& suffix, const string& tag,
+		const string& transporterName)
+	{
+		typedef MembraneTransportFV1T<TDomain, TTransporter> T;
+		typedef MembraneTransportFV1<TDomain> TBase;
+		string name = string("MembraneTransportFV1_").append(transporterName).append(suffix);
+		reg.add_class_<T, TBase>(name, grp, "MembraneTransportFV1 with devirtualized " + transporterName + " kernels")
+			.template add_constructor<void (*)(const char*, SmartPtr<TTransporter>)>
+				("Subset(s) as comma-separated c-string#" + transporterName)
+			.template add_constructor<void (*)(const std::vector<std::string>&, SmartPtr<TTransporter>)>
+				("Subset(s) as vector#" + transporterName)
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, string("MembraneTransportFV1_").append(transporterName), tag);
+	}
+};
+
+
+/**
+ * Groups of rarely used functionality can be registered lazily (build option
+ * NCLazyRegistration), i.e., only when a script requests them by calling
+ * require_neuro_collection_group(). This keeps plugin load time down for
+ * scripts not needing them. Without the option, groups are registered at once.
+ */
+typedef void (*RegisterGroupFunc)(Registry& reg, string grp);
+
+struct LazyGroup
+{
+	LazyGroup() : reg(NULL), func(NULL), registered(false) {}
+	Registry* reg;
+	string grp;
+	RegisterGroupFunc func;
+	bool registered;
+};
+
+static std::map<string, LazyGroup>& LazyGroups()
+{
+	static std::map<string, LazyGroup> groups;
+	return groups;
+}
+
+static void RegisterGroup(Registry& reg, const string& grp, const string& name, RegisterGroupFunc func)
+{
+	LazyGroup& lg = LazyGroups()[name];
+	lg.reg = &reg;
+	lg.grp = grp;
+	lg.func = func;
+#ifndef NC_WITH_LAZY_REGISTRATION
+	func(reg, grp);
+	lg.registered = true;
+#endif
+}
+
+void RequireGroup(const std::string& name)
+{
+	std::map<string, LazyGroup>::iterator it = LazyGroups().find(name);
+	UG_COND_THROW(it == LazyGroups().end(), "Unknown neuro_collection group '" << name << "' "
+		"(or not compiled into this build).");
+
+	LazyGroup& lg = it->second;
+	if (lg.registered)
+		return;
+
+	try {lg.func(*lg.reg, lg.grp);}
+	UG_REGISTRY_CATCH_THROW(lg.grp);
+	lg.registered = true;
+
+	// let the bindings (e.g., Lua) know about the new functionality
+	lg.reg->registry_changed();
+}
+
+
 /**
  * Class exporting the functionality. All functionality that is to
  * be used in scripts or visualization must be registered here.
@@ -177,16 +317,153 @@ static void DomainAlgebra(Registry& reg, string grp)
 				("approximation space # function names (comma-separated c-string) # "
 					"subset names (comma-separated c-string) # file base name")
 			.add_method("exportWaveProfileX", &T::exportWaveProfileX, "", "", "")
+			.add_method("set_binary_output", &T::set_binary_output, "", "whether to write binary files",
+				"write binary profile series instead of one text file per time step")
+			.add_method("set_compressed_output", &T::set_compressed_output, "",
+				"whether to write compressed series # absolute error bound (0 for lossless)",
+				"write compressed profile series instead of one text file per time step")
+			.add_method("set_single_file_output", &T::set_single_file_output, "", "whether to append to one file",
+				"append all snapshots to one file per subset and function (collective MPI-IO in parallel)")
+			.add_method("set_num_snapshots_to_preallocate", &T::set_num_snapshots_to_preallocate, "",
+				"number of snapshots", "preallocate single-file output for this number of snapshots")
+			.add_method("close", &T::close_files, "", "", "close single-file output files")
 			.set_construct_as_smart_pointer(true);
 
 		reg.add_class_to_group(name, "WaveProfileExporter", tag);
 	}
 
+	// WaveFrontTracker
+	{
+		typedef WaveFrontTracker<TDomain, TAlgebra> T;
+		string name = string("WaveFrontTracker").append(suffix);
+		reg.add_class_<T>(name, grp)
+			.template add_constructor<void (*)(SmartPtr<ApproximationSpace<TDomain> >,
+				const char*, const char*, number)>
+				("approximation space # function names for ca_cyt, ca_er, c1, c2 (comma-separated c-string) # "
+					"RyR-carrying membrane subset names (comma-separated c-string) # threshold")
+			.add_method("set_ryr", &T::set_ryr, "", "RyR channel", "compute maximal RyR flux density in each update")
+			.add_method("set_calcium_mode", &T::set_calcium_mode, "", "whether to use calcium mode",
+				"determine front by cytosolic calcium instead of RyR open probability")
+			.add_method("update", &T::update, "", "solution # time", "update front position, velocity and max flux")
+			.add_method("front_position", &T::front_position, "front position", "", "")
+			.add_method("front_velocity", &T::front_velocity, "front velocity", "", "")
+			.add_method("max_flux_density", &T::max_flux_density, "maximal flux density (mol/(m^2*s))", "", "")
+			.set_construct_as_smart_pointer(true);
+
+		reg.add_class_to_group(name, "WaveFrontTracker", tag);
+	}
+
+	// in-situ analysis
+	{
+		typedef InSituAnalysis<TDomain, TAlgebra> T;
+		string name = string("InSituAnalysis").append(suffix);
+		reg.add_class_<T>(name, grp)
+			.template add_constructor<void (*)(SmartPtr<ApproximationSpace<TDomain> >, const std::string&)>
+				("approximation space # file base name")
+			.add_method("add_statistics", &T::add_statistics, "", "function name # subset names (comma-separated c-string)",
+				"minimum, maximum and mean of a function on each subset")
+			.add_method("add_area_above_threshold", &T::add_area_above_threshold, "",
+				"function name # subset names (comma-separated c-string) # threshold",
+				"measure of the part of each subset where the function exceeds the threshold")
+			.add_method("add_front_position", &T::add_front_position, "",
+				"function name # subset names (comma-separated c-string) # threshold",
+				"largest x coordinate where the function exceeds the threshold")
+			.add_method("add_histogram", &T::add_histogram, "",
+				"function name # subset names (comma-separated c-string) # lower bound # upper bound # number of bins",
+				"histogram of the function on each subset")
+			.add_method("set_snapshot", &T::set_snapshot, "",
+				"function names # subset names (comma-separated c-strings) # interval # grid level",
+				"write decimated snapshots every interval-th analysis")
+			.add_method("analyze", &T::analyze, "", "solution # time", "compute all reductions and write the results")
+			.add_method("num_values", &T::num_values, "number of results", "", "")
+			.add_method("value_name", &T::value_name, "name of the result", "result index", "")
+			.add_method("value", &T::value, "result of the last analysis", "result index", "")
+			.add_method("flush", &T::flush, "", "", "write all queued records")
+			.set_construct_as_smart_pointer(true);
+
+		reg.add_class_to_group(name, "InSituAnalysis", tag);
+	}
+
+	// native time stepping loop
+	{
+		typedef CalciumSimulationDriver<TDomain, TAlgebra> T;
+		typedef typename TAlgebra::vector_type vector_type;
+		string name = string("CalciumSimulationDriver").append(suffix);
+		reg.add_class_<T>(name, grp)
+			.template add_constructor<void (*)(SmartPtr<ITimeDiscretization<TAlgebra> >, SmartPtr<IOperatorInverse<vector_type> >)>
+				("time discretization # solver")
+			.add_method("set_time_step", &T::set_time_step, "", "time step size", "set (initial) time step size")
+			.add_method("set_min_time_step", &T::set_min_time_step, "", "minimal time step size",
+				"set minimal step size for step reduction on solver failure")
+			.add_method("set_time_step_controller", &T::set_time_step_controller, "", "time step controller",
+				"adapt the time step size")
+			.add_method("add_measurement", &T::add_measurement, "", "measurement # interval (steps)",
+				"take a measurement every interval steps")
+			.add_method("add_wave_profile_export", &T::add_wave_profile_export, "", "exporter # interval (steps)",
+				"export wave profiles every interval steps")
+			.add_method("set_wave_front_tracker", &T::set_wave_front_tracker, "", "wave front tracker",
+				"update front in every step (and pass its velocity to the time step controller)")
+			.add_method("set_script_hook", &T::set_script_hook, "", "function name # interval (steps)",
+				"call a script function(step, time, dt) every interval steps; it may return false to stop")
+			.add_method("set_verbose", &T::set_verbose, "", "verbosity", "print a line per time step")
+			.add_method("run", &T::run, "time reached", "solution # start time # end time", "run the simulation")
+			.add_method("num_steps", &T::num_steps, "number of accepted steps", "", "")
+			.add_method("num_rejected_steps", &T::num_rejected_steps, "number of rejected steps", "", "")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "CalciumSimulationDriver", tag);
+	}
+
+	// RyR vertex-block Jacobi preconditioner
+	RegisterRyRBlockJacobi<TDomain, TAlgebra>::reg(reg, grp, suffix, tag);
+
 	// measurements
 	reg.add_function("take_measurement", static_cast<number (*)(SmartPtr<TGridFunction>, const number, const char*, const char*, const char*, const char*)>(&takeMeasurement<GridFunction<TDomain, TAlgebra> >), grp.c_str(),
 					 "", "solution#time#subset names#function names#output file name#output file extension",
 					 "outputs average values of unknowns on subsets");
 
+	// repeated measurements (cached volumes, single sweep, open files)
+	{
+		typedef Measurement<TGridFunction> T;
+		string name = string("Measurement").append(suffix);
+		reg.add_class_<T>(name, grp)
+			.template add_constructor<void (*)(SmartPtr<TGridFunction>, const char*, const char*, const char*)>
+				("solution # subset names # function names # output file name")
+			.template add_constructor<void (*)(SmartPtr<TGridFunction>, const char*, const char*, const char*, const char*)>
+				("solution # subset names # function names # output file name # output file extension")
+			.add_method("take", &T::take, "average of last function on last subset", "time",
+				"outputs average values of unknowns on subsets")
+			.add_method("value", &T::value, "average value", "subset index # function index",
+				"average value of a function on a subset in the last measurement")
+			.add_method("flush", &T::flush, "", "", "flush output files")
+			.add_method("set_binary_output", &T::set_binary_output, "", "whether to write a binary file",
+				"write all measurements to one binary file instead of text files")
+			.add_method("set_compressed_output", &T::set_compressed_output, "", "absolute error bound (0 for lossless)",
+				"write all measurements to one compressed time series file instead of text files")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "Measurement", tag);
+	}
+
+	// parallel checkpoint / restart
+	{
+		typedef SolutionCheckpoint<TGridFunction> T;
+		string name = string("SolutionCheckpoint").append(suffix);
+		reg.add_class_<T>(name, grp)
+			.template add_constructor<void (*)(SmartPtr<TGridFunction>)>("solution")
+			.add_method("add_state", &T::add_state, "", "unique name # state object",
+				"store additional (non-DoF) state in the checkpoint")
+			.add_method("set_tolerance", &T::set_tolerance, "", "relative tolerance",
+				"tolerance for matching positions on restart")
+			.add_method("write", &T::write, "", "file name # time", "write checkpoint")
+			.add_method("read", &T::read, "checkpoint time", "file name", "read checkpoint")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "SolutionCheckpoint", tag);
+	}
+
+	// steady-state initialization of membrane transport mechanisms
+	reg.add_function("init_to_steady_state", &InitToSteadyState<TGridFunction>, grp.c_str(),
+		"", "membrane transport mechanism#solution#time",
+		"initializes the internal gating states of the mechanism to the steady state for the given solution");
+
 	// solution import / export
 	reg.add_function("exportSolution", &exportSolution<TGridFunction>, grp.c_str(),
 		"", "solution#time#subsetNames#functionNames#outFileName", "outputs solutions to file");
@@ -244,6 +521,31 @@ static void DomainAlgebra(Registry& reg, string grp)
 			<< "' found in RyRImplicit_1drotsym class group to add algebra-dependent functionality to.");
 	}
 
+	// export all template realizations of BufferFV1::integrate_reactions()
+	{
+		typedef BufferFV1<TDomain> T;
+		ClassGroupDesc* cgd = reg.get_class_group(std::string("BufferFV1"));
+		size_t numClasses = cgd->num_classes();
+		size_t i = 0;
+		for (; i < numClasses; ++i)
+		{
+			std::string classTag = cgd->get_class_tag(i);
+			if (classTag == GetDomainTag<TDomain>())
+			{
+				ExportedClass<T>* expClass = dynamic_cast<ExportedClass<T>* >(cgd->get_class(i));
+				UG_COND_THROW(!expClass, "Exported class can not be cast to the correct type.");
+
+				expClass->add_method("integrate_reactions",
+					&T::template integrate_reactions<TGridFunction>, "", "solution # time # time step",
+					"integrate buffering reactions exactly over the time step (operator splitting)");
+
+				break;
+			}
+		}
+		UG_COND_THROW(i == numClasses, "No class with domain tag '" << GetDomainTag<TDomain>()
+			<< "' found in BufferFV1 class group to add algebra-dependent functionality to.");
+	}
+
 	// export all template realizations of VDCC_BG::calculate_steady_state()
 	{
 		typedef VDCC_BG<TDomain> T;
@@ -296,6 +598,12 @@ static void Domain(Registry& reg, string grp)
 			.template add_constructor<void (*)(const char*)>("Subset(s)")
 			.add_method("set_num_reactions", &T::set_num_reactions, "", "number of reactions | default | value=1",
 				"set number of reactions about to be added")
+			.add_method("set_rapid_buffer_approximation", &T::set_rapid_buffer_approximation, "",
+				"whether to use the rapid buffer approximation | default | value=true",
+				"eliminate buffers assuming equilibrium (must be set before adding reactions)")
+			.add_method("set_operator_splitting", &T::set_operator_splitting, "",
+				"whether to use operator splitting | default | value=true",
+				"do not assemble reactions, they are integrated by integrate_reactions() instead")
 			.add_method("add_reaction", static_cast<void (T::*)
 				 (const char*, const char*, number, number, number)>(&T::add_reaction), "",
 				  "buffering substance | selection | value=[\"clb\"] # "
@@ -344,10 +652,97 @@ static void Domain(Registry& reg, string grp)
 			.add_method("set_density_function", static_cast<void (T::*) (SmartPtr<CplUserData<number,dim> >)>
 					(&T::set_density_function), "", "", "add a density function")
 			.add_method("set_membrane_transporter", &T::set_membrane_transporter, "", "", "sets the membrane transport mechanism")
+			.add_method("set_density_caching", &T::set_density_caching, "", "whether to cache density values",
+				"cache density values per integration point (only for time-independent densities)")
+			.add_method("set_combined_flux_evaluation", &T::set_combined_flux_evaluation, "",
+				"whether to evaluate derivatives along with fluxes",
+				"evaluate flux derivatives during defect assembling and reuse them in the Jacobian")
+			.add_method("set_frozen_jacobian", &T::set_frozen_jacobian, "",
+				"relative tolerance#non-positive value disables reuse",
+				"reuse flux derivatives as long as the unknowns change less than the tolerance")
+			.add_method("set_activity_masking", &T::set_activity_masking, "",
+				"flux density threshold # relative wake-up tolerance",
+				"skip assembling at integration points with negligible flux")
+			.add_method("disable_activity_masking", &T::disable_activity_masking, "", "", "")
+			.add_method("num_inactive_points", &T::num_inactive_points, "number of skipped integration points", "", "")
+			.add_method("set_cost_measurement", &T::set_cost_measurement, "", "number of time steps (0: off)",
+				"measure the time spent in flux evaluations over the last time steps")
+			.add_method("measured_time_per_evaluation", &T::measured_time_per_evaluation,
+				"average time per flux evaluation (negative if not measured)", "", "")
+			.add_method("element_cost", &T::element_cost, "relative cost of a membrane element", "", "")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "MembraneTransportFV1", tag);
 	}
 
+	// two-sided membrane transport with devirtualized kernels of built-in transport mechanisms
+	RegisterMembraneTransportFV1T<TDomain, Leak>::reg(reg, grp, suffix, tag, "Leak");
+	RegisterMembraneTransportFV1T<TDomain, SERCA>::reg(reg, grp, suffix, tag, "SERCA");
+	RegisterMembraneTransportFV1T<TDomain, PMCA>::reg(reg, grp, suffix, tag, "PMCA");
+	RegisterMembraneTransportFV1T<TDomain, NCX>::reg(reg, grp, suffix, tag, "NCX");
+
+#ifdef UG_PARALLEL
+	// cost-weighted load balancing
+	{
+		typedef MembraneCostBalanceWeights<TDomain> T;
+		typedef IBalanceWeights TBase;
+		string name = string("MembraneCostBalanceWeights").append(suffix);
+		reg.add_class_<T, TBase>(name, grp)
+			.template add_constructor<void (*)(SmartPtr<TDomain>)>("domain")
+			.add_method("set_bulk_cost", &T::set_bulk_cost, "", "cost", "weight of a bulk element (default: 1)")
+			.add_method("set_subset_cost", &T::set_subset_cost, "", "subsets as comma-separated c-string#cost",
+				"additional cost of elements or element sides in the given subsets")
+			.add_method("add_membrane_transport", &T::add_membrane_transport, "", "membrane transport discretization",
+				"add the cost of a membrane transport discretization to its subsets")
+			.add_method("set_measured_costs", &T::set_measured_costs, "", "assembling time of a bulk element (<= 0: off)",
+				"use measured flux evaluation times instead of cost estimates")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "MembraneCostBalanceWeights", tag);
+	}
+#endif
+
+	// several two-sided membrane transport systems assembled in one pass
+	{
+		typedef MultiMembraneTransportFV1<TDomain> T;
+		typedef FV1InnerBoundaryElemDisc<TDomain> TBase;
+		string name = string("MultiMembraneTransportFV1").append(suffix);
+		reg.add_class_<T, TBase >(name, grp)
+			.template add_constructor<void (*)(const char*)>("Subset(s) as comma-separated c-string")
+			.template add_constructor<void (*)(const std::vector<std::string>&)>("Subset(s) as vector")
+			.add_method("add_membrane_transporter", static_cast<void (T::*) (SmartPtr<IMembraneTransporter>, const number)>
+					(&T::add_membrane_transporter), "", "MembraneTransporter#density", "add a transport mechanism with constant density")
+#ifdef UG_FOR_LUA
+			.add_method("add_membrane_transporter", static_cast<void (T::*) (SmartPtr<IMembraneTransporter>, const char*)>
+					(&T::add_membrane_transporter), "", "MembraneTransporter#density function", "add a transport mechanism with density function")
+#endif
+			.add_method("add_membrane_transporter", static_cast<void (T::*) (SmartPtr<IMembraneTransporter>, SmartPtr<CplUserData<number,dim> >)>
+					(&T::add_membrane_transporter), "", "MembraneTransporter#density function", "add a transport mechanism with density function")
+			.add_method("num_membrane_transporters", &T::num_membrane_transporters, "number of transport mechanisms", "", "")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "MultiMembraneTransportFV1", tag);
+	}
+
+	// mitochondria as sub-grid compartment of the cytosol
+	{
+		typedef LumpedMitochondriaFV1<TDomain> T;
+		typedef IElemDisc<TDomain> TBase;
+		string name = string("LumpedMitochondriaFV1").append(suffix);
+		reg.add_class_<T, TBase >(name, grp)
+			.template add_constructor<void (*)(const char*, const char*)>("mitochondrial function(s) as comma-separated c-string#Subset(s) as comma-separated c-string")
+			.template add_constructor<void (*)(const std::vector<std::string>&, const std::vector<std::string>&)>("mitochondrial function(s) as vector#Subset(s) as vector")
+			.add_method("set_volume_fraction", &T::set_volume_fraction, "", "volume fraction", "set mitochondrial volume fraction")
+			.add_method("add_membrane_transporter", static_cast<void (T::*) (SmartPtr<IMembraneTransporter>, const number)>
+					(&T::add_membrane_transporter), "", "MembraneTransporter#volume density", "add a mitochondrial transport mechanism with constant volume density")
+#ifdef UG_FOR_LUA
+			.add_method("add_membrane_transporter", static_cast<void (T::*) (SmartPtr<IMembraneTransporter>, const char*)>
+					(&T::add_membrane_transporter), "", "MembraneTransporter#volume density function", "add a mitochondrial transport mechanism with volume density function")
+#endif
+			.add_method("add_membrane_transporter", static_cast<void (T::*) (SmartPtr<IMembraneTransporter>, SmartPtr<CplUserData<number,dim> >)>
+					(&T::add_membrane_transporter), "", "MembraneTransporter#volume density function", "add a mitochondrial transport mechanism with volume density function")
+			.add_method("num_membrane_transporters", &T::num_membrane_transporters, "number of transport mechanisms", "", "")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "LumpedMitochondriaFV1", tag);
+	}
+
 #ifdef NC_WITH_CABLENEURON
 	// implementation of two-sided membrane transport systems (1d "cable", fcts const in radius and angle)
 	{
@@ -367,9 +762,38 @@ static void Domain(Registry& reg, string grp)
 					(&T::set_density_function), "", "", "add a density function")
 			.add_method("set_radius", &T::set_radius, "", "", "sets the radius the membrane is located at")
 			.add_method("set_radius_factor", &T::set_radius_factor, "", "", "sets the radius the membrane is located at")
+			.add_method("update_geometry_factors", &T::update_geometry_factors, "", "", "recompute membrane areas (after diameter changes)")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "MembraneTransport1d", tag);
 	}
+
+	// several two-sided membrane transport systems on a 1d "cable", assembled in one pass
+	{
+		typedef MultiMembraneTransport1d<TDomain> T;
+		typedef IElemDisc<TDomain> TBase;
+		string name = string("MultiMembraneTransport1d").append(suffix);
+		reg.add_class_<T, TBase >(name, grp)
+			.template add_constructor<void (*)(const char*)>("Subset(s) as comma-separated c-string")
+			.template add_constructor<void (*)(const std::vector<std::string>&)>("Subset(s) as vector")
+			.add_method("add_membrane_transporter", static_cast<void (T::*) (SmartPtr<IMembraneTransporter>, const number)>
+					(&T::add_membrane_transporter), "", "MembraneTransporter#density", "add a transport mechanism with constant density")
+#ifdef UG_FOR_LUA
+			.add_method("add_membrane_transporter", static_cast<void (T::*) (SmartPtr<IMembraneTransporter>, const char*)>
+					(&T::add_membrane_transporter), "", "MembraneTransporter#density function", "add a transport mechanism with density function")
+#endif
+			.add_method("add_membrane_transporter", static_cast<void (T::*) (SmartPtr<IMembraneTransporter>, SmartPtr<CplUserData<number,dim> >)>
+					(&T::add_membrane_transporter), "", "MembraneTransporter#density function", "add a transport mechanism with density function")
+			.add_method("num_membrane_transporters", &T::num_membrane_transporters, "number of transport mechanisms", "", "")
+			.add_method("set_radius", &T::set_radius, "", "", "sets the radius the membrane is located at")
+			.add_method("set_radius_factor", &T::set_radius_factor, "", "", "sets the radius the membrane is located at")
+			.add_method("update_geometry_factors", &T::update_geometry_factors, "", "", "recompute membrane areas and cross sections (after diameter changes)")
+			.add_method("set_volume_scaling", &T::set_volume_scaling, "", "whether to scale",
+					"divide fluxes by the cross section of the compartment of the respective function")
+			.add_method("set_volume_fraction", &T::set_volume_fraction, "", "function name#volume fraction",
+					"fraction of the cable cross section occupied by the compartment of the function")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "MultiMembraneTransport1d", tag);
+	}
 #endif
 
 	// user flux boundary
@@ -386,10 +810,62 @@ static void Domain(Registry& reg, string grp)
 					"", "", "add a flux density function")
 			.add_method("set_flux_function", static_cast<void (T::*) (const char*)> (&T::set_flux_function),
 					"", "", "add a flux density function")
+			.add_method("set_batched_evaluation", &T::set_batched_evaluation, "", "batched evaluation",
+					"evaluate a Lua flux callback in batches once per time (default: off)")
+			.add_method("set_time_only_flux", &T::set_time_only_flux, "", "time-only flux",
+					"declare the flux function to depend on time only (default: off)")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "UserFluxBoundaryFV1", tag);
 	}
 
+	// natively evaluated expression user data
+	{
+		typedef ExpressionUserData<dim> T;
+		typedef CplUserData<number, dim> TBase;
+		std::string name = std::string("ExpressionUserNumber").append(suffix);
+		reg.add_class_<T, TBase>(name, grp)
+			.template add_constructor<void (*)(const char*)>("expression in x, y, z and t")
+			.add_method("expression", &T::expression, "expression", "", "")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "ExpressionUserNumber", tag);
+	}
+
+	// geometry cache for membrane discs
+	{
+		typedef ManifoldGeometryCache<TDomain> T;
+		std::string name = std::string("ManifoldGeometryCache").append(suffix);
+		reg.add_class_<T>(name, grp)
+			.template add_constructor<void (*)(SmartPtr<TDomain>)>("domain")
+			.add_method("clear", &T::clear, "", "", "remove all cached geometries")
+			.add_method("size", &T::size, "number of cached elements", "", "")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "ManifoldGeometryCache", tag);
+	}
+
+	// moving-window refinement around a wave front
+	{
+		typedef WaveFrontRefinementDriver<TDomain> T;
+		std::string name = std::string("WaveFrontRefinementDriver").append(suffix);
+		reg.add_class_<T>(name, grp)
+			.template add_constructor<void (*)(SmartPtr<TDomain>)>("domain")
+			.add_method("set_window", &T::set_window, "", "extent behind front # extent ahead of front",
+				"set refinement window around the front")
+			.add_method("set_coarsening_margin", &T::set_coarsening_margin, "", "margin",
+				"coarsen elements farther than this from the window")
+			.add_method("set_max_level", &T::set_max_level, "", "level", "maximal refinement level")
+			.add_method("mark", &T::mark, "", "refiner # front position",
+				"mark for refinement around the front and for coarsening elsewhere")
+			.add_method("num_marked_for_refinement", &T::num_marked_for_refinement, "number of elements", "", "")
+			.add_method("num_marked_for_coarsening", &T::num_marked_for_coarsening, "number of elements", "", "")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "WaveFrontRefinementDriver", tag);
+
+		// NeuriteAxialRefinementMarker is only registered for 3d
+		if (TDomain::dim == 3)
+			reg.get_class_<T>().add_method("set_axial_marker", &T::set_axial_marker, "",
+				"neurite axial refinement marker", "refine anisotropically in axial direction");
+	}
+
 	// Hodgkin-Huxley channels
 	{
 		typedef HH<TDomain> T;
@@ -410,6 +886,10 @@ static void Domain(Registry& reg, string grp)
 			.add_method("set_reference_time", &T::set_reference_time, "", "reference time (in units of s)", "")
 			.add_method("use_exact_gating_mode", &T::use_exact_gating_mode, "", "time step size", "")
 			.add_method("use_gating_explicit_current_mode", &T::use_gating_explicit_current_mode, "", "time step size", "")
+			.add_method("use_rate_tables", &T::use_rate_tables, "", "use tables#relative tolerance",
+				"use tabulated gating functions")
+			.add_method("set_geometry_cache", &T::set_geometry_cache, "", "geometry cache",
+				"use a (shared) cache for the membrane element geometry")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "HH", tag);
 	}
@@ -436,6 +916,10 @@ static void Domain(Registry& reg, string grp)
 			.add_method("set_reference_time", &T::set_reference_time, "", "reference time (in units of s)", "")
 			.add_method("use_exact_gating_mode", &T::use_exact_gating_mode, "", "time step size", "")
 			.add_method("use_gating_explicit_current_mode", &T::use_gating_explicit_current_mode, "", "time step size", "")
+			.add_method("use_rate_tables", &T::use_rate_tables, "", "use tables#relative tolerance",
+				"use tabulated gating functions")
+			.add_method("set_geometry_cache", &T::set_geometry_cache, "", "geometry cache",
+				"use a (shared) cache for the membrane element geometry")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "HHCharges", tag);
 	}
@@ -461,6 +945,10 @@ static void Domain(Registry& reg, string grp)
 			.add_method("set_reference_time", &T::set_reference_time, "", "reference time (in units of s)", "")
 			.add_method("set_temperature", &T::set_temperature, "", "temperature (in K)", "")
 			.add_method("use_exact_gating_mode", &T::use_exact_gating_mode, "", "time step size", "")
+			.add_method("use_rate_tables", &T::use_rate_tables, "", "use tables#relative tolerance",
+				"use tabulated gating functions")
+			.add_method("checkpoint_state", &T::checkpoint_state, "state object", "",
+				"gating state for a SolutionCheckpoint")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "HHSpecies", tag);
 	}
@@ -479,10 +967,58 @@ static void Domain(Registry& reg, string grp)
 				("Function vector with the order: "
 				 "{\"cytosolic calcium\", \"endoplasmic calcium\"} # "
 				 "subsets vector, approximation space")
+			.add_method("set_conductance", &T::set_conductance, "", "conductance (m^3/s)",
+				"set the channel conductance (also between time steps)")
+			.add_method("checkpoint_state", &T::checkpoint_state, "state object", "",
+				"channel states for a SolutionCheckpoint or ChannelStateMigration")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "RyRinstat", tag);
 	}
 
+	// NMDAR for many event-activated synapses
+	{
+		typedef NMDARMultiSynapse<TDomain> T;
+		typedef NMDAR TBase;
+		std::string name = std::string("NMDARMultiSynapse").append(suffix);
+		reg.add_class_<T, TBase>(name, grp)
+			.template add_constructor<void (*)(const char*, const char*, SmartPtr<TDomain>)>
+				("Functions as comma-separated string with the order: "
+				 "extracellular calcium, intracellular calcium # "
+				 "membrane subsets as comma-separated string # domain")
+			.template add_constructor<void (*)(const std::vector<std::string>&, const std::vector<std::string>&, SmartPtr<TDomain>)>
+				("Function vector with the order: {extracellular calcium, intracellular calcium} # "
+				 "membrane subsets vector # domain")
+			.add_method("add_synapse", &T::add_synapse, "synapse index", "coordinates",
+				"defines a synapse at the given position")
+			.add_method("add_activation", &T::add_activation, "", "synapse index # activation time",
+				"activates a synapse at the given time")
+			.add_method("set_expiry", &T::set_expiry, "", "number of decay times",
+				"sets after how many decay times an activation is no longer considered")
+			.add_method("num_active_elements", &T::num_active_elements, "number of elements with active synapses")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "NMDARMultiSynapse", tag);
+	}
+
+	// implicit RyR with locally condensed channel states
+	{
+		typedef RyRImplicitCondensed<TDomain> T;
+		typedef IMembraneTransporter TBase;
+		std::string name = std::string("RyRImplicitCondensed").append(suffix);
+		reg.add_class_<T, TBase>(name, grp)
+			.template add_constructor<void (*)(const char*, const char*, SmartPtr<ApproximationSpace<TDomain> >)>
+				("Functions as comma-separated string with the order: "
+				 "{\"cytosolic calcium\", \"endoplasmic calcium\"} # "
+				 "subsets as comma-separated string # approximation space")
+			.template add_constructor<void (*)(const std::vector<std::string>&, const std::vector<std::string>&, SmartPtr<ApproximationSpace<TDomain> >)>
+				("Function vector with the order: "
+				 "{\"cytosolic calcium\", \"endoplasmic calcium\"} # "
+				 "subsets vector, approximation space")
+			.add_method("set_conductance", &T::set_conductance, "", "conductance (m^3/s)",
+				"set the channel conductance (also between time steps)")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "RyRImplicitCondensed", tag);
+	}
+
 	// fully implicit RyR
 	{
 		typedef RyRImplicit<TDomain> T;
@@ -498,6 +1034,13 @@ static void Domain(Registry& reg, string grp)
 				("Function vector with the order: "
 				 "{\"cytosolic calcium\", \"endoplasmic calcium\", \"O2 channel state\", \"C1 channel state\", \"C2 channel state\"} # "
 				 "subsets vector,")
+			.add_method("set_geometry_cache", &T::set_geometry_cache, "", "geometry cache",
+				"use a (shared) cache for the membrane element geometry")
+			.add_method("set_frozen_jacobian", &T::set_frozen_jacobian, "",
+				"relative tolerance#non-positive value disables reuse",
+				"reuse the local Jacobian as long as the unknowns change less than the tolerance")
+			.add_method("set_conductance", &T::set_conductance, "", "conductance (m^3/s)",
+				"set the channel conductance (also between time steps)")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "RyRImplicit", tag);
 	}
@@ -535,8 +1078,20 @@ static void Domain(Registry& reg, string grp)
 			.add_method("set_channel_type_T", &T::template set_channel_type<T::BG_Ttype>,
 						"", "", "set the channel type to T")
 			.add_method("init", &T::init, "", "time", "initialize the Borg-Graham object")
+			.add_method("use_exact_gating_mode", &T::use_exact_gating_mode, "", "whether to use exact gating",
+						"use the exact (Rush-Larsen) solution for gating updates instead of implicit Euler")
+			.add_method("set_multirate_substeps", &T::set_multirate_substeps, "", "number of sub-steps",
+						"sub-step the gates in each time step and use the time-averaged open probability in the flux")
 			.add_method("export_membrane_potential_to_vtk", &T::export_membrane_potential_to_vtk,
-						"", "file name # step # time", "writes the current membrane potential data to vtk file");
+						"", "file name # step # time", "writes the current membrane potential data to vtk file")
+			.add_method("set_vtk_output_stride", &T::set_vtk_output_stride, "", "stride",
+						"only export every n-th step of the membrane potential to vtk")
+			.add_method("set_async_vtk_output", &T::set_async_vtk_output, "", "asynchronous",
+						"write the membrane potential vtk output in a background thread")
+			.add_method("set_geometry_cache", &T::set_geometry_cache, "", "geometry cache",
+						"use a (shared) cache for the membrane element geometry")
+			.add_method("checkpoint_state", &T::checkpoint_state, "state object", "",
+						"gating state for a SolutionCheckpoint");
 		reg.add_class_to_group(name, "VDCC_BG", tag);
 	}
 
@@ -556,6 +1111,10 @@ static void Domain(Registry& reg, string grp)
 						"", "", "add a potential function")
 			.add_method("set_potential_function", static_cast<void (T::*) (SmartPtr<CplUserData<number, dim> >)> (&T::set_potential_function),
 						"", "", "add a potential function")
+			.add_method("set_potential_function", static_cast<void (T::*) (SmartPtr<ActionPotentialTrain>)> (&T::set_potential_function),
+						"", "action potential train", "use an action potential train as potential")
+			.add_method("set_isopotential", &T::set_isopotential, "", "whether the potential function is independent of space",
+						"evaluate the potential once per time step and integrate the gates for all vertices at once")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "VDCC_BG_UserData", tag);
 	}
@@ -574,10 +1133,23 @@ static void Domain(Registry& reg, string grp)
 				SmartPtr<ApproximationSpace<TDomain> >, const std::string, const char*, const std::string, const bool)>
 				("function(s) as comma-separated c-string#subset(s) as comma-separated c-string#approxSpace#baseNameVmFile#timeFormat#extensionVmFile#fileInterval#fileOffset#vertexOrderOrPositionCanChange")
 			.add_method("set_file_times", &T::set_file_times, "", "file interval#file offset (first file)", "set times for which files with potential values are available")
+			.add_method("set_binary_potential_file", &T::set_binary_potential_file, "", "binary potential file name",
+						"use a preprocessed binary potential file (cf. ConvertVmFilesToBinary) instead of text files")
+			.add_method("set_time_interpolation", &T::set_time_interpolation, "", "whether to interpolate",
+						"linearly interpolate potentials between two consecutive files")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "VDCC_BG_VM2UG", tag);
 	}
 
+	// conversion of potential text files to binary format
+	{
+		std::string name = std::string("ConvertVmFilesToBinary").append(suffix);
+		reg.add_function(name, &VmTimeSeries<TDomain::dim>::write_from_text_files, grp.c_str(), "",
+			"output file name#base name of text files#time format#extension of text files#"
+			"file interval#file offset (first file)#number of files",
+			"converts a series of potential text files to one binary potential file");
+	}
+
 	// VDCC with Neuron
 #ifdef NC_WITH_NEURON
 	{
@@ -594,6 +1166,8 @@ static void Domain(Registry& reg, string grp)
 			.add_method("set_transformator", static_cast<void (T::*) (SmartPtr<membrane_potential_mapping::Transformator>)> (&T::set_transformator), "", "", "")
 			.add_method("set_provider", static_cast<void (T::*) (SmartPtr<membrane_potential_mapping::Mapper<TDomain::dim, number> >)> (&T::set_provider), "", "", "")
 			.add_method("set_mapper", static_cast<void (T::*) (SmartPtr<membrane_potential_mapping::NeuronMPM>)> (&T::set_mapper), "", "", "")
+			.add_method("set_shared_vm_buffer", &T::set_shared_vm_buffer, "", "shared membrane potential buffer",
+				"take membrane potentials from an in-memory buffer written by NEURON")
 			.set_construct_as_smart_pointer(true);
 		reg.add_class_to_group(name, "VDCC_BG_VM2UG_NEURON", tag);
 	}
@@ -614,10 +1188,37 @@ static void Domain(Registry& reg, string grp)
 	reg.add_function("compute_volume_of_subset", static_cast<number (*) (ConstSmartPtr<ApproximationSpace<TDomain> >, int)>(&computeVolume<TDomain>), grp.c_str(),
 					 "volume of the subset", "approxSpace # subset index", "calculates subset volume");
 
+	// cached volumes of several subsets
+	{
+		typedef SubsetVolumes<TDomain> T;
+		string name = string("SubsetVolumes").append(suffix);
+		reg.add_class_<T>(name, grp)
+			.template add_constructor<void (*)(ConstSmartPtr<ApproximationSpace<TDomain> >, const char*)>
+				("approximation space # subset names")
+			.add_method("volume", &T::volume, "volume of the subset", "index of the subset in the given names",
+				"volume of a subset (computed for all subsets at once and cached until the grid changes)")
+			.add_method("invalidate", &T::invalidate, "", "", "force re-computation on next access")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "SubsetVolumes", tag);
+	}
+
 	reg.add_function("RemoveAllNonDefaultRefinementProjectors", &RemoveAllNonDefaultRefinementProjectors<TDomain>);
+	reg.add_function("GlobalRefineWithBatchedProjection", &GlobalRefineWithBatchedProjection<TDomain>, grp.c_str(), "", "domain#threaded (only for thread-safe projectors)", "refines globally, then projects all new vertices in one pass");
 
 	reg.add_function("PathLength1D", static_cast<number (*)(const std::string&, const std::string&, const std::string&, TDomain&)>(&PathLength1D<TDomain>), "length", "1d domain#from subset#to subset#3d domain");
 
+#ifdef UG_PARALLEL
+	reg.add_function("PartitionNeuronNetwork", &PartitionNeuronNetwork<TDomain>, grp.c_str(), "number of split neurons",
+					 "domain#partition map#number of partitions#base level#imbalance tolerance",
+					 "partition a 1d network by neuron IDs, keeping neurons on one partition where possible");
+	reg.add_function("SavePartitionedDomain", &SavePartitionedDomain<TDomain>, grp.c_str(), "",
+					 "distributed domain#file name base",
+					 "save each process' part of a distributed domain (with interfaces) for LoadPartitionedDomain");
+	reg.add_function("LoadPartitionedDomain", &LoadPartitionedDomain<TDomain>, grp.c_str(), "",
+					 "empty domain#file name base",
+					 "load a domain saved by SavePartitionedDomain with the same number of processes, without redistribution");
+#endif
+
 }
 
 /**
@@ -635,6 +1236,22 @@ static void Dimension(Registry& reg, string grp)
 	string suffix = GetDimensionSuffix<dim>();
 	string tag = GetDimensionTag<dim>();
 
+	// in-memory membrane potential exchange
+	{
+		typedef SharedVmBuffer<dim> T;
+		string name = string("SharedVmBuffer").append(suffix);
+		reg.add_class_<T>(name, grp)
+			.add_constructor()
+			.add_method("set_points", &T::set_points, "", "point coordinates (dim entries per point) # resting potential (mV)",
+				"set the (fixed) point layout")
+			.add_method("set_values", &T::set_values, "", "potentials (mV) in layout order # time",
+				"copy new potential values")
+			.add_method("num_points", &T::num_points, "number of points", "", "")
+			.add_method("value", &T::value, "potential (mV)", "point index", "")
+			.add_method("time", &T::time, "time of current values", "", "")
+			.set_construct_as_smart_pointer(true);
+		reg.add_class_to_group(name, "SharedVmBuffer", tag);
+	}
 }
 
 /**
@@ -653,6 +1270,76 @@ static void Algebra(Registry& reg, string grp)
 	string tag = GetAlgebraTag<TAlgebra>();
 }
 
+#ifdef NC_WITH_GRID_GENERATION
+/**
+ * Registration of the grid generators (bouton, spine, dendrite).
+ * SWC import and neurite test utilities are registered by RegisterNeuriteGeneration().
+ * With NCLazyRegistration, this group is only registered on
+ * require_neuro_collection_group("grid_generation").
+ *
+ * @param reg		registry
+ * @param grp		group for sorting of functionality
+ */
+static void GridGeneration(Registry& reg, string grp)
+{
+	// build bouton
+	{
+        reg.add_function("BuildBouton", static_cast<void (*)(bool, number, int, int, number, number, number, number, string)>(&BuildBouton), grp,
+                         "", "bExtSpace#radius#numRefinements#numReleaseSites#TbarHeight#TbarLegRadius#TbarTopRadius#TbarTopHeight#fileName",
+                         "Generates a drosophila NMJ bouton volume grid.");
+        reg.add_function("BuildBouton", static_cast<void (*)(bool, number, int, int, number, number, number, number, Grid&, SubsetHandler&)>(&BuildBouton), grp,
+                         "", "bExtSpace#radius#numRefinements#numReleaseSites#TbarHeight#TbarLegRadius#TbarTopRadius#TbarTopHeight#grid#subset handler",
+                         "Generates a drosophila NMJ bouton volume grid in the given (empty) grid.");
+	}
+
+	// build spine
+	{
+		// TODO: Rename "BuildSpine", remove ineffective parameters
+        reg.add_function("BuildDendrite", static_cast<void (*)(const std::vector<number>&, const std::vector<bool>&, const std::string&)>(&BuildSpine), grp,
+                         "", "geometric param vector (cytosol radius, ER radius, dendrite length, spine position, "
+                         "spine ER neck radius, spine ER neck length, spine ER head radius, spine ER head length, "
+                         "spine neck radius, spine neck length, spine head radius, spine head length)"
+                         "options vector (build a synapse? [ineffective], build ER?, build spine ER?, "
+                         "synapse at different location? [ineffective], build spine ER head?)"
+                         "#fileName",
+                         "Generates a dendritic spine with a portion of the connected dendrite.");
+        reg.add_function("BuildDendrite", static_cast<void (*)(const std::vector<number>&, const std::vector<bool>&, Grid&, SubsetHandler&, const std::string&)>(&BuildSpine), grp,
+                         "", "geometric param vector#options vector#grid#subset handler#debug file name",
+                         "Generates a dendritic spine with a portion of the connected dendrite in the given (empty) grid.");
+	}
+
+	// DendriteGenerator
+	{
+		typedef DendriteGenerator T;
+		string name = string("DendriteGenerator");
+		reg.add_class_<T>(name, grp)
+			.add_constructor()
+			.add_method("set_dendrite_length", &T::set_dendrite_length, "", "", "")
+			.add_method("set_dendrite_radius", &T::set_dendrite_radius, "", "", "")
+			.add_method("set_er_radius", &T::set_er_radius, "", "", "")
+			.add_method("set_synapse_area", &T::set_synapse_area, "", "", "")
+			.add_method("set_num_segments", &T::set_num_segments, "", "", "")
+			.add_method("num_segments", &T::num_segments, "", "", "")
+			.add_method("create_dendrite_middle_influx", static_cast<void (T::*)(const std::string&)>(&T::create_dendrite_middle_influx), "", "", "")
+			.add_method("create_dendrite", static_cast<void (T::*)(const std::string&)>(&T::create_dendrite), "", "", "")
+			.add_method("create_dendrite_1d", static_cast<void (T::*)(const std::string&)>(&T::create_dendrite_1d), "", "", "")
+			.add_method("create_dendrite_discreteRyR", static_cast<void (T::*)(const std::string&, number)>(&T::create_dendrite_discreteRyR), "", "", "")
+			.add_method("create_dendrite_middle_influx", static_cast<void (T::*)(Grid&, ISubsetHandler&)>(&T::create_dendrite_middle_influx),
+				"", "grid # subset handler", "create in (domain) grid instead of file")
+			.add_method("create_dendrite", static_cast<void (T::*)(Grid&, ISubsetHandler&)>(&T::create_dendrite),
+				"", "grid # subset handler", "create in (domain) grid instead of file")
+			.add_method("create_dendrite_1d", static_cast<void (T::*)(Grid&, ISubsetHandler&)>(&T::create_dendrite_1d),
+				"", "grid # subset handler", "create in (domain) grid instead of file")
+			.add_method("create_dendrite_discreteRyR", static_cast<void (T::*)(Grid&, ISubsetHandler&, number)>(&T::create_dendrite_discreteRyR),
+				"", "grid # subset handler # channel distance", "create in (domain) grid instead of file")
+			.add_method("create_dendrite_distributed", &T::create_dendrite_distributed,
+				"", "grid # subset handler", "create in (domain) grid, each process only its own range of segments")
+			.add_method("set_bobbel_er", &T::set_bobbel_er, "", "numSeg / ER block # numSeg / hole block", "")
+			.set_construct_as_smart_pointer(true);
+	}
+}
+#endif
+
 /**
  * Function called for the registration of Domain and Algebra independent parts.
  * All Functions and Classes not depending on Domain and Algebra
@@ -683,7 +1370,22 @@ static void Common(Registry& reg, string grp)
 						"Default values: 1.0 (no scaling).")
 			.add_method("set_scale_flux", &T::set_scale_flux, "", "index#scaling factor",
 						"Sets a scaling factor for conversion of the calculated flux (specified by first parameter) to the unit employed "
-						"by the user.", "");
+						"by the user.", "")
+			.add_method("set_element_cost", &T::set_element_cost, "", "relative cost (negative: estimate)",
+						"Sets the cost of a membrane element using this mechanism relative to a bulk element "
+						"(used for load balancing).", "")
+			.add_method("element_cost", &T::element_cost, "relative cost of a membrane element", "", "", "")
+			.add_method("parameter_revision", &T::parameter_revision, "number of parameter changes so far", "", "", "")
+			.add_method("set_device_offload", &T::set_device_offload, "", "whether to offload",
+						"Evaluates batched fluxes on an offload device (needs the NCDeviceOffload build option).", "")
+			.add_method("device_offload", &T::device_offload, "whether batched fluxes are offloaded", "", "", "")
+			.add_method("set_device_offload_min_batch_size", &T::set_device_offload_min_batch_size, "", "number of points",
+						"Sets the minimal number of points for a batch to be offloaded (smaller batches stay on the host).", "")
+			.add_method("has_device_kernels", &T::has_device_kernels, "whether device kernels exist", "", "", "")
+			.add_method("set_frozen_gating_jacobian", &T::set_frozen_gating_jacobian, "", "whether to freeze gating",
+						"Treats gating as constant in the flux derivatives (inexact Newton; fluxes still use "
+						"the gates of the current iterate; the sparsity pattern is retained).", "")
+			.add_method("frozen_gating_jacobian", &T::frozen_gating_jacobian, "whether gating is frozen in the Jacobian", "", "", "");
 			//.add_method("calc_flux", static_cast<number (T::*) (const std::vector<number>&, size_t) const>(&T::calc_flux), "", "input values#flux index#output flux",
 			//		"calculates the specified flux through this mechanism", "");
 			/* does not work, since vectors have to be const for exchange with lua
@@ -747,6 +1449,8 @@ static void Common(Registry& reg, string grp)
 			.add_constructor<void (*)(const std::vector<std::string>&)>
 				("Function vector with the following order: "
 				 "{\"cytosolic calcium\", \"endoplasmic calcium\"}")
+			.add_method("set_conductance", &T::set_conductance, "", "conductance (m^3/s)",
+				"set the channel conductance (also between time steps)")
 			.set_construct_as_smart_pointer(true);
 	}
 	{
@@ -762,6 +1466,26 @@ static void Common(Registry& reg, string grp)
 				 "{\"cytosolic calcium\", \"endoplasmic calcium\"}")
 			.set_construct_as_smart_pointer(true);
 	}
+	{
+		typedef FusedERMembrane T;
+		typedef IMembraneTransporter TBase;
+		std::string name = std::string("FusedERMembrane");
+		reg.add_class_<T, TBase>(name, grp)
+			.add_constructor<void (*)(const char*)>
+				("Functions as comma-separated string with the following order: "
+				 "\"cytosolic calcium, endoplasmic calcium, ip3\"")
+			.add_constructor<void (*)(const std::vector<std::string>&)>
+				("Function vector with the following order: "
+				 "{\"cytosolic calcium\", \"endoplasmic calcium\", \"ip3\"}")
+			.add_method("set_densities", &T::set_densities, "", "SERCA density#RyR density#IP3R density#leakage density",
+				"set the densities (1/m^2) of the combined mechanisms")
+			.add_method("set_leak_to_equilibrium", &T::set_leak_to_equilibrium, "", "cytosolic calcium#endoplasmic calcium#ip3",
+				"choose the leakage density such that there is no net flux for the given concentrations")
+			.add_method("leak_density", &T::leak_density, "leakage density", "", "")
+			.add_method("set_ryr_conductance", &T::set_ryr_conductance, "", "conductance (m^3/s)", "set the RyR channel conductance")
+			.add_method("set_ip3r_conductance", &T::set_ip3r_conductance, "", "conductance (m^3/s)", "set the IP3R channel conductance")
+			.set_construct_as_smart_pointer(true);
+	}
 	{
 		typedef Leak T;
 		typedef IMembraneTransporter TBase;
@@ -791,6 +1515,10 @@ static void Common(Registry& reg, string grp)
 			.add_constructor<void (*)(const std::vector<std::string>&)>
 				("Function vector with the following order: "
 				 "{\"cytosolic calcium\", \"extracellular calcium\"}")
+			.add_method("set_dissociation_constant", &T::set_dissociation_constant, "", "dissociation constant (mM)",
+				"set the calcium dissociation constant (also between time steps)")
+			.add_method("set_max_flux", &T::set_max_flux, "", "maximal flux (mol/s)",
+				"set the maximal flux (also between time steps)")
 			.set_construct_as_smart_pointer(true);
 	}
 	{
@@ -804,6 +1532,10 @@ static void Common(Registry& reg, string grp)
 			.add_constructor<void (*)(const std::vector<std::string>&)>
 				("Function vector with the following order: "
 				 "{\"cytosolic calcium\", \"extracellular calcium\"}")
+			.add_method("set_dissociation_constant", &T::set_dissociation_constant, "", "dissociation constant (mM)",
+				"set the calcium dissociation constant (also between time steps)")
+			.add_method("set_max_flux", &T::set_max_flux, "", "maximal flux (mol/s)",
+				"set the maximal flux (also between time steps)")
 			.set_construct_as_smart_pointer(true);
 	}
 	{
@@ -878,106 +1610,115 @@ static void Common(Registry& reg, string grp)
 			.add_constructor()
 			.add_constructor<void (*)(number, number, number, number)>
 				("stimBegin#stimEnd#stimFreq#basicVoltage")
+			.add_constructor<void (*)(number, number, number, number, number)>
+				("stimBegin#stimEnd#stimFreq#basicVoltage#tableStep")
 			.add_method("membrane_potential", &T::membrane_potential,
 						"Returns membrane potential to given frequency stimulation interval.")
+			.add_method("set_tabulation", &T::set_tabulation, "", "sampling step (s)",
+						"use a sampled table of the AP voltage trace (non-positive step disables)")
 			.set_construct_as_smart_pointer(true);
 	}
 
-	// build bouton
+#ifdef NC_WITH_GRID_GENERATION
+	// grid generation (possibly registered lazily)
+	RegisterGroup(reg, grp, "grid_generation", &GridGeneration);
+#endif
+#ifdef NC_WITH_NEURITE_GENERATION
+	RegisterGroup(reg, grp, "neurite_generation", &RegisterNeuriteGeneration);
+#endif
 	{
-        reg.add_function("BuildBouton", &BuildBouton, grp,
-                         "", "bExtSpace#radius#numRefinements#numReleaseSites#TbarHeight#TbarLegRadius#TbarTopRadius#TbarTopHeight#fileName",
-                         "Generates a drosophila NMJ bouton volume grid.");
+		reg.add_function("require_neuro_collection_group", &RequireGroup, grp.c_str(), "",
+			"group name (grid_generation, neurite_generation)",
+			"Registers a group of functionality that is registered lazily (NCLazyRegistration=ON); "
+			"no-op if the group is already registered.");
 	}
 
-	// build spine
+	// mesh cache for generated grids
 	{
-		// TODO: Rename "BuildSpine", remove ineffective parameters
-        reg.add_function("BuildDendrite", &BuildSpine, grp,
-                         "", "geometric param vector (cytosol radius, ER radius, dendrite length, spine position, "
-                         "spine ER neck radius, spine ER neck length, spine ER head radius, spine ER head length, "
-                         "spine neck radius, spine neck length, spine head radius, spine head length)"
-                         "options vector (build a synapse? [ineffective], build ER?, build spine ER?, "
-                         "synapse at different location? [ineffective], build spine ER head?)"
-                         "#fileName",
-                         "Generates a dendritic spine with a portion of the connected dendrite.");
+		reg.add_function("set_mesh_cache_directory", &set_mesh_cache_directory, grp.c_str(), "",
+			"cache directory (empty to disable)",
+			"Sets the directory where generated grids are cached by their input (SWC import, DendriteGenerator).");
 	}
 
-	// DendriteGenerator
+	// hot path instrumentation
 	{
-		typedef DendriteGenerator T;
-		string name = string("DendriteGenerator");
+		reg.add_function("set_hot_path_sample_interval", &set_hot_path_sample_interval, grp.c_str(), "",
+			"interval", "Times every n-th call of instrumented functions (default: 64).");
+		reg.add_function("mark_hot_path_newton_iteration", &mark_hot_path_newton_iteration, grp.c_str(), "", "",
+			"Closes the current Newton iteration for the attribution of calls to iterations.");
+		reg.add_function("reset_hot_path_counters", &reset_hot_path_counters, grp.c_str(), "", "",
+			"Sets all hot path counters to zero.");
+		reg.add_function("print_hot_path_report", &print_hot_path_report, grp.c_str(), "", "",
+			"Prints call counts and times of instrumented functions by mechanism and subsets "
+			"(requires the plugin to be built with NCInstrumentation=ON).");
+	}
+
+	// timeline trace of coupling phases
+	{
+		reg.add_function("start_timeline_trace", &start_timeline_trace, grp.c_str(), "",
+			"maximal number of events per process",
+			"Starts recording timeline events of the coupling phases (ring buffer per process).");
+		reg.add_function("stop_timeline_trace", &stop_timeline_trace, grp.c_str(), "", "",
+			"Stops recording timeline events.");
+		reg.add_function("write_timeline_trace", &write_timeline_trace, grp.c_str(), "", "file name",
+			"Writes the recorded events of all processes in Chrome trace JSON format (collective).");
+		reg.add_function("timeline_trace_begin", &timeline_trace_begin, grp.c_str(), "", "phase name",
+			"Begins a phase in the timeline trace (e.g. assembling or solving).");
+		reg.add_function("timeline_trace_end", &timeline_trace_end, grp.c_str(), "", "",
+			"Ends the innermost phase begun by timeline_trace_begin.");
+	}
+
+	// memory accounting
+	{
+		reg.add_function("add_grid_to_memory_report", &add_grid_to_memory_report, grp.c_str(), "",
+			"multigrid#name", "Reports the elements of the grid and the plugin's attachments on it.");
+		reg.add_function("clear_memory_report_grids", &clear_memory_report_grids, grp.c_str(), "", "",
+			"Removes all grids from the memory report.");
+		reg.add_function("print_memory_report", &print_memory_report, grp.c_str(), "", "",
+			"Prints the memory held by grids, transport mechanisms and couplings, "
+			"reduced over all processes (collective).");
+		reg.add_function("update_memory_peak", &update_memory_peak, grp.c_str(), "", "",
+			"Keeps the current memory report of this process if its total is the largest so far.");
+		reg.add_function("print_memory_peak_report", &print_memory_peak_report, grp.c_str(), "", "",
+			"Prints the peak memory reports of all processes (collective).");
+	}
+
+	// time step size control
+	{
+		typedef TimeStepController T;
+		std::string name = std::string("TimeStepController");
 		reg.add_class_<T>(name, grp)
 			.add_constructor()
-			.add_method("set_dendrite_length", &T::set_dendrite_length, "", "", "")
-			.add_method("set_dendrite_radius", &T::set_dendrite_radius, "", "", "")
-			.add_method("set_er_radius", &T::set_er_radius, "", "", "")
-			.add_method("set_synapse_area", &T::set_synapse_area, "", "", "")
-			.add_method("set_num_segments", &T::set_num_segments, "", "", "")
-			.add_method("num_segments", &T::num_segments, "", "", "")
-			.add_method("create_dendrite_middle_influx", &T::create_dendrite_middle_influx, "", "", "")
-			.add_method("create_dendrite", &T::create_dendrite, "", "", "")
-			.add_method("create_dendrite_1d", &T::create_dendrite_1d, "", "", "")
-			.add_method("create_dendrite_discreteRyR", &T::create_dendrite_discreteRyR, "", "", "")
-			.add_method("set_bobbel_er", &T::set_bobbel_er, "", "numSeg / ER block # numSeg / hole block", "")
+			.add_method("add_transporter", &T::add_transporter, "", "membrane transport mechanism",
+						"registers a mechanism whose characteristic time scale restricts the step size")
+			.add_method("set_time_step_bounds", &T::set_time_step_bounds, "", "minimal step size#maximal step size", "")
+			.add_method("set_growth_limits", &T::set_growth_limits, "", "maximal growth factor#maximal shrinking factor", "")
+			.add_method("set_safety_factor", &T::set_safety_factor, "", "safety factor", "")
+			.add_method("set_change_tolerance", &T::set_change_tolerance, "", "relative change per step", "")
+			.add_method("set_time_scale_fraction", &T::set_time_scale_fraction, "", "fraction",
+						"fraction of the smallest characteristic time scale allowed as step size")
+			.add_method("set_wave_front_resolution", &T::set_wave_front_resolution, "", "element size at the front", "")
+			.add_method("set_wave_front_velocity", &T::set_wave_front_velocity, "", "front velocity", "")
+			.add_method("characteristic_time_scale", &T::characteristic_time_scale, "time scale", "",
+						"smallest characteristic time scale of all mechanisms and the wave front (collective)")
+			.add_method("check_step", &T::check_step, "whether the step is accepted", "step size#relative change",
+						"checks the last step and calculates the size of the next one (collective)")
+			.add_method("next_dt", &T::next_dt, "proposed step size", "", "")
+			.add_method("num_accepted", &T::num_accepted, "number of accepted steps", "", "")
+			.add_method("num_rejected", &T::num_rejected, "number of rejected steps", "", "")
 			.set_construct_as_smart_pointer(true);
 	}
 
-#ifndef UG_FOR_VRL
-	// neurites from swc
-	{
-		reg.add_function("import_neurites_from_swc", &neurites_from_swc::import_neurites_from_swc, "",
-			"file name # anisotropy # refinements", "");
-		reg.add_function("import_er_neurites_from_swc", &neurites_from_swc::import_er_neurites_from_swc, "",
-			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements", "");
-		reg.add_function("import_1d_neurites_from_swc", &neurites_from_swc::import_1d_neurites_from_swc, "",
-			"file name # anisotropy # refinements", "");
-	}
-
-	// test neurite projector
-	{
-		reg.add_function("test_neurite_projector", &test_neurite_projector_with_four_section_tube, "", "", "");
-		reg.add_function("test_neurite_projector_with_bp", &test_neurite_projector_with_four_section_tube_and_branch_point, "", "", "");
-		reg.add_function("test_import_swc_with_er", &test_import_swc_with_er, "",
-			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize", "");
-		reg.add_function("test_import_swc_general", &test_import_swc_general, "",
-			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements", "");
-		reg.add_function("test_import_swc_general_var", &test_import_swc_general_var, "",
-			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize # blow up factor # for VR # dryRun# option # segLength", "");
-		reg.add_function("test_import_swc_general_var_benchmark", &test_import_swc_general_var_benchmark, "",
-			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize # blow up factor # for VR # dryRun# option # segLength", "");
-		reg.add_function("test_import_swc_general_var_benchmark_var", &test_import_swc_general_var_benchmark_var, "",
-			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize # blow up factor # for VR # dryRun# option # segLength", "");
-		reg.add_function("test_import_swc_general_var_for_vr", &test_import_swc_general_var_for_vr, "",
-			"swc file name (input) # ugx file name (output) # ER scale factor # anisotropy # refinements # regularize # blow up factor", "");
-		reg.add_function("test_import_swc_surf", &test_import_swc_surf, "", "file name", "");
-		reg.add_function("test_import_swc_1d", &test_import_swc_1d, "", "file name # anisotropy # refinements", "");
-		reg.add_function("test_convert_swc_to_ugx", &test_convert_swc_to_ugx, "", "file name");
-		reg.add_function("refine_swc_grid", &refine_swc_grid, "", "");
-		reg.add_function("refine_swc_grid_variant", &refine_swc_grid_variant, "input file name # output file name", "");
-		reg.add_function("coarsen_1d_grid", &coarsen_1d_grid, "input file name", "output file name");
-		reg.add_function("test_import_swc_vr", &test_import_swc_vr, "Filename # anisotropy # numRefs");
-		reg.add_function("test_import_swc_general_var_for_vr_var", &test_import_swc_general_var_for_vr_var, "");
-		reg.add_function("test_import_swc_general_var_for_vr_var_benchmark", &test_import_swc_general_var_for_vr_var_benchmark, "");
-		reg.add_function("create_branches_from_swc", static_cast<void (*)(const std::string&, number, size_t, bool)>(&create_branches_from_swc), "", "input file name # ER scale factor # number of refinements # create measurement subsets", "");
-		reg.add_function("create_branches_from_swc", static_cast<void (*)(const std::string&, number, size_t)>(&create_branches_from_swc), "", "input file name # ER scale factor # number of refinements", "");
-		reg.add_function("test_import_swc_and_regularize", static_cast<void (*)(const std::string&, number, const std::string&, const size_t, const bool, const bool)>(&test_import_swc_and_regularize), "", "file name # desired segment length", "");
-		reg.add_function("test_import_swc_and_regularize", static_cast<void (*)(const std::string&, number, const std::string&, const size_t, const bool, const bool, const number)>(&test_import_swc_and_regularize), "", "file name # desired segment length", "");
-		reg.add_function("test_import_swc_and_regularize", static_cast<void (*)(const std::string&)>(&test_import_swc_and_regularize), "", "file name # desired segment length", "");
-		reg.add_function("test_import_swc_and_regularize", static_cast<void (*)(const std::string&, const bool, const bool)>(&test_import_swc_and_regularize), "", "file name # desired segment length # soma Included", "");
-		reg.add_function("test_import_swc_and_regularize_var", (&test_import_swc_and_regularize_var), "", "file name", "");
-		reg.add_function("GetNumberOfTriangleIntersections", &GetNumberOfTriangleIntersections, "", "gridName#snapThreshold", "");
-	}
-
-	/// statistics (temporary)
-	{
-		reg.add_function("test_statistics", &test_statistics);
-		reg.add_function("test_statistics_soma", &test_statistics_soma);
-	}
-
-	// grid generation
-	{
-		reg.add_function("polygonal_mesh_from_txt", &polygonal_mesh_from_txt, "", "TXT input file|string");
+#if defined(UG_DIM_2) && defined(NC_WITH_GRID_GENERATION)
+	// assembly throughput benchmark
+	{
+		reg.add_function("create_assembly_benchmark_dendrite", &CreateAssemblyBenchmarkDendrite, grp.c_str(), "",
+			"domain # number of segments",
+			"Generates the 2d dendrite of the DendriteGenerator into the given domain (on rank 0).");
+		reg.add_function("run_assembly_benchmark", &RunAssemblyBenchmark, grp.c_str(), "",
+			"domain # label # thread counts (comma-separated) # repetitions # JSON lines output file",
+			"Measures defect and Jacobian assembly throughput of the standard calcium model "
+			"per element disc and appends the results to the output file.");
 	}
 #endif
 
@@ -993,6 +1734,8 @@ static void Common(Registry& reg, string grp)
 #endif
 			.add_constructor<void (*)(SmartPtr<Domain3d>)>("domain")
 			.add_method("mark", &T::mark, "", "refiner", "Marks neurites for axial refinement.")
+			.add_method("set_incremental", &T::set_incremental, "", "incremental",
+				"only examine new volumes for branching points (default: off)")
 			.set_construct_as_smart_pointer(true);
 	}
 
@@ -1016,6 +1759,65 @@ static void Common(Registry& reg, string grp)
 	{
 		reg.add_function("GetCoordinatesFromVertexByIndex", &GetCoordinatesFromVertexByIndex, grp.c_str(), "coordinates", "grid#index", "");
 	}
+
+	// non-DoF state for checkpoints
+	{
+		reg.add_class_<ICheckpointState>("ICheckpointState", grp);
+	}
+
+	// migration of channel states on redistribution
+	{
+		typedef ChannelStateMigration T;
+		reg.add_class_<T>("ChannelStateMigration", grp)
+			.add_constructor()
+			.add_method("add_state", &T::add_state, "", "state object (e.g. from checkpoint_state())",
+				"add the state of a channel to be migrated with its grid objects")
+			.set_construct_as_smart_pointer(true);
+	#ifdef UG_PARALLEL
+		reg.add_function("AddChannelStateMigration", &AddChannelStateMigration, grp.c_str(), "",
+			"load balancer # channel state migration",
+			"pack channel states into the distribution buffers of the load balancer");
+	#endif
+	}
+
+	// reader for binary measurement / profile output
+	{
+		typedef BinaryRecordReader T;
+		reg.add_class_<T>("BinaryRecordReader", grp)
+			.add_constructor<void (*)(const std::string&)>("file name")
+			.add_method("num_columns", &T::num_columns, "number of column names", "", "")
+			.add_method("column_name", &T::column_name, "column name", "column index", "")
+			.add_method("num_records", &T::num_records, "number of records", "", "")
+			.add_method("record_size", &T::record_size, "number of values", "record index", "")
+			.add_method("value", &T::value, "value", "record index # value index", "")
+			.add_method("record", &T::record, "values", "record index", "")
+			.add_method("export_ascii", &T::export_ascii, "", "output file name",
+				"write all records to a tab-separated text file")
+			.set_construct_as_smart_pointer(true);
+	}
+
+	// reader for compressed measurement / profile series
+	{
+		typedef CompressedSeriesReader T;
+		reg.add_class_<T>("CompressedSeriesReader", grp)
+			.add_constructor<void (*)(const std::string&)>("file name")
+			.add_method("num_points", &T::num_points, "number of points", "", "")
+			.add_method("coord_dim", &T::coord_dim, "number of coordinates per point", "", "")
+			.add_method("coordinate", &T::coordinate, "coordinate", "point index # coordinate index", "")
+			.add_method("num_values", &T::num_values, "number of values per snapshot", "", "")
+			.add_method("num_columns", &T::num_columns, "number of column names", "", "")
+			.add_method("column_name", &T::column_name, "column name", "column index", "")
+			.add_method("tolerance", &T::tolerance, "absolute error bound (0 if lossless)", "", "")
+			.add_method("num_snapshots", &T::num_snapshots, "number of snapshots", "", "")
+			.add_method("time", &T::time, "time", "snapshot index", "")
+			.add_method("snapshot_index", &T::snapshot_index, "snapshot index", "time",
+				"index of the last snapshot at or before the given time")
+			.add_method("snapshot", &T::snapshot, "values", "snapshot index", "")
+			.add_method("snapshot_at_time", &T::snapshot_at_time, "values", "time",
+				"values of the last snapshot at or before the given time")
+			.add_method("value", &T::value, "value", "snapshot index # value index", "")
+			.set_construct_as_smart_pointer(true);
+	}
 }
 
 }; // end Functionality
@@ -1044,6 +1846,20 @@ struct NonBlockedFunctionality
 				.add_method("calculate_steady_state", &T::calculate_steady_state, "", "solution", "")
 				.add_method("set_cutoff_open_probability", &T::set_cutoff_open_probability, "", "cutoff probability",
 					"set open probability below which the channel is supposed to be certainly closed")
+				.add_method("set_stochastic_mode", &T::set_stochastic_mode, "",
+					"stochastic gating # number of channels per cluster",
+					"simulate channel gating stochastically, each channel vertex representing a cluster of channels")
+				.add_method("set_tau_leaping_threshold", &T::set_tau_leaping_threshold, "", "number of channels",
+					"set cluster size from which on clusters are advanced by tau-leaping instead of event-driven")
+				.add_method("set_random_seed", &T::set_random_seed, "", "seed", "")
+				.add_method("set_calcium_rescale_tolerance", &T::set_calcium_rescale_tolerance, "", "relative tolerance",
+					"set relative calcium change below which scheduled transition events are kept")
+				.add_method("set_mean_field_clustering", &T::set_mean_field_clustering, "", "cluster radius",
+					"aggregate neighboring channel vertices to mean-field clusters sharing one set of gating states")
+				.add_method("set_nanodomain_correction", &T::set_nanodomain_correction, "",
+					"channel mouth radius (um) # mesh resolution radius (um) # diffusion coefficient (um^2/s) # "
+					"buffer binding rate k_on*B_tot (1/s)",
+					"use analytic sub-grid calcium concentration at the channel mouth for the gating kinetics")
 				.set_construct_as_smart_pointer(true);
 			reg.add_class_to_group(name, "RyRDiscrete", tag);
 		}
@@ -1084,6 +1900,12 @@ struct Pure3DFunctionality
 					"Set initial values for all unknowns in the 1d cable simulation.")
 				.add_method("set_coordinate_scale_factor_3d_to_1d", &T::set_coordinate_scale_factor_3d_to_1d, "",
 					"factor", "Set a factor for coordinate scaling from 3d to 1d representation.")
+				.add_method("set_distributed_potential_mapping", &T::set_distributed_potential_mapping, "",
+					"distributed", "Set whether the 3d->1d potential mapping is computed without global gathering of 1d vertices.")
+				.add_method("set_incremental_potential_remapping", &T::set_incremental_potential_remapping, "",
+					"incremental", "Set whether the 3d->1d potential mapping is only updated for new vertices after 3d grid adaption.")
+				.add_method("set_potential_edge_interpolation", &T::set_potential_edge_interpolation, "",
+					"edgeInterpolation", "Set whether 1d potential values are interpolated linearly along the nearest 1d edge.")
 				.add_method("set_solver_output_verbose", &T::set_solver_output_verbose, "",
 					"verbose", "Set whether the output of the 1d solver is to be verbose.")
 				.add_method("set_vtk_output", &T::set_vtk_output, "",
@@ -1091,12 +1913,68 @@ struct Pure3DFunctionality
 				.add_method("set_time_steps_for_simulation_and_potential_update", &T::set_time_steps_for_simulation_and_potential_update, "",
 					"simulation time step#potential update time step",
 					"Set a time step size (maximum) for the 1d simulation and for the potential update.")
+				.add_method("set_pipelined_coupling", &T::set_pipelined_coupling, "", "pipelined",
+					"Set whether the 3d problem uses potentials lagged by one time step, "
+					"so that their communication overlaps the 3d solve.")
+				.add_method("set_cfl_reuse_tolerance", &T::set_cfl_reuse_tolerance, "", "relative tolerance",
+					"Set a tolerance for the relative change of the 1d solution below which CFL estimates are reused.")
+				.add_method("set_adaptive_substepping", &T::set_adaptive_substepping, "", "safety factor#max growth factor",
+					"Use a continuous adaptive substep size controller for the 1d problem.")
+				.add_method("num_substeps_last_step", &T::num_substeps_last_step, "number of substeps", "",
+					"Number of 1d substeps in the last 3d time step.")
+				.add_method("max_substeps_per_step", &T::max_substeps_per_step, "max number of substeps", "",
+					"Maximal number of 1d substeps in a 3d time step.")
+				.add_method("average_substeps_per_step", &T::average_substeps_per_step, "average number of substeps", "",
+					"Average number of 1d substeps per 3d time step.")
+				.add_method("num_cfl_estimates", &T::num_cfl_estimates, "number of CFL estimates", "",
+					"Number of CFL estimates computed.")
+				.add_method("num_cfl_reuses", &T::num_cfl_reuses, "number of CFL reuses", "",
+					"Number of CFL estimates reused.")
+				.add_method("reset_substep_statistics", &T::reset_substep_statistics, "", "",
+					"Reset the 1d substepping statistics.")
 				// not necessary atm
 				//.add_method("set_hybrid_neuron_communicator", &T::set_hybrid_neuron_communicator, "",
 				//    "hybrid neuron communicator", "Set a hybrid neuron communicator.")
 				.set_construct_as_smart_pointer(true);
 			reg.add_class_to_group(name, "VDCC_BG_CN", tag);
 		}
+
+		// scaling benchmark for hybrid 1d/3d coupling
+		{
+			typedef HybridCouplingBenchmark<TDomain> T;
+			std::string name = std::string("HybridCouplingBenchmark").append(suffix);
+			reg.add_class_<T>(name, grp)
+				.template add_constructor<void (*)(SmartPtr<ApproximationSpace<TDomain> >,
+					SmartPtr<ApproximationSpace<TDomain> >,
+					SmartPtr<cable_neuron::synapse_handler::SynapseHandler<TDomain> >, const std::string&)>
+					("3d approximation space#1d approximation space#synapse handler#1d potential function name")
+				.add_method("set_potential_subsets", &T::set_potential_subsets, "", "subset(s) as vector",
+					"Set the 3d subsets receiving potential values.")
+				.add_method("set_current_subsets", &T::set_current_subsets, "", "subset(s) as vector",
+					"Set the 3d subsets receiving synaptic currents.")
+				.add_method("set_neuron_ids", &T::set_neuron_ids, "", "neuron ids as vector",
+					"Set the 3d represented neuron IDs.")
+				.add_method("set_coordinate_scale_factor_3d_to_1d", &T::set_coordinate_scale_factor_3d_to_1d, "",
+					"factor", "Set a factor for coordinate scaling from 3d to 1d representation.")
+				.add_method("set_distributed_potential_mapping", &T::set_distributed_potential_mapping, "",
+					"distributed", "Set whether the 3d->1d potential mapping is computed without global gathering of 1d vertices.")
+				.add_method("set_distributed_synapse_mapping", &T::set_distributed_synapse_mapping, "",
+					"distributed", "Set whether the 1d->3d synapse mapping is computed without global gathering of synapse coordinates.")
+				.add_method("set_potential_edge_interpolation", &T::set_potential_edge_interpolation, "",
+					"edgeInterpolation", "Set whether 1d potential values are interpolated linearly along the nearest 1d edge.")
+				.add_method("set_num_repetitions", &T::set_num_repetitions, "", "number of repetitions",
+					"Set the number of executions per phase.")
+				.add_method("set_synapse_time", &T::set_synapse_time, "", "time",
+					"Set the time at which synaptic currents are gathered.")
+				.add_method("run", &T::run, "", "",
+					"Time potential and synapse mapping, potential exchange and current gathering separately.")
+				.add_method("print_report", &T::print_report, "", "",
+					"Print max/min/avg times over all processes per phase.")
+				.add_method("write_json", &T::write_json, "", "file name#label",
+					"Append the timings of the last run to a JSON lines file.")
+				.set_construct_as_smart_pointer(true);
+			reg.add_class_to_group(name, "HybridCouplingBenchmark", tag);
+		}
 	}
 
 	template <typename TDomain, typename TAlgebra>
@@ -1129,6 +2007,8 @@ struct Pure3DFunctionality
 				.add_method("set_scaling_factors", &T::set_scaling_factors, "", "", "")
 				.add_method("set_ip3_production_params", &T::set_ip3_production_params, "", "single synapse maximal production rate#decay rate", "")
 				.add_method("set_3d_neuron_ids", &T::set_3d_neuron_ids, "", "", "")
+				.add_method("set_distributed_synapse_mapping", &T::set_distributed_synapse_mapping, "", "distributed",
+					"Set whether the 1d->3d synapse mapping is computed without global gathering of synapse coordinates.")
 				.set_construct_as_smart_pointer(true);
 
 			reg.add_class_to_group(name, "HybridSynapseCurrentAssembler", tag);
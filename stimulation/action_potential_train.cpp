@@ -95,6 +95,12 @@ ActionPotentialTrain::ActionPotentialTrain()
 	m_stimEnd = 0.0;
 	m_AP_duration = 0.01;
 	m_basicVoltage = -65.0;
+
+	m_bTabulated = false;
+	m_tableStep = 0.0;
+	m_bCacheValid = false;
+	m_cacheTime = 0.0;
+	m_cacheVm = m_basicVoltage;
 }
 
 
@@ -106,8 +112,36 @@ ActionPotentialTrain::ActionPotentialTrain(	number stimBegin, number stimEnd,
 	m_AP_duration = 1./stimFreq;
 	m_basicVoltage = basicVoltage;
 
+	m_bTabulated = false;
+	m_tableStep = 0.0;
+	m_bCacheValid = false;
+	m_cacheTime = 0.0;
+	m_cacheVm = m_basicVoltage;
+
+	if(m_AP_duration < 0.01)
+			UG_THROW("ActionPotentialTrain: Value for AP_duration only allowed to be >= 0.01.");
+}
+
+
+ActionPotentialTrain::ActionPotentialTrain(	number stimBegin, number stimEnd,
+											number stimFreq, number basicVoltage,
+											number tableStep)
+{
+	m_stimBegin = stimBegin;
+	m_stimEnd = stimEnd;
+	m_AP_duration = 1./stimFreq;
+	m_basicVoltage = basicVoltage;
+
+	m_bTabulated = false;
+	m_tableStep = 0.0;
+	m_bCacheValid = false;
+	m_cacheTime = 0.0;
+	m_cacheVm = m_basicVoltage;
+
 	if(m_AP_duration < 0.01)
 			UG_THROW("ActionPotentialTrain: Value for AP_duration only allowed to be >= 0.01.");
+
+	set_tabulation(tableStep);
 }
 
 
@@ -119,17 +153,43 @@ ActionPotentialTrain::~ActionPotentialTrain()
 
 number ActionPotentialTrain::membrane_potential(number time)
 {
+	if (m_bCacheValid && time == m_cacheTime)
+		return m_cacheVm;
+
 	double vm;
 
 	if(time < m_stimBegin || time > m_stimEnd)
 		vm = m_basicVoltage;
+	else if (m_bTabulated)
+		vm = AP_voltage_trace_tabulated(time);
 	else
 		vm = AP_voltage_trace(time);
 
+	m_cacheTime = time;
+	m_cacheVm = vm;
+	m_bCacheValid = true;
+
 	return vm;
 }
 
 
+void ActionPotentialTrain::set_tabulation(number tableStep)
+{
+	m_bCacheValid = false;
+	m_vTable.clear();
+	m_bTabulated = tableStep > 0.0;
+	m_tableStep = m_bTabulated ? tableStep : 0.0;
+	if (!m_bTabulated)
+		return;
+
+	// the trace differs from the basic voltage only for local times in [0.001, 0.008]
+	const size_t nPts = (size_t) ceil(0.008 / m_tableStep) + 1;
+	m_vTable.resize(nPts);
+	for (size_t i = 0; i < nPts; ++i)
+		m_vTable[i] = AP_voltage_trace(i * m_tableStep);
+}
+
+
 number ActionPotentialTrain::global_to_local_AP_time(number time)
 {
 	int nCompletedAPs = time / m_AP_duration;
@@ -195,6 +255,19 @@ number ActionPotentialTrain::AP_voltage_trace(number time)
 }
 
 
+number ActionPotentialTrain::AP_voltage_trace_tabulated(number time)
+{
+	const number t = global_to_local_AP_time(time);
+	const number pos = t / m_tableStep;
+	const size_t i = (size_t) pos;
+	if (i + 1 >= m_vTable.size())
+		return m_basicVoltage;
+
+	const number w = pos - i;
+	return (1.0 - w) * m_vTable[i] + w * m_vTable[i+1];
+}
+
+
 } // neuro_collection
 } // namespace ug
 
@@ -88,6 +88,7 @@
 
 #include "common/common.h"
 #include <cmath>
+#include <vector>
 
 
 namespace ug{
@@ -118,12 +119,39 @@ class ActionPotentialTrain
 		ActionPotentialTrain(	number stimBegin, number stimEnd,
 								number stimFreq, number basicVoltage);
 
+		/**
+		 * @brief constructor with tabulated voltage trace
+		 *
+		 * @param stimBegin		stimulation begin time in s
+		 * @param stimEnd		stimulation end time in s
+		 * @param AP_duration	action potential duration in s
+		 * @param basicVoltage	resting potential in mV
+		 * @param tableStep		sampling step of the voltage trace table in s (see set_tabulation())
+		 */
+		ActionPotentialTrain(	number stimBegin, number stimEnd,
+								number stimFreq, number basicVoltage, number tableStep);
+
 		/// destructor
 		~ActionPotentialTrain();
 
 		///	Get current membrane potential inside specified frequency stimulation interval
+		/**
+		 * The value for the last time asked for is cached, so that querying the
+		 * (isopotential) stimulus for many locations at the same time is cheap.
+		 */
 		number membrane_potential(number time);
 
+		/// use a sampled table of the AP voltage trace
+		/**
+		 * The characteristic voltage trace of one AP is sampled with the given step
+		 * and linearly interpolated afterwards. As the trace is piecewise linear,
+		 * the interpolation error is bounded by the voltage rate of the steepest part
+		 * (160 mV/ms) times the step.
+		 *
+		 * @param tableStep  sampling step in s; a non-positive value disables tabulation
+		 */
+		void set_tabulation(number tableStep);
+
 	private:
 		///	Translate global time to local time inside one AP interval
 		number global_to_local_AP_time(number time);
@@ -131,10 +159,21 @@ class ActionPotentialTrain
 		///	characteristic action potential voltage trace
 		number AP_voltage_trace(number time);
 
+		/// characteristic action potential voltage trace (from table)
+		number AP_voltage_trace_tabulated(number time);
+
 		number m_stimBegin;
 		number m_stimEnd;
 		number m_AP_duration;
 		number m_basicVoltage;
+
+		bool m_bTabulated;
+		number m_tableStep;
+		std::vector<number> m_vTable;       ///< trace values at local AP times i*m_tableStep
+
+		bool m_bCacheValid;
+		number m_cacheTime;
+		number m_cacheVm;
 };
 
 ///@}
@@ -0,0 +1,675 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "grid_generation_benchmark.h"
+#include "grid_generation_stages.h"
+#include "neurite_runtime_error.h"
+#include "test_neurite_proj.h"
+#include "../util/mesh_cache.h"
+#include "common/error.h"
+#include "common/log.h"
+#include "common/math/ugmath.h"
+#include "common/stopwatch.h"
+#include "common/util/file_util.h"
+#include "common/util/string_util.h"
+#include "lib_grid/file_io/file_io.h"
+#include "lib_grid/grid/grid.h"
+#include "lib_grid/tools/subset_handler_grid.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <unistd.h>
+#endif
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_base.h"
+#endif
+
+namespace ug {
+	namespace neuro_collection {
+		namespace {
+			/// one parameter set of the benchmark suite
+			struct BenchmarkParams {
+				std::string label;
+				std::string strategy;
+				bool correct;
+				bool withER;
+				number erScaleFactor;
+				number anisotropy;
+				size_t numRefs;
+				number blowUpFactor;
+				number segLength;
+				std::string option;
+			};
+
+			/// results of one benchmark case
+			struct BenchmarkResult {
+				std::string swcFile;
+				std::string params;
+				int status;
+				number seconds;
+				number peakMemory;
+				std::vector<GridGenerationStageRecord> vStages;
+				bool bGrid;
+				size_t numVertices, numEdges, numFaces, numVolumes;
+				number ratioMin, ratioMean, ratioMax, minEdgeLength;
+				bool bCached; ///< grid taken from the mesh cache (batch only)
+				std::string message; ///< error message (batch only)
+				std::string directory; ///< case directory (batch only)
+
+				BenchmarkResult()
+				: status(NEURITE_RUNTIME_ERROR_CODE_OTHER), seconds(0.0), peakMemory(0.0),
+				  bGrid(false), numVertices(0), numEdges(0), numFaces(0), numVolumes(0),
+				  ratioMin(0.0), ratioMean(0.0), ratioMax(0.0), minEdgeLength(0.0),
+				  bCached(false) {}
+			};
+
+			////////////////////////////////////////////////////////////////////
+			/// status_name
+			////////////////////////////////////////////////////////////////////
+			const char* status_name(int status) {
+				static const char* names[] = {"success", "other", "regularization_incomplete",
+					"invalid_branches", "contains_cycles", "cylinder_cylinder_overlap",
+					"soma_connection_overlap", "tetrahedralize_failure", "bp_iteration_failure",
+					"no_permissible_render_vector_found"};
+				if (status >= 0 && status < (int) (sizeof(names) / sizeof(names[0]))) {
+					return names[status];
+				}
+				return "unknown";
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// json_string
+			////////////////////////////////////////////////////////////////////
+			std::string json_string(const std::string& s) {
+				std::ostringstream oss;
+				oss << '"';
+				for (size_t i = 0; i < s.size(); ++i) {
+					const char c = s[i];
+					if (c == '"' || c == '\\') { oss << '\\' << c; }
+					else if (c == '\n') { oss << "\\n"; }
+					else if (c == '\t') { oss << "\\t"; }
+					else if ((unsigned char) c < 0x20) {
+						oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c
+							<< std::dec << std::setfill(' ');
+					}
+					else { oss << c; }
+				}
+				oss << '"';
+				return oss.str();
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// read_suite
+			////////////////////////////////////////////////////////////////////
+			void read_suite
+			(
+				const std::string& suiteFile,
+				std::vector<std::string>& vSWCFiles,
+				std::vector<BenchmarkParams>& vParams
+			) {
+				std::ifstream in(suiteFile.c_str());
+				UG_COND_THROW(!in, "Benchmark suite file '" << suiteFile << "' could not be opened.");
+
+				std::string line;
+				size_t lineCnt = 0;
+				while (std::getline(in, line)) {
+					++lineCnt;
+					const size_t commentPos = line.find('#');
+					if (commentPos != std::string::npos) {
+						line = line.substr(0, commentPos);
+					}
+					std::istringstream iss(line);
+					std::string key;
+					if (!(iss >> key)) { continue; }
+
+					if (key == "swc") {
+						std::string fileName;
+						UG_COND_THROW(!(iss >> fileName), "Benchmark suite file '" << suiteFile
+							<< "': Line " << lineCnt << " does not name an SWC file.");
+						vSWCFiles.push_back(fileName);
+					} else if (key == "params") {
+						BenchmarkParams p;
+						UG_COND_THROW(!(iss >> p.label >> p.strategy >> p.correct >> p.withER
+							>> p.erScaleFactor >> p.anisotropy >> p.numRefs >> p.blowUpFactor
+							>> p.segLength >> p.option), "Benchmark suite file '" << suiteFile
+							<< "': Line " << lineCnt << " does not contain a complete parameter set.");
+						UG_COND_THROW(p.strategy != "general" && p.strategy != "branches",
+							"Benchmark suite file '" << suiteFile << "': Line " << lineCnt
+							<< " has unknown strategy '" << p.strategy << "'.");
+						vParams.push_back(p);
+					} else {
+						UG_THROW("Benchmark suite file '" << suiteFile << "': Line " << lineCnt
+							<< " starts with unknown keyword '" << key << "'.");
+					}
+				}
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// edge_ratio
+			////////////////////////////////////////////////////////////////////
+			template <typename TElem>
+			number edge_ratio
+			(
+				TElem* elem,
+				Grid::VertexAttachmentAccessor<APosition>& aaPos
+			) {
+				number minLen = std::numeric_limits<number>::max();
+				number maxLen = 0.0;
+				for (size_t i = 0; i < elem->num_edges(); ++i) {
+					EdgeDescriptor ed;
+					elem->edge_desc(i, ed);
+					const number len = VecDistance(aaPos[ed.vertex(0)], aaPos[ed.vertex(1)]);
+					minLen = std::min(minLen, len);
+					maxLen = std::max(maxLen, len);
+				}
+				return minLen > 0.0 ? maxLen / minLen : std::numeric_limits<number>::infinity();
+			}
+
+			template <typename TElem>
+			void edge_ratio_statistics
+			(
+				Grid& g,
+				Grid::VertexAttachmentAccessor<APosition>& aaPos,
+				BenchmarkResult& res
+			) {
+				res.ratioMin = std::numeric_limits<number>::max();
+				res.ratioMax = 0.0;
+				res.ratioMean = 0.0;
+				size_t n = 0;
+				typedef typename geometry_traits<TElem>::iterator iter_type;
+				for (iter_type it = g.template begin<TElem>(); it != g.template end<TElem>(); ++it) {
+					const number r = edge_ratio(*it, aaPos);
+					res.ratioMin = std::min(res.ratioMin, r);
+					res.ratioMax = std::max(res.ratioMax, r);
+					res.ratioMean += r;
+					++n;
+				}
+				if (n) { res.ratioMean /= n; }
+				else { res.ratioMin = 0.0; }
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// analyze_grid
+			////////////////////////////////////////////////////////////////////
+			void analyze_grid
+			(
+				const std::string& fileName,
+				BenchmarkResult& res
+			) {
+				Grid g;
+				SubsetHandler sh(g);
+				g.attach_to_vertices(aPosition);
+				if (!LoadGridFromFile(g, sh, fileName.c_str())) {
+					UG_LOGN("Benchmark: resulting grid '" << fileName << "' could not be loaded.");
+					return;
+				}
+				Grid::VertexAttachmentAccessor<APosition> aaPos(g, aPosition);
+
+				res.bGrid = true;
+				res.numVertices = g.num<Vertex>();
+				res.numEdges = g.num<Edge>();
+				res.numFaces = g.num<Face>();
+				res.numVolumes = g.num<Volume>();
+
+				res.minEdgeLength = res.numEdges ? std::numeric_limits<number>::max() : 0.0;
+				for (EdgeIterator it = g.begin<Edge>(); it != g.end<Edge>(); ++it) {
+					res.minEdgeLength = std::min(res.minEdgeLength,
+						VecDistance(aaPos[(*it)->vertex(0)], aaPos[(*it)->vertex(1)]));
+				}
+
+				if (res.numVolumes) { edge_ratio_statistics<Volume>(g, aaPos, res); }
+				else { edge_ratio_statistics<Face>(g, aaPos, res); }
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// write_cases
+			////////////////////////////////////////////////////////////////////
+			void write_cases
+			(
+				std::ostream& out,
+				const std::vector<BenchmarkResult>& vResults
+			) {
+				out << "  \"cases\": [";
+				for (size_t i = 0; i < vResults.size(); ++i) {
+					const BenchmarkResult& r = vResults[i];
+					out << (i ? "," : "") << "\n    {\n"
+						<< "      \"swc\": " << json_string(r.swcFile) << ",\n"
+						<< "      \"params\": " << json_string(r.params) << ",\n";
+					if (!r.directory.empty()) {
+						out << "      \"directory\": " << json_string(r.directory) << ",\n";
+					}
+					out << "      \"status\": " << r.status << ",\n";
+					if (!r.message.empty()) {
+						out << "      \"message\": " << json_string(r.message) << ",\n";
+					}
+					if (r.bCached) {
+						out << "      \"cached\": true,\n";
+					}
+					out << "      \"seconds\": " << r.seconds << ",\n"
+						<< "      \"peak_rss_mb\": " << r.peakMemory << ",\n"
+						<< "      \"stages\": [";
+					for (size_t j = 0; j < r.vStages.size(); ++j) {
+						const GridGenerationStageRecord& s = r.vStages[j];
+						out << (j ? "," : "") << "\n        {\"name\": " << json_string(s.name)
+							<< ", \"seconds\": " << s.seconds << ", \"rss_mb\": " << s.memory
+							<< ", \"rss_delta_mb\": " << s.memoryDelta << "}";
+					}
+					out << (r.vStages.empty() ? "]" : "\n      ]");
+					if (r.bGrid) {
+						out << ",\n      \"elements\": {\"vertices\": " << r.numVertices
+							<< ", \"edges\": " << r.numEdges << ", \"faces\": " << r.numFaces
+							<< ", \"volumes\": " << r.numVolumes << "},\n"
+							<< "      \"quality\": {\"edge_ratio_min\": " << r.ratioMin
+							<< ", \"edge_ratio_mean\": " << r.ratioMean
+							<< ", \"edge_ratio_max\": " << r.ratioMax
+							<< ", \"min_edge_length\": " << r.minEdgeLength << "}";
+					}
+					out << "\n    }";
+				}
+				out << (vResults.empty() ? "]\n" : "\n  ]\n");
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// write_json
+			////////////////////////////////////////////////////////////////////
+			void write_json
+			(
+				const std::string& jsonFile,
+				const std::string& suiteFile,
+				const std::vector<BenchmarkResult>& vResults
+			) {
+				std::ofstream out(jsonFile.c_str());
+				UG_COND_THROW(!out, "Benchmark output file '" << jsonFile << "' could not be opened.");
+				out << std::setprecision(8);
+
+				out << "{\n  \"suite\": " << json_string(suiteFile) << ",\n";
+				write_cases(out, vResults);
+				out << "}\n";
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// write_report
+			////////////////////////////////////////////////////////////////////
+			size_t write_report
+			(
+				const std::string& reportFile,
+				const std::string& suiteFile,
+				const std::vector<BenchmarkResult>& vResults
+			) {
+				size_t numFailed = 0, numCached = 0;
+				std::map<int, size_t> statusCount;
+				for (size_t i = 0; i < vResults.size(); ++i) {
+					++statusCount[vResults[i].status];
+					if (vResults[i].status != NEURITE_RUNTIME_ERROR_CODE_SUCCESS) { ++numFailed; }
+					if (vResults[i].bCached) { ++numCached; }
+				}
+
+				std::ofstream out(reportFile.c_str());
+				UG_COND_THROW(!out, "Batch report file '" << reportFile << "' could not be opened.");
+				out << std::setprecision(8);
+
+				out << "{\n  \"suite\": " << json_string(suiteFile) << ",\n"
+					<< "  \"summary\": {\"cases\": " << vResults.size()
+					<< ", \"succeeded\": " << vResults.size() - numFailed
+					<< ", \"failed\": " << numFailed << ", \"cached\": " << numCached
+					<< ", \"status\": {";
+				for (std::map<int, size_t>::const_iterator it = statusCount.begin(); it != statusCount.end(); ++it) {
+					out << (it == statusCount.begin() ? "" : ", ") << json_string(status_name(it->first))
+						<< ": " << it->second;
+				}
+				out << "}},\n";
+				write_cases(out, vResults);
+				out << "}\n";
+
+				return numFailed;
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// run_case
+			////////////////////////////////////////////////////////////////////
+			void run_case
+			(
+				const std::string& swcFile,
+				const BenchmarkParams& p,
+				bool useCache,
+				BenchmarkResult& res
+			) {
+				const std::string outFileName = p.strategy == "general"
+					? "testNeuriteProjector_after_adding_neurites_and_connecting_all.ugx"
+					: "imported_y_structure.ugx";
+				const std::vector<std::string> vOutFileNames(1, outFileName);
+
+				MeshCacheKey cacheKey("RunBatchGridGeneration", "1");
+				if (useCache) {
+					cacheKey.add_file_content(swcFile);
+					cacheKey.add(p.strategy);
+					cacheKey.add(p.correct);
+					cacheKey.add(p.withER);
+					cacheKey.add(p.erScaleFactor);
+					cacheKey.add(p.anisotropy);
+					cacheKey.add(p.numRefs);
+					cacheKey.add(p.blowUpFactor);
+					cacheKey.add(p.segLength);
+					cacheKey.add(p.option);
+					if (mesh_cache_restore(cacheKey, vOutFileNames)) {
+						res.status = NEURITE_RUNTIME_ERROR_CODE_SUCCESS;
+						res.bCached = true;
+						res.peakMemory = PeakResidentMemoryMB();
+						analyze_grid(outFileName, res);
+						return;
+					}
+				}
+
+				Stopwatch sw;
+				sw.start();
+				if (p.strategy == "general") {
+					res.status = test_import_swc_general_var_benchmark(swcFile, p.correct,
+						p.erScaleFactor, p.withER, p.anisotropy, p.numRefs, false,
+						p.blowUpFactor, false, false, p.option, p.segLength);
+				} else {
+					res.status = test_import_swc_general_var_benchmark_var(swcFile,
+						p.erScaleFactor, p.numRefs);
+				}
+				sw.stop();
+				res.seconds = sw.ms() / 1000.0;
+				res.peakMemory = PeakResidentMemoryMB();
+				if (p.strategy == "general") {
+					res.vStages = LastGridGenerationStageRecords();
+				}
+
+				if (res.status == NEURITE_RUNTIME_ERROR_CODE_SUCCESS) {
+					analyze_grid(outFileName, res);
+					if (useCache) {
+						mesh_cache_store(cacheKey, vOutFileNames);
+					}
+				}
+			}
+
+		#if defined(__unix__) || defined(__APPLE__)
+			/// one case of a batch
+			struct BatchCase {
+				std::string swcFile; ///< as given in the suite
+				std::string swcPath; ///< absolute path (empty if not found)
+				const BenchmarkParams* params;
+				std::string directory;
+			};
+
+			////////////////////////////////////////////////////////////////////
+			/// absolute_path
+			////////////////////////////////////////////////////////////////////
+			std::string absolute_path(const std::string& path) {
+				if (path.empty() || path[0] == '/') { return path; }
+				char buf[4096];
+				UG_COND_THROW(!getcwd(buf, sizeof(buf)), "Current working directory could not be determined.");
+				return std::string(buf) + "/" + path;
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// write_result_file / read_result_file
+			////////////////////////////////////////////////////////////////////
+			const char* resultFileName = "result.txt";
+
+			void write_result_file
+			(
+				const std::string& fileName,
+				const BenchmarkResult& r
+			) {
+				std::ofstream out(fileName.c_str());
+				UG_COND_THROW(!out, "Batch result file '" << fileName << "' could not be opened.");
+				out << std::setprecision(17);
+				out << r.status << " " << r.seconds << " " << r.peakMemory << " " << r.bCached
+					<< " " << r.bGrid << " " << r.numVertices << " " << r.numEdges << " "
+					<< r.numFaces << " " << r.numVolumes << " " << r.ratioMin << " " << r.ratioMean
+					<< " " << r.ratioMax << " " << r.minEdgeLength << "\n";
+				for (size_t i = 0; i < r.vStages.size(); ++i) {
+					const GridGenerationStageRecord& s = r.vStages[i];
+					out << "stage " << s.seconds << " " << s.memory << " " << s.memoryDelta
+						<< " " << s.name << "\n";
+				}
+				if (!r.message.empty()) {
+					std::string msg = r.message;
+					std::replace(msg.begin(), msg.end(), '\n', ' ');
+					out << "message " << msg << "\n";
+				}
+			}
+
+			bool read_result_file
+			(
+				const std::string& fileName,
+				BenchmarkResult& r
+			) {
+				std::ifstream in(fileName.c_str());
+				if (!in) { return false; }
+				if (!(in >> r.status >> r.seconds >> r.peakMemory >> r.bCached >> r.bGrid
+					>> r.numVertices >> r.numEdges >> r.numFaces >> r.numVolumes >> r.ratioMin
+					>> r.ratioMean >> r.ratioMax >> r.minEdgeLength)) {
+					return false;
+				}
+				std::string key;
+				while (in >> key) {
+					if (key == "stage") {
+						GridGenerationStageRecord s;
+						in >> s.seconds >> s.memory >> s.memoryDelta >> std::ws;
+						std::getline(in, s.name);
+						r.vStages.push_back(s);
+					} else if (key == "message") {
+						in >> std::ws;
+						std::getline(in, r.message);
+					}
+				}
+				return true;
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// run_batch_case
+			////////////////////////////////////////////////////////////////////
+			void run_batch_case(const BatchCase& c) {
+				BenchmarkResult res;
+				if (c.swcPath.empty()) {
+					res.message = "SWC file '" + c.swcFile + "' could not be located.";
+				} else {
+					try {
+						run_case(c.swcPath, *c.params, !mesh_cache_directory().empty(), res);
+					} catch (const UGError& err) {
+						res.status = NEURITE_RUNTIME_ERROR_CODE_OTHER;
+						res.message = err.get_msg();
+					} catch (const std::exception& err) {
+						res.status = NEURITE_RUNTIME_ERROR_CODE_OTHER;
+						res.message = err.what();
+					}
+				}
+				write_result_file(resultFileName, res);
+
+				if (res.status == NEURITE_RUNTIME_ERROR_CODE_SUCCESS) {
+					UG_LOGN("Batch: '" << c.swcFile << "' with parameter set '" << c.params->label
+						<< "' finished.");
+				} else {
+					UG_LOGN("Batch: '" << c.swcFile << "' with parameter set '" << c.params->label
+						<< "' failed with status " << status_name(res.status) << ": " << res.message);
+				}
+			}
+		#endif
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// RunGridGenerationBenchmark
+		////////////////////////////////////////////////////////////////////////
+		int RunGridGenerationBenchmark
+		(
+			const std::string& suiteFile,
+			const std::string& jsonFile
+		) {
+			std::vector<std::string> vSWCFiles;
+			std::vector<BenchmarkParams> vParams;
+			read_suite(suiteFile, vSWCFiles, vParams);
+
+			int numFailed = 0;
+			std::vector<BenchmarkResult> vResults;
+			for (size_t i = 0; i < vSWCFiles.size(); ++i) {
+				for (size_t j = 0; j < vParams.size(); ++j) {
+					const BenchmarkParams& p = vParams[j];
+					UG_LOGN("Benchmark: '" << vSWCFiles[i] << "' with parameter set '" << p.label << "'");
+
+					BenchmarkResult res;
+					res.swcFile = vSWCFiles[i];
+					res.params = p.label;
+					run_case(vSWCFiles[i], p, false, res);
+					if (res.status != NEURITE_RUNTIME_ERROR_CODE_SUCCESS) {
+						++numFailed;
+					}
+
+					vResults.push_back(res);
+					write_json(jsonFile, suiteFile, vResults);
+				}
+			}
+
+			UG_LOGN("Benchmark: " << vResults.size() << " cases, " << numFailed << " failed.");
+			return numFailed;
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// RunBatchGridGeneration
+		////////////////////////////////////////////////////////////////////////
+		int RunBatchGridGeneration
+		(
+			const std::string& suiteFile,
+			const std::string& outDir,
+			const std::string& reportFile
+		) {
+		#if defined(__unix__) || defined(__APPLE__)
+			std::vector<std::string> vSWCFiles;
+			std::vector<BenchmarkParams> vParams;
+			read_suite(suiteFile, vSWCFiles, vParams);
+
+			int rank = 0, numProcs = 1;
+		#ifdef UG_PARALLEL
+			rank = pcl::ProcRank();
+			numProcs = pcl::NumProcs();
+		#endif
+
+			// case directories are entered for each case, so all paths must be absolute
+			const std::string baseDir = absolute_path(outDir);
+			if (!DirectoryExists(baseDir.c_str())) { CreateDirectory(baseDir); }
+			UG_COND_THROW(!DirectoryExists(baseDir.c_str()), "Batch output directory '"
+				<< baseDir << "' could not be created.");
+
+			if (mesh_cache_directory().empty()) {
+				const std::string cacheDir = baseDir + "/mesh_cache";
+				if (!DirectoryExists(cacheDir.c_str())) { CreateDirectory(cacheDir); }
+				set_mesh_cache_directory(cacheDir);
+			} else {
+				set_mesh_cache_directory(absolute_path(mesh_cache_directory()));
+			}
+
+			std::vector<BatchCase> vCases;
+			for (size_t i = 0; i < vSWCFiles.size(); ++i) {
+				const std::string swcPath = absolute_path(FindFileInStandardPaths(vSWCFiles[i].c_str()));
+				for (size_t j = 0; j < vParams.size(); ++j) {
+					std::ostringstream oss;
+					oss << baseDir << "/" << std::setw(4) << std::setfill('0') << vCases.size() << "_"
+						<< FilenameWithoutPath(FilenameWithoutExtension(vSWCFiles[i])) << "__" << vParams[j].label;
+
+					BatchCase c;
+					c.swcFile = vSWCFiles[i];
+					c.swcPath = swcPath;
+					c.params = &vParams[j];
+					c.directory = oss.str();
+					vCases.push_back(c);
+				}
+			}
+
+			// run own cases (round-robin over the processes)
+			char cwd[4096];
+			UG_COND_THROW(!getcwd(cwd, sizeof(cwd)), "Current working directory could not be determined.");
+			for (size_t k = rank; k < vCases.size(); k += numProcs) {
+				const BatchCase& c = vCases[k];
+				if (!DirectoryExists(c.directory.c_str())) { CreateDirectory(c.directory); }
+				UG_COND_THROW(!DirectoryExists(c.directory.c_str()), "Batch case directory '"
+					<< c.directory << "' could not be created.");
+				UG_LOGN("Batch: '" << c.swcFile << "' with parameter set '" << c.params->label << "'");
+
+				UG_COND_THROW(chdir(c.directory.c_str()), "Could not change to directory '" << c.directory << "'.");
+				run_batch_case(c);
+				UG_COND_THROW(chdir(cwd), "Could not change back to directory '" << cwd << "'.");
+			}
+
+		#ifdef UG_PARALLEL
+			if (numProcs > 1) { pcl::SynchronizeProcesses(); }
+		#endif
+
+			// collect results of all processes
+			std::vector<BenchmarkResult> vResults(vCases.size());
+			for (size_t k = 0; k < vCases.size(); ++k) {
+				BenchmarkResult& res = vResults[k];
+				if (!read_result_file(vCases[k].directory + "/" + resultFileName, res)) {
+					res = BenchmarkResult();
+					res.message = "No result was written.";
+				}
+				res.swcFile = vCases[k].swcFile;
+				res.params = vCases[k].params->label;
+				res.directory = vCases[k].directory;
+			}
+
+			int numFailed = 0;
+			if (rank == 0) {
+				numFailed = (int) write_report(reportFile, suiteFile, vResults);
+				UG_LOGN("Batch: " << vResults.size() << " cases, " << numFailed << " failed.");
+			} else {
+				for (size_t k = 0; k < vResults.size(); ++k) {
+					if (vResults[k].status != NEURITE_RUNTIME_ERROR_CODE_SUCCESS) { ++numFailed; }
+				}
+			}
+			return numFailed;
+		#else
+			UG_THROW("RunBatchGridGeneration changes into the case directories, which is only supported on POSIX systems.");
+		#endif
+		}
+	}
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__TEST__GRID_GENERATION_BENCHMARK_H
+#define UG__PLUGINS__NEURO_COLLECTION__TEST__GRID_GENERATION_BENCHMARK_H
+
+#include <cstddef>
+#include <string>
+
+namespace ug {
+	namespace neuro_collection {
+		/*!
+		 * \brief runs a grid generation benchmark suite and writes the results as JSON
+		 * The suite file contains (besides '#' comments and empty lines) lines
+		 *
+		 *   swc <file name>
+		 *   params <label> <strategy> <correct> <withER> <erScaleFactor>
+		 *          <anisotropy> <numRefs> <blowUpFactor> <segLength> <option>
+		 *
+		 * (each params entry on a single line). Every SWC file is run with every
+		 * parameter set. The strategy is either "general" (as in
+		 * test_import_swc_general_var_benchmark) or "branches" (as in
+		 * test_import_swc_general_var_benchmark_var, which only uses
+		 * erScaleFactor and numRefs); boolean values are given as 0 or 1.
+		 *
+		 * For each case, the status code (see neurite_runtime_error.h), the total
+		 * wall-clock time, the timings and memory of the grid generation stages,
+		 * the peak resident memory of the process, the number of elements of
+		 * the resulting grid and edge length ratio statistics of its volumes
+		 * (of its faces if there are no volumes) are recorded.
+		 * The JSON file is rewritten after every case, so that results of
+		 * completed cases are kept if a later case crashes.
+		 *
+		 * \param[in] suiteFile  benchmark suite description
+		 * \param[in] jsonFile   output file
+		 * \return number of cases that did not finish successfully
+		 */
+		int RunGridGenerationBenchmark
+		(
+			const std::string& suiteFile,
+			const std::string& jsonFile
+		);
+
+		/*!
+		 * \brief generates grids for all cases of a suite in a batch
+		 * The suite file has the same format as for RunGridGenerationBenchmark.
+		 * The cases (every SWC file with every parameter set) are distributed
+		 * round-robin over the MPI processes; each process runs its cases one
+		 * after another in the calling process. No worker processes are forked,
+		 * as forking is not safe with MPI and OpenMP; concurrency is only
+		 * obtained from the MPI processes.
+		 *
+		 * Every case is run in its own directory outDir/<swc name>__<label>,
+		 * which takes the resulting grid and its result (result.txt). With more
+		 * than one MPI process, outDir must be on a shared file system.
+		 * Failures are isolated per case: neurite runtime errors
+		 * (e.g. TetrahedralizeFailure) and ug errors are caught, logged and
+		 * recorded with their status code. A crash of the process (e.g. by a
+		 * signal) is not isolated, though; it aborts the remaining cases of
+		 * this process. Rerunning the batch skips the cases already finished
+		 * by means of the mesh cache.
+		 *
+		 * Grids are taken from the mesh cache if the same SWC file content has
+		 * already been processed with the same parameters. If no cache directory
+		 * is set, outDir/mesh_cache is used.
+		 *
+		 * After all cases, the first process writes a JSON report with the
+		 * results of all cases (as in RunGridGenerationBenchmark, plus the
+		 * case directory, cache hits and error messages) and a summary of the
+		 * number of cases per status.
+		 *
+		 * \param[in] suiteFile   suite description
+		 * \param[in] outDir      output directory (created if not existent)
+		 * \param[in] reportFile  JSON report file
+		 * \return number of cases that did not finish successfully
+		 */
+		int RunBatchGridGeneration
+		(
+			const std::string& suiteFile,
+			const std::string& outDir,
+			const std::string& reportFile
+		);
+	}
+}
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__TEST__GRID_GENERATION_BENCHMARK_H
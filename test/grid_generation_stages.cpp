@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "grid_generation_stages.h"
+#include "common/log.h"
+#include "common/util/string_util.h"
+#include "lib_grid/algorithms/subset_color_util.h"
+#include "lib_grid/algorithms/subset_util.h"
+#include "lib_grid/file_io/file_io.h"
+
+#include <cstdio>
+#include <set>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <sys/resource.h>
+	#include <unistd.h>
+#endif
+
+namespace ug {
+	namespace neuro_collection {
+		namespace {
+			/// active stage and stages with dumps enabled
+			std::string g_curStage;
+			std::set<std::string> g_dumpStages;
+			bool g_dumpAll = false;
+
+			/// records of the most recent pipeline
+			std::vector<GridGenerationStageRecord> g_vStageRecords;
+
+			////////////////////////////////////////////////////////////////////
+			/// resident_memory_mb
+			////////////////////////////////////////////////////////////////////
+			number resident_memory_mb() {
+			#if defined(__linux__)
+				// current resident set size
+				FILE* f = fopen("/proc/self/statm", "r");
+				if (f) {
+					long pages = 0, resident = 0;
+					const int nRead = fscanf(f, "%ld %ld", &pages, &resident);
+					fclose(f);
+					if (nRead == 2) {
+						return (number) resident * (number) sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+					}
+				}
+			#endif
+				return PeakResidentMemoryMB();
+			}
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// PeakResidentMemoryMB
+		////////////////////////////////////////////////////////////////////////
+		number PeakResidentMemoryMB() {
+		#if defined(__unix__) || defined(__APPLE__)
+			// peak resident set size (kB on Linux, bytes on macOS)
+			struct rusage usage;
+			if (getrusage(RUSAGE_SELF, &usage) == 0) {
+			#ifdef __APPLE__
+				return (number) usage.ru_maxrss / (1024.0 * 1024.0);
+			#else
+				return (number) usage.ru_maxrss / 1024.0;
+			#endif
+			}
+		#endif
+			return 0.0;
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// LastGridGenerationStageRecords
+		////////////////////////////////////////////////////////////////////////
+		const std::vector<GridGenerationStageRecord>& LastGridGenerationStageRecords() {
+			return g_vStageRecords;
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// GridGenerationStages
+		////////////////////////////////////////////////////////////////////////
+		GridGenerationStages::GridGenerationStages()
+		: m_memStart(0.0), m_totalTime(0.0)
+		{
+			g_vStageRecords.clear();
+		}
+
+		GridGenerationStages::~GridGenerationStages() {
+			end();
+			if (m_totalTime > 0.0) {
+				UG_LOGN("Grid generation stages took " << m_totalTime << " s in total.");
+			}
+		}
+
+		void GridGenerationStages::begin(const std::string& name) {
+			end();
+			m_name = name;
+			g_curStage = name;
+			m_memStart = resident_memory_mb();
+			m_stopwatch.start();
+		}
+
+		void GridGenerationStages::end() {
+			if (m_name.empty()) {
+				return;
+			}
+			m_stopwatch.stop();
+			const number sec = m_stopwatch.ms() / 1000.0;
+			const number mem = resident_memory_mb();
+			m_totalTime += sec;
+
+			GridGenerationStageRecord rec;
+			rec.name = m_name;
+			rec.seconds = sec;
+			rec.memory = mem;
+			rec.memoryDelta = mem - m_memStart;
+			g_vStageRecords.push_back(rec);
+
+			UG_LOGN("Stage '" << m_name << "': " << sec << " s, resident memory "
+				<< mem << " MB (" << (mem >= m_memStart ? "+" : "") << mem - m_memStart << " MB)");
+			m_name.clear();
+			g_curStage.clear();
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// SetGridGenerationDumpStages
+		////////////////////////////////////////////////////////////////////////
+		void SetGridGenerationDumpStages
+		(
+			const std::string& stages
+		) {
+			g_dumpStages.clear();
+			g_dumpAll = false;
+
+			std::vector<std::string> vTokens;
+			TokenizeString(stages, vTokens, ',');
+			for (size_t i = 0; i < vTokens.size(); ++i) {
+				const std::string stage = TrimString(vTokens[i]);
+				if (stage == "all") {
+					g_dumpAll = true;
+				} else if (!stage.empty()) {
+					g_dumpStages.insert(stage);
+				}
+			}
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// GridGenerationDumpEnabled
+		////////////////////////////////////////////////////////////////////////
+		bool GridGenerationDumpEnabled() {
+			if (g_dumpAll) {
+				return true;
+			}
+			return g_dumpStages.find(g_curStage) != g_dumpStages.end();
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// DumpStageGrid
+		////////////////////////////////////////////////////////////////////////
+		void DumpStageGrid
+		(
+			Grid& grid,
+			ISubsetHandler& sh,
+			const char* const fileName,
+			bool prepare
+		) {
+			if (prepare) {
+				EraseEmptySubsets(sh);
+				AssignSubsetColors(sh);
+			}
+			if (GridGenerationDumpEnabled()) {
+				SaveGridToFile(grid, sh, fileName);
+			}
+		}
+
+		void DumpStageGrid
+		(
+			Grid& grid,
+			const char* const fileName
+		) {
+			if (GridGenerationDumpEnabled()) {
+				SaveGridToFile(grid, fileName);
+			}
+		}
+	}
+}
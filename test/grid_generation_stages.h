@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__TEST__GRID_GENERATION_STAGES_H
+#define UG__PLUGINS__NEURO_COLLECTION__TEST__GRID_GENERATION_STAGES_H
+
+#include <string>
+#include <vector>
+#include "common/types.h"
+#include "common/stopwatch.h"
+#include "lib_grid/grid/grid.h"
+#include "lib_grid/tools/subset_handler_interface.h"
+
+namespace ug {
+	namespace neuro_collection {
+		/*!
+		 * \brief timing and memory of one finished grid generation stage
+		 */
+		struct GridGenerationStageRecord {
+			std::string name; ///< stage name
+			number seconds; ///< wall-clock time
+			number memory; ///< resident memory at the end of the stage (MB)
+			number memoryDelta; ///< change of resident memory during the stage (MB)
+		};
+
+		/*!
+		 * \brief Stage pipeline of the 3d grid generation from SWC files
+		 * Starting a stage ends the previous one, the last stage is ended on
+		 * destruction. For each stage, the wall-clock time and the resident
+		 * memory (at the end and relative to the start of the stage) is logged.
+		 * While a stage is active, DumpStageGrid() writes intermediate grids
+		 * only if dumps have been enabled for this stage (see
+		 * SetGridGenerationDumpStages), so no debug I/O is done by default.
+		 * The records of the finished stages of the most recent pipeline are
+		 * available from LastGridGenerationStageRecords().
+		 */
+		class GridGenerationStages
+		{
+			public:
+				GridGenerationStages();
+				~GridGenerationStages();
+
+				/*!
+				 * \brief ends the current stage (if any) and starts a new one
+				 * \param[in] name  name of the stage
+				 */
+				void begin(const std::string& name);
+
+				/*!
+				 * \brief ends the current stage (if any)
+				 */
+				void end();
+
+			private:
+				// non-copyable
+				GridGenerationStages(const GridGenerationStages&);
+				GridGenerationStages& operator=(const GridGenerationStages&);
+
+			private:
+				std::string m_name;
+				Stopwatch m_stopwatch;
+				number m_memStart;
+				number m_totalTime;
+		};
+
+		/*!
+		 * \brief stage records of the most recently started pipeline
+		 */
+		const std::vector<GridGenerationStageRecord>& LastGridGenerationStageRecords();
+
+		/*!
+		 * \brief peak resident memory of the process so far (MB, 0 if unknown)
+		 */
+		number PeakResidentMemoryMB();
+
+		/*!
+		 * \brief enables intermediate grid dumps for a set of stages
+		 * \param[in] stages  comma-separated list of stage names, "all" for
+		 *                    every stage or an empty string for none (default)
+		 */
+		void SetGridGenerationDumpStages
+		(
+			const std::string& stages
+		);
+
+		/*!
+		 * \brief whether intermediate grids of the current stage are dumped
+		 */
+		bool GridGenerationDumpEnabled();
+
+		/*!
+		 * \brief writes an intermediate grid if dumps are enabled for the current stage
+		 * If prepare is set, empty subsets are erased and subset colors are
+		 * assigned (like in SavePreparedGridToFile) regardless of whether the
+		 * grid is written, so that subset indices do not depend on dump settings.
+		 * \param[in, out] grid
+		 * \param[in, out] sh
+		 * \param[in] fileName
+		 * \param[in] prepare
+		 */
+		void DumpStageGrid
+		(
+			Grid& grid,
+			ISubsetHandler& sh,
+			const char* const fileName,
+			bool prepare = false
+		);
+
+		/*!
+		 * \brief writes an intermediate grid (without subsets) if dumps are enabled for the current stage
+		 * \param[in] grid
+		 * \param[in] fileName
+		 */
+		void DumpStageGrid
+		(
+			Grid& grid,
+			const char* const fileName
+		);
+	}
+}
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__TEST__GRID_GENERATION_STAGES_H
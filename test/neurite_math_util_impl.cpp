@@ -56,6 +56,7 @@
 #include <boost/generator_iterator.hpp>
 #include <ctime>
 #include "neurite_runtime_error.h"
+#include "../util/aabb_hash.h"
 #include <boost/geometry.hpp>
 #include <boost/geometry/algorithms/length.hpp>
 
@@ -651,8 +652,6 @@ namespace ug {
 			const vector<SWCPoint>& vPoints
 		)
 		{
-			typedef vector<vector<int> > combination_t;
-			typedef vector<vector<int> >::const_iterator combination_iter;
 			std::vector<Cylinder> cylinders;
 			size_t nPts = vPoints.size();
 			for (size_t i = 0; i < nPts; i++) {
@@ -665,14 +664,21 @@ namespace ug {
 					cylinders.push_back(Cylinder(vPoints[i].coords, dir, vPoints[i].radius, len));
 					}
 				}
-			// create all pairwise cylinders, then test for intersection
-			combination_t combinations = makeCombi(cylinders.size(), 2);
-			combination_iter it = combinations.begin();
-			while (it != combinations.end()) {
-				if (!CylinderCylinderSeparationTest(cylinders[(*it)[0]], cylinders[(*it)[1]])) {
+			// bound each cylinder by a ball of radius height plus radius
+			// (conservative) and only test pairs with overlapping bounds
+			AABBHash<3> hash;
+			for (size_t i = 0; i < cylinders.size(); i++) {
+				hash.add_ball(cylinders[i].c, cylinders[i].h + cylinders[i].r);
+			}
+			hash.build();
+
+			std::vector<std::pair<size_t, size_t> > vCandidates;
+			hash.overlapping_pairs(vCandidates);
+			for (size_t k = 0; k < vCandidates.size(); k++) {
+				if (!CylinderCylinderSeparationTest(cylinders[vCandidates[k].first],
+					cylinders[vCandidates[k].second])) {
 					return false;
 				}
-				++it;
 			}
 			return true;
 		}
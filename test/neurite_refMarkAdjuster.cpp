@@ -73,16 +73,14 @@ void NeuriteRefMarkAdjuster::change_edge_mark(IRefiner& ref, Edge* e, const vect
     vector3 neuriteDir;
     if (!dir)
     {
-        try {m_spNP->direction_at_grid_object(neuriteDir, e);}
-        catch (UGError& err)
+        // no direction could be calculated since edge axial param is out of bounds,
+        // i.e. <0 (soma) or >1 (tip)
+        // we do not refine here
+        if (!neurite_direction(neuriteDir, e))
         {
-            // no direction could be calculated since edge axial param is out of bounds,
-            // i.e. <0 (soma) or >1 (tip)
-            // we do not refine here
             ref.mark(e, RM_COPY);
             return;
         }
-        VecNormalize(neuriteDir, neuriteDir);
     }
     else neuriteDir = *dir;
 
@@ -109,12 +107,11 @@ void NeuriteRefMarkAdjuster::change_face_mark(IRefiner& ref, Grid& grid, Face* f
     vector3 neuriteDir;
     if (!dir)
     {
-        try {m_spNP->direction_at_grid_object(neuriteDir, f);}
-        catch (UGError& err)
+        // no direction could be calculated since face axial param is out of bounds,
+        // i.e. <0 (soma) or >1 (tip)
+        // we do not refine here
+        if (!neurite_direction(neuriteDir, f))
         {
-            // no direction could be calculated since edge axial param is out of bounds,
-            // i.e. <0 (soma) or >1 (tip)
-            // we do not refine here
             ref.mark(f, RM_COPY);
 
             for (size_t k = 0; k < el_sz; ++k)
@@ -122,7 +119,6 @@ void NeuriteRefMarkAdjuster::change_face_mark(IRefiner& ref, Grid& grid, Face* f
 
             return;
         }
-        VecNormalize(neuriteDir, neuriteDir);
     }
     else neuriteDir = *dir;
 
@@ -143,13 +139,11 @@ void NeuriteRefMarkAdjuster::change_vol_mark(IRefiner& ref, Grid& grid, Volume*
     size_t fl_sz = fl.size();
 
     // get neurite direction
+    // (no direction can be calculated if the volume axial param is out of bounds,
+    // i.e. <0 (soma) or >1 (tip); we do not refine there)
     vector3 neuriteDir;
-    try {m_spNP->direction_at_grid_object(neuriteDir, v);}
-    catch (UGError& err)
+    if (!neurite_direction(neuriteDir, v))
     {
-        // no direction could be calculated since volume axial param is out of bounds,
-        // i.e. <0 (soma) or >1 (tip)
-        // we do not refine here
         ref.mark(v, RM_COPY);
         for (size_t k = 0; k < fl_sz; ++k)
             mark_face_copy(ref, grid, fl[k]);
@@ -165,6 +159,98 @@ void NeuriteRefMarkAdjuster::change_vol_mark(IRefiner& ref, Grid& grid, Volume*
 }
 
 
+bool NeuriteRefMarkAdjuster::neurite_direction(vector3& dirOut, GridObject* o) const
+{
+    std::map<GridObject*, DirEntry>::const_iterator it = m_mDirCache.find(o);
+    if (it != m_mDirCache.end())
+    {
+        dirOut = it->second.dir;
+        return it->second.valid;
+    }
+
+    DirEntry& entry = m_mDirCache[o];
+    try
+    {
+        m_spNP->direction_at_grid_object(entry.dir, o);
+        VecNormalize(entry.dir, entry.dir);
+        entry.valid = true;
+    }
+    catch (UGError& err)
+    {
+        entry.valid = false;
+    }
+
+    dirOut = entry.dir;
+    return entry.valid;
+}
+
+
+bool NeuriteRefMarkAdjuster::is_anisotropic(Quadrilateral* q) const
+{
+    std::map<GridObject*, bool>::const_iterator it = m_mAnisoCache.find(q);
+    if (it != m_mAnisoCache.end())
+        return it->second;
+
+    // calculate anisotropy of face
+    vector3 sidevec;
+    VecSubtract(sidevec, m_aaPos[q->vertex(1)], m_aaPos[q->vertex(0)]);
+    number a = VecLength(sidevec);
+    VecSubtract(sidevec, m_aaPos[q->vertex(2)], m_aaPos[q->vertex(1)]);
+    number aniso = a / VecLength(sidevec);
+    if (aniso < 1.0) aniso = 1.0 / aniso;
+
+    return m_mAnisoCache[q] = aniso >= 1.4142;
+}
+
+
+bool NeuriteRefMarkAdjuster::is_anisotropic(Hexahedron* h) const
+{
+    std::map<GridObject*, bool>::const_iterator it = m_mAnisoCache.find(h);
+    if (it != m_mAnisoCache.end())
+        return it->second;
+
+    // calculate anisotropy of volume
+    vector3 sidevec;
+    VecSubtract(sidevec, m_aaPos[h->vertex(1)], m_aaPos[h->vertex(0)]);
+    number a = VecLength(sidevec);
+    VecSubtract(sidevec, m_aaPos[h->vertex(2)], m_aaPos[h->vertex(1)]);
+    number b = VecLength(sidevec);
+    VecSubtract(sidevec, m_aaPos[h->vertex(4)], m_aaPos[h->vertex(0)]);
+    number c = VecLength(sidevec);
+    number aniso = std::max(a, std::max(b,c)) / std::min(a, std::min(b,c));
+
+    return m_mAnisoCache[h] = aniso >= 1.4142;
+}
+
+
+void NeuriteRefMarkAdjuster::register_grid_callbacks(Grid& grid)
+{
+    if (m_pGrid == &grid)
+        return;
+
+    clear_cache();
+    m_pGrid = &grid;
+    m_spGridAdaptionCallbackID = grid.message_hub()->register_class_callback(this,
+        &NeuriteRefMarkAdjuster::grid_adaption_callback);
+    m_spGridDistributionCallbackID = grid.message_hub()->register_class_callback(this,
+        &NeuriteRefMarkAdjuster::grid_distribution_callback);
+}
+
+
+void NeuriteRefMarkAdjuster::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+    if (gma.adaption_ends())
+        clear_cache();
+}
+
+
+void NeuriteRefMarkAdjuster::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+    if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+        clear_cache();
+}
+
+
 void NeuriteRefMarkAdjuster::ref_marks_changed
 (
 	IRefiner& ref,
@@ -178,6 +264,7 @@ void NeuriteRefMarkAdjuster::ref_marks_changed
 
 	if (!ref.grid()) return;
 	Grid& grid = *ref.grid();
+	register_grid_callbacks(grid);
 
 	Grid::edge_traits::secure_container		assEdges;
 	Grid::face_traits::secure_container		assFaces;
@@ -204,16 +291,8 @@ void NeuriteRefMarkAdjuster::ref_marks_changed
 	        continue;
 	    }
 
-	    // calculate anisotropy of face
-	    vector3 sidevec;
-	    VecSubtract(sidevec, m_aaPos[q->vertex(1)], m_aaPos[q->vertex(0)]);
-        number a = VecLength(sidevec);
-        VecSubtract(sidevec, m_aaPos[q->vertex(2)], m_aaPos[q->vertex(1)]);
-        number aniso = a / VecLength(sidevec);
-        if (aniso < 1.0) aniso = 1.0 / aniso;
-
         // isotropic face: only copy, also mark edges copy
-        if (aniso < 1.4142)
+        if (!is_anisotropic(q))
             mark_face_copy(ref, grid, q);
         // anisotropic face: mark anisotropic and process edges
         else
@@ -232,18 +311,8 @@ void NeuriteRefMarkAdjuster::ref_marks_changed
             continue;
         }
 
-		// calculate anisotropy of volume
-        vector3 sidevec;
-        VecSubtract(sidevec, m_aaPos[h->vertex(1)], m_aaPos[h->vertex(0)]);
-        number a = VecLength(sidevec);
-        VecSubtract(sidevec, m_aaPos[h->vertex(2)], m_aaPos[h->vertex(1)]);
-        number b = VecLength(sidevec);
-        VecSubtract(sidevec, m_aaPos[h->vertex(4)], m_aaPos[h->vertex(0)]);
-        number c = VecLength(sidevec);
-        number aniso = std::max(a, std::max(b,c)) / std::min(a, std::min(b,c));
-
         // isotropic volume: only copy, also mark faces and edges copy
-        if (aniso < 1.4142)
+        if (!is_anisotropic(h))
             mark_vol_copy(ref, grid, h);
         // anisotropic volume: mark volume and volume faces appropriately
         else
@@ -43,6 +43,9 @@
 #include "lib_grid/refinement/ref_mark_adjuster_interface.h"
 #include "lib_grid/refinement/hanging_node_refiner_multi_grid.h"
 #include "lib_grid/refinement/projectors/neurite_projector.h"
+#include "lib_grid/lib_grid_messages.h"
+
+#include <map>
 
 
 namespace ug {
@@ -59,6 +62,12 @@ namespace neuro_collection {
  * At some point, the original anisotropy of the neurite mesh will have been "refined out"
  * and this refinement mark adjuster can be switched off using disable().
  *
+ * The neurite direction and the anisotropy classification of each element are
+ * computed only once and cached, since the refiner calls the adjuster repeatedly
+ * while marks propagate. Grid objects are level-specific, so the cache holds
+ * separate entries for each level. It is cleared after each adaption and
+ * redistribution of the grid (and can be cleared manually using clear_cache()).
+ *
  * TODO: Have the refinement mark adjuster decide on when it switches itself off.
  */
 class NeuriteRefMarkAdjuster
@@ -70,13 +79,20 @@ class NeuriteRefMarkAdjuster
             ConstSmartPtr<NeuriteProjector> np,
             ConstSmartPtr<ISubsetHandler> ssh,
             const Grid::VertexAttachmentAccessor<Attachment<vector3> >& aaPos
-        ) : IRefMarkAdjuster(), m_spNP(np), m_ssh(ssh), m_aaPos(aaPos) {}
+        ) : IRefMarkAdjuster(), m_spNP(np), m_ssh(ssh), m_aaPos(aaPos), m_pGrid(NULL) {}
 
 		virtual ~NeuriteRefMarkAdjuster() {}
 
         void disable()
         {enable(false);}
 
+        /// remove all cached direction and anisotropy data
+        void clear_cache()
+        {
+            m_mDirCache.clear();
+            m_mAnisoCache.clear();
+        }
+
 		virtual void ref_marks_changed
 		(
 			IRefiner& ref,
@@ -91,10 +107,36 @@ class NeuriteRefMarkAdjuster
         void change_face_mark(IRefiner& ref, Grid& grid, Face* f, const vector3* dir = NULL) const;
         void change_vol_mark(IRefiner& ref, Grid& grid, Volume* v) const;
 
+        /// normalized neurite direction at an element (false if there is none, i.e., soma or tip)
+        bool neurite_direction(vector3& dirOut, GridObject* o) const;
+
+        /// whether a quadrilateral is anisotropic
+        bool is_anisotropic(Quadrilateral* q) const;
+
+        /// whether a hexahedron is anisotropic
+        bool is_anisotropic(Hexahedron* h) const;
+
+	private:
+        void register_grid_callbacks(Grid& grid);
+        void grid_adaption_callback(const GridMessage_Adaption& gma);
+        void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
 	private:
 		ConstSmartPtr<NeuriteProjector> m_spNP;
 		ConstSmartPtr<ISubsetHandler> m_ssh;
         const Grid::VertexAttachmentAccessor<Attachment<vector3> > m_aaPos;
+
+        struct DirEntry
+        {
+            vector3 dir;
+            bool valid;
+        };
+        mutable std::map<GridObject*, DirEntry> m_mDirCache;
+        mutable std::map<GridObject*, bool> m_mAnisoCache;
+
+        Grid* m_pGrid;
+        MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+        MessageHub::SPCallbackId m_spGridDistributionCallbackID;
 };
 
 void add_neurite_ref_mark_adjuster(IRefiner* ref, SmartPtr<NeuriteRefMarkAdjuster> nrma);
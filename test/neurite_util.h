@@ -893,6 +893,38 @@ namespace ug {
 			const std::vector<SWCPoint>& somaPoint
 		);
 
+		/*!
+		 * \brief reduces a grid to the provided subset indices (in place)
+		 * Same as split_grid_based_on_subset_indices, but erases everything else
+		 * from the given grid instead of working on a copy of it
+		 * \param[in,out] grid
+		 * \param[in,out] sh
+		 * \param[in] vSi
+		 */
+		void split_grid_based_on_subset_indices_in_place
+		(
+			Grid& grid,
+			ISubsetHandler& sh,
+			const std::vector<size_t>& vSi
+		);
+
+		/*!
+		 * \brief reduces a grid to the part inside the soma sphere (in place)
+		 * Same as split_grid_based_on_selection, but erases everything else
+		 * from the given grid instead of working on a copy of it
+		 * \param[in,out] grid
+		 * \param[in,out] sh
+		 * \param[in] aaPos
+		 * \param[in] somaPoint
+		 */
+		void split_grid_based_on_selection_in_place
+		(
+			Grid& grid,
+			ISubsetHandler& sh,
+			Grid::VertexAttachmentAccessor<APosition>& aaPos,
+			const std::vector<SWCPoint>& somaPoint
+		);
+
 		/*!
 		 * \brief selects elements whose center lies within or on a sphere specified by center and radius
 		 * \param[in] grid
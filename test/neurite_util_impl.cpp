@@ -40,6 +40,9 @@
 #include "neurite_util.h"
 #include "neurite_runtime_error.h"
 #include "tetrahedralize_util.h"
+#include "grid_generation_stages.h"
+#include "../util/kd_tree.h"
+#include "../util/aabb_hash.h"
 #include "common/log.h"
 #include "common/error.h"
 #include "common/math/math_vector_matrix/math_vector_functions.h"
@@ -651,8 +654,7 @@ namespace ug {
 			std::vector<ug::vector3> normals;
 			projected.resize(numQuads);
 			projectedVertices.resize(numQuads);
-			IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, "before_projections_inner.ugx");
-			SaveGridToFile(g, "before_projections_inner.ugx");
+			DumpStageGrid(g, "before_projections_inner.ugx");
 
 			/// find all edges for each inner sphere's surface quad - take two starting at the same vertex to get two edges for normal calculation
 			for (size_t i = 1; i < numQuads+1; i++) {
@@ -771,8 +773,7 @@ namespace ug {
 					VecSubtract(*it2, *it2, dir);
 				}
 			}
-			IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, "projection_after_centered.ugx");
-			SaveGridToFile(g, sh, "projection_after_centered.ugx");
+			DumpStageGrid(g, sh, "projection_after_centered.ugx");
 
 			std::vector<std::vector<number> > allAngles;
 			std::vector<std::vector<number> > allAnglesInner;
@@ -916,8 +917,7 @@ namespace ug {
 			/// quad vertices) and form a face. It is also possible to do the
 			/// same procedure with the sorted angle differences above to
 			/// create these faces if angles are correct
-			IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, "before_projections_inner_connections.ugx");
-			SaveGridToFile(g, sh, "before_projections_inner_connections.ugx");
+			DumpStageGrid(g, sh, "before_projections_inner_connections.ugx");
 			for (size_t i = 1; i < numQuads+1; i++) {
 				sel.clear();
 				UG_DLOGN(NC_TNP, 0, "Selecting now subset: " << somaIndex+i);
@@ -961,8 +961,7 @@ namespace ug {
 				}
 			}
 
-			IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, "after_projections_inner.ugx");
-			SaveGridToFile(g, sh, "after_projections_inner.ugx");
+			DumpStageGrid(g, sh, "after_projections_inner.ugx");
 
 			/// TODO: Optimierung: Verdrehung kann beseitigt werden wenn man digge
 			/// Knoten des inneren Soma Oberflächenquads auf die Ebene projiziert
@@ -2249,6 +2248,41 @@ namespace ug {
 	    	lines = lineCnt;
 		}
 
+		////////////////////////////////////////////////////////////////////////
+		/// find_closest_subset_vertices
+		////////////////////////////////////////////////////////////////////////
+		static void find_closest_subset_vertices
+		(
+			const std::vector<ug::vector3>& vQueryPts,
+			std::vector<ug::Vertex*>& vClosestOut,
+			Grid& g,
+			Grid::VertexAttachmentAccessor<APosition>& aaPos,
+			SubsetHandler& sh,
+			size_t si
+		) {
+			/// subset vertices are collected and indexed once for all queries
+			Selector sel(g);
+			SelectSubsetElements<Vertex>(sel, sh, si, true);
+			UG_DLOGN(NC_TNP, 0, "selected vertices: " << sel.num<Vertex>());
+			std::vector<ug::Vertex*> vVrts(sel.vertices_begin(), sel.vertices_end());
+			UG_COND_THROW(vVrts.empty() && !vQueryPts.empty(),
+				"No best vertex found for root neurite >>0<<.");
+
+			std::vector<ug::vector3> vVrtPos(vVrts.size());
+			for (size_t i = 0; i < vVrts.size(); i++) {
+				vVrtPos[i] = aaPos[vVrts[i]];
+			}
+			KDTree<3> tree(vVrtPos);
+
+			for (size_t i = 0; i < vQueryPts.size(); i++) {
+				number distSq;
+				vClosestOut.push_back(vVrts[tree.nearest(vQueryPts[i], distSq)]);
+			}
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// get_closest_vertices_on_soma_var
+		////////////////////////////////////////////////////////////////////////
 		void get_closest_vertices_on_soma_var
 		(
 			const std::vector<std::vector<ug::vector3> >& vPos,
@@ -2260,29 +2294,11 @@ namespace ug {
 			const std::vector<size_t> indices
 		)
 		{
+			std::vector<ug::vector3> vCenters(indices.size());
 			for (size_t i = 0; i < indices.size(); i++) {
-				UG_LOGN("i-th root neurite: " << i);
-				ug::vector3 centerOut = vPos[indices[i]][0];
-				Selector sel(g);
-				SelectSubsetElements<Vertex>(sel, sh, si, true);
-				UG_DLOGN(NC_TNP, 0, "selected vertices: " << sel.num<Vertex>());
-				Selector::traits<Vertex>::iterator vit = sel.vertices_begin();
-				Selector::traits<Vertex>::iterator vit_end = sel.vertices_end();
-				number best = -1;
-				ug::Vertex* best_vertex = NULL;
-				for (; vit != vit_end; ++vit) {
-					number dist = VecDistance(aaPos[*vit], centerOut);
-					if (best == -1) {
-						best = dist;
-						best_vertex = *vit;
-					} else if (dist < best) {
-						best = dist;
-						best_vertex = *vit;
-					}
-				}
-				UG_COND_THROW(!best_vertex, "No best vertex found for root neurite >>" << i << "<<.");
-				vPointsSomaSurface.push_back(best_vertex);
+				vCenters[i] = vPos[indices[i]][0];
 			}
+			find_closest_subset_vertices(vCenters, vPointsSomaSurface, g, aaPos, sh, si);
 		}
 
 		////////////////////////////////////////////////////////////////////////
@@ -2298,31 +2314,7 @@ namespace ug {
 			size_t si
 		) {
 			UG_DLOGN(NC_TNP, 0, "Finding now: " << vPos.size());
-			for (size_t i = 0; i < vPos.size(); i++) {
-				UG_LOGN("i-th root neurite: " << i);
-				const ug::vector3* pointSet = &vPos[i];
-				ug::vector3 centerOut;
-				CalculateCenter(centerOut, pointSet, 1);
-				Selector sel(g);
-				SelectSubsetElements<Vertex>(sel, sh, si, true);
-				UG_DLOGN(NC_TNP, 0, "selected vertices: " << sel.num<Vertex>());
-				Selector::traits<Vertex>::iterator vit = sel.vertices_begin();
-				Selector::traits<Vertex>::iterator vit_end = sel.vertices_end();
-				number best = -1;
-				ug::Vertex* best_vertex = NULL;
-				for (; vit != vit_end; ++vit) {
-					number dist = VecDistance(aaPos[*vit], centerOut);
-					if (best == -1) {
-						best = dist;
-						best_vertex = *vit;
-					} else if (dist < best) {
-						best = dist;
-						best_vertex = *vit;
-					}
-				}
-				UG_COND_THROW(!best_vertex, "No best vertex found for root neurite >>" << i << "<<.");
-				vPointsSomaSurface.push_back(best_vertex);
-			}
+			find_closest_subset_vertices(vPos, vPointsSomaSurface, g, aaPos, sh, si);
 		}
 
 		////////////////////////////////////////////////////////////////////////
@@ -2337,29 +2329,10 @@ namespace ug {
 			size_t si
 		) {
 			UG_DLOGN(NC_TNP, 0, "finding now: " << vPos.size());
-			for (size_t i = 0; i < vPos.size(); i++) {
-				const ug::vector3* pointSet = &vPos[i];
-				ug::vector3 centerOut;
-				CalculateCenter(centerOut, pointSet, 1);
-				Selector sel(g);
-				SelectSubsetElements<Vertex>(sel, sh, si, true);
-				UG_DLOGN(NC_TNP, 0, "selected vertices: " << sel.num<Vertex>());
-				Selector::traits<Vertex>::iterator vit = sel.vertices_begin();
-				Selector::traits<Vertex>::iterator vit_end = sel.vertices_end();
-				number best = -1;
-				ug::Vertex* best_vertex = NULL;
-				for (; vit != vit_end; ++vit) {
-					number dist = VecDistance(aaPos[*vit], centerOut);
-					if (best == -1) {
-						best = dist;
-						best_vertex = *vit;
-					} else if (dist < best) {
-						best = dist;
-						best_vertex = *vit;
-					}
-				}
-				UG_COND_THROW(!best_vertex, "No best vertex found for root neurite >>" << i << "<<.");
-				vPointsSomaSurface.push_back(aaPos[best_vertex]);
+			std::vector<ug::Vertex*> vClosest;
+			find_closest_subset_vertices(vPos, vClosest, g, aaPos, sh, si);
+			for (size_t i = 0; i < vClosest.size(); i++) {
+				vPointsSomaSurface.push_back(aaPos[vClosest[i]]);
 			}
 		}
 
@@ -2523,7 +2496,7 @@ namespace ug {
 				AssignSelectionToSubset(sel, sh, somaIndex);
 			}
 
-			SaveGridToFile(grid, sh, "before_creating_all_pyramids.ugx");
+			DumpStageGrid(grid, sh, "before_creating_all_pyramids.ugx");
 
 			//grid.disable_options(EO_CREATE_VOLUMES);
 			// Create pyramids at connectiong region of soma and dendrite
@@ -2544,7 +2517,7 @@ namespace ug {
 			}
 
 
-			SaveGridToFile(grid, sh, "after_creating_all_pyramids.ugx");
+			DumpStageGrid(grid, sh, "after_creating_all_pyramids.ugx");
 
 			// Create selection of soma and ER - ignoring the neurites
 			IF_DEBUG(NC_TNP, 0) SaveGridToFile(grid, sh, "before_tetrahedralize_soma.ugx");
@@ -2554,7 +2527,7 @@ namespace ug {
 			CloseSelection(sel);
 
 			AssignSelectionToSubset(sel, sh, 100);
-			SaveGridToFile(grid, sh, "before_tetrahedralize"
+			DumpStageGrid(grid, sh, "before_tetrahedralize"
 								"_soma_and_after_selecting.ugx");
 
 			sel.clear();
@@ -2575,7 +2548,7 @@ namespace ug {
 			///CloseSelection(sel);
 			AssignSelectionToSubset(sel, sh, 200);
 
-			SaveGridToFile(grid, sh, "before_tetrahedralize"
+			DumpStageGrid(grid, sh, "before_tetrahedralize"
 									"_soma_and_after_selecting_take2.ugx");
 
 			sel.clear();
@@ -2583,16 +2556,16 @@ namespace ug {
 			AssignSelectionToSubset(sel, sh, 4);
 			CloseSelection(sel);
 
-			SavePreparedGridToFile(grid, sh, "before_tetrahedralize"
-												"_soma_and_after_selecting_take3.ugx");
+			DumpStageGrid(grid, sh, "before_tetrahedralize"
+												"_soma_and_after_selecting_take3.ugx", true);
 
 			IF_DEBUG(NC_TNP, 0) SaveGridToFile(grid, sh, "before_tetrahedralize"
 					"_soma_and_after_selecting.ugx");
 			UG_DLOGN(NC_TNP, 0, "num vertices before tet call: " << grid.num<Vertex>());
 			RemoveDoubles<3>(grid, grid.begin<Vertex>(), grid.end<Vertex>(), aaPos, 0.00001);
 			sel.clear();
-			SavePreparedGridToFile(grid, sh, "before_tetrahedralize"
-					"_soma_and_after_selecting_take4.ugx");
+			DumpStageGrid(grid, sh, "before_tetrahedralize"
+					"_soma_and_after_selecting_take4.ugx", true);
 			SelectSubset(sel, sh, 4, true);
 
 			UG_LOGN("deselecting quadconts...")
@@ -2618,15 +2591,16 @@ namespace ug {
 			AssignSelectionToSubset(sel, sh, 100);
 
 			/// TODO: center  base face of pyramid is missing in selection => this makes teh tetgen call fail?!
-			SavePreparedGridToFile(grid, sh, "before_tetrahedralize"
-					"_soma_and_after_selecting_take5.ugx");
+			DumpStageGrid(grid, sh, "before_tetrahedralize"
+					"_soma_and_after_selecting_take5.ugx", true);
 
 
-			const bool success = Tetrahedralize(sel, grid, &sh, 10, true, true, aPosition, 10); /// 10, false, false, aPosition, 10
+			/// independent parts (e.g. of a soma without ER) are split if enabled
+			const bool success = TetrahedralizeSubVolumesEnabled()
+				? TetrahedralizeSubVolumes(sel, grid, &sh, std::vector<int>(), 10, true, aPosition, 10)
+				: Tetrahedralize(sel, grid, &sh, 10, true, true, aPosition, 10); /// 10, false, false, aPosition, 10
 			if (!success) { throw TetrahedralizeFailure(); }
-			IF_DEBUG(NC_TNP, 0) SaveGridToFile(grid, sh, "after_tetrahedralize_"
-					"soma_and_before_fix_axial_parameters.ugx");
-			SaveGridToFile(grid, sh, "after_tetrahedralize_"
+			DumpStageGrid(grid, sh, "after_tetrahedralize_"
 								"soma_and_before_fix_axial_parameters.ugx");
 			UG_DLOGN(NC_TNP, 0, "num vertices after tet call: " << grid.num<Vertex>());
 
@@ -2694,7 +2668,7 @@ namespace ug {
 				sh.assign_subset(vVol.front(), 1);
 
 
-				SavePreparedGridToFile(grid, sh, "after_extend_ER_within.ugx");
+				DumpStageGrid(grid, sh, "after_extend_ER_within.ugx", true);
 				for (size_t j = 0; j < vertices.size(); j++) {
 					aaSurfParams[vertices[j]].axial = -scale/2.0;
 					aaMapping[vertices[j]].lambda = 0;
@@ -2775,19 +2749,32 @@ namespace ug {
 			const std::vector<SWCPoint>& somaPoint
 		) {
 			gridOut.attach_to_vertices(aPosition);
-			SubsetHandler sh(gridOut);
-			CopyGrid<APosition>(gridIn, gridOut, srcSh, sh, aPosition);
-			Selector sel(gridOut); sel.clear();
-			SelectElementsInSphere<ug::Vertex>(gridOut, sel, somaPoint[0].coords, somaPoint[0].radius*0.55, aaPos);
+			CopyGrid<APosition>(gridIn, gridOut, srcSh, destSh, aPosition);
+			Grid::VertexAttachmentAccessor<APosition> aaPosOut(gridOut, aPosition);
+			split_grid_based_on_selection_in_place(gridOut, destSh, aaPosOut, somaPoint);
+
+			// save grid
+			SavePreparedGridToFile(gridOut, destSh, "after_splitting_the_grid_and_copying.ugx");
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// split_grid_based_on_selection_in_place
+		////////////////////////////////////////////////////////////////////////
+		void split_grid_based_on_selection_in_place
+		(
+			Grid& grid,
+			ISubsetHandler& sh,
+			Grid::VertexAttachmentAccessor<APosition>& aaPos,
+			const std::vector<SWCPoint>& somaPoint
+		) {
+			Selector sel(grid); sel.clear();
+			SelectElementsInSphere<ug::Vertex>(grid, sel, somaPoint[0].coords, somaPoint[0].radius*0.55, aaPos);
 
 			// invert
 			InvertSelection(sel);
 
 			// erase selection
 			EraseSelectedObjects(sel);
-
-			// save grid
-			SavePreparedGridToFile(gridOut, sh, "after_splitting_the_grid_and_copying.ugx");
 		}
 
 		////////////////////////////////////////////////////////////////////////
@@ -2803,11 +2790,24 @@ namespace ug {
 			const std::vector<size_t>& vSi
 		) {
 			gridOut.attach_to_vertices(aPosition);
-			SubsetHandler sh(gridOut);
-			CopyGrid<APosition>(gridIn, gridOut, srcSh, sh, aPosition);
+			CopyGrid<APosition>(gridIn, gridOut, srcSh, destSh, aPosition);
+			split_grid_based_on_subset_indices_in_place(gridOut, destSh, vSi);
+
+			// save grid
+			SavePreparedGridToFile(gridOut, destSh, "after_splitting_the_grid_and_copying.ugx");
+		}
 
+		////////////////////////////////////////////////////////////////////////
+		/// split_grid_based_on_subset_indices_in_place
+		////////////////////////////////////////////////////////////////////////
+		void split_grid_based_on_subset_indices_in_place
+		(
+			Grid& grid,
+			ISubsetHandler& sh,
+			const std::vector<size_t>& vSi
+		) {
 			// select soma and ER in spheres
-			Selector sel(gridOut); sel.clear();
+			Selector sel(grid); sel.clear();
 			for (size_t i = 0; i < vSi.size(); i++) {
 				SelectSubset(sel, sh, vSi[i], true);
 			}
@@ -2817,9 +2817,6 @@ namespace ug {
 
 			// erase selection
 			EraseSelectedObjects(sel);
-
-			// save grid
-			SavePreparedGridToFile(gridOut, sh, "after_splitting_the_grid_and_copying.ugx");
 		}
 
 		////////////////////////////////////////////////////////////////////////
@@ -3182,7 +3179,7 @@ namespace ug {
 			AssignSubsetColors(sh);
 			stringstream ss;
 			ss << "SphereAdaptionToSquare_i=" << i << ".ugx";
-			SaveGridToFile(g, sh, ss.str().c_str());
+			DumpStageGrid(g, sh, ss.str().c_str());
 		}
 
 		////////////////////////////////////////////////////////////////////////
@@ -3244,8 +3241,7 @@ namespace ug {
 			AssignSubsetColors(sh);
 			std::stringstream ss;
 			ss << fileName << "_best_vertices.ugx";
-			IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, ss.str().c_str());
-			SaveGridToFile(g, sh, ss.str().c_str());
+			DumpStageGrid(g, sh, ss.str().c_str());
 			ss.str(""); ss.clear();
 
 			UG_DLOGN(NC_TNP, 0, "3. AdaptSurfaceGridToCylinder")
@@ -3284,14 +3280,13 @@ namespace ug {
 				UG_LOGN("new method")
 			}
 			AssignSubsetColors(sh);
-			SaveGridToFile(g, sh, "after_adapting_surface_grid.ugx");
+			DumpStageGrid(g, sh, "after_adapting_surface_grid.ugx");
 
 			UG_LOGN("Done with bestvertices")
 
 			AssignSubsetColors(sh);
 			ss << fileName << "_before_deleting_center_vertices.ugx";
-			IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, ss.str().c_str());
-			SaveGridToFile(g, sh, ss.str().c_str());
+			DumpStageGrid(g, sh, ss.str().c_str());
 			ss.str(""); ss.clear();
 
 			UG_DLOGN(NC_TNP, 0, "5. MergeVertices")
@@ -3299,8 +3294,7 @@ namespace ug {
 			EraseEmptySubsets(sh);
 			AssignSubsetColors(sh);
 			ss << fileName << "_after_deleting_center_vertices.ugx";
-			IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, ss.str().c_str());
-			SaveGridToFile(g, sh, ss.str().c_str());
+			DumpStageGrid(g, sh, ss.str().c_str());
 			ss.str(""); ss.clear();
 			/// refine outer polygon once to get 12 vertices
 			int beginningOfQuads = si+1+numDodecagons; // subset index where inner quads are stored in
@@ -3467,7 +3461,7 @@ namespace ug {
 					//sh.assign_subset(verticesNew[j], siOuter);
 				}
 			}
-			SaveGridToFile(g, sh, "after_first_connect.ugx");
+			DumpStageGrid(g, sh, "after_first_connect.ugx");
 		}
 
 		////////////////////////////////////////////////////////////////////////
@@ -3713,7 +3707,7 @@ namespace ug {
 				vector<pair<Vertex*, Vertex*> > pairs;
 				connect_polygon_with_polygon(unprojectedVertices, projectedVertices, aaPos, pairs);
 				vector<pair<Vertex*, Vertex*> >::iterator it = pairs.begin();
-				SaveGridToFile(g, sh, "before_connecting.ugx");
+				DumpStageGrid(g, sh, "before_connecting.ugx");
 				for (; it != pairs.end(); ++it) {
 					if (merge) {
 						UG_DLOGN(NC_TNP, 0, "Creating edge between: " << aaPos[it->first]
@@ -4128,16 +4122,27 @@ namespace ug {
 			const std::vector<std::vector<number> >& vRad,
 			const number blowUpFactor
 		) {
+			/// neurite starts i and j intersect if their distance is smaller
+			/// than the larger (blown-up) radius, in particular, the start of one
+			/// lies within the bounding box of the other: only check those pairs
 			const size_t n = vPos.size();
+			AABBHash<3> hash;
 			for (size_t i = 0; i < n; i++) {
-				for (size_t j = 0; j < n; j++) {
-					if ( (i!=j) && (VecDistance(vPos[i].front(), vPos[j].front()) <
-						(blowUpFactor * std::max(vRad[i].front(), vRad[j].front()))))
-					{
-						UG_LOGN("Neurite start cylinders intersect at: " << vPos[i].front()
-								<< "and " << vPos[j].front());
-						return true;
-					}
+				hash.add_ball(vPos[i].front(), blowUpFactor * vRad[i].front());
+			}
+			hash.build();
+
+			std::vector<std::pair<size_t, size_t> > vCandidates;
+			hash.overlapping_pairs(vCandidates);
+			for (size_t k = 0; k < vCandidates.size(); k++) {
+				const size_t i = vCandidates[k].first;
+				const size_t j = vCandidates[k].second;
+				if (VecDistance(vPos[i].front(), vPos[j].front()) <
+					(blowUpFactor * std::max(vRad[i].front(), vRad[j].front())))
+				{
+					UG_LOGN("Neurite start cylinders intersect at: " << vPos[i].front()
+							<< "and " << vPos[j].front());
+					return true;
 				}
 			}
 			return false;
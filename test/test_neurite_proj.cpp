@@ -49,6 +49,9 @@
 #include "../util/misc_util.h"
 #include "neurite_math_util.h"
 #include "neurite_runtime_error.h"
+#include "grid_generation_stages.h"
+#include "../grid_generation/swc_reader.h"
+#include "../grid_generation/text_writer.h"
 
 /// ug
 #include "lib_grid/refinement/projectors/projection_handler.h" // ProjectionHandler
@@ -2454,15 +2457,15 @@ void export_to_swc
 			start = q.front();
 	}
 
-	// write the neuron to file
-	std::ofstream outFile(fileName.c_str(), std::ios::out);
-	UG_COND_THROW(!outFile.is_open(), "Could not open output file '" << fileName << "'.");
+	// write the neuron to file (buffered, in one depth-first traversal)
+	TextFileWriter outFile(fileName);
 
-	outFile << "# This file has been generated by UG4." << std::endl;
+	outFile.put("# This file has been generated by UG4.\n");
 
 	std::stack<std::pair<Vertex*, int> > stack; // corresponds to depth-first
 	stack.push(std::make_pair(start, -1));
 
+	Grid::traits<Edge>::secure_container edges;
 	g.begin_marking();
 	int ind = 0;   // by convention, swc starts with index 1
 	bool all_types_identified = true;
@@ -2485,12 +2488,11 @@ void export_to_swc
 		number radius = 0.5*aaDiam[v];
 
 		// write line to file
-		outFile << ++ind << " " << type << " "
-			<< coord[0] << " " << coord[1] << " " << coord[2] << " "
-			<< radius << " " << conn << std::endl;
+		outFile.put_int(++ind).put(' ').put_int(type).put(' ')
+			.put_number(coord[0]).put(' ').put_number(coord[1]).put(' ').put_number(coord[2]).put(' ')
+			.put_number(radius).put(' ').put_int(conn).put('\n');
 
 		// push neighboring elems to queue
-		Grid::traits<Edge>::secure_container edges;
 		g.associated_elements(edges, v);
 
 		size_t sz = edges.size();
@@ -2640,13 +2642,13 @@ void test_convert_swc_to_ugx(
 	const std::string& fileName
 )
 {
-	std::vector<SWCPoint> vPoints;
-	import_swc(fileName, vPoints);
+	std::string inFileName = FindFileInStandardPaths(fileName.c_str());
+	UG_COND_THROW(inFileName == "", "SWC input file '" << fileName << "' could not be located.");
 
-	// export original cell to ugx
+	// export original cell to ugx (without intermediate point list)
 	Grid g;
 	SubsetHandler sh(g);
-	swc_points_to_grid(vPoints, g, sh);
+	neurites_from_swc::swc_file_to_grid(inFileName, g, sh);
 	std::string fn_noext = FilenameWithoutExtension(fileName);
 	std::string fn = fn_noext + "_orig.ugx";
 	export_to_ugx(g, sh, fn);
@@ -4069,6 +4071,9 @@ void test_import_swc_general_var(
 			UG_LOGN("segLength: " << segLength)
 
 			using namespace std;
+	GridGenerationStages stages;
+	stages.begin("swc correction");
+
 	// Read in SWC file to intermediate structure (May contain multiple soma points)
 	vector<SWCPoint> vPoints;
 	vector<SWCPoint> vSomaPoints;
@@ -4230,10 +4235,12 @@ void test_import_swc_general_var(
 
 	UG_LOGN("After checks...")
 	UG_DLOGN(NC_TNP, 0, " passed!");
-	Grid g2;
-	SubsetHandler sh2(g2);
-	swc_points_to_grid(vPoints, g2, sh2);
-	export_to_ugx(g2, sh2, "after_regularize.ugx");
+	if (GridGenerationDumpEnabled()) {
+		Grid g2;
+		SubsetHandler sh2(g2);
+		swc_points_to_grid(vPoints, g2, sh2);
+		export_to_ugx(g2, sh2, "after_regularize.ugx");
+	}
 	/// TODO Smooth again? Or smooth much before in the beginning? Probably smooth before fixing branches
 	/// constrained_smoothing(vPoints, vRootNeuriteIndsOut.size(), 0.1, 0.1, 10, 0.1);
 	///convert_pointlist_to_neuritelist(vPoints, vSomaPoints, vPos, vRad, vBPInfo, vRootNeuriteIndsOut);
@@ -4253,6 +4260,8 @@ void test_import_swc_general_var(
 
 	UG_LOGN("Converted again")
 
+	stages.begin("soma creation");
+
 	// Projection handling setup
 	SubsetHandler psh(g);
 	psh.set_default_subset_index(0);
@@ -4311,7 +4320,7 @@ void test_import_swc_general_var(
 	sh.set_default_subset_index(4); /// soma starts now at 4
 	somaPoint = vSomaPoints;
 	create_soma(somaPoint, g, aaPos, sh, 4, 3);
-	SaveGridToFile(g, sh, "testNeuriteProjector_after_adding_first_soma.ugx");
+	DumpStageGrid(g, sh, "testNeuriteProjector_after_adding_first_soma.ugx");
 	UG_DLOGN(NC_TNP, 0, " done.");
 	IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, "testNeuriteProjector_testNeuriteProjector_after_adding_neurites_and_connecting_inner_soma_to_outer_ER.ugxafter_adding_neurites_and_soma.ugx");
 	vector<Vertex*> outQuadsInner;
@@ -4331,8 +4340,9 @@ void test_import_swc_general_var(
 	g.erase(outVertsInner.begin(), outVertsInner.end());
 	outVerts.clear();
 	outVertsInner.clear();
-	IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, "testNeuriteProjector_after_adding_neurites_and_finding_initial_edges.ugx");
-	SaveGridToFile(g, sh, "testNeuriteProjector_after_adding_neurites_and_finding_initial_edges.ugx");
+	DumpStageGrid(g, sh, "testNeuriteProjector_after_adding_neurites_and_finding_initial_edges.ugx");
+
+	stages.begin("neurite connection");
 
 	std::vector<SWCPoint> newPoints;
 	sh.set_default_subset_index(0);
@@ -4357,12 +4367,12 @@ void test_import_swc_general_var(
 		    ss.str(""); ss.clear();
 		 */
 	}
-	SaveGridToFile(g, sh, "testNeuriteProjector_after_adding_neurites.ugx");
+	DumpStageGrid(g, sh, "testNeuriteProjector_after_adding_neurites.ugx");
 
 
 	UG_DLOGN(NC_TNP, 0, " done.");
 	UG_LOGN("Generating inner soma");
-	SaveGridToFile(g, sh, "testNeuriteProjector_after_generating_neurites.ugx");
+	DumpStageGrid(g, sh, "testNeuriteProjector_after_generating_neurites.ugx");
 
 	/// (Inner sphere) ER
 	UG_DLOGN(NC_TNP, 0, "Creating (inner sphere) ER");
@@ -4376,7 +4386,7 @@ void test_import_swc_general_var(
 	// Find surface quads on the (inner sphere) ER to connect with to ER
 	connect_neurites_with_soma(g, aaPos, aaSurfParams, outVerts, outVertsInner, outRadsInner, outQuadsInner2, newSomaIndex, sh, fileName, erScaleFactor, axisVectorsInner, vNeurites, connectingVertices, connectingVerticesInner, connectingEdges, connectingEdgesInner, vRootNeuriteIndsOut.size(), false);
 	UG_LOGN("Connected inner soma");
-	SaveGridToFile(g, sh, "testNeuriteProjector_after_finding_surface_quads.ugx");
+	DumpStageGrid(g, sh, "testNeuriteProjector_after_finding_surface_quads.ugx");
 
 	/// Connects (inner sphere) ER with ER part of dendrite
 	if (withER) {
@@ -4399,7 +4409,7 @@ void test_import_swc_general_var(
 			UG_COND_THROW(neuriteProj->neurites()[i].vSomaSec.size() != 2, "Each neurite should only contain two sections for determining if at soma.")
 		}
 	}
-	SaveGridToFile(g, sh, "testNeuriteProjector_after_finding_surface_quads_and_connect_new.ugx");
+	DumpStageGrid(g, sh, "testNeuriteProjector_after_finding_surface_quads_and_connect_new.ugx");
 
 	// assign subset
 	AssignSubsetColors(sh);
@@ -4417,9 +4427,8 @@ void test_import_swc_general_var(
 		ss << "inner-connex #" << i;
 		sh.set_subset_name(ss.str().c_str(), i);
 	}
-	IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, "testNeuriteProjector_after_adding_neurites_and_renaming.ugx");
 	UG_LOGN("After inner connex");
-	SaveGridToFile(g, sh, "testNeuriteProjector_after_adding_neurites_and_renaming.ugx");
+	DumpStageGrid(g, sh, "testNeuriteProjector_after_adding_neurites_and_renaming.ugx");
 
 	/// Double Vertices might occur during Qhull gen faces -> remove these here
 	/// RemoveDoubles<3>(g, g.begin<Vertex>(), g.end<Vertex>(), aaPos, 0.0001);
@@ -4433,7 +4442,7 @@ void test_import_swc_general_var(
 		sh.set_subset_name(ss.str().c_str(), i);
 	}
 
-	SavePreparedGridToFile(g, sh, "testNeuriteProjector_after_adding_neurites_and_connecting_inner_soma_to_outer_ER.ugx");
+	DumpStageGrid(g, sh, "testNeuriteProjector_after_adding_neurites_and_connecting_inner_soma_to_outer_ER.ugx", true);
 	UG_LOGN("After adding neurites and connecting inner soma to outer ER");
 
 	UG_LOGN("somaIndex before connect pm with soma: " << newSomaIndex);
@@ -4454,7 +4463,7 @@ void test_import_swc_general_var(
 			connect_pm_with_soma(newSomaIndex, g, aaPos, sh, outVertsClean, false, 0, false); /// soma ER subset stored as last subset index
 		}
 	}
-	SavePreparedGridToFile(g, sh, "after_connect_pm_with_soma.ugx");
+	DumpStageGrid(g, sh, "after_connect_pm_with_soma.ugx", true);
 
 
 	UG_LOGN("Passed connecting ER and PM to Soma");
@@ -4466,7 +4475,7 @@ void test_import_swc_general_var(
 		/// inner soma, like the surrounding pyramids to close outer soma, to avoid intersections
 		if (withER) {
 			extend_ER_within(g, sh, aaPos, aaSurfParams, aaMapping, newSomaIndex, vRootNeuriteIndsOut.size(), erScaleFactor, outVertsInner, somaPoint.front());
-			SavePreparedGridToFile(g, sh, "after_extend_ER_and_before_connect_outer.ugx");
+			DumpStageGrid(g, sh, "after_extend_ER_and_before_connect_outer.ugx", true);
 			UG_LOGN("Size of outvertsInner: " << outVertsInner.size());
 			std::vector<std::vector<ug::Vertex*> > outVertsInnerClean;
 			for (size_t i = 0; i < outVertsInner.size() / 4; i++) {
@@ -4480,10 +4489,10 @@ void test_import_swc_general_var(
 			//connect_er_with_er(newSomaIndex+2*numQuads-1, g, aaPos, sh, outVertsInnerClean, 2*numQuads-1, false, false);
 			/// TODO: this method gives wrong result for merging at soma (last parameter: true not false)
 			///connect_er_with_er(newSomaIndex, g, aaPos, sh, outVertsInnerClean, 2*numQuads+1, true, true);
-			SavePreparedGridToFile(g, sh, "before_connect_er_with_er.ugx");
+			DumpStageGrid(g, sh, "before_connect_er_with_er.ugx", true);
 			connect_polys(newSomaIndex-numQuads, g, aaPos, sh, outVertsInnerClean, true, 2*numQuads+1, false); // was 4 instead of numQuads
 			/// TODO: there are 4 less subsets because we assign now correctly to the correct subsets before...
-			SavePreparedGridToFile(g, sh, "after_connect_er_with_er.ugx");
+			DumpStageGrid(g, sh, "after_connect_er_with_er.ugx", true);
 		}
 	}
 
@@ -4495,14 +4504,14 @@ void test_import_swc_general_var(
 		SelectSubset(sel, sh, newSomaIndex-numQuads+i, true); /// these go to PM subset! (was 4 instead of numQuads)
 	}
 	AssignSelectionToSubset(sel, sh, 2); /// Connecting surface polygons need to belong to neurite start...
-	SavePreparedGridToFile(g, sh, "after_connect_er_with_er_before_reassignment.ugx");
+	DumpStageGrid(g, sh, "after_connect_er_with_er_before_reassignment.ugx", true);
 	/*
 		SelectSubset(sel, sh, newSomaIndex, true);
 		AssignSelectionToSubset(sel, sh, 3); /// inner soma surfaces goes to ERM
 		sel.clear();
 		SelectSubset(sel, sh, 4, true);
 		AssignSelectionToSubset(sel, sh, 2); // soma surface goes to PM
-		SavePreparedGridToFile(g, sh, "after_connect_er_with_er_before_reassignment.ugx");
+		DumpStageGrid(g, sh, "after_connect_er_with_er_before_reassignment.ugx", true);
 
 		Tetrahedralize(g, sh, 20, false, true, aPosition, 10);
 		SavePreparedGridToFile(g, sh, "after_new_tetrahedralize.ugx");
@@ -4523,7 +4532,7 @@ void test_import_swc_general_var(
 	/// Could be removed earlier since they are not responsible for -1 parent face normals
 	g.erase(sh.begin<Vertex>(sh.num_subsets()-1), sh.end<Vertex>(sh.num_subsets()-1));
 	g.erase(sh.begin<Vertex>(sh.num_subsets()-2), sh.end<Vertex>(sh.num_subsets()-2));
-	SavePreparedGridToFile(g, sh, "before_tetrahedralize_and_after_reassigned.ugx");
+	DumpStageGrid(g, sh, "before_tetrahedralize_and_after_reassigned.ugx", true);
 
 	/// assign correct axial parameters for "somata" regions (TODO: Verify to be correct!)
 	set_somata_mapping_parameters(g, sh, aaMapping, 4, 5, somaPoint.front());
@@ -4552,12 +4561,12 @@ void test_import_swc_general_var(
 		SelectSubset(sel, sh, 0, true);
 		EraseSelectedObjects(sel);
 		sh.erase_subset(lastSI); sh.erase_subset(3); sh.erase_subset(1); sh.erase_subset(0);
-		SaveGridToFile(g, sh, "after_selecting_boundary_elements.ugx");
+		DumpStageGrid(g, sh, "after_selecting_boundary_elements.ugx");
 		Triangulate(g, g.begin<ug::Quadrilateral>(), g.end<ug::Quadrilateral>());
 		/// apply a hint of laplacian smoothin for soma region
 		LaplacianSmooth(g, sh.begin<Vertex>(1), sh.end<Vertex>(1), aaPos, 0.1, 10);
 		FixFaceOrientation(g, g.faces_begin(), g.faces_end());
-		SaveGridToFile(g, sh, "after_selecting_boundary_elements_tris.ugx");
+		DumpStageGrid(g, sh, "after_selecting_boundary_elements_tris.ugx");
 		/// Use to warn if triangles intersect and correct triangle intersections
 		RemoveDoubles<3>(g, g.begin<Vertex>(), g.end<Vertex>(), aPosition, SMALL);
 		ResolveTriangleIntersections(g, g.begin<Triangle>(), g.end<Triangle>(), 0.1, aPosition);
@@ -4641,8 +4650,9 @@ void test_import_swc_general_var(
 	/// TODO: 1) Do not asign to one subset all elements from interior o soma
 	///       2) Call tetgen and preserve all boundaries and outer
 	///       3) Since ER volumina protrusing in soma sphere are also filled with tetrahedrons, remove these volumina
+	stages.begin("tetrahedralization");
 	tetrahedralize_soma(g, sh, aaPos, aaSurfParams, 4, 5, savedSomaPoint);
-	SavePreparedGridToFile(g, sh, "after_tetrahedralize_and_before_reassign_volumes.ugx");
+	DumpStageGrid(g, sh, "after_tetrahedralize_and_before_reassign_volumes.ugx", true);
 
 	/// reassign soma volumes to appropriate subsets
 	reassign_volumes(g, sh, 4, 5, erScaleFactor, savedSomaPoint[0], aaPos);
@@ -4652,15 +4662,15 @@ void test_import_swc_general_var(
 
 	UG_LOGN("After tetrahedralize");
 
-	SavePreparedGridToFile(g, sh, "after_tetrahedralize_soma.ugx");
+	DumpStageGrid(g, sh, "after_tetrahedralize_soma.ugx", true);
 	/// After merge doubles might occur, delete them. Boundary faces are retained,
 	/// however triangles occur now at boundary interface and quadrilaterals, thus
 	/// delete the triangles to keep the quadrilaterals from the start of neurites
 	RemoveDoubles<3>(g, g.begin<Vertex>(), g.end<Vertex>(), aaPos, 0.00001);
-	SavePreparedGridToFile(g, sh, "after_tetrahedralize_soma_and_removed_doubles.ugx");
+	DumpStageGrid(g, sh, "after_tetrahedralize_soma_and_removed_doubles.ugx", true);
 	DeleteInnerEdgesFromQuadrilaterals(g, sh, 4);
 	DeleteInnerEdgesFromQuadrilaterals(g, sh, 1);
-	SavePreparedGridToFile(g, sh, "after_tetrahedralize_soma_and_conversion.ugx");
+	DumpStageGrid(g, sh, "after_tetrahedralize_soma_and_conversion.ugx", true);
 
 	for (int i = 0; i <= sh.num_subsets(); i++) {
 		for (VertexIterator iter = sh.begin<Vertex>(i); iter != sh.end<Vertex>(i); iter++) {
@@ -4670,6 +4680,7 @@ void test_import_swc_general_var(
 
 	// at branching points, we have not computed the correct positions yet,
 	// so project the complete geometry using the projector
+	stages.begin("projection");
 	VertexIterator vit = g.begin<Vertex>();
 	VertexIterator vit_end = g.end<Vertex>();
 	for (; vit != vit_end; ++vit) {
@@ -4683,7 +4694,7 @@ void test_import_swc_general_var(
 	}
 
 
-	IF_DEBUG(NC_TNP, 0) SaveGridToFile(g, sh, "testNeuriteProjector_after_adding_neurites_and_connecting_all.ugx");
+	// final (tetrahedralized and projected) grid
 	SaveGridToFile(g, sh, "testNeuriteProjector_after_adding_neurites_and_connecting_all.ugx");
 }
 
@@ -39,8 +39,12 @@
 
 #include <vector>
 #include <sstream>
+#include <map>
+#include <set>
+#include <algorithm>
 #include "tetrahedralize_util.h"
 #include <lib_grid/algorithms/grid_generation/tetrahedralization.h>
+#include "../util/aabb_hash.h"
 
 #ifdef UG_TETGEN
 	#include "tetgen.h"
@@ -50,6 +54,108 @@ using namespace std;
 
 namespace ug {
 	namespace neuro_collection {
+		namespace {
+			/// whether tetrahedralize_soma splits into sub-volumes
+			bool g_tetrahedralizeSubVolumes = false;
+		}
+
+		#ifdef UG_TETGEN
+		namespace {
+			/// tetgen in- and output of one sub-volume
+			struct SubVolumeJob {
+				tetgenio in, out;
+				std::vector<Vertex*> vVrts; ///< input vertex of each tetgen point
+				int errCode;
+				bool failed;
+				SubVolumeJob() : errCode(0), failed(false) {}
+			};
+
+			////////////////////////////////////////////////////////////////////
+			/// find_root
+			////////////////////////////////////////////////////////////////////
+			size_t find_root(std::vector<size_t>& vParent, size_t i) {
+				while (vParent[i] != i) {
+					vParent[i] = vParent[vParent[i]];
+					i = vParent[i];
+				}
+				return i;
+			}
+
+			////////////////////////////////////////////////////////////////////
+			/// unite
+			////////////////////////////////////////////////////////////////////
+			void unite(std::vector<size_t>& vParent, size_t i, size_t j) {
+				i = find_root(vParent, i);
+				j = find_root(vParent, j);
+				if (i != j) {
+					vParent[std::max(i, j)] = std::min(i, j);
+				}
+			}
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// prepare_surface_selection
+		////////////////////////////////////////////////////////////////////////
+		static void prepare_surface_selection
+		(
+			Selector& sel,
+			Grid& grid,
+			Grid::VertexAttachmentAccessor<APosition>& aaPos
+		) {
+			if (sel.num<Quadrilateral>() > 0) {
+				Triangulate(grid, sel.begin<Quadrilateral>(), sel.end<Quadrilateral>(), &aaPos);
+			}
+
+			if(sel.num<Edge>() > 0 || sel.num<Face>() > 0) {
+				size_t numVrtsRemoved = 0;
+				for (VertexIterator iter = sel.begin<Vertex>();
+						iter != sel.end<Vertex>();)
+				{
+					Vertex* v = *iter;
+					++iter;
+					if ((NumAssociatedEdges(grid, v) == 0) ||
+						(NumAssociatedFaces(grid, v) == 0))
+					{
+						grid.erase(v);
+						++numVrtsRemoved;
+					}
+				}
+
+				UG_COND_LOGN(numVrtsRemoved, "WARNING in Tetrahedralize: Removed " <<
+						numVrtsRemoved << " vertices which were not connected to any "
+						<< "edge or face.");
+			}
+
+			RemoveDuplicates(grid, sel.begin<Face>(), sel.end<Face>());
+		}
+
+		////////////////////////////////////////////////////////////////////////
+		/// tetgen_params
+		////////////////////////////////////////////////////////////////////////
+		static std::string tetgen_params
+		(
+			Grid& grid,
+			number quality,
+			bool preserveBnds,
+			bool preserveAll,
+			int verbosity
+		) {
+			stringstream ss;
+			ss << VerbosityToTetgenParam(verbosity);
+			if(grid.num_faces() > 0){
+				ss << "p";
+				if(quality > SMALL)
+					ss << "qq" << quality;
+				if(preserveBnds || preserveAll)
+					ss << "Y";
+				if(preserveAll)
+					ss << "Y";	// if inner bnds shall be preserved "YY" has to be passed to tetgen
+			}
+			ss << "Q";//"Q";
+			return ss.str();
+		}
+		#endif
+
         ////////////////////////////////////////////////////////////////////////
         /// Tetrahedralize
         ////////////////////////////////////////////////////////////////////////
@@ -69,31 +175,7 @@ namespace ug {
 				UG_COND_THROW(!grid.has_vertex_attachment(aPos), "Grid has no position attachment.");
 				Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPos);
 
-				if (sel.num<Quadrilateral>() > 0) {
-					Triangulate(grid, sel.begin<Quadrilateral>(), sel.end<Quadrilateral>(), &aaPos);
-				}
-
-				if(sel.num<Edge>() > 0 || sel.num<Face>() > 0) {
-					size_t numVrtsRemoved = 0;
-					for (VertexIterator iter = sel.begin<Vertex>();
-							iter != sel.end<Vertex>();)
-					{
-						Vertex* v = *iter;
-						++iter;
-						if ((NumAssociatedEdges(grid, v) == 0) ||
-							(NumAssociatedFaces(grid, v) == 0))
-						{
-							grid.erase(v);
-							++numVrtsRemoved;
-						}
-					}
-
-					UG_COND_LOGN(numVrtsRemoved, "WARNING in Tetrahedralize: Removed " <<
-							numVrtsRemoved << " vertices which were not connected to any "
-							<< "edge or face.");
-				}
-
-				RemoveDuplicates(grid, sel.begin<Face>(), sel.end<Face>());
+				prepare_surface_selection(sel, grid, aaPos);
 
 				//	attach an index to the vertices
 				AInt aInd;
@@ -166,19 +248,8 @@ namespace ug {
 
 				//	call tetrahedralization
 				try {
-					stringstream ss;
-					ss << VerbosityToTetgenParam(verbosity);
-					if(grid.num_faces() > 0){
-						ss << "p";
-						if(quality > SMALL)
-							ss << "qq" << quality;
-						if(preserveBnds || preserveAll)
-							ss << "Y";
-						if(preserveAll)
-							ss << "Y";	// if inner bnds shall be preserved "YY" has to be passed to tetgen
-					}
-					ss << "Q";//"Q";
-					tetrahedralize(const_cast<char*>(ss.str().c_str()), &in, &out);
+					const std::string params = tetgen_params(grid, quality, preserveBnds, preserveAll, verbosity);
+					tetrahedralize(const_cast<char*>(params.c_str()), &in, &out);
 				}
 				catch (int errCode) {
 					UG_LOGN("  aborting tetrahedralization. Received error: " << errCode);
@@ -252,5 +323,395 @@ namespace ug {
 				return false;
 		#endif
 		}
+
+        ////////////////////////////////////////////////////////////////////////
+        /// TetrahedralizeSubVolumes
+        ////////////////////////////////////////////////////////////////////////
+		bool TetrahedralizeSubVolumes
+		(
+			Selector& sel,
+			Grid& grid,
+			ISubsetHandler* pSH,
+			const std::vector<int>& vSeparatorSubsets,
+			number quality,
+			bool preserveAll,
+			APosition& aPos,
+			int verbosity
+		)
+		{
+			#ifdef UG_TETGEN
+				UG_COND_THROW(!grid.has_vertex_attachment(aPos), "Grid has no position attachment.");
+				UG_COND_THROW(!vSeparatorSubsets.empty() && !pSH,
+					"Separator subsets require a subset handler.");
+				Grid::VertexAttachmentAccessor<APosition> aaPos(grid, aPos);
+
+				prepare_surface_selection(sel, grid, aaPos);
+
+				/// selected faces and whether they separate sub-volumes
+				const std::vector<Face*> vFaces(sel.faces_begin(), sel.faces_end());
+				const size_t numFaces = vFaces.size();
+				std::vector<bool> vIsSep(numFaces, false);
+				if (pSH) {
+					for (size_t i = 0; i < numFaces; ++i) {
+						vIsSep[i] = std::find(vSeparatorSubsets.begin(), vSeparatorSubsets.end(),
+							pSH->get_subset_index(vFaces[i])) != vSeparatorSubsets.end();
+					}
+				}
+
+				/// faces around each edge (edges need not exist in the grid)
+				typedef std::pair<Vertex*, Vertex*> edge_key;
+				typedef std::map<edge_key, std::vector<size_t> > edge_map;
+				edge_map mEdgeFaces;
+				for (size_t i = 0; i < numFaces; ++i) {
+					Face* f = vFaces[i];
+					const size_t numVrts = f->num_vertices();
+					for (size_t k = 0; k < numVrts; ++k) {
+						Vertex* v0 = f->vertex(k);
+						Vertex* v1 = f->vertex((k + 1) % numVrts);
+						if (v1 < v0) {std::swap(v0, v1);}
+						mEdgeFaces[edge_key(v0, v1)].push_back(i);
+					}
+				}
+
+				/// surface patches: separator faces are connected among each other,
+				/// other faces only across edges which do not touch a separator
+				std::vector<size_t> vParent(numFaces);
+				for (size_t i = 0; i < numFaces; ++i) {vParent[i] = i;}
+				for (edge_map::const_iterator it = mEdgeFaces.begin(); it != mEdgeFaces.end(); ++it) {
+					const std::vector<size_t>& vf = it->second;
+					bool touchesSep = false;
+					for (size_t k = 0; k < vf.size(); ++k) {
+						if (vIsSep[vf[k]]) {touchesSep = true;}
+					}
+					for (size_t k = 1; k < vf.size(); ++k) {
+						for (size_t l = 0; l < k; ++l) {
+							if (vIsSep[vf[k]] != vIsSep[vf[l]]) {continue;}
+							if (vIsSep[vf[k]] || !touchesSep) {unite(vParent, vf[k], vf[l]);}
+						}
+					}
+				}
+
+				std::vector<size_t> vPatch(numFaces);
+				std::map<size_t, size_t> mRootToPatch;
+				std::vector<bool> vIsSepPatch;
+				for (size_t i = 0; i < numFaces; ++i) {
+					const size_t root = find_root(vParent, i);
+					std::map<size_t, size_t>::iterator pit = mRootToPatch.find(root);
+					if (pit == mRootToPatch.end()) {
+						pit = mRootToPatch.insert(std::make_pair(root, vIsSepPatch.size())).first;
+						vIsSepPatch.push_back(vIsSep[i]);
+					}
+					vPatch[i] = pit->second;
+				}
+				const size_t numPatches = vIsSepPatch.size();
+
+				/// patches bounding the sub-volume on the other side of each separator
+				std::vector<std::set<size_t> > vSepNeighbors(numPatches);
+				for (edge_map::const_iterator it = mEdgeFaces.begin(); it != mEdgeFaces.end(); ++it) {
+					const std::vector<size_t>& vf = it->second;
+					for (size_t k = 0; k < vf.size(); ++k) {
+						if (!vIsSep[vf[k]]) {continue;}
+						for (size_t l = 0; l < vf.size(); ++l) {
+							if (!vIsSep[vf[l]]) {vSepNeighbors[vPatch[vf[k]]].insert(vPatch[vf[l]]);}
+						}
+					}
+				}
+
+				/// sub-volume seeds are all non-separator patches and closed separator patches
+				std::vector<bool> vIsSeed(numPatches);
+				for (size_t p = 0; p < numPatches; ++p) {
+					vIsSeed[p] = !vIsSepPatch[p] || vSepNeighbors[p].empty();
+				}
+
+				/// seeds adjacent via a separator never have to be merged
+				std::set<std::pair<size_t, size_t> > sSepAdjacent;
+				for (size_t p = 0; p < numPatches; ++p) {
+					std::set<size_t>::const_iterator a, b;
+					for (a = vSepNeighbors[p].begin(); a != vSepNeighbors[p].end(); ++a) {
+						for (b = a, ++b; b != vSepNeighbors[p].end(); ++b) {
+							sSepAdjacent.insert(std::make_pair(*a, *b));
+						}
+					}
+				}
+
+				/// seeds touching in a vertex which is not on a separator are merged
+				std::vector<size_t> vSeedParent(numPatches);
+				for (size_t p = 0; p < numPatches; ++p) {vSeedParent[p] = p;}
+				{
+					std::map<Vertex*, std::vector<size_t> > mVrtPatches;
+					for (size_t i = 0; i < numFaces; ++i) {
+						for (size_t k = 0; k < vFaces[i]->num_vertices(); ++k) {
+							mVrtPatches[vFaces[i]->vertex(k)].push_back(vPatch[i]);
+						}
+					}
+					std::map<Vertex*, std::vector<size_t> >::const_iterator it;
+					for (it = mVrtPatches.begin(); it != mVrtPatches.end(); ++it) {
+						const std::vector<size_t>& vp = it->second;
+						bool onSep = false;
+						for (size_t k = 0; k < vp.size(); ++k) {
+							if (vIsSepPatch[vp[k]]) {onSep = true;}
+						}
+						if (onSep) {continue;}
+						for (size_t k = 1; k < vp.size(); ++k) {unite(vSeedParent, vp[0], vp[k]);}
+					}
+				}
+
+				/// bounding boxes of the seeds including their separators
+				std::vector<vector3> vLo(numPatches), vHi(numPatches);
+				std::vector<bool> vHasBox(numPatches, false);
+				for (size_t i = 0; i < numFaces; ++i) {
+					const size_t p = vPatch[i];
+					std::vector<size_t> vTargets;
+					if (vIsSeed[p]) {vTargets.push_back(p);}
+					else {vTargets.assign(vSepNeighbors[p].begin(), vSepNeighbors[p].end());}
+					for (size_t t = 0; t < vTargets.size(); ++t) {
+						const size_t q = vTargets[t];
+						for (size_t k = 0; k < vFaces[i]->num_vertices(); ++k) {
+							const vector3& x = aaPos[vFaces[i]->vertex(k)];
+							if (!vHasBox[q]) {vLo[q] = x; vHi[q] = x; vHasBox[q] = true; continue;}
+							for (size_t d = 0; d < 3; ++d) {
+								vLo[q][d] = std::min(vLo[q][d], x[d]);
+								vHi[q][d] = std::max(vHi[q][d], x[d]);
+							}
+						}
+					}
+				}
+
+				/// seeds with overlapping bounding boxes may be nested: merge them
+				/// unless they are known to be adjacent across a separator
+				{
+					std::vector<size_t> vSeeds;
+					AABBHash<3> hash;
+					for (size_t p = 0; p < numPatches; ++p) {
+						if (!vIsSeed[p]) {continue;}
+						vSeeds.push_back(p);
+						hash.add_box(vLo[p], vHi[p]);
+					}
+					hash.build();
+					std::vector<std::pair<size_t, size_t> > vCandidates;
+					hash.overlapping_pairs(vCandidates);
+					for (size_t k = 0; k < vCandidates.size(); ++k) {
+						const size_t a = vSeeds[vCandidates[k].first];
+						const size_t b = vSeeds[vCandidates[k].second];
+						if (sSepAdjacent.find(std::make_pair(std::min(a, b), std::max(a, b)))
+							== sSepAdjacent.end())
+						{
+							unite(vSeedParent, a, b);
+						}
+					}
+				}
+
+				/// faces of each sub-volume, separators belong to all adjacent ones
+				std::map<size_t, size_t> mRootToVolume;
+				for (size_t p = 0; p < numPatches; ++p) {
+					if (!vIsSeed[p]) {continue;}
+					const size_t root = find_root(vSeedParent, p);
+					if (mRootToVolume.find(root) == mRootToVolume.end()) {
+						const size_t id = mRootToVolume.size();
+						mRootToVolume[root] = id;
+					}
+				}
+				const size_t numVolumes = mRootToVolume.size();
+				if (numVolumes < 2) {
+					return Tetrahedralize(sel, grid, pSH, quality, true, preserveAll, aPos, verbosity);
+				}
+				UG_LOGN("  tetrahedralizing " << numVolumes << " sub-volumes");
+
+				std::vector<std::vector<Face*> > vVolumeFaces(numVolumes);
+				for (size_t i = 0; i < numFaces; ++i) {
+					const size_t p = vPatch[i];
+					std::set<size_t> sVolumes;
+					if (vIsSeed[p]) {
+						sVolumes.insert(mRootToVolume[find_root(vSeedParent, p)]);
+					} else {
+						std::set<size_t>::const_iterator it;
+						for (it = vSepNeighbors[p].begin(); it != vSepNeighbors[p].end(); ++it) {
+							sVolumes.insert(mRootToVolume[find_root(vSeedParent, *it)]);
+						}
+					}
+					for (std::set<size_t>::const_iterator it = sVolumes.begin(); it != sVolumes.end(); ++it) {
+						vVolumeFaces[*it].push_back(vFaces[i]);
+					}
+				}
+
+				//	setup the tetgen input of each sub-volume
+				std::vector<SubVolumeJob*> vJobs(numVolumes);
+				AInt aInd;
+				grid.attach_to_vertices_dv(aInd, -1);
+				Grid::VertexAttachmentAccessor<AInt> aaInd(grid, aInd);
+				for (size_t g = 0; g < numVolumes; ++g) {
+					SubVolumeJob* job = vJobs[g] = new SubVolumeJob;
+					const std::vector<Face*>& vf = vVolumeFaces[g];
+					for (size_t i = 0; i < vf.size(); ++i) {
+						for (size_t k = 0; k < vf[i]->num_vertices(); ++k) {
+							Vertex* v = vf[i]->vertex(k);
+							if (aaInd[v] < 0) {
+								aaInd[v] = (int) job->vVrts.size();
+								job->vVrts.push_back(v);
+							}
+						}
+					}
+
+					tetgenio& in = job->in;
+					in.numberofpoints = (int) job->vVrts.size();
+					in.pointlist = new REAL[in.numberofpoints*3];
+					for (int i = 0; i < in.numberofpoints; ++i) {
+						// float cast, see Tetrahedralize
+						const vector3& v = aaPos[job->vVrts[i]];
+						in.pointlist[i * 3] = (float)v.x();
+						in.pointlist[i * 3 + 1] = (float)v.y();
+						in.pointlist[i * 3 + 2] = (float)v.z();
+					}
+
+					in.numberoffacets = (int) vf.size();
+					in.facetlist = new tetgenio::facet[in.numberoffacets];
+					in.facetmarkerlist = new int[in.numberoffacets];
+					for (int i = 0; i < in.numberoffacets; ++i) {
+						tetgenio::facet* tf = &in.facetlist[i];
+						tf->numberofpolygons = 1;
+						tf->polygonlist = new tetgenio::polygon[tf->numberofpolygons];
+						tf->numberofholes = 0;
+						tf->holelist = NULL;
+						tetgenio::polygon* p = &tf->polygonlist[0];
+						p->numberofvertices = vf[i]->num_vertices();
+						p->vertexlist = new int[p->numberofvertices];
+						for (int k = 0; k < p->numberofvertices; ++k)
+							p->vertexlist[k] = aaInd[vf[i]->vertex(k)];
+						in.facetmarkerlist[i] = pSH ? pSH->get_subset_index(vf[i]) : 0;
+					}
+
+					for (size_t i = 0; i < job->vVrts.size(); ++i) {aaInd[job->vVrts[i]] = -1;}
+				}
+				grid.detach_from_vertices(aInd);
+				aaInd.invalidate();
+
+				//	call tetrahedralization concurrently, boundaries have to be
+				//	preserved such that the sub-volumes match at their separators
+				const std::string params = tetgen_params(grid, quality, true, preserveAll, verbosity);
+			#ifdef _OPENMP
+				#pragma omp parallel for schedule(dynamic)
+			#endif
+				for (long g = 0; g < (long) numVolumes; ++g) {
+					std::vector<char> vParams(params.begin(), params.end());
+					vParams.push_back('\0');
+					try {
+						tetrahedralize(&vParams[0], &vJobs[g]->in, &vJobs[g]->out);
+					}
+					catch (int errCode) {
+						vJobs[g]->failed = true;
+						vJobs[g]->errCode = errCode;
+					}
+				}
+
+				bool failed = false;
+				for (size_t g = 0; g < numVolumes; ++g) {
+					if (vJobs[g]->failed) {
+						UG_LOGN("  aborting tetrahedralization of sub-volume " << g
+							<< ". Received error: " << vJobs[g]->errCode);
+						failed = true;
+					}
+				}
+				if (failed) {
+					for (size_t g = 0; g < numVolumes; ++g) {delete vJobs[g];}
+					return false;
+				}
+
+				//	update the old vertices and add the new ones of each sub-volume
+				std::vector<std::vector<Vertex*> > vOutVrts(numVolumes);
+				for (size_t g = 0; g < numVolumes; ++g) {
+					const tetgenio& out = vJobs[g]->out;
+					const std::vector<Vertex*>& vInVrts = vJobs[g]->vVrts;
+					std::vector<Vertex*>& vVrts = vOutVrts[g];
+					vVrts.resize(out.numberofpoints);
+					UG_COND_LOGN(out.numberofpoints < (int) vInVrts.size(),
+						"	WARNING: Unused points may remain!");
+					int counter = 0;
+					for (; counter < std::min(out.numberofpoints, (int) vInVrts.size()); ++counter) {
+						Vertex* v = vInVrts[counter];
+						aaPos[v].x() = out.pointlist[counter*3];
+						aaPos[v].y() = out.pointlist[counter*3+1];
+						aaPos[v].z() = out.pointlist[counter*3+2];
+						vVrts[counter] = v;
+					}
+					for(; counter < out.numberofpoints; ++counter) {
+						RegularVertex* v = *grid.create<RegularVertex>();
+						aaPos[v].x() = out.pointlist[counter*3];
+						aaPos[v].y() = out.pointlist[counter*3+1];
+						aaPos[v].z() = out.pointlist[counter*3+2];
+						vVrts[counter] = v;
+					}
+				}
+
+				//	erase edges if boundary segments were not preserved
+				if(!preserveAll){
+					grid.erase(sel.begin<Edge>(), sel.end<Edge>());
+				}
+
+				//	add new faces, separator faces are part of several sub-volumes
+				grid.erase(sel.begin<Face>(), sel.end<Face>());
+				typedef std::pair<Vertex*, std::pair<Vertex*, Vertex*> > tri_key;
+				std::set<tri_key> sCreatedTris;
+				bool filled = true;
+				for (size_t g = 0; g < numVolumes; ++g) {
+					const tetgenio& out = vJobs[g]->out;
+					const std::vector<Vertex*>& vVrts = vOutVrts[g];
+					for (int i = 0; i < out.numberoftrifaces; ++i)
+					{
+						Vertex* v[3] = {vVrts[out.trifacelist[i*3]],
+										vVrts[out.trifacelist[i*3 + 1]],
+										vVrts[out.trifacelist[i*3 + 2]]};
+						Vertex* s[3] = {v[0], v[1], v[2]};
+						std::sort(s, s + 3);
+						if (!sCreatedTris.insert(tri_key(s[0], std::make_pair(s[1], s[2]))).second)
+							continue;
+
+						Triangle* tri = *grid.create<Triangle>(TriangleDescriptor(v[0], v[1], v[2]));
+						if(pSH && out.trifacemarkerlist)
+							pSH->assign_subset(tri, out.trifacemarkerlist[i]);
+					}
+
+					if(out.numberoftetrahedra < 1) {
+						filled = false;
+						continue;
+					}
+
+					//	add new volumes
+					for (int i = 0; i < out.numberoftetrahedra; ++i)
+					{
+						Tetrahedron* tet = *grid.create<Tetrahedron>(
+									TetrahedronDescriptor(vVrts[out.tetrahedronlist[i*4]],
+															vVrts[out.tetrahedronlist[i*4 + 1]],
+															vVrts[out.tetrahedronlist[i*4 + 2]],
+															vVrts[out.tetrahedronlist[i*4 + 3]]));
+						if(pSH)
+							pSH->assign_subset(tet, 0);
+					}
+				}
+
+				for (size_t g = 0; g < numVolumes; ++g) {delete vJobs[g];}
+				return filled;
+		#else
+				UG_THROW("\nPerformTetrahedralization: Tetgen is not available in the "
+						"current build.\nRecompile with Tetgen support to use tetrahedralization.\n");
+				return false;
+		#endif
+		}
+
+        ////////////////////////////////////////////////////////////////////////
+        /// SetTetrahedralizeSubVolumes
+        ////////////////////////////////////////////////////////////////////////
+		void SetTetrahedralizeSubVolumes
+		(
+			bool enable
+		) {
+			g_tetrahedralizeSubVolumes = enable;
+		}
+
+        ////////////////////////////////////////////////////////////////////////
+        /// TetrahedralizeSubVolumesEnabled
+        ////////////////////////////////////////////////////////////////////////
+		bool TetrahedralizeSubVolumesEnabled() {
+			return g_tetrahedralizeSubVolumes;
+		}
 	}
 }
@@ -42,6 +42,7 @@
 
 #include <lib_grid/algorithms/geom_obj_util/geom_obj_util.h>
 #include <lib_grid/algorithms/remove_duplicates_util.h>
+#include <vector>
 
 namespace ug {
 	namespace neuro_collection {
@@ -75,6 +76,55 @@ namespace ug {
 		    APosition& aPos = aPosition,
 		    int verbosity = 0
 		);
+
+		/*!
+		* \brief Fills a closed surface-grid selection with tetrahedrons, one
+		* TetGen call per independent sub-volume
+		* The selected faces are split into sub-volumes at the faces of the
+		* given separator subsets: A separator region (e.g. the cap between
+		* soma and a neurite) bounds every sub-volume adjacent to it.
+		* Sub-volumes which do not share a separator region but touch or whose
+		* bounding boxes overlap (nested surfaces, e.g. the ER inside the soma)
+		* are kept together. The sub-volumes are tetrahedralized concurrently
+		* (if OpenMP is available) with preserved boundaries and are stitched
+		* together along the common separator faces. If there is only one
+		* sub-volume, this is the same as Tetrahedralize.
+		*
+		* \param[in] sel
+		* \param[in,out] grid
+		* \param[in,out] sh
+		* \param[in] vSeparatorSubsets  subset indices of the separating faces
+		* \param[in] quality            see Tetrahedralize
+		* \param[in] preserveAll        bool to specify if inner boundaries shall be preserved
+		* \param[in] aPos
+		* \param[in] verbosity	       number between 0 and 3 to specify level of verbosity
+		*/
+		bool TetrahedralizeSubVolumes
+		(
+			Selector& sel,
+			Grid& grid,
+			ISubsetHandler* SH,
+			const std::vector<int>& vSeparatorSubsets,
+		    number quality = 5,
+		    bool preserveAll = false,
+		    APosition& aPos = aPosition,
+		    int verbosity = 0
+		);
+
+		/*!
+		* \brief enables sub-volume tetrahedralization in the grid generation
+		* If enabled, tetrahedralize_soma uses TetrahedralizeSubVolumes
+		* instead of a single Tetrahedralize call (default: disabled).
+		*/
+		void SetTetrahedralizeSubVolumes
+		(
+			bool enable
+		);
+
+		/*!
+		* \brief whether sub-volume tetrahedralization is enabled
+		*/
+		bool TetrahedralizeSubVolumesEnabled();
 	}
 }
 #endif // UG__PLUIGNS___NEURO_COLLECTION_TEST__TETRAHEDRALIZE_UTIL_H
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+/*
+ * Grid generation benchmark (build target NCBenchmark)
+ *
+ * Usage: NCBenchmark <suite file> [<json output file>]
+ * The suite file format is described in test/grid_generation_benchmark.h.
+ * The exit code is the number of failed cases (capped at 255).
+ */
+
+#include <iostream>
+#include <string>
+
+#include "ug.h"
+#include "common/error.h"
+#include "common/math/ugmath.h"
+#include "lib_grid/global_attachments.h"
+#include "lib_grid/refinement/projectors/neurite_projector.h"
+
+#include "../test/grid_generation_benchmark.h"
+
+using namespace ug;
+using namespace ug::neuro_collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// declare_attachments: global attachments used by the grid generation
+////////////////////////////////////////////////////////////////////////////////
+static void declare_attachments() {
+	if (!GlobalAttachments::is_declared("npSurfParams")) {
+		GlobalAttachments::declare_attachment<Attachment<NeuriteProjector::SurfaceParams> >("npSurfParams", true);
+	}
+	if (!GlobalAttachments::is_declared("npMapping")) {
+		GlobalAttachments::declare_attachment<Attachment<NeuriteProjector::Mapping> >("npMapping", true);
+	}
+	if (!GlobalAttachments::is_declared("npNormals")) {
+		GlobalAttachments::declare_attachment<ANormal3>("npNormals", true);
+	}
+	if (!GlobalAttachments::is_declared("diameter")) {
+		GlobalAttachments::declare_attachment<ANumber>("diameter", true);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// main
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <suite file> [<json output file>]" << std::endl;
+		return 255;
+	}
+	const std::string suiteFile = argv[1];
+	const std::string jsonFile = argc > 2 ? argv[2] : "nc_benchmark.json";
+
+	UGInit(&argc, &argv);
+	int numFailed = 255;
+	try {
+		declare_attachments();
+		numFailed = RunGridGenerationBenchmark(suiteFile, jsonFile);
+	} catch (const UGError& err) {
+		std::cerr << "Benchmark aborted: " << err.get_msg() << std::endl;
+	}
+	UGFinalize();
+
+	return numFailed > 255 ? 255 : numFailed;
+}
@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+/*
+ * Membrane transporter flux kernel benchmark (build target NCFluxBenchmark)
+ *
+ * Usage: NCFluxBenchmark [<number of points>] [--reference <file> | --write-reference <file>]
+ *
+ * Every transport mechanism is driven over the same pseudo-random physiological
+ * input vectors (fixed seed), once point-wise (flux(), flux_deriv()) and once
+ * batched (flux_batch(), flux_deriv_batch()). Throughput is reported in points/s.
+ * Batched results are checked against point-wise results; with --reference, the
+ * results for the first points are checked against a reference file written
+ * before by --write-reference, so optimizations cannot change results unnoticed.
+ * The exit code is the number of failed checks (capped at 255).
+ *
+ * Not covered: RyRinstat and VDCC_BG, which keep their states in grid attachments
+ * and can therefore not be run without a grid.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ug.h"
+#include "common/error.h"
+#include "common/stopwatch.h"
+
+#include "../membrane_transporters/membrane_transporter_interface.h"
+#include "../membrane_transporters/pmca.h"
+#include "../membrane_transporters/ncx.h"
+#include "../membrane_transporters/serca.h"
+#include "../membrane_transporters/leak.h"
+#include "../membrane_transporters/fused_er_membrane.h"
+#include "../membrane_transporters/ip3r.h"
+#include "../membrane_transporters/ryr.h"
+#include "../membrane_transporters/mcu.h"
+#include "../membrane_transporters/mncx.h"
+#include "../membrane_transporters/nmdar.h"
+#include "../membrane_transporters/leakage_ohmic.h"
+
+using namespace ug;
+using namespace ug::neuro_collection;
+
+/// number of points per mechanism written to / checked against the reference file
+static const size_t numRefPoints = 32;
+
+/// relative tolerance for result comparisons
+static const number relTol = 1e-10;
+
+////////////////////////////////////////////////////////////////////////////////
+/// benchmark case: a mechanism and the ranges of its inputs
+////////////////////////////////////////////////////////////////////////////////
+struct FluxBenchmarkCase {
+	std::string name;
+	SmartPtr<IMembraneTransporter> mt;
+	std::vector<std::pair<number, number> > vRange;
+
+	FluxBenchmarkCase(const std::string& _name, SmartPtr<IMembraneTransporter> _mt)
+	: name(_name), mt(_mt) {}
+
+	FluxBenchmarkCase& range(number lo, number hi) {
+		vRange.push_back(std::make_pair(lo, hi));
+		return *this;
+	}
+};
+
+struct FluxBenchmarkResult {
+	number scalarPtsPerSec;
+	number scalarDerivPtsPerSec;
+	number batchPtsPerSec;
+	number batchDerivPtsPerSec;
+	std::vector<number> vFlux;   ///< point-wise fluxes, index k*nFlux + i
+	std::vector<number> vDeriv;  ///< point-wise derivatives, index (k*nFlux + i)*nDep + j
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// deterministic pseudo-random numbers in [0,1) (same sequence on all platforms)
+////////////////////////////////////////////////////////////////////////////////
+static number next_uniform(unsigned long& state) {
+	state = (state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+	return (number) state / 2147483648.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// the mechanisms and their input ranges (concentrations in mM, potentials in V)
+////////////////////////////////////////////////////////////////////////////////
+static void create_cases(std::vector<FluxBenchmarkCase>& vCase) {
+	const number caCytLo = 5e-5, caCytHi = 1e-3;
+
+	vCase.push_back(FluxBenchmarkCase("PMCA", make_sp(new PMCA("ca_cyt, ca_ext")))
+		.range(caCytLo, caCytHi).range(1.0, 2.0));
+	vCase.push_back(FluxBenchmarkCase("NCX", make_sp(new NCX("ca_cyt, ca_ext")))
+		.range(caCytLo, caCytHi).range(1.0, 2.0));
+	vCase.push_back(FluxBenchmarkCase("SERCA", make_sp(new SERCA("ca_cyt, ca_er")))
+		.range(caCytLo, caCytHi).range(0.1, 0.5));
+	vCase.push_back(FluxBenchmarkCase("Leak", make_sp(new Leak("ca_er, ca_cyt, phi_er, phi_cyt")))
+		.range(0.1, 0.5).range(caCytLo, caCytHi).range(-0.01, 0.01).range(-0.08, -0.05));
+	vCase.push_back(FluxBenchmarkCase("IP3R", make_sp(new IP3R("ca_cyt, ca_er, ip3")))
+		.range(caCytLo, caCytHi).range(0.1, 0.5).range(1e-4, 1e-3));
+	vCase.push_back(FluxBenchmarkCase("RyR", make_sp(new RyR("ca_cyt, ca_er")))
+		.range(caCytLo, caCytHi).range(0.1, 0.5));
+	SmartPtr<FusedERMembrane> erm = make_sp(new FusedERMembrane("ca_cyt, ca_er, ip3"));
+	erm->set_densities(1.973e15, 8.6e11, 1.73e13, 0.0);
+	erm->set_leak_to_equilibrium(5e-5, 0.25, 1e-4);
+	vCase.push_back(FluxBenchmarkCase("FusedERM", erm)
+		.range(caCytLo, caCytHi).range(0.1, 0.5).range(1e-4, 1e-3));
+	vCase.push_back(FluxBenchmarkCase("MCU", make_sp(new MCU("ca_cyt, ca_mit")))
+		.range(caCytLo, caCytHi).range(5e-5, 5e-4));
+	vCase.push_back(FluxBenchmarkCase("MNCX", make_sp(new MNCX("ca_cyt, ca_mit, na_cyt, na_mit")))
+		.range(caCytLo, caCytHi).range(5e-5, 5e-4).range(5.0, 15.0).range(3.0, 10.0));
+	vCase.push_back(FluxBenchmarkCase("NMDAR", make_sp(new NMDAR("ca_ext, ca_cyt")))
+		.range(1.0, 2.0).range(caCytLo, caCytHi));
+	vCase.push_back(FluxBenchmarkCase("OhmicLeakage", make_sp(new OhmicLeakage("phi_cyt, phi_ext")))
+		.range(-0.08, -0.05).range(-0.005, 0.005));
+
+	for (size_t c = 0; c < vCase.size(); ++c) {
+		IMembraneTransporter& mt = *vCase[c].mt;
+		mt.check_and_lock();
+		mt.prepare_threads();
+		mt.prepare_timestep(0.01, 0.0, NULL);
+		UG_COND_THROW(vCase[c].vRange.size() != mt.symb_fcts().size(),
+			vCase[c].name << ": " << vCase[c].vRange.size() << " input ranges given for "
+			<< mt.symb_fcts().size() << " functions.");
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// relative comparison
+////////////////////////////////////////////////////////////////////////////////
+static bool close_enough(number a, number b) {
+	const number scale = std::max(fabs(a), fabs(b));
+	return fabs(a - b) <= relTol * scale || scale < 1e-300;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// run one case; returns number of failed checks
+////////////////////////////////////////////////////////////////////////////////
+static int run_case(const FluxBenchmarkCase& bc, size_t nPts, FluxBenchmarkResult& res) {
+	const IMembraneTransporter& mt = *bc.mt;
+	const size_t nFct = bc.vRange.size();
+	const size_t nFlux = mt.n_fluxes();
+	const size_t nDep = mt.n_dependencies();
+
+	// inputs (structure-of-arrays for the batched path)
+	unsigned long seed = 4711;
+	std::vector<number> vU(nFct * nPts);
+	for (size_t k = 0; k < nPts; ++k)
+		for (size_t i = 0; i < nFct; ++i)
+			vU[i*nPts + k] = bc.vRange[i].first
+				+ next_uniform(seed) * (bc.vRange[i].second - bc.vRange[i].first);
+	std::vector<GridObject*> vElem(nPts, (GridObject*) NULL);
+
+	// point-wise fluxes
+	std::vector<number> u(nFct);
+	std::vector<number> flux(nFlux);
+	res.vFlux.resize(nPts * nFlux);
+	Stopwatch sw;
+	sw.start();
+	for (size_t k = 0; k < nPts; ++k) {
+		for (size_t i = 0; i < nFct; ++i)
+			u[i] = vU[i*nPts + k];
+		mt.flux(u, NULL, flux);
+		for (size_t i = 0; i < nFlux; ++i)
+			res.vFlux[k*nFlux + i] = flux[i];
+	}
+	res.scalarPtsPerSec = nPts / std::max(sw.ms() / 1000.0, 1e-9);
+
+	// point-wise derivatives (stored by supplied function index)
+	std::vector<std::vector<std::pair<size_t, number> > > fd(nFlux);
+	res.vDeriv.assign(nPts * nFlux * nFct, 0.0);
+	sw.start();
+	for (size_t k = 0; k < nPts; ++k) {
+		for (size_t i = 0; i < nFct; ++i)
+			u[i] = vU[i*nPts + k];
+		for (size_t i = 0; i < nFlux; ++i)
+			fd[i].assign(nDep, std::pair<size_t, number>(0, 0.0));
+		mt.flux_deriv(u, NULL, fd);
+		for (size_t i = 0; i < nFlux; ++i)
+			for (size_t j = 0; j < fd[i].size(); ++j)
+				res.vDeriv[(k*nFlux + i)*nFct + fd[i][j].first] += fd[i][j].second;
+	}
+	res.scalarDerivPtsPerSec = nPts / std::max(sw.ms() / 1000.0, 1e-9);
+
+	// batched fluxes
+	std::vector<number> vFluxBatch;
+	sw.start();
+	mt.flux_batch(vU, vElem, vFluxBatch);
+	res.batchPtsPerSec = nPts / std::max(sw.ms() / 1000.0, 1e-9);
+
+	// batched derivatives
+	std::vector<size_t> vDerivFct;
+	std::vector<number> vDerivBatch;
+	sw.start();
+	mt.flux_deriv_batch(vU, vElem, vDerivFct, vDerivBatch);
+	res.batchDerivPtsPerSec = nPts / std::max(sw.ms() / 1000.0, 1e-9);
+
+	// batched results must match point-wise results
+	int numFailed = 0;
+	for (size_t k = 0; k < nPts && !numFailed; ++k) {
+		for (size_t i = 0; i < nFlux; ++i) {
+			if (!close_enough(vFluxBatch[i*nPts + k], res.vFlux[k*nFlux + i])) {
+				std::cerr << bc.name << ": batched flux " << i << " at point " << k << " is "
+					<< vFluxBatch[i*nPts + k] << ", point-wise " << res.vFlux[k*nFlux + i] << std::endl;
+				++numFailed;
+				break;
+			}
+		}
+	}
+	std::vector<number> vDerivBatchByFct(nPts * nFlux * nFct, 0.0);
+	for (size_t i = 0; i < nFlux; ++i)
+		for (size_t j = 0; j < nDep; ++j)
+			for (size_t k = 0; k < nPts; ++k)
+				vDerivBatchByFct[(k*nFlux + i)*nFct + vDerivFct[i*nDep + j]] += vDerivBatch[(i*nDep + j)*nPts + k];
+	for (size_t n = 0; n < vDerivBatchByFct.size(); ++n) {
+		if (!close_enough(vDerivBatchByFct[n], res.vDeriv[n])) {
+			std::cerr << bc.name << ": batched flux derivative " << n << " is "
+				<< vDerivBatchByFct[n] << ", point-wise " << res.vDeriv[n] << std::endl;
+			++numFailed;
+			break;
+		}
+	}
+
+	return numFailed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// reference output: one line per mechanism with its first results
+////////////////////////////////////////////////////////////////////////////////
+static std::string reference_line(const FluxBenchmarkCase& bc, const FluxBenchmarkResult& res, size_t nFluxPts, size_t nDerivPts) {
+	std::ostringstream oss;
+	oss << std::setprecision(17) << bc.name;
+	for (size_t n = 0; n < nFluxPts; ++n)
+		oss << " " << res.vFlux[n];
+	for (size_t n = 0; n < nDerivPts; ++n)
+		oss << " " << res.vDeriv[n];
+	return oss.str();
+}
+
+static int check_reference_line(const std::string& line, const FluxBenchmarkCase& bc, const FluxBenchmarkResult& res, size_t nFluxPts, size_t nDerivPts) {
+	std::istringstream iss(line);
+	std::string name;
+	iss >> name;
+	if (name != bc.name) {
+		std::cerr << "Reference file: expected entry for " << bc.name << ", found '" << name << "'." << std::endl;
+		return 1;
+	}
+
+	for (size_t n = 0; n < nFluxPts + nDerivPts; ++n) {
+		number ref;
+		if (!(iss >> ref)) {
+			std::cerr << bc.name << ": reference entry too short." << std::endl;
+			return 1;
+		}
+		const number val = n < nFluxPts ? res.vFlux[n] : res.vDeriv[n - nFluxPts];
+		if (!close_enough(val, ref)) {
+			std::cerr << bc.name << ": result " << n << " is " << val << ", reference " << ref << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// main
+////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[]) {
+	size_t nPts = 100000;
+	std::string refFile;
+	bool writeRef = false;
+	for (int a = 1; a < argc; ++a) {
+		const std::string arg = argv[a];
+		if ((arg == "--reference" || arg == "--write-reference") && a + 1 < argc) {
+			writeRef = arg == "--write-reference";
+			refFile = argv[++a];
+		} else if (atol(argv[a]) > 0) {
+			nPts = (size_t) atol(argv[a]);
+		} else {
+			std::cerr << "Usage: " << argv[0]
+				<< " [<number of points>] [--reference <file> | --write-reference <file>]" << std::endl;
+			return 255;
+		}
+	}
+	const size_t nRef = std::min(nPts, numRefPoints);
+
+	UGInit(&argc, &argv);
+	int numFailed = 0;
+	try {
+		std::vector<FluxBenchmarkCase> vCase;
+		create_cases(vCase);
+
+		std::ifstream refIn;
+		std::ofstream refOut;
+		if (!refFile.empty()) {
+			if (writeRef)
+				refOut.open(refFile.c_str());
+			else
+				refIn.open(refFile.c_str());
+			UG_COND_THROW(!(writeRef ? refOut.is_open() : refIn.is_open()),
+				"Could not open reference file '" << refFile << "'.");
+		}
+
+		std::cout << std::left << std::setw(14) << "mechanism" << std::right
+			<< std::setw(16) << "flux pts/s" << std::setw(16) << "deriv pts/s"
+			<< std::setw(16) << "batch pts/s" << std::setw(16) << "batch d pts/s" << std::endl;
+		for (size_t c = 0; c < vCase.size(); ++c) {
+			FluxBenchmarkResult res;
+			numFailed += run_case(vCase[c], nPts, res);
+
+			std::cout << std::left << std::setw(14) << vCase[c].name << std::right << std::scientific
+				<< std::setprecision(3) << std::setw(16) << res.scalarPtsPerSec
+				<< std::setw(16) << res.scalarDerivPtsPerSec << std::setw(16) << res.batchPtsPerSec
+				<< std::setw(16) << res.batchDerivPtsPerSec << std::endl;
+
+			const size_t nFluxRef = nRef * vCase[c].mt->n_fluxes();
+			const size_t nDerivRef = nFluxRef * vCase[c].vRange.size();
+			if (refOut.is_open())
+				refOut << reference_line(vCase[c], res, nFluxRef, nDerivRef) << "\n";
+			else if (refIn.is_open()) {
+				std::string line;
+				if (!std::getline(refIn, line)) {
+					std::cerr << "Reference file has no entry for " << vCase[c].name << "." << std::endl;
+					++numFailed;
+				} else
+					numFailed += check_reference_line(line, vCase[c], res, nFluxRef, nDerivRef);
+			}
+		}
+	} catch (const UGError& err) {
+		std::cerr << "Benchmark aborted: " << err.get_msg() << std::endl;
+		numFailed = 255;
+	}
+	UGFinalize();
+
+	if (numFailed)
+		std::cerr << numFailed << " check(s) failed." << std::endl;
+	return numFailed > 255 ? 255 : numFailed;
+}
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+/*
+ * Performance regression tests (build target NCPerfTestsuite)
+ *
+ * Each test case times a hot path on fixed-size, deterministic input (best of
+ * several repetitions) and compares the time with a stored baseline. A test case
+ * fails if its time exceeds the baseline by more than the tolerance.
+ *
+ * Configuration by environment variables:
+ *   NC_PERF_BASELINE          baseline file (default: nc_perf_baseline.txt)
+ *   NC_PERF_TOLERANCE         admissible slow-down in percent (default: 20)
+ *   NC_PERF_UPDATE_BASELINE   if set to 1, measured times replace the baseline
+ *
+ * Times missing from the baseline file are recorded, not checked, so the first
+ * run on a new machine creates the baseline. The correctness tests (NCTestsuite)
+ * are built separately and are not affected by timing noise.
+ * SWC import reads test.swc from the working directory (as NCTestsuite does).
+ */
+
+#define BOOST_TEST_MODULE __CPP__UNIT_TESTS__UG__NEURO_COLLECTION__PERFORMANCE_TESTS__
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ug.h"
+#include "common/stopwatch.h"
+#include "lib_disc/domain.h"
+#include "lib_grid/refinement/hanging_node_refiner_multi_grid.h"
+
+#include "../grid_generation/dendrite_generator.h"
+#include "../membrane_transporters/membrane_transporter_interface.h"
+#include "../membrane_transporters/ncx.h"
+#include "../membrane_transporters/pmca.h"
+#include "../membrane_transporters/ryr.h"
+#include "../membrane_transporters/serca.h"
+#include "../test/test_neurite_proj.h"
+#include "../util/kd_tree.h"
+#include "../util/wave_front_refinement.h"
+
+using namespace ug;
+using namespace ug::neuro_collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// baseline timings (loaded before and saved after all tests)
+////////////////////////////////////////////////////////////////////////////////
+struct PerfBaseline {
+   std::string fileName;
+   number tolerance;
+   bool update;
+   bool dirty;
+   std::map<std::string, number> mTime;
+
+   static PerfBaseline*& instance() {
+      static PerfBaseline* inst = NULL;
+      return inst;
+   }
+
+   PerfBaseline() : fileName("nc_perf_baseline.txt"), tolerance(20.0), update(false), dirty(false) {
+      const char* env;
+      if ((env = getenv("NC_PERF_BASELINE")) && *env)
+         fileName = env;
+      if ((env = getenv("NC_PERF_TOLERANCE")) && *env)
+         tolerance = atof(env);
+      if ((env = getenv("NC_PERF_UPDATE_BASELINE")))
+         update = std::string(env) == "1";
+
+      std::ifstream ifs(fileName.c_str());
+      std::string name;
+      number t;
+      while (ifs >> name >> t)
+         mTime[name] = t;
+
+      int argc = boost::unit_test::framework::master_test_suite().argc;
+      char** argv = boost::unit_test::framework::master_test_suite().argv;
+      UGInit(&argc, &argv);
+
+      instance() = this;
+   }
+
+   ~PerfBaseline() {
+      instance() = NULL;
+      if (dirty) {
+         std::ofstream ofs(fileName.c_str());
+         ofs.precision(6);
+         for (std::map<std::string, number>::const_iterator it = mTime.begin(); it != mTime.end(); ++it)
+            ofs << it->first << " " << std::scientific << it->second << "\n";
+      }
+      UGFinalize();
+   }
+
+   /// compare a measured time with the baseline (or record it)
+   void check(const std::string& name, number t) {
+      std::map<std::string, number>::iterator it = mTime.find(name);
+      if (update || it == mTime.end()) {
+         BOOST_TEST_MESSAGE(name << ": " << t << " s (recorded as baseline)");
+         mTime[name] = t;
+         dirty = true;
+         return;
+      }
+
+      const number limit = it->second * (1.0 + 0.01 * tolerance);
+      BOOST_TEST_MESSAGE(name << ": " << t << " s (baseline " << it->second << " s)");
+      BOOST_CHECK_MESSAGE(t <= limit, name << " regressed: " << t << " s, baseline "
+         << it->second << " s, tolerance " << tolerance << "%.");
+   }
+};
+
+BOOST_GLOBAL_FIXTURE(PerfBaseline);
+
+static void check_baseline(const std::string& name, number t) {
+   BOOST_REQUIRE_MESSAGE(PerfBaseline::instance(), "Baseline not loaded.");
+   PerfBaseline::instance()->check(name, t);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// deterministic pseudo-random numbers in [0,1) (same sequence on all platforms)
+////////////////////////////////////////////////////////////////////////////////
+static number next_uniform(unsigned long& state) {
+   state = (state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+   return (number) state / 2147483648.0;
+}
+
+/// number of repetitions per measurement (the best time is used)
+static const size_t numReps = 5;
+
+////////////////////////////////////////////////////////////////////////////////
+/// TESTSUITE performance
+////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(performance);
+////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(SwcImport) {
+   GlobalAttachments::declare_attachment<ANumber>("diameter", true);
+
+   number best = std::numeric_limits<number>::max();
+   for (size_t r = 0; r < numReps; ++r) {
+      Stopwatch sw;
+      sw.start();
+      std::vector<SWCPoint> vPoints;
+      import_swc("test.swc", vPoints, 1.0);
+      Grid grid;
+      SubsetHandler sh(grid);
+      swc_points_to_grid(vPoints, grid, sh, 1.0);
+      best = std::min(best, sw.ms() / 1000.0);
+      BOOST_REQUIRE_MESSAGE(grid.num_vertices() > 0, "Requiring imported vertices.");
+   }
+   check_baseline("SwcImport", best);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(NearestNeighborMapping) {
+   // 1d vertex positions and 3d query positions in the unit cube
+   const size_t nData = 50000, nQuery = 200000;
+   unsigned long seed = 4711;
+   std::vector<ug::vector3> vData(nData), vQuery(nQuery);
+   for (size_t i = 0; i < nData; ++i)
+      vData[i] = ug::vector3(next_uniform(seed), next_uniform(seed), next_uniform(seed));
+   for (size_t i = 0; i < nQuery; ++i)
+      vQuery[i] = ug::vector3(next_uniform(seed), next_uniform(seed), next_uniform(seed));
+
+   number best = std::numeric_limits<number>::max();
+   std::vector<size_t> vNN;
+   std::vector<number> vDistSq;
+   for (size_t r = 0; r < numReps; ++r) {
+      Stopwatch sw;
+      sw.start();
+      KDTree<3> tree(vData);
+      tree.nearest(vQuery, vNN, vDistSq);
+      best = std::min(best, sw.ms() / 1000.0);
+   }
+   BOOST_REQUIRE_MESSAGE(vNN.size() == nQuery, "Requiring one neighbor per query point.");
+   check_baseline("NearestNeighborMapping", best);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void check_flux_kernel
+(
+   const std::string& name,
+   SmartPtr<IMembraneTransporter> mt,
+   number lo0, number hi0, number lo1, number hi1
+) {
+   mt->check_and_lock();
+   mt->prepare_threads();
+   mt->prepare_timestep(0.01, 0.0, NULL);
+
+   const size_t nPts = 200000;
+   unsigned long seed = 4711;
+   std::vector<number> vU(2 * nPts);
+   for (size_t k = 0; k < nPts; ++k) {
+      vU[k] = lo0 + next_uniform(seed) * (hi0 - lo0);
+      vU[nPts + k] = lo1 + next_uniform(seed) * (hi1 - lo1);
+   }
+   std::vector<GridObject*> vElem(nPts, (GridObject*) NULL);
+
+   std::vector<number> vFlux, vDeriv;
+   std::vector<size_t> vDerivFct;
+   number best = std::numeric_limits<number>::max();
+   for (size_t r = 0; r < numReps; ++r) {
+      Stopwatch sw;
+      sw.start();
+      mt->flux_batch(vU, vElem, vFlux);
+      mt->flux_deriv_batch(vU, vElem, vDerivFct, vDeriv);
+      best = std::min(best, sw.ms() / 1000.0);
+   }
+   BOOST_REQUIRE_MESSAGE(vFlux.size() == nPts * mt->n_fluxes(), "Requiring one flux per point.");
+   check_baseline("FluxKernel/" + name, best);
+}
+
+BOOST_AUTO_TEST_CASE(FluxKernels) {
+   const number caCytLo = 5e-5, caCytHi = 1e-3;
+   check_flux_kernel("PMCA", make_sp(new PMCA("ca_cyt, ca_ext")), caCytLo, caCytHi, 1.0, 2.0);
+   check_flux_kernel("NCX", make_sp(new NCX("ca_cyt, ca_ext")), caCytLo, caCytHi, 1.0, 2.0);
+   check_flux_kernel("SERCA", make_sp(new SERCA("ca_cyt, ca_er")), caCytLo, caCytHi, 0.1, 0.5);
+   check_flux_kernel("RyR", make_sp(new RyR("ca_cyt, ca_er")), caCytLo, caCytHi, 0.1, 0.5);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(RefinementMarking) {
+   SmartPtr<Domain2d> dom = make_sp(new Domain2d());
+   DendriteGenerator dg;
+   dg.set_num_segments(2000);
+   dg.create_dendrite(*dom->grid(), *dom->subset_handler());
+   BOOST_REQUIRE_MESSAGE(dom->grid()->num<Face>() > 0, "Requiring a dendrite grid.");
+
+   // window around the center of the dendrite
+   const Domain2d::position_accessor_type& aaPos = dom->position_accessor();
+   number xMin = std::numeric_limits<number>::max();
+   number xMax = -std::numeric_limits<number>::max();
+   for (VertexIterator it = dom->grid()->begin<Vertex>(); it != dom->grid()->end<Vertex>(); ++it) {
+      xMin = std::min(xMin, aaPos[*it][0]);
+      xMax = std::max(xMax, aaPos[*it][0]);
+   }
+
+   WaveFrontRefinementDriver<Domain2d> driver(dom);
+   driver.set_window(0.1 * (xMax - xMin), 0.1 * (xMax - xMin));
+   SmartPtr<HangingNodeRefiner_MultiGrid> refiner = make_sp(new HangingNodeRefiner_MultiGrid(*dom->grid()));
+
+   number best = std::numeric_limits<number>::max();
+   for (size_t r = 0; r < numReps; ++r) {
+      refiner->clear_marks();
+      Stopwatch sw;
+      sw.start();
+      driver.mark(refiner, 0.5 * (xMin + xMax));
+      best = std::min(best, sw.ms() / 1000.0);
+   }
+   BOOST_REQUIRE_MESSAGE(driver.num_marked_for_refinement() > 0, "Requiring marked elements.");
+   check_baseline("RefinementMarking", best);
+}
+////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE_END();
@@ -43,11 +43,23 @@
 #include <boost/test/parameterized_test.hpp>
 #include <common/math/ugmath.h>
 #include <lib_grid/grid/grid.h>
+#include <lib_disc/domain.h>
+#include <lib_disc/function_spaces/approximation_space.h>
+#include <lib_disc/function_spaces/grid_function.h>
+#include <lib_algebra/cpu_algebra_types.h>
+#include <limits>
 #include <vector>
 
 #include "../test/neurite_util.h"
 #include "../test/neurite_math_util.h"
 #include "../test/test_neurite_proj.h"
+#include "../util/kd_tree.h"
+#include "../util/expression.h"
+#include "../util/time_step_controller.h"
+#include "../util/compressed_series.h"
+#include "../grid_generation/bouton_generator.h"
+#include "../grid_generation/neurite_storage.h"
+#include "../buffer_fv1.h"
 #include "fixtures.cpp"
 #include "lib_grid/refinement/projectors/cylinder_projector.h" // CylinderProjector
 
@@ -114,6 +126,34 @@ BOOST_AUTO_TEST_CASE(ExtractSubGrid) {
    BOOST_REQUIRE_MESSAGE(g.num_edges() == 4, "Requiring four edges.");
 }
 
+////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExtractSubGridInPlace) {
+   Grid g;
+   SubsetHandler sh(g);
+   g.attach_to_vertices(aPosition);
+   Grid::VertexAttachmentAccessor<APosition> aaPos(g, aPosition);
+   sh.set_default_subset_index(0);
+   // create vertices in subset 0
+   ug::Vertex *p1, *p2, *p3, *p4;
+   p1 = *g.create<RegularVertex>(); p2 = *g.create<RegularVertex>();
+   p3 = *g.create<RegularVertex>(); p4 = *g.create<RegularVertex>();
+   aaPos[p1] = ug::vector3(0, 0, 0); aaPos[p2] = ug::vector3(0, 1, 0);
+   aaPos[p3] = ug::vector3(1, 1, 0); aaPos[p4] = ug::vector3(1, 0, 0);
+
+   /// create edges in subsets 1, 2, 3 and 4 of square
+   sh.assign_subset(*g.create<RegularEdge>(EdgeDescriptor(p1, p2)), 1);
+   sh.assign_subset(*g.create<RegularEdge>(EdgeDescriptor(p2, p3)), 2);
+   sh.assign_subset(*g.create<RegularEdge>(EdgeDescriptor(p3, p4)), 3);
+   sh.assign_subset(*g.create<RegularEdge>(EdgeDescriptor(p4, p1)), 4);
+
+   // keep vertices and first edge only, no second grid involved
+   std::vector<size_t> vSi; vSi.push_back(0); vSi.push_back(1);
+   split_grid_based_on_subset_indices_in_place(g, sh, vSi);
+   BOOST_REQUIRE_MESSAGE(g.num_vertices() == 4, "Requiring four vertices.");
+   BOOST_REQUIRE_MESSAGE(g.num_edges() == 1, "Requiring one edge.");
+   BOOST_REQUIRE_MESSAGE(sh.num<Edge>(1) == 1, "Requiring the edge in subset 1.");
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 BOOST_FIXTURE_TEST_CASE(ExtendERintoSoma, FixtureOneGrid) {
    /// FIXME: Adapt test case add scale to aaSurfParams
@@ -514,6 +554,275 @@ BOOST_AUTO_TEST_CASE(GraphAcylic) {
     ///BOOST_REQUIRE_MESSAGE(is_cyclic(adj2, V), "Graph supposed to contain no cycle.");
 }
 
+////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(KDTreeNearestNeighbor) {
+   // regular lattice of data points and some query points in between
+   std::vector<ug::vector3> vData;
+   for (size_t i = 0; i < 10; i++)
+      for (size_t j = 0; j < 10; j++)
+         for (size_t k = 0; k < 10; k++)
+            vData.push_back(ug::vector3(i, 0.5*j, 0.25*k));
+
+   std::vector<ug::vector3> vQuery;
+   for (size_t i = 0; i < 50; i++)
+      vQuery.push_back(ug::vector3(0.17*i, 0.093*i, -0.05*i + 2.0));
+
+   KDTree<3> tree(vData);
+   BOOST_REQUIRE_MESSAGE(tree.size() == vData.size(), "Requiring all data points in tree.");
+
+   std::vector<size_t> vNN;
+   std::vector<number> vDistSq;
+   tree.nearest(vQuery, vNN, vDistSq);
+   BOOST_REQUIRE_MESSAGE(vNN.size() == vQuery.size(), "Requiring one neighbor per query point.");
+
+   // compare with brute-force search
+   for (size_t q = 0; q < vQuery.size(); q++) {
+      number minDistSq = VecDistanceSq(vQuery[q], vData[0]);
+      for (size_t d = 1; d < vData.size(); d++)
+         minDistSq = std::min(minDistSq, VecDistanceSq(vQuery[q], vData[d]));
+      BOOST_REQUIRE_SMALL(vDistSq[q] - minDistSq, SMALL);
+      BOOST_REQUIRE_SMALL(VecDistanceSq(vQuery[q], vData[vNN[q]]) - minDistSq, SMALL);
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpressionEvaluation) {
+   // constant folding
+   Expression c("2^-1 + sin(pi/2)*max(1, 3)");
+   BOOST_REQUIRE_MESSAGE(c.is_constant(), "Requiring constant expression.");
+   BOOST_REQUIRE_MESSAGE(c.num_instructions() == 1, "Requiring folded expression.");
+
+   // comparison with C++ for single points and batches
+   Expression ex("1e-3*exp(-t/0.01)*(x^2 + y^2 < 4) - z*abs(-x)");
+   BOOST_REQUIRE_MESSAGE(ex.depends_on(Expression::_T_), "Requiring time dependency.");
+
+   std::vector<ug::vector3> vCoords;
+   for (size_t i = 0; i < 100; i++)
+      vCoords.push_back(ug::vector3(0.03*i, -0.021*i, 0.5 - 0.01*i));
+   const number t = 0.004;
+
+   std::vector<number> vBatch(vCoords.size());
+   ex.eval_batch(&vCoords[0][0], 3, 3, t, vCoords.size(), &vBatch[0]);
+   for (size_t i = 0; i < vCoords.size(); i++) {
+      const ug::vector3& x = vCoords[i];
+      const number ref = 1e-3*exp(-t/0.01)*(x[0]*x[0] + x[1]*x[1] < 4 ? 1.0 : 0.0)
+         - x[2]*fabs(x[0]);
+      number vars[Expression::NUM_VARS] = {x[0], x[1], x[2], t};
+      BOOST_REQUIRE_SMALL(ex.eval(vars) - ref, SMALL);
+      BOOST_REQUIRE_SMALL(vBatch[i] - ref, SMALL);
+   }
+
+   // invalid expressions (e.g. names of Lua callbacks)
+   BOOST_REQUIRE_MESSAGE(!Expression::is_valid("densityFct"), "Requiring unknown identifier to be rejected.");
+   BOOST_REQUIRE_MESSAGE(!Expression::is_valid("sin(x"), "Requiring missing parenthesis to be rejected.");
+}
+
+BOOST_AUTO_TEST_CASE(TimeStepControl) {
+   TimeStepController tsc;
+   tsc.set_time_step_bounds(1e-6, 1e-3);
+   tsc.set_growth_limits(2.0, 0.25);
+   tsc.set_safety_factor(1.0);
+   tsc.set_change_tolerance(1e-2);
+
+   // quiescent: growth limited by factor and upper bound
+   BOOST_REQUIRE(tsc.check_step(1e-4, 0.0));
+   BOOST_REQUIRE_CLOSE(tsc.next_dt(), 2e-4, 1e-8);
+   BOOST_REQUIRE(tsc.check_step(8e-4, 1e-3));
+   BOOST_REQUIRE_CLOSE(tsc.next_dt(), 1e-3, 1e-8);
+
+   // too large change: rejection with limited shrinking
+   BOOST_REQUIRE(!tsc.check_step(1e-4, 2e-2));
+   BOOST_REQUIRE_CLOSE(tsc.next_dt(), 5e-5, 1e-8);
+   BOOST_REQUIRE(!tsc.check_step(1e-4, 1.0));
+   BOOST_REQUIRE_CLOSE(tsc.next_dt(), 2.5e-5, 1e-8);
+
+   // step at lower bound is always accepted
+   BOOST_REQUIRE(tsc.check_step(1e-6, 1.0));
+   BOOST_REQUIRE_CLOSE(tsc.next_dt(), 1e-6, 1e-8);
+
+   // wave front passes at most one element per step
+   tsc.set_wave_front_resolution(1e-7);
+   tsc.set_wave_front_velocity(-1e-3);
+   BOOST_REQUIRE(tsc.check_step(1e-4, 0.0));
+   BOOST_REQUIRE_CLOSE(tsc.next_dt(), 1e-4, 1e-8);
+
+   BOOST_REQUIRE_EQUAL(tsc.num_accepted(), 4u);
+   BOOST_REQUIRE_EQUAL(tsc.num_rejected(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(CompressedSeriesRoundTrip) {
+   const size_t nPts = 200;
+   const size_t nSnap = 50;
+   std::vector<number> vX(nPts);
+   for (size_t i = 0; i < nPts; ++i)
+      vX[i] = 1e-6 * i;
+
+   // traveling pulse with constant background
+   std::vector<number> vVal(nPts);
+   const number tols[2] = {0.0, 1e-9};
+   for (size_t m = 0; m < 2; ++m) {
+      {
+         CompressedSeriesWriter writer("compressed_series_test.tsc", vX, 1, nPts,
+                                       std::vector<std::string>(), tols[m], 16);
+         for (size_t t = 0; t < nSnap; ++t) {
+            for (size_t i = 0; i < nPts; ++i)
+               vVal[i] = 5e-8 + 1e-6 * exp(-pow((number) i - 4.0 * t, 2) / 50.0);
+            writer.write(1e-3 * t, vVal);
+         }
+      }
+
+      CompressedSeriesReader reader("compressed_series_test.tsc");
+      BOOST_REQUIRE_EQUAL(reader.num_points(), nPts);
+      BOOST_REQUIRE_EQUAL(reader.num_snapshots(), nSnap);
+      BOOST_REQUIRE_CLOSE(reader.coordinate(10, 0), 1e-5, 1e-8);
+      BOOST_REQUIRE_EQUAL(reader.snapshot_index(0.0205), 20u);
+
+      // random access (backwards, across chunks)
+      for (size_t t = nSnap; t-- > 0;) {
+         std::vector<number> vRead = reader.snapshot(t);
+         for (size_t i = 0; i < nPts; ++i) {
+            const number ref = 5e-8 + 1e-6 * exp(-pow((number) i - 4.0 * t, 2) / 50.0);
+            if (tols[m] == 0.0)
+               BOOST_REQUIRE_EQUAL(vRead[i], ref);
+            else
+               BOOST_REQUIRE_SMALL(vRead[i] - ref, tols[m] * (1.0 + 1e-8));
+         }
+      }
+   }
+   remove("compressed_series_test.tsc");
+}
+
+/// Fibonacci lattice: points on the sphere, no clusters
+BOOST_AUTO_TEST_CASE(FibonacciSphereCoords) {
+   const int N = 500;
+   const number radius = 2.0;
+   std::vector<ug::vector3> coords;
+   ug::neuro_collection::GetFibonacciSphereCoords(coords, N, radius);
+   BOOST_REQUIRE_EQUAL(coords.size(), (size_t) N);
+
+   ug::vector3 center(0.0);
+   for (int i = 0; i < N; ++i) {
+      BOOST_REQUIRE_CLOSE(VecLength(coords[i]), radius, 1e-10);
+      VecAdd(center, center, coords[i]);
+   }
+   BOOST_REQUIRE_SMALL(VecLength(center) / N, 1e-2);
+
+   // minimal distance comparable to the mean spacing sqrt(4 pi r^2 / N)
+   number minDist = std::numeric_limits<number>::max();
+   for (int i = 0; i < N; ++i)
+      for (int j = i + 1; j < N; ++j)
+         minDist = std::min(minDist, VecDistance(coords[i], coords[j]));
+   BOOST_REQUIRE_GT(minDist, 0.5 * sqrt(4.0 * M_PI / N) * radius);
+}
+
+BOOST_AUTO_TEST_CASE(NeuriteDataStorage) {
+   using namespace ug::neuro_collection::neurites_from_swc;
+   NeuriteData nd;
+   nd.reserve(5, 3, 1);
+
+   // neurite 0 with a branching point at its second position and two children
+   nd.pos.push_back(0, ug::vector3(0.0, 0.0, 0.0));
+   nd.pos.push_back(0, ug::vector3(1.0, 0.0, 0.0));
+   nd.pos.push_back(0, ug::vector3(2.0, 0.0, 0.0));
+   const size_t bpInd = nd.add_branch_point(0, 1, 2);
+   nd.pos.push_back(1, ug::vector3(1.0, 0.0, 0.0));
+   nd.pos.push_back(1, ug::vector3(1.0, 1.0, 0.0));
+   nd.add_branch_child(bpInd, 1);
+   nd.pos.push_back(2, ug::vector3(1.0, 0.0, 0.0));
+   nd.add_branch_child(bpInd, 2);
+   nd.pos.resize(3);
+   nd.bp.resize(3);
+
+   BOOST_REQUIRE_EQUAL(nd.num_neurites(), (size_t) 3);
+   BOOST_REQUIRE_EQUAL(nd.pos.num_entries(), (size_t) 6);
+   BOOST_REQUIRE_EQUAL(nd.pos[0].size(), (size_t) 3);
+   BOOST_REQUIRE_EQUAL(nd.pos[1].size(), (size_t) 2);
+   BOOST_REQUIRE_EQUAL(nd.pos[2].size(), (size_t) 1);
+   BOOST_REQUIRE_EQUAL(nd.pos[1].back()[1], 1.0);
+   BOOST_REQUIRE_EQUAL(nd.bp[0].size(), (size_t) 1);
+   BOOST_REQUIRE_EQUAL(nd.bp[1].size(), (size_t) 0);
+   BOOST_REQUIRE_EQUAL(nd.bp[0][0].pos, (size_t) 1);
+
+   NeuriteRange<size_t> children = nd.children(nd.bp[0][0]);
+   BOOST_REQUIRE_EQUAL(children.size(), (size_t) 2);
+   BOOST_REQUIRE_EQUAL(children[0], (size_t) 1);
+   BOOST_REQUIRE_EQUAL(children[1], (size_t) 2);
+   BOOST_REQUIRE_THROW(nd.add_branch_child(bpInd, 3), ug::UGError);
+}
+
+BOOST_AUTO_TEST_CASE(BufferSplittingOnMembrane) {
+   typedef GridFunction<Domain3d, CPUAlgebra> TGridFunction;
+   const number btot = 40.0, kb = 27.0, ku = 19.0;
+   const number c0 = 0.5, b0 = 10.0, dt = 0.1;
+
+   // one tetrahedron in "cyt", one of its faces (with edges and corners) in "pm"
+   SmartPtr<Domain3d> dom = make_sp(new Domain3d());
+   MultiGrid& mg = *dom->grid();
+   MGSubsetHandler& sh = *dom->subset_handler();
+   Domain3d::position_accessor_type& aaPos = dom->position_accessor();
+   mg.enable_options(GRIDOPT_AUTOGENERATE_SIDES);
+   sh.set_subset_name("cyt", 0);
+   sh.set_subset_name("pm", 1);
+   ug::Vertex* v[4];
+   sh.set_default_subset_index(1);
+   for (size_t i = 0; i < 3; ++i) v[i] = *mg.create<RegularVertex>();
+   mg.create<Triangle>(TriangleDescriptor(v[0], v[1], v[2]));
+   sh.set_default_subset_index(0);
+   v[3] = *mg.create<RegularVertex>();
+   mg.create<Tetrahedron>(TetrahedronDescriptor(v[0], v[1], v[2], v[3]));
+   aaPos[v[0]] = ug::vector3(0, 0, 0); aaPos[v[1]] = ug::vector3(1, 0, 0);
+   aaPos[v[2]] = ug::vector3(0, 1, 0); aaPos[v[3]] = ug::vector3(0, 0, 1);
+
+   SmartPtr<ApproximationSpace<Domain3d> > approx =
+      make_sp(new ApproximationSpace<Domain3d>(dom, AlgebraType(AlgebraType::CPU, 1)));
+   approx->add("ca", "Lagrange", 1, "cyt, pm");
+   approx->add("clb", "Lagrange", 1, "cyt, pm");
+   approx->init_top_surface();
+
+   // spatially constant initial values: transport vanishes, so the unsplit
+   // solution is the solution of the local reaction equation at every vertex
+   SmartPtr<TGridFunction> u = make_sp(new TGridFunction(approx));
+   const size_t fctCa = u->fct_id_by_name("ca");
+   const size_t fctClb = u->fct_id_by_name("clb");
+   std::vector<DoFIndex> vDI;
+   for (size_t i = 0; i < 4; ++i) {
+      u->dd()->inner_dof_indices(v[i], fctCa, vDI);
+      BOOST_REQUIRE_EQUAL(vDI.size(), (size_t) 1);
+      DoFRef(*u, vDI[0]) = c0;
+      u->dd()->inner_dof_indices(v[i], fctClb, vDI);
+      BOOST_REQUIRE_EQUAL(vDI.size(), (size_t) 1);
+      DoFRef(*u, vDI[0]) = b0;
+   }
+
+   BufferFV1<Domain3d> buffer("cyt");
+   buffer.add_reaction("clb", "ca", btot, kb, ku);
+   buffer.set_operator_splitting(true);
+   buffer.integrate_reactions(u, 0.0, dt);
+
+   // unsplit reference: fine RK4 integration of the reaction equation
+   number c = c0, b = b0;
+   const size_t nSteps = 10000;
+   const number h = dt / nSteps;
+   for (size_t n = 0; n < nSteps; ++n) {
+      const number k1 = -kb*c*b + ku*(btot - b);
+      const number k2 = -kb*(c + 0.5*h*k1)*(b + 0.5*h*k1) + ku*(btot - b - 0.5*h*k1);
+      const number k3 = -kb*(c + 0.5*h*k2)*(b + 0.5*h*k2) + ku*(btot - b - 0.5*h*k2);
+      const number k4 = -kb*(c + h*k3)*(b + h*k3) + ku*(btot - b - h*k3);
+      const number dc = h / 6.0 * (k1 + 2.0*k2 + 2.0*k3 + k4);
+      c += dc;
+      b += dc;
+   }
+
+   // all corners must be integrated, including those in the membrane subset
+   BOOST_REQUIRE_EQUAL(sh.num<ug::Vertex>(1), (size_t) 3);
+   for (size_t i = 0; i < 4; ++i) {
+      u->dd()->inner_dof_indices(v[i], fctCa, vDI);
+      BOOST_REQUIRE_CLOSE(DoFRef(*u, vDI[0]), c, 1e-6);
+      u->dd()->inner_dof_indices(v[i], fctClb, vDI);
+      BOOST_REQUIRE_CLOSE(DoFRef(*u, vDI[0]), b, 1e-6);
+   }
+}
+
 BOOST_AUTO_TEST_CASE(FindPathLength1D) {
    Domain3d dom;
    std::ifstream ifile("test_1d.ugx");
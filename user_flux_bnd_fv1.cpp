@@ -38,6 +38,7 @@
  */
 
 #include "user_flux_bnd_fv1.h"
+#include "util/expression_user_data.h"  // for ExpressionUserData
 
 
 namespace ug {
@@ -45,7 +46,9 @@ namespace neuro_collection {
 
 template <typename TDomain>
 UserFluxBoundaryFV1<TDomain>::UserFluxBoundaryFV1(const char* functions, const char* subsets)
-: FV1InnerBoundaryElemDisc<TDomain>(functions, subsets)
+: FV1InnerBoundaryElemDisc<TDomain>(functions, subsets),
+  m_bBatchedEval(false), m_bTimeOnly(false), m_bLuaFlux(false),
+  m_bBatchValid(false), m_batchTime(0.0), m_timeOnlyFlux(0.0)
 {}
 
 
@@ -55,7 +58,9 @@ UserFluxBoundaryFV1<TDomain>::UserFluxBoundaryFV1
 	const std::vector<std::string>& functions,
 	const std::vector<std::string>& subsets
 )
-: FV1InnerBoundaryElemDisc<TDomain>(functions, subsets)
+: FV1InnerBoundaryElemDisc<TDomain>(functions, subsets),
+  m_bBatchedEval(false), m_bTimeOnly(false), m_bLuaFlux(false),
+  m_bBatchValid(false), m_batchTime(0.0), m_timeOnlyFlux(0.0)
 {}
 
 
@@ -63,6 +68,8 @@ template <typename TDomain>
 void UserFluxBoundaryFV1<TDomain>::set_flux_function(SmartPtr<CplUserData<number, dim> > fluxFct)
 {
 	m_fluxFct = fluxFct;
+	m_bLuaFlux = dynamic_cast<LuaUserData<number, dim>*>(fluxFct.get()) != NULL;
+	clear_batches();
 }
 
 
@@ -84,6 +91,13 @@ void UserFluxBoundaryFV1<TDomain>::set_flux_function(const char* name)
 		return;
 	}
 
+	// closed-form expression in x, y, z and t (evaluated natively)
+	if (ExpressionUserData<dim>::is_valid(name))
+	{
+		set_flux_function(make_sp(new ExpressionUserData<dim>(name)));
+		return;
+	}
+
 	// no match found
 	if (!CheckLuaCallbackName(name))
 		UG_THROW("Lua-Callback with name '" << name << "' does not exist.");
@@ -94,6 +108,135 @@ void UserFluxBoundaryFV1<TDomain>::set_flux_function(const char* name)
 }
 
 
+template <typename TDomain>
+void UserFluxBoundaryFV1<TDomain>::set_batched_evaluation(bool b)
+{
+	m_bBatchedEval = b;
+	clear_batches();
+}
+
+
+template <typename TDomain>
+void UserFluxBoundaryFV1<TDomain>::set_time_only_flux(bool b)
+{
+	m_bTimeOnly = b;
+	clear_batches();
+}
+
+
+template <typename TDomain>
+void UserFluxBoundaryFV1<TDomain>::approximation_space_changed()
+{
+	clear_batches();
+
+	SmartPtr<MultiGrid> grid = this->approx_space()->domain()->grid();
+	m_spGridAdaptionCallbackID = grid->message_hub()->register_class_callback(this,
+		&UserFluxBoundaryFV1<TDomain>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid->message_hub()->register_class_callback(this,
+		&UserFluxBoundaryFV1<TDomain>::grid_distribution_callback);
+}
+
+
+template <typename TDomain>
+void UserFluxBoundaryFV1<TDomain>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		clear_batches();
+}
+
+
+template <typename TDomain>
+void UserFluxBoundaryFV1<TDomain>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		clear_batches();
+}
+
+
+template <typename TDomain>
+void UserFluxBoundaryFV1<TDomain>::clear_batches()
+{
+	m_mBatch.clear();
+	m_mElemIndices.clear();
+	m_bBatchValid = false;
+}
+
+
+template <typename TDomain>
+void UserFluxBoundaryFV1<TDomain>::evaluate_batches(number time)
+{
+	typename std::map<int, SubsetBatch>::iterator it = m_mBatch.begin();
+	for (; it != m_mBatch.end(); ++it)
+	{
+		SubsetBatch& batch = it->second;
+		const size_t nIP = batch.vCoords.size();
+		if (nIP)
+			(*m_fluxFct)(&batch.vFlux[0], &batch.vCoords[0], time, it->first, nIP);
+	}
+}
+
+
+template <typename TDomain>
+number UserFluxBoundaryFV1<TDomain>::flux_density(GridObject* e, const MathVector<dim>& coords, int si)
+{
+	if (!m_fluxFct.valid())
+		return 0.0;
+
+	const number time = this->time();
+
+	number fluxDensity;
+	if (!m_bTimeOnly && (!m_bBatchedEval || !m_bLuaFlux || m_fluxFct->requires_grid_fct()))
+	{
+		(*m_fluxFct)(fluxDensity, coords, time, si);
+		return fluxDensity;
+	}
+
+	// the batches are shared by all threads
+#ifdef _OPENMP
+	#pragma omp critical (nc_user_flux_batch)
+#endif
+	{
+		const bool bNewTime = !m_bBatchValid || time != m_batchTime;
+		if (m_bTimeOnly)
+		{
+			if (bNewTime)
+				(*m_fluxFct)(m_timeOnlyFlux, coords, time, si);
+			fluxDensity = m_timeOnlyFlux;
+		}
+		else
+		{
+			if (bNewTime)
+				evaluate_batches(time);
+
+			// look up integration point in the points recorded for this element
+			SubsetBatch& batch = m_mBatch[si];
+			std::vector<size_t>& vInd = m_mElemIndices[std::make_pair(e, si)];
+			const size_t nIP = vInd.size();
+			size_t k = 0;
+			for (; k < nIP; ++k)
+				if (VecDistanceSq(batch.vCoords[vInd[k]], coords) == 0.0)
+					break;
+
+			if (k < nIP)
+				fluxDensity = batch.vFlux[vInd[k]];
+			else
+			{
+				// not yet recorded
+				(*m_fluxFct)(fluxDensity, coords, time, si);
+				vInd.push_back(batch.vCoords.size());
+				batch.vCoords.push_back(coords);
+				batch.vFlux.push_back(fluxDensity);
+			}
+		}
+
+		m_bBatchValid = true;
+		m_batchTime = time;
+	}
+
+	return fluxDensity;
+}
+
+
 template <typename TDomain>
 bool UserFluxBoundaryFV1<TDomain>::fluxDensityFct
 (
@@ -104,13 +247,8 @@ bool UserFluxBoundaryFV1<TDomain>::fluxDensityFct
 	FluxCond& fc
 )
 {
-	number fluxDensity;
-	if (m_fluxFct.valid())
-		(*m_fluxFct)(fluxDensity, coords, this->time(), si);
-	else fluxDensity = 0.0;
-
 	fc.flux.resize(1, 0.0);
-	fc.flux[0] = fluxDensity;
+	fc.flux[0] = flux_density(e, coords, si);
 
 	fc.to.resize(1);
 	fc.to[0] = 0;
@@ -44,6 +44,10 @@
 #include "lib_disc/spatial_disc/elem_disc/inner_boundary/inner_boundary.h"
 #include "bindings/lua/lua_user_data.h"
 #include "common/util/smart_pointer.h"
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
+
+#include <map>
+#include <vector>
 
 
 namespace ug {
@@ -57,6 +61,17 @@ namespace neuro_collection {
 /**
  * This class implements the inner_boundary interface to provide a normal
  * Neumann boundary the flux over which is defined by an instance of UserNumberData.
+ *
+ * As the flux function does not depend on the unknowns, its values usually only
+ * change with time. Lua callbacks can therefore be evaluated only once per time
+ * (not once per Newton iteration and assembling) if batched evaluation is switched
+ * on: The integration points visited are recorded per element and subset, and
+ * whenever the time changes, the callback is evaluated for all of them in one
+ * batched call per subset. Constant and native flux functions as well as flux
+ * functions that depend on the solution (such as grid function data) are always
+ * evaluated point-wise.
+ * If the flux function only depends on time (not on the location), this can be
+ * declared using set_time_only_flux(); it is then evaluated once per time.
  */
 
 template<typename TDomain>
@@ -91,6 +106,27 @@ class UserFluxBoundaryFV1
 		/// setting flux information
 		void set_flux_function(const char* name);
 
+		/**
+		 * @brief Evaluate a Lua flux callback in batches once per time
+		 * Flux values are kept per integration point and re-evaluated (for all
+		 * points of a subset in one call) whenever the time changes.
+		 * They are discarded whenever the grid is adapted or redistributed
+		 * and whenever a new flux function is set.
+		 * Only use this if the callback does not depend on anything but time and
+		 * location (e.g., not on Lua globals changed between solves at the same time).
+		 * Has no effect for other kinds of flux functions.
+		 * Default is off.
+		 */
+		void set_batched_evaluation(bool b);
+
+		/**
+		 * @brief Declare the flux function to depend on time only
+		 * The flux function is then evaluated once per time (at the first
+		 * integration point) and this value is used on the whole boundary.
+		 * Default is off.
+		 */
+		void set_time_only_flux(bool b);
+
 
 		// virtual functions inherited from FV1InnerBoundaryElemDisc
 		/// calculates the flux density
@@ -114,8 +150,49 @@ class UserFluxBoundaryFV1
 			FluxDerivCond& fdc
 		);
 
+	protected:
+		/// @copydoc IElemDisc::approximation_space_changed()
+		virtual void approximation_space_changed();
+
+		/// flux density at integration point (from batch values if possible)
+		number flux_density(GridObject* e, const MathVector<dim>& coords, int si);
+
+		/// re-evaluate all recorded integration points for the current time
+		void evaluate_batches(number time);
+
+		/// discard all recorded integration points and values
+		void clear_batches();
+
+		/// grid change callbacks (invalidating the batches)
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
 	protected:
 		SmartPtr<UserData<number,dim> > m_fluxFct;
+
+	private:
+		/// recorded integration points and their flux values for one subset
+		struct SubsetBatch
+		{
+			std::vector<MathVector<dim> > vCoords;
+			std::vector<number> vFlux;
+		};
+
+		bool m_bBatchedEval;
+		bool m_bTimeOnly;
+		bool m_bLuaFlux;	///< whether the flux function is a Lua callback
+
+		/// time the batch values belong to
+		bool m_bBatchValid;
+		number m_batchTime;
+		number m_timeOnlyFlux;
+
+		std::map<int, SubsetBatch> m_mBatch;
+		/// indices of the integration points of an element (on a subset) in the subset batch
+		std::map<std::pair<GridObject*, int>, std::vector<size_t> > m_mElemIndices;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
 };
 
 /// \}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__AABB_HASH_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__AABB_HASH_H
+
+#include <cstddef>                       // for size_t
+#include <utility>                       // for pair
+#include <vector>                        // for vector
+
+#include "common/math/ugmath.h"          // for MathVector
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Spatial hash for broad-phase proximity and intersection queries on boxes
+ *
+ * Axis-aligned bounding boxes (of vertices with a radius, segments, capsules,
+ * cylinders, ...) are added and binned into a uniform grid of cells once.
+ * Afterwards, all pairs of overlapping boxes can be found in roughly linear time
+ * (instead of testing all pairs) and boxes overlapping a query box can be listed.
+ * Exact tests on the candidates are left to the caller.
+ *
+ * The cells are not stored in a hash map, but as a sorted array of (cell key,
+ * box index) entries; cell keys are hashed cell coordinates. Hash collisions
+ * can therefore only produce additional candidates, which are removed by the
+ * box overlap check.
+ *
+ * The cell size defaults to the mean of the largest extents of the boxes.
+ * Queries are read-only and can be carried out concurrently.
+ */
+template <int dim>
+class AABBHash
+{
+	public:
+		typedef MathVector<dim> pos_type;
+		typedef typename pos_type::value_type value_type;
+
+	public:
+		/// constructor
+		AABBHash();
+
+		/// add a box (its index is the number of boxes added before)
+		size_t add_box(const pos_type& lo, const pos_type& hi);
+
+		/// add the bounding box of a ball
+		size_t add_ball(const pos_type& center, value_type radius);
+
+		/// add the bounding box of a segment with a radius (capsule)
+		size_t add_capsule(const pos_type& a, const pos_type& b, value_type radius);
+
+		/// number of boxes
+		size_t size() const {return m_vLo.size();}
+
+		/// remove all boxes
+		void clear();
+
+		/// set the cell size (must be called before build; non-positive means automatic)
+		void set_cell_size(value_type h) {m_cellSize = h;}
+
+		/// bin the boxes (must be called after adding boxes and before querying)
+		void build();
+
+		/**
+		 * @brief find all pairs of overlapping boxes
+		 * @param vPairsOut  output: pairs (i, j) with i < j, each pair once, sorted
+		 */
+		void overlapping_pairs(std::vector<std::pair<size_t, size_t> >& vPairsOut) const;
+
+		/**
+		 * @brief find all boxes overlapping a query box
+		 * @param lo, hi    query box
+		 * @param vIndOut   output: indices of overlapping boxes (sorted)
+		 */
+		void overlapping_boxes(const pos_type& lo, const pos_type& hi, std::vector<size_t>& vIndOut) const;
+
+	protected:
+		typedef unsigned long long key_type;
+
+		void cell_coords(const pos_type& x, long* c) const;
+		key_type cell_key(const long* c) const;
+		bool overlap(size_t i, size_t j) const;
+		bool overlap(size_t i, const pos_type& lo, const pos_type& hi) const;
+
+		/// call f(key) for all cells intersecting the box
+		template <typename TFunc>
+		void for_each_cell(const pos_type& lo, const pos_type& hi, TFunc& f) const;
+
+	private:
+		std::vector<pos_type> m_vLo;
+		std::vector<pos_type> m_vHi;
+
+		value_type m_cellSize;
+		value_type m_h;
+		pos_type m_origin;
+
+		/// (cell key, box index), sorted
+		std::vector<std::pair<key_type, size_t> > m_vEntries;
+
+		bool m_bBuilt;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "aabb_hash_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__AABB_HASH_H
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "aabb_hash.h"
+
+#include <algorithm>                     // for std::sort, std::unique, std::lower_bound
+#include <cmath>                         // for std::floor, std::pow
+
+#include "common/error.h"                // for UG_COND_THROW
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <int dim>
+AABBHash<dim>::AABBHash()
+: m_cellSize(0.0), m_h(1.0), m_bBuilt(false)
+{}
+
+
+template <int dim>
+size_t AABBHash<dim>::add_box(const pos_type& lo, const pos_type& hi)
+{
+	m_vLo.push_back(lo);
+	m_vHi.push_back(hi);
+	m_bBuilt = false;
+	return m_vLo.size() - 1;
+}
+
+
+template <int dim>
+size_t AABBHash<dim>::add_ball(const pos_type& center, value_type radius)
+{
+	pos_type lo, hi;
+	for (int d = 0; d < dim; ++d)
+	{
+		lo[d] = center[d] - radius;
+		hi[d] = center[d] + radius;
+	}
+	return add_box(lo, hi);
+}
+
+
+template <int dim>
+size_t AABBHash<dim>::add_capsule(const pos_type& a, const pos_type& b, value_type radius)
+{
+	pos_type lo, hi;
+	for (int d = 0; d < dim; ++d)
+	{
+		lo[d] = std::min(a[d], b[d]) - radius;
+		hi[d] = std::max(a[d], b[d]) + radius;
+	}
+	return add_box(lo, hi);
+}
+
+
+template <int dim>
+void AABBHash<dim>::clear()
+{
+	m_vLo.clear();
+	m_vHi.clear();
+	m_vEntries.clear();
+	m_bBuilt = false;
+}
+
+
+template <int dim>
+void AABBHash<dim>::cell_coords(const pos_type& x, long* c) const
+{
+	for (int d = 0; d < dim; ++d)
+		c[d] = (long) std::floor((x[d] - m_origin[d]) / m_h);
+}
+
+
+template <int dim>
+typename AABBHash<dim>::key_type AABBHash<dim>::cell_key(const long* c) const
+{
+	static const key_type primes[3] = {73856093ULL, 19349669ULL, 83492791ULL};
+	key_type key = 0;
+	for (int d = 0; d < dim; ++d)
+		key = key * 1099511628211ULL + (key_type) c[d] * primes[d % 3];
+	return key;
+}
+
+
+template <int dim>
+template <typename TFunc>
+void AABBHash<dim>::for_each_cell(const pos_type& lo, const pos_type& hi, TFunc& f) const
+{
+	long cLo[dim], cHi[dim], c[dim];
+	cell_coords(lo, cLo);
+	cell_coords(hi, cHi);
+	for (int d = 0; d < dim; ++d)
+		c[d] = cLo[d];
+
+	// iterate over all cells of the box (odometer-like)
+	while (true)
+	{
+		f(cell_key(c));
+
+		int d = 0;
+		for (; d < dim; ++d)
+		{
+			if (c[d] < cHi[d]) {++c[d]; break;}
+			c[d] = cLo[d];
+		}
+		if (d == dim)
+			break;
+	}
+}
+
+
+namespace aabb_hash_detail
+{
+	template <typename TKey>
+	struct EntryCollector
+	{
+		EntryCollector(std::vector<std::pair<TKey, size_t> >& _vEntries, size_t _ind)
+		: vEntries(_vEntries), ind(_ind) {}
+
+		void operator()(TKey key) {vEntries.push_back(std::make_pair(key, ind));}
+
+		std::vector<std::pair<TKey, size_t> >& vEntries;
+		size_t ind;
+	};
+
+	template <typename TKey>
+	struct KeyCollector
+	{
+		KeyCollector(std::vector<TKey>& _vKeys)
+		: vKeys(_vKeys) {}
+
+		void operator()(TKey key) {vKeys.push_back(key);}
+
+		std::vector<TKey>& vKeys;
+	};
+} // namespace aabb_hash_detail
+
+
+template <int dim>
+void AABBHash<dim>::build()
+{
+	m_vEntries.clear();
+	m_bBuilt = true;
+
+	const size_t nBoxes = m_vLo.size();
+	if (!nBoxes)
+		return;
+
+	// bounding box of all boxes and mean extent
+	pos_type gLo = m_vLo[0], gHi = m_vHi[0];
+	value_type meanExtent = 0.0;
+	for (size_t i = 0; i < nBoxes; ++i)
+	{
+		value_type ext = 0.0;
+		for (int d = 0; d < dim; ++d)
+		{
+			UG_COND_THROW(m_vHi[i][d] < m_vLo[i][d], "Box " << i << " has negative extent.");
+			gLo[d] = std::min(gLo[d], m_vLo[i][d]);
+			gHi[d] = std::max(gHi[d], m_vHi[i][d]);
+			ext = std::max(ext, m_vHi[i][d] - m_vLo[i][d]);
+		}
+		meanExtent += ext;
+	}
+	meanExtent /= nBoxes;
+
+	m_origin = gLo;
+	m_h = m_cellSize > 0.0 ? m_cellSize : meanExtent;
+	if (!(m_h > 0.0))
+	{
+		// degenerate boxes: about one box per cell
+		value_type gExt = 0.0;
+		for (int d = 0; d < dim; ++d)
+			gExt = std::max(gExt, gHi[d] - gLo[d]);
+		m_h = gExt > 0.0 ? gExt / std::pow((value_type) nBoxes, (value_type) 1.0 / dim) : 1.0;
+	}
+
+	for (size_t i = 0; i < nBoxes; ++i)
+	{
+		aabb_hash_detail::EntryCollector<key_type> collect(m_vEntries, i);
+		for_each_cell(m_vLo[i], m_vHi[i], collect);
+	}
+	std::sort(m_vEntries.begin(), m_vEntries.end());
+}
+
+
+template <int dim>
+bool AABBHash<dim>::overlap(size_t i, size_t j) const
+{
+	return overlap(i, m_vLo[j], m_vHi[j]);
+}
+
+
+template <int dim>
+bool AABBHash<dim>::overlap(size_t i, const pos_type& lo, const pos_type& hi) const
+{
+	for (int d = 0; d < dim; ++d)
+		if (m_vHi[i][d] < lo[d] || hi[d] < m_vLo[i][d])
+			return false;
+	return true;
+}
+
+
+template <int dim>
+void AABBHash<dim>::overlapping_pairs(std::vector<std::pair<size_t, size_t> >& vPairsOut) const
+{
+	UG_COND_THROW(!m_bBuilt, "AABBHash must be built before querying.");
+	vPairsOut.clear();
+
+	const size_t nEntries = m_vEntries.size();
+	size_t groupBegin = 0;
+	while (groupBegin < nEntries)
+	{
+		size_t groupEnd = groupBegin + 1;
+		while (groupEnd < nEntries && m_vEntries[groupEnd].first == m_vEntries[groupBegin].first)
+			++groupEnd;
+
+		for (size_t a = groupBegin; a < groupEnd; ++a)
+		{
+			for (size_t b = a + 1; b < groupEnd; ++b)
+			{
+				const size_t i = m_vEntries[a].second;
+				const size_t j = m_vEntries[b].second;
+				if (overlap(i, j))
+					vPairsOut.push_back(std::make_pair(std::min(i, j), std::max(i, j)));
+			}
+		}
+
+		groupBegin = groupEnd;
+	}
+
+	// pairs sharing several cells are found several times
+	std::sort(vPairsOut.begin(), vPairsOut.end());
+	vPairsOut.erase(std::unique(vPairsOut.begin(), vPairsOut.end()), vPairsOut.end());
+}
+
+
+template <int dim>
+void AABBHash<dim>::overlapping_boxes
+(
+	const pos_type& lo,
+	const pos_type& hi,
+	std::vector<size_t>& vIndOut
+) const
+{
+	UG_COND_THROW(!m_bBuilt, "AABBHash must be built before querying.");
+	vIndOut.clear();
+	if (m_vEntries.empty())
+		return;
+
+	std::vector<key_type> vKeys;
+	aabb_hash_detail::KeyCollector<key_type> collect(vKeys);
+	for_each_cell(lo, hi, collect);
+	std::sort(vKeys.begin(), vKeys.end());
+	vKeys.erase(std::unique(vKeys.begin(), vKeys.end()), vKeys.end());
+
+	for (size_t k = 0; k < vKeys.size(); ++k)
+	{
+		typename std::vector<std::pair<key_type, size_t> >::const_iterator it =
+			std::lower_bound(m_vEntries.begin(), m_vEntries.end(), std::make_pair(vKeys[k], (size_t) 0));
+		for (; it != m_vEntries.end() && it->first == vKeys[k]; ++it)
+			if (overlap(it->second, lo, hi))
+				vIndOut.push_back(it->second);
+	}
+
+	std::sort(vIndOut.begin(), vIndOut.end());
+	vIndOut.erase(std::unique(vIndOut.begin(), vIndOut.end()), vIndOut.end());
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
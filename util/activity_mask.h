@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__ACTIVITY_MASK_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__ACTIVITY_MASK_H
+
+#include "common/math/ugmath.h"  // for MathVector
+#include "common/types.h"  // for number
+#include "lib_grid/grid/grid_base_objects.h"  // for GridObject
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/// Bookkeeping of quiescent membrane integration points
+/**
+ * Most of a membrane carries negligible transport flux at any given time
+ * (e.g., ahead of and behind a travelling calcium wave). This class keeps track
+ * of integration points (identified by element and coordinates) where both the
+ * flux and its derivatives were found to be below a threshold. Such points are
+ * considered inactive and can be skipped during assembling as long as their
+ * activity indicators (usually the local unknowns the flux depends on, e.g. the
+ * calcium concentration) stay within a relative tolerance of the values they had
+ * when the point was found quiescent. Any larger change wakes the point up again.
+ *
+ * Flux and derivative quiescence are recorded separately, since they are computed
+ * in different assembling passes; a point is only inactive if both are quiescent.
+ */
+template <int dim>
+class ActivityMask
+{
+	public:
+		/// constructor
+		ActivityMask();
+
+		/// set flux magnitude below which a point is considered quiescent
+		void set_flux_threshold(number thresh) {m_fluxThresh = thresh; clear();}
+
+		/// set relative change of the activity indicators that wakes a point up
+		void set_wake_tolerance(number tol) {m_wakeTol = tol; clear();}
+
+		/// forget all recorded points
+		void clear() {m_mEntries.clear();}
+
+		/**
+		 * @brief whether the point can be skipped
+		 * If the point has been recorded as quiescent but its indicators have changed
+		 * by more than the wake tolerance, its record is discarded and false is returned.
+		 */
+		bool is_inactive(GridObject* e, const MathVector<dim>& coords, const std::vector<number>& vInd);
+
+		/**
+		 * @brief record the flux magnitude at a point
+		 * @param e       element
+		 * @param coords  integration point coordinates
+		 * @param vInd    current activity indicators of the point
+		 * @param mag     maximal magnitude of the fluxes at the point
+		 */
+		void record_flux(GridObject* e, const MathVector<dim>& coords, const std::vector<number>& vInd, number mag);
+
+		/**
+		 * @brief record the flux derivative magnitude at a point
+		 * The magnitude should be given as the maximal flux change produced by
+		 * a relative change of one of the unknowns by 100% (i.e., |dj/du * u|),
+		 * so that it is comparable to the flux threshold.
+		 */
+		void record_deriv(GridObject* e, const MathVector<dim>& coords, const std::vector<number>& vInd, number mag);
+
+		/// number of currently inactive points
+		size_t num_inactive() const;
+
+	protected:
+		struct Entry
+		{
+			MathVector<dim> coords;
+			std::vector<number> vIndRef;
+			bool bFluxQuiet;
+			bool bDerivQuiet;
+		};
+
+		/// get entry for point (creating it if necessary)
+		Entry& entry(GridObject* e, const MathVector<dim>& coords);
+
+		/// whether indicators are still within tolerance of the reference values
+		bool indicators_unchanged(const Entry& entry, const std::vector<number>& vInd) const;
+
+		/// update reference values if indicators have changed
+		void update_reference(Entry& entry, const std::vector<number>& vInd);
+
+	private:
+		number m_fluxThresh;
+		number m_wakeTol;
+		std::map<GridObject*, std::vector<Entry> > m_mEntries;
+};
+
+/// @}
+
+} // namspace neuro_collection
+} // namespace ug
+
+#include "activity_mask_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__ACTIVITY_MASK_H
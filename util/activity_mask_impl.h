@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "activity_mask.h"
+
+#include <cmath>  // for fabs
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <int dim>
+ActivityMask<dim>::ActivityMask()
+: m_fluxThresh(0.0), m_wakeTol(1e-2)
+{}
+
+
+template <int dim>
+typename ActivityMask<dim>::Entry& ActivityMask<dim>::entry(GridObject* e, const MathVector<dim>& coords)
+{
+	std::vector<Entry>& vEntry = m_mEntries[e];
+	const size_t nIP = vEntry.size();
+	for (size_t k = 0; k < nIP; ++k)
+		if (VecDistanceSq(vEntry[k].coords, coords) == 0.0)
+			return vEntry[k];
+
+	vEntry.resize(nIP + 1);
+	Entry& newEntry = vEntry.back();
+	newEntry.coords = coords;
+	newEntry.bFluxQuiet = false;
+	newEntry.bDerivQuiet = false;
+	return newEntry;
+}
+
+
+template <int dim>
+bool ActivityMask<dim>::indicators_unchanged(const Entry& entry, const std::vector<number>& vInd) const
+{
+	const size_t nInd = vInd.size();
+	if (entry.vIndRef.size() != nInd)
+		return false;
+
+	for (size_t i = 0; i < nInd; ++i)
+		if (fabs(vInd[i] - entry.vIndRef[i]) > m_wakeTol * fabs(entry.vIndRef[i]))
+			return false;
+
+	return true;
+}
+
+
+template <int dim>
+void ActivityMask<dim>::update_reference(Entry& entry, const std::vector<number>& vInd)
+{
+	if (indicators_unchanged(entry, vInd))
+		return;
+
+	entry.vIndRef = vInd;
+	entry.bFluxQuiet = false;
+	entry.bDerivQuiet = false;
+}
+
+
+template <int dim>
+bool ActivityMask<dim>::is_inactive(GridObject* e, const MathVector<dim>& coords, const std::vector<number>& vInd)
+{
+	typename std::map<GridObject*, std::vector<Entry> >::iterator it = m_mEntries.find(e);
+	if (it == m_mEntries.end())
+		return false;
+
+	std::vector<Entry>& vEntry = it->second;
+	const size_t nIP = vEntry.size();
+	for (size_t k = 0; k < nIP; ++k)
+	{
+		Entry& ent = vEntry[k];
+		if (VecDistanceSq(ent.coords, coords) != 0.0)
+			continue;
+
+		if (!ent.bFluxQuiet || !ent.bDerivQuiet)
+			return false;
+
+		// wake up
+		if (!indicators_unchanged(ent, vInd))
+		{
+			ent.bFluxQuiet = false;
+			ent.bDerivQuiet = false;
+			return false;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+
+template <int dim>
+void ActivityMask<dim>::record_flux
+(
+	GridObject* e,
+	const MathVector<dim>& coords,
+	const std::vector<number>& vInd,
+	number mag
+)
+{
+	Entry& ent = entry(e, coords);
+	update_reference(ent, vInd);
+	ent.bFluxQuiet = mag < m_fluxThresh;
+}
+
+
+template <int dim>
+void ActivityMask<dim>::record_deriv
+(
+	GridObject* e,
+	const MathVector<dim>& coords,
+	const std::vector<number>& vInd,
+	number mag
+)
+{
+	Entry& ent = entry(e, coords);
+	update_reference(ent, vInd);
+	ent.bDerivQuiet = mag < m_fluxThresh;
+}
+
+
+template <int dim>
+size_t ActivityMask<dim>::num_inactive() const
+{
+	size_t n = 0;
+	typename std::map<GridObject*, std::vector<Entry> >::const_iterator it = m_mEntries.begin();
+	for (; it != m_mEntries.end(); ++it)
+	{
+		const std::vector<Entry>& vEntry = it->second;
+		for (size_t k = 0; k < vEntry.size(); ++k)
+			if (vEntry[k].bFluxQuiet && vEntry[k].bDerivQuiet)
+				++n;
+	}
+	return n;
+}
+
+
+} // namspace neuro_collection
+} // namespace ug
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "assembly_benchmark.h"
+
+#ifdef UG_DIM_2
+
+#include <algorithm>                                         // for std::min, std::max
+#include <cstdlib>                                           // for atoi
+#include <fstream>                                           // for ofstream
+#include <limits>                                            // for numeric_limits
+#include <sstream>                                           // for ostringstream
+#include <vector>                                            // for vector
+
+#include "common/error.h"                                    // for UG_COND_THROW
+#include "common/log.h"                                      // for UG_LOGN
+#include "common/stopwatch.h"                                // for Stopwatch
+#include "common/util/string_util.h"                         // for TokenizeTrimString
+#include "lib_algebra/cpu_algebra_types.h"                   // for CPUAlgebra
+#include "lib_disc/function_spaces/approximation_space.h"    // for ApproximationSpace
+#include "lib_disc/function_spaces/grid_function.h"          // for GridFunction
+#include "lib_disc/function_spaces/interpolate.h"            // for Interpolate
+#include "lib_disc/spatial_disc/domain_disc.h"               // for DomainDiscretization
+#include "../buffer_fv1.h"                                   // for BufferFV1
+#include "../membrane_transport_fv1.h"                       // for MembraneTransportFV1
+#include "../grid_generation/dendrite_generator.h"           // for DendriteGenerator
+#include "../membrane_transporters/leak.h"                   // for Leak
+#include "../membrane_transporters/ncx.h"                    // for NCX
+#include "../membrane_transporters/pmca.h"                   // for PMCA
+#include "../membrane_transporters/ryr_implicit.h"           // for RyRImplicit
+#include "../membrane_transporters/serca.h"                  // for SERCA
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_base.h"                                // for NumProcs, ProcRank
+	#include "pcl/pcl_process_communicator.h"                // for ProcessCommunicator
+#endif
+
+#ifdef _OPENMP
+	#include <omp.h>
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+void CreateAssemblyBenchmarkDendrite(SmartPtr<Domain2d> dom, size_t numSegments)
+{
+	UG_COND_THROW(!dom.valid(), "Invalid domain given.");
+
+#ifdef UG_PARALLEL
+	if (pcl::ProcRank() != 0)
+		return;
+#endif
+
+	DendriteGenerator dg;
+	dg.set_num_segments(numSegments);
+	dg.create_dendrite(*dom->grid(), *dom->subset_handler());
+}
+
+
+
+namespace {
+
+typedef Domain2d TDomain;
+typedef CPUAlgebra TAlgebra;
+typedef GridFunction<TDomain, TAlgebra> TGridFunction;
+typedef DomainDiscretization<TDomain, TAlgebra> TDomDisc;
+
+/// a set of element discs assembled together, with the number of elements they assemble
+struct BenchmarkGroup
+{
+	std::string name;
+	std::vector<SmartPtr<IElemDisc<TDomain> > > vDisc;
+	std::string subsets;  ///< subsets whose elements are counted
+	int elemDim;          ///< dimension of the counted elements
+};
+
+
+number max_over_procs(number t)
+{
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		return com.allreduce(t, PCL_RO_MAX);
+	}
+#endif
+	return t;
+}
+
+
+void barrier()
+{
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		com.barrier();
+	}
+#endif
+}
+
+
+template <typename TElem>
+size_t count_surface_elems(SmartPtr<DoFDistribution> dd, int si)
+{
+	size_t n = 0;
+	typedef typename DoFDistribution::traits<TElem>::const_iterator iter_type;
+	iter_type itEnd = dd->end<TElem>(si);
+	for (iter_type it = dd->begin<TElem>(si); it != itEnd; ++it)
+		++n;
+	return n;
+}
+
+
+size_t count_global_elems(SmartPtr<ApproximationSpace<TDomain> > approx, const BenchmarkGroup& g)
+{
+	SmartPtr<DoFDistribution> dd = approx->dd(GridLevel(), false);
+	ConstSmartPtr<MGSubsetHandler> sh = approx->domain()->subset_handler();
+
+	const std::vector<std::string> vSubset = TokenizeTrimString(g.subsets);
+	size_t n = 0;
+	for (size_t i = 0; i < vSubset.size(); ++i)
+	{
+		const int si = sh->get_subset_index(vSubset[i].c_str());
+		if (si < 0)
+			continue;
+		n += g.elemDim == 2 ? count_surface_elems<Face>(dd, si) : count_surface_elems<Edge>(dd, si);
+	}
+
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		n = com.allreduce(n, PCL_RO_SUM);
+	}
+#endif
+	return n;
+}
+
+} // anonymous namespace
+
+
+
+void RunAssemblyBenchmark
+(
+	SmartPtr<Domain2d> dom,
+	const std::string& label,
+	const std::string& threadCounts,
+	size_t numReps,
+	const std::string& jsonFile
+)
+{
+	UG_COND_THROW(!dom.valid(), "Invalid domain given.");
+	numReps = std::max(numReps, (size_t) 1);
+
+	std::vector<int> vNumThreads;
+	const std::vector<std::string> vTC = TokenizeTrimString(threadCounts);
+	for (size_t i = 0; i < vTC.size(); ++i)
+		vNumThreads.push_back(std::max(atoi(vTC[i].c_str()), 1));
+	if (vNumThreads.empty())
+		vNumThreads.push_back(1);
+
+	int numProcs = 1;
+	int rank = 0;
+#ifdef UG_PARALLEL
+	numProcs = pcl::NumProcs();
+	rank = pcl::ProcRank();
+#endif
+
+	// approximation space
+	const char* cytSubsets = "cyt, pm, erm, act, meas";
+	SmartPtr<ApproximationSpace<TDomain> > approx = make_sp(new ApproximationSpace<TDomain>(dom));
+	approx->add("ca_cyt", "Lagrange", 1, cytSubsets);
+	approx->add("clb", "Lagrange", 1, cytSubsets);
+	approx->add("ca_er", "Lagrange", 1, "er, erm");
+	approx->add("o2", "Lagrange", 1, "erm");
+	approx->add("c1", "Lagrange", 1, "erm");
+	approx->add("c2", "Lagrange", 1, "erm");
+	approx->init_levels();
+	approx->init_top_surface();
+
+	// standard calcium model
+	SmartPtr<BufferFV1<TDomain> > buffer = make_sp(new BufferFV1<TDomain>("cyt"));
+	buffer->add_reaction("clb", "ca_cyt", 4.0e-2, 27.0e3, 19.0);
+
+	SmartPtr<MembraneTransportFV1<TDomain> > serca =
+		make_sp(new MembraneTransportFV1<TDomain>("erm", make_sp(new SERCA("ca_cyt, ca_er"))));
+	serca->set_density_function(1973.0);
+
+	SmartPtr<MembraneTransportFV1<TDomain> > leak =
+		make_sp(new MembraneTransportFV1<TDomain>("erm", make_sp(new Leak("ca_er, ca_cyt"))));
+	leak->set_density_function(3.8e-17);
+
+	SmartPtr<RyRImplicit<TDomain> > ryr =
+		make_sp(new RyRImplicit<TDomain>("ca_cyt, ca_er, o2, c1, c2", "erm"));
+	SmartPtr<MembraneTransportFV1<TDomain> > ryrFlux =
+		make_sp(new MembraneTransportFV1<TDomain>("erm", ryr));
+	ryrFlux->set_density_function(0.86);
+
+	std::vector<std::string> vPMFct(2);
+	vPMFct[0] = "ca_cyt";
+	SmartPtr<PMCA> pmcaMech = make_sp(new PMCA(vPMFct));
+	pmcaMech->set_constant(1, 1.5);
+	SmartPtr<MembraneTransportFV1<TDomain> > pmca =
+		make_sp(new MembraneTransportFV1<TDomain>("pm", pmcaMech));
+	pmca->set_density_function(500.0);
+
+	SmartPtr<NCX> ncxMech = make_sp(new NCX(vPMFct));
+	ncxMech->set_constant(1, 1.5);
+	SmartPtr<MembraneTransportFV1<TDomain> > ncx =
+		make_sp(new MembraneTransportFV1<TDomain>("pm", ncxMech));
+	ncx->set_density_function(15.0);
+
+	// benchmark groups
+	std::vector<BenchmarkGroup> vGroup(8);
+	vGroup[0].name = "BufferFV1";
+	vGroup[0].vDisc.push_back(buffer);
+	vGroup[0].subsets = "cyt";
+	vGroup[1].name = "MembraneTransportFV1[SERCA]";
+	vGroup[1].vDisc.push_back(serca);
+	vGroup[1].subsets = "erm";
+	vGroup[2].name = "MembraneTransportFV1[Leak]";
+	vGroup[2].vDisc.push_back(leak);
+	vGroup[2].subsets = "erm";
+	vGroup[3].name = "MembraneTransportFV1[RyRImplicit]";
+	vGroup[3].vDisc.push_back(ryrFlux);
+	vGroup[3].subsets = "erm";
+	vGroup[4].name = "MembraneTransportFV1[PMCA]";
+	vGroup[4].vDisc.push_back(pmca);
+	vGroup[4].subsets = "pm";
+	vGroup[5].name = "MembraneTransportFV1[NCX]";
+	vGroup[5].vDisc.push_back(ncx);
+	vGroup[5].subsets = "pm";
+	vGroup[6].name = "RyRImplicit";
+	vGroup[6].vDisc.push_back(ryr);
+	vGroup[6].subsets = "erm";
+	vGroup[7].name = "all";
+	for (size_t g = 0; g < 7; ++g)
+		vGroup[7].vDisc.push_back(vGroup[g].vDisc[0]);
+	vGroup[7].subsets = "cyt, er, pm, erm";
+	for (size_t g = 0; g < vGroup.size(); ++g)
+		vGroup[g].elemDim = vGroup[g].subsets == "cyt" ? 2 : 1;
+	vGroup[7].elemDim = 2;
+
+	// solution at rest
+	SmartPtr<TGridFunction> u = make_sp(new TGridFunction(approx));
+	SmartPtr<TGridFunction> d = make_sp(new TGridFunction(approx));
+	u->set(0.0);
+	Interpolate(5.0e-5, u, "ca_cyt");
+	Interpolate(3.9e-2, u, "clb");
+	Interpolate(2.5e-1, u, "ca_er");
+	Interpolate(0.9, u, "c1");
+	Interpolate(0.1, u, "c2");
+	TAlgebra::matrix_type J;
+
+	std::ofstream ofs;
+	if (rank == 0)
+	{
+		ofs.open(jsonFile.c_str(), std::ios_base::app);
+		UG_COND_THROW(!ofs.is_open(), "Could not open benchmark output file '" << jsonFile << "'.");
+	}
+
+	for (size_t g = 0; g < vGroup.size(); ++g)
+	{
+		const BenchmarkGroup& grp = vGroup[g];
+		TDomDisc domDisc(approx);
+		for (size_t i = 0; i < grp.vDisc.size(); ++i)
+			domDisc.add(grp.vDisc[i]);
+
+		// the "all" group counts the elements of full dimension only
+		const size_t nElem = count_global_elems(approx, grp);
+
+		for (size_t t = 0; t < vNumThreads.size(); ++t)
+		{
+#ifdef _OPENMP
+			omp_set_num_threads(vNumThreads[t]);
+#else
+			if (vNumThreads[t] != 1)
+				continue;
+#endif
+
+			// warm-up (first assemblings include setup of the disc)
+			domDisc.assemble_defect(*d, *u, u->grid_level());
+			domDisc.assemble_jacobian(J, *u, u->grid_level());
+
+			number tDef = std::numeric_limits<number>::max();
+			number tJac = std::numeric_limits<number>::max();
+			for (size_t r = 0; r < numReps; ++r)
+			{
+				Stopwatch sw;
+				barrier();
+				sw.start();
+				domDisc.assemble_defect(*d, *u, u->grid_level());
+				tDef = std::min(tDef, max_over_procs(sw.ms() / 1000.0));
+
+				barrier();
+				sw.start();
+				domDisc.assemble_jacobian(J, *u, u->grid_level());
+				tJac = std::min(tJac, max_over_procs(sw.ms() / 1000.0));
+			}
+
+			if (rank != 0)
+				continue;
+
+			std::ostringstream oss;
+			oss << "{\"label\": \"" << label << "\", \"procs\": " << numProcs
+				<< ", \"threads\": " << vNumThreads[t] << ", \"disc\": \"" << grp.name
+				<< "\", \"elements\": " << nElem << ", \"defect_s\": " << tDef
+				<< ", \"jacobian_s\": " << tJac
+				<< ", \"defect_elems_per_s\": " << (tDef > 0.0 ? nElem / tDef : 0.0)
+				<< ", \"jacobian_elems_per_s\": " << (tJac > 0.0 ? nElem / tJac : 0.0) << "}";
+			ofs << oss.str() << std::endl;
+			UG_LOGN(oss.str());
+		}
+	}
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG_DIM_2
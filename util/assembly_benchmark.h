@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__ASSEMBLY_BENCHMARK_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__ASSEMBLY_BENCHMARK_H
+
+#include <cstddef>                       // for size_t
+#include <string>                        // for string
+
+#include "common/util/smart_pointer.h"   // for SmartPtr
+#include "lib_disc/domain.h"             // for Domain2d
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+#ifdef UG_DIM_2
+
+/**
+ * @brief Generate the dendrite geometry of the assembly benchmark into a domain
+ *
+ * The dendrite (with ER) is created by DendriteGenerator::create_dendrite()
+ * with the given number of segments and default dimensions. It is only created
+ * on process 0; in parallel runs, the domain is to be distributed afterwards
+ * (as any loaded domain) before running the benchmark.
+ *
+ * @param dom          domain (empty)
+ * @param numSegments  number of axial segments (see DendriteGenerator::set_num_segments())
+ */
+void CreateAssemblyBenchmarkDendrite(SmartPtr<Domain2d> dom, size_t numSegments);
+
+
+/**
+ * @brief Measure the element assembling throughput of the calcium model discretizations
+ *
+ * A standard calcium model is set up on a domain created by CreateAssemblyBenchmarkDendrite():
+ * calbindin buffering (BufferFV1) in the cytosol, SERCA, leakage and implicit RyR
+ * (MembraneTransportFV1) on the ER membrane, PMCA and NCX on the plasma membrane and
+ * the RyR channel state equations (RyRImplicit).
+ * Each discretization is assembled on its own (and all of them together), the defect
+ * and the Jacobian separately, for each given number of threads. Times are maxima
+ * over all processes after a barrier; element counts are global.
+ *
+ * Results are appended to the given file as JSON lines (one object per measurement),
+ * so that runs with different numbers of processes and segments can be collected
+ * in one file for regression tracking.
+ * This function is collective; only process 0 writes.
+ *
+ * @param dom           domain (as created by CreateAssemblyBenchmarkDendrite())
+ * @param label         label written into each result (e.g. the number of segments)
+ * @param threadCounts  comma-separated numbers of threads (ignored without OpenMP)
+ * @param numReps       number of repetitions per measurement (the minimum time is reported)
+ * @param jsonFile      output file (results are appended)
+ */
+void RunAssemblyBenchmark
+(
+	SmartPtr<Domain2d> dom,
+	const std::string& label,
+	const std::string& threadCounts,
+	size_t numReps,
+	const std::string& jsonFile
+);
+
+#endif // UG_DIM_2
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__ASSEMBLY_BENCHMARK_H
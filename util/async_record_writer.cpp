@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "async_record_writer.h"
+
+#include <cstring>                       // for memcpy, memcmp
+#include <fstream>                       // for ofstream
+#include <iomanip>                       // for setprecision
+#include <limits>                        // for numeric_limits
+#include <stdint.h>                      // for uint32_t, uint64_t
+
+#include "common/error.h"                // for UG_COND_THROW
+#include "common/log.h"                  // for UG_LOG
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+static const char recordFileMagic[8] = {'N', 'C', 'R', 'E', 'C', '0', '0', '1'};
+
+
+AsyncRecordWriter::AsyncRecordWriter
+(
+	const std::string& fileName,
+	const std::vector<std::string>& vColName,
+	bool append,
+	size_t batchBytes
+)
+: m_fileName(fileName), m_file(NULL), m_batchBytes(batchBytes),
+  m_pFill(new std::vector<char>()), m_bError(false)
+{
+	// header is only written to new (or empty) files
+	bool bHeader = true;
+	if (append)
+	{
+		FILE* f = fopen(fileName.c_str(), "rb");
+		if (f)
+		{
+			bHeader = fgetc(f) == EOF;
+			fclose(f);
+		}
+	}
+
+	m_file = fopen(fileName.c_str(), append ? "ab" : "wb");
+	UG_COND_THROW(!m_file, "Output file '" << fileName << "' could not be opened.");
+
+	m_pFill->reserve(m_batchBytes);
+	if (bHeader)
+	{
+		append_bytes(recordFileMagic, 8);
+		const uint32_t nCol = (uint32_t) vColName.size();
+		append_bytes(&nCol, sizeof(uint32_t));
+		for (size_t i = 0; i < vColName.size(); ++i)
+		{
+			const uint32_t len = (uint32_t) vColName[i].size();
+			append_bytes(&len, sizeof(uint32_t));
+			append_bytes(vColName[i].data(), len);
+		}
+	}
+
+#ifdef NC_ASYNC_RECORD_WRITER_THREAD
+	m_bBusy = false;
+	m_bStop = false;
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_condWork, NULL);
+	pthread_cond_init(&m_condDone, NULL);
+	if (pthread_create(&m_thread, NULL, &AsyncRecordWriter::writer_main, this))
+	{
+		pthread_cond_destroy(&m_condDone);
+		pthread_cond_destroy(&m_condWork);
+		pthread_mutex_destroy(&m_mutex);
+		fclose(m_file);
+		delete m_pFill;
+		UG_THROW("Writer thread for output file '" << fileName << "' could not be started.");
+	}
+#endif
+}
+
+
+AsyncRecordWriter::~AsyncRecordWriter()
+{
+	// write remaining records
+	if (!m_pFill->empty())
+		submit_batch();
+
+#ifdef NC_ASYNC_RECORD_WRITER_THREAD
+	pthread_mutex_lock(&m_mutex);
+	m_bStop = true;
+	pthread_cond_signal(&m_condWork);
+	pthread_mutex_unlock(&m_mutex);
+	pthread_join(m_thread, NULL);
+
+	pthread_cond_destroy(&m_condDone);
+	pthread_cond_destroy(&m_condWork);
+	pthread_mutex_destroy(&m_mutex);
+
+	for (size_t i = 0; i < m_vFree.size(); ++i)
+		delete m_vFree[i];
+#endif
+
+	delete m_pFill;
+	fclose(m_file);
+
+	if (m_bError)
+		UG_LOG("WARNING: Not all records could be written to '" << m_fileName << "'.\n");
+}
+
+
+void AsyncRecordWriter::append_bytes(const void* p, size_t nBytes)
+{
+	const size_t oldSize = m_pFill->size();
+	m_pFill->resize(oldSize + nBytes);
+	if (nBytes)
+		memcpy(&(*m_pFill)[oldSize], p, nBytes);
+}
+
+
+void AsyncRecordWriter::write(const number* vals, size_t n)
+{
+	check_error();
+
+	const uint64_t n64 = (uint64_t) n;
+	append_bytes(&n64, sizeof(uint64_t));
+	for (size_t i = 0; i < n; ++i)
+	{
+		const double v = (double) vals[i];
+		append_bytes(&v, sizeof(double));
+	}
+
+	if (m_pFill->size() >= m_batchBytes)
+		submit_batch();
+}
+
+
+void AsyncRecordWriter::flush()
+{
+	if (!m_pFill->empty())
+		submit_batch();
+
+#ifdef NC_ASYNC_RECORD_WRITER_THREAD
+	pthread_mutex_lock(&m_mutex);
+	while (!m_queue.empty() || m_bBusy)
+		pthread_cond_wait(&m_condDone, &m_mutex);
+	pthread_mutex_unlock(&m_mutex);
+#endif
+
+	check_error();
+}
+
+
+void AsyncRecordWriter::submit_batch()
+{
+#ifdef NC_ASYNC_RECORD_WRITER_THREAD
+	pthread_mutex_lock(&m_mutex);
+	m_queue.push_back(m_pFill);
+	if (m_vFree.empty())
+		m_pFill = new std::vector<char>();
+	else
+	{
+		m_pFill = m_vFree.back();
+		m_vFree.pop_back();
+	}
+	pthread_cond_signal(&m_condWork);
+	pthread_mutex_unlock(&m_mutex);
+
+	m_pFill->clear();
+	m_pFill->reserve(m_batchBytes);
+#else
+	write_batch(*m_pFill);
+	m_pFill->clear();
+#endif
+}
+
+
+void AsyncRecordWriter::write_batch(const std::vector<char>& batch)
+{
+	if (batch.empty())
+		return;
+
+	const bool ok = fwrite(&batch[0], 1, batch.size(), m_file) == batch.size()
+		&& fflush(m_file) == 0;
+
+	if (!ok)
+	{
+#ifdef NC_ASYNC_RECORD_WRITER_THREAD
+		pthread_mutex_lock(&m_mutex);
+		m_bError = true;
+		pthread_mutex_unlock(&m_mutex);
+#else
+		m_bError = true;
+#endif
+	}
+}
+
+
+void AsyncRecordWriter::check_error()
+{
+	bool bError;
+#ifdef NC_ASYNC_RECORD_WRITER_THREAD
+	pthread_mutex_lock(&m_mutex);
+	bError = m_bError;
+	pthread_mutex_unlock(&m_mutex);
+#else
+	bError = m_bError;
+#endif
+	UG_COND_THROW(bError, "Output file '" << m_fileName << "' could not be written to.");
+}
+
+
+#ifdef NC_ASYNC_RECORD_WRITER_THREAD
+void* AsyncRecordWriter::writer_main(void* arg)
+{
+	static_cast<AsyncRecordWriter*>(arg)->writer_loop();
+	return NULL;
+}
+
+
+void AsyncRecordWriter::writer_loop()
+{
+	pthread_mutex_lock(&m_mutex);
+	while (true)
+	{
+		while (m_queue.empty() && !m_bStop)
+			pthread_cond_wait(&m_condWork, &m_mutex);
+
+		if (m_queue.empty())
+			break;  // stop requested and nothing left to do
+
+		std::vector<char>* pBatch = m_queue.front();
+		m_queue.pop_front();
+		m_bBusy = true;
+		pthread_mutex_unlock(&m_mutex);
+
+		// the actual writing is done without holding the lock
+		write_batch(*pBatch);
+
+		pthread_mutex_lock(&m_mutex);
+		pBatch->clear();
+		m_vFree.push_back(pBatch);
+		m_bBusy = false;
+		pthread_cond_broadcast(&m_condDone);
+	}
+	pthread_mutex_unlock(&m_mutex);
+}
+#endif
+
+
+
+BinaryRecordReader::BinaryRecordReader(const std::string& fileName)
+{
+	FILE* f = fopen(fileName.c_str(), "rb");
+	UG_COND_THROW(!f, "Record file '" << fileName << "' could not be opened.");
+
+	// header
+	char magic[8];
+	uint32_t nCol = 0;
+	bool ok = fread(magic, 1, 8, f) == 8 && !memcmp(magic, recordFileMagic, 8)
+		&& fread(&nCol, sizeof(uint32_t), 1, f) == 1;
+	for (uint32_t i = 0; ok && i < nCol; ++i)
+	{
+		uint32_t len = 0;
+		ok = fread(&len, sizeof(uint32_t), 1, f) == 1;
+		if (!ok) break;
+		std::string name(len, ' ');
+		ok = !len || fread(&name[0], 1, len, f) == len;
+		m_vColName.push_back(name);
+	}
+	if (!ok)
+	{
+		fclose(f);
+		UG_THROW("'" << fileName << "' is not a valid record file.");
+	}
+
+	// records (an incomplete last record, e.g. from an aborted run, is ignored)
+	uint64_t n;
+	std::vector<double> vBuf;
+	while (fread(&n, sizeof(uint64_t), 1, f) == 1)
+	{
+		vBuf.resize((size_t) n);
+		if (n && fread(&vBuf[0], sizeof(double), (size_t) n, f) != (size_t) n)
+			break;
+
+		m_vRecStart.push_back(m_vVal.size());
+		m_vRecSize.push_back((size_t) n);
+		for (size_t i = 0; i < (size_t) n; ++i)
+			m_vVal.push_back((number) vBuf[i]);
+	}
+	fclose(f);
+}
+
+
+std::string BinaryRecordReader::column_name(size_t i) const
+{
+	UG_COND_THROW(i >= m_vColName.size(), "Column index " << i << " out of range.");
+	return m_vColName[i];
+}
+
+
+size_t BinaryRecordReader::record_size(size_t r) const
+{
+	UG_COND_THROW(r >= m_vRecSize.size(), "Record index " << r << " out of range.");
+	return m_vRecSize[r];
+}
+
+
+number BinaryRecordReader::value(size_t r, size_t i) const
+{
+	UG_COND_THROW(i >= record_size(r), "Value index " << i << " out of range for record " << r << ".");
+	return m_vVal[m_vRecStart[r] + i];
+}
+
+
+std::vector<number> BinaryRecordReader::record(size_t r) const
+{
+	const size_t n = record_size(r);
+	return std::vector<number>(m_vVal.begin() + m_vRecStart[r], m_vVal.begin() + m_vRecStart[r] + n);
+}
+
+
+void BinaryRecordReader::export_ascii(const std::string& fileName) const
+{
+	std::ofstream outFile(fileName.c_str(), std::ios_base::out);
+	UG_COND_THROW(!outFile.is_open(), "Output file '" << fileName << "' could not be opened.");
+
+	outFile << std::setprecision(std::numeric_limits<number>::digits10 + 1);
+	const size_t nRec = m_vRecStart.size();
+	for (size_t r = 0; r < nRec; ++r)
+	{
+		const size_t start = m_vRecStart[r];
+		const size_t n = m_vRecSize[r];
+		for (size_t i = 0; i < n; ++i)
+			outFile << (i ? "\t" : "") << m_vVal[start + i];
+		outFile << "\n";
+	}
+
+	UG_COND_THROW(!outFile.good(), "Output file '" << fileName << "' could not be written to.");
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__ASYNC_RECORD_WRITER_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__ASYNC_RECORD_WRITER_H
+
+#include <cstddef>                       // for size_t
+#include <cstdio>                        // for FILE
+#include <deque>                         // for deque
+#include <string>                        // for string
+#include <vector>                        // for vector
+
+#include "common/types.h"                // for number
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define NC_ASYNC_RECORD_WRITER_THREAD
+	#include <pthread.h>                 // for pthread_t, pthread_mutex_t, pthread_cond_t
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Binary record output written by a background thread
+ *
+ * Records (sequences of numbers, e.g. a time and the values measured at that time)
+ * are serialized into an in-memory batch. Full batches are handed over to
+ * a writer thread, so that the simulation does not wait on the file system.
+ * Where threads are not supported, batches are written synchronously
+ * (which still saves the formatting and many small writes).
+ *
+ * The file layout (native byte order) is:
+ *   - header: magic "NCREC001", number of column names (uint32),
+ *     for each column name: its length (uint32) and its characters,
+ *   - records, each consisting of the number of values n (uint64)
+ *     and n doubles.
+ * When appending to an existing file, the header is not written again.
+ * Files can be read with BinaryRecordReader.
+ *
+ * Errors in the writer thread are reported by the next call to write() or flush().
+ */
+class AsyncRecordWriter
+{
+	public:
+		/**
+		 * @brief constructor
+		 *
+		 * @param fileName    output file name
+		 * @param vColName    names of the record entries (informative only)
+		 * @param append      whether to append to an existing file
+		 * @param batchBytes  size of a batch to be written at once (in bytes)
+		 */
+		AsyncRecordWriter
+		(
+			const std::string& fileName,
+			const std::vector<std::string>& vColName,
+			bool append,
+			size_t batchBytes = 1 << 20
+		);
+
+		/// destructor (writes all queued records and stops the writer thread)
+		~AsyncRecordWriter();
+
+		/// queue one record
+		void write(const number* vals, size_t n);
+
+		/// queue one record
+		void write(const std::vector<number>& vals)
+		{write(vals.empty() ? NULL : &vals[0], vals.size());}
+
+		/// write all queued records (waits for the writer thread)
+		void flush();
+
+		/// file name
+		const std::string& file_name() const {return m_fileName;}
+
+	private:
+		// not copyable
+		AsyncRecordWriter(const AsyncRecordWriter&);
+		AsyncRecordWriter& operator=(const AsyncRecordWriter&);
+
+		void append_bytes(const void* p, size_t nBytes);
+		void submit_batch();
+		void write_batch(const std::vector<char>& batch);
+		void check_error();
+
+#ifdef NC_ASYNC_RECORD_WRITER_THREAD
+		static void* writer_main(void* arg);
+		void writer_loop();
+#endif
+
+	private:
+		std::string m_fileName;
+		FILE* m_file;
+		size_t m_batchBytes;
+
+		/// batch being filled by the simulation
+		std::vector<char>* m_pFill;
+
+		/// set by the writer on write failure
+		bool m_bError;
+
+#ifdef NC_ASYNC_RECORD_WRITER_THREAD
+		pthread_t m_thread;
+		pthread_mutex_t m_mutex;
+		pthread_cond_t m_condWork;
+		pthread_cond_t m_condDone;
+		std::deque<std::vector<char>*> m_queue;		///< batches waiting to be written
+		std::vector<std::vector<char>*> m_vFree;	///< written batches for reuse
+		bool m_bBusy;
+		bool m_bStop;
+#endif
+};
+
+
+/**
+ * @brief Reader for files written by AsyncRecordWriter
+ *
+ * The whole file is read on construction.
+ */
+class BinaryRecordReader
+{
+	public:
+		/// constructor (reads the file)
+		BinaryRecordReader(const std::string& fileName);
+
+		/// number of column names in the header
+		size_t num_columns() const {return m_vColName.size();}
+
+		/// name of column i
+		std::string column_name(size_t i) const;
+
+		/// number of records
+		size_t num_records() const {return m_vRecStart.size();}
+
+		/// number of values of record r
+		size_t record_size(size_t r) const;
+
+		/// value i of record r
+		number value(size_t r, size_t i) const;
+
+		/// values of record r
+		std::vector<number> record(size_t r) const;
+
+		/// write all records to a text file (one record per line, tab-separated)
+		void export_ascii(const std::string& fileName) const;
+
+	private:
+		std::vector<std::string> m_vColName;
+		std::vector<number> m_vVal;
+		std::vector<size_t> m_vRecStart;
+		std::vector<size_t> m_vRecSize;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__ASYNC_RECORD_WRITER_H
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "async_vtk_writer.h"
+
+#include <cstdio>                        // for FILE, fopen, fprintf, snprintf
+
+#include "common/error.h"                // for UG_COND_THROW
+#include "common/log.h"                  // for UG_LOG
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_base.h"            // for NumProcs, ProcRank
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// file name relative to the directory of the file referring to it
+static std::string strip_directory(const std::string& fileName)
+{
+	const size_t pos = fileName.find_last_of('/');
+	return pos == std::string::npos ? fileName : fileName.substr(pos + 1);
+}
+
+
+AsyncPointVTKWriter::AsyncPointVTKWriter(const std::string& baseName, const std::string& dataName)
+: m_baseName(baseName), m_dataName(dataName), m_stride(1), m_rank(0), m_nProcs(1),
+  m_bError(false)
+{
+#ifdef UG_PARALLEL
+	m_rank = pcl::ProcRank();
+	m_nProcs = pcl::NumProcs();
+#endif
+
+#ifdef NC_ASYNC_VTK_WRITER_THREAD
+	m_bBusy = false;
+	m_bStop = false;
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_condWork, NULL);
+	pthread_cond_init(&m_condDone, NULL);
+	if (pthread_create(&m_thread, NULL, &AsyncPointVTKWriter::writer_main, this))
+	{
+		pthread_cond_destroy(&m_condDone);
+		pthread_cond_destroy(&m_condWork);
+		pthread_mutex_destroy(&m_mutex);
+		UG_THROW("Writer thread for VTK output '" << baseName << "' could not be started.");
+	}
+#endif
+}
+
+
+AsyncPointVTKWriter::~AsyncPointVTKWriter()
+{
+#ifdef NC_ASYNC_VTK_WRITER_THREAD
+	pthread_mutex_lock(&m_mutex);
+	m_bStop = true;
+	pthread_cond_signal(&m_condWork);
+	pthread_mutex_unlock(&m_mutex);
+	pthread_join(m_thread, NULL);
+
+	pthread_cond_destroy(&m_condDone);
+	pthread_cond_destroy(&m_condWork);
+	pthread_mutex_destroy(&m_mutex);
+
+	for (size_t i = 0; i < m_vFree.size(); ++i)
+		delete m_vFree[i];
+#endif
+
+	if (m_bError)
+		UG_LOG("WARNING: Not all VTK output files '" << m_baseName << "*' could be written.\n");
+}
+
+
+void AsyncPointVTKWriter::set_stride(size_t stride)
+{
+	UG_COND_THROW(!stride, "The output stride must be positive.");
+	m_stride = stride;
+}
+
+
+void AsyncPointVTKWriter::write
+(
+	size_t step,
+	number time,
+	const std::vector<number>& vCoord,
+	const std::vector<number>& vVal
+)
+{
+	check_error();
+
+	if (!is_output_step(step))
+		return;
+
+	UG_COND_THROW(vCoord.size() != 3*vVal.size(), "Number of coordinates (" << vCoord.size()
+		<< ") does not match three times the number of values (" << vVal.size() << ").");
+
+#ifdef NC_ASYNC_VTK_WRITER_THREAD
+	pthread_mutex_lock(&m_mutex);
+	Snapshot* snap;
+	if (m_vFree.empty())
+		snap = new Snapshot();
+	else
+	{
+		snap = m_vFree.back();
+		m_vFree.pop_back();
+	}
+	pthread_mutex_unlock(&m_mutex);
+
+	// copying is the only work done on the calling thread
+	snap->step = step;
+	snap->time = time;
+	snap->vCoord = vCoord;
+	snap->vVal = vVal;
+
+	pthread_mutex_lock(&m_mutex);
+	m_queue.push_back(snap);
+	pthread_cond_signal(&m_condWork);
+	pthread_mutex_unlock(&m_mutex);
+#else
+	Snapshot snap;
+	snap.step = step;
+	snap.time = time;
+	snap.vCoord = vCoord;
+	snap.vVal = vVal;
+	if (!write_snapshot(snap))
+		m_bError = true;
+#endif
+}
+
+
+void AsyncPointVTKWriter::flush()
+{
+#ifdef NC_ASYNC_VTK_WRITER_THREAD
+	pthread_mutex_lock(&m_mutex);
+	while (!m_queue.empty() || m_bBusy)
+		pthread_cond_wait(&m_condDone, &m_mutex);
+	pthread_mutex_unlock(&m_mutex);
+#endif
+
+	check_error();
+}
+
+
+std::string AsyncPointVTKWriter::piece_name(size_t step, int rank) const
+{
+	char buf[32];
+	snprintf(buf, 32, "_t%05lu_p%04d.vtu", (unsigned long) step, rank);
+	return m_baseName + buf;
+}
+
+
+std::string AsyncPointVTKWriter::header_name(size_t step) const
+{
+	char buf[32];
+	snprintf(buf, 32, "_t%05lu.pvtu", (unsigned long) step);
+	return m_baseName + buf;
+}
+
+
+bool AsyncPointVTKWriter::write_snapshot(const Snapshot& snap)
+{
+	bool ok = write_piece(snap);
+	if (m_rank == 0)
+	{
+		ok = write_header(snap) && ok;
+		m_vPvdEntry.push_back(std::make_pair(snap.time, strip_directory(header_name(snap.step))));
+		ok = write_pvd() && ok;
+	}
+	return ok;
+}
+
+
+bool AsyncPointVTKWriter::write_piece(const Snapshot& snap) const
+{
+	FILE* f = fopen(piece_name(snap.step, m_rank).c_str(), "w");
+	if (!f)
+		return false;
+
+	const size_t nPts = snap.vVal.size();
+	fprintf(f, "<?xml version=\"1.0\"?>\n"
+		"<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n"
+		"  <UnstructuredGrid>\n"
+		"    <Piece NumberOfPoints=\"%lu\" NumberOfCells=\"%lu\">\n",
+		(unsigned long) nPts, (unsigned long) nPts);
+
+	fprintf(f, "      <Points>\n"
+		"        <DataArray type=\"Float64\" NumberOfComponents=\"3\" format=\"ascii\">\n");
+	for (size_t i = 0; i < nPts; ++i)
+		fprintf(f, "%.10g %.10g %.10g\n", (double) snap.vCoord[3*i],
+			(double) snap.vCoord[3*i+1], (double) snap.vCoord[3*i+2]);
+	fprintf(f, "        </DataArray>\n      </Points>\n");
+
+	// every point is a VTK_VERTEX cell
+	fprintf(f, "      <Cells>\n"
+		"        <DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">\n");
+	for (size_t i = 0; i < nPts; ++i)
+		fprintf(f, "%lu\n", (unsigned long) i);
+	fprintf(f, "        </DataArray>\n"
+		"        <DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">\n");
+	for (size_t i = 0; i < nPts; ++i)
+		fprintf(f, "%lu\n", (unsigned long) (i+1));
+	fprintf(f, "        </DataArray>\n"
+		"        <DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">\n");
+	for (size_t i = 0; i < nPts; ++i)
+		fprintf(f, "1\n");
+	fprintf(f, "        </DataArray>\n      </Cells>\n");
+
+	fprintf(f, "      <PointData Scalars=\"%s\">\n"
+		"        <DataArray type=\"Float64\" Name=\"%s\" format=\"ascii\">\n",
+		m_dataName.c_str(), m_dataName.c_str());
+	for (size_t i = 0; i < nPts; ++i)
+		fprintf(f, "%.10g\n", (double) snap.vVal[i]);
+	fprintf(f, "        </DataArray>\n      </PointData>\n"
+		"    </Piece>\n  </UnstructuredGrid>\n</VTKFile>\n");
+
+	const bool ok = !ferror(f);
+	return fclose(f) == 0 && ok;
+}
+
+
+bool AsyncPointVTKWriter::write_header(const Snapshot& snap) const
+{
+	FILE* f = fopen(header_name(snap.step).c_str(), "w");
+	if (!f)
+		return false;
+
+	fprintf(f, "<?xml version=\"1.0\"?>\n"
+		"<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n"
+		"  <PUnstructuredGrid GhostLevel=\"0\">\n"
+		"    <PPointData Scalars=\"%s\">\n"
+		"      <PDataArray type=\"Float64\" Name=\"%s\"/>\n"
+		"    </PPointData>\n"
+		"    <PPoints>\n"
+		"      <PDataArray type=\"Float64\" NumberOfComponents=\"3\"/>\n"
+		"    </PPoints>\n",
+		m_dataName.c_str(), m_dataName.c_str());
+	for (int p = 0; p < m_nProcs; ++p)
+		fprintf(f, "    <Piece Source=\"%s\"/>\n", strip_directory(piece_name(snap.step, p)).c_str());
+	fprintf(f, "  </PUnstructuredGrid>\n</VTKFile>\n");
+
+	const bool ok = !ferror(f);
+	return fclose(f) == 0 && ok;
+}
+
+
+bool AsyncPointVTKWriter::write_pvd()
+{
+	const std::string fileName = m_baseName + ".pvd";
+	FILE* f = fopen(fileName.c_str(), "w");
+	if (!f)
+		return false;
+
+	fprintf(f, "<?xml version=\"1.0\"?>\n"
+		"<VTKFile type=\"Collection\" version=\"0.1\">\n"
+		"  <Collection>\n");
+	for (size_t i = 0; i < m_vPvdEntry.size(); ++i)
+		fprintf(f, "    <DataSet timestep=\"%.17g\" group=\"\" part=\"0\" file=\"%s\"/>\n",
+			(double) m_vPvdEntry[i].first, m_vPvdEntry[i].second.c_str());
+	fprintf(f, "  </Collection>\n</VTKFile>\n");
+
+	const bool ok = !ferror(f);
+	return fclose(f) == 0 && ok;
+}
+
+
+void AsyncPointVTKWriter::check_error()
+{
+	bool bError;
+#ifdef NC_ASYNC_VTK_WRITER_THREAD
+	pthread_mutex_lock(&m_mutex);
+	bError = m_bError;
+	pthread_mutex_unlock(&m_mutex);
+#else
+	bError = m_bError;
+#endif
+	UG_COND_THROW(bError, "VTK output files '" << m_baseName << "*' could not be written.");
+}
+
+
+#ifdef NC_ASYNC_VTK_WRITER_THREAD
+void* AsyncPointVTKWriter::writer_main(void* arg)
+{
+	static_cast<AsyncPointVTKWriter*>(arg)->writer_loop();
+	return NULL;
+}
+
+
+void AsyncPointVTKWriter::writer_loop()
+{
+	pthread_mutex_lock(&m_mutex);
+	while (true)
+	{
+		while (m_queue.empty() && !m_bStop)
+			pthread_cond_wait(&m_condWork, &m_mutex);
+
+		if (m_queue.empty())
+			break;  // stop requested and nothing left to do
+
+		Snapshot* snap = m_queue.front();
+		m_queue.pop_front();
+		m_bBusy = true;
+		pthread_mutex_unlock(&m_mutex);
+
+		// formatting and writing is done without holding the lock
+		const bool ok = write_snapshot(*snap);
+
+		pthread_mutex_lock(&m_mutex);
+		if (!ok)
+			m_bError = true;
+		m_vFree.push_back(snap);
+		m_bBusy = false;
+		pthread_cond_broadcast(&m_condDone);
+	}
+	pthread_mutex_unlock(&m_mutex);
+}
+#endif
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__ASYNC_VTK_WRITER_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__ASYNC_VTK_WRITER_H
+
+#include <cstddef>                       // for size_t
+#include <deque>                         // for deque
+#include <string>                        // for string
+#include <utility>                       // for pair
+#include <vector>                        // for vector
+
+#include "common/types.h"                // for number
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define NC_ASYNC_VTK_WRITER_THREAD
+	#include <pthread.h>                 // for pthread_t, pthread_mutex_t, pthread_cond_t
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief VTK output of point data written by a background thread
+ *
+ * Each call to write() copies the point coordinates and values of the calling
+ * process into a snapshot which is formatted and written by a writer thread,
+ * so that the simulation does not wait on the file system.
+ * Where threads are not supported, snapshots are written synchronously.
+ *
+ * Every process writes its own piece "<base>_t<step>_p<rank>.vtu" (points as
+ * VTK_VERTEX cells); process 0 additionally writes the parallel header
+ * "<base>_t<step>.pvtu" and keeps the time series file "<base>.pvd" up to date.
+ * As the pieces are named after the process rank, no communication is needed;
+ * every process has to call write() for the same steps, though.
+ *
+ * A decimation stride can be set so that only every n-th step is written.
+ *
+ * Errors in the writer thread are reported by the next call to write() or flush().
+ */
+class AsyncPointVTKWriter
+{
+	public:
+		/**
+		 * @brief constructor
+		 *
+		 * @param baseName  base name of the output files
+		 * @param dataName  name of the point data array
+		 */
+		AsyncPointVTKWriter(const std::string& baseName, const std::string& dataName);
+
+		/// destructor (writes all queued snapshots and stops the writer thread)
+		~AsyncPointVTKWriter();
+
+		/// only write steps that are multiples of the given stride (default: 1)
+		void set_stride(size_t stride);
+
+		/// whether the given step is written (according to the stride)
+		bool is_output_step(size_t step) const {return step % m_stride == 0;}
+
+		/**
+		 * @brief queue one snapshot (if the step is an output step)
+		 *
+		 * @param step    step index
+		 * @param time    point in time
+		 * @param vCoord  point coordinates (3 per point)
+		 * @param vVal    point values (1 per point)
+		 */
+		void write(size_t step, number time, const std::vector<number>& vCoord, const std::vector<number>& vVal);
+
+		/// write all queued snapshots (waits for the writer thread)
+		void flush();
+
+		/// base name of the output files
+		const std::string& base_name() const {return m_baseName;}
+
+	private:
+		// not copyable
+		AsyncPointVTKWriter(const AsyncPointVTKWriter&);
+		AsyncPointVTKWriter& operator=(const AsyncPointVTKWriter&);
+
+		struct Snapshot
+		{
+			size_t step;
+			number time;
+			std::vector<number> vCoord;
+			std::vector<number> vVal;
+		};
+
+		std::string piece_name(size_t step, int rank) const;
+		std::string header_name(size_t step) const;
+
+		bool write_snapshot(const Snapshot& snap);
+		bool write_piece(const Snapshot& snap) const;
+		bool write_header(const Snapshot& snap) const;
+		bool write_pvd();
+		void check_error();
+
+#ifdef NC_ASYNC_VTK_WRITER_THREAD
+		static void* writer_main(void* arg);
+		void writer_loop();
+#endif
+
+	private:
+		std::string m_baseName;
+		std::string m_dataName;
+		size_t m_stride;
+		int m_rank;
+		int m_nProcs;
+
+		/// time series entries written so far (only used by the writer)
+		std::vector<std::pair<number, std::string> > m_vPvdEntry;
+
+		/// set by the writer on write failure
+		bool m_bError;
+
+#ifdef NC_ASYNC_VTK_WRITER_THREAD
+		pthread_t m_thread;
+		pthread_mutex_t m_mutex;
+		pthread_cond_t m_condWork;
+		pthread_cond_t m_condDone;
+		std::deque<Snapshot*> m_queue;		///< snapshots waiting to be written
+		std::vector<Snapshot*> m_vFree;		///< written snapshots for reuse
+		bool m_bBusy;
+		bool m_bStop;
+#endif
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__ASYNC_VTK_WRITER_H
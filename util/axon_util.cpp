@@ -39,6 +39,7 @@
 
 #include "axon_util.h"
 
+#include <algorithm>                                                // for std::sort, std::upper_bound
 #include <cstddef>                                                  // for size_t, NULL
 #include <stack>
 
@@ -54,6 +55,7 @@
 #include "lib_grid/grid_objects/grid_dim_traits.h"                  // for grid_dim_traits
 #include "lib_grid/tools/grid_level.h"                              // for GridLevel
 #include "lib_grid/tools/subset_group.h"                            // for SubsetGroup
+#include "thread_scratch.h"                                         // for thread_index, max_num_threads
 
 namespace ug {
 namespace neuro_collection {
@@ -141,30 +143,50 @@ void unmark_ranvier_areas
 	}
 
 
-	MathVector<TDomain::dim> normal;
+	// sorted centers serve as an axial index of the ranvier nodes
+	std::sort(ranvierCentersX.begin(), ranvierCentersX.end());
 
+	// find ranvier elements (those whose center is at one of the ranvier coords);
+	// this is done in a threaded sweep with one binary search per element,
+	// the (comparatively few) ranvier elements are then treated serially
+	std::vector<elem_type*> vElem;
 	const_elem_iterator iter = dd->template begin<elem_type>();
 	const_elem_iterator iterEnd = dd->template end<elem_type>();
 	for (; iter != iterEnd; ++iter)
+		vElem.push_back(*iter);
+
+	const size_t nThreads = max_num_threads();
+	std::vector<std::vector<elem_type*> > vRanvierElemPerThread(nThreads);
+	const long nElem = (long) vElem.size();
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (long k = 0; k < nElem; ++k)
 	{
-		elem_type* elem = *iter;
+		elem_type* elem = vElem[k];
 
 		// calculate object center
-		number objectCenter = CalculateGridObjectCenter(elem, aaPos)[0];
-		number objectSize = VecDistance(aaPos[elem->vertex(0)], aaPos[elem->vertex(1)]);
+		const number objectCenter = CalculateGridObjectCenter(elem, aaPos)[0];
+		const number tol = 1e-3 * VecDistance(aaPos[elem->vertex(0)], aaPos[elem->vertex(1)]);
 
-		// only work on this elem if center is at one of the ranvier coords
-		bool isRanvierElem = false;
-		for (size_t ss = 0; ss < nSs; ++ss)
-		{
-			if (fabs(objectCenter - ranvierCentersX[ss]) < 1e-3 * objectSize)
-			{
-				isRanvierElem = true;
-				break;
-			}
-		}
-		if (!isRanvierElem)
-			continue;
+		std::vector<number>::const_iterator it =
+			std::upper_bound(ranvierCentersX.begin(), ranvierCentersX.end(), objectCenter - tol);
+		if (it != ranvierCentersX.end() && *it < objectCenter + tol)
+			vRanvierElemPerThread[thread_index()].push_back(elem);
+	}
+
+	// keep the original element order (static schedule, threads in order)
+	std::vector<elem_type*> vRanvierElem;
+	for (size_t t = 0; t < nThreads; ++t)
+		vRanvierElem.insert(vRanvierElem.end(), vRanvierElemPerThread[t].begin(), vRanvierElemPerThread[t].end());
+
+
+	MathVector<TDomain::dim> normal;
+
+	const size_t nRanvierElem = vRanvierElem.size();
+	for (size_t i = 0; i < nRanvierElem; ++i)
+	{
+		elem_type* elem = vRanvierElem[i];
 
 		// unmark element
 		if (doUnmark)
@@ -43,8 +43,18 @@
 #include "common/types.h"  // number
 #include "common/util/smart_pointer.h"
 #include "lib_disc/function_spaces/grid_function.h"
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
 
 #include "../membrane_transporters/ryr_implicit.h"
+#include "async_record_writer.h"  // for AsyncRecordWriter
+#include "compressed_series.h"  // for CompressedSeriesWriter
+
+#include <cstdio>    // for FILE
+#include <stdint.h>  // for uint64_t
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_process_communicator.h"  // for ProcessCommunicator, MPI_File
+#endif
 
 
 namespace ug {
@@ -149,6 +159,89 @@ class WaveProfileExporter
 
 		void exportWaveProfileX(ConstSmartPtr<gf_type> u, number time);
 
+		/**
+		 * @brief write binary output instead of one text file per time step
+		 *
+		 * If enabled, each process appends its part of the profiles to the files
+		 * <fileBaseName>_<subset>_<function>[_p<rank>].bin (see AsyncRecordWriter);
+		 * the rank suffix is only used in parallel runs.
+		 * Each record consists of the time followed by pairs of x coordinate and value
+		 * for all vertices of the process (sorted by x coordinate).
+		 * Files are created anew if the first export is at time 0, appended to otherwise.
+		 */
+		void set_binary_output(bool b);
+
+		/**
+		 * @brief append all snapshots to one file per subset and function
+		 *
+		 * If enabled, each snapshot is appended to the file
+		 * <fileBaseName>_<subset>_<function>.wps instead of creating
+		 * a new file per time step. In parallel, all processes write to the same
+		 * file using collective MPI-IO at offsets that are computed only once
+		 * (the distribution of vertices does not change between snapshots).
+		 *
+		 * The file layout (native byte order) is:
+		 *   - header: magic "NCWPS001", number of vertices nVrt (uint64),
+		 *     number of snapshots written (uint64), nVrt x coordinates (double),
+		 *   - snapshots, each consisting of the time and nVrt values (double).
+		 * Files are created anew if the first export is at time 0;
+		 * otherwise, snapshots are appended to an existing file.
+		 *
+		 * The files are closed by close_files() or on destruction.
+		 * As closing is collective in parallel, close_files() should be called
+		 * explicitly at the end of a parallel simulation.
+		 */
+		void set_single_file_output(bool b);
+
+		/**
+		 * @brief expected number of snapshots for single-file output
+		 *
+		 * In parallel, the single-file output files are preallocated for this
+		 * number of snapshots on creation (0, the default, means no preallocation).
+		 */
+		void set_num_snapshots_to_preallocate(size_t n);
+
+		/**
+		 * @brief write compressed profile series instead of one text file per time step
+		 *
+		 * If enabled, each process writes its part of the profiles to the files
+		 * <fileBaseName>_<subset>_<function>[_p<rank>].tsc (see CompressedSeriesWriter);
+		 * the rank suffix is only used in parallel runs.
+		 * The x coordinates of the vertices (sorted) are stored once, each snapshot
+		 * consists of the values in these vertices.
+		 * The files are completed by close_files() or on destruction.
+		 *
+		 * @param b          whether to write compressed series
+		 * @param tolerance  absolute error bound for the values (0 for lossless output)
+		 */
+		void set_compressed_output(bool b, number tolerance);
+
+		/// close single-file and compressed output files (collective in parallel)
+		void close_files();
+
+		/// destructor
+		~WaveProfileExporter();
+
+	private:
+		void open_binary_files(number time);
+		void open_compressed_files();
+
+		struct SeriesFile
+		{
+			SeriesFile() : fp(NULL), nSnap(0), bOpen(false) {}
+#ifdef UG_PARALLEL
+			MPI_File fh;
+#endif
+			FILE* fp;
+			uint64_t nSnap;
+			bool bOpen;
+		};
+
+		void init_series_layout();
+		void open_series_files(number time);
+		void write_series_chunk(SeriesFile& sf, uint64_t byteOffset, const void* data, size_t nBytes);
+		void read_series_header(SeriesFile& sf, char* header);
+
 	private:
 		struct CmpVrtPos
 		{
@@ -173,9 +266,135 @@ class WaveProfileExporter
 
 		std::vector<std::vector<std::vector<DoFIndex> > > m_vvvDoFSeries;
 		std::vector<std::vector<number> > m_vvXPos;
+
+		bool m_bBinary;
+		std::vector<SmartPtr<AsyncRecordWriter> > m_vBinWriter;
+		std::vector<number> m_vRecord;
+
+		bool m_bCompressed;
+		number m_compTol;
+		std::vector<SmartPtr<CompressedSeriesWriter> > m_vCompWriter;
+
+		bool m_bSingleFile;
+		size_t m_nPrealloc;
+		std::vector<SeriesFile> m_vSeriesFile;		///< one per subset and function
+
+		/// single-file layout per subset (computed once)
+		std::vector<uint64_t> m_vSeriesNumVrt;		///< global number of vertices
+		std::vector<uint64_t> m_vSeriesVrtOffset;	///< number of vertices before this proc's
+		std::vector<bool> m_vSeriesHeadProc;		///< whether this proc writes header and times
+		std::vector<char> m_vSeriesBuf;
 };
 
 
+
+/**
+ * @brief Stateful tracking of a RyR-induced calcium wave
+ *
+ * Does the same as waveFrontX() and maxRyRFluxDensity(), but is meant to be
+ * called in every time step (e.g., to control the time step size):
+ * - Subset and function groups are only created once; the membrane vertices
+ *   and their DoF indices are cached (sorted by x coordinate) until the grid
+ *   is adapted or redistributed.
+ * - If a RyR channel is set, front position and maximal flux density are
+ *   computed in one pass over the cached vertices. The front is the rightmost
+ *   vertex where the threshold is exceeded (as in waveFrontX()).
+ * - Otherwise, the front is searched for starting from the previous front
+ *   position: forward as long as the threshold is exceeded, backward if the
+ *   previous front vertex is no longer above the threshold. This assumes one
+ *   contiguous supra-threshold region per process (a single wave moving
+ *   from left to right). The first update always searches all vertices.
+ * - The front velocity is computed from the last two front positions.
+ *
+ * As for WaveProfileExporter, processes must hold contiguous (in direction of x)
+ * parts of the subsets. The front position is interpolated linearly between the
+ * front vertex and its right neighbor if the neighbor is on the same process.
+ *
+ * The front is determined by the open probability 1-(c1+c2) of the RyR channel
+ * or (in calcium mode, see set_calcium_mode()) by the cytosolic calcium concentration.
+ */
+template <typename TDomain, typename TAlgebra>
+class WaveFrontTracker
+{
+	public:
+		typedef GridFunction<TDomain, TAlgebra> gf_type;
+
+	public:
+		/**
+		 * @brief constructor
+		 *
+		 * @param approxSpace   approximation space
+		 * @param fctNames      names for functions ca_cyt, ca_er, c1, c2 (in this order)
+		 * @param subsetNames   names of all ER membrane subsets with RyR channels
+		 * @param thresh        threshold value of (1-(c1+c2))
+		 *                      OR threshold value for ca_cyt (calcium mode)
+		 */
+		WaveFrontTracker
+		(
+			SmartPtr<ApproximationSpace<TDomain> > approxSpace,
+			const char* fctNames,
+			const char* subsetNames,
+			number thresh
+		);
+
+		/// set RyR channel for maximal flux density computation
+		void set_ryr(ConstSmartPtr<RyRImplicit<TDomain> > ryr);
+
+		/// determine the front by the cytosolic calcium concentration instead of RyR open probability
+		void set_calcium_mode(bool b);
+
+		/// update front position, velocity and maximal flux density for a solution at time t
+		void update(ConstSmartPtr<gf_type> u, number time);
+
+		/// front position (-max number if no vertex is above the threshold)
+		number front_position() const {return m_xFront;}
+
+		/// front velocity (0 before the second update)
+		number front_velocity() const {return m_vFront;}
+
+		/// maximal RyR flux density (mol/(m^2*s)); only available if RyR is set
+		number max_flux_density() const;
+
+	private:
+		void build_cache();
+		number front_value(const gf_type& u, size_t i) const;
+		int full_search(const gf_type& u) const;
+		int incremental_search(const gf_type& u) const;
+
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	private:
+		SmartPtr<ApproximationSpace<TDomain> > m_spApprox;
+		SubsetGroup m_ssGrp;
+		FunctionGroup m_fctGrp;
+		number m_thresh;
+		bool m_bCalciumMode;
+		ConstSmartPtr<RyRImplicit<TDomain> > m_spRyR;
+
+		/// cached membrane vertices sorted by x coordinate
+		bool m_bCacheValid;
+		std::vector<Vertex*> m_vVrt;
+		std::vector<number> m_vX;
+		std::vector<DoFIndex> m_vDoF;	///< 4 per vertex: ca_cyt, ca_er, c1, c2
+
+		/// tracking state
+		int m_localFront;		///< index of local front vertex (-1 if none)
+		bool m_bLocalFrontValid;
+		number m_xFront;
+		number m_vFront;
+		number m_maxFlux;
+		number m_tLast;
+		bool m_bHasLast;
+
+		/// flux computation buffers
+		std::vector<number> m_vValues;
+		std::vector<number> m_vFlux;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+};
+
 ///@}
 
 } // namespace ug
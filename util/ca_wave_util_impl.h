@@ -46,7 +46,9 @@
 
 #include <sstream>
 #include <vector>
-#include <algorithm>  // for std::sort
+#include <algorithm>  // for std::sort, std::stable_sort
+#include <cstring>    // for memcpy, memcmp
+#include <limits>     // for numeric_limits
 
 
 namespace ug {
@@ -385,7 +387,12 @@ WaveProfileExporter<TDomain, TAlgebra>::WaveProfileExporter
   m_vSs(TokenizeString(subsetNames)),
   m_fileName(fileBaseName),
   m_vvvDoFSeries(m_vSs.size()),
-  m_vvXPos(m_vSs.size())
+  m_vvXPos(m_vSs.size()),
+  m_bBinary(false),
+  m_bCompressed(false),
+  m_compTol(0.0),
+  m_bSingleFile(false),
+  m_nPrealloc(0)
 {
 	typedef typename TDomain::position_attachment_type pos_attach_type;
 	typedef typename DoFDistribution::traits<Vertex>::const_iterator vrt_it;
@@ -539,11 +546,449 @@ static void writeSerialFile(const std::string& data, const std::string& fileName
 
 
 
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::set_binary_output(bool b)
+{
+	UG_COND_THROW(!m_vBinWriter.empty(),
+		"WaveProfileExporter: Output format cannot be changed after the first binary export.");
+	m_bBinary = b;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::open_binary_files(number time)
+{
+	std::vector<std::string> vColName(1, "time");
+	vColName.push_back("x");
+	vColName.push_back("value");
+
+	const size_t nsi = m_vvvDoFSeries.size();
+	for (size_t s = 0; s < nsi; ++s)
+	{
+		const size_t nfct = m_vvvDoFSeries[s].size();
+		for (size_t f = 0; f < nfct; ++f)
+		{
+			std::ostringstream ossFn;
+			ossFn << m_fileName << "_" << m_vSs[s] << "_" << m_vFct[f];
+#ifdef UG_PARALLEL
+			if (pcl::NumProcs() > 1)
+				ossFn << "_p" << pcl::ProcRank();
+#endif
+			ossFn << ".bin";
+
+			try {m_vBinWriter.push_back(make_sp(new AsyncRecordWriter(ossFn.str(), vColName, time != 0.0)));}
+			UG_CATCH_THROW("Binary output file '" << ossFn.str() << "' could not be opened.");
+		}
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::set_compressed_output(bool b, number tolerance)
+{
+	UG_COND_THROW(!m_vCompWriter.empty(),
+		"WaveProfileExporter: Output format cannot be changed after the first compressed export.");
+	UG_COND_THROW(tolerance < 0.0, "WaveProfileExporter: Tolerance must not be negative.");
+	m_bCompressed = b;
+	m_compTol = tolerance;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::open_compressed_files()
+{
+	const std::vector<std::string> vColName;
+	const size_t nsi = m_vvvDoFSeries.size();
+	for (size_t s = 0; s < nsi; ++s)
+	{
+		const size_t nfct = m_vvvDoFSeries[s].size();
+		for (size_t f = 0; f < nfct; ++f)
+		{
+			std::ostringstream ossFn;
+			ossFn << m_fileName << "_" << m_vSs[s] << "_" << m_vFct[f];
+#ifdef UG_PARALLEL
+			if (pcl::NumProcs() > 1)
+				ossFn << "_p" << pcl::ProcRank();
+#endif
+			ossFn << ".tsc";
+
+			try {m_vCompWriter.push_back(make_sp(new CompressedSeriesWriter(ossFn.str(), m_vvXPos[s], 1,
+				m_vvXPos[s].size(), vColName, m_compTol)));}
+			UG_CATCH_THROW("Compressed output file '" << ossFn.str() << "' could not be opened.");
+		}
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+WaveProfileExporter<TDomain, TAlgebra>::~WaveProfileExporter()
+{
+	try {close_files();}
+	catch (...) {}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::set_single_file_output(bool b)
+{
+	UG_COND_THROW(!m_vSeriesFile.empty(),
+		"WaveProfileExporter: Output format cannot be changed after the first single-file export.");
+	m_bSingleFile = b;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::set_num_snapshots_to_preallocate(size_t n)
+{
+	m_nPrealloc = n;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::close_files()
+{
+	for (size_t k = 0; k < m_vCompWriter.size(); ++k)
+		m_vCompWriter[k]->close();
+
+	for (size_t k = 0; k < m_vSeriesFile.size(); ++k)
+	{
+		SeriesFile& sf = m_vSeriesFile[k];
+		if (!sf.bOpen)
+			continue;
+#ifdef UG_PARALLEL
+		if (pcl::NumProcs() > 1)
+			MPI_File_close(&sf.fh);
+		else
+#endif
+		fclose(sf.fp);
+		sf.bOpen = false;
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::init_series_layout()
+{
+	const size_t nsi = m_vvXPos.size();
+	m_vSeriesNumVrt.resize(nsi);
+	m_vSeriesVrtOffset.resize(nsi);
+	m_vSeriesHeadProc.resize(nsi);
+
+	for (size_t s = 0; s < nsi; ++s)
+	{
+		const unsigned long nLoc = m_vvXPos[s].size();
+		m_vSeriesNumVrt[s] = nLoc;
+		m_vSeriesVrtOffset[s] = 0;
+		m_vSeriesHeadProc[s] = true;
+
+#ifdef UG_PARALLEL
+		if (pcl::NumProcs() > 1)
+		{
+			// order procs by their leftmost vertex (procs without vertices last)
+			pcl::ProcessCommunicator pc;
+			const size_t np = pcl::NumProcs();
+			number minX = nLoc ? m_vvXPos[s][0] : std::numeric_limits<number>::max();
+			std::vector<number> allMinX(np);
+			pc.allgather(&minX, 1, PCL_DT_DOUBLE, &allMinX[0], 1, PCL_DT_DOUBLE);
+			std::vector<unsigned long> allSizes(np);
+			unsigned long mySize = nLoc;
+			pc.allgather(&mySize, 1, PCL_DT_UNSIGNED_LONG, &allSizes[0], 1, PCL_DT_UNSIGNED_LONG);
+
+			std::vector<size_t> rankOrder(np);
+			for (size_t i = 0; i < np; ++i)
+				rankOrder[i] = i;
+			MyCompare cmp(allMinX);
+			std::stable_sort(rankOrder.begin(), rankOrder.end(), cmp);
+
+			const size_t myRank = pcl::ProcRank();
+			uint64_t offset = 0;
+			uint64_t total = 0;
+			bool bOffsetFound = false;
+			for (size_t i = 0; i < np; ++i)
+			{
+				if (rankOrder[i] == myRank)
+				{
+					offset = total;
+					bOffsetFound = true;
+				}
+				total += allSizes[rankOrder[i]];
+			}
+			UG_COND_THROW(!bOffsetFound, "Own rank not found in process order.");
+
+			m_vSeriesNumVrt[s] = total;
+			m_vSeriesVrtOffset[s] = offset;
+
+			// header and times are written by the first proc in order
+			// (it has offset 0 and writes one contiguous chunk)
+			m_vSeriesHeadProc[s] = (rankOrder[0] == myRank);
+		}
+#endif
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::write_series_chunk
+(
+	SeriesFile& sf,
+	uint64_t byteOffset,
+	const void* data,
+	size_t nBytes
+)
+{
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		// some old MPI implementations need non-const void* here
+		MPI_Status status;
+		if (MPI_File_write_at_all(sf.fh, (MPI_Offset) byteOffset, const_cast<void*>(data),
+			(int) nBytes, MPI_BYTE, &status) != MPI_SUCCESS)
+			UG_THROW("Collective write to single-file wave profile output failed.");
+		return;
+	}
+#endif
+	UG_COND_THROW(fseek(sf.fp, (long) byteOffset, SEEK_SET) != 0
+			|| (nBytes && fwrite(data, 1, nBytes, sf.fp) != nBytes),
+		"Write to single-file wave profile output failed.");
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::read_series_header(SeriesFile& sf, char* header)
+{
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		MPI_Status status;
+		if (MPI_File_read_at_all(sf.fh, 0, header, 24, MPI_BYTE, &status) != MPI_SUCCESS)
+			UG_THROW("Reading the header of single-file wave profile output failed.");
+		return;
+	}
+#endif
+	UG_COND_THROW(fseek(sf.fp, 0, SEEK_SET) != 0 || fread(header, 1, 24, sf.fp) != 24,
+		"Reading the header of single-file wave profile output failed.");
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveProfileExporter<TDomain, TAlgebra>::open_series_files(number time)
+{
+	static const char magic[8] = {'N', 'C', 'W', 'P', 'S', '0', '0', '1'};
+
+	init_series_layout();
+
+	const size_t nsi = m_vvvDoFSeries.size();
+	for (size_t s = 0; s < nsi; ++s)
+	{
+		const uint64_t nVrt = m_vSeriesNumVrt[s];
+		const uint64_t headerBytes = 24 + 8*nVrt;
+		const uint64_t snapBytes = 8*(nVrt + 1);
+
+		const size_t nfct = m_vvvDoFSeries[s].size();
+		for (size_t f = 0; f < nfct; ++f)
+		{
+			std::ostringstream ossFn;
+			ossFn << m_fileName << "_" << m_vSs[s] << "_" << m_vFct[f] << ".wps";
+			const std::string fn = ossFn.str();
+
+			m_vSeriesFile.push_back(SeriesFile());
+			SeriesFile& sf = m_vSeriesFile.back();
+
+			// open (keep existing contents if appending)
+			bool bExisting = false;
+#ifdef UG_PARALLEL
+			if (pcl::NumProcs() > 1)
+			{
+				pcl::ProcessCommunicator pc;
+				if (MPI_File_open(pc.get_mpi_communicator(), const_cast<char*>(fn.c_str()),
+					MPI_MODE_CREATE | MPI_MODE_RDWR, MPI_INFO_NULL, &sf.fh) != MPI_SUCCESS)
+					UG_THROW("Unable to open " << fn << ".");
+				sf.bOpen = true;
+
+				MPI_Offset size = 0;
+				MPI_File_get_size(sf.fh, &size);
+				bExisting = time != 0.0 && (uint64_t) size >= headerBytes;
+				if (!bExisting)
+					MPI_File_set_size(sf.fh, 0);
+				if (m_nPrealloc)
+					MPI_File_preallocate(sf.fh, (MPI_Offset) (headerBytes + m_nPrealloc*snapBytes));
+			}
+			else
+#endif
+			{
+				if (time != 0.0)
+					sf.fp = fopen(fn.c_str(), "r+b");
+				bExisting = sf.fp != NULL;
+				if (!bExisting)
+					sf.fp = fopen(fn.c_str(), "w+b");
+				UG_COND_THROW(!sf.fp, "Unable to open " << fn << ".");
+				sf.bOpen = true;
+			}
+
+			if (bExisting)
+			{
+				// check the header and continue after the last snapshot
+				char header[24];
+				read_series_header(sf, header);
+				uint64_t nVrtFile;
+				memcpy(&nVrtFile, header + 8, 8);
+				UG_COND_THROW(memcmp(header, magic, 8) != 0 || nVrtFile != nVrt,
+					"File " << fn << " cannot be appended to: It is no wave profile series file "
+					"or has a different number of vertices (" << nVrtFile << " instead of " << nVrt << ").");
+				memcpy(&sf.nSnap, header + 16, 8);
+				continue;
+			}
+
+			// write header (including this proc's x coordinates)
+			const size_t nLoc = m_vvXPos[s].size();
+			const size_t nPre = m_vSeriesHeadProc[s] ? 24 : 0;
+			m_vSeriesBuf.resize(nPre + 8*nLoc);
+			if (nPre)
+			{
+				const uint64_t zero = 0;
+				memcpy(&m_vSeriesBuf[0], magic, 8);
+				memcpy(&m_vSeriesBuf[8], &nVrt, 8);
+				memcpy(&m_vSeriesBuf[16], &zero, 8);
+			}
+			for (size_t i = 0; i < nLoc; ++i)
+			{
+				const double x = m_vvXPos[s][i];
+				memcpy(&m_vSeriesBuf[nPre + 8*i], &x, 8);
+			}
+			const uint64_t offset = 24 + 8*m_vSeriesVrtOffset[s] - nPre;
+			write_series_chunk(sf, offset, m_vSeriesBuf.empty() ? NULL : &m_vSeriesBuf[0], m_vSeriesBuf.size());
+		}
+	}
+}
+
+
 template <typename TDomain, typename TAlgebra>
 void WaveProfileExporter<TDomain, TAlgebra>::
 exportWaveProfileX(ConstSmartPtr<gf_type> u, number time)
 {
 	const size_t nsi = m_vvvDoFSeries.size();
+
+	UG_COND_THROW(m_bBinary && m_bSingleFile,
+		"WaveProfileExporter: Binary and single-file output cannot be combined.");
+	UG_COND_THROW(m_bCompressed && (m_bBinary || m_bSingleFile),
+		"WaveProfileExporter: Compressed output cannot be combined with binary or single-file output.");
+
+	if (m_bSingleFile)
+	{
+		if (m_vSeriesFile.empty())
+			open_series_files(time);
+
+		size_t k = 0;
+		for (size_t s = 0; s < nsi; ++s)
+		{
+			const uint64_t nVrt = m_vSeriesNumVrt[s];
+			const uint64_t headerBytes = 24 + 8*nVrt;
+			const uint64_t snapBytes = 8*(nVrt + 1);
+			const size_t nLoc = m_vvXPos[s].size();
+			const bool bHead = m_vSeriesHeadProc[s];
+			const size_t nPre = bHead ? 8 : 0;
+
+			const size_t nfct = m_vvvDoFSeries[s].size();
+			for (size_t f = 0; f < nfct; ++f, ++k)
+			{
+				SeriesFile& sf = m_vSeriesFile[k];
+				const std::vector<DoFIndex>& vdi = m_vvvDoFSeries[s][f];
+
+				// this proc's chunk of the snapshot (preceded by time for the head proc)
+				m_vSeriesBuf.resize(nPre + 8*nLoc);
+				if (bHead)
+				{
+					const double t = time;
+					memcpy(&m_vSeriesBuf[0], &t, 8);
+				}
+				for (size_t i = 0; i < nLoc; ++i)
+				{
+					const double val = DoFRef(*u, vdi[i]);
+					memcpy(&m_vSeriesBuf[nPre + 8*i], &val, 8);
+				}
+				const uint64_t offset = headerBytes + sf.nSnap*snapBytes
+					+ 8 + 8*m_vSeriesVrtOffset[s] - nPre;
+				write_series_chunk(sf, offset, m_vSeriesBuf.empty() ? NULL : &m_vSeriesBuf[0],
+					m_vSeriesBuf.size());
+
+				// update number of snapshots in header
+				++sf.nSnap;
+				if (bHead)
+				{
+#ifdef UG_PARALLEL
+					if (pcl::NumProcs() > 1)
+					{
+						MPI_Status status;
+						MPI_File_write_at(sf.fh, 16, &sf.nSnap, 8, MPI_BYTE, &status);
+					}
+					else
+#endif
+					{
+						UG_COND_THROW(fseek(sf.fp, 16, SEEK_SET) != 0 || fwrite(&sf.nSnap, 8, 1, sf.fp) != 1,
+							"Write to single-file wave profile output failed.");
+					}
+				}
+			}
+		}
+		return;
+	}
+
+	if (m_bCompressed)
+	{
+		if (m_vCompWriter.empty())
+			open_compressed_files();
+
+		size_t k = 0;
+		for (size_t s = 0; s < nsi; ++s)
+		{
+			const size_t nVrt = m_vvXPos[s].size();
+			m_vRecord.resize(nVrt);
+
+			const size_t nfct = m_vvvDoFSeries[s].size();
+			for (size_t f = 0; f < nfct; ++f, ++k)
+			{
+				const std::vector<DoFIndex>& vdi = m_vvvDoFSeries[s][f];
+				for (size_t i = 0; i < nVrt; ++i)
+					m_vRecord[i] = DoFRef(*u, vdi[i]);
+
+				try {m_vCompWriter[k]->write(time, m_vRecord);}
+				UG_CATCH_THROW("Compressed output file '" << m_vCompWriter[k]->file_name()
+					<< "' could not be written to.");
+			}
+		}
+		return;
+	}
+
+	if (m_bBinary)
+	{
+		if (m_vBinWriter.empty())
+			open_binary_files(time);
+
+		size_t k = 0;
+		for (size_t s = 0; s < nsi; ++s)
+		{
+			const size_t nVrt = m_vvXPos[s].size();
+			m_vRecord.resize(2*nVrt + 1);
+			m_vRecord[0] = time;
+
+			const size_t nfct = m_vvvDoFSeries[s].size();
+			for (size_t f = 0; f < nfct; ++f, ++k)
+			{
+				const std::vector<DoFIndex>& vdi = m_vvvDoFSeries[s][f];
+				for (size_t i = 0; i < nVrt; ++i)
+				{
+					m_vRecord[2*i+1] = m_vvXPos[s][i];
+					m_vRecord[2*i+2] = DoFRef(*u, vdi[i]);
+				}
+
+				try {m_vBinWriter[k]->write(m_vRecord);}
+				UG_CATCH_THROW("Binary output file '" << m_vBinWriter[k]->file_name()
+					<< "' could not be written to.");
+			}
+		}
+		return;
+	}
+
 	for (size_t s = 0; s < nsi; ++s)
 	{
 		const size_t nfct = m_vvvDoFSeries[s].size();
@@ -577,5 +1022,273 @@ exportWaveProfileX(ConstSmartPtr<gf_type> u, number time)
 
 
 
+
+// ////////////////// //
+// WaveFrontTracker   //
+// ////////////////// //
+
+template <typename TDomain, typename TAlgebra>
+WaveFrontTracker<TDomain, TAlgebra>::WaveFrontTracker
+(
+	SmartPtr<ApproximationSpace<TDomain> > approxSpace,
+	const char* fctNames,
+	const char* subsetNames,
+	number thresh
+)
+: m_spApprox(approxSpace),
+  m_ssGrp(approxSpace->domain()->subset_handler()),
+  m_fctGrp(approxSpace->function_pattern()),
+  m_thresh(thresh),
+  m_bCalciumMode(false),
+  m_bCacheValid(false),
+  m_localFront(-1),
+  m_bLocalFrontValid(false),
+  m_xFront(-std::numeric_limits<number>::max()),
+  m_vFront(0.0),
+  m_maxFlux(0.0),
+  m_tLast(0.0),
+  m_bHasLast(false),
+  m_vValues(5, 0.0),
+  m_vFlux(1, 0.0)
+{
+	try {m_ssGrp.add(TokenizeString(subsetNames));}
+	UG_CATCH_THROW("Could not add all subsets to WaveFrontTracker.");
+	UG_COND_THROW(m_ssGrp.size() < 1, "Subset group must have at least 1 entry.\n"
+		"Make sure you provide at least 1 subset name for ER membrane subset.");
+
+	try {m_fctGrp.add(TokenizeString(fctNames));}
+	UG_CATCH_THROW("Could not add all functions to WaveFrontTracker.");
+	UG_COND_THROW(m_fctGrp.size() != 4, "Function group must have exactly 4 entries.\n"
+		"Make sure you provided exactly 4 function names in the following order:\n"
+		"ca_cyt, ca_er, c1, c2.");
+
+	Grid& grid = *m_spApprox->domain()->grid();
+	m_spGridAdaptionCallbackID = grid.message_hub()->register_class_callback(this,
+		&WaveFrontTracker<TDomain, TAlgebra>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid.message_hub()->register_class_callback(this,
+		&WaveFrontTracker<TDomain, TAlgebra>::grid_distribution_callback);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveFrontTracker<TDomain, TAlgebra>::set_ryr(ConstSmartPtr<RyRImplicit<TDomain> > ryr)
+{
+	m_spRyR = ryr;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveFrontTracker<TDomain, TAlgebra>::set_calcium_mode(bool b)
+{
+	m_bCalciumMode = b;
+	m_bLocalFrontValid = false;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+number WaveFrontTracker<TDomain, TAlgebra>::max_flux_density() const
+{
+	UG_COND_THROW(!m_spRyR.valid(), "WaveFrontTracker: "
+		"Maximal flux density is only available if a RyR channel is set.");
+	return m_maxFlux;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveFrontTracker<TDomain, TAlgebra>::build_cache()
+{
+	ConstSmartPtr<DoFDistribution> dd = m_spApprox->dof_distribution(GridLevel(), false);
+	const typename TDomain::position_accessor_type& aaPos = m_spApprox->domain()->position_accessor();
+
+	std::vector<std::pair<number, Vertex*> > vSort;
+	const size_t nSs = m_ssGrp.size();
+	for (size_t s = 0; s < nSs; ++s)
+	{
+		const int si = m_ssGrp[s];
+		for (size_t f = 0; f < 4; ++f)
+		{
+			UG_COND_THROW(!dd->is_def_in_subset(m_fctGrp[f], si), "Function '" << m_fctGrp.name(f)
+				<< "' is not defined on subset '" << m_ssGrp.name(s) << "'.");
+		}
+
+		DoFDistribution::traits<Vertex>::const_iterator it = dd->begin<Vertex>(si);
+		DoFDistribution::traits<Vertex>::const_iterator itEnd = dd->end<Vertex>(si);
+		for (; it != itEnd; ++it)
+			vSort.push_back(std::make_pair((number) aaPos[*it][0], *it));
+	}
+	std::sort(vSort.begin(), vSort.end());
+
+	const size_t nVrt = vSort.size();
+	m_vVrt.resize(nVrt);
+	m_vX.resize(nVrt);
+	m_vDoF.resize(4*nVrt);
+	std::vector<DoFIndex> ind;
+	for (size_t i = 0; i < nVrt; ++i)
+	{
+		m_vX[i] = vSort[i].first;
+		m_vVrt[i] = vSort[i].second;
+		for (size_t f = 0; f < 4; ++f)
+		{
+			size_t numInd = dd->dof_indices(m_vVrt[i], m_fctGrp[f], ind, true, true);
+			UG_COND_THROW(numInd != 1, "More (or less) than one function index found on a vertex!");
+			m_vDoF[4*i + f] = ind[0];
+		}
+	}
+
+	m_bCacheValid = true;
+	m_bLocalFrontValid = false;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+inline number WaveFrontTracker<TDomain, TAlgebra>::front_value(const gf_type& u, size_t i) const
+{
+	if (m_bCalciumMode)
+		return DoFRef(u, m_vDoF[4*i]);
+	return 1.0 - (DoFRef(u, m_vDoF[4*i + 2]) + DoFRef(u, m_vDoF[4*i + 3]));
+}
+
+
+template <typename TDomain, typename TAlgebra>
+int WaveFrontTracker<TDomain, TAlgebra>::full_search(const gf_type& u) const
+{
+	for (int i = (int) m_vX.size() - 1; i >= 0; --i)
+		if (front_value(u, i) > m_thresh)
+			return i;
+	return -1;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+int WaveFrontTracker<TDomain, TAlgebra>::incremental_search(const gf_type& u) const
+{
+	const int n = (int) m_vX.size();
+	if (!n)
+		return -1;
+
+	// no front here last time: the wave can only enter from the left
+	int p = m_localFront;
+	if (p < 0)
+	{
+		if (front_value(u, 0) <= m_thresh)
+			return -1;
+		p = 0;
+	}
+
+	// advance front as long as the threshold is exceeded
+	if (front_value(u, p) > m_thresh)
+	{
+		while (p + 1 < n && front_value(u, p + 1) > m_thresh)
+			++p;
+		return p;
+	}
+
+	// front has receded
+	while (p >= 0 && front_value(u, p) <= m_thresh)
+		--p;
+	return p;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveFrontTracker<TDomain, TAlgebra>::update(ConstSmartPtr<gf_type> u, number time)
+{
+	typedef RyRImplicit<TDomain> ryr_type;
+
+	if (!m_bCacheValid)
+		build_cache();
+
+	const gf_type& sol = *u;
+	const int nVrt = (int) m_vX.size();
+
+	// front (and max flux) on this proc
+	int front = -1;
+	double maxVals[2] = {-std::numeric_limits<double>::max(), 0.0};
+	if (m_spRyR.valid())
+	{
+		// fused pass: flux density in every vertex, rightmost vertex above threshold
+		const ryr_type& ryr = *m_spRyR;
+		const number sccyt = ryr.scale_input(ryr_type::_CCYT_);
+		const number scer = ryr.scale_input(ryr_type::_CER_);
+		const number sc1 = ryr.scale_input(ryr_type::_C1_);
+		const number sc2 = ryr.scale_input(ryr_type::_C2_);
+		for (int i = 0; i < nVrt; ++i)
+		{
+			const number cc = DoFRef(sol, m_vDoF[4*i]);
+			const number c1 = DoFRef(sol, m_vDoF[4*i + 2]);
+			const number c2 = DoFRef(sol, m_vDoF[4*i + 3]);
+
+			m_vValues[ryr_type::_CCYT_] = sccyt * cc;
+			m_vValues[ryr_type::_CER_] = scer * DoFRef(sol, m_vDoF[4*i + 1]);
+			m_vValues[ryr_type::_C1_] = sc1 * c1;
+			m_vValues[ryr_type::_C2_] = sc2 * c2;
+			ryr.calc_flux(m_vValues, m_vVrt[i], m_vFlux);
+			maxVals[1] = std::max(maxVals[1], (double) fabs(m_vFlux[0]));
+
+			const number val = m_bCalciumMode ? cc : 1.0 - (c1 + c2);
+			if (val > m_thresh)
+				front = i;
+		}
+	}
+	else
+		front = m_bLocalFrontValid ? incremental_search(sol) : full_search(sol);
+
+	m_localFront = front;
+	m_bLocalFrontValid = true;
+
+	// interpolate exact threshold position with right neighbor
+	if (front >= 0)
+	{
+		number xMax = m_vX[front];
+		if (front + 1 < nVrt)
+		{
+			const number vMax = front_value(sol, front);
+			const number vNext = front_value(sol, front + 1);
+			xMax = (xMax*(vNext-m_thresh) - m_vX[front+1]*(vMax - m_thresh)) / (vNext-vMax);
+		}
+		maxVals[0] = xMax;
+	}
+
+	// max over all processes (front and flux at once)
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		double local[2] = {maxVals[0], maxVals[1]};
+		com.allreduce(local, maxVals, 2, PCL_DT_DOUBLE, PCL_RO_MAX);
+	}
+#endif
+
+	// velocity from last two front positions
+	const number xNew = maxVals[0];
+	const number noFront = -std::numeric_limits<number>::max();
+	if (m_bHasLast && time > m_tLast && xNew != noFront && m_xFront != noFront)
+		m_vFront = (xNew - m_xFront) / (time - m_tLast);
+	else
+		m_vFront = 0.0;
+
+	m_xFront = xNew;
+	m_maxFlux = maxVals[1];
+	m_tLast = time;
+	m_bHasLast = true;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveFrontTracker<TDomain, TAlgebra>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		m_bCacheValid = false;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void WaveFrontTracker<TDomain, TAlgebra>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		m_bCacheValid = false;
+}
+
+
 } // namespace ug
 } // namespace neuro_collection
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#include "channel_state_migration.h"
+
+#include <algorithm>                              // for sort, binary_search
+
+#include "common/error.h"                         // for UG_COND_THROW
+#include "common/serialization.h"                 // for Serialize, Deserialize
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+ChannelStateMigration::ChannelStateMigration()
+: m_bObjectsCollected(false)
+{}
+
+
+void ChannelStateMigration::add_state(SmartPtr<ICheckpointState> state)
+{
+	UG_COND_THROW(!state.valid(), "Invalid state object given.");
+	m_vState.push_back(state);
+	m_bObjectsCollected = false;
+}
+
+
+void ChannelStateMigration::collect_objects() const
+{
+	const size_t nState = m_vState.size();
+	m_vvObj.resize(nState);
+	for (size_t s = 0; s < nState; ++s)
+	{
+		m_vState[s]->collect_checkpoint_objects(m_vvObj[s]);
+		std::sort(m_vvObj[s].begin(), m_vvObj[s].end());
+	}
+	m_bObjectsCollected = true;
+}
+
+
+void ChannelStateMigration::write_info(BinaryBuffer& out) const
+{
+	if (!m_bObjectsCollected)
+		collect_objects();
+
+	// number of channels and values per object (checked on the receiving side)
+	const size_t nState = m_vState.size();
+	Serialize(out, nState);
+	for (size_t s = 0; s < nState; ++s)
+		Serialize(out, m_vState[s]->num_checkpoint_values());
+}
+
+
+void ChannelStateMigration::read_info(BinaryBuffer& in)
+{
+	size_t nState;
+	Deserialize(in, nState);
+	UG_COND_THROW(nState != m_vState.size(), "Received states of " << nState
+		<< " channels, but " << m_vState.size() << " channels are registered locally.");
+
+	for (size_t s = 0; s < nState; ++s)
+	{
+		size_t nVal;
+		Deserialize(in, nVal);
+		UG_COND_THROW(nVal != m_vState[s]->num_checkpoint_values(),
+			"Number of state values of channel " << s << " differs between processes.");
+	}
+}
+
+
+void ChannelStateMigration::write_object(BinaryBuffer& out, GridObject* o) const
+{
+	const size_t nState = m_vState.size();
+	for (size_t s = 0; s < nState; ++s)
+	{
+		const char hasState =
+			std::binary_search(m_vvObj[s].begin(), m_vvObj[s].end(), o) ? 1 : 0;
+		out.write(&hasState, sizeof(char));
+		if (!hasState)
+			continue;
+
+		const size_t nVal = m_vState[s]->num_checkpoint_values();
+		m_vVal.resize(nVal);
+		m_vState[s]->get_checkpoint_values(o, &m_vVal[0]);
+		out.write(reinterpret_cast<const char*>(&m_vVal[0]), nVal * sizeof(number));
+	}
+}
+
+
+void ChannelStateMigration::read_object(BinaryBuffer& in, GridObject* o)
+{
+	const size_t nState = m_vState.size();
+	for (size_t s = 0; s < nState; ++s)
+	{
+		char hasState;
+		in.read(&hasState, sizeof(char));
+		if (!hasState)
+			continue;
+
+		const size_t nVal = m_vState[s]->num_checkpoint_values();
+		m_vVal.resize(nVal);
+		in.read(reinterpret_cast<char*>(&m_vVal[0]), nVal * sizeof(number));
+		m_vState[s]->set_checkpoint_values(o, &m_vVal[0]);
+	}
+}
+
+
+void ChannelStateMigration::deserialization_done()
+{
+	// objects carrying state have to be collected anew for the next redistribution
+	m_bObjectsCollected = false;
+	m_vvObj.clear();
+}
+
+
+#ifdef UG_PARALLEL
+void AddChannelStateMigration(SmartPtr<LoadBalancer> balancer, SmartPtr<ChannelStateMigration> migration)
+{
+	UG_COND_THROW(!balancer.valid(), "Invalid load balancer given.");
+	UG_COND_THROW(!migration.valid(), "Invalid channel state migration given.");
+	balancer->add_serializer(migration);
+}
+#endif
+
+
+} // namespace neuro_collection
+} // namespace ug
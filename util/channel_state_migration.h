@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__CHANNEL_STATE_MIGRATION_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__CHANNEL_STATE_MIGRATION_H
+
+#include <vector>                                 // for vector
+
+#include "common/types.h"                         // for number
+#include "common/util/binary_buffer.h"            // for BinaryBuffer
+#include "common/util/smart_pointer.h"            // for SmartPtr
+#include "lib_grid/algorithms/serialization.h"    // for GridDataSerializer
+#include "lib_grid/grid/grid_base_objects.h"      // for GridObject, Vertex, ...
+#ifdef UG_PARALLEL
+	#include "lib_grid/parallelization/load_balancer.h"  // for LoadBalancer
+#endif
+
+#include "checkpoint_state.h"                     // for ICheckpointState
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Migration of channel states with their grid objects on redistribution
+ *
+ * Channels keeping their gating states in grid attachments or maps (e.g. VDCC_BG,
+ * HHSpecies, RyRinstat) lose these states for all objects that are sent to another
+ * process on redistribution. This serializer packs the states of all added
+ * channels (given by their checkpoint state objects, see ICheckpointState) into
+ * the distribution buffers, in one block per grid object, and unpacks them on the
+ * receiving process, so that no channel has to be re-initialized to equilibrium
+ * after load balancing.
+ *
+ * The serializer has to be added to the load balancer (see AddChannelStateMigration());
+ * the channels have to be constructed (and added) in the same order on all processes.
+ * The set of objects carrying state is determined once per redistribution
+ * (on the first call to write_info()).
+ */
+class ChannelStateMigration : public GridDataSerializer
+{
+	public:
+		/// constructor
+		ChannelStateMigration();
+
+		/// add the state of a channel
+		void add_state(SmartPtr<ICheckpointState> state);
+
+		/// @name inheritances from GridDataSerializer
+		/// @{
+		virtual void write_info(BinaryBuffer& out) const;
+		virtual void read_info(BinaryBuffer& in);
+
+		virtual void write_data(BinaryBuffer& out, Vertex* o) const {write_object(out, o);}
+		virtual void write_data(BinaryBuffer& out, Edge* o) const {write_object(out, o);}
+		virtual void write_data(BinaryBuffer& out, Face* o) const {write_object(out, o);}
+		virtual void write_data(BinaryBuffer& out, Volume* o) const {write_object(out, o);}
+
+		virtual void read_data(BinaryBuffer& in, Vertex* o) {read_object(in, o);}
+		virtual void read_data(BinaryBuffer& in, Edge* o) {read_object(in, o);}
+		virtual void read_data(BinaryBuffer& in, Face* o) {read_object(in, o);}
+		virtual void read_data(BinaryBuffer& in, Volume* o) {read_object(in, o);}
+
+		virtual void deserialization_done();
+		/// @}
+
+	private:
+		void collect_objects() const;
+		void write_object(BinaryBuffer& out, GridObject* o) const;
+		void read_object(BinaryBuffer& in, GridObject* o);
+
+	private:
+		std::vector<SmartPtr<ICheckpointState> > m_vState;
+
+		/// sorted objects carrying state, for each channel (cached per redistribution)
+		mutable std::vector<std::vector<GridObject*> > m_vvObj;
+		mutable bool m_bObjectsCollected;
+
+		/// buffer for the values of one object
+		mutable std::vector<number> m_vVal;
+};
+
+
+#ifdef UG_PARALLEL
+/// add a channel state migration to the serializers of a load balancer
+void AddChannelStateMigration(SmartPtr<LoadBalancer> balancer, SmartPtr<ChannelStateMigration> migration);
+#endif
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__CHANNEL_STATE_MIGRATION_H
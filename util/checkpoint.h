@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__CHECKPOINT_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__CHECKPOINT_H
+
+#include <string>                                           // for string
+#include <vector>                                           // for vector
+
+#include "common/types.h"                                   // for number
+#include "common/util/smart_pointer.h"                      // for SmartPtr
+#include "lib_disc/common/multi_index.h"                    // for DoFIndex
+#include "lib_grid/grid/grid_base_objects.h"                // for GridObject
+
+#include "checkpoint_file.h"                                // for CheckpointFile
+#include "checkpoint_state.h"                               // for ICheckpointState
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Parallel binary checkpoint of a solution and additional state
+ *
+ * Writes all DoFs of a grid function (for all functions) together with
+ * non-DoF state provided by ICheckpointState objects (e.g., the gating states
+ * of VDCC_BG or HHSpecies channels, see their checkpoint_state() methods)
+ * into one binary file. In parallel, all processes write their parts
+ * into the same file using collective MPI-IO.
+ *
+ * Every entry is stored together with its position (DoF position or center
+ * of the grid object). On restart, the entries are read back in parallel:
+ * - If the number of processes and the local entry layout are unchanged,
+ *   each process reads exactly its own block.
+ * - Otherwise (e.g., after a redistribution), each process scans the file
+ *   for entries within its bounding box and finds the entries for its DoFs
+ *   and objects by binary search over the positions, i.e., in O(log n)
+ *   per entry.
+ * Positions are matched up to a tolerance relative to the extent of the grid
+ * (see set_tolerance()). The grid must be the same (same refinement) as when
+ * the checkpoint was written.
+ *
+ * Data derived from the geometry only (e.g., the 1d-3d mapping of the
+ * HybridNeuronCommunicator) is not stored; it is recomputed on restart.
+ *
+ * File layout (native byte order):
+ *   - magic "NCCKP001", dim (uint32), number of writing processes (uint32),
+ *     number of sections (uint32), reserved (uint32), time (double),
+ *   - for each section: name length (uint32) and name, values per entry (uint32),
+ *     number of entries of each writing process (uint64 each),
+ *   - for each section, for each process: entries of dim coordinates
+ *     followed by the values (double each).
+ * Solution sections are named "fct:<function name>", state sections "state:<name>".
+ */
+template <typename TGridFunction>
+class SolutionCheckpoint
+{
+	public:
+		typedef typename TGridFunction::domain_type domain_type;
+		static const int dim = domain_type::dim;
+
+	public:
+		/// constructor
+		SolutionCheckpoint(SmartPtr<TGridFunction> u);
+
+		/// add non-DoF state (the name has to be unique)
+		void add_state(const std::string& name, SmartPtr<ICheckpointState> state);
+
+		/// set relative tolerance for matching positions (default: 1e-8)
+		void set_tolerance(number relTol);
+
+		/// write checkpoint for the given time
+		void write(const std::string& fileName, number time);
+
+		/// read checkpoint into the solution and states; returns the checkpoint time
+		number read(const std::string& fileName);
+
+	private:
+		struct Section
+		{
+			std::string name;
+			size_t nVal;
+			std::vector<number> vPos;			///< dim coordinates per entry
+			std::vector<DoFIndex> vDoF;			///< solution sections
+			std::vector<GridObject*> vObj;		///< state sections
+			SmartPtr<ICheckpointState> spState;
+
+			size_t num_entries() const {return vDoF.size() + vObj.size();}
+		};
+
+		struct FileSection
+		{
+			std::string name;
+			size_t nVal;
+			std::vector<uint64_t> vCount;		///< number of entries per writing process
+			uint64_t offset;					///< byte offset of first entry
+		};
+
+		void collect_sections(std::vector<Section>& vSec) const;
+
+		template <typename TBaseElem>
+		void collect_dofs(size_t fct, int si, Section& sec) const;
+
+		void get_values(const Section& sec, size_t i, number* vals) const;
+		void set_values(Section& sec, size_t i, const number* vals);
+
+		bool read_own_block(CheckpointFile& file, const FileSection& fsec, Section& sec, number tol);
+		size_t read_by_position(CheckpointFile& file, const FileSection& fsec, Section& sec, number tol);
+
+	private:
+		SmartPtr<TGridFunction> m_spSol;
+		std::vector<std::string> m_vStateName;
+		std::vector<SmartPtr<ICheckpointState> > m_vState;
+		number m_relTol;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "checkpoint_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__CHECKPOINT_H
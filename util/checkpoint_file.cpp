@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "checkpoint_file.h"
+
+#include "common/error.h"                // for UG_COND_THROW
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_base.h"            // for NumProcs
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+// size of blocks used to circumvent the int limit of MPI counts
+static const size_t checkpointBlockBytes = 1 << 20;
+
+
+CheckpointFile::CheckpointFile(const std::string& fileName, Mode mode)
+: m_fileName(fileName), m_bParallel(false), m_fp(NULL)
+{
+#ifdef UG_PARALLEL
+	m_bParallel = pcl::NumProcs() > 1;
+	if (m_bParallel)
+	{
+		pcl::ProcessCommunicator pc;
+		const int amode = mode == CF_WRITE ? (MPI_MODE_CREATE | MPI_MODE_WRONLY) : MPI_MODE_RDONLY;
+
+		// some old MPI implementations need non-const char* here
+		if (MPI_File_open(pc.get_mpi_communicator(), const_cast<char*>(fileName.c_str()),
+			amode, MPI_INFO_NULL, &m_fh) != MPI_SUCCESS)
+			UG_THROW("Unable to open checkpoint file '" << fileName << "'.");
+		if (mode == CF_WRITE)
+			MPI_File_set_size(m_fh, 0);
+
+		MPI_Type_contiguous((int) checkpointBlockBytes, MPI_BYTE, &m_blockType);
+		MPI_Type_commit(&m_blockType);
+		return;
+	}
+#endif
+
+	m_fp = fopen(fileName.c_str(), mode == CF_WRITE ? "wb" : "rb");
+	UG_COND_THROW(!m_fp, "Unable to open checkpoint file '" << fileName << "'.");
+}
+
+
+CheckpointFile::~CheckpointFile()
+{
+#ifdef UG_PARALLEL
+	if (m_bParallel)
+	{
+		MPI_File_close(&m_fh);
+		MPI_Type_free(&m_blockType);
+		return;
+	}
+#endif
+	fclose(m_fp);
+}
+
+
+void CheckpointFile::write_at(uint64_t offset, const void* data, size_t nBytes)
+{
+#ifdef UG_PARALLEL
+	if (m_bParallel)
+	{
+		// always two collective calls: full blocks and remainder
+		char* p = static_cast<char*>(const_cast<void*>(data));
+		const size_t nBlocks = nBytes / checkpointBlockBytes;
+		const size_t rest = nBytes % checkpointBlockBytes;
+		MPI_Status status;
+		if (MPI_File_write_at_all(m_fh, (MPI_Offset) offset, p, (int) nBlocks, m_blockType, &status)
+				!= MPI_SUCCESS
+			|| MPI_File_write_at_all(m_fh, (MPI_Offset) (offset + nBlocks*checkpointBlockBytes),
+				p + nBlocks*checkpointBlockBytes, (int) rest, MPI_BYTE, &status) != MPI_SUCCESS)
+			UG_THROW("Writing to checkpoint file '" << m_fileName << "' failed.");
+		return;
+	}
+#endif
+
+	if (!nBytes)
+		return;
+	UG_COND_THROW(fseek(m_fp, (long) offset, SEEK_SET) != 0
+		|| fwrite(data, 1, nBytes, m_fp) != nBytes,
+		"Writing to checkpoint file '" << m_fileName << "' failed.");
+}
+
+
+void CheckpointFile::read_at(uint64_t offset, void* data, size_t nBytes)
+{
+#ifdef UG_PARALLEL
+	if (m_bParallel)
+	{
+		char* p = static_cast<char*>(data);
+		const size_t nBlocks = nBytes / checkpointBlockBytes;
+		const size_t rest = nBytes % checkpointBlockBytes;
+		MPI_Status status;
+		if (MPI_File_read_at_all(m_fh, (MPI_Offset) offset, p, (int) nBlocks, m_blockType, &status)
+				!= MPI_SUCCESS
+			|| MPI_File_read_at_all(m_fh, (MPI_Offset) (offset + nBlocks*checkpointBlockBytes),
+				p + nBlocks*checkpointBlockBytes, (int) rest, MPI_BYTE, &status) != MPI_SUCCESS)
+			UG_THROW("Reading from checkpoint file '" << m_fileName << "' failed.");
+		return;
+	}
+#endif
+
+	if (!nBytes)
+		return;
+	UG_COND_THROW(fseek(m_fp, (long) offset, SEEK_SET) != 0
+		|| fread(data, 1, nBytes, m_fp) != nBytes,
+		"Reading from checkpoint file '" << m_fileName << "' failed (file too short?).");
+}
+
+
+uint64_t CheckpointFile::size()
+{
+#ifdef UG_PARALLEL
+	if (m_bParallel)
+	{
+		MPI_Offset sz = 0;
+		MPI_File_get_size(m_fh, &sz);
+		return (uint64_t) sz;
+	}
+#endif
+
+	UG_COND_THROW(fseek(m_fp, 0, SEEK_END) != 0,
+		"Size of checkpoint file '" << m_fileName << "' could not be determined.");
+	return (uint64_t) ftell(m_fp);
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__CHECKPOINT_FILE_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__CHECKPOINT_FILE_H
+
+#include <cstddef>                       // for size_t
+#include <cstdio>                        // for FILE
+#include <stdint.h>                      // for uint64_t
+#include <string>                        // for string
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_process_communicator.h"  // for MPI_File
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Binary file for collective positioned reads and writes
+ *
+ * In parallel (more than one process), the file is opened by all processes
+ * and accessed using collective MPI-IO; all methods must therefore be called
+ * by all processes (with possibly empty data). In serial, stdio is used.
+ * Data of arbitrary size can be read and written (no int limit on byte counts).
+ */
+class CheckpointFile
+{
+	public:
+		enum Mode {CF_READ, CF_WRITE};
+
+	public:
+		/// open file (truncated when opened for writing)
+		CheckpointFile(const std::string& fileName, Mode mode);
+
+		/// close file
+		~CheckpointFile();
+
+		/// write nBytes at byte offset
+		void write_at(uint64_t offset, const void* data, size_t nBytes);
+
+		/// read nBytes from byte offset
+		void read_at(uint64_t offset, void* data, size_t nBytes);
+
+		/// file size in bytes
+		uint64_t size();
+
+		/// file name
+		const std::string& file_name() const {return m_fileName;}
+
+	private:
+		// not copyable
+		CheckpointFile(const CheckpointFile&);
+		CheckpointFile& operator=(const CheckpointFile&);
+
+	private:
+		std::string m_fileName;
+		bool m_bParallel;
+		FILE* m_fp;
+#ifdef UG_PARALLEL
+		MPI_File m_fh;
+		MPI_Datatype m_blockType;
+#endif
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__CHECKPOINT_FILE_H
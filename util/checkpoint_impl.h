@@ -0,0 +1,593 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "checkpoint.h"
+
+#include <algorithm>                                        // for std::sort, std::lower_bound, std::min
+#include <cmath>                                            // for fabs
+#include <cstring>                                          // for memcpy, memcmp
+#include <limits>                                           // for numeric_limits
+#include <utility>                                          // for pair
+
+#include "common/error.h"                                   // for UG_THROW etc.
+#include "common/math/ugmath.h"                             // for VecSet, VecAdd, VecScale
+#include "lib_disc/function_spaces/dof_position_util.h"     // for InnerDoFPosition
+#include "lib_grid/grid/grid_base_objects.h"                // for Vertex, Edge, Face, Volume
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_base.h"                               // for NumProcs, ProcRank
+	#include "pcl/pcl_process_communicator.h"               // for ProcessCommunicator
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+static const char checkpointFileMagic[8] = {'N', 'C', 'C', 'K', 'P', '0', '0', '1'};
+
+
+template <typename TElem, typename TAAPos>
+static void AddCheckpointObjectCenter(std::vector<number>& vPos, TElem* elem, const TAAPos& aaPos)
+{
+	typename TAAPos::ValueType c;
+	VecSet(c, 0.0);
+	const size_t nVrt = elem->num_vertices();
+	for (size_t i = 0; i < nVrt; ++i)
+		VecAdd(c, c, aaPos[elem->vertex(i)]);
+	VecScale(c, c, 1.0 / nVrt);
+
+	for (size_t d = 0; d < c.size(); ++d)
+		vPos.push_back(c[d]);
+}
+
+
+template <typename TAAPos>
+static void AddCheckpointObjectCenter(std::vector<number>& vPos, GridObject* o, const TAAPos& aaPos)
+{
+	switch (o->base_object_id())
+	{
+		case VERTEX:
+		{
+			const typename TAAPos::ValueType& c = aaPos[static_cast<Vertex*>(o)];
+			for (size_t d = 0; d < c.size(); ++d)
+				vPos.push_back(c[d]);
+			return;
+		}
+		case EDGE: AddCheckpointObjectCenter(vPos, static_cast<Edge*>(o), aaPos); return;
+		case FACE: AddCheckpointObjectCenter(vPos, static_cast<Face*>(o), aaPos); return;
+		case VOLUME: AddCheckpointObjectCenter(vPos, static_cast<Volume*>(o), aaPos); return;
+		default: UG_THROW("Unknown base object type " << o->base_object_id() << ".");
+	}
+}
+
+
+static inline void AppendCheckpointBytes(std::vector<char>& buf, const void* p, size_t n)
+{
+	const char* c = static_cast<const char*>(p);
+	buf.insert(buf.end(), c, c + n);
+}
+
+
+static inline int CheckpointAllMin(int val)
+{
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		int res = val;
+		com.allreduce(&val, &res, 1, PCL_DT_INT, PCL_RO_MIN);
+		return res;
+	}
+#endif
+	return val;
+}
+
+
+
+template <typename TGridFunction>
+SolutionCheckpoint<TGridFunction>::SolutionCheckpoint(SmartPtr<TGridFunction> u)
+: m_spSol(u), m_relTol(1e-8)
+{
+	UG_COND_THROW(!m_spSol.valid(), "SolutionCheckpoint: Invalid solution given.");
+}
+
+
+template <typename TGridFunction>
+void SolutionCheckpoint<TGridFunction>::add_state(const std::string& name, SmartPtr<ICheckpointState> state)
+{
+	UG_COND_THROW(!state.valid(), "SolutionCheckpoint: Invalid state given for '" << name << "'.");
+	for (size_t i = 0; i < m_vStateName.size(); ++i)
+		UG_COND_THROW(m_vStateName[i] == name, "SolutionCheckpoint: State name '" << name << "' is already in use.");
+
+	m_vStateName.push_back(name);
+	m_vState.push_back(state);
+}
+
+
+template <typename TGridFunction>
+void SolutionCheckpoint<TGridFunction>::set_tolerance(number relTol)
+{
+	UG_COND_THROW(relTol < 0.0, "Tolerance must be non-negative.");
+	m_relTol = relTol;
+}
+
+
+template <typename TGridFunction>
+template <typename TBaseElem>
+void SolutionCheckpoint<TGridFunction>::collect_dofs(size_t fct, int si, Section& sec) const
+{
+	typedef typename DoFDistribution::traits<TBaseElem>::const_iterator it_type;
+
+	ConstSmartPtr<DoFDistribution> dd = m_spSol->dof_distribution();
+	const domain_type& dom = *m_spSol->approx_space()->domain();
+	const LFEID lfeid = dd->lfeid(fct);
+
+	std::vector<typename domain_type::position_type> vCoord;
+	std::vector<DoFIndex> vInd;
+	it_type it = dd->template begin<TBaseElem>(si);
+	it_type itEnd = dd->template end<TBaseElem>(si);
+	for (; it != itEnd; ++it)
+	{
+		InnerDoFPosition<domain_type>(vCoord, *it, dom, lfeid);
+		dd->inner_dof_indices(*it, fct, vInd);
+		UG_COND_THROW(vCoord.size() != vInd.size(), "Number of DoF positions (" << vCoord.size()
+			<< ") does not match number of DoFs (" << vInd.size() << ").");
+
+		for (size_t k = 0; k < vInd.size(); ++k)
+		{
+			for (int d = 0; d < dim; ++d)
+				sec.vPos.push_back(vCoord[k][d]);
+			sec.vDoF.push_back(vInd[k]);
+		}
+	}
+}
+
+
+template <typename TGridFunction>
+void SolutionCheckpoint<TGridFunction>::collect_sections(std::vector<Section>& vSec) const
+{
+	ConstSmartPtr<DoFDistribution> dd = m_spSol->dof_distribution();
+
+	// one section per function
+	const size_t nFct = dd->num_fct();
+	const int nSi = dd->num_subsets();
+	vSec.resize(nFct + m_vState.size());
+	for (size_t fct = 0; fct < nFct; ++fct)
+	{
+		Section& sec = vSec[fct];
+		sec.name = std::string("fct:") + dd->name(fct);
+		sec.nVal = 1;
+
+		for (int si = 0; si < nSi; ++si)
+		{
+			if (!dd->is_def_in_subset(fct, si))
+				continue;
+
+			if (dim >= VERTEX && dd->max_fct_dofs(fct, VERTEX, si) > 0)
+				collect_dofs<Vertex>(fct, si, sec);
+			if (dim >= EDGE && dd->max_fct_dofs(fct, EDGE, si) > 0)
+				collect_dofs<Edge>(fct, si, sec);
+			if (dim >= FACE && dd->max_fct_dofs(fct, FACE, si) > 0)
+				collect_dofs<Face>(fct, si, sec);
+			if (dim >= VOLUME && dd->max_fct_dofs(fct, VOLUME, si) > 0)
+				collect_dofs<Volume>(fct, si, sec);
+		}
+	}
+
+	// one section per state
+	const typename domain_type::position_accessor_type& aaPos
+		= m_spSol->approx_space()->domain()->position_accessor();
+	for (size_t s = 0; s < m_vState.size(); ++s)
+	{
+		Section& sec = vSec[nFct + s];
+		sec.name = std::string("state:") + m_vStateName[s];
+		sec.nVal = m_vState[s]->num_checkpoint_values();
+		sec.spState = m_vState[s];
+
+		sec.spState->collect_checkpoint_objects(sec.vObj);
+		for (size_t i = 0; i < sec.vObj.size(); ++i)
+			AddCheckpointObjectCenter(sec.vPos, sec.vObj[i], aaPos);
+	}
+}
+
+
+template <typename TGridFunction>
+inline void SolutionCheckpoint<TGridFunction>::get_values(const Section& sec, size_t i, number* vals) const
+{
+	if (sec.spState.valid())
+		sec.spState->get_checkpoint_values(sec.vObj[i], vals);
+	else
+		vals[0] = DoFRef(*m_spSol, sec.vDoF[i]);
+}
+
+
+template <typename TGridFunction>
+inline void SolutionCheckpoint<TGridFunction>::set_values(Section& sec, size_t i, const number* vals)
+{
+	if (sec.spState.valid())
+		sec.spState->set_checkpoint_values(sec.vObj[i], vals);
+	else
+		DoFRef(*m_spSol, sec.vDoF[i]) = vals[0];
+}
+
+
+template <typename TGridFunction>
+void SolutionCheckpoint<TGridFunction>::write(const std::string& fileName, number time)
+{
+	std::vector<Section> vSec;
+	collect_sections(vSec);
+	const size_t nSec = vSec.size();
+
+	// entry counts of all procs
+	size_t np = 1;
+	size_t myRank = 0;
+	std::vector<unsigned long> vLocCnt(nSec);
+	for (size_t s = 0; s < nSec; ++s)
+		vLocCnt[s] = vSec[s].num_entries();
+	std::vector<unsigned long> vCnt = vLocCnt;	// proc-major
+#ifdef UG_PARALLEL
+	np = pcl::NumProcs();
+	myRank = pcl::ProcRank();
+	if (np > 1 && nSec)
+	{
+		pcl::ProcessCommunicator com;
+		vCnt.resize(np*nSec);
+		com.allgather(&vLocCnt[0], (int) nSec, PCL_DT_UNSIGNED_LONG, &vCnt[0], (int) nSec, PCL_DT_UNSIGNED_LONG);
+	}
+#endif
+
+	// header (identical on all procs)
+	std::vector<char> header;
+	AppendCheckpointBytes(header, checkpointFileMagic, 8);
+	const uint32_t fileDim = dim;
+	const uint32_t fileNp = np;
+	const uint32_t fileNSec = nSec;
+	const uint32_t reserved = 0;
+	const double t = time;
+	AppendCheckpointBytes(header, &fileDim, 4);
+	AppendCheckpointBytes(header, &fileNp, 4);
+	AppendCheckpointBytes(header, &fileNSec, 4);
+	AppendCheckpointBytes(header, &reserved, 4);
+	AppendCheckpointBytes(header, &t, 8);
+	for (size_t s = 0; s < nSec; ++s)
+	{
+		const uint32_t len = vSec[s].name.size();
+		const uint32_t nVal = vSec[s].nVal;
+		AppendCheckpointBytes(header, &len, 4);
+		AppendCheckpointBytes(header, vSec[s].name.data(), len);
+		AppendCheckpointBytes(header, &nVal, 4);
+		for (size_t p = 0; p < np; ++p)
+		{
+			const uint64_t cnt = vCnt[p*nSec + s];
+			AppendCheckpointBytes(header, &cnt, 8);
+		}
+	}
+
+	CheckpointFile file(fileName, CheckpointFile::CF_WRITE);
+	file.write_at(0, &header[0], myRank == 0 ? header.size() : 0);
+
+	// sections (one contiguous block per proc)
+	uint64_t offset = header.size();
+	std::vector<double> buf;
+	for (size_t s = 0; s < nSec; ++s)
+	{
+		const Section& sec = vSec[s];
+		const size_t entrySz = dim + sec.nVal;
+
+		uint64_t myOffset = offset;
+		uint64_t total = 0;
+		for (size_t p = 0; p < np; ++p)
+		{
+			if (p == myRank)
+				myOffset = offset + 8*entrySz*total;
+			total += vCnt[p*nSec + s];
+		}
+
+		const size_t nEntries = sec.num_entries();
+		buf.resize(nEntries * entrySz);
+		for (size_t i = 0; i < nEntries; ++i)
+		{
+			double* entry = &buf[i*entrySz];
+			for (int d = 0; d < dim; ++d)
+				entry[d] = sec.vPos[i*dim + d];
+			get_values(sec, i, entry + dim);
+		}
+
+		file.write_at(myOffset, buf.empty() ? NULL : &buf[0], 8*buf.size());
+		offset += 8*entrySz*total;
+	}
+}
+
+
+template <typename TGridFunction>
+bool SolutionCheckpoint<TGridFunction>::read_own_block
+(
+	CheckpointFile& file,
+	const FileSection& fsec,
+	Section& sec,
+	number tol
+)
+{
+	size_t myRank = 0;
+#ifdef UG_PARALLEL
+	myRank = pcl::ProcRank();
+#endif
+
+	const size_t entrySz = dim + sec.nVal;
+	uint64_t before = 0;
+	for (size_t p = 0; p < myRank; ++p)
+		before += fsec.vCount[p];
+
+	const size_t nEntries = sec.num_entries();
+	std::vector<double> buf(nEntries * entrySz);
+	file.read_at(fsec.offset + 8*entrySz*before, buf.empty() ? NULL : &buf[0], 8*buf.size());
+
+	// the layout is only the same if all positions match
+	for (size_t i = 0; i < nEntries; ++i)
+		for (int d = 0; d < dim; ++d)
+			if (fabs(buf[i*entrySz + d] - sec.vPos[i*dim + d]) > tol)
+				return false;
+
+	for (size_t i = 0; i < nEntries; ++i)
+		set_values(sec, i, &buf[i*entrySz + dim]);
+
+	return true;
+}
+
+
+template <typename TGridFunction>
+size_t SolutionCheckpoint<TGridFunction>::read_by_position
+(
+	CheckpointFile& file,
+	const FileSection& fsec,
+	Section& sec,
+	number tol
+)
+{
+	const size_t entrySz = dim + sec.nVal;
+	const size_t nEntries = sec.num_entries();
+
+	// bounding box of local entries
+	std::vector<number> vMin(dim, std::numeric_limits<number>::max());
+	std::vector<number> vMax(dim, -std::numeric_limits<number>::max());
+	for (size_t i = 0; i < nEntries; ++i)
+	{
+		for (int d = 0; d < dim; ++d)
+		{
+			vMin[d] = std::min(vMin[d], sec.vPos[i*dim + d] - tol);
+			vMax[d] = std::max(vMax[d], sec.vPos[i*dim + d] + tol);
+		}
+	}
+
+	// scan file in chunks (all procs read the same chunks), keep entries in bounding box
+	uint64_t total = 0;
+	for (size_t p = 0; p < fsec.vCount.size(); ++p)
+		total += fsec.vCount[p];
+
+	const uint64_t chunkEntries = 1 << 16;
+	std::vector<double> chunk;
+	std::vector<double> vKeep;
+	for (uint64_t start = 0; start < total; start += chunkEntries)
+	{
+		const uint64_t n = std::min(chunkEntries, total - start);
+		chunk.resize(n * entrySz);
+		file.read_at(fsec.offset + 8*entrySz*start, &chunk[0], 8*chunk.size());
+
+		for (uint64_t k = 0; k < n; ++k)
+		{
+			const double* entry = &chunk[k*entrySz];
+			bool bInside = true;
+			for (int d = 0; d < dim && bInside; ++d)
+				bInside = entry[d] >= vMin[d] && entry[d] <= vMax[d];
+			if (bInside)
+				vKeep.insert(vKeep.end(), entry, entry + entrySz);
+		}
+	}
+
+	// sort kept entries by first coordinate
+	const size_t nKeep = vKeep.size() / entrySz;
+	std::vector<std::pair<number, size_t> > vSorted(nKeep);
+	for (size_t k = 0; k < nKeep; ++k)
+		vSorted[k] = std::make_pair((number) vKeep[k*entrySz], k);
+	std::sort(vSorted.begin(), vSorted.end());
+
+	// look up every local entry
+	size_t nMissing = 0;
+	for (size_t i = 0; i < nEntries; ++i)
+	{
+		const number* pos = &sec.vPos[i*dim];
+		typename std::vector<std::pair<number, size_t> >::const_iterator it
+			= std::lower_bound(vSorted.begin(), vSorted.end(), std::make_pair(pos[0] - tol, (size_t) 0));
+
+		bool bFound = false;
+		for (; it != vSorted.end() && it->first <= pos[0] + tol; ++it)
+		{
+			const double* entry = &vKeep[it->second * entrySz];
+			bool bMatch = true;
+			for (int d = 1; d < dim && bMatch; ++d)
+				bMatch = fabs(entry[d] - pos[d]) <= tol;
+			if (bMatch)
+			{
+				set_values(sec, i, entry + dim);
+				bFound = true;
+				break;
+			}
+		}
+		if (!bFound)
+			++nMissing;
+	}
+
+	return nMissing;
+}
+
+
+template <typename TGridFunction>
+number SolutionCheckpoint<TGridFunction>::read(const std::string& fileName)
+{
+	CheckpointFile file(fileName, CheckpointFile::CF_READ);
+
+	// header
+	char fixed[32];
+	file.read_at(0, fixed, 32);
+	UG_COND_THROW(memcmp(fixed, checkpointFileMagic, 8) != 0,
+		"File '" << fileName << "' is no checkpoint file.");
+	uint32_t fileDim, fileNp, fileNSec;
+	double time;
+	memcpy(&fileDim, fixed + 8, 4);
+	memcpy(&fileNp, fixed + 12, 4);
+	memcpy(&fileNSec, fixed + 16, 4);
+	memcpy(&time, fixed + 24, 8);
+	UG_COND_THROW(fileDim != (uint32_t) dim, "Checkpoint file '" << fileName << "' was written for dimension "
+		<< fileDim << ", but the solution is of dimension " << dim << ".");
+
+	std::vector<FileSection> vFileSec(fileNSec);
+	uint64_t pos = 32;
+	for (size_t s = 0; s < fileNSec; ++s)
+	{
+		FileSection& fsec = vFileSec[s];
+		uint32_t len, nVal;
+		file.read_at(pos, &len, 4);
+		pos += 4;
+		std::vector<char> name(len);
+		file.read_at(pos, len ? &name[0] : NULL, len);
+		pos += len;
+		fsec.name.assign(name.begin(), name.end());
+		file.read_at(pos, &nVal, 4);
+		pos += 4;
+		fsec.nVal = nVal;
+		fsec.vCount.resize(fileNp);
+		file.read_at(pos, &fsec.vCount[0], 8*fileNp);
+		pos += 8*fileNp;
+	}
+	for (size_t s = 0; s < fileNSec; ++s)
+	{
+		FileSection& fsec = vFileSec[s];
+		fsec.offset = pos;
+		for (size_t p = 0; p < fileNp; ++p)
+			pos += 8*(dim + fsec.nVal)*fsec.vCount[p];
+	}
+
+	// local entries
+	std::vector<Section> vSec;
+	collect_sections(vSec);
+
+	// tolerance relative to the extent of the grid
+	std::vector<double> vExt(2*dim, -std::numeric_limits<double>::max());	// -min, max
+	for (size_t s = 0; s < vSec.size(); ++s)
+	{
+		const std::vector<number>& vPos = vSec[s].vPos;
+		for (size_t i = 0; i < vPos.size(); ++i)
+		{
+			const int d = i % dim;
+			vExt[d] = std::max(vExt[d], (double) -vPos[i]);
+			vExt[dim + d] = std::max(vExt[dim + d], (double) vPos[i]);
+		}
+	}
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		std::vector<double> vLocExt = vExt;
+		com.allreduce(&vLocExt[0], &vExt[0], 2*dim, PCL_DT_DOUBLE, PCL_RO_MAX);
+	}
+#endif
+	number diam = 0.0;
+	for (int d = 0; d < dim; ++d)
+		diam = std::max(diam, (number) (vExt[dim + d] + vExt[d]));
+	const number tol = m_relTol * (diam > 0.0 ? diam : 1.0);
+
+	size_t np = 1;
+	size_t myRank = 0;
+#ifdef UG_PARALLEL
+	np = pcl::NumProcs();
+	myRank = pcl::ProcRank();
+#endif
+
+	for (size_t s = 0; s < vSec.size(); ++s)
+	{
+		Section& sec = vSec[s];
+
+		size_t fs = 0;
+		for (; fs < vFileSec.size(); ++fs)
+			if (vFileSec[fs].name == sec.name)
+				break;
+		UG_COND_THROW(fs == vFileSec.size(), "Section '" << sec.name << "' not found in checkpoint file '"
+			<< fileName << "'.");
+		const FileSection& fsec = vFileSec[fs];
+		UG_COND_THROW(fsec.nVal != sec.nVal, "Section '" << sec.name << "' of checkpoint file '" << fileName
+			<< "' has " << fsec.nVal << " values per entry, but " << sec.nVal << " are required.");
+
+		// same layout: every proc reads its own block
+		int bSameLayout = fileNp == np && fsec.vCount[myRank] == sec.num_entries();
+		bSameLayout = CheckpointAllMin(bSameLayout);
+		if (bSameLayout)
+			bSameLayout = CheckpointAllMin(read_own_block(file, fsec, sec, tol));
+
+		// otherwise: look up by position
+		if (!bSameLayout)
+		{
+			unsigned long nMissing = read_by_position(file, fsec, sec, tol);
+#ifdef UG_PARALLEL
+			if (np > 1)
+			{
+				pcl::ProcessCommunicator com;
+				unsigned long loc = nMissing;
+				com.allreduce(&loc, &nMissing, 1, PCL_DT_UNSIGNED_LONG, PCL_RO_SUM);
+			}
+#endif
+			UG_COND_THROW(nMissing, nMissing << " entries of section '" << sec.name
+				<< "' could not be found in checkpoint file '" << fileName << "'.\n"
+				"Make sure the grid is the same as when the checkpoint was written.");
+		}
+	}
+
+#ifdef UG_PARALLEL
+	m_spSol->set_storage_type(PST_CONSISTENT);
+#endif
+
+	for (size_t s = 0; s < m_vState.size(); ++s)
+		m_vState[s]->checkpoint_restored(time);
+
+	return time;
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__CHECKPOINT_STATE_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__CHECKPOINT_STATE_H
+
+#include <vector>                                 // for vector
+
+#include "common/types.h"                         // for number
+#include "lib_grid/grid/grid_base_objects.h"      // for GridObject
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Interface for non-DoF state to be stored in a SolutionCheckpoint
+ *
+ * State that is not part of the solution vector (e.g., gating variables kept
+ * in attachments by some channels) is stored as a fixed number of values
+ * per grid object. On restart, the objects are identified by their centers,
+ * so that a checkpoint can be read on a different distribution of the grid.
+ */
+class ICheckpointState
+{
+	public:
+		virtual ~ICheckpointState() {}
+
+		/// number of values per grid object
+		virtual size_t num_checkpoint_values() const = 0;
+
+		/// get all (local) grid objects carrying state
+		virtual void collect_checkpoint_objects(std::vector<GridObject*>& vObj) = 0;
+
+		/// get the values of a grid object
+		virtual void get_checkpoint_values(GridObject* o, number* vals) const = 0;
+
+		/// set the values of a grid object
+		virtual void set_checkpoint_values(GridObject* o, const number* vals) = 0;
+
+		/// called after all values have been set on restart
+		virtual void checkpoint_restored(number time) = 0;
+};
+
+
+/**
+ * @brief ICheckpointState forwarding to equally named methods of an object
+ *
+ * This lets classes that cannot derive from ICheckpointState themselves
+ * (e.g., because of their registration in the registry) provide their state.
+ * The object must outlive this adapter.
+ */
+template <typename TObj>
+class MemberCheckpointState : public ICheckpointState
+{
+	public:
+		MemberCheckpointState(TObj* obj) : m_pObj(obj) {}
+
+		virtual size_t num_checkpoint_values() const
+		{return m_pObj->num_checkpoint_values();}
+
+		virtual void collect_checkpoint_objects(std::vector<GridObject*>& vObj)
+		{m_pObj->collect_checkpoint_objects(vObj);}
+
+		virtual void get_checkpoint_values(GridObject* o, number* vals) const
+		{m_pObj->get_checkpoint_values(o, vals);}
+
+		virtual void set_checkpoint_values(GridObject* o, const number* vals)
+		{m_pObj->set_checkpoint_values(o, vals);}
+
+		virtual void checkpoint_restored(number time)
+		{m_pObj->checkpoint_restored(time);}
+
+	private:
+		TObj* m_pObj;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__CHECKPOINT_STATE_H
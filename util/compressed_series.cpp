@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#include "compressed_series.h"
+
+#include <algorithm>                     // for upper_bound
+#include <cmath>                         // for fabs, floor
+#include <cstring>                       // for memcpy, memcmp
+#include <limits>                        // for numeric_limits
+
+#include "common/error.h"                // for UG_COND_THROW
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+static const char seriesFileMagic[8] = {'N', 'C', 'T', 'S', 'C', '0', '0', '1'};
+static const char seriesFileEndMagic[8] = {'N', 'C', 'T', 'S', 'C', 'E', 'N', 'D'};
+
+
+// /////////////////// //
+// encoding of values  //
+// /////////////////// //
+
+static inline void encode_varint(uint64_t v, std::vector<unsigned char>& buf)
+{
+	while (v >= 0x80)
+	{
+		buf.push_back((unsigned char) ((v & 0x7f) | 0x80));
+		v >>= 7;
+	}
+	buf.push_back((unsigned char) v);
+}
+
+
+/**
+ * xor-ed bit patterns: runs of zeros as byte 0x80 followed by the run length - 1 (varint),
+ * other values as one byte with the numbers of leading and trailing zero bytes,
+ * followed by the remaining bytes
+ */
+static void encode_xors(const std::vector<uint64_t>& vX, std::vector<unsigned char>& buf)
+{
+	const size_t n = vX.size();
+	for (size_t j = 0; j < n;)
+	{
+		const uint64_t x = vX[j];
+		if (!x)
+		{
+			size_t run = 1;
+			while (j + run < n && !vX[j + run]) ++run;
+			buf.push_back((unsigned char) (8 << 4));
+			encode_varint(run - 1, buf);
+			j += run;
+			continue;
+		}
+
+		unsigned lz = 0;
+		while (!((x >> (8*(7-lz))) & 0xff)) ++lz;
+		unsigned tz = 0;
+		while (!((x >> (8*tz)) & 0xff)) ++tz;
+
+		buf.push_back((unsigned char) ((lz << 4) | tz));
+		for (unsigned b = tz; b < 8 - lz; ++b)
+			buf.push_back((unsigned char) ((x >> (8*b)) & 0xff));
+		++j;
+	}
+}
+
+
+/**
+ * prediction errors of quanta: runs of zeros as varint((run length << 1) | 1),
+ * other errors as varint(zig-zag(error) << 1)
+ */
+static void encode_residuals(const std::vector<int64_t>& vRes, std::vector<unsigned char>& buf)
+{
+	const size_t n = vRes.size();
+	for (size_t j = 0; j < n;)
+	{
+		const int64_t d = vRes[j];
+		if (!d)
+		{
+			size_t run = 1;
+			while (j + run < n && !vRes[j + run]) ++run;
+			encode_varint(((uint64_t) run << 1) | 1, buf);
+			j += run;
+			continue;
+		}
+
+		const uint64_t zz = ((uint64_t) d << 1) ^ (uint64_t) (d >> 63);
+		encode_varint(zz << 1, buf);
+		++j;
+	}
+}
+
+
+static inline uint64_t bits_of(double v)
+{
+	uint64_t b;
+	memcpy(&b, &v, 8);
+	return b;
+}
+
+
+static inline double double_of(uint64_t b)
+{
+	double v;
+	memcpy(&v, &b, 8);
+	return v;
+}
+
+
+
+// ////////////////////////// //
+// CompressedSeriesWriter     //
+// ////////////////////////// //
+
+CompressedSeriesWriter::CompressedSeriesWriter
+(
+	const std::string& fileName,
+	const std::vector<number>& vCoord,
+	size_t coordDim,
+	size_t nValues,
+	const std::vector<std::string>& vColName,
+	number tolerance,
+	size_t chunkSize
+)
+: m_fileName(fileName), m_file(NULL), m_offset(0),
+  m_nValues(nValues), m_tol(tolerance), m_chunkSize(chunkSize),
+  m_vPrevBits(nValues, 0), m_vPrevQ(nValues, 0), m_vPrevPrevQ(nValues, 0)
+{
+	UG_COND_THROW(m_tol < 0.0, "Tolerance must not be negative (is " << m_tol << ").");
+	UG_COND_THROW(m_chunkSize < 1, "Chunk size must be positive.");
+	UG_COND_THROW((coordDim == 0 && !vCoord.empty()) || (coordDim && vCoord.size() % coordDim),
+		"Number of coordinates (" << vCoord.size() << ") does not match coordinate dimension "
+		<< coordDim << ".");
+
+	m_file = fopen(fileName.c_str(), "wb");
+	UG_COND_THROW(!m_file, "Compressed series file '" << fileName << "' could not be opened.");
+
+	// header
+	const uint32_t cDim = (uint32_t) coordDim;
+	const uint64_t nPts = coordDim ? (uint64_t) (vCoord.size() / coordDim) : 0;
+	const uint64_t nVal = (uint64_t) nValues;
+	const double tol = m_tol;
+	const uint32_t cs = (uint32_t) chunkSize;
+	const uint32_t nCol = (uint32_t) vColName.size();
+	write_bytes(seriesFileMagic, 8);
+	write_bytes(&cDim, 4);
+	write_bytes(&nPts, 8);
+	write_bytes(&nVal, 8);
+	write_bytes(&tol, 8);
+	write_bytes(&cs, 4);
+	write_bytes(&nCol, 4);
+	for (size_t i = 0; i < vColName.size(); ++i)
+	{
+		const uint32_t len = (uint32_t) vColName[i].size();
+		write_bytes(&len, 4);
+		write_bytes(vColName[i].data(), len);
+	}
+	for (size_t i = 0; i < vCoord.size(); ++i)
+	{
+		const double c = vCoord[i];
+		write_bytes(&c, 8);
+	}
+}
+
+
+CompressedSeriesWriter::~CompressedSeriesWriter()
+{
+	try {close();}
+	catch (...) {}
+}
+
+
+void CompressedSeriesWriter::write_bytes(const void* p, size_t nBytes)
+{
+	if (!nBytes)
+		return;
+	UG_COND_THROW(fwrite(p, 1, nBytes, m_file) != nBytes,
+		"Write to compressed series file '" << m_fileName << "' failed.");
+	m_offset += nBytes;
+}
+
+
+void CompressedSeriesWriter::write(number time, const std::vector<number>& vals)
+{
+	UG_COND_THROW(vals.size() != m_nValues, "Snapshot has " << vals.size()
+		<< " values, but the series expects " << m_nValues << ".");
+	write(time, vals.empty() ? NULL : &vals[0]);
+}
+
+
+void CompressedSeriesWriter::write(number time, const number* vals)
+{
+	UG_COND_THROW(!m_file, "Compressed series file '" << m_fileName << "' has already been closed.");
+
+	// first snapshot of a chunk is encoded against zero
+	if (m_vTime.size() % m_chunkSize == 0)
+	{
+		m_vChunkOffset.push_back(m_offset);
+		m_vPrevBits.assign(m_nValues, 0);
+		m_vPrevQ.assign(m_nValues, 0);
+		m_vPrevPrevQ.assign(m_nValues, 0);
+	}
+	m_vTime.push_back(time);
+
+	m_vBuf.clear();
+	if (m_tol > 0.0)
+	{
+		// quantize, predict by linear extrapolation from the last two snapshots
+		const number invStep = 0.5 / m_tol;
+		const number maxQ = 1.0e18;
+		m_vRes.resize(m_nValues);
+		for (size_t j = 0; j < m_nValues; ++j)
+		{
+			const number q = std::floor(vals[j] * invStep + 0.5);
+			UG_COND_THROW(!(std::fabs(q) < maxQ), "Value " << vals[j] << " cannot be quantized "
+				"with tolerance " << m_tol << " in compressed series '" << m_fileName << "'.");
+			const int64_t iq = (int64_t) q;
+			m_vRes[j] = iq - (2*m_vPrevQ[j] - m_vPrevPrevQ[j]);
+			m_vPrevPrevQ[j] = m_vPrevQ[j];
+			m_vPrevQ[j] = iq;
+		}
+		encode_residuals(m_vRes, m_vBuf);
+	}
+	else
+	{
+		m_vXor.resize(m_nValues);
+		for (size_t j = 0; j < m_nValues; ++j)
+		{
+			const uint64_t b = bits_of(vals[j]);
+			m_vXor[j] = b ^ m_vPrevBits[j];
+			m_vPrevBits[j] = b;
+		}
+		encode_xors(m_vXor, m_vBuf);
+	}
+
+	write_bytes(m_vBuf.empty() ? NULL : &m_vBuf[0], m_vBuf.size());
+}
+
+
+void CompressedSeriesWriter::close()
+{
+	if (!m_file)
+		return;
+
+	const uint64_t indexOffset = m_offset;
+	for (size_t c = 0; c < m_vChunkOffset.size(); ++c)
+		write_bytes(&m_vChunkOffset[c], 8);
+	for (size_t i = 0; i < m_vTime.size(); ++i)
+		write_bytes(&m_vTime[i], 8);
+
+	const uint64_t nSnap = m_vTime.size();
+	write_bytes(&indexOffset, 8);
+	write_bytes(&nSnap, 8);
+	write_bytes(seriesFileEndMagic, 8);
+
+	const bool bFail = fclose(m_file) != 0;
+	m_file = NULL;
+	UG_COND_THROW(bFail, "Compressed series file '" << m_fileName << "' could not be closed.");
+}
+
+
+
+// ////////////////////////// //
+// CompressedSeriesReader     //
+// ////////////////////////// //
+
+CompressedSeriesReader::CompressedSeriesReader(const std::string& fileName)
+: m_fileName(fileName), m_file(NULL), m_coordDim(0), m_nPoints(0), m_nValues(0),
+  m_tol(0.0), m_chunkSize(1), m_indexOffset(0), m_curr(-1)
+{
+	m_file = fopen(fileName.c_str(), "rb");
+	UG_COND_THROW(!m_file, "Compressed series file '" << fileName << "' could not be opened.");
+
+	// header
+	char magic[8];
+	read_bytes(magic, 8);
+	UG_COND_THROW(memcmp(magic, seriesFileMagic, 8),
+		"File '" << fileName << "' is not a compressed series file.");
+
+	uint32_t cDim, cs, nCol;
+	uint64_t nPts, nVal;
+	double tol;
+	read_bytes(&cDim, 4);
+	read_bytes(&nPts, 8);
+	read_bytes(&nVal, 8);
+	read_bytes(&tol, 8);
+	read_bytes(&cs, 4);
+	read_bytes(&nCol, 4);
+	m_coordDim = cDim;
+	m_nPoints = nPts;
+	m_nValues = nVal;
+	m_tol = tol;
+	m_chunkSize = cs;
+	UG_COND_THROW(m_chunkSize < 1, "Invalid chunk size in compressed series file '" << fileName << "'.");
+
+	m_vColName.resize(nCol);
+	for (size_t i = 0; i < nCol; ++i)
+	{
+		uint32_t len;
+		read_bytes(&len, 4);
+		m_vColName[i].resize(len);
+		if (len)
+			read_bytes(&m_vColName[i][0], len);
+	}
+
+	m_vCoord.resize(m_nPoints * m_coordDim);
+	for (size_t i = 0; i < m_vCoord.size(); ++i)
+	{
+		double c;
+		read_bytes(&c, 8);
+		m_vCoord[i] = c;
+	}
+
+	// footer and index
+	UG_COND_THROW(fseek(m_file, -24, SEEK_END) != 0,
+		"Compressed series file '" << fileName << "' is truncated.");
+	uint64_t nSnap;
+	read_bytes(&m_indexOffset, 8);
+	read_bytes(&nSnap, 8);
+	read_bytes(magic, 8);
+	UG_COND_THROW(memcmp(magic, seriesFileEndMagic, 8),
+		"Compressed series file '" << fileName << "' has not been closed properly.");
+
+	UG_COND_THROW(fseek(m_file, (long) m_indexOffset, SEEK_SET) != 0,
+		"Invalid index in compressed series file '" << fileName << "'.");
+	m_vChunkOffset.resize((nSnap + m_chunkSize - 1) / m_chunkSize);
+	for (size_t c = 0; c < m_vChunkOffset.size(); ++c)
+		read_bytes(&m_vChunkOffset[c], 8);
+	m_vTime.resize(nSnap);
+	for (size_t i = 0; i < nSnap; ++i)
+		read_bytes(&m_vTime[i], 8);
+
+	m_vBits.resize(m_nValues);
+	m_vQ.resize(m_nValues);
+	m_vPrevQ.resize(m_nValues);
+	m_vVal.resize(m_nValues);
+}
+
+
+CompressedSeriesReader::~CompressedSeriesReader()
+{
+	if (m_file)
+		fclose(m_file);
+}
+
+
+void CompressedSeriesReader::read_bytes(void* p, size_t nBytes)
+{
+	UG_COND_THROW(fread(p, 1, nBytes, m_file) != nBytes,
+		"Read from compressed series file '" << m_fileName << "' failed.");
+}
+
+
+number CompressedSeriesReader::coordinate(size_t i, size_t d) const
+{
+	UG_COND_THROW(i >= m_nPoints || d >= m_coordDim,
+		"Point " << i << " or coordinate " << d << " out of range.");
+	return m_vCoord[i*m_coordDim + d];
+}
+
+
+std::string CompressedSeriesReader::column_name(size_t i) const
+{
+	UG_COND_THROW(i >= m_vColName.size(), "Column " << i << " out of range.");
+	return m_vColName[i];
+}
+
+
+number CompressedSeriesReader::time(size_t i) const
+{
+	UG_COND_THROW(i >= m_vTime.size(), "Snapshot " << i << " out of range.");
+	return m_vTime[i];
+}
+
+
+size_t CompressedSeriesReader::snapshot_index(number t) const
+{
+	UG_COND_THROW(m_vTime.empty(), "Compressed series file '" << m_fileName << "' is empty.");
+	std::vector<double>::const_iterator it = std::upper_bound(m_vTime.begin(), m_vTime.end(), t);
+	return it == m_vTime.begin() ? 0 : (size_t) (it - m_vTime.begin()) - 1;
+}
+
+
+uint64_t CompressedSeriesReader::read_varint()
+{
+	uint64_t v = 0;
+	unsigned shift = 0;
+	int c;
+	do
+	{
+		c = fgetc(m_file);
+		UG_COND_THROW(c == EOF || shift > 63, "Compressed series file '" << m_fileName << "' is corrupt.");
+		v |= (uint64_t) (c & 0x7f) << shift;
+		shift += 7;
+	}
+	while (c & 0x80);
+	return v;
+}
+
+
+void CompressedSeriesReader::decode(size_t i)
+{
+	UG_COND_THROW(i >= m_vTime.size(), "Snapshot " << i << " out of range.");
+	if ((long) i == m_curr)
+		return;
+
+	// continue from the current snapshot if it precedes i in the same chunk,
+	// otherwise start anew at the beginning of the chunk
+	const size_t chunk = i / m_chunkSize;
+	size_t next;
+	if (m_curr >= 0 && (size_t) m_curr < i && (size_t) m_curr / m_chunkSize == chunk)
+		next = m_curr + 1;
+	else
+	{
+		next = chunk * m_chunkSize;
+		UG_COND_THROW(fseek(m_file, (long) m_vChunkOffset[chunk], SEEK_SET) != 0,
+			"Seek in compressed series file '" << m_fileName << "' failed.");
+		m_vBits.assign(m_nValues, 0);
+		m_vQ.assign(m_nValues, 0);
+		m_vPrevQ.assign(m_nValues, 0);
+	}
+
+	m_curr = -1;
+	for (; next <= i; ++next)
+	{
+		if (m_tol > 0.0)
+		{
+			for (size_t j = 0; j < m_nValues;)
+			{
+				const uint64_t t = read_varint();
+				size_t run = 1;
+				int64_t d = 0;
+				if (t & 1)
+					run = (size_t) (t >> 1);
+				else
+				{
+					const uint64_t zz = t >> 1;
+					d = (int64_t) (zz >> 1) ^ -(int64_t) (zz & 1);
+				}
+				UG_COND_THROW(!run || j + run > m_nValues,
+					"Compressed series file '" << m_fileName << "' is corrupt.");
+
+				for (size_t k = 0; k < run; ++k, ++j)
+				{
+					const int64_t q = 2*m_vQ[j] - m_vPrevQ[j] + d;
+					m_vPrevQ[j] = m_vQ[j];
+					m_vQ[j] = q;
+				}
+			}
+		}
+		else
+		{
+			for (size_t j = 0; j < m_nValues;)
+			{
+				const int h = fgetc(m_file);
+				UG_COND_THROW(h == EOF, "Compressed series file '" << m_fileName << "' is corrupt.");
+				const unsigned lz = (unsigned) h >> 4;
+				const unsigned tz = (unsigned) h & 0x0f;
+				UG_COND_THROW(lz + tz > 8, "Compressed series file '" << m_fileName << "' is corrupt.");
+
+				// run of unchanged values
+				if (lz == 8)
+				{
+					const size_t run = (size_t) read_varint() + 1;
+					UG_COND_THROW(j + run > m_nValues,
+						"Compressed series file '" << m_fileName << "' is corrupt.");
+					j += run;
+					continue;
+				}
+
+				uint64_t x = 0;
+				for (unsigned b = tz; b < 8 - lz; ++b)
+				{
+					const int c = fgetc(m_file);
+					UG_COND_THROW(c == EOF, "Compressed series file '" << m_fileName << "' is corrupt.");
+					x |= (uint64_t) c << (8*b);
+				}
+				m_vBits[j] ^= x;
+				++j;
+			}
+		}
+	}
+	m_curr = (long) i;
+
+	if (m_tol > 0.0)
+	{
+		const number step = 2.0 * m_tol;
+		for (size_t j = 0; j < m_nValues; ++j)
+			m_vVal[j] = (number) m_vQ[j] * step;
+	}
+	else
+	{
+		for (size_t j = 0; j < m_nValues; ++j)
+			m_vVal[j] = double_of(m_vBits[j]);
+	}
+}
+
+
+std::vector<number> CompressedSeriesReader::snapshot(size_t i)
+{
+	decode(i);
+	return m_vVal;
+}
+
+
+number CompressedSeriesReader::value(size_t i, size_t j)
+{
+	UG_COND_THROW(j >= m_nValues, "Value " << j << " out of range.");
+	decode(i);
+	return m_vVal[j];
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__COMPRESSED_SERIES_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__COMPRESSED_SERIES_H
+
+#include <cstddef>                       // for size_t
+#include <cstdio>                        // for FILE
+#include <stdint.h>                      // for int64_t, uint64_t
+#include <string>                        // for string
+#include <vector>                        // for vector
+
+#include "common/types.h"                // for number
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Writer for compressed time series of snapshots
+ *
+ * A series consists of snapshots of a fixed number of values (e.g. the values of
+ * a function in the vertices of a profile, or all values of a measurement),
+ * optionally associated to static points whose coordinates are stored only once.
+ *
+ * Each snapshot is delta-encoded with respect to the previous one:
+ * - lossless (tolerance 0): the bit patterns of consecutive values are xor-ed
+ *   and only the non-zero bytes of the result are stored (behind one byte
+ *   holding the numbers of leading and trailing zero bytes),
+ * - error-bounded lossy (tolerance > 0): values are quantized to multiples of
+ *   2*tolerance (so that the absolute error is at most the tolerance);
+ *   the quanta are predicted by linear extrapolation from the previous two
+ *   snapshots and the prediction errors are stored as zig-zag varints.
+ * Runs of unchanged values (or of exact predictions) are stored as run lengths,
+ * other slowly changing values need one or two bytes instead of eight.
+ *
+ * Snapshots are grouped into chunks (of chunkSize snapshots each), the first
+ * snapshot of a chunk being encoded against zero, so that any snapshot can
+ * be decoded by decoding at most one chunk (see CompressedSeriesReader).
+ *
+ * File layout (native byte order):
+ *   - header: magic "NCTSC001", coordinate dimension (uint32),
+ *     number of points (uint64), values per snapshot (uint64),
+ *     tolerance (double), chunk size (uint32), number of column names (uint32),
+ *     for each name: its length (uint32) and its characters,
+ *     coordinates of all points (double),
+ *   - encoded snapshots,
+ *   - index: for each chunk its byte offset (uint64), for each snapshot its time (double),
+ *   - footer: index offset (uint64), number of snapshots (uint64), magic "NCTSCEND".
+ *
+ * The index is written by close() (or on destruction); files that have not been
+ * closed cannot be read.
+ */
+class CompressedSeriesWriter
+{
+	public:
+		/**
+		 * @brief constructor (creates the file and writes the header)
+		 *
+		 * @param fileName   output file name
+		 * @param vCoord     coordinates of all points (coordDim entries per point; may be empty)
+		 * @param coordDim   number of coordinates per point
+		 * @param nValues    number of values per snapshot
+		 * @param vColName   names of the values (informative only; may be empty)
+		 * @param tolerance  absolute error bound (0 for lossless compression)
+		 * @param chunkSize  number of snapshots per chunk
+		 */
+		CompressedSeriesWriter
+		(
+			const std::string& fileName,
+			const std::vector<number>& vCoord,
+			size_t coordDim,
+			size_t nValues,
+			const std::vector<std::string>& vColName,
+			number tolerance = 0.0,
+			size_t chunkSize = 64
+		);
+
+		/// destructor (closes the file)
+		~CompressedSeriesWriter();
+
+		/// append a snapshot
+		void write(number time, const number* vals);
+
+		/// append a snapshot
+		void write(number time, const std::vector<number>& vals);
+
+		/// write the index and close the file
+		void close();
+
+		/// number of snapshots written
+		size_t num_snapshots() const {return m_vTime.size();}
+
+		/// number of bytes written so far
+		uint64_t bytes_written() const {return m_offset;}
+
+		/// file name
+		const std::string& file_name() const {return m_fileName;}
+
+	private:
+		// not copyable
+		CompressedSeriesWriter(const CompressedSeriesWriter&);
+		CompressedSeriesWriter& operator=(const CompressedSeriesWriter&);
+
+		void write_bytes(const void* p, size_t nBytes);
+
+	private:
+		std::string m_fileName;
+		FILE* m_file;
+		uint64_t m_offset;
+
+		size_t m_nValues;
+		number m_tol;
+		size_t m_chunkSize;
+
+		std::vector<uint64_t> m_vChunkOffset;
+		std::vector<double> m_vTime;
+
+		/// previous snapshot (bit patterns) or previous two snapshots (quanta)
+		std::vector<uint64_t> m_vPrevBits;
+		std::vector<int64_t> m_vPrevQ;
+		std::vector<int64_t> m_vPrevPrevQ;
+
+		std::vector<int64_t> m_vRes;
+		std::vector<uint64_t> m_vXor;
+		std::vector<unsigned char> m_vBuf;
+};
+
+
+/**
+ * @brief Reader for files written by CompressedSeriesWriter
+ *
+ * Header and index are read on construction; snapshots are decoded on demand.
+ * Consecutive snapshots of the same chunk are decoded incrementally,
+ * so reading a series in order costs one decoding step per snapshot.
+ */
+class CompressedSeriesReader
+{
+	public:
+		/// constructor (reads header and index)
+		CompressedSeriesReader(const std::string& fileName);
+
+		/// destructor
+		~CompressedSeriesReader();
+
+		/// number of points
+		size_t num_points() const {return m_nPoints;}
+
+		/// number of coordinates per point
+		size_t coord_dim() const {return m_coordDim;}
+
+		/// coordinate d of point i
+		number coordinate(size_t i, size_t d) const;
+
+		/// number of values per snapshot
+		size_t num_values() const {return m_nValues;}
+
+		/// number of column names
+		size_t num_columns() const {return m_vColName.size();}
+
+		/// name of column i
+		std::string column_name(size_t i) const;
+
+		/// absolute error bound of the values (0 if lossless)
+		number tolerance() const {return m_tol;}
+
+		/// number of snapshots
+		size_t num_snapshots() const {return m_vTime.size();}
+
+		/// time of snapshot i
+		number time(size_t i) const;
+
+		/// index of the last snapshot at or before time t (0 if t is before the first snapshot)
+		size_t snapshot_index(number t) const;
+
+		/// values of snapshot i
+		std::vector<number> snapshot(size_t i);
+
+		/// values of the last snapshot at or before time t
+		std::vector<number> snapshot_at_time(number t) {return snapshot(snapshot_index(t));}
+
+		/// value j of snapshot i
+		number value(size_t i, size_t j);
+
+	private:
+		// not copyable
+		CompressedSeriesReader(const CompressedSeriesReader&);
+		CompressedSeriesReader& operator=(const CompressedSeriesReader&);
+
+		void read_bytes(void* p, size_t nBytes);
+		uint64_t read_varint();
+		void decode(size_t i);
+
+	private:
+		std::string m_fileName;
+		FILE* m_file;
+
+		size_t m_coordDim;
+		size_t m_nPoints;
+		size_t m_nValues;
+		number m_tol;
+		size_t m_chunkSize;
+		std::vector<std::string> m_vColName;
+		std::vector<number> m_vCoord;
+
+		std::vector<uint64_t> m_vChunkOffset;
+		std::vector<double> m_vTime;
+		uint64_t m_indexOffset;
+
+		/// currently decoded snapshot (-1 if none) and its state
+		long m_curr;
+		std::vector<uint64_t> m_vBits;
+		std::vector<int64_t> m_vQ;
+		std::vector<int64_t> m_vPrevQ;
+		std::vector<number> m_vVal;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__COMPRESSED_SERIES_H
@@ -0,0 +1,481 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "expression.h"
+
+#include "common/error.h"  // for UG_COND_THROW
+
+#include <algorithm>  // for std::min, std::max
+#include <cctype>
+#include <cmath>
+#include <cstdlib>  // for strtod
+#include <sstream>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+static inline number apply_unary(Expression::Op op, number a)
+{
+	switch (op)
+	{
+		case Expression::OP_NEG: return -a;
+		case Expression::OP_SIN: return std::sin(a);
+		case Expression::OP_COS: return std::cos(a);
+		case Expression::OP_TAN: return std::tan(a);
+		case Expression::OP_EXP: return std::exp(a);
+		case Expression::OP_LOG: return std::log(a);
+		case Expression::OP_SQRT: return std::sqrt(a);
+		case Expression::OP_ABS: return std::fabs(a);
+		case Expression::OP_TANH: return std::tanh(a);
+		case Expression::OP_FLOOR: return std::floor(a);
+		case Expression::OP_CEIL: return std::ceil(a);
+		default: return 0.0;
+	}
+}
+
+
+static inline number apply_binary(Expression::Op op, number a, number b)
+{
+	switch (op)
+	{
+		case Expression::OP_ADD: return a + b;
+		case Expression::OP_SUB: return a - b;
+		case Expression::OP_MUL: return a * b;
+		case Expression::OP_DIV: return a / b;
+		case Expression::OP_POW: return std::pow(a, b);
+		case Expression::OP_MIN: return std::min(a, b);
+		case Expression::OP_MAX: return std::max(a, b);
+		case Expression::OP_LT: return a < b ? 1.0 : 0.0;
+		case Expression::OP_GT: return a > b ? 1.0 : 0.0;
+		case Expression::OP_LE: return a <= b ? 1.0 : 0.0;
+		case Expression::OP_GE: return a >= b ? 1.0 : 0.0;
+		default: return 0.0;
+	}
+}
+
+
+static inline bool is_binary(Expression::Op op)
+{
+	return op >= Expression::OP_ADD;
+}
+
+
+
+/// recursive descent parser emitting bytecode (with constant folding)
+class Expression::Parser
+{
+	public:
+		Parser(const std::string& expr, std::vector<Instr>& vCode)
+		: m_s(expr), m_pos(0), m_vCode(vCode), m_usedVars(0), m_depth(0), m_maxDepth(0)
+		{}
+
+		bool parse(std::string& err)
+		{
+			m_vCode.clear();
+			if (!comparison())
+			{
+				err = m_err;
+				return false;
+			}
+			skip_ws();
+			if (m_pos != m_s.size())
+			{
+				err = error_at("unexpected character");
+				return false;
+			}
+			if (m_maxDepth > MAX_STACK)
+			{
+				err = "Expression is too deeply nested.";
+				return false;
+			}
+			return true;
+		}
+
+		unsigned used_vars() const {return m_usedVars;}
+
+	private:
+		void skip_ws()
+		{
+			while (m_pos < m_s.size() && std::isspace((unsigned char) m_s[m_pos]))
+				++m_pos;
+		}
+
+		bool accept(char c)
+		{
+			skip_ws();
+			if (m_pos < m_s.size() && m_s[m_pos] == c)
+			{
+				++m_pos;
+				return true;
+			}
+			return false;
+		}
+
+		std::string error_at(const char* msg)
+		{
+			std::ostringstream oss;
+			oss << "Invalid expression '" << m_s << "': " << msg << " at position " << m_pos << ".";
+			return oss.str();
+		}
+
+		bool fail(const char* msg)
+		{
+			if (m_err.empty())
+				m_err = error_at(msg);
+			return false;
+		}
+
+		void push(const Instr& instr)
+		{
+			m_vCode.push_back(instr);
+			m_maxDepth = std::max(m_maxDepth, ++m_depth);
+		}
+
+		void emit_const(number val)
+		{
+			Instr instr = {OP_CONST, 0, val};
+			push(instr);
+		}
+
+		void emit_var(size_t var)
+		{
+			Instr instr = {OP_VAR, var, 0.0};
+			push(instr);
+			m_usedVars |= 1u << var;
+		}
+
+		void emit_op(Op op)
+		{
+			const size_t n = m_vCode.size();
+			if (is_binary(op))
+			{
+				// fold if both operands are constants (they are then the last two instructions)
+				--m_depth;
+				if (n >= 2 && m_vCode[n-2].op == OP_CONST && m_vCode[n-1].op == OP_CONST)
+				{
+					m_vCode[n-2].value = apply_binary(op, m_vCode[n-2].value, m_vCode[n-1].value);
+					m_vCode.pop_back();
+					return;
+				}
+			}
+			else if (n >= 1 && m_vCode[n-1].op == OP_CONST)
+			{
+				m_vCode[n-1].value = apply_unary(op, m_vCode[n-1].value);
+				return;
+			}
+
+			Instr instr = {op, 0, 0.0};
+			m_vCode.push_back(instr);
+		}
+
+		bool comparison()
+		{
+			if (!sum()) return false;
+			skip_ws();
+			if (m_pos < m_s.size() && (m_s[m_pos] == '<' || m_s[m_pos] == '>'))
+			{
+				const bool bLess = m_s[m_pos] == '<';
+				++m_pos;
+				const bool bEq = m_pos < m_s.size() && m_s[m_pos] == '=';
+				if (bEq) ++m_pos;
+				if (!sum()) return false;
+				emit_op(bLess ? (bEq ? OP_LE : OP_LT) : (bEq ? OP_GE : OP_GT));
+			}
+			return true;
+		}
+
+		bool sum()
+		{
+			if (!product()) return false;
+			while (true)
+			{
+				if (accept('+')) {if (!product()) return false; emit_op(OP_ADD);}
+				else if (accept('-')) {if (!product()) return false; emit_op(OP_SUB);}
+				else return true;
+			}
+		}
+
+		bool product()
+		{
+			if (!unary()) return false;
+			while (true)
+			{
+				if (accept('*')) {if (!unary()) return false; emit_op(OP_MUL);}
+				else if (accept('/')) {if (!unary()) return false; emit_op(OP_DIV);}
+				else return true;
+			}
+		}
+
+		bool unary()
+		{
+			if (accept('-'))
+			{
+				if (!unary()) return false;
+				emit_op(OP_NEG);
+				return true;
+			}
+			if (accept('+'))
+				return unary();
+			return power();
+		}
+
+		bool power()
+		{
+			if (!primary()) return false;
+			if (accept('^'))
+			{
+				// right-associative, binds stronger than a unary minus on its left
+				if (!unary()) return false;
+				emit_op(OP_POW);
+			}
+			return true;
+		}
+
+		bool primary()
+		{
+			skip_ws();
+			if (m_pos >= m_s.size())
+				return fail("unexpected end");
+
+			const char c = m_s[m_pos];
+
+			// parenthesized expression
+			if (c == '(')
+			{
+				++m_pos;
+				if (!comparison()) return false;
+				if (!accept(')')) return fail("')' expected");
+				return true;
+			}
+
+			// number
+			if (std::isdigit((unsigned char) c) || c == '.')
+			{
+				const char* begin = m_s.c_str() + m_pos;
+				char* end;
+				const number val = strtod(begin, &end);
+				if (end == begin) return fail("invalid number");
+				m_pos += end - begin;
+				emit_const(val);
+				return true;
+			}
+
+			// identifier
+			if (std::isalpha((unsigned char) c) || c == '_')
+			{
+				const size_t begin = m_pos;
+				while (m_pos < m_s.size() && (std::isalnum((unsigned char) m_s[m_pos]) || m_s[m_pos] == '_'))
+					++m_pos;
+				const std::string id = m_s.substr(begin, m_pos - begin);
+
+				if (id == "x") {emit_var(_X_); return true;}
+				if (id == "y") {emit_var(_Y_); return true;}
+				if (id == "z") {emit_var(_Z_); return true;}
+				if (id == "t") {emit_var(_T_); return true;}
+				if (id == "pi") {emit_const(3.14159265358979323846); return true;}
+				if (id == "e") {emit_const(2.71828182845904523536); return true;}
+
+				static const struct {const char* name; Op op;} fcts[] =
+				{
+					{"sin", OP_SIN}, {"cos", OP_COS}, {"tan", OP_TAN}, {"exp", OP_EXP},
+					{"log", OP_LOG}, {"sqrt", OP_SQRT}, {"abs", OP_ABS}, {"tanh", OP_TANH},
+					{"floor", OP_FLOOR}, {"ceil", OP_CEIL},
+					{"pow", OP_POW}, {"min", OP_MIN}, {"max", OP_MAX}
+				};
+				const size_t nFct = sizeof(fcts) / sizeof(fcts[0]);
+				for (size_t f = 0; f < nFct; ++f)
+				{
+					if (id != fcts[f].name)
+						continue;
+
+					if (!accept('(')) return fail("'(' expected");
+					if (!comparison()) return false;
+					if (is_binary(fcts[f].op))
+					{
+						if (!accept(',')) return fail("',' expected");
+						if (!comparison()) return false;
+					}
+					if (!accept(')')) return fail("')' expected");
+					emit_op(fcts[f].op);
+					return true;
+				}
+
+				m_pos = begin;
+				return fail("unknown identifier");
+			}
+
+			return fail("unexpected character");
+		}
+
+	private:
+		const std::string& m_s;
+		size_t m_pos;
+		std::vector<Instr>& m_vCode;
+		unsigned m_usedVars;
+		size_t m_depth;
+		size_t m_maxDepth;
+		std::string m_err;
+};
+
+
+
+Expression::Expression(const std::string& expr)
+: m_expr(expr), m_usedVars(0)
+{
+	Parser parser(m_expr, m_vCode);
+	std::string err;
+	UG_COND_THROW(!parser.parse(err), err);
+	m_usedVars = parser.used_vars();
+}
+
+
+bool Expression::is_valid(const std::string& expr, std::string* err)
+{
+	std::vector<Instr> vCode;
+	Parser parser(expr, vCode);
+	std::string msg;
+	const bool bValid = parser.parse(msg);
+	if (err)
+		*err = msg;
+	return bValid;
+}
+
+
+number Expression::eval(const number* vars) const
+{
+	number stack[MAX_STACK];
+	size_t top = 0;
+
+	const size_t nInstr = m_vCode.size();
+	for (size_t i = 0; i < nInstr; ++i)
+	{
+		const Instr& instr = m_vCode[i];
+		switch (instr.op)
+		{
+			case OP_CONST: stack[top++] = instr.value; break;
+			case OP_VAR: stack[top++] = vars[instr.var]; break;
+			default:
+				if (is_binary(instr.op))
+				{
+					--top;
+					stack[top-1] = apply_binary(instr.op, stack[top-1], stack[top]);
+				}
+				else
+					stack[top-1] = apply_unary(instr.op, stack[top-1]);
+		}
+	}
+
+	return stack[0];
+}
+
+
+void Expression::eval_batch
+(
+	const number* coords,
+	size_t stride,
+	size_t dim,
+	number t,
+	size_t n,
+	number* out
+) const
+{
+	// evaluate instruction-wise on blocks of points
+	const size_t B = 32;
+	number stack[MAX_STACK][B];
+
+	const size_t nInstr = m_vCode.size();
+	for (size_t begin = 0; begin < n; begin += B)
+	{
+		const size_t nb = std::min(B, n - begin);
+		const number* c = coords + begin*stride;
+
+		size_t top = 0;
+		for (size_t i = 0; i < nInstr; ++i)
+		{
+			const Instr& instr = m_vCode[i];
+			if (instr.op == OP_CONST)
+			{
+				number* b = stack[top++];
+				for (size_t k = 0; k < nb; ++k) b[k] = instr.value;
+				continue;
+			}
+			if (instr.op == OP_VAR)
+			{
+				number* b = stack[top++];
+				if (instr.var == _T_)
+					for (size_t k = 0; k < nb; ++k) b[k] = t;
+				else if (instr.var < dim)
+					for (size_t k = 0; k < nb; ++k) b[k] = c[k*stride + instr.var];
+				else
+					for (size_t k = 0; k < nb; ++k) b[k] = 0.0;
+				continue;
+			}
+			if (!is_binary(instr.op))
+			{
+				number* a = stack[top-1];
+				if (instr.op == OP_NEG)
+					for (size_t k = 0; k < nb; ++k) a[k] = -a[k];
+				else
+					for (size_t k = 0; k < nb; ++k) a[k] = apply_unary(instr.op, a[k]);
+				continue;
+			}
+
+			--top;
+			number* a = stack[top-1];
+			const number* b = stack[top];
+			switch (instr.op)
+			{
+				case OP_ADD: for (size_t k = 0; k < nb; ++k) a[k] += b[k]; break;
+				case OP_SUB: for (size_t k = 0; k < nb; ++k) a[k] -= b[k]; break;
+				case OP_MUL: for (size_t k = 0; k < nb; ++k) a[k] *= b[k]; break;
+				case OP_DIV: for (size_t k = 0; k < nb; ++k) a[k] /= b[k]; break;
+				default: for (size_t k = 0; k < nb; ++k) a[k] = apply_binary(instr.op, a[k], b[k]);
+			}
+		}
+
+		for (size_t k = 0; k < nb; ++k)
+			out[begin + k] = stack[0][k];
+	}
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__EXPRESSION_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__EXPRESSION_H
+
+#include "common/types.h"  // for number
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/// Mathematical expression in x, y, z and t compiled to stack bytecode
+/**
+ * This class parses a closed-form expression of the coordinates x, y, z
+ * and the time t once and evaluates it without any interpreter overhead
+ * (such as that of a Lua callback).
+ *
+ * Supported are
+ * - numbers (including exponential notation) and the constants pi and e,
+ * - the binary operators +, -, *, /, ^ (right-associative) and the unary -, +,
+ * - the comparisons <, >, <=, >= (yielding 1 or 0, e.g. for pulses),
+ * - the functions sin, cos, tan, exp, log, sqrt, abs, tanh, floor, ceil
+ *   and the binary functions pow, min, max.
+ *
+ * Sub-expressions not depending on any variable are folded at compile time.
+ * Batches of points are evaluated instruction by instruction over blocks of
+ * points, so that the inner loops are free of dispatch and can be vectorized.
+ */
+class Expression
+{
+	public:
+		/// variables in the order of the variable array
+		enum {_X_ = 0, _Y_, _Z_, _T_, NUM_VARS};
+
+	public:
+		/// constructor (throws if the expression is invalid)
+		Expression(const std::string& expr);
+
+		/// check whether a string is a valid expression (error message in err)
+		static bool is_valid(const std::string& expr, std::string* err = NULL);
+
+		/// the expression string
+		const std::string& expression() const {return m_expr;}
+
+		/// whether the expression depends on no variable at all
+		bool is_constant() const {return m_usedVars == 0;}
+
+		/// whether the expression depends on the given variable
+		bool depends_on(size_t var) const {return (m_usedVars >> var) & 1;}
+
+		/// number of bytecode instructions
+		size_t num_instructions() const {return m_vCode.size();}
+
+		/// evaluate for the variable values vars[NUM_VARS]
+		number eval(const number* vars) const;
+
+		/**
+		 * @brief Evaluate for n points
+		 * @param coords   coordinates of the points (point i at coords + i*stride)
+		 * @param stride   distance of consecutive points in coords
+		 * @param dim      number of coordinates per point (the others are zero)
+		 * @param t        time
+		 * @param n        number of points
+		 * @param out      values (n entries)
+		 */
+		void eval_batch
+		(
+			const number* coords,
+			size_t stride,
+			size_t dim,
+			number t,
+			size_t n,
+			number* out
+		) const;
+
+	public:
+		/// bytecode operations
+		enum Op
+		{
+			OP_CONST, OP_VAR,
+			OP_NEG, OP_SIN, OP_COS, OP_TAN, OP_EXP, OP_LOG, OP_SQRT, OP_ABS, OP_TANH,
+			OP_FLOOR, OP_CEIL,
+			OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW, OP_MIN, OP_MAX,
+			OP_LT, OP_GT, OP_LE, OP_GE
+		};
+
+		/// bytecode instruction
+		struct Instr
+		{
+			Op op;
+			size_t var;     ///< variable index (OP_VAR)
+			number value;   ///< constant value (OP_CONST)
+		};
+
+		/// maximal stack depth of an expression
+		static const size_t MAX_STACK = 32;
+
+	private:
+		class Parser;
+
+	private:
+		std::string m_expr;
+		std::vector<Instr> m_vCode;
+		unsigned m_usedVars;
+};
+
+/// @}
+
+} // namspace neuro_collection
+} // namespace ug
+
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__EXPRESSION_H
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__EXPRESSION_USER_DATA_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__EXPRESSION_USER_DATA_H
+
+#include "lib_disc/spatial_disc/user_data/std_glob_pos_data.h"  // for StdGlobPosData
+#include "expression.h"
+
+#include <string>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/// User number given by an expression in x, y, z and t
+/**
+ * This user data evaluates a compiled Expression natively, i.e., without
+ * entering the Lua VM. It can therefore replace Lua callbacks of closed-form
+ * functions of the coordinates and time. Wherever this plugin accepts the name
+ * of a Lua callback (such as in set_density_function() or set_flux_function()),
+ * an expression string is accepted as well.
+ *
+ * Batches of points are evaluated by Expression::eval_batch().
+ */
+template <int dim>
+class ExpressionUserData
+: public StdGlobPosData<ExpressionUserData<dim>, number, dim>
+{
+	public:
+		/// constructor (throws if the expression is invalid)
+		ExpressionUserData(const char* expr)
+		: m_expr(expr) {}
+
+		/// check whether a string is a valid expression
+		static bool is_valid(const char* expr)
+		{
+			return Expression::is_valid(expr);
+		}
+
+		/// the expression string
+		const std::string& expression() const {return m_expr.expression();}
+
+		/// evaluate at one point (used by StdGlobPosData)
+		inline void evaluate(number& value, const MathVector<dim>& x, number time, int si) const
+		{
+			number vars[Expression::NUM_VARS] = {0.0, 0.0, 0.0, time};
+			for (int d = 0; d < dim && d < 3; ++d)
+				vars[d] = x[d];
+			value = m_expr.eval(vars);
+		}
+
+		/// evaluate at a batch of points
+		virtual void operator()
+		(
+			number vValue[],
+			const MathVector<dim> vGlobIP[],
+			number time,
+			int si,
+			const size_t nip
+		) const
+		{
+			if (!nip) return;
+			m_expr.eval_batch(&vGlobIP[0][0], dim, dim, time, nip, vValue);
+		}
+
+		/// evaluate at one point
+		virtual void operator()
+		(
+			number& value,
+			const MathVector<dim>& globIP,
+			number time,
+			int si
+		) const
+		{
+			evaluate(value, globIP, time, si);
+		}
+
+		/// whether the expression depends on no variable at all
+		virtual bool constant() const {return m_expr.is_constant();}
+
+	private:
+		Expression m_expr;
+};
+
+/// @}
+
+} // namspace neuro_collection
+} // namespace ug
+
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__EXPRESSION_USER_DATA_H
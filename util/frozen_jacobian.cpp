@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "frozen_jacobian.h"
+
+#include <cmath>  // for fabs
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+FrozenJacobianStore::FrozenJacobianStore()
+: m_relTol(0.0), m_nReused(0), m_nRefreshed(0)
+{}
+
+
+void FrozenJacobianStore::register_grid(Grid& grid)
+{
+	m_spGridAdaptionCallbackID = grid.message_hub()->register_class_callback(this,
+		&FrozenJacobianStore::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid.message_hub()->register_class_callback(this,
+		&FrozenJacobianStore::grid_distribution_callback);
+}
+
+
+bool FrozenJacobianStore::inputs_within_tolerance
+(
+	const std::vector<number>& vIn,
+	const std::vector<number>& vRef,
+	number relTol
+)
+{
+	const size_t nIn = vIn.size();
+	if (vRef.size() != nIn)
+		return false;
+
+	for (size_t i = 0; i < nIn; ++i)
+		if (!(fabs(vIn[i] - vRef[i]) <= relTol * fabs(vRef[i])))
+			return false;
+
+	return true;
+}
+
+
+bool FrozenJacobianStore::lookup(GridObject* e, const std::vector<number>& vIn, std::vector<number>& vEntries)
+{
+	bool found = false;
+
+	// the store may be shared by several threads
+#ifdef _OPENMP
+	#pragma omp critical (nc_frozen_jacobian)
+#endif
+	{
+		std::map<GridObject*, Entry>::const_iterator it = m_mEntries.find(e);
+		if (it != m_mEntries.end() && inputs_within_tolerance(vIn, it->second.vInRef, m_relTol))
+		{
+			vEntries = it->second.vEntries;
+			found = true;
+			++m_nReused;
+		}
+		else
+			++m_nRefreshed;
+	}
+
+	return found;
+}
+
+
+void FrozenJacobianStore::store(GridObject* e, const std::vector<number>& vIn, const std::vector<number>& vEntries)
+{
+#ifdef _OPENMP
+	#pragma omp critical (nc_frozen_jacobian)
+#endif
+	{
+		Entry& entry = m_mEntries[e];
+		entry.vInRef = vIn;
+		entry.vEntries = vEntries;
+	}
+}
+
+
+void FrozenJacobianStore::clear()
+{
+	m_mEntries.clear();
+	m_nReused = 0;
+	m_nRefreshed = 0;
+}
+
+
+size_t FrozenJacobianStore::memory_bytes() const
+{
+	size_t bytes = 0;
+	std::map<GridObject*, Entry>::const_iterator it = m_mEntries.begin();
+	for (; it != m_mEntries.end(); ++it)
+	{
+		bytes += sizeof(*it) + 4 * sizeof(void*);
+		bytes += (it->second.vInRef.capacity() + it->second.vEntries.capacity()) * sizeof(number);
+	}
+	return bytes;
+}
+
+
+void FrozenJacobianStore::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		clear();
+}
+
+
+void FrozenJacobianStore::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		clear();
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
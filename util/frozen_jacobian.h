@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__FROZEN_JACOBIAN_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__FROZEN_JACOBIAN_H
+
+#include "common/types.h"  // for number
+#include "lib_grid/grid/grid.h"  // for Grid
+#include "lib_grid/grid/grid_base_objects.h"  // for GridObject
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/// Storage of local Jacobian contributions for a modified (frozen-Jacobian) Newton method
+/**
+ * Membrane flux Jacobians often change only slowly over a Newton solve and even
+ * over several time steps. A disc can therefore keep the local Jacobian entries
+ * it assembled for an element together with the inputs they were computed from
+ * and add the stored entries again as long as none of the inputs has changed by
+ * more than a relative tolerance. The defect is not affected by this.
+ *
+ * Entries are identified by their element; the disc decides which inputs to
+ * compare and in which order entries are stored. The store is cleared whenever
+ * the grid it is registered with is adapted or redistributed.
+ */
+class FrozenJacobianStore
+{
+	public:
+		/// constructor
+		FrozenJacobianStore();
+
+		/// set relative input change up to which entries are reused (<= 0 disables reuse)
+		void set_tolerance(number relTol) {m_relTol = relTol; clear();}
+
+		/// relative input change up to which entries are reused
+		number tolerance() const {return m_relTol;}
+
+		/// whether entries are reused at all
+		bool enabled() const {return m_relTol > 0.0;}
+
+		/// clear the store whenever the given grid is adapted or redistributed
+		void register_grid(Grid& grid);
+
+		/**
+		 * @brief get stored entries for an element
+		 * @param e         element
+		 * @param vIn       current inputs
+		 * @param vEntries  stored entries (only written on success)
+		 * @return whether entries are stored for the element and the inputs are within tolerance
+		 */
+		bool lookup(GridObject* e, const std::vector<number>& vIn, std::vector<number>& vEntries);
+
+		/// store entries for an element (replacing previous ones)
+		void store(GridObject* e, const std::vector<number>& vIn, const std::vector<number>& vEntries);
+
+		/// forget all stored entries
+		void clear();
+
+		/// number of elements with stored entries
+		size_t size() const {return m_mEntries.size();}
+
+		/// number of lookups that could (not) be answered since the last clear
+		size_t num_reused() const {return m_nReused;}
+		size_t num_refreshed() const {return m_nRefreshed;}
+
+		/// estimated memory held by the store
+		size_t memory_bytes() const;
+
+		/// whether each input differs from its reference by at most relTol times the reference
+		static bool inputs_within_tolerance
+		(
+			const std::vector<number>& vIn,
+			const std::vector<number>& vRef,
+			number relTol
+		);
+
+	private:
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	private:
+		struct Entry
+		{
+			std::vector<number> vInRef;
+			std::vector<number> vEntries;
+		};
+
+		number m_relTol;
+		std::map<GridObject*, Entry> m_mEntries;
+
+		size_t m_nReused;
+		size_t m_nRefreshed;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+};
+
+/// @}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__FROZEN_JACOBIAN_H
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__GATING_INTEGRATOR_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__GATING_INTEGRATOR_H
+
+#include "common/types.h"  // for number
+#include "nc_config.h"  // for NC_WITH_FLOAT_GATING_STORAGE
+
+#include <cmath>
+#include <cstddef>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/**
+ * @brief Time integration schemes for gating variables
+ *
+ * Gating variables u of (Hodgkin-Huxley-like) channels are governed by
+ *     u' = \frac{u_\infty(V_m) - u}{\tau_u(V_m)}.
+ * With V_m treated explicitly during a time step of size dt, the step reads
+ *     u(t+dt) = u_\infty + f * (u(t) - u_\infty)
+ * with a decay factor f depending on the scheme:
+ * - implicit Euler:  f = \tau / (\tau + dt),
+ * - Rush-Larsen (exponential Euler):  f = \exp(-dt/\tau).
+ * The Rush-Larsen scheme is exact for constant V_m and therefore stable for any dt
+ * (also no sub-stepping is required to achieve accuracy for fast gates).
+ * Channel models only need to provide u_\infty and \tau.
+ */
+enum GatingIntegrationScheme
+{
+	GIS_IMPLICIT_EULER = 0,
+	GIS_RUSH_LARSEN
+};
+
+
+/**
+ * @brief Value type in which gating states are stored between time steps
+ *
+ * Gating variables lie in [0,1] and are advanced by the first-order schemes
+ * below, so single precision is sufficient for their storage (configure with
+ * NCFloatGatingStorage=ON to halve the memory and bandwidth of the stored states).
+ * All arithmetic is carried out in number; stores only gather from and scatter
+ * to this type.
+ */
+#ifdef NC_WITH_FLOAT_GATING_STORAGE
+typedef float gating_storage_type;
+#else
+typedef number gating_storage_type;
+#endif
+
+
+/// decay factor f of the deviation from the limit value for one time step
+inline number gating_decay_factor(number tau, number dt, GatingIntegrationScheme scheme)
+{
+	if (scheme == GIS_RUSH_LARSEN)
+		return std::exp(-dt/tau);
+	return tau / (tau + dt);
+}
+
+
+/// derivative of the decay factor w.r.t. the time constant
+inline number gating_decay_factor_deriv_tau(number tau, number dt, GatingIntegrationScheme scheme)
+{
+	if (scheme == GIS_RUSH_LARSEN)
+		return std::exp(-dt/tau) * dt / (tau*tau);
+	return dt / ((tau + dt) * (tau + dt));
+}
+
+
+/// one time step for a single gating variable
+inline number gating_step(number u, number uInf, number tau, number dt, GatingIntegrationScheme scheme)
+{
+	return uInf + gating_decay_factor(tau, dt, scheme) * (u - uInf);
+}
+
+
+/**
+ * @brief One time step for n gating variables
+ * The loops are free of branches, so they can be vectorized by the compiler;
+ * they are threaded if OpenMP is available.
+ *
+ * @param u       gating values (updated)
+ * @param uInf    limit values
+ * @param tau     time constants
+ * @param n       number of gating variables
+ * @param dt      time step size (in units of tau)
+ * @param scheme  integration scheme
+ */
+inline void gating_step_batch
+(
+	number* u,
+	const number* uInf,
+	const number* tau,
+	size_t n,
+	number dt,
+	GatingIntegrationScheme scheme
+)
+{
+	const long nl = (long) n;
+	if (scheme == GIS_RUSH_LARSEN)
+	{
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(static)
+#endif
+		for (long k = 0; k < nl; ++k)
+			u[k] = uInf[k] + (u[k] - uInf[k]) * std::exp(-dt/tau[k]);
+	}
+	else
+	{
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(static)
+#endif
+		for (long k = 0; k < nl; ++k)
+			u[k] = (tau[k] * u[k] + dt * uInf[k]) / (tau[k] + dt);
+	}
+}
+
+/// @}
+
+} // namspace neuro_collection
+} // namespace ug
+
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__GATING_INTEGRATOR_H
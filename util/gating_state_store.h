@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__GATING_STATE_STORE_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__GATING_STATE_STORE_H
+
+#include "common/types.h"  // for number
+#include "lib_grid/grid/grid.h"  // for Grid
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
+
+#include <cstddef>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/// Contiguous storage for the gating states of a set of grid objects
+/**
+ * This class holds, for an ordered set of grid objects (the "slots"), one dense
+ * array per gating state (e.g. membrane potential and gating variables).
+ * Channels holding their gating states in grid attachments or maps can gather
+ * them here before a time step, run their gating update as a loop over the
+ * contiguous arrays (which can be threaded and vectorized) and scatter the
+ * results back.
+ *
+ * The slot assignment depends on the grid. If the store is registered with a
+ * grid (using register_grid_callbacks()), it is invalidated automatically after
+ * each adaption and redistribution of that grid and has to be rebuilt by its owner
+ * before the next use (cf. valid()).
+ */
+template <typename TElem>
+class GatingStateStore
+{
+	public:
+		/// constructor
+		GatingStateStore();
+
+		/// set number of states per slot (clears the store)
+		void set_num_states(size_t nStates);
+
+		/// number of states per slot
+		size_t num_states() const {return m_vvState.size();}
+
+		/// remove all slots
+		void clear();
+
+		/// append a slot for the given object (all states initialized to zero)
+		void add(TElem* e);
+
+		/// number of slots
+		size_t size() const {return m_vElem.size();}
+
+		/// object associated with a slot
+		TElem* elem(size_t slot) const {return m_vElem[slot];}
+
+		/// array of state values for all slots
+		number* state(size_t s) {return m_vvState[s].empty() ? NULL : &m_vvState[s][0];}
+
+		/// array of state values for all slots (const version)
+		const number* state(size_t s) const {return m_vvState[s].empty() ? NULL : &m_vvState[s][0];}
+
+		/// whether the slot assignment is up to date
+		bool valid() const {return m_bValid;}
+
+		/// mark slot assignment as up to date
+		void set_valid() {m_bValid = true;}
+
+		/// mark slot assignment as outdated
+		void invalidate() {m_bValid = false;}
+
+		/// memory held by the slots and states
+		size_t memory_bytes() const;
+
+		/// invalidate the store whenever the grid is adapted or redistributed
+		void register_grid_callbacks(Grid& grid);
+
+	private:
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	private:
+		std::vector<TElem*> m_vElem;
+		std::vector<std::vector<number> > m_vvState;
+		bool m_bValid;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+};
+
+/// @}
+
+} // namspace neuro_collection
+} // namespace ug
+
+#include "gating_state_store_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__GATING_STATE_STORE_H
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "gating_state_store.h"
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TElem>
+GatingStateStore<TElem>::GatingStateStore()
+: m_bValid(false)
+{}
+
+
+template <typename TElem>
+void GatingStateStore<TElem>::set_num_states(size_t nStates)
+{
+	m_vvState.resize(nStates);
+	clear();
+}
+
+
+template <typename TElem>
+void GatingStateStore<TElem>::clear()
+{
+	m_vElem.clear();
+	const size_t nStates = m_vvState.size();
+	for (size_t s = 0; s < nStates; ++s)
+		m_vvState[s].clear();
+	m_bValid = false;
+}
+
+
+template <typename TElem>
+void GatingStateStore<TElem>::add(TElem* e)
+{
+	m_vElem.push_back(e);
+	const size_t nStates = m_vvState.size();
+	for (size_t s = 0; s < nStates; ++s)
+		m_vvState[s].push_back(0.0);
+}
+
+
+template <typename TElem>
+size_t GatingStateStore<TElem>::memory_bytes() const
+{
+	size_t bytes = m_vElem.capacity() * sizeof(TElem*)
+		+ m_vvState.capacity() * sizeof(std::vector<number>);
+	const size_t nStates = m_vvState.size();
+	for (size_t s = 0; s < nStates; ++s)
+		bytes += m_vvState[s].capacity() * sizeof(number);
+	return bytes;
+}
+
+
+template <typename TElem>
+void GatingStateStore<TElem>::register_grid_callbacks(Grid& grid)
+{
+	m_spGridAdaptionCallbackID = grid.message_hub()->register_class_callback(this,
+		&GatingStateStore<TElem>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid.message_hub()->register_class_callback(this,
+		&GatingStateStore<TElem>::grid_distribution_callback);
+}
+
+
+template <typename TElem>
+void GatingStateStore<TElem>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		m_bValid = false;
+}
+
+
+template <typename TElem>
+void GatingStateStore<TElem>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		m_bValid = false;
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
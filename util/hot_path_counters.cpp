@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "hot_path_counters.h"
+
+#include "common/log.h"                  // for UG_LOG
+
+#ifdef NC_WITH_INSTRUMENTATION
+#include <algorithm>                     // for std::find, std::sort, std::max
+#include <iomanip>                       // for std::setw
+#include <map>                           // for map
+#include <sstream>                       // for ostringstream
+#include <utility>                       // for pair
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+#ifdef NC_WITH_INSTRUMENTATION
+
+namespace {
+
+size_t s_sampleInterval = 64;
+
+std::vector<HotPathCounter*>& registered_counters()
+{
+	static std::vector<HotPathCounter*> vCounter;
+	return vCounter;
+}
+
+struct ReportRow
+{
+	std::string category;
+	std::string name;
+	std::string subsets;
+	HotPathCounter::Totals t;
+
+	number estimated_seconds() const
+	{
+		if (!t.timedCalls)
+			return 0.0;
+		return t.seconds / t.timedCalls * t.calls;
+	}
+};
+
+bool by_estimated_time(const ReportRow& a, const ReportRow& b)
+{
+	return a.estimated_seconds() > b.estimated_seconds();
+}
+
+} // anonymous namespace
+
+
+HotPathCounter::HotPathCounter()
+: m_iterations(0), m_maxCallsPerIteration(0)
+{
+	registered_counters().push_back(this);
+}
+
+HotPathCounter::HotPathCounter(const HotPathCounter& other)
+: m_iterations(0), m_maxCallsPerIteration(0),
+  m_category(other.m_category), m_name(other.m_name), m_subsets(other.m_subsets)
+{
+	registered_counters().push_back(this);
+}
+
+HotPathCounter& HotPathCounter::operator=(const HotPathCounter& other)
+{
+	m_category = other.m_category;
+	m_name = other.m_name;
+	m_subsets = other.m_subsets;
+	return *this;
+}
+
+HotPathCounter::~HotPathCounter()
+{
+	std::vector<HotPathCounter*>& vCounter = registered_counters();
+	std::vector<HotPathCounter*>::iterator it = std::find(vCounter.begin(), vCounter.end(), this);
+	if (it != vCounter.end())
+		vCounter.erase(it);
+}
+
+
+void HotPathCounter::set_label(const std::string& category, const std::string& name, const std::string& subsets)
+{
+	m_category = category;
+	m_name = name;
+	m_subsets = subsets;
+}
+
+
+bool HotPathCounter::begin_call() const
+{
+	Tally& t = m_tally.local();
+	++t.iterCalls;
+	if (t.calls++ % s_sampleInterval)
+		return false;
+
+	++t.timedCalls;
+	return true;
+}
+
+
+void HotPathCounter::totals(Totals& tot) const
+{
+	tot.calls = 0;
+	tot.timedCalls = 0;
+	tot.seconds = 0.0;
+	for (size_t i = 0; i < m_tally.size(); ++i)
+	{
+		tot.calls += m_tally[i].calls;
+		tot.timedCalls += m_tally[i].timedCalls;
+		tot.seconds += m_tally[i].seconds;
+	}
+	tot.iterations = m_iterations;
+	tot.maxCallsPerIteration = m_maxCallsPerIteration;
+}
+
+
+void HotPathCounter::close_iteration()
+{
+	size_t iterCalls = 0;
+	for (size_t i = 0; i < m_tally.size(); ++i)
+	{
+		iterCalls += m_tally[i].iterCalls;
+		m_tally[i].iterCalls = 0;
+	}
+
+	++m_iterations;
+	m_maxCallsPerIteration = std::max(m_maxCallsPerIteration, iterCalls);
+}
+
+
+void HotPathCounter::reset()
+{
+	for (size_t i = 0; i < m_tally.size(); ++i)
+		m_tally[i] = Tally();
+	m_iterations = 0;
+	m_maxCallsPerIteration = 0;
+}
+
+#endif // NC_WITH_INSTRUMENTATION
+
+
+
+std::string hot_path_subset_label(const std::vector<std::string>& vSubset)
+{
+	std::string label;
+	for (size_t i = 0; i < vSubset.size(); ++i)
+	{
+		if (i)
+			label += ",";
+		label += vSubset[i];
+	}
+	return label;
+}
+
+
+void set_hot_path_sample_interval(size_t n)
+{
+#ifdef NC_WITH_INSTRUMENTATION
+	s_sampleInterval = std::max(n, (size_t) 1);
+#endif
+}
+
+
+void mark_hot_path_newton_iteration()
+{
+#ifdef NC_WITH_INSTRUMENTATION
+	std::vector<HotPathCounter*>& vCounter = registered_counters();
+	for (size_t i = 0; i < vCounter.size(); ++i)
+		vCounter[i]->close_iteration();
+#endif
+}
+
+
+void reset_hot_path_counters()
+{
+#ifdef NC_WITH_INSTRUMENTATION
+	std::vector<HotPathCounter*>& vCounter = registered_counters();
+	for (size_t i = 0; i < vCounter.size(); ++i)
+		vCounter[i]->reset();
+#endif
+}
+
+
+void print_hot_path_report()
+{
+#ifdef NC_WITH_INSTRUMENTATION
+	// merge counters with identical labels
+	typedef std::pair<std::string, std::pair<std::string, std::string> > label_type;
+	std::map<label_type, size_t> mRow;
+	std::vector<ReportRow> vRow;
+
+	const std::vector<HotPathCounter*>& vCounter = registered_counters();
+	for (size_t i = 0; i < vCounter.size(); ++i)
+	{
+		const HotPathCounter& c = *vCounter[i];
+		HotPathCounter::Totals t;
+		c.totals(t);
+		if (!t.calls)
+			continue;
+
+		const label_type label(c.category(), std::make_pair(c.name(), c.subsets()));
+		std::map<label_type, size_t>::iterator it = mRow.find(label);
+		if (it == mRow.end())
+		{
+			mRow[label] = vRow.size();
+			ReportRow row;
+			row.category = c.category();
+			row.name = c.name();
+			row.subsets = c.subsets();
+			row.t = t;
+			vRow.push_back(row);
+			continue;
+		}
+
+		HotPathCounter::Totals& rt = vRow[it->second].t;
+		rt.calls += t.calls;
+		rt.timedCalls += t.timedCalls;
+		rt.seconds += t.seconds;
+		rt.iterations = std::max(rt.iterations, t.iterations);
+		rt.maxCallsPerIteration += t.maxCallsPerIteration;
+	}
+
+	std::sort(vRow.begin(), vRow.end(), by_estimated_time);
+
+	std::ostringstream oss;
+	oss << "Hot path report (every " << s_sampleInterval << "th call timed):\n";
+	oss << std::left << std::setw(44) << "function" << std::setw(24) << "mechanism"
+		<< std::setw(20) << "subsets" << std::right << std::setw(12) << "calls"
+		<< std::setw(14) << "us/call" << std::setw(12) << "est. s"
+		<< std::setw(12) << "calls/it" << std::setw(12) << "max/it" << "\n";
+	for (size_t i = 0; i < vRow.size(); ++i)
+	{
+		const ReportRow& r = vRow[i];
+		oss << std::left << std::setw(44) << r.category << std::setw(24) << r.name
+			<< std::setw(20) << r.subsets << std::right << std::setw(12) << r.t.calls;
+		if (r.t.timedCalls)
+			oss << std::setw(14) << 1e6 * r.t.seconds / r.t.timedCalls;
+		else
+			oss << std::setw(14) << "-";
+		oss << std::setw(12) << r.estimated_seconds();
+		if (r.t.iterations)
+			oss << std::setw(12) << (number) r.t.calls / r.t.iterations
+				<< std::setw(12) << r.t.maxCallsPerIteration;
+		else
+			oss << std::setw(12) << "-" << std::setw(12) << "-";
+		oss << "\n";
+	}
+	UG_LOG(oss.str());
+#else
+	UG_LOG("Hot path report not available: The neuro_collection plugin has been built "
+		"without instrumentation (NCInstrumentation=OFF)." << std::endl);
+#endif
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__HOT_PATH_COUNTERS_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__HOT_PATH_COUNTERS_H
+
+#include <cstddef>                       // for size_t
+#include <string>                        // for string
+#include <vector>                        // for vector
+
+// configuration file for compile options
+#include "nc_config.h"
+
+#ifdef NC_WITH_INSTRUMENTATION
+#include "common/stopwatch.h"            // for Stopwatch
+#include "common/types.h"                // for number
+#include "thread_scratch.h"              // for ThreadScratch
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+#ifdef NC_WITH_INSTRUMENTATION
+
+/**
+ * @brief Call counter and sampling timer for a hot code path
+ *
+ * Counts the calls of an instrumented function (per thread, so there is no contention)
+ * and measures the run time of every n-th call (see set_hot_path_sample_interval()).
+ * Calls are also attributed to Newton iterations: mark_hot_path_newton_iteration()
+ * closes the current iteration of all counters.
+ *
+ * Counters register themselves on construction; they are reported by
+ * print_hot_path_report() under their category (the instrumented function),
+ * the name of their owner (e.g. IMembraneTransporter::name()) and its subsets.
+ *
+ * Use the NC_HOT_PATH_* macros instead of this class directly, as they compile
+ * to nothing if the plugin is built without instrumentation (NCInstrumentation=OFF).
+ */
+class HotPathCounter
+{
+	public:
+		HotPathCounter();
+		HotPathCounter(const HotPathCounter& other);
+		HotPathCounter& operator=(const HotPathCounter& other);
+		~HotPathCounter();
+
+		/// set the labels under which the counter is reported
+		void set_label(const std::string& category, const std::string& name, const std::string& subsets);
+
+		/// provide tallies for the current number of threads (not thread-safe)
+		void prepare_threads() {m_tally.ensure_capacity();}
+
+		/// count a call; returns whether it is to be timed
+		bool begin_call() const;
+
+		/// add the measured time of a timed call
+		void end_timed_call(number seconds) const {m_tally.local().seconds += seconds;}
+
+		/// accumulated data
+		struct Totals
+		{
+			size_t calls;
+			size_t timedCalls;
+			number seconds;
+			size_t iterations;
+			size_t maxCallsPerIteration;
+		};
+		void totals(Totals& t) const;
+
+		/// close the current Newton iteration (not thread-safe)
+		void close_iteration();
+
+		/// set all tallies to zero (not thread-safe)
+		void reset();
+
+		const std::string& category() const {return m_category;}
+		const std::string& name() const {return m_name;}
+		const std::string& subsets() const {return m_subsets;}
+
+	private:
+		struct Tally
+		{
+			Tally() : calls(0), timedCalls(0), seconds(0.0), iterCalls(0) {}
+			size_t calls;
+			size_t timedCalls;
+			number seconds;
+			size_t iterCalls;  ///< calls in the current Newton iteration
+		};
+		ThreadScratch<Tally> m_tally;
+
+		size_t m_iterations;
+		size_t m_maxCallsPerIteration;
+
+		std::string m_category;
+		std::string m_name;
+		std::string m_subsets;
+};
+
+
+/// times a scope if the counter decides so
+class HotPathScope
+{
+	public:
+		HotPathScope(const HotPathCounter& c)
+		: m_c(c), m_bTimed(c.begin_call())
+		{
+			if (m_bTimed)
+				m_sw.start();
+		}
+
+		~HotPathScope()
+		{
+			if (m_bTimed)
+				m_c.end_timed_call(m_sw.ms() / 1000.0);
+		}
+
+	private:
+		const HotPathCounter& m_c;
+		bool m_bTimed;
+		Stopwatch m_sw;
+};
+
+/// declare a counter (as a class member)
+#define NC_HOT_PATH_COUNTER(var) HotPathCounter var;
+
+/// label a counter
+#define NC_HOT_PATH_LABEL(var, category, name, subsets) (var).set_label(category, name, subsets)
+
+/// provide thread tallies for a counter
+#define NC_HOT_PATH_PREPARE_THREADS(var) (var).prepare_threads()
+
+/// count (and possibly time) the remainder of the enclosing scope
+#define NC_HOT_PATH_SCOPE(var) HotPathScope ncHotPathScope(var)
+
+#else
+
+#define NC_HOT_PATH_COUNTER(var)
+#define NC_HOT_PATH_LABEL(var, category, name, subsets)
+#define NC_HOT_PATH_PREPARE_THREADS(var)
+#define NC_HOT_PATH_SCOPE(var)
+
+#endif // NC_WITH_INSTRUMENTATION
+
+
+/// comma-separated list of subset names for counter labels
+std::string hot_path_subset_label(const std::vector<std::string>& vSubset);
+
+/**
+ * @brief Time every n-th call of instrumented functions
+ *
+ * The per-call times in the report are averages over the timed calls.
+ * Default: 64. Does nothing without instrumentation.
+ */
+void set_hot_path_sample_interval(size_t n);
+
+/// close the current Newton iteration of all counters (does nothing without instrumentation)
+void mark_hot_path_newton_iteration();
+
+/// set all counters to zero (does nothing without instrumentation)
+void reset_hot_path_counters();
+
+/**
+ * @brief Print the call counts and times of all instrumented functions
+ *
+ * Rows are grouped by instrumented function, owner name and subsets and sorted
+ * by estimated total time (average time of timed calls times number of calls).
+ * In parallel runs, each process prints its own numbers.
+ */
+void print_hot_path_report();
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__HOT_PATH_COUNTERS_H
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__IN_SITU_ANALYSIS_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__IN_SITU_ANALYSIS_H
+
+#include "common/types.h"  // number
+#include "common/util/smart_pointer.h"
+#include "lib_disc/function_spaces/grid_function.h"
+
+#include "async_record_writer.h"  // for AsyncRecordWriter
+
+#include <string>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/**
+ * @brief In-situ reduction of the solution to a few derived quantities
+ *
+ * Instead of exporting full profiles or volume snapshots for later analysis,
+ * this class computes a configurable set of reductions of the solution
+ * in every call to analyze() and writes only their results:
+ * - statistics: minimum, maximum and (volume-weighted) mean of a function
+ *   on each of a set of subsets,
+ * - area above threshold: measure of the part of each subset where a function
+ *   exceeds a threshold (per element, the element measure times the fraction
+ *   of its corners above the threshold),
+ * - front position: largest x coordinate of a corner where a function exceeds
+ *   a threshold (over all given subsets; -max number if there is none),
+ * - histogram: measure of the part of each subset where the (element-averaged)
+ *   function lies in each of a number of equidistant bins (values outside
+ *   the range are counted in the first and last bins).
+ *
+ * All reductions are computed in one pass over the elements of each subset
+ * and reduced over all processes with one sum and one max reduction.
+ * Elements shared by several processes are only counted by the master copy.
+ * Each call appends one record (the time followed by all results) to the binary
+ * file <fileBaseName>.bin (see AsyncRecordWriter, BinaryRecordReader);
+ * the column names describe the results.
+ *
+ * Optionally, a spatially decimated snapshot is written every n-th call
+ * (see set_snapshot()): the values of some functions in all vertices of some
+ * subsets that already exist on a coarse grid level, together with their
+ * coordinates, appended by each process to <fileBaseName>_snapshot[_p<rank>].bin.
+ *
+ * The functions must be vertex-centered (e.g. Lagrange P1).
+ */
+template <typename TDomain, typename TAlgebra>
+class InSituAnalysis
+{
+	public:
+		typedef GridFunction<TDomain, TAlgebra> gf_type;
+		static const int worldDim = TDomain::dim;
+
+	public:
+		/// constructor
+		InSituAnalysis(SmartPtr<ApproximationSpace<TDomain> > approxSpace, const std::string& fileBaseName);
+
+		/// minimum, maximum and mean of a function on each of the subsets
+		void add_statistics(const char* fctName, const char* subsetNames);
+
+		/// measure of the part of each subset where the function exceeds the threshold
+		void add_area_above_threshold(const char* fctName, const char* subsetNames, number thresh);
+
+		/// largest x coordinate where the function exceeds the threshold on the subsets
+		void add_front_position(const char* fctName, const char* subsetNames, number thresh);
+
+		/// histogram of the function on each of the subsets
+		void add_histogram(const char* fctName, const char* subsetNames, number lower, number upper, size_t nBins);
+
+		/**
+		 * @brief write decimated snapshots
+		 *
+		 * @param fctNames     functions to be written (comma-separated)
+		 * @param subsetNames  subsets to be written (comma-separated)
+		 * @param interval     a snapshot is written in every interval-th call to analyze()
+		 *                     (0 disables snapshots)
+		 * @param level        only vertices existing on this grid level (or coarser) are written
+		 */
+		void set_snapshot(const char* fctNames, const char* subsetNames, size_t interval, int level);
+
+		/// compute all reductions for a solution at the given time and write the results
+		void analyze(ConstSmartPtr<gf_type> u, number time);
+
+		/// number of results per record (without time)
+		size_t num_values() const {return m_vColName.size() - 1;}
+
+		/// name of a result
+		const std::string& value_name(size_t i) const;
+
+		/// result of the last analysis
+		number value(size_t i) const;
+
+		/// write all queued records
+		void flush();
+
+	private:
+		enum ReductionType {RT_STATISTICS, RT_AREA_ABOVE, RT_FRONT, RT_HISTOGRAM};
+
+		struct Reduction
+		{
+			ReductionType type;
+			size_t fct;
+			SubsetGroup ssGrp;
+			number thresh;
+			number lower;
+			number upper;
+			size_t nBins;
+			size_t sumOffset;	///< first entry in the sum-reduced values
+			size_t maxOffset;	///< first entry in the max-reduced values
+		};
+
+		void add_reduction(Reduction& r, const char* fctName, const char* subsetNames);
+
+		template <int dim>
+		void reduce_subset(const gf_type& u, const Reduction& r, size_t s);
+
+		void assemble_record(number time);
+
+		void write_snapshot(const gf_type& u, number time);
+
+		template <int dim>
+		void collect_snapshot_vertices(const gf_type& u, int si, std::vector<Vertex*>& vVrt);
+
+	private:
+		SmartPtr<ApproximationSpace<TDomain> > m_spApprox;
+		std::string m_fileName;
+
+		std::vector<Reduction> m_vReduction;
+		size_t m_nSum;
+		size_t m_nMax;
+		std::vector<std::string> m_vColName;
+
+		SmartPtr<AsyncRecordWriter> m_spWriter;
+		std::vector<number> m_vLocalSum, m_vGlobalSum;
+		std::vector<number> m_vLocalMax, m_vGlobalMax;
+		std::vector<number> m_vRecord;
+
+		size_t m_snapInterval;
+		int m_snapLevel;
+		FunctionGroup m_snapFctGrp;
+		SubsetGroup m_snapSsGrp;
+		SmartPtr<AsyncRecordWriter> m_spSnapWriter;
+		std::vector<number> m_vSnapRecord;
+
+		size_t m_nCalls;
+
+		/// buffers
+		std::vector<MathVector<worldDim> > m_vCorner;
+		std::vector<DoFIndex> m_vInd;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "in_situ_analysis_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__IN_SITU_ANALYSIS_H
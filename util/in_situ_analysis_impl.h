@@ -0,0 +1,581 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#include "in_situ_analysis.h"
+
+#include "common/error.h"	// UG_THROW etc.
+#include "common/util/string_util.h"	// TokenizeString
+#include "timeline_trace.h"	// NC_TRACE_SCOPE
+#ifdef UG_PARALLEL
+	#include "lib_grid/parallelization/distributed_grid.h"	// DistributedGridManager
+	#include "pcl/pcl_process_communicator.h"	// ProcessCommunicator
+#endif
+
+#include <algorithm>	// min, max
+#include <cmath>	// floor
+#include <limits>
+#include <sstream>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TDomain, typename TAlgebra>
+InSituAnalysis<TDomain, TAlgebra>::InSituAnalysis
+(
+	SmartPtr<ApproximationSpace<TDomain> > approxSpace,
+	const std::string& fileBaseName
+)
+: m_spApprox(approxSpace),
+  m_fileName(fileBaseName),
+  m_nSum(0),
+  m_nMax(0),
+  m_vColName(1, "time"),
+  m_snapInterval(0),
+  m_snapLevel(0),
+  m_nCalls(0)
+{
+	UG_COND_THROW(!m_spApprox.valid(), "InSituAnalysis: Invalid approximation space given.");
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::add_reduction
+(
+	Reduction& r,
+	const char* fctName,
+	const char* subsetNames
+)
+{
+	UG_COND_THROW(m_spWriter.valid(),
+		"InSituAnalysis: Reductions cannot be added after the first analysis.");
+
+	try {r.fct = m_spApprox->fct_id_by_name(fctName);}
+	UG_CATCH_THROW("Function '" << fctName << "' is not contained in the approximation space.");
+
+	r.ssGrp = SubsetGroup(m_spApprox->domain()->subset_handler());
+	try {r.ssGrp.add(TokenizeString(subsetNames));}
+	UG_CATCH_THROW("Could not add all subsets in '" << subsetNames << "' to InSituAnalysis.");
+	UG_COND_THROW(r.ssGrp.size() < 1, "InSituAnalysis: At least one subset has to be given.");
+
+	r.sumOffset = m_nSum;
+	r.maxOffset = m_nMax;
+
+	const size_t nSs = r.ssGrp.size();
+	switch (r.type)
+	{
+		case RT_STATISTICS:
+			// sums: integral and measure; maxima: max and -min (per subset)
+			m_nSum += 2*nSs;
+			m_nMax += 2*nSs;
+			for (size_t s = 0; s < nSs; ++s)
+			{
+				m_vColName.push_back(std::string("min_") + fctName + "_" + r.ssGrp.name(s));
+				m_vColName.push_back(std::string("max_") + fctName + "_" + r.ssGrp.name(s));
+				m_vColName.push_back(std::string("mean_") + fctName + "_" + r.ssGrp.name(s));
+			}
+			break;
+		case RT_AREA_ABOVE:
+			m_nSum += nSs;
+			for (size_t s = 0; s < nSs; ++s)
+				m_vColName.push_back(std::string("area_above_") + fctName + "_" + r.ssGrp.name(s));
+			break;
+		case RT_FRONT:
+			m_nMax += 1;
+			m_vColName.push_back(std::string("front_") + fctName);
+			break;
+		case RT_HISTOGRAM:
+			m_nSum += nSs * r.nBins;
+			for (size_t s = 0; s < nSs; ++s)
+			{
+				for (size_t b = 0; b < r.nBins; ++b)
+				{
+					std::ostringstream oss;
+					oss << "hist" << b << "_" << fctName << "_" << r.ssGrp.name(s);
+					m_vColName.push_back(oss.str());
+				}
+			}
+			break;
+	}
+
+	m_vReduction.push_back(r);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::add_statistics(const char* fctName, const char* subsetNames)
+{
+	Reduction r;
+	r.type = RT_STATISTICS;
+	r.thresh = r.lower = r.upper = 0.0;
+	r.nBins = 0;
+	add_reduction(r, fctName, subsetNames);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::add_area_above_threshold
+(
+	const char* fctName,
+	const char* subsetNames,
+	number thresh
+)
+{
+	Reduction r;
+	r.type = RT_AREA_ABOVE;
+	r.thresh = thresh;
+	r.lower = r.upper = 0.0;
+	r.nBins = 0;
+	add_reduction(r, fctName, subsetNames);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::add_front_position
+(
+	const char* fctName,
+	const char* subsetNames,
+	number thresh
+)
+{
+	Reduction r;
+	r.type = RT_FRONT;
+	r.thresh = thresh;
+	r.lower = r.upper = 0.0;
+	r.nBins = 0;
+	add_reduction(r, fctName, subsetNames);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::add_histogram
+(
+	const char* fctName,
+	const char* subsetNames,
+	number lower,
+	number upper,
+	size_t nBins
+)
+{
+	UG_COND_THROW(nBins < 1, "InSituAnalysis: A histogram needs at least one bin.");
+	UG_COND_THROW(upper <= lower, "InSituAnalysis: Upper bound of the histogram ("
+		<< upper << ") must be larger than lower bound (" << lower << ").");
+
+	Reduction r;
+	r.type = RT_HISTOGRAM;
+	r.thresh = 0.0;
+	r.lower = lower;
+	r.upper = upper;
+	r.nBins = nBins;
+	add_reduction(r, fctName, subsetNames);
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::set_snapshot
+(
+	const char* fctNames,
+	const char* subsetNames,
+	size_t interval,
+	int level
+)
+{
+	UG_COND_THROW(m_spSnapWriter.valid(),
+		"InSituAnalysis: Snapshots cannot be changed after the first snapshot.");
+
+	m_snapFctGrp = FunctionGroup(m_spApprox->function_pattern());
+	try {m_snapFctGrp.add(TokenizeString(fctNames));}
+	UG_CATCH_THROW("Could not add all functions in '" << fctNames << "' to InSituAnalysis.");
+
+	m_snapSsGrp = SubsetGroup(m_spApprox->domain()->subset_handler());
+	try {m_snapSsGrp.add(TokenizeString(subsetNames));}
+	UG_CATCH_THROW("Could not add all subsets in '" << subsetNames << "' to InSituAnalysis.");
+
+	m_snapInterval = interval;
+	m_snapLevel = level;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+template <int dim>
+void InSituAnalysis<TDomain, TAlgebra>::reduce_subset(const gf_type& u, const Reduction& r, size_t s)
+{
+	typedef typename domain_traits<dim>::grid_base_object Elem;
+	typedef typename gf_type::template traits<Elem>::const_iterator iter_type;
+
+	const typename TDomain::position_accessor_type& aaPos = m_spApprox->domain()->position_accessor();
+
+#ifdef UG_PARALLEL
+	const DistributedGridManager& dgm = *u.dof_distribution()->multi_grid()->distributed_grid_manager();
+#endif
+
+	number* vSum = m_vLocalSum.empty() ? NULL : &m_vLocalSum[r.sumOffset];
+	number* vMax = m_vLocalMax.empty() ? NULL : &m_vLocalMax[r.maxOffset];
+
+	iter_type iter = u.template begin<Elem>(r.ssGrp[s]);
+	iter_type iterEnd = u.template end<Elem>(r.ssGrp[s]);
+	for (; iter != iterEnd; ++iter)
+	{
+		Elem* elem = *iter;
+
+#ifdef UG_PARALLEL
+		// do not count horizontal slaves in the parallel case to prevent double counting
+		if (dgm.get_status(elem) & ES_H_SLAVE)
+			continue;
+#endif
+
+		u.dof_indices(elem, r.fct, m_vInd);
+		const size_t nCo = m_vInd.size();
+		if (!nCo)
+			continue;
+
+		CollectCornerCoordinates(m_vCorner, elem, aaPos, false);
+
+		switch (r.type)
+		{
+			case RT_STATISTICS:
+			{
+				number avg = 0.0;
+				for (size_t co = 0; co < nCo; ++co)
+				{
+					const number val = DoFRef(u, m_vInd[co]);
+					avg += val;
+					vMax[2*s] = std::max(vMax[2*s], val);
+					vMax[2*s+1] = std::max(vMax[2*s+1], -val);
+				}
+				const number size = ElementSize<worldDim>(elem->reference_object_id(), &m_vCorner[0]);
+				vSum[2*s] += size * avg / nCo;
+				vSum[2*s+1] += size;
+				break;
+			}
+			case RT_AREA_ABOVE:
+			{
+				size_t nAbove = 0;
+				for (size_t co = 0; co < nCo; ++co)
+					if (DoFRef(u, m_vInd[co]) > r.thresh)
+						++nAbove;
+				if (nAbove)
+					vSum[s] += ElementSize<worldDim>(elem->reference_object_id(), &m_vCorner[0])
+						* (number) nAbove / nCo;
+				break;
+			}
+			case RT_FRONT:
+			{
+				for (size_t co = 0; co < nCo; ++co)
+					if (DoFRef(u, m_vInd[co]) > r.thresh)
+						vMax[0] = std::max(vMax[0], m_vCorner[co][0]);
+				break;
+			}
+			case RT_HISTOGRAM:
+			{
+				number avg = 0.0;
+				for (size_t co = 0; co < nCo; ++co)
+					avg += DoFRef(u, m_vInd[co]);
+				avg /= nCo;
+
+				const number rel = (avg - r.lower) / (r.upper - r.lower);
+				long bin = (long) std::floor(rel * r.nBins);
+				bin = std::min(std::max(bin, 0L), (long) r.nBins - 1);
+				vSum[s*r.nBins + bin] += ElementSize<worldDim>(elem->reference_object_id(), &m_vCorner[0]);
+				break;
+			}
+		}
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::assemble_record(number time)
+{
+	m_vRecord.resize(m_vColName.size());
+	m_vRecord[0] = time;
+
+	size_t k = 1;
+	const size_t nRed = m_vReduction.size();
+	for (size_t i = 0; i < nRed; ++i)
+	{
+		const Reduction& r = m_vReduction[i];
+		const number* vSum = m_vGlobalSum.empty() ? NULL : &m_vGlobalSum[r.sumOffset];
+		const number* vMax = m_vGlobalMax.empty() ? NULL : &m_vGlobalMax[r.maxOffset];
+		const size_t nSs = r.ssGrp.size();
+
+		switch (r.type)
+		{
+			case RT_STATISTICS:
+				for (size_t s = 0; s < nSs; ++s)
+				{
+					m_vRecord[k++] = -vMax[2*s+1];
+					m_vRecord[k++] = vMax[2*s];
+					m_vRecord[k++] = vSum[2*s+1] > 0.0 ? vSum[2*s] / vSum[2*s+1] : 0.0;
+				}
+				break;
+			case RT_AREA_ABOVE:
+				for (size_t s = 0; s < nSs; ++s)
+					m_vRecord[k++] = vSum[s];
+				break;
+			case RT_FRONT:
+				m_vRecord[k++] = vMax[0];
+				break;
+			case RT_HISTOGRAM:
+				for (size_t b = 0; b < nSs * r.nBins; ++b)
+					m_vRecord[k++] = vSum[b];
+				break;
+		}
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::analyze(ConstSmartPtr<gf_type> u, number time)
+{
+	NC_TRACE_SCOPE("InSituAnalysis::analyze");
+
+	const gf_type& sol = *u;
+
+	// local reductions
+	m_vLocalSum.assign(m_nSum, 0.0);
+	m_vLocalMax.assign(m_nMax, -std::numeric_limits<number>::max());
+	const size_t nRed = m_vReduction.size();
+	for (size_t i = 0; i < nRed; ++i)
+	{
+		const Reduction& r = m_vReduction[i];
+		const size_t nSs = r.ssGrp.size();
+		for (size_t s = 0; s < nSs; ++s)
+		{
+			const int dim = r.ssGrp.dim(s);
+			if (dim == worldDim)
+				reduce_subset<worldDim>(sol, r, s);
+			else if (dim == worldDim-1 && worldDim > 1)
+				reduce_subset<(worldDim>1 ? worldDim-1 : 1)>(sol, r, s);
+			else if (dim == worldDim-2 && worldDim > 2)
+				reduce_subset<(worldDim>2 ? worldDim-2 : 1)>(sol, r, s);
+			else if (dim == 0)
+				reduce_subset<0>(sol, r, s);
+			else {UG_THROW("Unknown dim (" << dim << ") or worldDim (" << worldDim << ").");}
+		}
+	}
+
+	// global reductions (one for all sums, one for all maxima)
+	m_vGlobalSum = m_vLocalSum;
+	m_vGlobalMax = m_vLocalMax;
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		if (m_nSum)
+			com.allreduce(&m_vLocalSum[0], &m_vGlobalSum[0], (int) m_nSum, PCL_DT_DOUBLE, PCL_RO_SUM);
+		if (m_nMax)
+			com.allreduce(&m_vLocalMax[0], &m_vGlobalMax[0], (int) m_nMax, PCL_DT_DOUBLE, PCL_RO_MAX);
+	}
+#endif
+
+	assemble_record(time);
+
+	// write results
+#ifdef UG_PARALLEL
+	if (GetLogAssistant().is_output_process())
+	{
+#endif
+	if (!m_spWriter.valid())
+	{
+		const std::string fileName = m_fileName + ".bin";
+		try {m_spWriter = make_sp(new AsyncRecordWriter(fileName, m_vColName, time != 0.0));}
+		UG_CATCH_THROW("Output file '" << fileName << "' could not be opened.");
+	}
+	try {m_spWriter->write(m_vRecord);}
+	UG_CATCH_THROW("Output file '" << m_spWriter->file_name() << "' could not be written to.");
+#ifdef UG_PARALLEL
+	}
+#endif
+
+	// decimated snapshot
+	if (m_snapInterval && m_nCalls % m_snapInterval == 0)
+		write_snapshot(sol, time);
+
+	++m_nCalls;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+template <int dim>
+void InSituAnalysis<TDomain, TAlgebra>::collect_snapshot_vertices
+(
+	const gf_type& u,
+	int si,
+	std::vector<Vertex*>& vVrt
+)
+{
+	typedef typename domain_traits<dim>::grid_base_object Elem;
+	typedef typename gf_type::template traits<Elem>::const_iterator iter_type;
+
+	MultiGrid& mg = *m_spApprox->domain()->grid();
+
+#ifdef UG_PARALLEL
+	const DistributedGridManager& dgm = *mg.distributed_grid_manager();
+#endif
+
+	iter_type iter = u.template begin<Elem>(si);
+	iter_type iterEnd = u.template end<Elem>(si);
+	for (; iter != iterEnd; ++iter)
+	{
+		Elem* elem = *iter;
+		const size_t nVrt = elem->num_vertices();
+		for (size_t i = 0; i < nVrt; ++i)
+		{
+			Vertex* vrt = elem->vertex(i);
+			if (mg.is_marked(vrt) || mg.get_level(vrt) > m_snapLevel)
+				continue;
+			mg.mark(vrt);
+
+#ifdef UG_PARALLEL
+			if (dgm.get_status(vrt) & ES_H_SLAVE)
+				continue;
+#endif
+			vVrt.push_back(vrt);
+		}
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::write_snapshot(const gf_type& u, number time)
+{
+	NC_TRACE_SCOPE("InSituAnalysis::write_snapshot");
+
+	const size_t nFct = m_snapFctGrp.size();
+
+	if (!m_spSnapWriter.valid())
+	{
+		std::vector<std::string> vColName(1, "time");
+		const char* coordName[3] = {"x", "y", "z"};
+		for (int d = 0; d < worldDim; ++d)
+			vColName.push_back(coordName[d]);
+		for (size_t f = 0; f < nFct; ++f)
+			vColName.push_back(m_snapFctGrp.name(f));
+
+		std::ostringstream ossFn;
+		ossFn << m_fileName << "_snapshot";
+#ifdef UG_PARALLEL
+		if (pcl::NumProcs() > 1)
+			ossFn << "_p" << pcl::ProcRank();
+#endif
+		ossFn << ".bin";
+
+		try {m_spSnapWriter = make_sp(new AsyncRecordWriter(ossFn.str(), vColName, time != 0.0));}
+		UG_CATCH_THROW("Snapshot file '" << ossFn.str() << "' could not be opened.");
+	}
+
+	// vertices of the subsets existing on the snapshot level (each once)
+	std::vector<Vertex*> vVrt;
+	MultiGrid& mg = *m_spApprox->domain()->grid();
+	mg.begin_marking();
+	const size_t nSs = m_snapSsGrp.size();
+	for (size_t s = 0; s < nSs; ++s)
+	{
+		const int dim = m_snapSsGrp.dim(s);
+		if (dim == worldDim)
+			collect_snapshot_vertices<worldDim>(u, m_snapSsGrp[s], vVrt);
+		else if (dim == worldDim-1 && worldDim > 1)
+			collect_snapshot_vertices<(worldDim>1 ? worldDim-1 : 1)>(u, m_snapSsGrp[s], vVrt);
+		else if (dim == worldDim-2 && worldDim > 2)
+			collect_snapshot_vertices<(worldDim>2 ? worldDim-2 : 1)>(u, m_snapSsGrp[s], vVrt);
+		else if (dim == 0)
+			collect_snapshot_vertices<0>(u, m_snapSsGrp[s], vVrt);
+		else
+		{
+			mg.end_marking();
+			UG_THROW("Unknown dim (" << dim << ") or worldDim (" << worldDim << ").");
+		}
+	}
+	mg.end_marking();
+
+	// time, then coordinates and values for each vertex
+	const typename TDomain::position_accessor_type& aaPos = m_spApprox->domain()->position_accessor();
+	const size_t nVrt = vVrt.size();
+	const size_t stride = worldDim + nFct;
+	m_vSnapRecord.resize(1 + nVrt*stride);
+	m_vSnapRecord[0] = time;
+	for (size_t i = 0; i < nVrt; ++i)
+	{
+		number* rec = &m_vSnapRecord[1 + i*stride];
+		for (int d = 0; d < worldDim; ++d)
+			rec[d] = aaPos[vVrt[i]][d];
+		for (size_t f = 0; f < nFct; ++f)
+		{
+			u.inner_dof_indices(vVrt[i], m_snapFctGrp[f], m_vInd);
+			rec[worldDim + f] = m_vInd.empty() ? 0.0 : DoFRef(u, m_vInd[0]);
+		}
+	}
+
+	try {m_spSnapWriter->write(m_vSnapRecord);}
+	UG_CATCH_THROW("Snapshot file '" << m_spSnapWriter->file_name() << "' could not be written to.");
+}
+
+
+template <typename TDomain, typename TAlgebra>
+const std::string& InSituAnalysis<TDomain, TAlgebra>::value_name(size_t i) const
+{
+	UG_COND_THROW(i >= num_values(), "InSituAnalysis: Value index " << i << " out of range.");
+	return m_vColName[i+1];
+}
+
+
+template <typename TDomain, typename TAlgebra>
+number InSituAnalysis<TDomain, TAlgebra>::value(size_t i) const
+{
+	UG_COND_THROW(i >= num_values(), "InSituAnalysis: Value index " << i << " out of range.");
+	UG_COND_THROW(m_vRecord.empty(), "InSituAnalysis: No analysis has been performed yet.");
+	return m_vRecord[i+1];
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void InSituAnalysis<TDomain, TAlgebra>::flush()
+{
+	if (m_spWriter.valid())
+		m_spWriter->flush();
+	if (m_spSnapWriter.valid())
+		m_spSnapWriter->flush();
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
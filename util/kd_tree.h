@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__KD_TREE_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__KD_TREE_H
+
+#include <cstddef>                       // for size_t
+#include <vector>                        // for vector
+
+#include "common/math/ugmath.h"          // for MathVector, VecDistanceSq
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Static k-d tree for nearest neighbor queries on point sets
+ *
+ * The tree is built once from a set of data points (in O(M log M)) and can then
+ * be queried for the nearest data point to any query point in O(log M) each.
+ * It is meant to replace brute-force nearest neighbor searches where the same data
+ * set is queried many times, e.g., when mapping many 3d vertices to the vertices
+ * of a 1d neuron.
+ *
+ * The tree is balanced and stored implicitly: The points are permuted such that
+ * each index range [lo, hi) is a subtree with its splitting point at (lo+hi)/2.
+ * No node structures are allocated. The splitting dimension of each subtree is
+ * the dimension of largest extent of its points.
+ *
+ * Queries are read-only and can therefore be carried out concurrently.
+ * Batched queries are thread-parallel if OpenMP is available.
+ */
+template <int dim>
+class KDTree
+{
+	public:
+		typedef MathVector<dim> pos_type;
+		typedef typename pos_type::value_type value_type;
+
+	public:
+		/// constructor
+		KDTree();
+
+		/// constructor building the tree from a set of data points
+		KDTree(const std::vector<pos_type>& vDataPts);
+
+		/// (re-)build tree from a set of data points
+		void build(const std::vector<pos_type>& vDataPts);
+
+		/// remove all data points
+		void clear();
+
+		/// number of data points in the tree
+		size_t size() const {return m_vPts.size();}
+
+		/// whether the tree contains no data points
+		bool empty() const {return m_vPts.empty();}
+
+		/**
+		 * @brief find nearest data point to a query point
+		 *
+		 * @param qp       query point
+		 * @param distSq   output: squared distance to the nearest data point
+		 * @return         index (in the data vector given on construction) of nearest data point
+		 *
+		 * Must not be called on an empty tree.
+		 */
+		size_t nearest(const pos_type& qp, value_type& distSq) const;
+
+		/**
+		 * @brief find nearest data points for a batch of query points
+		 *
+		 * @param vQueryPts   query points
+		 * @param vNNOut      output: indices of nearest data points
+		 * @param vDistSqOut  output: squared distances to nearest data points
+		 *
+		 * Must not be called on an empty tree.
+		 */
+		void nearest
+		(
+			const std::vector<pos_type>& vQueryPts,
+			std::vector<size_t>& vNNOut,
+			std::vector<value_type>& vDistSqOut
+		) const;
+
+	protected:
+		void build_subtree(size_t lo, size_t hi);
+
+		void search_subtree
+		(
+			size_t lo,
+			size_t hi,
+			const pos_type& qp,
+			size_t& best,
+			value_type& bestDistSq
+		) const;
+
+	private:
+		struct IndexCompare
+		{
+			IndexCompare(const std::vector<pos_type>& _vPts, size_t _cmp)
+			: vPts(_vPts), cmp(_cmp) {};
+
+			bool operator()(const size_t& a, const size_t& b) const
+			{return vPts[a][cmp] < vPts[b][cmp];}
+
+			private:
+				const std::vector<pos_type>& vPts;
+				size_t cmp;
+		};
+
+	private:
+		/// data points in tree order
+		std::vector<pos_type> m_vPts;
+
+		/// original indices of data points in tree order
+		std::vector<size_t> m_vInd;
+
+		/// splitting dimension of the subtree whose splitting point is at the index
+		std::vector<unsigned char> m_vSplitDim;
+
+		/// original data points (only needed during construction)
+		const std::vector<pos_type>* m_pvDataPts;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "kd_tree_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__KD_TREE_H
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "kd_tree.h"
+
+#include <algorithm>                     // for std::nth_element
+#include <limits>                        // for std::numeric_limits
+
+#include "common/error.h"                // for UG_ASSERT
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <int dim>
+KDTree<dim>::KDTree()
+: m_pvDataPts(NULL)
+{}
+
+
+template <int dim>
+KDTree<dim>::KDTree(const std::vector<pos_type>& vDataPts)
+: m_pvDataPts(NULL)
+{
+	build(vDataPts);
+}
+
+
+template <int dim>
+void KDTree<dim>::build(const std::vector<pos_type>& vDataPts)
+{
+	const size_t nPts = vDataPts.size();
+
+	m_vInd.resize(nPts);
+	for (size_t i = 0; i < nPts; ++i)
+		m_vInd[i] = i;
+	m_vSplitDim.assign(nPts, 0);
+
+	m_pvDataPts = &vDataPts;
+	build_subtree(0, nPts);
+	m_pvDataPts = NULL;
+
+	// store points in tree order for better locality during the search
+	m_vPts.resize(nPts);
+	for (size_t i = 0; i < nPts; ++i)
+		m_vPts[i] = vDataPts[m_vInd[i]];
+}
+
+
+template <int dim>
+void KDTree<dim>::clear()
+{
+	m_vPts.clear();
+	m_vInd.clear();
+	m_vSplitDim.clear();
+}
+
+
+template <int dim>
+void KDTree<dim>::build_subtree(size_t lo, size_t hi)
+{
+	if (hi - lo < 2)
+		return;
+
+	const std::vector<pos_type>& vPts = *m_pvDataPts;
+
+	// find dimension of largest extent
+	pos_type min = vPts[m_vInd[lo]];
+	pos_type max = min;
+	for (size_t i = lo + 1; i < hi; ++i)
+	{
+		const pos_type& pt = vPts[m_vInd[i]];
+		for (int d = 0; d < dim; ++d)
+		{
+			if (pt[d] < min[d]) min[d] = pt[d];
+			else if (pt[d] > max[d]) max[d] = pt[d];
+		}
+	}
+	size_t splitDim = 0;
+	for (int d = 1; d < dim; ++d)
+		if (max[d] - min[d] > max[splitDim] - min[splitDim])
+			splitDim = d;
+
+	// partition around median
+	const size_t mid = lo + (hi - lo) / 2;
+	std::nth_element(m_vInd.begin() + lo, m_vInd.begin() + mid, m_vInd.begin() + hi,
+		IndexCompare(vPts, splitDim));
+	m_vSplitDim[mid] = (unsigned char) splitDim;
+
+	build_subtree(lo, mid);
+	build_subtree(mid + 1, hi);
+}
+
+
+template <int dim>
+void KDTree<dim>::search_subtree
+(
+	size_t lo,
+	size_t hi,
+	const pos_type& qp,
+	size_t& best,
+	value_type& bestDistSq
+) const
+{
+	if (lo >= hi)
+		return;
+
+	const size_t mid = lo + (hi - lo) / 2;
+	const pos_type& sp = m_vPts[mid];
+
+	const value_type distSq = VecDistanceSq(qp, sp);
+	if (distSq < bestDistSq)
+	{
+		bestDistSq = distSq;
+		best = mid;
+	}
+
+	// search the half containing the query point first,
+	// then the other half only if it might contain a closer point
+	const value_type diff = qp[m_vSplitDim[mid]] - sp[m_vSplitDim[mid]];
+	if (diff < 0)
+	{
+		search_subtree(lo, mid, qp, best, bestDistSq);
+		if (diff*diff < bestDistSq)
+			search_subtree(mid + 1, hi, qp, best, bestDistSq);
+	}
+	else
+	{
+		search_subtree(mid + 1, hi, qp, best, bestDistSq);
+		if (diff*diff < bestDistSq)
+			search_subtree(lo, mid, qp, best, bestDistSq);
+	}
+}
+
+
+template <int dim>
+size_t KDTree<dim>::nearest(const pos_type& qp, value_type& distSq) const
+{
+	UG_ASSERT(!empty(), "Nearest neighbor search on an empty k-d tree.");
+
+	size_t best = 0;
+	distSq = std::numeric_limits<value_type>::max();
+	search_subtree(0, m_vPts.size(), qp, best, distSq);
+
+	return m_vInd[best];
+}
+
+
+template <int dim>
+void KDTree<dim>::nearest
+(
+	const std::vector<pos_type>& vQueryPts,
+	std::vector<size_t>& vNNOut,
+	std::vector<value_type>& vDistSqOut
+) const
+{
+	const long nQ = (long) vQueryPts.size();
+	vNNOut.resize(nQ);
+	vDistSqOut.resize(nQ);
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (long q = 0; q < nQ; ++q)
+		vNNOut[q] = nearest(vQueryPts[q], vDistSqOut[q]);
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__MANIFOLD_GEOMETRY_CACHE_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__MANIFOLD_GEOMETRY_CACHE_H
+
+#include "common/math/ugmath.h"  // for MathVector
+#include "common/types.h"  // for number
+#include "common/util/smart_pointer.h"  // for SmartPtr
+#include "lib_grid/grid/grid_base_objects.h"  // for GridObject
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
+#include "lib_grid/tools/subset_handler_interface.h"  // for ISubsetHandler
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/// Boundary faces of a manifold element as needed by the membrane discs
+/**
+ * The membrane discs (RyRImplicit, HH, HHCharges, VDCC_BG) only need
+ * the associated corner and the volume of each boundary face of the
+ * (H)FV1ManifoldGeometry. This class holds exactly these values and
+ * mimics the relevant part of the geometry interface.
+ */
+class ManifoldElemGeometry
+{
+	public:
+		/// boundary face (only node id and volume)
+		class BF
+		{
+			public:
+				BF() : m_nodeId(0), m_vol(0.0) {}
+				BF(int nodeId, number vol) : m_nodeId(nodeId), m_vol(vol) {}
+
+				/// associated corner of the element
+				int node_id() const {return m_nodeId;}
+
+				/// volume of the boundary face
+				number volume() const {return m_vol;}
+
+			private:
+				int m_nodeId;
+				number m_vol;
+		};
+
+	public:
+		/// number of boundary faces
+		size_t num_bf() const {return m_vBF.size();}
+
+		/// boundary face i
+		const BF& bf(size_t i) const {return m_vBF[i];}
+
+		/// take boundary faces from an (updated) finite volume geometry
+		template <typename TFVGeom>
+		void assign(const TFVGeom& geo);
+
+		/// memory held by the boundary faces
+		size_t memory_bytes() const {return m_vBF.capacity() * sizeof(BF);}
+
+	private:
+		std::vector<BF> m_vBF;
+};
+
+
+/**
+ * @brief Cache for the boundary face geometry of manifold elements
+ *
+ * Membrane geometry does not change unless the grid does. Instead of updating
+ * the finite volume geometry of every membrane element in every assembling,
+ * this cache computes it once per element and hands out the stored values
+ * in all following assemblings.
+ * One cache can (and should) be shared by all membrane discs working on
+ * the same grid (cf. set_geometry_cache() of the discs).
+ * The cache is cleared automatically after each adaption and redistribution
+ * of the grid.
+ *
+ * Its entries are computed with whatever geometry type the querying disc uses;
+ * this is the same for all discs on a grid (as it only depends on whether the grid
+ * is regular or not).
+ */
+template <typename TDomain>
+class ManifoldGeometryCache
+{
+	public:
+		static const int dim = TDomain::dim;
+
+	public:
+		/// constructor
+		ManifoldGeometryCache(SmartPtr<TDomain> spDom);
+
+		/// geometry for an element (computed and stored if not yet cached)
+		template <typename TFVGeom>
+		const ManifoldElemGeometry& geometry
+		(
+			GridObject* elem,
+			const MathVector<dim> vCornerCoords[],
+			const ISubsetHandler* sh
+		);
+
+		/// remove all entries
+		void clear() {m_mCache.clear();}
+
+		/// number of cached elements
+		size_t size() const {return m_mCache.size();}
+
+		/// estimated memory held by the cache (entries, boundary faces and map nodes)
+		size_t memory_bytes() const;
+
+	private:
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	private:
+		std::map<GridObject*, ManifoldElemGeometry> m_mCache;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+};
+
+
+/**
+ * @brief Prepare the geometry of a membrane element for assembling
+ *
+ * If a cache is given, the geometry is taken from there; otherwise the finite
+ * volume geometry is updated and its boundary faces are copied to localGeom.
+ *
+ * @return pointer to the geometry to be used in the assembling of this element
+ */
+template <typename TFVGeom, typename TDomain>
+const ManifoldElemGeometry* prepare_manifold_geometry
+(
+	ManifoldGeometryCache<TDomain>* pCache,
+	ManifoldElemGeometry& localGeom,
+	GridObject* elem,
+	const MathVector<TDomain::dim> vCornerCoords[],
+	const ISubsetHandler* sh
+);
+
+/// @}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "manifold_geometry_cache_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__MANIFOLD_GEOMETRY_CACHE_H
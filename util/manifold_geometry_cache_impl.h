@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "manifold_geometry_cache.h"
+
+#include "common/error.h"  // for UG_COND_THROW, UGError
+#include "lib_disc/spatial_disc/disc_util/geom_provider.h"  // for GeomProvider
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TFVGeom>
+void ManifoldElemGeometry::assign(const TFVGeom& geo)
+{
+	const size_t nBF = geo.num_bf();
+	m_vBF.resize(nBF);
+	for (size_t i = 0; i < nBF; ++i)
+		m_vBF[i] = BF(geo.bf(i).node_id(), geo.bf(i).volume());
+}
+
+
+template <typename TDomain>
+ManifoldGeometryCache<TDomain>::ManifoldGeometryCache(SmartPtr<TDomain> spDom)
+{
+	UG_COND_THROW(!spDom.valid(), "ManifoldGeometryCache: Invalid domain given.");
+
+	Grid& grid = *spDom->grid();
+	m_spGridAdaptionCallbackID = grid.message_hub()->register_class_callback(this,
+		&ManifoldGeometryCache<TDomain>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid.message_hub()->register_class_callback(this,
+		&ManifoldGeometryCache<TDomain>::grid_distribution_callback);
+}
+
+
+template <typename TDomain>
+template <typename TFVGeom>
+const ManifoldElemGeometry& ManifoldGeometryCache<TDomain>::geometry
+(
+	GridObject* elem,
+	const MathVector<dim> vCornerCoords[],
+	const ISubsetHandler* sh
+)
+{
+	ManifoldElemGeometry* pGeom = NULL;
+	bool bFailed = false;
+	std::string errMsg;
+
+	// the cache may be shared by several threads
+	// (exceptions must not leave the critical section)
+#ifdef _OPENMP
+	#pragma omp critical (nc_manifold_geom_cache)
+#endif
+	{
+		typename std::map<GridObject*, ManifoldElemGeometry>::iterator it = m_mCache.find(elem);
+		if (it != m_mCache.end())
+			pGeom = &it->second;
+		else
+		{
+			static TFVGeom& geo = GeomProvider<TFVGeom>::get();
+			try
+			{
+				geo.update(elem, vCornerCoords, sh);
+				pGeom = &m_mCache[elem];
+				pGeom->assign(geo);
+			}
+			catch (const UGError& err)
+			{
+				bFailed = true;
+				errMsg = err.get_msg();
+			}
+		}
+	}
+
+	UG_COND_THROW(bFailed, "ManifoldGeometryCache: Cannot update finite volume geometry:\n" << errMsg);
+
+	return *pGeom;
+}
+
+
+template <typename TDomain>
+size_t ManifoldGeometryCache<TDomain>::memory_bytes() const
+{
+	size_t bytes = 0;
+	typename std::map<GridObject*, ManifoldElemGeometry>::const_iterator it = m_mCache.begin();
+	for (; it != m_mCache.end(); ++it)
+		bytes += sizeof(*it) + 4 * sizeof(void*) + it->second.memory_bytes();
+	return bytes;
+}
+
+
+template <typename TDomain>
+void ManifoldGeometryCache<TDomain>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		m_mCache.clear();
+}
+
+
+template <typename TDomain>
+void ManifoldGeometryCache<TDomain>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		m_mCache.clear();
+}
+
+
+template <typename TFVGeom, typename TDomain>
+const ManifoldElemGeometry* prepare_manifold_geometry
+(
+	ManifoldGeometryCache<TDomain>* pCache,
+	ManifoldElemGeometry& localGeom,
+	GridObject* elem,
+	const MathVector<TDomain::dim> vCornerCoords[],
+	const ISubsetHandler* sh
+)
+{
+	if (pCache)
+		return &pCache->template geometry<TFVGeom>(elem, vCornerCoords, sh);
+
+	static TFVGeom& geo = GeomProvider<TFVGeom>::get();
+	geo.update(elem, vCornerCoords, sh);
+	localGeom.assign(geo);
+	return &localGeom;
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -42,6 +42,13 @@
 
 #include "common/util/smart_pointer.h"
 #include "lib_disc/function_spaces/approximation_space.h"
+#include "lib_grid/lib_grid_messages.h"  // for GridMessage_Adaption, GridMessage_Distribution
+#include "async_record_writer.h"  // for AsyncRecordWriter
+#include "compressed_series.h"  // for CompressedSeriesWriter
+
+#include <fstream>
+#include <string>
+#include <vector>
 
 
 namespace ug {
@@ -51,6 +58,62 @@ namespace neuro_collection {
 ///@{
 
 
+/**
+ * \brief Volumes of a group of subsets
+ *
+ * Computes the volumes (areas, lengths, numbers of vertices for lower-dimensional
+ * subsets) of all subsets of a group in one pass over their surface elements
+ * and, in the parallel case, sums them up over all processes in a single reduction.
+ * Elements shared by several processes (horizontal interfaces) are only counted
+ * on the process holding the master copy.
+ *
+ * The volumes are cached until the grid is adapted or redistributed.
+ */
+template <typename TDomain>
+class SubsetVolumes
+{
+	public:
+		static const int worldDim = TDomain::dim;
+
+	public:
+		/// constructor with subset names (separated by commas)
+		SubsetVolumes(ConstSmartPtr<ApproximationSpace<TDomain> > approx, const char* subsetNames);
+
+		/// constructor with subset group
+		SubsetVolumes(ConstSmartPtr<ApproximationSpace<TDomain> > approx, const SubsetGroup& ssGrp);
+
+		/// subset group the volumes are computed for
+		const SubsetGroup& subset_group() const {return m_ssGrp;}
+
+		/// volumes of all subsets (in the order of the subset group)
+		const std::vector<number>& volumes();
+
+		/// volume of the i-th subset of the group
+		number volume(size_t i);
+
+		/// force re-computation on next access
+		void invalidate() {m_bValid = false;}
+
+	private:
+		void register_grid_callbacks();
+		void compute();
+
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	private:
+		ConstSmartPtr<ApproximationSpace<TDomain> > m_spApprox;
+		SubsetGroup m_ssGrp;
+
+		std::vector<number> m_vVol;
+		std::vector<number> m_vLocal;
+		bool m_bValid;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+};
+
+
 /**
  * \brief calculates the volume of a subset
  *
@@ -58,9 +121,8 @@ namespace neuro_collection {
  * \param subset   contains the subset index that the volume measurement
  *                 is to be performed for
  *
- * @todo In the parallel case:
- *       For lower-dimensional objects it is possible that some are accounted for
- *       more than once! --> master/slave layout !?
+ * In the parallel case, objects shared by several processes are counted once.
+ * Use SubsetVolumes for several subsets or repeated calls.
  */
 template <typename TDomain>
 number computeVolume(ConstSmartPtr<ApproximationSpace<TDomain> > approx, const int subset);
@@ -70,14 +132,11 @@ number computeVolume(ConstSmartPtr<ApproximationSpace<TDomain> > approx, const i
  * \brief outputs the volumes of chosen subsets
  *
  *	The result is written to the command line interface.
+ *	All subsets are computed in one pass (see SubsetVolumes).
  *
  * \param approx		the underlying approximation space
  * \param subsetNames	contains the names of the subsets that the volume measuring
  * 						is to be performed for, separated by commas
- *
- * @todo	In the parallel case:
- * 			For lower-dimensional objects it is possible that some are accounted for
- * 			more than once! --> master/slave layout !?
  */
 template <typename TDomain>
 void computeVolume
@@ -103,9 +162,7 @@ void computeVolume
  * 						as a suffix will be created
  * \param outFileName	the name of the output file(s), i.e. their prefix
  *
- * @todo	In the parallel case:
- * 			For lower-dimensional objects it is possible that some are accounted for
- * 			more than once! --> master/slave layout !?
+ * This is a one-time Measurement (see there).
  */
 
 template <typename TGridFunction>
@@ -129,6 +186,158 @@ number takeMeasurement
 	const char* outFileExt
 );
 
+
+/**
+ * \brief Repeated measurement of average values of unknowns on subsets
+ *
+ * This class does the same as takeMeasurement(), but is meant to be used
+ * in every time step of a simulation:
+ * - Subset volumes are computed only once and then cached until the grid
+ *   is adapted or redistributed.
+ * - All requested functions are integrated in one sweep over the elements
+ *   of each subset.
+ * - In the parallel case, all integrals (and volumes) are summed up over the
+ *   processes in a single reduction.
+ * - Output files are opened once and kept open (buffered) for the lifetime
+ *   of the object.
+ *
+ * The output files are named as those of takeMeasurement() and have the same format.
+ * As in takeMeasurement(), output files are created anew if the first measurement
+ * is taken at time 0 and appended to otherwise.
+ *
+ * Alternatively, all measurements can be written to one binary file
+ * (see set_binary_output()), which is written by a background thread
+ * and can be read using BinaryRecordReader.
+ *
+ * In the parallel case, elements shared by several processes (horizontal
+ * interfaces) only contribute on the process holding the master copy.
+ */
+template <typename TGridFunction>
+class Measurement
+{
+	public:
+		typedef typename TGridFunction::domain_type domain_type;
+		static const int worldDim = domain_type::dim;
+
+	public:
+		/**
+		 * \brief constructor
+		 *
+		 * \param solution		the grid function containing the unknowns
+		 * \param subsetNames	names of the subsets to measure on, separated by commas
+		 * \param functionNames	names of the functions to measure, separated by commas
+		 * \param outFileName	prefix of the output file names
+		 * \param outFileExt		suffix of the output file names
+		 */
+		Measurement
+		(
+			SmartPtr<TGridFunction> solution,
+			const char* subsetNames,
+			const char* functionNames,
+			const char* outFileName,
+			const char* outFileExt
+		);
+
+		/// constructor without output file extension
+		Measurement
+		(
+			SmartPtr<TGridFunction> solution,
+			const char* subsetNames,
+			const char* functionNames,
+			const char* outFileName
+		);
+
+		/// destructor (closes output files)
+		~Measurement();
+
+		/**
+		 * \brief take measurement for the current solution
+		 *
+		 * \param time	the simulation time the values are accorded to in the output files
+		 * \return		average value of the last function on the last subset
+		 *				(same as takeMeasurement())
+		 */
+		number take(number time);
+
+		/// average value of function fi on subset si as computed in the last measurement
+		number value(size_t si, size_t fi) const;
+
+		/// flush all output files
+		void flush();
+
+		/**
+		 * \brief write binary output instead of text files
+		 *
+		 * If enabled, all measurements are written to the single file
+		 * <outFileName><outFileExt>.bin (see AsyncRecordWriter).
+		 * Each record consists of the time followed by the averages for all
+		 * subset-function pairs (subset-major); the columns are named
+		 * "time" and "<subset>_<function>".
+		 * Must be called before the first measurement is taken.
+		 */
+		void set_binary_output(bool b);
+
+		/**
+		 * \brief write a compressed time series instead of text files
+		 *
+		 * If enabled, all measurements are written to the single file
+		 * <outFileName><outFileExt>.tsc (see CompressedSeriesWriter), each snapshot
+		 * consisting of the averages for all subset-function pairs (subset-major).
+		 * The file is completed when the measurement object is destroyed.
+		 * Must be called before the first measurement is taken.
+		 *
+		 * \param tolerance	absolute error bound for the averages (0 for lossless output)
+		 */
+		void set_compressed_output(number tolerance);
+
+	private:
+		void init(const char* subsetNames, const char* functionNames);
+
+		void open_files(number time);
+
+		/// integrate all functions (and possibly the volume) over one subset
+		template <int dim>
+		void integrate_subset(int si, number* vInt, number* pVol);
+
+		/// vertex subsets: sum over vertices (and count them)
+		void sum_on_vertices(int si, number* vInt, number* pVol);
+
+		void grid_adaption_callback(const GridMessage_Adaption& gma);
+		void grid_distribution_callback(const GridMessage_Distribution& gmd);
+
+	private:
+		SmartPtr<TGridFunction> m_spSol;
+		SubsetGroup m_ssGrp;
+		FunctionGroup m_fctGrp;
+
+		std::string m_outFileName;
+		std::string m_outFileExt;
+		std::vector<std::ofstream*> m_vOutFile;
+
+		bool m_bBinary;
+		SmartPtr<AsyncRecordWriter> m_spBinWriter;
+		std::vector<number> m_vRecord;
+
+		bool m_bCompressed;
+		number m_compTol;
+		SmartPtr<CompressedSeriesWriter> m_spCompWriter;
+
+		/// cached subset volumes
+		std::vector<number> m_vVol;
+		bool m_bVolValid;
+
+		/// averages of last measurement (subset-major)
+		std::vector<number> m_vAvg;
+
+		/// integration buffers
+		std::vector<number> m_vLocal;
+		std::vector<number> m_vGlobal;
+		std::vector<DoFIndex> m_vInd;
+
+		MessageHub::SPCallbackId m_spGridAdaptionCallbackID;
+		MessageHub::SPCallbackId m_spGridDistributionCallbackID;
+};
+
 ///@}
 
 } // namespace ug
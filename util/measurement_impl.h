@@ -40,8 +40,18 @@
 #include "measurement.h"
 
 #include "common/error.h"	// UG_THROW etc.
+#include "timeline_trace.h"	// NC_TRACE_SCOPE
 #include "lib_disc/function_spaces/integrate.h"	// IntegrateSubset
+#include "lib_disc/local_finite_element/local_finite_element_provider.h"	// LocalFiniteElementProvider
+#include "lib_disc/quadrature/quadrature_provider.h"	// QuadratureRuleProvider
+#include "lib_disc/reference_element/reference_mapping_provider.h"	// ReferenceMappingProvider
 
+#ifdef UG_PARALLEL
+	#include "lib_grid/parallelization/distributed_grid.h"	// DistributedGridManager
+#endif
+
+#include <iomanip>
+#include <limits>
 #include <sstream>
 
 
@@ -68,20 +78,30 @@ void collectVol
 	typedef typename domain_traits<dim>::grid_base_object Elem;
 	typedef typename DoFDistribution::template traits<Elem>::const_iterator iter_type;
 
+#ifdef UG_PARALLEL
+	const DistributedGridManager& dgm = *dofDistr->multi_grid()->distributed_grid_manager();
+#endif
+
 	//	get element iterator for current subset
 	iter_type iter = dofDistr->template begin<Elem>(si);
 	iter_type iterEnd = dofDistr->template end<Elem>(si);
 
 	// loop over all elements
+	std::vector<typename TDomain::position_type> coco;
 	for (; iter != iterEnd; ++iter)
 	{
 		// get current element
 		Elem* elem = *iter;
 
+#ifdef UG_PARALLEL
+		// do not count horizontal slaves in the parallel case to prevent double counting
+		if (dgm.get_status(elem) & ES_H_SLAVE)
+			continue;
+#endif
+
 		ReferenceObjectID roid = elem->reference_object_id();
 
 		// collect corner coords
-		std::vector<typename TDomain::position_type> coco;
 		CollectCornerCoordinates(coco, elem, aaPos, false);
 
 		vol += ElementSize<worldDim>(roid, &coco[0]);
@@ -90,41 +110,130 @@ void collectVol
 
 
 template <typename TDomain>
-number computeVolume(ConstSmartPtr<ApproximationSpace<TDomain> > approx, const int subset)
+SubsetVolumes<TDomain>::SubsetVolumes
+(
+	ConstSmartPtr<ApproximationSpace<TDomain> > approx,
+	const char* subsetNames
+)
+: m_spApprox(approx), m_bValid(false)
 {
-	const int worldDim = TDomain::dim;
+	UG_COND_THROW(!m_spApprox.valid(), "SubsetVolumes: Invalid approximation space given.");
 
-	ConstSmartPtr<DoFDistribution> dofDistr = approx->dof_distribution(GridLevel());
-	const typename TDomain::position_accessor_type& aaPos = approx->domain()->position_accessor();
+	try {m_ssGrp = m_spApprox->dof_distribution(GridLevel())->subset_grp_by_name(subsetNames);}
+	UG_CATCH_THROW("At least one of the subsets in '" << subsetNames
+					<< "' is not contained in the approximation space (or something else was wrong).");
+
+	register_grid_callbacks();
+}
 
-	// initialize result variable
-	number vol = 0.0;
 
-	// further implementation depends on dim
-	int dim = dofDistr->dim_subset(subset);
+template <typename TDomain>
+SubsetVolumes<TDomain>::SubsetVolumes
+(
+	ConstSmartPtr<ApproximationSpace<TDomain> > approx,
+	const SubsetGroup& ssGrp
+)
+: m_spApprox(approx), m_ssGrp(ssGrp), m_bValid(false)
+{
+	UG_COND_THROW(!m_spApprox.valid(), "SubsetVolumes: Invalid approximation space given.");
+	register_grid_callbacks();
+}
+
 
-	// collect volume
-	if (dim == worldDim)
-		collectVol<TDomain, worldDim>(dofDistr, aaPos, subset, vol);
-	else if (dim == worldDim-1 && worldDim >= 1)
-		collectVol<TDomain, worldDim>=1 ? worldDim-1 : 1>(dofDistr, aaPos, subset, vol);
-	else if (dim == worldDim-2 && worldDim >= 2)
-		collectVol<TDomain, worldDim>=2 ? worldDim-2 : 1>(dofDistr, aaPos, subset, vol);
-	else if (dim == worldDim-3 && worldDim >= 3)
-		collectVol<TDomain, worldDim>=3 ? worldDim-3 : 1>(dofDistr, aaPos, subset, vol);
-	else {UG_THROW("Unknown dim (" << dim << ") or worldDim (" << worldDim << ").");}
+template <typename TDomain>
+void SubsetVolumes<TDomain>::register_grid_callbacks()
+{
+	Grid& grid = *m_spApprox->domain()->grid();
+	m_spGridAdaptionCallbackID = grid.message_hub()->register_class_callback(this,
+		&SubsetVolumes<TDomain>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid.message_hub()->register_class_callback(this,
+		&SubsetVolumes<TDomain>::grid_distribution_callback);
+}
 
+
+template <typename TDomain>
+const std::vector<number>& SubsetVolumes<TDomain>::volumes()
+{
+	if (!m_bValid)
+		compute();
+	return m_vVol;
+}
+
+
+template <typename TDomain>
+number SubsetVolumes<TDomain>::volume(size_t i)
+{
+	UG_COND_THROW(i >= m_ssGrp.size(), "SubsetVolumes: Subset index " << i << " out of range.");
+	return volumes()[i];
+}
+
+
+template <typename TDomain>
+void SubsetVolumes<TDomain>::compute()
+{
+	NC_TRACE_SCOPE("SubsetVolumes::compute");
+
+	ConstSmartPtr<DoFDistribution> dofDistr = m_spApprox->dof_distribution(GridLevel());
+	const typename TDomain::position_accessor_type& aaPos = m_spApprox->domain()->position_accessor();
+
+	// collect local volumes of all subsets
+	const size_t nSs = m_ssGrp.size();
+	m_vLocal.assign(nSs, 0.0);
+	for (size_t i = 0; i < nSs; ++i)
+	{
+		const int si = m_ssGrp[i];
+		const int dim = dofDistr->dim_subset(si);
+		number& vol = m_vLocal[i];
+
+		if (dim == worldDim)
+			collectVol<TDomain, worldDim>(dofDistr, aaPos, si, vol);
+		else if (dim == worldDim-1 && worldDim >= 1)
+			collectVol<TDomain, worldDim>=1 ? worldDim-1 : 1>(dofDistr, aaPos, si, vol);
+		else if (dim == worldDim-2 && worldDim >= 2)
+			collectVol<TDomain, worldDim>=2 ? worldDim-2 : 1>(dofDistr, aaPos, si, vol);
+		else if (dim == worldDim-3 && worldDim >= 3)
+			collectVol<TDomain, worldDim>=3 ? worldDim-3 : 1>(dofDistr, aaPos, si, vol);
+		else {UG_THROW("Unknown dim (" << dim << ") or worldDim (" << worldDim << ").");}
+	}
+
+	// sum up volumes on all processes (all subsets at once)
+	m_vVol = m_vLocal;
 #ifdef UG_PARALLEL
-	if (pcl::NumProcs() > 1)
+	if (pcl::NumProcs() > 1 && nSs)
 	{
-		// sum up volumes and integrals on all processes
 		pcl::ProcessCommunicator com;
-		number local = vol;
-		com.allreduce(&local, &vol, 1, PCL_DT_DOUBLE, PCL_RO_SUM);
+		com.allreduce(&m_vLocal[0], &m_vVol[0], (int) nSs, PCL_DT_DOUBLE, PCL_RO_SUM);
 	}
 #endif
 
-	return vol;
+	m_bValid = true;
+}
+
+
+template <typename TDomain>
+void SubsetVolumes<TDomain>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		m_bValid = false;
+}
+
+
+template <typename TDomain>
+void SubsetVolumes<TDomain>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		m_bValid = false;
+}
+
+
+template <typename TDomain>
+number computeVolume(ConstSmartPtr<ApproximationSpace<TDomain> > approx, const int subset)
+{
+	SubsetGroup ssGrp(approx->domain()->subset_handler());
+	ssGrp.add(subset);
+
+	SubsetVolumes<TDomain> volumes(approx, ssGrp);
+	return volumes.volume(0);
 }
 
 
@@ -135,22 +244,16 @@ void computeVolume
 	const char* subsetNames
 )
 {
-	// retrieve domain, dofDistr and dim from approxSpace
-	ConstSmartPtr<TDomain> domain = approx->domain();
-	ConstSmartPtr<DoFDistribution> dofDistr = approx->dof_distribution(GridLevel());
-
-	// get subset group to be measured on
-	SubsetGroup ssGrp;
-	try {ssGrp = dofDistr->subset_grp_by_name(subsetNames);}
-	UG_CATCH_THROW("At least one of the subsets in '" << subsetNames
-					<< "' is not contained in the approximation space (or something else was wrong).");
+	// all subsets in one pass
+	SubsetVolumes<TDomain> volumes(approx, subsetNames);
+	const SubsetGroup& ssGrp = volumes.subset_group();
+	const std::vector<number>& vVol = volumes.volumes();
 
 	// loop subsets
 	UG_LOG("\n");
 	for (size_t si = 0; si < ssGrp.size(); si++)
 	{
-		// initialize measurement result variables
-		number vol = computeVolume(approx, ssGrp[si]);
+		number vol = vVol[si];
 
 		// subset dim
 		int dim = ssGrp.dim(si);
@@ -194,97 +297,385 @@ number takeMeasurement
 	const char* outFileExt
 )
 {
-	typedef typename TGridFunction::domain_type domain_type;
-	const int worldDim = domain_type::dim;
+	NC_TRACE_SCOPE("takeMeasurement");
+
+	// one-time measurement: all subsets and functions in one pass, one reduction
+	Measurement<TGridFunction> measurement(solution, subsetNames, functionNames, outFileName, outFileExt);
+	return measurement.take(time);
+}
+
+
+
+
+// ///////////////////////// //
+// repeated measurement class //
+// ///////////////////////// //
+
+template <typename TGridFunction>
+Measurement<TGridFunction>::Measurement
+(
+	SmartPtr<TGridFunction> solution,
+	const char* subsetNames,
+	const char* functionNames,
+	const char* outFileName,
+	const char* outFileExt
+)
+: m_spSol(solution), m_outFileName(outFileName), m_outFileExt(outFileExt),
+  m_bBinary(false), m_bCompressed(false), m_compTol(0.0), m_bVolValid(false)
+{
+	init(subsetNames, functionNames);
+}
+
+
+template <typename TGridFunction>
+Measurement<TGridFunction>::Measurement
+(
+	SmartPtr<TGridFunction> solution,
+	const char* subsetNames,
+	const char* functionNames,
+	const char* outFileName
+)
+: m_spSol(solution), m_outFileName(outFileName), m_outFileExt(""),
+  m_bBinary(false), m_bCompressed(false), m_compTol(0.0), m_bVolValid(false)
+{
+	init(subsetNames, functionNames);
+}
+
+
+template <typename TGridFunction>
+Measurement<TGridFunction>::~Measurement()
+{
+	for (size_t i = 0; i < m_vOutFile.size(); ++i)
+		delete m_vOutFile[i];
+}
+
 
-	// retrieve approximation space, domain, dofDistr and dim from grid function
-	ConstSmartPtr<ApproximationSpace<domain_type> > approx = solution->approx_space();
+template <typename TGridFunction>
+void Measurement<TGridFunction>::init(const char* subsetNames, const char* functionNames)
+{
+	UG_COND_THROW(!m_spSol.valid(), "Measurement: Invalid solution given.");
 
-	// get subset group to be measured on
-	SubsetGroup ssGrp;
-	try {ssGrp = solution->subset_grp_by_name(subsetNames);}
+	try {m_ssGrp = m_spSol->subset_grp_by_name(subsetNames);}
 	UG_CATCH_THROW("At least one of the subsets in '" << subsetNames
 					<< "' is not contained in the approximation space (or something else was wrong).");
 
-	// get function group to be measured
-	FunctionGroup fctGrp;
-	try {fctGrp = solution->fct_grp_by_name(functionNames);}
+	try {m_fctGrp = m_spSol->fct_grp_by_name(functionNames);}
 	UG_CATCH_THROW("At least one of the functions in '" << functionNames
 					<< "' is not contained in the approximation space (or something else was wrong).");
 
-	number value = 0.0;
-	number vol = 0.0;
+	m_vVol.assign(m_ssGrp.size(), 0.0);
+	m_vAvg.assign(m_ssGrp.size() * m_fctGrp.size(), 0.0);
 
-	// loop subsets
-	for (size_t si = 0; si < ssGrp.size(); si++)
+	Grid& grid = *m_spSol->approx_space()->domain()->grid();
+	m_spGridAdaptionCallbackID = grid.message_hub()->register_class_callback(this,
+		&Measurement<TGridFunction>::grid_adaption_callback);
+	m_spGridDistributionCallbackID = grid.message_hub()->register_class_callback(this,
+		&Measurement<TGridFunction>::grid_distribution_callback);
+}
+
+
+template <typename TGridFunction>
+template <int dim>
+void Measurement<TGridFunction>::integrate_subset(int si, number* vInt, number* pVol)
+{
+	typedef typename domain_traits<dim>::grid_base_object Elem;
+	typedef typename TGridFunction::template traits<Elem>::const_iterator iter_type;
+
+	const typename domain_type::position_accessor_type& aaPos
+		= m_spSol->approx_space()->domain()->position_accessor();
+	const TGridFunction& u = *m_spSol;
+	const size_t nFct = m_fctGrp.size();
+
+	std::vector<MathVector<worldDim> > vCorner;
+	std::vector<number> vDetJ;
+	std::vector<number> vShape;
+
+#ifdef UG_PARALLEL
+	const DistributedGridManager& dgm = *u.dof_distribution()->multi_grid()->distributed_grid_manager();
+#endif
+
+	iter_type iter = u.template begin<Elem>(si);
+	iter_type iterEnd = u.template end<Elem>(si);
+	for (; iter != iterEnd; ++iter)
 	{
-		vol = computeVolume(approx, ssGrp[si]);
+		Elem* elem = *iter;
 
-		int dim = ssGrp.dim(si);
+#ifdef UG_PARALLEL
+		// do not count horizontal slaves in the parallel case to prevent double counting
+		if (dgm.get_status(elem) & ES_H_SLAVE)
+			continue;
+#endif
 
-		// loop functions
-		for (size_t fi = 0; fi < fctGrp.size(); fi++)
-		{
+		const ReferenceObjectID roid = elem->reference_object_id();
+		CollectCornerCoordinates(vCorner, elem, aaPos, false);
 
-			// special case for vertex
-			if (dim == 0)
-			{
-				value = StdFuncIntegralOnVertex(solution, fctGrp[fi], ssGrp[si]);
-			}
-			else
-			{
-				SmartPtr<IIntegrand<number, TGridFunction::dim> > spIntegrand
-					= make_sp(new StdFuncIntegrand<TGridFunction>(solution.get(), fctGrp[fi]));
-
-				if (dim == worldDim)
-					value = IntegrateSubset<TGridFunction, worldDim>(*spIntegrand, *solution, ssGrp[si], 1, "best");
-				else if (dim == worldDim-1 && worldDim > 1)
-					value = IntegrateSubset<TGridFunction, (worldDim>1 ? worldDim-1 : 1)>(*spIntegrand, *solution, ssGrp[si], 1, "best");
-				else if (dim == worldDim-2 && worldDim > 2)
-					value = IntegrateSubset<TGridFunction, (worldDim>2 ? worldDim-2 : 1)>(*spIntegrand, *solution, ssGrp[si], 1, "best");
-				else {UG_THROW("Unknown dim (" << dim << ") or worldDim (" << worldDim << ").");}
-			}
-		#ifdef UG_PARALLEL
-			// sum over processes
-			if (pcl::NumProcs() > 1)
+		if (pVol)
+			*pVol += ElementSize<worldDim>(roid, &vCorner[0]);
+
+		// integration points and their weights (same for all functions)
+		const QuadratureRule<dim>& rQuad = QuadratureRuleProvider<dim>::get(roid, 1);
+		const size_t nIP = rQuad.size();
+		DimReferenceMapping<dim, worldDim>& rMapping
+			= ReferenceMappingProvider::get<dim, worldDim>(roid, &vCorner[0]);
+		vDetJ.resize(nIP);
+		rMapping.sqrt_gram_det(&vDetJ[0], rQuad.points(), nIP);
+
+		// integrate all functions
+		for (size_t fi = 0; fi < nFct; ++fi)
+		{
+			const size_t fct = m_fctGrp[fi];
+			const LocalShapeFunctionSet<dim>& rTrial
+				= LocalFiniteElementProvider::get<dim>(roid, u.local_finite_element_id(fct));
+			u.dof_indices(elem, fct, m_vInd);
+			const size_t nSh = m_vInd.size();
+			vShape.resize(rTrial.num_sh());
+			UG_ASSERT(nSh == vShape.size(), "Number of DoFs (" << nSh
+				<< ") does not match number of shape functions (" << vShape.size() << ").");
+
+			number integral = 0.0;
+			for (size_t ip = 0; ip < nIP; ++ip)
 			{
-				pcl::ProcessCommunicator com;
-				number local = value;
-				com.allreduce(&local, &value, 1, PCL_DT_DOUBLE, PCL_RO_SUM);
+				rTrial.shapes(&vShape[0], rQuad.point(ip));
+				number val = 0.0;
+				for (size_t sh = 0; sh < nSh; ++sh)
+					val += DoFRef(u, m_vInd[sh]) * vShape[sh];
+				integral += val * rQuad.weight(ip) * vDetJ[ip];
 			}
+			vInt[fi] += integral;
+		}
+	}
+}
 
-			// check if this proc is output proc
-			if (GetLogAssistant().is_output_process())
-			{
-		#endif
 
+template <typename TGridFunction>
+void Measurement<TGridFunction>::sum_on_vertices(int si, number* vInt, number* pVol)
+{
+	typedef typename TGridFunction::template traits<Vertex>::const_iterator iter_type;
+
+	const TGridFunction& u = *m_spSol;
+	const size_t nFct = m_fctGrp.size();
+
+#ifdef UG_PARALLEL
+	const DistributedGridManager& dgm = *u.dof_distribution()->multi_grid()->distributed_grid_manager();
+#endif
+
+	iter_type iter = u.template begin<Vertex>(si);
+	iter_type iterEnd = u.template end<Vertex>(si);
+	for (; iter != iterEnd; ++iter)
+	{
+#ifdef UG_PARALLEL
+		// do not count horizontal slaves in the parallel case to prevent double counting
+		if (dgm.get_status(*iter) & ES_H_SLAVE)
+			continue;
+#endif
+
+		if (pVol) *pVol += 1.0;
+		for (size_t fi = 0; fi < nFct; ++fi)
+		{
+			u.inner_dof_indices(*iter, m_fctGrp[fi], m_vInd);
+			for (size_t k = 0; k < m_vInd.size(); ++k)
+				vInt[fi] += DoFRef(u, m_vInd[k]);
+		}
+	}
+}
+
+
+template <typename TGridFunction>
+void Measurement<TGridFunction>::open_files(number time)
+{
+	const size_t nSs = m_ssGrp.size();
+	const size_t nFct = m_fctGrp.size();
+
+	if (m_bCompressed)
+	{
+		std::vector<std::string> vColName;
+		for (size_t si = 0; si < nSs; ++si)
+			for (size_t fi = 0; fi < nFct; ++fi)
+				vColName.push_back(std::string(m_ssGrp.name(si)) + "_" + m_fctGrp.name(fi));
+
+		const std::string fileName = m_outFileName + m_outFileExt + ".tsc";
+		try {m_spCompWriter = make_sp(new CompressedSeriesWriter(fileName, std::vector<number>(), 0,
+			nSs*nFct, vColName, m_compTol));}
+		UG_CATCH_THROW("Compressed output file " << fileName << " could not be opened.");
+		return;
+	}
+
+	if (m_bBinary)
+	{
+		std::vector<std::string> vColName(1, "time");
+		for (size_t si = 0; si < nSs; ++si)
+			for (size_t fi = 0; fi < nFct; ++fi)
+				vColName.push_back(std::string(m_ssGrp.name(si)) + "_" + m_fctGrp.name(fi));
+
+		const std::string fileName = m_outFileName + m_outFileExt + ".bin";
+		try {m_spBinWriter = make_sp(new AsyncRecordWriter(fileName, vColName, time != 0.0));}
+		UG_CATCH_THROW("Binary output file " << fileName << " could not be opened.");
+		m_vRecord.resize(nSs*nFct + 1);
+		return;
+	}
+
+	m_vOutFile.resize(nSs * nFct, NULL);
+	for (size_t si = 0; si < nSs; ++si)
+	{
+		for (size_t fi = 0; fi < nFct; ++fi)
+		{
 			// construct outFile name
-			std::ostringstream ofnss(outFileName, std::ios_base::app);
-			ofnss << "_" << ssGrp.name(si) << "_" << fctGrp.name(fi) << outFileExt;
+			std::ostringstream ofnss(m_outFileName, std::ios_base::app);
+			ofnss << "_" << m_ssGrp.name(si) << "_" << m_fctGrp.name(fi) << m_outFileExt;
 
 			// create if first time step, append otherwise
-			std::ofstream outFile;
-			if (time == 0.0) outFile.open(ofnss.str().c_str(), std::ios_base::out);
-			else outFile.open(ofnss.str().c_str(), std::ios_base::app);
+			std::ofstream* pFile = new std::ofstream();
+			m_vOutFile[si*nFct + fi] = pFile;
+			if (time == 0.0) pFile->open(ofnss.str().c_str(), std::ios_base::out);
+			else pFile->open(ofnss.str().c_str(), std::ios_base::app);
+			UG_COND_THROW(!pFile->is_open(), "Output file " << ofnss.str() << " could not be opened.");
 
 			// set precision
-			outFile << std::setprecision(std::numeric_limits<number>::digits10 + 1);
+			*pFile << std::setprecision(std::numeric_limits<number>::digits10 + 1);
+		}
+	}
+}
 
-			// write measurement
-			try {outFile << time << "\t" << value/vol << "\n";}
-			UG_CATCH_THROW("Output file " << ofnss.str() << " could not be written to.");
-			outFile.close();
 
-		#ifdef UG_PARALLEL
-			}
-		#endif
-		}
+template <typename TGridFunction>
+number Measurement<TGridFunction>::take(number time)
+{
+	NC_TRACE_SCOPE("Measurement::take");
+
+	const size_t nSs = m_ssGrp.size();
+	const size_t nFct = m_fctGrp.size();
+	const bool bVol = !m_bVolValid;
+
+	// integrals (subset-major), followed by volumes if they are to be computed
+	const size_t nVal = nSs*nFct + (bVol ? nSs : 0);
+	m_vLocal.assign(nVal, 0.0);
+	for (size_t si = 0; si < nSs; ++si)
+	{
+		number* vInt = &m_vLocal[si*nFct];
+		number* pVol = bVol ? &m_vLocal[nSs*nFct + si] : NULL;
+
+		const int dim = m_ssGrp.dim(si);
+		if (dim == 0)
+			sum_on_vertices(m_ssGrp[si], vInt, pVol);
+		else if (dim == worldDim)
+			integrate_subset<worldDim>(m_ssGrp[si], vInt, pVol);
+		else if (dim == worldDim-1 && worldDim > 1)
+			integrate_subset<(worldDim>1 ? worldDim-1 : 1)>(m_ssGrp[si], vInt, pVol);
+		else if (dim == worldDim-2 && worldDim > 2)
+			integrate_subset<(worldDim>2 ? worldDim-2 : 1)>(m_ssGrp[si], vInt, pVol);
+		else {UG_THROW("Unknown dim (" << dim << ") or worldDim (" << worldDim << ").");}
+	}
+
+	// sum over processes (all values at once)
+	m_vGlobal = m_vLocal;
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1 && nVal)
+	{
+		pcl::ProcessCommunicator com;
+		com.allreduce(&m_vLocal[0], &m_vGlobal[0], (int) nVal, PCL_DT_DOUBLE, PCL_RO_SUM);
+	}
+#endif
+
+	if (bVol)
+	{
+		for (size_t si = 0; si < nSs; ++si)
+			m_vVol[si] = m_vGlobal[nSs*nFct + si];
+		m_bVolValid = true;
+	}
+
+	for (size_t si = 0; si < nSs; ++si)
+		for (size_t fi = 0; fi < nFct; ++fi)
+			m_vAvg[si*nFct + fi] = m_vGlobal[si*nFct + fi] / m_vVol[si];
+
+	// write measurements
+#ifdef UG_PARALLEL
+	if (GetLogAssistant().is_output_process())
+	{
+#endif
+	if (m_vOutFile.empty() && !m_spBinWriter.valid() && !m_spCompWriter.valid())
+		open_files(time);
+
+	if (m_bCompressed)
+	{
+		try {m_spCompWriter->write(time, m_vAvg);}
+		UG_CATCH_THROW("Compressed output file " << m_spCompWriter->file_name() << " could not be written to.");
+	}
+	else if (m_bBinary)
+	{
+		m_vRecord[0] = time;
+		for (size_t k = 0; k < nSs*nFct; ++k)
+			m_vRecord[k+1] = m_vAvg[k];
+		try {m_spBinWriter->write(m_vRecord);}
+		UG_CATCH_THROW("Binary output file " << m_spBinWriter->file_name() << " could not be written to.");
+	}
+	else for (size_t k = 0; k < nSs*nFct; ++k)
+	{
+		*m_vOutFile[k] << time << "\t" << m_vAvg[k] << "\n";
+		UG_COND_THROW(!m_vOutFile[k]->good(), "Output file for subset '" << m_ssGrp.name(k / nFct)
+			<< "' and function '" << m_fctGrp.name(k % nFct) << "' could not be written to.");
 	}
+#ifdef UG_PARALLEL
+	}
+#endif
+
+	return m_vAvg.empty() ? 0.0 : m_vAvg.back();
+}
+
+
+template <typename TGridFunction>
+number Measurement<TGridFunction>::value(size_t si, size_t fi) const
+{
+	UG_COND_THROW(si >= m_ssGrp.size() || fi >= m_fctGrp.size(),
+		"Measurement: Subset index " << si << " or function index " << fi << " out of range.");
+	return m_vAvg[si*m_fctGrp.size() + fi];
+}
+
+
+template <typename TGridFunction>
+void Measurement<TGridFunction>::flush()
+{
+	for (size_t i = 0; i < m_vOutFile.size(); ++i)
+		m_vOutFile[i]->flush();
+	if (m_spBinWriter.valid())
+		m_spBinWriter->flush();
+}
+
+
+template <typename TGridFunction>
+void Measurement<TGridFunction>::set_binary_output(bool b)
+{
+	UG_COND_THROW(!m_vOutFile.empty() || m_spBinWriter.valid() || m_spCompWriter.valid(),
+		"Measurement: Output format cannot be changed after the first measurement.");
+	m_bBinary = b;
+}
+
+
+template <typename TGridFunction>
+void Measurement<TGridFunction>::set_compressed_output(number tolerance)
+{
+	UG_COND_THROW(!m_vOutFile.empty() || m_spBinWriter.valid() || m_spCompWriter.valid(),
+		"Measurement: Output format cannot be changed after the first measurement.");
+	UG_COND_THROW(tolerance < 0.0, "Measurement: Tolerance must not be negative.");
+	m_bCompressed = true;
+	m_compTol = tolerance;
+}
 
-	return value/vol;
+
+template <typename TGridFunction>
+void Measurement<TGridFunction>::grid_adaption_callback(const GridMessage_Adaption& gma)
+{
+	if (gma.adaption_ends())
+		m_bVolValid = false;
 }
 
 
+template <typename TGridFunction>
+void Measurement<TGridFunction>::grid_distribution_callback(const GridMessage_Distribution& gmd)
+{
+	if (gmd.msg() == GMDT_DISTRIBUTION_STOPS)
+		m_bVolValid = false;
+}
+
 
 } // namespace ug
 } // namespace neuro_collection
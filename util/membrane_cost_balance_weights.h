@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__MEMBRANE_COST_BALANCE_WEIGHTS_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__MEMBRANE_COST_BALANCE_WEIGHTS_H
+
+#ifdef UG_PARALLEL
+
+#include "common/util/smart_pointer.h"                // for SmartPtr
+#include "lib_disc/domain_traits.h"                   // for domain_traits
+#include "lib_grid/grid/grid.h"                       // for Grid::AttachmentAccessor
+#include "lib_grid/parallelization/load_balancer.h"   // for IBalanceWeights
+#include "../membrane_transport_fv1.h"                // for MembraneTransportFV1
+
+#include <cstddef>                                    // for size_t
+#include <vector>                                     // for vector
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Balance weights accounting for the cost of membrane transport assembling
+ *
+ * Elements adjacent to membranes carrying expensive transport mechanisms (RyR, VDCC,
+ * Hodgkin-Huxley, ...) are considerably more expensive to assemble than bulk elements.
+ * With uniform weights, processes owning much of the membrane become stragglers.
+ * This class assigns every element of full dimension a weight
+ *     bulk cost + cost of its subset + sum over its sides of (side subset cost / #elements sharing the side),
+ * which can be handed to the partitioner (e.g. via set_balance_weights() of the Parmetis partitioner).
+ *
+ * Subset costs are either set explicitly or taken from the registered membrane transport
+ * discretizations, which report the relative cost of the transport mechanism they use
+ * (see IMembraneTransporter::element_cost()).
+ * In measured mode, the costs of the discretizations are instead derived from the time
+ * they spent in flux evaluations over the last time steps
+ * (see MembraneTransportFV1::set_cost_measurement()).
+ *
+ * Weights are computed in refresh_weights(), which is called by the load balancer before
+ * each partitioning.
+ */
+template <typename TDomain>
+class MembraneCostBalanceWeights
+: public IBalanceWeights
+{
+	public:
+		static const int dim = TDomain::dim;
+		typedef typename domain_traits<dim>::grid_base_object elem_type;
+		typedef typename elem_type::side side_type;
+
+	public:
+		/// constructor
+		MembraneCostBalanceWeights(SmartPtr<TDomain> dom);
+
+		/// destructor
+		virtual ~MembraneCostBalanceWeights();
+
+		/// set the weight of a bulk element (default: 1)
+		void set_bulk_cost(number cost);
+
+		/// set an additional cost for all elements (or element sides) of the given subsets
+		void set_subset_cost(const char* subsets, number cost);
+
+		/// take the membrane costs from a membrane transport discretization
+		void add_membrane_transport(SmartPtr<MembraneTransportFV1<TDomain> > disc);
+
+		/**
+		 * @brief Use measured flux evaluation times instead of cost estimates
+		 *
+		 * The cost of a membrane side is its number of corners (integration points) times
+		 * the measured time per flux evaluation divided by the time a bulk element takes.
+		 * Discretizations without measurements keep their estimated cost.
+		 *
+		 * @param bulkTimePerElem  assembling time (in s) of a bulk element; non-positive values
+		 *                         switch measured mode off
+		 */
+		void set_measured_costs(number bulkTimePerElem);
+
+		// inherited from IBalanceWeights
+		virtual void refresh_weights(int baseLevel);
+		virtual number get_weight(Vertex* e) {return weight(e);}
+		virtual number get_weight(Edge* e) {return weight(e);}
+		virtual number get_weight(Face* e) {return weight(e);}
+		virtual number get_weight(Volume* e) {return weight(e);}
+
+	protected:
+		/// resolve subset names to indices
+		void subset_indices(std::vector<int>& vSI, const std::vector<std::string>& vSubset) const;
+
+		/// compute cost per subset (fixed part and part per side corner)
+		void update_subset_costs();
+
+		number weight(elem_type* e) {return m_aaWeight[e];}
+		number weight(GridObject*) {return 1.0;}
+
+	protected:
+		SmartPtr<TDomain> m_spDom;
+
+		number m_bulkCost;
+		std::vector<number> m_vUserCost;  ///< explicitly set cost per subset
+
+		std::vector<SmartPtr<MembraneTransportFV1<TDomain> > > m_vDisc;
+		std::vector<std::vector<int> > m_vDiscSI;  ///< subset indices of each disc
+
+		number m_bulkTime;  ///< bulk element time for measured mode (non-positive: estimates)
+
+		std::vector<number> m_vCost;           ///< per subset: fixed cost per element
+		std::vector<number> m_vCostPerCorner;  ///< per subset: cost per element corner
+
+		ANumber m_aWeight;
+		Grid::AttachmentAccessor<elem_type, ANumber> m_aaWeight;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "membrane_cost_balance_weights_impl.h"
+
+#endif // UG_PARALLEL
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__MEMBRANE_COST_BALANCE_WEIGHTS_H
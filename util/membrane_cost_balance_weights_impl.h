@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "membrane_cost_balance_weights.h"
+
+#include "common/error.h"                   // for UG_COND_THROW
+#include "common/util/string_util.h"        // for TokenizeTrimString
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TDomain>
+MembraneCostBalanceWeights<TDomain>::MembraneCostBalanceWeights(SmartPtr<TDomain> dom)
+: m_spDom(dom), m_bulkCost(1.0), m_bulkTime(0.0)
+{
+	UG_COND_THROW(!m_spDom.valid(), "No valid domain given.");
+
+	MultiGrid& mg = *m_spDom->grid();
+	mg.attach_to<elem_type>(m_aWeight);
+	m_aaWeight.access(mg, m_aWeight);
+}
+
+
+template <typename TDomain>
+MembraneCostBalanceWeights<TDomain>::~MembraneCostBalanceWeights()
+{
+	MultiGrid& mg = *m_spDom->grid();
+	if (mg.has_attachment<elem_type>(m_aWeight))
+		mg.detach_from<elem_type>(m_aWeight);
+}
+
+
+template <typename TDomain>
+void MembraneCostBalanceWeights<TDomain>::set_bulk_cost(number cost)
+{
+	UG_COND_THROW(cost < 0.0, "Bulk cost must not be negative.");
+	m_bulkCost = cost;
+}
+
+
+template <typename TDomain>
+void MembraneCostBalanceWeights<TDomain>::set_subset_cost(const char* subsets, number cost)
+{
+	std::vector<int> vSI;
+	subset_indices(vSI, TokenizeTrimString(subsets));
+
+	for (size_t i = 0; i < vSI.size(); ++i)
+	{
+		if ((size_t) vSI[i] >= m_vUserCost.size())
+			m_vUserCost.resize(vSI[i] + 1, 0.0);
+		m_vUserCost[vSI[i]] = cost;
+	}
+}
+
+
+template <typename TDomain>
+void MembraneCostBalanceWeights<TDomain>::add_membrane_transport
+(
+	SmartPtr<MembraneTransportFV1<TDomain> > disc
+)
+{
+	UG_COND_THROW(!disc.valid(), "Invalid membrane transport discretization given.");
+
+	m_vDisc.push_back(disc);
+	m_vDiscSI.resize(m_vDiscSI.size() + 1);
+	subset_indices(m_vDiscSI.back(), disc->symb_subsets());
+}
+
+
+template <typename TDomain>
+void MembraneCostBalanceWeights<TDomain>::set_measured_costs(number bulkTimePerElem)
+{
+	m_bulkTime = bulkTimePerElem;
+}
+
+
+template <typename TDomain>
+void MembraneCostBalanceWeights<TDomain>::subset_indices
+(
+	std::vector<int>& vSI,
+	const std::vector<std::string>& vSubset
+) const
+{
+	ConstSmartPtr<ISubsetHandler> sh = m_spDom->subset_handler();
+
+	vSI.clear();
+	for (size_t i = 0; i < vSubset.size(); ++i)
+	{
+		const int si = sh->get_subset_index(vSubset[i].c_str());
+		UG_COND_THROW(si < 0, "Subset '" << vSubset[i] << "' not found in domain.");
+		vSI.push_back(si);
+	}
+}
+
+
+template <typename TDomain>
+void MembraneCostBalanceWeights<TDomain>::update_subset_costs()
+{
+	const size_t nSubsets = (size_t) m_spDom->subset_handler()->num_subsets();
+
+	m_vCost.assign(nSubsets, 0.0);
+	m_vCostPerCorner.assign(nSubsets, 0.0);
+	for (size_t si = 0; si < nSubsets && si < m_vUserCost.size(); ++si)
+		m_vCost[si] = m_vUserCost[si];
+
+	for (size_t d = 0; d < m_vDisc.size(); ++d)
+	{
+		const number t = m_bulkTime > 0.0 ? m_vDisc[d]->measured_time_per_evaluation() : -1.0;
+		const number cost = m_vDisc[d]->element_cost();
+
+		const std::vector<int>& vSI = m_vDiscSI[d];
+		for (size_t i = 0; i < vSI.size(); ++i)
+		{
+			if ((size_t) vSI[i] >= nSubsets)
+				continue;
+
+			if (t > 0.0)
+				m_vCostPerCorner[vSI[i]] += t / m_bulkTime;
+			else
+				m_vCost[vSI[i]] += cost;
+		}
+	}
+}
+
+
+template <typename TDomain>
+void MembraneCostBalanceWeights<TDomain>::refresh_weights(int baseLevel)
+{
+	update_subset_costs();
+
+	MultiGrid& mg = *m_spDom->grid();
+	ConstSmartPtr<MGSubsetHandler> sh = m_spDom->subset_handler();
+	const size_t nSubsets = m_vCost.size();
+
+	// bulk and element subset costs
+	typedef typename geometry_traits<elem_type>::iterator elem_iter;
+	elem_iter itEnd = mg.template end<elem_type>();
+	for (elem_iter it = mg.template begin<elem_type>(); it != itEnd; ++it)
+	{
+		elem_type* e = *it;
+		const int si = sh->get_subset_index(e);
+		m_aaWeight[e] = m_bulkCost;
+		if (si >= 0 && (size_t) si < nSubsets)
+			m_aaWeight[e] += m_vCost[si] + m_vCostPerCorner[si] * e->num_vertices();
+	}
+
+	// membrane costs are distributed among the elements sharing the side
+	typename Grid::traits<elem_type>::secure_container assElems;
+	typedef typename geometry_traits<side_type>::iterator side_iter;
+	side_iter sideItEnd = mg.template end<side_type>();
+	for (side_iter it = mg.template begin<side_type>(); it != sideItEnd; ++it)
+	{
+		side_type* side = *it;
+		const int si = sh->get_subset_index(side);
+		if (si < 0 || (size_t) si >= nSubsets)
+			continue;
+
+		const number cost = m_vCost[si] + m_vCostPerCorner[si] * side->num_vertices();
+		if (cost == 0.0)
+			continue;
+
+		mg.associated_elements(assElems, side);
+		const size_t nElems = assElems.size();
+		for (size_t i = 0; i < nElems; ++i)
+			m_aaWeight[assElems[i]] += cost / nElems;
+	}
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "memory_accounting.h"
+
+#include <algorithm>                                          // for std::find, std::sort, std::min, std::max
+#include <iomanip>                                            // for std::setw
+#include <sstream>                                            // for ostringstream, istringstream
+
+#include "common/log.h"                                       // for UG_LOG
+#include "lib_grid/global_attachments.h"                      // for GlobalAttachments
+#include "lib_grid/refinement/projectors/neurite_projector.h" // for NeuriteProjector
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_base.h"                                 // for NumProcs, ProcRank
+	#include "pcl/pcl_process_communicator.h"                 // for ProcessCommunicator
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <sys/resource.h>                                 // for getrusage
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+namespace {
+
+std::vector<IMemoryReporter*>& registered_reporters()
+{
+	static std::vector<IMemoryReporter*> vReporter;
+	return vReporter;
+}
+
+
+/// local memory: bytes per owner and item
+typedef std::pair<std::string, std::string> row_label;
+typedef std::map<row_label, size_t> local_memory;
+
+void collect_local_memory(local_memory& mem, size_t& total)
+{
+	mem.clear();
+	total = 0;
+	const std::vector<IMemoryReporter*>& vReporter = registered_reporters();
+	for (size_t i = 0; i < vReporter.size(); ++i)
+	{
+		MemoryReport rep;
+		vReporter[i]->report_memory(rep);
+		const std::string owner = vReporter[i]->memory_owner_name();
+		const std::vector<MemoryReport::item_type>& vItem = rep.items();
+		for (size_t j = 0; j < vItem.size(); ++j)
+		{
+			mem[row_label(owner, vItem[j].first)] += vItem[j].second;
+			total += vItem[j].second;
+		}
+	}
+}
+
+
+size_t peak_rss_bytes()
+{
+#if defined(__unix__) || defined(__APPLE__)
+	struct rusage ru;
+	if (getrusage(RUSAGE_SELF, &ru))
+		return 0;
+	#ifdef __APPLE__
+	return (size_t) ru.ru_maxrss;  // in bytes
+	#else
+	return (size_t) ru.ru_maxrss * 1024;  // in kB
+	#endif
+#else
+	return 0;
+#endif
+}
+
+
+struct ReportRow
+{
+	ReportRow() : min(0), max(0), sum(0), numProcs(0), maxProc(0) {}
+	row_label label;
+	size_t min;
+	size_t max;
+	size_t sum;
+	int numProcs;  ///< number of processes having this row
+	int maxProc;
+};
+
+bool by_max_size(const ReportRow& a, const ReportRow& b)
+{
+	return a.max > b.max;
+}
+
+
+std::string format_bytes(size_t bytes)
+{
+	std::ostringstream oss;
+	oss.precision(1);
+	oss << std::fixed;
+	if (bytes >= ((size_t) 1 << 30))
+		oss << (double) bytes / ((size_t) 1 << 30) << " GiB";
+	else if (bytes >= ((size_t) 1 << 20))
+		oss << (double) bytes / ((size_t) 1 << 20) << " MiB";
+	else if (bytes >= ((size_t) 1 << 10))
+		oss << (double) bytes / ((size_t) 1 << 10) << " KiB";
+	else
+		oss << bytes << " B";
+	return oss.str();
+}
+
+
+/// gather the local memory of all processes on process 0 and print it there
+void print_reduced_memory(const local_memory& mem, const std::string& title)
+{
+	// serialize local rows
+	std::ostringstream oss;
+	for (local_memory::const_iterator it = mem.begin(); it != mem.end(); ++it)
+		oss << it->first.first << '\t' << it->first.second << '\t' << it->second << '\n';
+	oss << "process\tpeak resident set size\t" << peak_rss_bytes() << '\n';
+
+	const std::string loc = oss.str();
+	std::vector<char> vLoc(loc.begin(), loc.end());
+	std::vector<char> vAll;
+	std::vector<int> vSize;
+	int numProcs = 1;
+	int rank = 0;
+#ifdef UG_PARALLEL
+	numProcs = pcl::NumProcs();
+	rank = pcl::ProcRank();
+	if (numProcs > 1)
+	{
+		pcl::ProcessCommunicator com;
+		com.gatherv(vAll, vLoc, 0, &vSize, NULL);
+	}
+	else
+#endif
+	{
+		vAll.swap(vLoc);
+		vSize.assign(1, (int) vAll.size());
+	}
+
+	if (rank != 0)
+		return;
+
+	// reduce rows over processes
+	std::map<row_label, ReportRow> mRow;
+	size_t offset = 0;
+	for (size_t p = 0; p < vSize.size(); ++p)
+	{
+		std::istringstream iss(std::string(vAll.begin() + offset, vAll.begin() + offset + vSize[p]));
+		offset += vSize[p];
+
+		std::string owner, item;
+		size_t bytes;
+		while (std::getline(iss, owner, '\t') && std::getline(iss, item, '\t') && iss >> bytes)
+		{
+			iss.ignore(1);
+			ReportRow& row = mRow[row_label(owner, item)];
+			row.label = row_label(owner, item);
+			if (!row.numProcs || bytes < row.min)
+				row.min = bytes;
+			if (!row.numProcs || bytes > row.max)
+			{
+				row.max = bytes;
+				row.maxProc = (int) p;
+			}
+			row.sum += bytes;
+			++row.numProcs;
+		}
+	}
+
+	std::vector<ReportRow> vRow;
+	for (std::map<row_label, ReportRow>::iterator it = mRow.begin(); it != mRow.end(); ++it)
+	{
+		// processes without this row hold nothing
+		if (it->second.numProcs < numProcs)
+			it->second.min = 0;
+		vRow.push_back(it->second);
+	}
+	std::sort(vRow.begin(), vRow.end(), by_max_size);
+
+	std::ostringstream out;
+	out << title << " (" << numProcs << " process(es)):\n";
+	out << std::left << std::setw(32) << "owner" << std::setw(36) << "item" << std::right
+		<< std::setw(14) << "min" << std::setw(14) << "max" << std::setw(10) << "max proc"
+		<< std::setw(14) << "sum" << "\n";
+	for (size_t i = 0; i < vRow.size(); ++i)
+	{
+		const ReportRow& r = vRow[i];
+		out << std::left << std::setw(32) << r.label.first << std::setw(36) << r.label.second << std::right
+			<< std::setw(14) << format_bytes(r.min) << std::setw(14) << format_bytes(r.max)
+			<< std::setw(10) << r.maxProc << std::setw(14) << format_bytes(r.sum) << "\n";
+	}
+	UG_LOG(out.str());
+}
+
+
+/// peak snapshot of this process
+struct MemoryPeak
+{
+	MemoryPeak() : total(0) {}
+	local_memory mem;
+	size_t total;
+};
+
+MemoryPeak& memory_peak()
+{
+	static MemoryPeak peak;
+	return peak;
+}
+
+
+/// reports a grid and the global attachments of the plugin on it
+class GridMemoryReporter : public IMemoryReporter
+{
+	public:
+		GridMemoryReporter(SmartPtr<MultiGrid> mg, const std::string& name)
+		: m_spMG(mg), m_name(name) {}
+
+		virtual std::string memory_owner_name() const {return m_name;}
+
+		virtual void report_memory(MemoryReport& rep) const
+		{
+			MultiGrid& mg = *m_spMG;
+			rep.add("vertices", mg.num<Vertex>() * sizeof(RegularVertex));
+			rep.add("edges", mg.num<Edge>() * sizeof(RegularEdge));
+			rep.add("faces", mg.num<Face>() * sizeof(Quadrilateral));
+			rep.add("volumes", mg.num<Volume>() * sizeof(Hexahedron));
+
+			typedef Attachment<NeuriteProjector::SurfaceParams> NPSurfParam;
+			typedef Attachment<NeuriteProjector::Mapping> NPMappingParam;
+			report_global_vertex_attachment<ANumber>(rep, "diameter");
+			report_global_vertex_attachment<ANormal3>(rep, "npNormals");
+			report_global_vertex_attachment<NPSurfParam>(rep, "npSurfParams");
+			report_global_vertex_attachment<NPMappingParam>(rep, "npMapping");
+			report_global_vertex_attachment<Attachment<uint> >(rep, "neuronID");
+		}
+
+	private:
+		template <typename TAttachment>
+		void report_global_vertex_attachment(MemoryReport& rep, const char* name) const
+		{
+			if (!GlobalAttachments::is_declared(name))
+				return;
+			try
+			{
+				TAttachment a = GlobalAttachments::attachment<TAttachment>(name);
+				rep.add(std::string("attachment ") + name, AttachmentMemory<Vertex>(*m_spMG, a));
+			}
+			catch (const UGError&) {}  // declared with a different type (by another plugin)
+		}
+
+	private:
+		SmartPtr<MultiGrid> m_spMG;
+		std::string m_name;
+};
+
+std::vector<SmartPtr<GridMemoryReporter> >& reported_grids()
+{
+	static std::vector<SmartPtr<GridMemoryReporter> > vGrid;
+	return vGrid;
+}
+
+} // anonymous namespace
+
+
+
+IMemoryReporter::IMemoryReporter()
+{
+	registered_reporters().push_back(this);
+}
+
+IMemoryReporter::IMemoryReporter(const IMemoryReporter&)
+{
+	registered_reporters().push_back(this);
+}
+
+IMemoryReporter::~IMemoryReporter()
+{
+	std::vector<IMemoryReporter*>& vReporter = registered_reporters();
+	std::vector<IMemoryReporter*>::iterator it = std::find(vReporter.begin(), vReporter.end(), this);
+	if (it != vReporter.end())
+		vReporter.erase(it);
+}
+
+
+
+void add_grid_to_memory_report(SmartPtr<MultiGrid> mg, const std::string& name)
+{
+	UG_COND_THROW(!mg.valid(), "Invalid grid given.");
+	reported_grids().push_back(make_sp(new GridMemoryReporter(mg, name)));
+}
+
+
+void clear_memory_report_grids()
+{
+	reported_grids().clear();
+}
+
+
+void print_memory_report()
+{
+	local_memory mem;
+	size_t total;
+	collect_local_memory(mem, total);
+	print_reduced_memory(mem, "Memory report");
+}
+
+
+void update_memory_peak()
+{
+	local_memory mem;
+	size_t total;
+	collect_local_memory(mem, total);
+
+	MemoryPeak& peak = memory_peak();
+	if (total > peak.total)
+	{
+		peak.mem.swap(mem);
+		peak.total = total;
+	}
+}
+
+
+void print_memory_peak_report()
+{
+	print_reduced_memory(memory_peak().mem, "Memory report at peak (per process)");
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
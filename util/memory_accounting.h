@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__MEMORY_ACCOUNTING_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__MEMORY_ACCOUNTING_H
+
+#include <cstddef>                       // for size_t
+#include <map>                           // for map
+#include <string>                        // for string
+#include <utility>                       // for pair
+#include <vector>                        // for vector
+
+#include "common/util/smart_pointer.h"   // for SmartPtr
+#include "lib_grid/multi_grid.h"         // for MultiGrid
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/// memory items (name and bytes) reported by one object
+class MemoryReport
+{
+	public:
+		typedef std::pair<std::string, size_t> item_type;
+
+	public:
+		/// add an item (items with zero bytes are ignored)
+		void add(const std::string& item, size_t bytes)
+		{
+			if (bytes)
+				m_vItem.push_back(item_type(item, bytes));
+		}
+
+		const std::vector<item_type>& items() const {return m_vItem;}
+
+	private:
+		std::vector<item_type> m_vItem;
+};
+
+
+/**
+ * @brief Interface for objects reporting the memory they hold
+ *
+ * Objects register themselves on construction and are reported by
+ * print_memory_report() under memory_owner_name(). Sizes are estimates:
+ * attachment data is counted as number of elements times value size,
+ * containers by their capacity (vectors) or number of entries (maps).
+ * Memory shared between objects (e.g. a geometry cache) may be reported by
+ * each of them.
+ */
+class IMemoryReporter
+{
+	public:
+		IMemoryReporter();
+		IMemoryReporter(const IMemoryReporter& other);
+		IMemoryReporter& operator=(const IMemoryReporter&) {return *this;}
+		virtual ~IMemoryReporter();
+
+		/// name under which the memory of this object is reported
+		virtual std::string memory_owner_name() const = 0;
+
+		/// add the memory held by this object to the report
+		virtual void report_memory(MemoryReport& rep) const = 0;
+};
+
+
+/// estimated memory of an attachment to all elements of type TElem of a grid
+template <typename TElem, typename TAttachment>
+size_t AttachmentMemory(Grid& g, const TAttachment& a)
+{
+	// Grid only takes non-const attachments for a query
+	if (!g.has_attachment<TElem>(const_cast<TAttachment&>(a)))
+		return 0;
+	return g.num<TElem>() * sizeof(typename TAttachment::ValueType);
+}
+
+/// memory of a vector (its capacity)
+template <typename T>
+size_t VectorMemory(const std::vector<T>& v)
+{
+	return v.capacity() * sizeof(T);
+}
+
+/// estimated memory of a map (entries plus tree node overhead)
+template <typename TKey, typename TValue>
+size_t MapMemory(const std::map<TKey, TValue>& m)
+{
+	return m.size() * (sizeof(std::pair<const TKey, TValue>) + 4 * sizeof(void*));
+}
+
+
+/**
+ * @brief Report the elements of a grid and the neuro_collection attachments on it
+ *
+ * The grid (all levels) is reported under the given name with its vertices, edges,
+ * faces and volumes as well as the global attachments of the grid generation
+ * (diameter, npNormals, npSurfParams, npMapping) and the neuron IDs (neuronID).
+ * The grid is kept alive by the report until clear_memory_report_grids() is called.
+ */
+void add_grid_to_memory_report(SmartPtr<MultiGrid> mg, const std::string& name);
+
+/// remove all grids added by add_grid_to_memory_report()
+void clear_memory_report_grids();
+
+/**
+ * @brief Print the memory held by all reporting objects
+ *
+ * Rows (owner and item) are sorted by maximal size over all processes; for each row,
+ * the minimum, maximum and sum over the processes are given, and the process of the
+ * maximum. The peak resident set size of the process is given, too (if available).
+ * This function is collective; process 0 prints.
+ */
+void print_memory_report();
+
+/**
+ * @brief Take a snapshot of the memory held by all reporting objects
+ *
+ * If the local total is larger than at all previous calls, the snapshot is
+ * kept as the peak of this process. Call this at points of potentially high memory
+ * usage, e.g. after each grid adaption or time step. Not collective.
+ */
+void update_memory_peak();
+
+/// print the peak snapshots (as print_memory_report(); collective)
+void print_memory_peak_report();
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__MEMORY_ACCOUNTING_H
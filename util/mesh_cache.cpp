@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "mesh_cache.h"
+
+#include <cstdio>                        // for FILE, fopen, fread, fwrite, rename, remove
+#include <sstream>                       // for ostringstream
+#include <iomanip>                       // for setw, setfill
+
+#include "common/error.h"                // for UG_COND_THROW
+#include "common/log.h"                  // for UG_LOG
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+static const uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+static const uint64_t fnvPrime = 1099511628211ULL;
+
+
+MeshCacheKey::MeshCacheKey(const std::string& generator, const std::string& version)
+: m_hash(fnvOffsetBasis)
+{
+	add(generator);
+	add(version);
+}
+
+
+void MeshCacheKey::add_bytes(const void* p, size_t nBytes)
+{
+	const unsigned char* c = static_cast<const unsigned char*>(p);
+	for (size_t i = 0; i < nBytes; ++i)
+	{
+		m_hash ^= (uint64_t) c[i];
+		m_hash *= fnvPrime;
+	}
+}
+
+
+void MeshCacheKey::add_file_content(const std::string& fileName)
+{
+	FILE* f = fopen(fileName.c_str(), "rb");
+	UG_COND_THROW(!f, "File '" << fileName << "' could not be opened for hashing.");
+
+	uint64_t nBytes = 0;
+	char buf[65536];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+	{
+		add_bytes(buf, n);
+		nBytes += n;
+	}
+	const bool ok = !ferror(f);
+	fclose(f);
+	UG_COND_THROW(!ok, "File '" << fileName << "' could not be read for hashing.");
+
+	// length terminates the content (neighboring entries cannot be confused)
+	add_bytes(&nBytes, sizeof(uint64_t));
+}
+
+
+void MeshCacheKey::add(const std::string& s)
+{
+	const uint64_t len = (uint64_t) s.size();
+	add_bytes(&len, sizeof(uint64_t));
+	add_bytes(s.data(), s.size());
+}
+
+
+void MeshCacheKey::add(number x)
+{
+	const double d = (double) x;
+	add_bytes(&d, sizeof(double));
+}
+
+
+void MeshCacheKey::add(size_t n)
+{
+	const uint64_t n64 = (uint64_t) n;
+	add_bytes(&n64, sizeof(uint64_t));
+}
+
+
+void MeshCacheKey::add(bool b)
+{
+	const unsigned char c = b ? 1 : 0;
+	add_bytes(&c, 1);
+}
+
+
+std::string MeshCacheKey::str() const
+{
+	std::ostringstream oss;
+	oss << std::hex << std::setw(16) << std::setfill('0') << m_hash;
+	return oss.str();
+}
+
+
+
+static std::string& mesh_cache_dir()
+{
+	static std::string dir;
+	return dir;
+}
+
+
+void set_mesh_cache_directory(const std::string& dir)
+{
+	std::string& d = mesh_cache_dir();
+	d = dir;
+	if (!d.empty() && d[d.size()-1] != '/')
+		d += '/';
+}
+
+
+const std::string& mesh_cache_directory()
+{
+	return mesh_cache_dir();
+}
+
+
+static std::string cache_file_name(const MeshCacheKey& key, size_t i)
+{
+	std::ostringstream oss;
+	oss << mesh_cache_dir() << key.str() << "_" << i << ".ugx";
+	return oss.str();
+}
+
+
+static bool copy_file(const std::string& from, const std::string& to)
+{
+	FILE* in = fopen(from.c_str(), "rb");
+	if (!in)
+		return false;
+	FILE* out = fopen(to.c_str(), "wb");
+	if (!out)
+	{
+		fclose(in);
+		return false;
+	}
+
+	bool ok = true;
+	char buf[65536];
+	size_t n;
+	while (ok && (n = fread(buf, 1, sizeof(buf), in)) > 0)
+		ok = fwrite(buf, 1, n, out) == n;
+	ok = ok && !ferror(in);
+
+	fclose(in);
+	return fclose(out) == 0 && ok;
+}
+
+
+bool mesh_cache_restore(const MeshCacheKey& key, const std::vector<std::string>& vTargetFile)
+{
+	if (mesh_cache_dir().empty())
+		return false;
+
+	// all files must be present
+	const size_t nFiles = vTargetFile.size();
+	for (size_t i = 0; i < nFiles; ++i)
+	{
+		FILE* f = fopen(cache_file_name(key, i).c_str(), "rb");
+		if (!f)
+			return false;
+		fclose(f);
+	}
+
+	for (size_t i = 0; i < nFiles; ++i)
+	{
+		UG_COND_THROW(!copy_file(cache_file_name(key, i), vTargetFile[i]),
+			"Cached mesh '" << cache_file_name(key, i) << "' could not be copied to '"
+			<< vTargetFile[i] << "'.");
+	}
+
+	UG_LOG("Mesh taken from cache (key " << key.str() << ").\n");
+	return true;
+}
+
+
+void mesh_cache_store(const MeshCacheKey& key, const std::vector<std::string>& vSourceFile)
+{
+	if (mesh_cache_dir().empty())
+		return;
+
+	const size_t nFiles = vSourceFile.size();
+	for (size_t i = 0; i < nFiles; ++i)
+	{
+		const std::string cacheFile = cache_file_name(key, i);
+		const std::string tmpFile = cacheFile + ".tmp";
+		if (!copy_file(vSourceFile[i], tmpFile) || rename(tmpFile.c_str(), cacheFile.c_str()))
+		{
+			remove(tmpFile.c_str());
+			UG_LOG("WARNING: Mesh '" << vSourceFile[i] << "' could not be stored in the cache.\n");
+			return;
+		}
+	}
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__MESH_CACHE_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__MESH_CACHE_H
+
+#include <cstddef>                       // for size_t
+#include <stdint.h>                      // for uint64_t
+#include <string>                        // for string
+#include <vector>                        // for vector
+
+#include "common/types.h"                // for number
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Key for the mesh cache
+ *
+ * A 64-bit FNV-1a hash over the name (and version) of the generator, the contents
+ * of all input files and all generation parameters. Generators must add everything
+ * the generated mesh depends on; when a generator changes its output, its version
+ * string has to be changed in order to invalidate older cache entries.
+ */
+class MeshCacheKey
+{
+	public:
+		/// constructor
+		MeshCacheKey(const std::string& generator, const std::string& version);
+
+		/// add the contents of a file
+		void add_file_content(const std::string& fileName);
+
+		/// add a parameter
+		/// @{
+		void add(const std::string& s);
+		void add(number x);
+		void add(size_t n);
+		void add(bool b);
+		/// @}
+
+		/// key as hexadecimal string
+		std::string str() const;
+
+	private:
+		void add_bytes(const void* p, size_t nBytes);
+
+	private:
+		uint64_t m_hash;
+};
+
+
+/**
+ * @brief Set the directory for the mesh cache
+ *
+ * The mesh generators that support caching (SWC import, DendriteGenerator) store
+ * their output files under the key of their input there and copy them from there
+ * instead of generating them again if the same input is given.
+ * The directory must exist. An empty name disables the cache (default).
+ */
+void set_mesh_cache_directory(const std::string& dir);
+
+/// directory of the mesh cache (empty if disabled)
+const std::string& mesh_cache_directory();
+
+/**
+ * @brief Copy cached files to their targets
+ *
+ * @param key          cache key
+ * @param vTargetFile  files produced by the generator (in a fixed order)
+ * @return whether all files were found in the cache (and copied); false if the cache is disabled
+ */
+bool mesh_cache_restore(const MeshCacheKey& key, const std::vector<std::string>& vTargetFile);
+
+/**
+ * @brief Store generated files in the cache
+ *
+ * Does nothing if the cache is disabled. Files are written to a temporary name
+ * first and renamed afterwards, so that concurrent runs never see partial entries.
+ *
+ * @param key          cache key
+ * @param vSourceFile  files produced by the generator (in the same order as for restoring)
+ */
+void mesh_cache_store(const MeshCacheKey& key, const std::vector<std::string>& vSourceFile);
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__MESH_CACHE_H
@@ -50,12 +50,87 @@
 #include "lib_grid/tools/grid_level.h"                              // for GridLevel
 #include "lib_grid/tools/surface_view.h"                            // for SurfaceView
 #include "lib_grid/refinement/projectors/projection_handler.h"      // for ProjectionHandler
+#include "lib_grid/refinement/global_multi_grid_refiner.h"          // for GlobalMultiGridRefiner
+#ifdef UG_PARALLEL
+#include "lib_grid/parallelization/parallel_refinement/parallel_refinement.h"  // for ParallelGlobalRefiner_MultiGrid
+#endif
+#include "thread_scratch.h"                                         // for thread_index, max_num_threads
+
+#include <algorithm>                                                // for std::sort, std::max
 
 
 namespace ug {
 namespace neuro_collection {
 
 
+namespace {
+
+/// marks collected by one thread during anisotropic marking
+template <typename TElem, typename TSide>
+struct AnisotropicMarkBuffer
+{
+	std::vector<TElem*> vElem;
+	std::vector<Edge*> vLongEdge;
+	std::vector<TSide*> vSide;
+};
+
+/// per-volume data needed for the neurite/BP decision in MarkNeuriteForAxialRefinement
+struct AxialVolumeInfo
+{
+	AxialVolumeInfo()
+	: nid(0), axLow(0.0), axHigh(0.0), numVrt(0), malformed(false), valid(false) {}
+
+	uint32_t nid;       ///< max neurite ID of the corners
+	number axLow;       ///< largest axial position of the lower four corners
+	number axHigh;      ///< smallest axial position of the upper four corners
+	size_t numVrt;      ///< number of corners
+	bool malformed;     ///< axial positions are not clearly discriminable
+	bool valid;         ///< info has been computed
+};
+
+typedef NeuriteProjector::SurfaceParams NPSP;
+
+void compute_axial_volume_info
+(
+	Volume* vol,
+	const Grid::VertexAttachmentAccessor<Attachment<NPSP> >& aaSurfParams,
+	AxialVolumeInfo& info
+)
+{
+	info.valid = true;
+	info.numVrt = vol->num_vertices();
+	if (info.numVrt != 8)
+		return;
+
+	uint32_t nid = aaSurfParams[vol->vertex(0)].neuriteID & ((1 << 20) - 1);
+	for (size_t i = 1; i < 8; ++i)
+		nid = std::max(nid, aaSurfParams[vol->vertex(i)].neuriteID & ((1 << 20) - 1));
+	info.nid = nid;
+
+	// axial positions need to be clearly discriminable
+	number vrtAxPos[8];
+	for (size_t i = 0; i < 8; ++i)
+	{
+		if ((aaSurfParams[vol->vertex(i)].neuriteID & ((1 << 20) - 1)) < nid)
+			vrtAxPos[i] = 0.0;
+		else
+			vrtAxPos[i] = aaSurfParams[vol->vertex(i)].axial;
+	}
+
+	std::sort(vrtAxPos, vrtAxPos + 8);
+	if (vrtAxPos[0] == 0.0 && vrtAxPos[3] > 0.0)
+		for (size_t i = 0; i < 3; ++i)
+			vrtAxPos[i] =  vrtAxPos[3];
+
+	info.axLow = vrtAxPos[3];
+	info.axHigh = vrtAxPos[4];
+	const number axLength = vrtAxPos[4] - vrtAxPos[3];
+	info.malformed = vrtAxPos[3] - vrtAxPos[0] >= axLength || vrtAxPos[7] - vrtAxPos[4] >= axLength;
+}
+
+} // namespace
+
+
 
 template <typename TDomain>
 void adjust_attachments
@@ -158,54 +233,102 @@ void mark_anisotropic_in_local_neurite_direction
 	Grid::VertexAttachmentAccessor<Attachment<NPSP> > aaSurfParams;
 	aaSurfParams.access(grid, aSP);
 
-	// get surface view and prepare loop over all surface elements
+	// collect surface elements, so they can be distributed among threads
 	SurfaceView sv(domain->subset_handler());
 	const_iterator iter = sv.begin<elem_type>(GridLevel(), SurfaceView::ALL_BUT_SHADOW_COPY);
 	const_iterator iterEnd = sv.end<elem_type>(GridLevel(), SurfaceView::ALL_BUT_SHADOW_COPY);
-
-	// loop elements for marking
-	std::vector<Edge*> longEdges;
+	std::vector<elem_type*> vElem;
 	for (; iter != iterEnd; ++iter)
+		vElem.push_back(*iter);
+
+	if (vElem.empty())
+		return;
+
+	// the grid might auto-enable the options needed for neighborhood queries
+	// on first use; this must not happen inside the parallel region
 	{
-		longEdges.clear();
-		AnisotropyState state = long_edges_of_anisotropic_elem(*iter, grid, aaPos, thresholdRatio, longEdges);
+		Grid::traits<Edge>::secure_container el;
+		grid.associated_elements(el, vElem[0]);
+		typename Grid::traits<side_type>::secure_container sl;
+		grid.associated_elements(sl, vElem[0]);
+	}
+
+	// classify all elements in one threaded sweep;
+	// marks are collected per thread and only applied to the refiner afterwards
+	typedef AnisotropicMarkBuffer<elem_type, side_type> MarkBuffer;
+	const size_t nThreads = max_num_threads();
+	std::vector<MarkBuffer> vBuffer(nThreads);
+	bool bNoLongEdges = false;
+
+	const long nElem = (long) vElem.size();
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (long k = 0; k < nElem; ++k)
+	{
+		elem_type* elem = vElem[k];
+		MarkBuffer& buf = vBuffer[thread_index()];
+
+		std::vector<Edge*> longEdges;
+		AnisotropyState state = long_edges_of_anisotropic_elem(elem, grid, aaPos, thresholdRatio, longEdges);
 		if (state == ISOTROPIC)
 			continue;
 
-		UG_COND_THROW(!longEdges.size(), "Element is anisotropic, but no long edges present.");
+		if (longEdges.empty())
+		{
+			bNoLongEdges = true;
+			continue;
+		}
 
 		// check whether edges point in local neurite direction
 		const Edge* const longEdge = longEdges[0];
 		number axialDistance = fabs(aaSurfParams[longEdge->vertex(1)].axial-aaSurfParams[longEdge->vertex(0)].axial);
+		if (axialDistance <= 1e-6)
+			continue;
 
-		if (axialDistance > 1e-6)
-		{
-			// check this is not a BP, ignore BPs
-			uint32_t nid = aaSurfParams[(*iter)->vertex(0)].neuriteID & ((1 << 20) - 1);
-			uint32_t thisNID = aaSurfParams[(*iter)->vertex(0)].neuriteID & ((1 << 20) - 1);
-			for (size_t i = 1; i < (*iter)->num_vertices(); ++i)
-				thisNID = std::max(thisNID, aaSurfParams[(*iter)->vertex(i)].neuriteID & ((1 << 20) - 1));
-			if (thisNID != nid)
-			{
-				continue;
-			}
+		// check this is not a BP, ignore BPs
+		const uint32_t nid = aaSurfParams[elem->vertex(0)].neuriteID & ((1 << 20) - 1);
+		uint32_t thisNID = nid;
+		for (size_t i = 1; i < elem->num_vertices(); ++i)
+			thisNID = std::max(thisNID, aaSurfParams[elem->vertex(i)].neuriteID & ((1 << 20) - 1));
+		if (thisNID != nid)
+			continue;
 
-			// mark elem
-			refiner->mark(*iter, RM_CLOSURE);
+		buf.vElem.push_back(elem);
+		buf.vLongEdge.insert(buf.vLongEdge.end(), longEdges.begin(), longEdges.end());
 
-			// mark long edges
-			const size_t nEdges = longEdges.size();
-			for (size_t e = 0; e < nEdges; ++e)
-				refiner->mark(longEdges[e], RM_FULL);
+		typename Grid::traits<side_type>::secure_container sl;
+		grid.associated_elements(sl, elem);
+		const size_t slSz = sl.size();
+		for (size_t s = 0; s < slSz; ++s)
+			buf.vSide.push_back(sl[s]);
+	}
 
-			// mark all sides
-			typename Grid::traits<side_type>::secure_container sl;
-			grid.associated_elements(sl, *iter);
-			const size_t slSz = sl.size();
-			for (size_t s = 0; s < slSz; ++s)
-				if (refiner->get_mark(sl[s]) != RM_FULL)
-					refiner->mark(sl[s], RM_CLOSURE);
-		}
+	UG_COND_THROW(bNoLongEdges, "Element is anisotropic, but no long edges present.");
+
+	// apply marks: elements, then long edges, then all sides of marked elements
+	// (sides that are long edges keep their full refinement mark)
+	for (size_t t = 0; t < nThreads; ++t)
+	{
+		const std::vector<elem_type*>& vMarked = vBuffer[t].vElem;
+		const size_t nMarked = vMarked.size();
+		for (size_t i = 0; i < nMarked; ++i)
+			refiner->mark(vMarked[i], RM_CLOSURE);
+	}
+	for (size_t t = 0; t < nThreads; ++t)
+	{
+		const std::vector<Edge*>& vLongEdge = vBuffer[t].vLongEdge;
+		const size_t nLongEdges = vLongEdge.size();
+		for (size_t i = 0; i < nLongEdges; ++i)
+			refiner->mark(vLongEdge[i], RM_FULL);
+	}
+	for (size_t t = 0; t < nThreads; ++t)
+	{
+		const std::vector<side_type*>& vSide = vBuffer[t].vSide;
+		const size_t nSides = vSide.size();
+		for (size_t i = 0; i < nSides; ++i)
+			if (refiner->get_mark(vSide[i]) != RM_FULL)
+				refiner->mark(vSide[i], RM_CLOSURE);
 	}
 }
 
@@ -241,18 +364,36 @@ void MarkNeuriteForAxialRefinement(SmartPtr<IRefiner> refiner, SmartPtr<Domain3d
 	aaState.access(grid, aState);
 
 
-	// get surface view and prepare loop over all surface elements
+	// per-volume axial data; computed for all surface volumes in one threaded sweep,
+	// so the serial traversal below only needs to look it up
+	Attachment<AxialVolumeInfo> aInfo;
+	grid.attach_to_volumes(aInfo);
+	Grid::VolumeAttachmentAccessor<Attachment<AxialVolumeInfo> > aaInfo;
+	aaInfo.access(grid, aInfo);
+
+	// get surface view and collect all surface elements
 	SurfaceView sv(domain->subset_handler());
 	const_vol_it iter = sv.begin<Volume>(GridLevel(), SurfaceView::ALL_BUT_SHADOW_COPY);
 	const_vol_it iterEnd = sv.end<Volume>(GridLevel(), SurfaceView::ALL_BUT_SHADOW_COPY);
+	std::vector<Volume*> vSurfVol;
+	for (; iter != iterEnd; ++iter)
+		vSurfVol.push_back(*iter);
+
+	const long nSurfVol = (long) vSurfVol.size();
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (long k = 0; k < nSurfVol; ++k)
+		compute_axial_volume_info(vSurfVol[k], aaSurfParams, aaInfo[vSurfVol[k]]);
 
 	std::vector<Volume*> volumes;
 	std::vector<Edge*> edges;
 
 	grid.begin_marking();
-	for (; iter != iterEnd; ++iter)
+	for (long k = 0; k < nSurfVol; ++k)
 	{
-		if (aaState[*iter])  // already undecided
+		Volume* start = vSurfVol[k];
+		if (aaState[start])  // already undecided
 			continue;
 
 		// start a queue of elements all at the same axial position
@@ -260,20 +401,18 @@ void MarkNeuriteForAxialRefinement(SmartPtr<IRefiner> refiner, SmartPtr<Domain3d
 		volumes.clear();
 		edges.clear();
 
-		const size_t nInitialVrt = (*iter)->num_vertices();
-		UG_COND_THROW(nInitialVrt != 8, "Volume element with " << nInitialVrt << " vertices found in grid.\n"
+		const AxialVolumeInfo& startInfo = aaInfo[start];
+		UG_COND_THROW(startInfo.numVrt != 8, "Volume element with " << startInfo.numVrt << " vertices found in grid.\n"
 			"But grid must only contain hexahedra for this function to work.\n"
-				<< ElementDebugInfo(grid, *iter));
+				<< ElementDebugInfo(grid, start));
 
-		uint32_t nid = aaSurfParams[(*iter)->vertex(0)].neuriteID & ((1 << 20) - 1);
-		for (size_t i = 1; i < nInitialVrt; ++i)
-			nid = std::max(nid, aaSurfParams[(*iter)->vertex(i)].neuriteID & ((1 << 20) - 1));
+		const uint32_t nid = startInfo.nid;
 
-//UG_LOGN(ElementDebugInfo(grid, *iter) << " with NID " << nid << ":");
+//UG_LOGN(ElementDebugInfo(grid, start) << " with NID " << nid << ":");
 
 		bool isBP = false;
 		std::queue<Volume*> q;
-		q.push(*iter);
+		q.push(start);
 		while (!q.empty())
 		{
 			Volume* elem = q.front();
@@ -293,49 +432,29 @@ void MarkNeuriteForAxialRefinement(SmartPtr<IRefiner> refiner, SmartPtr<Domain3d
 			state = 1;
 			volumes.push_back(elem);
 
-			const size_t nVrt = elem->num_vertices();
-			UG_COND_THROW(nVrt != 8, "Volume element with " << nVrt << " vertices found in grid.\n"
+			// neighbors outside the surface have not been processed in the sweep
+			AxialVolumeInfo& info = aaInfo[elem];
+			if (!info.valid)
+				compute_axial_volume_info(elem, aaSurfParams, info);
+
+			UG_COND_THROW(info.numVrt != 8, "Volume element with " << info.numVrt << " vertices found in grid.\n"
 				"But grid must only contain hexahedra for this function to work.\n"
 				<< ElementDebugInfo(grid, elem));
 
-			std::vector<number> vrtAxPos(8);
-
 			// check this is not a BP
-			uint32_t thisNID = aaSurfParams[elem->vertex(0)].neuriteID & ((1 << 20) - 1);
-			for (size_t i = 1; i < nVrt; ++i)
-				thisNID = std::max(thisNID, aaSurfParams[elem->vertex(i)].neuriteID & ((1 << 20) - 1));
+			const uint32_t thisNID = info.nid;
 			if (thisNID != nid)
 			{
 				isBP = true;
-//UG_LOGN("  BP because of " << ElementDebugInfo(grid, *iter) << " with NID " << thisNID);
+//UG_LOGN("  BP because of " << ElementDebugInfo(grid, elem) << " with NID " << thisNID);
 				break;
 			}
 
 			// axial positions need to be clearly discriminable
-			for (size_t i = 0; i < nVrt; ++i)
-			{
-				if ((aaSurfParams[elem->vertex(i)].neuriteID & ((1 << 20) - 1)) < thisNID)
-					vrtAxPos[i] = 0.0;
-				else
-					vrtAxPos[i] = aaSurfParams[elem->vertex(i)].axial;
-			}
-
-			std::sort(vrtAxPos.begin(), vrtAxPos.end());
-			if (vrtAxPos[0] == 0.0 && vrtAxPos[3] > 0.0)
-				for (size_t i = 0; i < 3; ++i)
-					vrtAxPos[i] =  vrtAxPos[3];
-
-			number axLength = vrtAxPos[4] - vrtAxPos[3];
-			if (vrtAxPos[3] - vrtAxPos[0] >= axLength || vrtAxPos[7] - vrtAxPos[4] >= axLength)
+			if (info.malformed)
 			{
 				isBP = true;
-/*
-UG_LOGN("  BP because of " << ElementDebugInfo(grid, *iter) << " which is malformed:");
-UG_LOG("    axial positions: ");
-for (size_t j = 0; j < nVrt; ++j)
-	UG_LOG(vrtAxPos[j] << " ");
-UG_LOGN("");
-*/
+//UG_LOGN("  BP because of " << ElementDebugInfo(grid, elem) << " which is malformed.");
 				break;
 			}
 
@@ -374,10 +493,10 @@ UG_LOGN("");
 				for (size_t e = 0; e < elSz; ++e)
 				{
 					Edge* ed = el[e];
-					if ((((aaSurfParams[ed->vertex(0)].neuriteID & ((1 << 20) - 1)) < thisNID || aaSurfParams[ed->vertex(0)].axial <= vrtAxPos[3])
-							&& ((aaSurfParams[ed->vertex(1)].neuriteID & ((1 << 20) - 1)) == thisNID && aaSurfParams[ed->vertex(1)].axial >= vrtAxPos[4]))
-						|| (((aaSurfParams[ed->vertex(1)].neuriteID & ((1 << 20) - 1)) < thisNID || aaSurfParams[ed->vertex(1)].axial <= vrtAxPos[3])
-							&& ((aaSurfParams[ed->vertex(0)].neuriteID & ((1 << 20) - 1)) == thisNID && aaSurfParams[ed->vertex(0)].axial >= vrtAxPos[4])))
+					if ((((aaSurfParams[ed->vertex(0)].neuriteID & ((1 << 20) - 1)) < thisNID || aaSurfParams[ed->vertex(0)].axial <= info.axLow)
+							&& ((aaSurfParams[ed->vertex(1)].neuriteID & ((1 << 20) - 1)) == thisNID && aaSurfParams[ed->vertex(1)].axial >= info.axHigh))
+						|| (((aaSurfParams[ed->vertex(1)].neuriteID & ((1 << 20) - 1)) < thisNID || aaSurfParams[ed->vertex(1)].axial <= info.axLow)
+							&& ((aaSurfParams[ed->vertex(0)].neuriteID & ((1 << 20) - 1)) == thisNID && aaSurfParams[ed->vertex(0)].axial >= info.axHigh)))
 					{
 						if (!grid.is_marked(ed))
 						{
@@ -423,6 +542,7 @@ UG_LOGN("");
 	grid.end_marking();
 
 	grid.detach_from_volumes(aState);
+	grid.detach_from_volumes(aInfo);
 
 
 	typedef SurfaceView::traits<Face>::const_iterator const_face_it;
@@ -455,6 +575,64 @@ void RemoveAllNonDefaultRefinementProjectors(SmartPtr<TDomain> dom)
 }
 
 
+template <typename TDomain>
+void GlobalRefineWithBatchedProjection(SmartPtr<TDomain> dom, bool threaded)
+{
+	MultiGrid& mg = *dom->grid();
+	SmartPtr<RefinementProjector> spProj = dom->refinement_projector();
+	UG_COND_THROW(!spProj.valid(), "Domain does not have a refinement projector.");
+
+	// refine with linear vertex placement
+	// (the serial refiner is not valid on distributed multigrids)
+	SmartPtr<RefinementProjector> spLinProj = make_sp(new RefinementProjector(dom->geometry3d()));
+#ifdef UG_PARALLEL
+	DistributedGridManager* dgm = mg.distributed_grid_manager();
+	if (dgm)
+	{
+		ParallelGlobalRefiner_MultiGrid ref(*dgm, spLinProj);
+		ref.refine();
+	}
+	else
+#endif
+	{
+		GlobalMultiGridRefiner ref(mg, spLinProj);
+		ref.refine();
+	}
+
+	// collect new vertices
+	const int topLv = (int) mg.top_level();
+	std::vector<Vertex*> vVrt;
+	vVrt.reserve(mg.num<Vertex>(topLv));
+	VertexIterator vit = mg.begin<Vertex>(topLv);
+	VertexIterator vitEnd = mg.end<Vertex>(topLv);
+	for (; vit != vitEnd; ++vit)
+		vVrt.push_back(*vit);
+
+	// project them in one pass
+	RefinementProjector& proj = *spProj;
+	const long nVrt = (long) vVrt.size();
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static) if (threaded)
+#endif
+	for (long k = 0; k < nVrt; ++k)
+	{
+		Vertex* vrt = vVrt[k];
+		GridObject* parent = mg.get_parent(vrt);
+		if (!parent)
+			continue;
+
+		switch (parent->base_object_id())
+		{
+			case VERTEX: proj.new_vertex(vrt, static_cast<Vertex*>(parent)); break;
+			case EDGE: proj.new_vertex(vrt, static_cast<Edge*>(parent)); break;
+			case FACE: proj.new_vertex(vrt, static_cast<Face*>(parent)); break;
+			case VOLUME: proj.new_vertex(vrt, static_cast<Volume*>(parent)); break;
+			default: break;
+		}
+	}
+}
+
+
 ////////////////////////////////////////////////////////////////////////
 /// GetCoordinatesFromVertexByIndex
 ////////////////////////////////////////////////////////////////////////
@@ -474,16 +652,19 @@ const vector3* GetCoordinatesFromVertexByIndex(Grid& grid, const int index)
 #ifdef UG_DIM_1
 	template void mark_anisotropic_in_local_neurite_direction<Domain1d>(SmartPtr<IRefiner>, SmartPtr<Domain1d>, number);
 	template void RemoveAllNonDefaultRefinementProjectors(SmartPtr<Domain1d>);
+	template void GlobalRefineWithBatchedProjection(SmartPtr<Domain1d>, bool);
 	template void adjust_attachments(SmartPtr<Domain1d>);
 #endif
 #ifdef UG_DIM_2
 	template void mark_anisotropic_in_local_neurite_direction<Domain2d>(SmartPtr<IRefiner>, SmartPtr<Domain2d>, number);
 	template void RemoveAllNonDefaultRefinementProjectors(SmartPtr<Domain2d>);
+	template void GlobalRefineWithBatchedProjection(SmartPtr<Domain2d>, bool);
 	template void adjust_attachments(SmartPtr<Domain2d>);
 #endif
 #ifdef UG_DIM_3
 	template void mark_anisotropic_in_local_neurite_direction<Domain3d>(SmartPtr<IRefiner>, SmartPtr<Domain3d>, number);
 	template void RemoveAllNonDefaultRefinementProjectors(SmartPtr<Domain3d>);
+	template void GlobalRefineWithBatchedProjection(SmartPtr<Domain3d>, bool);
 	template void adjust_attachments(SmartPtr<Domain3d>);
 #endif
 
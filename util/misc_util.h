@@ -78,6 +78,9 @@ void adjust_attachments
  * "Anisotropic in direction of the local neurite direction " means that the long
  *  edges (only the first one is checked) point more or less in local neurite direction.
  * To be precise: If the axial distance is larger than 1e-6 the direction is to be assumed in local neurite direction.
+ *
+ * All elements are classified in one (OpenMP-)threaded sweep; the resulting marks are
+ * collected per thread and applied to the refiner serially afterwards.
  */
 template <typename TDomain>
 void mark_anisotropic_in_local_neurite_direction
@@ -109,6 +112,30 @@ template <typename TDomain>
 void RemoveAllNonDefaultRefinementProjectors(SmartPtr<TDomain> dom);
 
 
+/**
+ * @brief Refine a domain globally once and project all new vertices in one batched pass
+ *
+ * The refinement itself is performed with linear vertex placement; afterwards,
+ * the domain's refinement projector is applied to all vertices of the new level,
+ * optionally in an (OpenMP-)threaded loop.
+ * This is equivalent to a GlobalMultiGridRefiner with the domain's projector
+ * as long as the projectors only use data of the parent level (as is the case
+ * for neurite and linear projectors), but not for smoothing projectors
+ * that depend on already projected children.
+ * On distributed multigrids, the parallel global refiner is used; the projection
+ * is then applied to all new vertices on each process independently.
+ * The threaded pass requires the projectors to allow concurrent calls of
+ * new_vertex() for distinct vertices. This has not been verified for the lib_grid
+ * projectors (e.g., NeuriteProjector), so it is off by default
+ * and must only be switched on for projectors known to be thread-safe.
+ *
+ * @param dom       domain to be refined
+ * @param threaded  whether the projection pass is to be threaded (default: false)
+ */
+template <typename TDomain>
+void GlobalRefineWithBatchedProjection(SmartPtr<TDomain> dom, bool threaded = false);
+
+
 /*!
  * \brief Get the coordinates of a grid vertex by its index
  * \param[in] grid
@@ -58,11 +58,11 @@ namespace neuro_collection {
 
 
 NeuriteAxialRefinementMarker::NeuriteAxialRefinementMarker(SmartPtr<Domain3d> dom)
-: m_spDom(dom)
+: m_bIncremental(false), m_spDom(dom)
 {
 	SmartPtr<MultiGrid> mg = m_spDom->grid();
 
-	// attach and access helper attachment
+	// attach and access helper attachments
 	if (!mg->has_volume_attachment(m_aBP))
 		mg->attach_to_volumes_dv(m_aBP, false);
 	else
@@ -70,6 +70,9 @@ NeuriteAxialRefinementMarker::NeuriteAxialRefinementMarker(SmartPtr<Domain3d> do
 
 	m_aaBP.access(*mg, m_aBP);
 
+	mg->attach_to_volumes_dv(m_aExamined, false);
+	m_aaExamined.access(*mg, m_aExamined);
+
 	// access neurite projector local coordinates attachment
 	UG_COND_THROW(!GlobalAttachments::is_declared("npSurfParams"),
 		"GlobalAttachment 'npSurfParams' not declared.");
@@ -86,6 +89,13 @@ NeuriteAxialRefinementMarker::~NeuriteAxialRefinementMarker()
 {
 	SmartPtr<MultiGrid> mg = m_spDom->grid();
 	mg->detach_from_volumes(m_aBP);
+	mg->detach_from_volumes(m_aExamined);
+}
+
+
+void NeuriteAxialRefinementMarker::set_incremental(bool b)
+{
+	m_bIncremental = b;
 }
 
 
@@ -112,11 +122,6 @@ void NeuriteAxialRefinementMarker::mark(SmartPtr<IRefiner> refiner)
 		refiner->mark(*itFace, RM_CLOSURE);
 
 	// mark all axial edges RM_REFINE
-	std::vector<EdgeDescriptor> edgeDescs1(4);
-	std::vector<EdgeDescriptor> edgeDescs2(4);
-	std::vector<EdgeDescriptor> edgeDescs3(4);
-	float axPos[8];
-
 	Grid::traits<Edge>::secure_container el;
 
 	itVol = sv.begin<Volume>(GridLevel(), SurfaceView::ALL_BUT_SHADOW_COPY);
@@ -127,100 +132,148 @@ void NeuriteAxialRefinementMarker::mark(SmartPtr<IRefiner> refiner)
 		if (is_bp_volume(vol))
 			continue;
 
-		// find the axial edges
-		Hexahedron* hex = dynamic_cast<Hexahedron*>(vol);
-		if (!hex) {
-			UG_DEBUG_BEGIN(NC_TNP, 0);
-			if (vol->num_vertices() > 0) {
-				if (!m_spDom->grid()->has_vertex_attachment(aPosition)) {
-					m_spDom->grid()->attach_to_vertices(aPosition);
-				}
-				Grid::VertexAttachmentAccessor<APosition> aaPos(*m_spDom->grid(), aPosition);
-				UG_LOG("Coordinates for the 0-th vertex of non-hexaeder element: " << aaPos[vol->vertex(0)]);
-			}
-			UG_DEBUG_END(NC_TNP, 0);
+		mark_axial_edges(refiner.get(), vol, el);
+	}
+}
 
-			UG_THROW("Found volume that is not a hexahedron.\n"
-					"This implementation can only handle hexahedron grids.");
-		}
 
-		uint32_t nid = 0;
-		for (size_t i = 0; i < 8; ++i)
-			nid = std::max(nid, m_aaSurfParams[hex->vertex(i)].neuriteID & ((1 << 20) - 1));
+void NeuriteAxialRefinementMarker::mark_volumes
+(
+	SmartPtr<IRefiner> refiner,
+	const std::vector<Volume*>& vVol
+)
+{
+	// identify BP edges
+	find_bp_volumes();
+
+	SmartPtr<MultiGrid> mg = m_spDom->grid();
+	Grid::traits<Face>::secure_container fl;
+	Grid::traits<Edge>::secure_container el;
 
-		// axial pos is only valid of neurite ID is that of the parent for BP vertices
-		// otherwise take 0.0
-		for (size_t i = 0; i < 8; ++i)
-		{
-			if ((m_aaSurfParams[hex->vertex(i)].neuriteID & ((1 << 20) - 1)) == nid)
-				axPos[i] = m_aaSurfParams[hex->vertex(i)].axial;
-			else
-				axPos[i] = 0.0;
-		}
+	const size_t nVol = vVol.size();
+	for (size_t v = 0; v < nVol; ++v)
+	{
+		Volume* vol = vVol[v];
+
+		// volume and its faces RM_CLOSURE
+		refiner->mark(vol, RM_CLOSURE);
+		mg->associated_elements(fl, vol);
+		const size_t flSz = fl.size();
+		for (size_t f = 0; f < flSz; ++f)
+			refiner->mark(fl[f], RM_CLOSURE);
+
+		// axial edges RM_REFINE
+		if (!is_bp_volume(vol))
+			mark_axial_edges(refiner.get(), vol, el);
+	}
+}
 
-		number length1 = 0.0;
-		edgeDescs1[0].set_vertex(0, hex->vertex(0));
-		edgeDescs1[0].set_vertex(1, hex->vertex(1));
-		length1 += fabs(axPos[0] - axPos[1]);
-		edgeDescs1[1].set_vertex(0, hex->vertex(2));
-		edgeDescs1[1].set_vertex(1, hex->vertex(3));
-		length1 += fabs(axPos[2] - axPos[3]);
-		edgeDescs1[2].set_vertex(0, hex->vertex(4));
-		edgeDescs1[2].set_vertex(1, hex->vertex(5));
-		length1 += fabs(axPos[4] - axPos[5]);
-		edgeDescs1[3].set_vertex(0, hex->vertex(6));
-		edgeDescs1[3].set_vertex(1, hex->vertex(7));
-		length1 += fabs(axPos[6] - axPos[7]);
-
-		number length2 = 0.0;
-		edgeDescs2[0].set_vertex(0, hex->vertex(0));
-		edgeDescs2[0].set_vertex(1, hex->vertex(3));
-		length2 += fabs(axPos[0] - axPos[3]);
-		edgeDescs2[1].set_vertex(0, hex->vertex(1));
-		edgeDescs2[1].set_vertex(1, hex->vertex(2));
-		length2 += fabs(axPos[1] - axPos[2]);
-		edgeDescs2[2].set_vertex(0, hex->vertex(4));
-		edgeDescs2[2].set_vertex(1, hex->vertex(7));
-		length2 += fabs(axPos[4] - axPos[7]);
-		edgeDescs2[3].set_vertex(0, hex->vertex(5));
-		edgeDescs2[3].set_vertex(1, hex->vertex(6));
-		length2 += fabs(axPos[5] - axPos[6]);
-
-		number length3 = 0.0;
-		edgeDescs3[0].set_vertex(0, hex->vertex(0));
-		edgeDescs3[0].set_vertex(1, hex->vertex(4));
-		length3 += fabs(axPos[0] - axPos[4]);
-		edgeDescs3[1].set_vertex(0, hex->vertex(1));
-		edgeDescs3[1].set_vertex(1, hex->vertex(5));
-		length3 += fabs(axPos[1] - axPos[5]);
-		edgeDescs3[2].set_vertex(0, hex->vertex(2));
-		edgeDescs3[2].set_vertex(1, hex->vertex(6));
-		length3 += fabs(axPos[2] - axPos[6]);
-		edgeDescs3[3].set_vertex(0, hex->vertex(3));
-		edgeDescs3[3].set_vertex(1, hex->vertex(7));
-		length3 += fabs(axPos[3] - axPos[7]);
-
-		std::vector<EdgeDescriptor>* edgeDescs = &edgeDescs3;
-		if (length1 > length2)
-		{
-			if (length1 > length3)
-				edgeDescs = &edgeDescs1;
+
+void NeuriteAxialRefinementMarker::mark_axial_edges
+(
+	IRefiner* refiner,
+	Volume* vol,
+	Grid::traits<Edge>::secure_container& el
+) const
+{
+	EdgeDescriptor edgeDescs1[4];
+	EdgeDescriptor edgeDescs2[4];
+	EdgeDescriptor edgeDescs3[4];
+	float axPos[8];
+
+	// find the axial edges
+	Hexahedron* hex = dynamic_cast<Hexahedron*>(vol);
+	if (!hex) {
+		UG_DEBUG_BEGIN(NC_TNP, 0);
+		if (vol->num_vertices() > 0) {
+			if (!m_spDom->grid()->has_vertex_attachment(aPosition)) {
+				m_spDom->grid()->attach_to_vertices(aPosition);
+			}
+			Grid::VertexAttachmentAccessor<APosition> aaPos(*m_spDom->grid(), aPosition);
+			UG_LOG("Coordinates for the 0-th vertex of non-hexaeder element: " << aaPos[vol->vertex(0)]);
 		}
-		else if (length2 > length3)
-			edgeDescs = &edgeDescs2;
+		UG_DEBUG_END(NC_TNP, 0);
+
+		UG_THROW("Found volume that is not a hexahedron.\n"
+				"This implementation can only handle hexahedron grids.");
+	}
 
-		mg->associated_elements(el, hex);
-		const size_t elSz = el.size();
-		for (size_t i = 0; i < 4; ++i)
+	uint32_t nid = 0;
+	for (size_t i = 0; i < 8; ++i)
+		nid = std::max(nid, m_aaSurfParams[hex->vertex(i)].neuriteID & ((1 << 20) - 1));
+
+	// axial pos is only valid of neurite ID is that of the parent for BP vertices
+	// otherwise take 0.0
+	for (size_t i = 0; i < 8; ++i)
+	{
+		if ((m_aaSurfParams[hex->vertex(i)].neuriteID & ((1 << 20) - 1)) == nid)
+			axPos[i] = m_aaSurfParams[hex->vertex(i)].axial;
+		else
+			axPos[i] = 0.0;
+	}
+
+	number length1 = 0.0;
+	edgeDescs1[0].set_vertex(0, hex->vertex(0));
+	edgeDescs1[0].set_vertex(1, hex->vertex(1));
+	length1 += fabs(axPos[0] - axPos[1]);
+	edgeDescs1[1].set_vertex(0, hex->vertex(2));
+	edgeDescs1[1].set_vertex(1, hex->vertex(3));
+	length1 += fabs(axPos[2] - axPos[3]);
+	edgeDescs1[2].set_vertex(0, hex->vertex(4));
+	edgeDescs1[2].set_vertex(1, hex->vertex(5));
+	length1 += fabs(axPos[4] - axPos[5]);
+	edgeDescs1[3].set_vertex(0, hex->vertex(6));
+	edgeDescs1[3].set_vertex(1, hex->vertex(7));
+	length1 += fabs(axPos[6] - axPos[7]);
+
+	number length2 = 0.0;
+	edgeDescs2[0].set_vertex(0, hex->vertex(0));
+	edgeDescs2[0].set_vertex(1, hex->vertex(3));
+	length2 += fabs(axPos[0] - axPos[3]);
+	edgeDescs2[1].set_vertex(0, hex->vertex(1));
+	edgeDescs2[1].set_vertex(1, hex->vertex(2));
+	length2 += fabs(axPos[1] - axPos[2]);
+	edgeDescs2[2].set_vertex(0, hex->vertex(4));
+	edgeDescs2[2].set_vertex(1, hex->vertex(7));
+	length2 += fabs(axPos[4] - axPos[7]);
+	edgeDescs2[3].set_vertex(0, hex->vertex(5));
+	edgeDescs2[3].set_vertex(1, hex->vertex(6));
+	length2 += fabs(axPos[5] - axPos[6]);
+
+	number length3 = 0.0;
+	edgeDescs3[0].set_vertex(0, hex->vertex(0));
+	edgeDescs3[0].set_vertex(1, hex->vertex(4));
+	length3 += fabs(axPos[0] - axPos[4]);
+	edgeDescs3[1].set_vertex(0, hex->vertex(1));
+	edgeDescs3[1].set_vertex(1, hex->vertex(5));
+	length3 += fabs(axPos[1] - axPos[5]);
+	edgeDescs3[2].set_vertex(0, hex->vertex(2));
+	edgeDescs3[2].set_vertex(1, hex->vertex(6));
+	length3 += fabs(axPos[2] - axPos[6]);
+	edgeDescs3[3].set_vertex(0, hex->vertex(3));
+	edgeDescs3[3].set_vertex(1, hex->vertex(7));
+	length3 += fabs(axPos[3] - axPos[7]);
+
+	EdgeDescriptor* edgeDescs = edgeDescs3;
+	if (length1 > length2)
+	{
+		if (length1 > length3)
+			edgeDescs = edgeDescs1;
+	}
+	else if (length2 > length3)
+		edgeDescs = edgeDescs2;
+
+	m_spDom->grid()->associated_elements(el, hex);
+	const size_t elSz = el.size();
+	for (size_t i = 0; i < 4; ++i)
+	{
+		for (size_t e = 0; e < elSz; ++e)
 		{
-			for (size_t e = 0; e < elSz; ++e)
+			Edge* edge = el[e];
+			if (CompareVertices(edge, &edgeDescs[i]))
 			{
-				Edge* edge = el[e];
-				if (CompareVertices(edge, &(*edgeDescs)[i]))
-				{
-					refiner->mark(edge, RM_REFINE);
-					break;
-				}
+				refiner->mark(edge, RM_REFINE);
+				break;
 			}
 		}
 	}
@@ -435,6 +488,17 @@ void NeuriteAxialRefinementMarker::find_bp_volumes()
 	{
 		Volume* vol = *itVol;
 
+		if (m_bIncremental)
+		{
+			// only examine new volumes, and only those that can be BP volumes
+			if (m_aaExamined[vol])
+				continue;
+			m_aaExamined[vol] = true;
+
+			if (has_non_bp_parent(mg.get(), vol))
+				continue;
+		}
+
 		// Is this a central BP volume?
 		if (!is_central_bp_vol(vol))
 			continue;
@@ -472,6 +536,20 @@ void NeuriteAxialRefinementMarker::mark_bp_volumes(MultiGrid* mg, int lvl) const
 	{
 		Volume* vol = *itVol;
 
+		// in incremental mode, use the known BP status
+		// (volumes surrounding a central BP volume are flagged as BP themselves)
+		if (m_bIncremental)
+		{
+			if (m_aaExamined[vol])
+			{
+				if (m_aaBP[vol])
+					mg->mark(vol);
+				continue;
+			}
+			if (has_non_bp_parent(mg, vol))
+				continue;
+		}
+
 		// Is this a central BP volume?
 		if (!is_central_bp_vol(vol))
 			continue;
@@ -505,6 +583,14 @@ bool NeuriteAxialRefinementMarker::is_bp_volume(Volume* vol) const
 }
 
 
+bool NeuriteAxialRefinementMarker::has_non_bp_parent(MultiGrid* mg, Volume* vol) const
+{
+	// BP volumes are refined by copying, so children of non-BP volumes are no BP volumes
+	Volume* parent = dynamic_cast<Volume*>(mg->get_parent(vol));
+	return parent && m_aaExamined[parent] && !m_aaBP[parent];
+}
+
+
 bool NeuriteAxialRefinementMarker::is_central_bp_vol(Volume* vol) const
 {
 	const size_t nVrt = vol->num_vertices();
@@ -52,6 +52,8 @@
 // configuration file for compile options
 #include "nc_config.h"
 
+#include <vector>
+
 #ifdef NC_WITH_PARMETIS
 #include "../../Parmetis/src/unificator_interface.h"  // for IUnificator
 #endif
@@ -80,6 +82,14 @@ namespace neuro_collection {
  * @note The class only works on neurites_from_swc-created geometries with hexahedral elements.
  *       It is not perfect. Sometimes, the refinement will not be properly anisotropic.
  * @note The class should work both on ER-containing and ER-less geometries.
+ *
+ * In incremental mode (set_incremental()), each volume is only examined once:
+ * As branching point volumes are refined by copying, children of volumes
+ * that have been found not to be branching point volumes cannot become ones.
+ * New volumes whose parent is such a volume are therefore only flagged as
+ * examined; only the remaining new volumes are checked geometrically.
+ * The cost of the branching point detection then scales with the number of
+ * new volumes instead of the number of all surface volumes.
  */
 class NeuriteAxialRefinementMarker
 #ifdef NC_WITH_PARMETIS
@@ -93,6 +103,22 @@ class NeuriteAxialRefinementMarker
 
 		void mark(SmartPtr<IRefiner> refiner);
 
+		/**
+		 * @brief mark only the given volumes for axial refinement
+		 *
+		 * Same as mark(), but restricted to a subset of the surface volumes,
+		 * e.g., a moving refinement window (see WaveFrontRefinementDriver).
+		 */
+		void mark_volumes(SmartPtr<IRefiner> refiner, const std::vector<Volume*>& vVol);
+
+		/**
+		 * @brief re-examine only new volumes for branching points
+		 * If switched on, the branching point status is propagated from parents
+		 * to children through the multigrid hierarchy (see class description).
+		 * Default is off.
+		 */
+		void set_incremental(bool b);
+
 #ifdef NC_WITH_PARMETIS
 		typedef Volume::side side_t;
 		typedef Attachment<int> AElemIndex;
@@ -118,11 +144,17 @@ class NeuriteAxialRefinementMarker
 	private:
 		void mark_bp_volumes(MultiGrid* mg, int lvl) const;
 		bool is_central_bp_vol(Volume*) const;
+		bool has_non_bp_parent(MultiGrid* mg, Volume* vol) const;
+		void mark_axial_edges(IRefiner* refiner, Volume* vol, Grid::traits<Edge>::secure_container& el) const;
 
 	protected:
 		Attachment<bool> m_aBP;
 		Grid::VolumeAttachmentAccessor<Attachment<bool> > m_aaBP;
 
+		bool m_bIncremental;
+		Attachment<bool> m_aExamined;  ///< whether the BP status of a volume is known
+		Grid::VolumeAttachmentAccessor<Attachment<bool> > m_aaExamined;
+
 		typedef NeuriteProjector::SurfaceParams NPSP;
 		Grid::VertexAttachmentAccessor<Attachment<NPSP> > m_aaSurfParams;
 
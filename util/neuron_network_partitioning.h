@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__NEURON_NETWORK_PARTITIONING_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__NEURON_NETWORK_PARTITIONING_H
+
+#ifdef UG_PARALLEL
+
+#include "common/types.h"                                  // for number
+#include "common/util/smart_pointer.h"                     // for SmartPtr
+#include "lib_disc/parallelization/domain_load_balancer.h"  // for PartitionMap
+
+#include <cstddef>                                         // for size_t
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/**
+ * @brief Partition a 1d neuron network such that neurons are not split
+ *
+ * The edges of the base level are assigned to numPartitions partitions,
+ * using the "neuronID" vertex attachment, such that each neuron is kept
+ * on one partition and the numbers of (membrane) edges per partition
+ * are balanced. Only neurons with more than (1 + imbalanceTol) times the
+ * average number of edges per partition are split; they are cut into
+ * chunks of (nearly) equal size which are contiguous in a depth-first
+ * traversal of the neuron, i.e., whole subtrees as far as possible.
+ * Neurons and chunks are then distributed largest first, each to the
+ * currently least loaded partition.
+ *
+ * Compared to a general graph partitioning of the network, this keeps the
+ * interfaces (and thus the communication) restricted to the cuts through
+ * large neurons.
+ * The resulting partition map can be used with DistributeDomain().
+ *
+ * @param dom            domain (holding a 1d network with neuron IDs)
+ * @param partitionMap   partition map to be filled
+ * @param numPartitions  number of partitions
+ * @param baseLevel      grid level to be partitioned
+ * @param imbalanceTol   tolerated relative excess of a partition over the average
+ * @return               number of neurons that had to be split
+ */
+template <typename TDomain>
+size_t PartitionNeuronNetwork
+(
+	SmartPtr<TDomain> dom,
+	PartitionMap& partitionMap,
+	int numPartitions,
+	size_t baseLevel,
+	number imbalanceTol
+);
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "neuron_network_partitioning_impl.h"
+
+#endif // UG_PARALLEL
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__NEURON_NETWORK_PARTITIONING_H
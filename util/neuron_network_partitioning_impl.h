@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "neuron_network_partitioning.h"
+
+#include "common/error.h"                   // for UG_COND_THROW
+#include "common/log.h"                     // for UG_LOG
+#include "lib_grid/global_attachments.h"    // for GlobalAttachments
+
+#include <algorithm>                        // for std::sort, std::min, std::max
+#include <cmath>                            // for std::ceil
+#include <functional>                       // for std::greater
+#include <map>
+#include <queue>                            // for std::priority_queue
+#include <utility>                          // for std::pair
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// part of a neuron (or a whole neuron) to be put on one partition
+struct NeuronChunk
+{
+	uint nid;      ///< neuron ID
+	size_t begin;  ///< first edge (in depth-first order of the neuron)
+	size_t size;   ///< number of edges
+
+	bool operator<(const NeuronChunk& other) const
+	{
+		// larger chunks first (deterministic for equal sizes)
+		if (size != other.size)
+			return size > other.size;
+		if (nid != other.nid)
+			return nid < other.nid;
+		return begin < other.begin;
+	}
+};
+
+
+template <typename TDomain>
+size_t PartitionNeuronNetwork
+(
+	SmartPtr<TDomain> dom,
+	PartitionMap& partitionMap,
+	int numPartitions,
+	size_t baseLevel,
+	number imbalanceTol
+)
+{
+	UG_COND_THROW(!dom.valid(), "No valid domain given.");
+	UG_COND_THROW(numPartitions < 1, "At least one partition is required.");
+	UG_COND_THROW(imbalanceTol < 0.0, "Imbalance tolerance must not be negative.");
+
+	MultiGrid& mg = *dom->grid();
+	UG_COND_THROW(baseLevel >= mg.num_levels(), "Base level " << baseLevel << " does not exist.");
+
+	typedef Attachment<uint> ANeuronID;
+	UG_COND_THROW(!GlobalAttachments::is_declared("neuronID"),
+		"The neuron ID attachment 'neuronID' has not been declared.");
+	ANeuronID aNID = GlobalAttachments::attachment<ANeuronID>("neuronID");
+	UG_COND_THROW(!mg.has_vertex_attachment(aNID), "The grid does not carry neuron IDs.");
+	Grid::VertexAttachmentAccessor<ANeuronID> aaNID(mg, aNID);
+
+	if ((int) partitionMap.num_target_procs() != numPartitions)
+	{
+		partitionMap.clear();
+		partitionMap.add_target_procs(0, numPartitions);
+	}
+	partitionMap.assign_grid(mg);
+	SubsetHandler& partitionHandler = *partitionMap.get_partition_handler();
+
+	// sort the edges of each neuron in depth-first order
+	// (consecutive edges then mostly form connected subtrees)
+	std::map<uint, std::vector<Edge*> > mNeuronEdges;
+	size_t nEdges = 0;
+	std::vector<Edge*> vStack;
+	Grid::traits<Edge>::secure_container assEdges;
+	mg.begin_marking();
+	typedef geometry_traits<Edge>::iterator EdgeIter;
+	for (EdgeIter it = mg.begin<Edge>(baseLevel); it != mg.end<Edge>(baseLevel); ++it)
+	{
+		if (mg.is_marked(*it))
+			continue;
+
+		const uint nid = aaNID[(*it)->vertex(0)];
+		std::vector<Edge*>& vEdges = mNeuronEdges[nid];
+
+		mg.mark(*it);
+		vStack.push_back(*it);
+		while (!vStack.empty())
+		{
+			Edge* e = vStack.back();
+			vStack.pop_back();
+			vEdges.push_back(e);
+			++nEdges;
+
+			for (size_t v = 0; v < 2; ++v)
+			{
+				mg.associated_elements(assEdges, e->vertex(v));
+				for (size_t k = 0; k < assEdges.size(); ++k)
+				{
+					Edge* ne = assEdges[k];
+					if (mg.is_marked(ne) || aaNID[ne->vertex(0)] != nid)
+						continue;
+					mg.mark(ne);
+					vStack.push_back(ne);
+				}
+			}
+		}
+	}
+	mg.end_marking();
+
+	// cut neurons that do not fit into one partition into chunks
+	const number avgLoad = (number) nEdges / numPartitions;
+	const number maxLoad = (1.0 + imbalanceTol) * avgLoad;
+	std::vector<NeuronChunk> vChunk;
+	size_t nSplit = 0;
+	std::map<uint, std::vector<Edge*> >::const_iterator nit = mNeuronEdges.begin();
+	for (; nit != mNeuronEdges.end(); ++nit)
+	{
+		const size_t n = nit->second.size();
+		size_t nChunks = 1;
+		if ((number) n > maxLoad)
+		{
+			nChunks = std::min((size_t) std::ceil(n / avgLoad), n);
+			++nSplit;
+		}
+
+		for (size_t c = 0; c < nChunks; ++c)
+		{
+			NeuronChunk chunk;
+			chunk.nid = nit->first;
+			chunk.begin = c * n / nChunks;
+			chunk.size = (c + 1) * n / nChunks - chunk.begin;
+			vChunk.push_back(chunk);
+		}
+	}
+
+	// largest first, each to the least loaded partition
+	std::sort(vChunk.begin(), vChunk.end());
+	typedef std::pair<size_t, int> LoadProc;
+	std::priority_queue<LoadProc, std::vector<LoadProc>, std::greater<LoadProc> > pqLoad;
+	for (int p = 0; p < numPartitions; ++p)
+		pqLoad.push(LoadProc(0, p));
+
+	for (size_t c = 0; c < vChunk.size(); ++c)
+	{
+		LoadProc lp = pqLoad.top();
+		pqLoad.pop();
+
+		const std::vector<Edge*>& vEdges = mNeuronEdges[vChunk[c].nid];
+		const size_t end = vChunk[c].begin + vChunk[c].size;
+		for (size_t k = vChunk[c].begin; k < end; ++k)
+			partitionHandler.assign_subset(vEdges[k], lp.second);
+
+		lp.first += vChunk[c].size;
+		pqLoad.push(lp);
+	}
+
+	// statistics
+	size_t minLoad = nEdges;
+	size_t maxAssigned = 0;
+	while (!pqLoad.empty())
+	{
+		minLoad = std::min(minLoad, pqLoad.top().first);
+		maxAssigned = std::max(maxAssigned, pqLoad.top().first);
+		pqLoad.pop();
+	}
+
+	size_t nInterfaceVrts = 0;
+	typedef geometry_traits<Vertex>::iterator VrtIter;
+	for (VrtIter it = mg.begin<Vertex>(baseLevel); it != mg.end<Vertex>(baseLevel); ++it)
+	{
+		mg.associated_elements(assEdges, *it);
+		for (size_t k = 1; k < assEdges.size(); ++k)
+		{
+			if (partitionHandler.get_subset_index(assEdges[k])
+				!= partitionHandler.get_subset_index(assEdges[0]))
+			{
+				++nInterfaceVrts;
+				break;
+			}
+		}
+	}
+
+	UG_LOG("Neuron network partitioning: " << mNeuronEdges.size() << " neurons, "
+		<< nEdges << " edges on " << numPartitions << " partitions\n"
+		"  edges per partition: " << minLoad << " - " << maxAssigned
+		<< " (average " << avgLoad << ")\n"
+		"  split neurons: " << nSplit << ", interface vertices: " << nInterfaceVrts << "\n");
+
+	return nSplit;
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__PARTITIONED_DOMAIN_IO_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__PARTITIONED_DOMAIN_IO_H
+
+#ifdef UG_PARALLEL
+
+#include "common/util/smart_pointer.h"                     // for SmartPtr
+
+#include <string>                                          // for string
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/**
+ * @brief Save a distributed domain as pre-partitioned pieces
+ *
+ * Each process writes its part of the (distributed) multigrid to
+ * <fileBase>_p<rank>.ugx (with all subset handlers and the projection handler,
+ * as LoadDomain() expects them) and its interfaces to <fileBase>_p<rank>.itf:
+ * for each element type, interface type, level and neighbor process, the
+ * local indices of the interface elements in interface order (together with
+ * their centers, for a consistency check on loading).
+ *
+ * The intended use is to distribute a large generated grid once, with the
+ * number of processes and the load balancer of the production runs
+ * (e.g., Parmetis with a NeuriteAxialRefinementMarker as unificator, so that
+ * branching point volumes and radial neighbors stay together, and with
+ * MembraneCostBalanceWeights), and to save the result. Production runs
+ * then use LoadPartitionedDomain() instead of loading the grid on one
+ * process and distributing it.
+ *
+ * @param dom       distributed domain
+ * @param fileBase  base name of the piece files (including the directory)
+ */
+template <typename TDomain>
+void SavePartitionedDomain(SmartPtr<TDomain> dom, const std::string& fileBase);
+
+
+/**
+ * @brief Load a domain from pieces written by SavePartitionedDomain()
+ *
+ * Each process loads its own piece and restores its grid layouts, so no
+ * redistribution is necessary. The number of processes must be the same as
+ * when the pieces were written. Additional subset handlers (e.g., for
+ * projectors) have to be created in the domain before, as for LoadDomain().
+ *
+ * @param dom       empty domain
+ * @param fileBase  base name of the piece files (including the directory)
+ */
+template <typename TDomain>
+void LoadPartitionedDomain(SmartPtr<TDomain> dom, const std::string& fileBase);
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "partitioned_domain_io_impl.h"
+
+#endif // UG_PARALLEL
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__PARTITIONED_DOMAIN_IO_H
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#include "partitioned_domain_io.h"
+
+#include "common/error.h"                                        // for UG_COND_THROW
+#include "lib_disc/domain_util.h"                                // for LoadDomain
+#include "lib_grid/algorithms/geom_obj_util/geom_obj_util.h"     // for CalculateCenter
+#include "lib_grid/file_io/file_io_ugx.h"                        // for GridWriterUGX
+#include "lib_grid/parallelization/distributed_grid.h"           // for DistributedGridManager
+#include "lib_grid/refinement/projectors/projection_handler.h"   // for ProjectionHandler
+#include "pcl/pcl_base.h"                                        // for NumProcs, ProcRank, SynchronizeProcesses
+#include "../grid_generation/text_scanner.h"                     // for FileBuffer, LineScanner
+#include "../grid_generation/text_writer.h"                      // for TextFileWriter
+
+#include <cmath>                                                 // for std::fabs
+#include <cstring>                                               // for memchr
+#include <iomanip>                                               // for std::setw, std::setfill
+#include <sstream>                                               // for std::ostringstream
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+namespace partitioned_domain_io {
+
+/// interface types stored in the piece files
+inline int interface_type(size_t i)
+{
+	switch (i)
+	{
+		case 0: return INT_H_MASTER;
+		case 1: return INT_H_SLAVE;
+		case 2: return INT_V_MASTER;
+		default: return INT_V_SLAVE;
+	}
+}
+static const size_t numInterfaceTypes = 4;
+
+
+inline std::string piece_file_name(const std::string& fileBase, int rank, const char* ext)
+{
+	std::ostringstream oss;
+	oss << fileBase << "_p" << std::setw(4) << std::setfill('0') << rank << ext;
+	return oss.str();
+}
+
+
+/// interfaces of one element type, interface type, level and neighbor as read from a piece file
+struct InterfaceBlock
+{
+	long elemDim;
+	long itfType;
+	long lvl;
+	long proc;
+	std::vector<long> vInd;
+	std::vector<number> vCoord;  ///< dim coordinates per element
+};
+
+
+/// writes the interfaces of one element type (local indices in grid iteration order)
+template <typename TDomain, typename TElem>
+void write_interfaces(TextFileWriter& out, TDomain& dom, GridLayoutMap& glm, int elemDim)
+{
+	typedef typename GridLayoutMap::Types<TElem>::Layout Layout;
+	typedef typename GridLayoutMap::Types<TElem>::Interface Interface;
+	typedef typename TDomain::position_type position_type;
+
+	bool bAny = false;
+	for (size_t t = 0; t < numInterfaceTypes; ++t)
+		bAny = bAny || glm.has_layout<TElem>(interface_type(t));
+	if (!bAny)
+		return;
+
+	// the reader creates the elements in the same order in which they are iterated here
+	MultiGrid& mg = *dom.grid();
+	Attachment<int> aInd;
+	mg.attach_to<TElem>(aInd);
+	Grid::AttachmentAccessor<TElem, Attachment<int> > aaInd(mg, aInd);
+	int ind = 0;
+	typedef typename geometry_traits<TElem>::iterator ElemIter;
+	for (ElemIter it = mg.begin<TElem>(); it != mg.end<TElem>(); ++it)
+		aaInd[*it] = ind++;
+
+	typename TDomain::position_accessor_type& aaPos = dom.position_accessor();
+	for (size_t t = 0; t < numInterfaceTypes; ++t)
+	{
+		const int itfType = interface_type(t);
+		if (!glm.has_layout<TElem>(itfType))
+			continue;
+
+		Layout& layout = glm.get_layout<TElem>(itfType);
+		for (size_t lvl = 0; lvl < layout.num_levels(); ++lvl)
+		{
+			for (typename Layout::iterator iit = layout.begin(lvl); iit != layout.end(lvl); ++iit)
+			{
+				Interface& itfc = layout.interface(iit);
+				out.put_int(elemDim).put(' ').put_int(itfType).put(' ').put_int((long) lvl).put(' ')
+					.put_int(layout.proc_id(iit)).put(' ').put_int((long) itfc.size()).put('\n');
+
+				for (typename Interface::iterator it = itfc.begin(); it != itfc.end(); ++it)
+				{
+					TElem* elem = itfc.get_element(it);
+					out.put_int(aaInd[elem]);
+					const position_type center = CalculateCenter(elem, aaPos);
+					for (int d = 0; d < TDomain::dim; ++d)
+						out.put(' ').put_number(center[d]);
+					out.put('\n');
+				}
+			}
+		}
+	}
+
+	mg.detach_from<TElem>(aInd);
+}
+
+
+/// adds the elements of interface blocks of one element type to the grid layouts
+template <typename TDomain, typename TElem>
+void add_interfaces
+(
+	const std::vector<InterfaceBlock>& vBlock,
+	int elemDim,
+	TDomain& dom,
+	GridLayoutMap& glm,
+	const std::string& fileName
+)
+{
+	typedef typename TDomain::position_type position_type;
+
+	std::vector<TElem*> vElem;
+	MultiGrid& mg = *dom.grid();
+	typename TDomain::position_accessor_type& aaPos = dom.position_accessor();
+	for (size_t b = 0; b < vBlock.size(); ++b)
+	{
+		const InterfaceBlock& block = vBlock[b];
+		if (block.elemDim != elemDim)
+			continue;
+
+		// local elements in the order in which they have been written
+		if (vElem.empty())
+		{
+			vElem.reserve(mg.num<TElem>());
+			typedef typename geometry_traits<TElem>::iterator ElemIter;
+			for (ElemIter it = mg.begin<TElem>(); it != mg.end<TElem>(); ++it)
+				vElem.push_back(*it);
+		}
+
+		typename GridLayoutMap::Types<TElem>::Interface& itfc =
+			glm.get_layout<TElem>((int) block.itfType).interface((int) block.proc, (size_t) block.lvl);
+		const size_t nInd = block.vInd.size();
+		for (size_t i = 0; i < nInd; ++i)
+		{
+			const long ind = block.vInd[i];
+			UG_COND_THROW(ind < 0 || (size_t) ind >= vElem.size(), "Interface element index " << ind
+				<< " in '" << fileName << "' does not exist in the grid piece.");
+			TElem* elem = vElem[ind];
+
+			// consistency check (centers are only stored with few digits)
+			const position_type center = CalculateCenter(elem, aaPos);
+			for (int d = 0; d < TDomain::dim; ++d)
+			{
+				const number stored = block.vCoord[i*TDomain::dim + d];
+				UG_COND_THROW(std::fabs(center[d] - stored) > 1e-5 * (std::fabs(center[d]) + std::fabs(stored)) + 1e-12,
+					"Interface element " << ind << " in '" << fileName << "' is located at " << center
+					<< " in the grid piece, which does not match the stored position. "
+					"The piece files do not belong together.");
+			}
+
+			itfc.push_back(elem);
+		}
+	}
+}
+
+
+/// reads the interface file of a piece
+template <typename TDomain>
+void read_interfaces(const std::string& fileName, std::vector<InterfaceBlock>& vBlockOut)
+{
+	const int dim = TDomain::dim;
+
+	FileBuffer buf(fileName);
+	const char* p = buf.begin();
+	const char* const end = buf.end();
+
+	bool bHeader = false;
+	size_t lineCnt = 0;
+	size_t nRemaining = 0;
+	while (p != end)
+	{
+		++lineCnt;
+		const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+		if (!lineEnd) lineEnd = end;
+
+		LineScanner scanner(p, lineEnd);
+		p = lineEnd == end ? end : lineEnd + 1;
+
+		if (scanner.at_end())
+			continue;
+
+		// header: number of processes, rank, dimension
+		if (!bHeader)
+		{
+			long nProcs, rank, fileDim;
+			UG_COND_THROW(!(scanner.read_int(nProcs) && scanner.read_int(rank)
+				&& scanner.read_int(fileDim) && scanner.at_end()),
+				"Error reading '" << fileName << "': Invalid header in line " << lineCnt << ".");
+			UG_COND_THROW(nProcs != pcl::NumProcs(), "Grid pieces in '" << fileName << "' have been written for "
+				<< nProcs << " processes, but " << pcl::NumProcs() << " processes are used.");
+			UG_COND_THROW(rank != pcl::ProcRank(), "File '" << fileName << "' belongs to process " << rank << ".");
+			UG_COND_THROW(fileDim != dim, "File '" << fileName << "' belongs to a domain of dimension " << fileDim << ".");
+			bHeader = true;
+			continue;
+		}
+
+		// block header: element dimension, interface type, level, neighbor process, number of elements
+		if (!nRemaining)
+		{
+			vBlockOut.resize(vBlockOut.size() + 1);
+			InterfaceBlock& block = vBlockOut.back();
+			long nElem;
+			UG_COND_THROW(!(scanner.read_int(block.elemDim) && scanner.read_int(block.itfType)
+				&& scanner.read_int(block.lvl) && scanner.read_int(block.proc)
+				&& scanner.read_int(nElem) && scanner.at_end()) || nElem < 0 || block.elemDim < 0 || block.elemDim > 3,
+				"Error reading '" << fileName << "': Invalid interface header in line " << lineCnt << ".");
+			nRemaining = (size_t) nElem;
+			block.vInd.reserve(nRemaining);
+			block.vCoord.reserve(dim * nRemaining);
+			continue;
+		}
+
+		// interface element: local index and center
+		InterfaceBlock& block = vBlockOut.back();
+		long ind;
+		bool bValid = scanner.read_int(ind);
+		for (int d = 0; d < dim && bValid; ++d)
+		{
+			number x;
+			bValid = scanner.read_number(x);
+			block.vCoord.push_back(x);
+		}
+		UG_COND_THROW(!bValid || !scanner.at_end(), "Error reading '" << fileName
+			<< "': Invalid interface element in line " << lineCnt << ".");
+		block.vInd.push_back(ind);
+		--nRemaining;
+	}
+
+	UG_COND_THROW(!bHeader || nRemaining, "Error reading '" << fileName << "': File is incomplete.");
+}
+
+} // namespace partitioned_domain_io
+
+
+
+template <typename TDomain>
+void SavePartitionedDomain(SmartPtr<TDomain> dom, const std::string& fileBase)
+{
+	using namespace partitioned_domain_io;
+
+	UG_COND_THROW(!dom.valid(), "No valid domain given.");
+	MultiGrid& mg = *dom->grid();
+	DistributedGridManager* dgm = mg.distributed_grid_manager();
+	UG_COND_THROW(!dgm, "The domain's grid is not a distributed grid.");
+
+	const int rank = pcl::ProcRank();
+
+	// grid piece (with all subset handlers and the projection handler)
+	const std::string ugxName = piece_file_name(fileBase, rank, ".ugx");
+	GridWriterUGX ugxWriter;
+	ugxWriter.add_grid(mg, "defGrid", dom->position_attachment());
+	ugxWriter.add_subset_handler(*dom->subset_handler(), "defSH", 0);
+	const std::vector<std::string> vAddSH = dom->additional_subset_handler_names();
+	for (size_t i = 0; i < vAddSH.size(); ++i)
+		ugxWriter.add_subset_handler(*dom->additional_subset_handler(vAddSH[i]), vAddSH[i].c_str(), 0);
+	ProjectionHandler* projHandler = dynamic_cast<ProjectionHandler*>(dom->refinement_projector().get());
+	if (projHandler)
+		ugxWriter.add_projection_handler(*projHandler, "defPH", 0);
+	UG_COND_THROW(!ugxWriter.write_to_file(ugxName.c_str()),
+		"Grid piece could not be written to file '" << ugxName << "'.");
+
+	// interfaces
+	const std::string itfName = piece_file_name(fileBase, rank, ".itf");
+	{
+		TextFileWriter out(itfName);
+		out.put("# interfaces of a partitioned grid\n");
+		out.put("# number of processes, rank, dimension\n");
+		out.put_int(pcl::NumProcs()).put(' ').put_int(rank).put(' ').put_int(TDomain::dim).put('\n');
+		out.put("# per interface: element dimension, interface type, level, neighbor process, number of elements\n");
+		out.put("# per element: local index (in grid iteration order) and center\n");
+
+		GridLayoutMap& glm = dgm->grid_layout_map();
+		write_interfaces<TDomain, Vertex>(out, *dom, glm, 0);
+		write_interfaces<TDomain, Edge>(out, *dom, glm, 1);
+		write_interfaces<TDomain, Face>(out, *dom, glm, 2);
+		write_interfaces<TDomain, Volume>(out, *dom, glm, 3);
+		out.close();
+	}
+
+	// pieces are only usable once all of them have been written
+	pcl::SynchronizeProcesses();
+}
+
+
+
+template <typename TDomain>
+void LoadPartitionedDomain(SmartPtr<TDomain> dom, const std::string& fileBase)
+{
+	using namespace partitioned_domain_io;
+
+	UG_COND_THROW(!dom.valid(), "No valid domain given.");
+	MultiGrid& mg = *dom->grid();
+	DistributedGridManager* dgm = mg.distributed_grid_manager();
+	UG_COND_THROW(!dgm, "The domain's grid is not a distributed grid.");
+	UG_COND_THROW(mg.num<Vertex>(), "Partitioned domains can only be loaded into an empty domain.");
+
+	const int rank = pcl::ProcRank();
+
+	// read interfaces first (this also checks that the pieces match the processes)
+	const std::string itfName = piece_file_name(fileBase, rank, ".itf");
+	std::vector<InterfaceBlock> vBlock;
+	read_interfaces<TDomain>(itfName, vBlock);
+
+	// own grid piece
+	const std::string ugxName = piece_file_name(fileBase, rank, ".ugx");
+	try {LoadDomain(*dom, ugxName.c_str(), rank);}
+	UG_CATCH_THROW("Failed loading grid piece from '" << ugxName << "'.");
+
+	// restore grid layouts
+	GridLayoutMap& glm = dgm->grid_layout_map();
+	add_interfaces<TDomain, Vertex>(vBlock, 0, *dom, glm, itfName);
+	add_interfaces<TDomain, Edge>(vBlock, 1, *dom, glm, itfName);
+	add_interfaces<TDomain, Face>(vBlock, 2, *dom, glm, itfName);
+	add_interfaces<TDomain, Volume>(vBlock, 3, *dom, glm, itfName);
+	dgm->grid_layouts_changed(false);
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
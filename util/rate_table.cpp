@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "rate_table.h"
+
+#include "common/error.h"  // for UG_COND_THROW
+
+#include <algorithm>  // for std::max, std::min
+#include <cmath>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+RateTable::RateTable()
+: m_nFct(0), m_nNodes(0), m_vMin(0.0), m_vMax(0.0), m_invH(0.0), m_sMax(0.0), m_maxErr(0.0)
+{}
+
+
+void RateTable::init
+(
+	const std::vector<RateFct>& vFct,
+	number vMin,
+	number vMax,
+	number relTol,
+	size_t maxNodes
+)
+{
+	UG_COND_THROW(vFct.empty(), "No functions given for tabulation.");
+	UG_COND_THROW(!(vMin < vMax), "Invalid tabulation range [" << vMin << ", " << vMax << "].");
+	UG_COND_THROW(!(relTol > 0.0), "Tabulation tolerance must be positive.");
+	UG_COND_THROW(maxNodes < 2, "At least two nodes are required for tabulation.");
+
+	m_vFct = vFct;
+	m_nFct = vFct.size();
+	m_vMin = vMin;
+	m_vMax = vMax;
+
+	// refine until tolerance is met;
+	// linear interpolation error behaves like h^2, use that to estimate the next grid
+	size_t nNodes = std::min((size_t) 257, maxNodes);
+	while (true)
+	{
+		const number err = fill(nNodes);
+		if (err <= relTol || nNodes == maxNodes)
+			break;
+
+		const number factor = 1.1 * std::sqrt(err / relTol);
+		size_t nNew = (size_t) std::ceil((nNodes - 1) * factor) + 1;
+		nNew = std::max(nNew, 2*nNodes - 1);
+		nNodes = std::min(nNew, maxNodes);
+	}
+}
+
+
+number RateTable::fill(size_t nNodes)
+{
+	const number h = (m_vMax - m_vMin) / (nNodes - 1);
+
+	m_vTable.resize(nNodes * m_nFct);
+	for (size_t k = 0; k < nNodes; ++k)
+	{
+		const number v = m_vMin + k*h;
+		for (size_t f = 0; f < m_nFct; ++f)
+			m_vTable[k*m_nFct + f] = m_vFct[f](v);
+	}
+
+	// error at interval midpoints relative to function scale
+	m_maxErr = 0.0;
+	for (size_t f = 0; f < m_nFct; ++f)
+	{
+		number scale = 0.0;
+		for (size_t k = 0; k < nNodes; ++k)
+			scale = std::max(scale, std::fabs(m_vTable[k*m_nFct + f]));
+		if (scale == 0.0)
+			scale = 1.0;
+
+		for (size_t k = 0; k + 1 < nNodes; ++k)
+		{
+			const number interp = 0.5 * (m_vTable[k*m_nFct + f] + m_vTable[(k+1)*m_nFct + f]);
+			const number exact = m_vFct[f](m_vMin + (k + 0.5)*h);
+			m_maxErr = std::max(m_maxErr, std::fabs(interp - exact) / scale);
+		}
+	}
+
+	m_nNodes = nNodes;
+	m_invH = 1.0 / h;
+	m_sMax = (number) (nNodes - 1);
+
+	return m_maxErr;
+}
+
+
+void RateTable::eval_batch(const number* v, size_t n, size_t f, number* out) const
+{
+	// interpolate with clamped index (branch-free)
+	const number sUpper = m_sMax - 1e-12 * m_sMax;
+	const number* tab = &m_vTable[f];
+	for (size_t i = 0; i < n; ++i)
+	{
+		number s = (v[i] - m_vMin) * m_invH;
+		s = s < 0.0 ? 0.0 : (s > sUpper ? sUpper : s);
+		const size_t k = (size_t) s;
+		const number w = s - (number) k;
+		const number t0 = tab[k * m_nFct];
+		const number t1 = tab[(k+1) * m_nFct];
+		out[i] = t0 + w * (t1 - t0);
+	}
+
+	// exact values outside of tabulated range
+	for (size_t i = 0; i < n; ++i)
+	{
+		const number s = (v[i] - m_vMin) * m_invH;
+		if (!(s >= 0.0 && s < m_sMax))
+			out[i] = m_vFct[f](v[i]);
+	}
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
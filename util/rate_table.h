@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__RATE_TABLE_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__RATE_TABLE_H
+
+#include "common/types.h"  // for number
+
+#include <cstddef>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/// Tabulation of voltage-dependent rate functions
+/**
+ * This class pre-computes a number of scalar functions of the membrane potential
+ * (typically gating limit values, time constants and their derivatives) on a uniform
+ * voltage grid and evaluates them by linear interpolation.
+ * This avoids the (numerous) exponential evaluations in the exact rate functions.
+ *
+ * The grid width is chosen such that the interpolation error of each function,
+ * relative to the maximal absolute value of that function in the tabulated range,
+ * is below a given tolerance (as far as the maximal number of nodes permits;
+ * the achieved error can be queried by max_error()).
+ * Outside the tabulated range, the exact functions are evaluated.
+ *
+ * The table is stored node-major, i.e., all functions for one voltage node are
+ * contiguous, so that evaluating all functions at one voltage needs only one
+ * index computation and touches only two cache lines.
+ */
+class RateTable
+{
+	public:
+		/// function to be tabulated
+		typedef number (*RateFct)(number);
+
+	public:
+		/// constructor
+		RateTable();
+
+		/**
+		 * @brief Tabulate the given functions
+		 * @param vFct      functions to be tabulated
+		 * @param vMin      lower bound of the tabulated range
+		 * @param vMax      upper bound of the tabulated range
+		 * @param relTol    relative interpolation tolerance
+		 * @param maxNodes  maximal number of nodes
+		 */
+		void init
+		(
+			const std::vector<RateFct>& vFct,
+			number vMin,
+			number vMax,
+			number relTol = 1e-6,
+			size_t maxNodes = 1 << 16
+		);
+
+		/// whether the table has been initialized
+		bool is_initialized() const {return m_nNodes != 0;}
+
+		/// number of tabulated functions
+		size_t num_fcts() const {return m_vFct.size();}
+
+		/// number of nodes
+		size_t num_nodes() const {return m_nNodes;}
+
+		/// maximal relative interpolation error (measured at interval midpoints)
+		number max_error() const {return m_maxErr;}
+
+		/// memory held by the table
+		size_t memory_bytes() const {return m_vTable.capacity() * sizeof(number);}
+
+		/// evaluate all functions at v (out must have num_fcts() entries)
+		void eval(number v, number* out) const
+		{
+			const number s = (v - m_vMin) * m_invH;
+			if (s >= 0.0 && s < m_sMax)
+			{
+				const size_t k = (size_t) s;
+				const number w = s - (number) k;
+				const number* t0 = &m_vTable[k * m_nFct];
+				const number* t1 = t0 + m_nFct;
+				for (size_t f = 0; f < m_nFct; ++f)
+					out[f] = t0[f] + w * (t1[f] - t0[f]);
+				return;
+			}
+
+			for (size_t f = 0; f < m_nFct; ++f)
+				out[f] = m_vFct[f](v);
+		}
+
+		/// evaluate function f at v
+		number eval(number v, size_t f) const
+		{
+			const number s = (v - m_vMin) * m_invH;
+			if (s >= 0.0 && s < m_sMax)
+			{
+				const size_t k = (size_t) s;
+				const number w = s - (number) k;
+				const number* t0 = &m_vTable[k * m_nFct + f];
+				return t0[0] + w * (t0[m_nFct] - t0[0]);
+			}
+
+			return m_vFct[f](v);
+		}
+
+		/**
+		 * @brief Evaluate function f at n voltages
+		 * The interpolation loop is free of branches and calls (except for
+		 * voltages outside the tabulated range, which are treated afterwards),
+		 * so it can be vectorized by the compiler.
+		 */
+		void eval_batch(const number* v, size_t n, size_t f, number* out) const;
+
+	private:
+		/// fill table for given number of nodes, return maximal relative error
+		number fill(size_t nNodes);
+
+	private:
+		std::vector<RateFct> m_vFct;
+		size_t m_nFct;
+		size_t m_nNodes;
+		number m_vMin;
+		number m_vMax;
+		number m_invH;
+		number m_sMax;   ///< number of intervals
+		number m_maxErr;
+		std::vector<number> m_vTable;
+};
+
+/// @}
+
+} // namspace neuro_collection
+} // namespace ug
+
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__RATE_TABLE_H
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__RYR_BLOCK_JACOBI_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__RYR_BLOCK_JACOBI_H
+
+#include <string>
+#include <vector>
+
+#include "common/types.h"                                       // for number
+#include "lib_algebra/operator/interface/preconditioner.h"      // for IPreconditioner
+#include "lib_disc/function_spaces/grid_function.h"             // for GridFunction
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/**
+ * @brief Vertex-block Jacobi preconditioner/smoother for implicit RyR problems
+ *
+ * In RyRImplicit problems, the channel state kinetics (o2, c1, c2) are orders of magnitude
+ * faster than calcium diffusion and couple to calcium only within each ER membrane vertex.
+ * This preconditioner inverts the coupling block of all given functions in each vertex
+ * of the given subsets exactly (e.g., c_cyt, c_er, o2, c1, c2) and applies a point Jacobi
+ * step to all other unknowns. It is meant to be used as smoother within multigrid.
+ *
+ * The block structure is collected from the DoF distribution of the grid function
+ * the preconditioner is applied to, so it works on every level of a geometric multigrid.
+ * Only scalar (CPU) algebra is supported and only serial execution.
+ */
+template <typename TDomain, typename TAlgebra>
+class RyRBlockJacobi : public IPreconditioner<TAlgebra>
+{
+	public:
+		typedef IPreconditioner<TAlgebra> base_type;
+		typedef typename TAlgebra::vector_type vector_type;
+		typedef typename TAlgebra::matrix_type matrix_type;
+		typedef MatrixOperator<matrix_type, vector_type> matrix_operator_type;
+		typedef GridFunction<TDomain, TAlgebra> grid_function_type;
+
+	protected:
+		using base_type::set_debug;
+		using base_type::debug_writer;
+		using base_type::write_debug;
+
+	public:
+		/**
+		 * @brief constructor
+		 * @param fcts      functions coupled in each vertex block (comma-separated c-string)
+		 * @param subsets   subsets on which vertex blocks are inverted (comma-separated c-string)
+		 */
+		RyRBlockJacobi(const char* fcts, const char* subsets);
+
+		/// copy constructor
+		RyRBlockJacobi(const RyRBlockJacobi<TDomain, TAlgebra>& parent);
+
+		/// @copydoc ILinearIterator::clone()
+		virtual SmartPtr<ILinearIterator<vector_type> > clone();
+
+		/// @copydoc IPreconditioner::supports_parallel()
+		virtual bool supports_parallel() const {return false;}
+
+	protected:
+		/// @copydoc IPreconditioner::name()
+		virtual const char* name() const {return "RyRBlockJacobi";}
+
+		/// @copydoc IPreconditioner::preprocess()
+		virtual bool preprocess(SmartPtr<matrix_operator_type> pOp);
+
+		/// @copydoc IPreconditioner::step()
+		virtual bool step(SmartPtr<matrix_operator_type> pOp, vector_type& c, const vector_type& d);
+
+		/// @copydoc IPreconditioner::postprocess()
+		virtual bool postprocess() {return true;}
+
+	protected:
+		/// collect vertex blocks from the DoF distribution and invert them
+		void build_blocks(const grid_function_type& gf);
+
+		/// invert a dense n x n matrix (row-major) in place
+		static void invert_dense(number* M, size_t n);
+
+	private:
+		std::vector<std::string> m_vFct;
+		std::vector<std::string> m_vSubset;
+
+		const matrix_type* m_pA;					///< matrix of the last preprocess
+		const DoFDistribution* m_pBlockDD;			///< DoF distribution the blocks were built for
+
+		std::vector<size_t> m_vBlockStart;			///< offsets of blocks in m_vBlockInd (and their inverses)
+		std::vector<size_t> m_vBlockInd;			///< algebra indices of all blocks
+		std::vector<size_t> m_vInvStart;			///< offsets of block inverses in m_vBlockInv
+		std::vector<number> m_vBlockInv;			///< inverted blocks (row-major)
+		std::vector<bool> m_vbInBlock;				///< whether an index belongs to a block
+		std::vector<number> m_vDiagInv;				///< inverse diagonal for point Jacobi
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "ryr_block_jacobi_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__RYR_BLOCK_JACOBI_H
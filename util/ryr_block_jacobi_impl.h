@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "ryr_block_jacobi.h"
+
+#include <algorithm>                                            // for std::swap
+#include <cmath>                                                // for fabs
+
+#include "common/error.h"                                       // for UG_COND_THROW
+#include "common/util/string_util.h"                            // for TokenizeTrimString
+#include "lib_disc/common/function_group.h"                     // for FunctionGroup
+#include "lib_disc/common/subset_group.h"                       // for SubsetGroup
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TDomain, typename TAlgebra>
+RyRBlockJacobi<TDomain, TAlgebra>::RyRBlockJacobi(const char* fcts, const char* subsets)
+: m_vFct(TokenizeTrimString(fcts)),
+  m_vSubset(TokenizeTrimString(subsets)),
+  m_pA(NULL),
+  m_pBlockDD(NULL)
+{}
+
+
+template <typename TDomain, typename TAlgebra>
+RyRBlockJacobi<TDomain, TAlgebra>::RyRBlockJacobi(const RyRBlockJacobi<TDomain, TAlgebra>& parent)
+: base_type(parent),
+  m_vFct(parent.m_vFct),
+  m_vSubset(parent.m_vSubset),
+  m_pA(NULL),
+  m_pBlockDD(NULL)
+{}
+
+
+template <typename TDomain, typename TAlgebra>
+SmartPtr<ILinearIterator<typename TAlgebra::vector_type> > RyRBlockJacobi<TDomain, TAlgebra>::clone()
+{
+	return make_sp(new RyRBlockJacobi<TDomain, TAlgebra>(*this));
+}
+
+
+template <typename TDomain, typename TAlgebra>
+bool RyRBlockJacobi<TDomain, TAlgebra>::preprocess(SmartPtr<matrix_operator_type> pOp)
+{
+	const matrix_type& A = *pOp;
+	m_pA = &A;
+
+	// point Jacobi for all indices
+	const size_t nRows = A.num_rows();
+	m_vDiagInv.resize(nRows);
+	for (size_t i = 0; i < nRows; ++i)
+	{
+		const number diag = A(i, i);
+		UG_COND_THROW(diag == 0.0, "Zero diagonal entry in row " << i << ".");
+		m_vDiagInv[i] = 1.0 / diag;
+	}
+
+	// blocks need to be rebuilt for the new matrix
+	m_pBlockDD = NULL;
+
+	return true;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRBlockJacobi<TDomain, TAlgebra>::build_blocks(const grid_function_type& gf)
+{
+	UG_COND_THROW(!m_pA, "Preconditioner has not been preprocessed.");
+	const matrix_type& A = *m_pA;
+	ConstSmartPtr<DoFDistribution> dd = gf.dd();
+
+	m_vBlockStart.assign(1, 0);
+	m_vBlockInd.clear();
+	m_vInvStart.assign(1, 0);
+	m_vBlockInv.clear();
+	m_vbInBlock.assign(A.num_rows(), false);
+
+	FunctionGroup fctGrp;
+	try {fctGrp = FunctionGroup(dd->dof_distribution_info(), m_vFct);}
+	UG_CATCH_THROW("Function group creation failed.");
+
+	SubsetGroup ssGrp;
+	try {ssGrp = SubsetGroup(gf.domain()->subset_handler(), m_vSubset);}
+	UG_CATCH_THROW("Subset group creation failed.");
+
+	typedef typename DoFDistribution::traits<Vertex>::const_iterator it_type;
+	std::vector<DoFIndex> vDI;
+	std::vector<size_t> vInd;
+	const size_t nFct = fctGrp.size();
+	for (size_t si = 0; si < ssGrp.size(); ++si)
+	{
+		it_type it = dd->template begin<Vertex>(ssGrp[si]);
+		it_type itEnd = dd->template end<Vertex>(ssGrp[si]);
+		for (; it != itEnd; ++it)
+		{
+			// collect algebra indices of the block
+			vInd.clear();
+			for (size_t f = 0; f < nFct; ++f)
+			{
+				dd->inner_dof_indices(*it, fctGrp[f], vDI, true);
+				for (size_t k = 0; k < vDI.size(); ++k)
+					if (!m_vbInBlock[vDI[k][0]])
+						vInd.push_back(vDI[k][0]);
+			}
+			const size_t n = vInd.size();
+			if (!n)
+				continue;
+
+			// extract dense block
+			const size_t invStart = m_vBlockInv.size();
+			m_vBlockInv.resize(invStart + n*n, 0.0);
+			number* M = &m_vBlockInv[invStart];
+			for (size_t r = 0; r < n; ++r)
+			{
+				for (typename matrix_type::const_row_iterator conn = A.begin_row(vInd[r]);
+					conn != A.end_row(vInd[r]); ++conn)
+				{
+					for (size_t s = 0; s < n; ++s)
+						if (conn.index() == vInd[s])
+							M[r*n + s] = conn.value();
+				}
+			}
+
+			// invert
+			try {invert_dense(M, n);}
+			UG_CATCH_THROW("Vertex block for " << ElementDebugInfo(*gf.domain()->grid(), *it)
+				<< " could not be inverted.");
+
+			for (size_t r = 0; r < n; ++r)
+			{
+				m_vBlockInd.push_back(vInd[r]);
+				m_vbInBlock[vInd[r]] = true;
+			}
+			m_vBlockStart.push_back(m_vBlockInd.size());
+			m_vInvStart.push_back(m_vBlockInv.size());
+		}
+	}
+
+	m_pBlockDD = dd.get();
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void RyRBlockJacobi<TDomain, TAlgebra>::invert_dense(number* M, size_t n)
+{
+	// Gauss-Jordan elimination with partial pivoting
+	std::vector<size_t> perm(n);
+	for (size_t i = 0; i < n; ++i)
+		perm[i] = i;
+
+	for (size_t k = 0; k < n; ++k)
+	{
+		size_t piv = k;
+		for (size_t i = k+1; i < n; ++i)
+			if (fabs(M[i*n + k]) > fabs(M[piv*n + k]))
+				piv = i;
+		UG_COND_THROW(M[piv*n + k] == 0.0, "Singular block.");
+		if (piv != k)
+		{
+			for (size_t j = 0; j < n; ++j)
+				std::swap(M[k*n + j], M[piv*n + j]);
+			std::swap(perm[k], perm[piv]);
+		}
+
+		const number pivInv = 1.0 / M[k*n + k];
+		M[k*n + k] = 1.0;
+		for (size_t j = 0; j < n; ++j)
+			M[k*n + j] *= pivInv;
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			if (i == k) continue;
+			const number f = M[i*n + k];
+			M[i*n + k] = 0.0;
+			for (size_t j = 0; j < n; ++j)
+				M[i*n + j] -= f * M[k*n + j];
+		}
+	}
+
+	// undo the row permutation (as column permutation of the inverse)
+	std::vector<number> row(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		for (size_t j = 0; j < n; ++j)
+			row[perm[j]] = M[i*n + j];
+		for (size_t j = 0; j < n; ++j)
+			M[i*n + j] = row[j];
+	}
+}
+
+
+template <typename TDomain, typename TAlgebra>
+bool RyRBlockJacobi<TDomain, TAlgebra>::step
+(
+	SmartPtr<matrix_operator_type> pOp,
+	vector_type& c,
+	const vector_type& d
+)
+{
+	// the block structure is taken from the DoF distribution of the grid function
+	const grid_function_type* pGF = dynamic_cast<const grid_function_type*>(&d);
+	UG_COND_THROW(!pGF, "RyRBlockJacobi can only be applied to grid functions.");
+	if (pGF->dd().get() != m_pBlockDD)
+		build_blocks(*pGF);
+
+	const number damp = this->damping()->damping();
+
+	// point Jacobi for indices not in any block
+	const size_t sz = m_vDiagInv.size();
+	for (size_t i = 0; i < sz; ++i)
+		if (!m_vbInBlock[i])
+			c[i] = damp * m_vDiagInv[i] * d[i];
+
+	// exact inversion of the vertex blocks
+	const size_t nBlocks = m_vBlockStart.size() - 1;
+	for (size_t b = 0; b < nBlocks; ++b)
+	{
+		const size_t* ind = &m_vBlockInd[m_vBlockStart[b]];
+		const size_t n = m_vBlockStart[b+1] - m_vBlockStart[b];
+		const number* Minv = &m_vBlockInv[m_vInvStart[b]];
+		for (size_t r = 0; r < n; ++r)
+		{
+			number sum = 0.0;
+			for (size_t s = 0; s < n; ++s)
+				sum += Minv[r*n + s] * d[ind[s]];
+			c[ind[r]] = damp * sum;
+		}
+	}
+
+	return true;
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
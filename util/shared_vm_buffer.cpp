@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#include "shared_vm_buffer.h"
+
+#include <algorithm>  // for std::copy
+
+#include "common/error.h"  // for UG_COND_THROW
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <int dim>
+SharedVmBuffer<dim>::SharedVmBuffer()
+: m_time(0.0), m_revision(0)
+{}
+
+
+template <int dim>
+void SharedVmBuffer<dim>::set_points(const std::vector<number>& vCoords, number vmRest)
+{
+	UG_COND_THROW(vCoords.size() % dim, "Number of coordinates (" << vCoords.size()
+		<< ") is not a multiple of the dimension (" << dim << ").");
+
+	const size_t nPts = vCoords.size() / dim;
+	m_vPts.resize(nPts);
+	for (size_t i = 0; i < nPts; ++i)
+		for (int d = 0; d < dim; ++d)
+			m_vPts[i][d] = vCoords[dim*i + d];
+
+	m_vVm.assign(nPts, vmRest);
+	++m_revision;
+}
+
+
+template <int dim>
+void SharedVmBuffer<dim>::set_values(const std::vector<number>& vVm, number time)
+{
+	UG_COND_THROW(vVm.size() != m_vVm.size(), "Number of potential values (" << vVm.size()
+		<< ") does not match number of points (" << m_vVm.size() << ").");
+
+	std::copy(vVm.begin(), vVm.end(), m_vVm.begin());
+	values_changed(time);
+}
+
+
+// explicit template specializations
+#ifdef UG_DIM_1
+	template class SharedVmBuffer<1>;
+#endif
+#ifdef UG_DIM_2
+	template class SharedVmBuffer<2>;
+#endif
+#ifdef UG_DIM_3
+	template class SharedVmBuffer<3>;
+#endif
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__SHARED_VM_BUFFER_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__SHARED_VM_BUFFER_H
+
+#include <cstddef>                       // for size_t
+#include <vector>                        // for vector
+
+#include "common/math/ugmath.h"          // for MathVector
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/**
+ * @brief In-memory buffer of membrane potentials at a fixed set of points
+ *
+ * This buffer is meant for coupling an electrical simulator running in the same
+ * process (such as NEURON) to the 3d calcium simulation without going through
+ * files: The point layout (e.g., the segment centers of the NEURON model) is set
+ * once; afterwards, each update only writes the new potential values in the same
+ * order, either by copying a vector (set_values()) or by writing directly into the
+ * storage returned by data() and calling values_changed().
+ *
+ * Consumers (see VDCC_BG_VM2UG_NEURON::set_shared_vm_buffer()) map their locations
+ * to the nearest buffer point once and only read values afterwards.
+ * Potentials are stored in mV.
+ */
+template <int dim>
+class SharedVmBuffer
+{
+	public:
+		typedef MathVector<dim> pos_type;
+
+	public:
+		/// constructor
+		SharedVmBuffer();
+
+		/**
+		 * @brief set the point layout
+		 * The layout must not change after consumers have mapped to it.
+		 * All values are initialized with the given resting potential.
+		 *
+		 * @param vCoords   point coordinates (dim consecutive entries per point)
+		 * @param vmRest    initial potential value (mV)
+		 */
+		void set_points(const std::vector<number>& vCoords, number vmRest);
+
+		/// point layout
+		const std::vector<pos_type>& points() const {return m_vPts;}
+
+		/// number of points
+		size_t num_points() const {return m_vPts.size();}
+
+		/**
+		 * @brief copy new potential values
+		 * @param vVm    potential values (mV), one per point in layout order
+		 * @param time   simulation time the values belong to
+		 */
+		void set_values(const std::vector<number>& vVm, number time);
+
+		/// storage for direct writes (num_points() values in layout order)
+		number* data() {return m_vVm.empty() ? NULL : &m_vVm[0];}
+
+		/// storage for direct reads
+		const number* data() const {return m_vVm.empty() ? NULL : &m_vVm[0];}
+
+		/// notify that values have been written to data() for the given time
+		void values_changed(number time) {m_time = time; ++m_revision;}
+
+		/// potential value (mV) at the i-th point
+		number value(size_t i) const {return m_vVm[i];}
+
+		/// simulation time the current values belong to
+		number time() const {return m_time;}
+
+		/// revision of the values (incremented by each update)
+		size_t revision() const {return m_revision;}
+
+	protected:
+		std::vector<pos_type> m_vPts;
+		std::vector<number> m_vVm;
+		number m_time;
+		size_t m_revision;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__SHARED_VM_BUFFER_H
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__SIMULATION_DRIVER_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__SIMULATION_DRIVER_H
+
+#include <cstddef>                       // for size_t
+#include <string>                        // for string
+#include <vector>                        // for vector
+
+#include "common/util/smart_pointer.h"   // for SmartPtr
+#include "lib_algebra/operator/interface/operator_inverse.h"  // for IOperatorInverse
+#include "lib_disc/function_spaces/grid_function.h"  // for GridFunction
+#include "lib_disc/time_disc/time_disc_interface.h"  // for ITimeDiscretization
+
+#include "ca_wave_util.h"                // for WaveProfileExporter, WaveFrontTracker
+#include "measurement.h"                 // for Measurement
+#include "time_step_controller.h"        // for TimeStepController
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+/**
+ * @brief Native time stepping loop for calcium simulations
+ *
+ * Runs the usual scripted loop (prepare step, solve, measure, export, adapt the
+ * step size) in C++, so that simulations with many cheap time steps are not
+ * dominated by per-step script overhead. Measurement and export objects build
+ * their subset and function groups once on construction, so nothing is looked
+ * up by name during the loop.
+ *
+ * Per accepted step, in this order:
+ * - the wave front tracker (if set) is updated and its velocity is passed on to
+ *   the time step controller,
+ * - measurements and wave profile exports are taken at their intervals,
+ * - the script hook (if set) is called at its interval.
+ *
+ * Without a time step controller, the step size is constant; it is halved
+ * (down to the minimal step size) if the solver fails.
+ * With a controller, the relative change ||u_new - u_old|| / ||u_new|| of each
+ * step is passed to TimeStepController::check_step(), which decides on acceptance
+ * and on the next step size.
+ */
+template <typename TDomain, typename TAlgebra>
+class CalciumSimulationDriver
+{
+	public:
+		typedef GridFunction<TDomain, TAlgebra> gf_type;
+		typedef typename TAlgebra::vector_type vector_type;
+
+	public:
+		/**
+		 * @brief constructor
+		 * @param timeDisc   time discretization (e.g., ThetaTimeStep)
+		 * @param solver     (non-linear) solver for one time step (e.g., NewtonSolver)
+		 */
+		CalciumSimulationDriver
+		(
+			SmartPtr<ITimeDiscretization<TAlgebra> > timeDisc,
+			SmartPtr<IOperatorInverse<vector_type> > solver
+		);
+
+		/// set (initial) time step size (in s)
+		void set_time_step(number dt);
+
+		/// set minimal time step size for step reduction on solver failure (without controller)
+		void set_min_time_step(number dtMin);
+
+		/// set adaptive time step controller
+		void set_time_step_controller(SmartPtr<TimeStepController> ctrl);
+
+		/// add a measurement taken every interval accepted steps
+		void add_measurement(SmartPtr<Measurement<gf_type> > meas, size_t interval);
+
+		/// add a wave profile export written every interval accepted steps
+		void add_wave_profile_export(SmartPtr<WaveProfileExporter<TDomain, TAlgebra> > exp, size_t interval);
+
+		/// set wave front tracker updated in every accepted step
+		void set_wave_front_tracker(SmartPtr<WaveFrontTracker<TDomain, TAlgebra> > tracker);
+
+		/**
+		 * @brief set a script function called every interval accepted steps
+		 * The function is called with the step number, time and step size and
+		 * may return false to end the simulation.
+		 */
+		void set_script_hook(const char* fctName, size_t interval);
+
+		/// set whether to print a line per time step (default: false)
+		void set_verbose(bool b);
+
+		/**
+		 * @brief run the simulation
+		 * @param u          initial solution (overwritten by the final solution)
+		 * @param startTime  start time
+		 * @param endTime    end time
+		 * @return           time reached (less than endTime if stopped by the script hook)
+		 */
+		number run(SmartPtr<gf_type> u, number startTime, number endTime);
+
+		/// number of accepted steps in the last run
+		size_t num_steps() const {return m_nSteps;}
+
+		/// number of rejected or failed steps in the last run
+		size_t num_rejected_steps() const {return m_nRejected;}
+
+	protected:
+		/// post-processing of an accepted step; returns false if the simulation is to be stopped
+		bool step_done(SmartPtr<gf_type> u, number time, number dt);
+
+		/// call the script hook; returns false if it asks to stop
+		bool call_script_hook(number time, number dt) const;
+
+	protected:
+		SmartPtr<ITimeDiscretization<TAlgebra> > m_spTimeDisc;
+		SmartPtr<IOperatorInverse<vector_type> > m_spSolver;
+		SmartPtr<TimeStepController> m_spDtCtrl;
+
+		number m_dt;
+		number m_dtMin;
+
+		std::vector<SmartPtr<Measurement<gf_type> > > m_vMeas;
+		std::vector<size_t> m_vMeasInterval;
+		std::vector<SmartPtr<WaveProfileExporter<TDomain, TAlgebra> > > m_vExp;
+		std::vector<size_t> m_vExpInterval;
+		SmartPtr<WaveFrontTracker<TDomain, TAlgebra> > m_spTracker;
+
+		std::string m_hookName;
+		size_t m_hookInterval;
+
+		bool m_bVerbose;
+		size_t m_nSteps;
+		size_t m_nRejected;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "simulation_driver_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__SIMULATION_DRIVER_H
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+
+#include "simulation_driver.h"
+
+#include <algorithm>  // for std::max
+#include <limits>     // for std::numeric_limits
+
+#include "common/error.h"                                  // for UG_THROW
+#include "common/log.h"                                    // for UG_LOG
+#include "lib_disc/operator/non_linear_operator/assembled_non_linear_operator.h"  // for AssembledOperator
+#include "lib_disc/time_disc/solution_time_series.h"       // for VectorTimeSeries
+#ifdef UG_FOR_LUA
+	#include "bindings/lua/lua_util.h"                     // for script::GetDefaultLuaState
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TDomain, typename TAlgebra>
+CalciumSimulationDriver<TDomain, TAlgebra>::CalciumSimulationDriver
+(
+	SmartPtr<ITimeDiscretization<TAlgebra> > timeDisc,
+	SmartPtr<IOperatorInverse<vector_type> > solver
+)
+: m_spTimeDisc(timeDisc), m_spSolver(solver),
+  m_dt(1e-5), m_dtMin(1e-9),
+  m_hookInterval(0),
+  m_bVerbose(false), m_nSteps(0), m_nRejected(0)
+{}
+
+
+template <typename TDomain, typename TAlgebra>
+void CalciumSimulationDriver<TDomain, TAlgebra>::set_time_step(number dt)
+{
+	UG_COND_THROW(dt <= 0.0, "Time step size must be positive.");
+	m_dt = dt;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void CalciumSimulationDriver<TDomain, TAlgebra>::set_min_time_step(number dtMin)
+{
+	m_dtMin = dtMin;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void CalciumSimulationDriver<TDomain, TAlgebra>::set_time_step_controller(SmartPtr<TimeStepController> ctrl)
+{
+	m_spDtCtrl = ctrl;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void CalciumSimulationDriver<TDomain, TAlgebra>::add_measurement
+(
+	SmartPtr<Measurement<gf_type> > meas,
+	size_t interval
+)
+{
+	m_vMeas.push_back(meas);
+	m_vMeasInterval.push_back(std::max(interval, (size_t) 1));
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void CalciumSimulationDriver<TDomain, TAlgebra>::add_wave_profile_export
+(
+	SmartPtr<WaveProfileExporter<TDomain, TAlgebra> > exp,
+	size_t interval
+)
+{
+	m_vExp.push_back(exp);
+	m_vExpInterval.push_back(std::max(interval, (size_t) 1));
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void CalciumSimulationDriver<TDomain, TAlgebra>::set_wave_front_tracker
+(
+	SmartPtr<WaveFrontTracker<TDomain, TAlgebra> > tracker
+)
+{
+	m_spTracker = tracker;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void CalciumSimulationDriver<TDomain, TAlgebra>::set_script_hook(const char* fctName, size_t interval)
+{
+#ifndef UG_FOR_LUA
+	UG_THROW("Script hooks are only available with Lua bindings.");
+#endif
+	m_hookName = fctName;
+	m_hookInterval = interval;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+void CalciumSimulationDriver<TDomain, TAlgebra>::set_verbose(bool b)
+{
+	m_bVerbose = b;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+bool CalciumSimulationDriver<TDomain, TAlgebra>::call_script_hook(number time, number dt) const
+{
+#ifdef UG_FOR_LUA
+	lua_State* L = script::GetDefaultLuaState();
+	lua_getglobal(L, m_hookName.c_str());
+	UG_COND_THROW(!lua_isfunction(L, -1), "Script hook '" << m_hookName << "' is not a function.");
+
+	lua_pushnumber(L, (lua_Number) m_nSteps);
+	lua_pushnumber(L, time);
+	lua_pushnumber(L, dt);
+	if (lua_pcall(L, 3, 1, 0) != 0)
+	{
+		const std::string msg = lua_tostring(L, -1);
+		lua_pop(L, 1);
+		UG_THROW("Error in script hook '" << m_hookName << "': " << msg);
+	}
+
+	// continue unless the hook explicitly returns false
+	const bool cont = lua_isnil(L, -1) || lua_toboolean(L, -1);
+	lua_pop(L, 1);
+	return cont;
+#else
+	return true;
+#endif
+}
+
+
+template <typename TDomain, typename TAlgebra>
+bool CalciumSimulationDriver<TDomain, TAlgebra>::step_done(SmartPtr<gf_type> u, number time, number dt)
+{
+	if (m_spTracker.valid())
+	{
+		m_spTracker->update(u, time);
+		if (m_spDtCtrl.valid())
+			m_spDtCtrl->set_wave_front_velocity(m_spTracker->front_velocity());
+	}
+
+	for (size_t i = 0; i < m_vMeas.size(); ++i)
+		if (m_nSteps % m_vMeasInterval[i] == 0)
+			m_vMeas[i]->take(time);
+
+	for (size_t i = 0; i < m_vExp.size(); ++i)
+		if (m_nSteps % m_vExpInterval[i] == 0)
+			m_vExp[i]->exportWaveProfileX(u, time);
+
+	if (!m_hookName.empty() && m_hookInterval && m_nSteps % m_hookInterval == 0)
+		return call_script_hook(time, dt);
+
+	return true;
+}
+
+
+template <typename TDomain, typename TAlgebra>
+number CalciumSimulationDriver<TDomain, TAlgebra>::run(SmartPtr<gf_type> u, number startTime, number endTime)
+{
+	UG_COND_THROW(!m_spTimeDisc.valid(), "No time discretization given.");
+	UG_COND_THROW(!m_spSolver.valid(), "No solver given.");
+
+	m_nSteps = 0;
+	m_nRejected = 0;
+
+	// operator and solution time series are set up once
+	SmartPtr<AssembledOperator<TAlgebra> > spOp =
+		make_sp(new AssembledOperator<TAlgebra>(m_spTimeDisc, u->grid_level()));
+	m_spSolver->init(spOp);
+
+	SmartPtr<VectorTimeSeries<vector_type> > spSolTimeSeries = make_sp(new VectorTimeSeries<vector_type>());
+	spSolTimeSeries->push(u->clone(), startTime);
+	SmartPtr<gf_type> spDiff = u->clone_without_values();
+
+	// initial state
+	number time = startTime;
+	if (!step_done(u, time, 0.0))
+		return time;
+
+	const number eps = 1e-8 * m_dt;
+	number dt = m_dt;
+	while (time < endTime - eps)
+	{
+		// do not step beyond the end
+		const number dtStep = std::min(dt, endTime - time);
+
+		m_spTimeDisc->prepare_step(spSolTimeSeries, dtStep);
+
+		bool converged;
+		try
+		{
+			m_spSolver->prepare(*u);
+			converged = m_spSolver->apply(*u);
+		}
+		UG_CATCH_THROW("Solver failed in time step " << m_nSteps + 1 << " at time " << time << ".");
+
+		// relative change of the solution in this step
+		number relChange = std::numeric_limits<number>::max();
+		if (converged)
+		{
+			VecScaleAdd(*spDiff, 1.0, *u, -1.0, *spSolTimeSeries->solution(0));
+			const number uNorm = u->norm();
+			relChange = uNorm > 0.0 ? spDiff->norm() / uNorm : 0.0;
+		}
+
+		// accept or repeat the step
+		bool accept = converged;
+		if (m_spDtCtrl.valid())
+		{
+			accept = m_spDtCtrl->check_step(dtStep, relChange) && converged;
+			UG_COND_THROW(!converged && m_spDtCtrl->next_dt() >= dtStep,
+				"Solver failed at minimal time step size " << dtStep << " at time " << time << ".");
+			dt = m_spDtCtrl->next_dt();
+		}
+		else if (!converged)
+		{
+			UG_COND_THROW(dtStep <= m_dtMin,
+				"Solver failed at minimal time step size " << dtStep << " at time " << time << ".");
+			dt = std::max(0.5 * dtStep, m_dtMin);
+		}
+
+		if (!accept)
+		{
+			++m_nRejected;
+			if (m_bVerbose)
+				UG_LOG("Step " << m_nSteps + 1 << " rejected (dt = " << dtStep << "), retrying with dt = " << dt << ".\n");
+			static_cast<vector_type&>(*u) = *spSolTimeSeries->solution(0);
+			continue;
+		}
+
+		m_spTimeDisc->finish_step_elem(spSolTimeSeries, u->grid_level());
+
+		// push solution, re-using the storage of the oldest one
+		time += dtStep;
+		++m_nSteps;
+		SmartPtr<vector_type> spOldest = spSolTimeSeries->oldest();
+		*spOldest = static_cast<const vector_type&>(*u);
+		spSolTimeSeries->push_discard_oldest(spOldest, time);
+
+		if (m_bVerbose)
+			UG_LOG("Step " << m_nSteps << ": t = " << time << ", dt = " << dtStep << ".\n");
+
+		if (!step_done(u, time, dtStep))
+			break;
+	}
+
+	return time;
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -79,6 +79,7 @@ namespace neuro_collection {
  * \param outFileName	the name of the output file(s), i.e. their prefix
  *
  * \warning This function is very old and will probably not work properly.
+ * \deprecated Use SolutionCheckpoint for checkpoints (also in parallel).
  */
 template <typename TGridFunction>
 void exportSolution
@@ -103,6 +104,8 @@ void exportSolution
  * \param subsetNames	subsets the solution is to be specified on
  * \param functionName	function the solution is to be specified for
  * \param inFileName	the name of the input file
+ *
+ * \deprecated Use SolutionCheckpoint for restarts (also in parallel).
  */
 template <typename TGridFunction>
 void importSolution
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__THREAD_SCRATCH_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__THREAD_SCRATCH_H
+
+#include "common/assert.h"  // for UG_ASSERT
+
+#include <cstddef>
+#include <vector>
+
+#ifdef _OPENMP
+	#include <omp.h>
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/// index of the calling thread, unique among all running threads (0 without OpenMP)
+/**
+ * omp_get_thread_num() is only unique within the innermost team; in a (possibly
+ * inactive) nested parallel region, threads of different outer threads share ids.
+ * The index is therefore composed of the thread numbers on all nesting levels.
+ */
+inline size_t thread_index()
+{
+#ifdef _OPENMP
+	const int level = omp_get_level();
+	size_t t = 0;
+	for (int l = 1; l <= level; ++l)
+		t = t * (size_t) omp_get_team_size(l) + (size_t) omp_get_ancestor_thread_num(l);
+	return t;
+#else
+	return 0;
+#endif
+}
+
+/// maximal number of threads a parallel region may use (1 if compiled without OpenMP)
+inline size_t max_num_threads()
+{
+#ifdef _OPENMP
+	return (size_t) omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+
+/// Scratch storage with one instance per thread
+/**
+ * Element discs and membrane transporters use scratch buffers in order to avoid
+ * allocations in every assembling call. If those calls are made from several
+ * threads concurrently, each thread has to work on its own buffers.
+ * This class holds one instance of the scratch type for each thread
+ * and hands out the instance of the calling thread.
+ *
+ * The number of instances is fixed on construction; if the number of threads
+ * changes afterwards, ensure_capacity() has to be called from outside any
+ * parallel region before local() is used again.
+ * Only one level of active parallelism is supported (nested regions must be
+ * inactive, i.e., run with one thread each).
+ *
+ * The element loops themselves are run by ug4's domain assembler; this plugin
+ * does not provide a threaded (colored or partitioned) assembling loop. The
+ * per-thread scratch only makes the discs and transporters re-entrant for
+ * threaded callers (such as the OpenMP loops over integration points and vertices).
+ *
+ * Instances are padded to separate cache lines in order to avoid false sharing.
+ */
+template <typename T>
+class ThreadScratch
+{
+	public:
+		ThreadScratch()
+		: m_vSlot(max_num_threads()) {}
+
+		/// make sure there is an instance for every thread (not thread-safe)
+		void ensure_capacity()
+		{
+			const size_t nThreads = max_num_threads();
+			if (m_vSlot.size() < nThreads)
+				m_vSlot.resize(nThreads);
+		}
+
+		/// instance of the calling thread
+		T& local() const
+		{
+#ifdef _OPENMP
+			UG_ASSERT(omp_get_active_level() <= 1, "Scratch instances cannot be used "
+				"in nested active parallel regions.");
+#endif
+			const size_t t = thread_index();
+			UG_ASSERT(t < m_vSlot.size(), "No scratch instance for thread " << t
+				<< " (only " << m_vSlot.size() << " allocated).");
+			return m_vSlot[t].val;
+		}
+
+		/// number of instances
+		size_t size() const {return m_vSlot.size();}
+
+		/// instance of thread t
+		T& operator[](size_t t) const {return m_vSlot[t].val;}
+
+	private:
+		struct Slot
+		{
+			T val;
+			char pad[64];
+		};
+		mutable std::vector<Slot> m_vSlot;
+};
+
+/// @}
+
+} // namespace neuro_collection
+} // namespace ug
+
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__THREAD_SCRATCH_H
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+
+#include "time_step_controller.h"
+
+#include "common/error.h"  // for UG_COND_THROW
+
+#include <algorithm>  // for std::min, std::max
+#include <cmath>  // for fabs
+#include <limits>  // for std::numeric_limits
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_base.h"  // for NumProcs
+	#include "pcl/pcl_process_communicator.h"  // for ProcessCommunicator
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+TimeStepController::TimeStepController()
+: m_dtMin(1e-9), m_dtMax(1e-2), m_maxGrowth(2.0), m_maxShrink(0.25), m_safety(0.9),
+  m_tol(1e-2), m_timeScaleFrac(0.1), m_frontResolution(0.0), m_frontVelocity(0.0),
+  m_nextDt(1e-9), m_nAccepted(0), m_nRejected(0)
+{}
+
+
+void TimeStepController::add_transporter(SmartPtr<IMembraneTransporter> mt)
+{
+	UG_COND_THROW(!mt.valid(), "Invalid membrane transport mechanism.");
+	m_vTransporter.push_back(mt);
+}
+
+
+void TimeStepController::set_time_step_bounds(number dtMin, number dtMax)
+{
+	UG_COND_THROW(dtMin <= 0.0 || dtMax < dtMin, "Bounds must satisfy 0 < dtMin <= dtMax.");
+	m_dtMin = dtMin;
+	m_dtMax = dtMax;
+	m_nextDt = std::min(std::max(m_nextDt, m_dtMin), m_dtMax);
+}
+
+
+void TimeStepController::set_growth_limits(number maxGrowth, number maxShrink)
+{
+	UG_COND_THROW(maxGrowth < 1.0 || maxShrink <= 0.0 || maxShrink > 1.0,
+		"Growth limit must be >= 1, shrinking limit in (0,1].");
+	m_maxGrowth = maxGrowth;
+	m_maxShrink = maxShrink;
+}
+
+
+void TimeStepController::set_safety_factor(number safety)
+{
+	UG_COND_THROW(safety <= 0.0 || safety > 1.0, "Safety factor must be in (0,1].");
+	m_safety = safety;
+}
+
+
+void TimeStepController::set_change_tolerance(number tol)
+{
+	UG_COND_THROW(tol <= 0.0, "Tolerance must be positive.");
+	m_tol = tol;
+}
+
+
+void TimeStepController::set_time_scale_fraction(number frac)
+{
+	UG_COND_THROW(frac <= 0.0, "Time scale fraction must be positive.");
+	m_timeScaleFrac = frac;
+}
+
+
+void TimeStepController::set_wave_front_resolution(number h)
+{
+	m_frontResolution = h;
+}
+
+
+void TimeStepController::set_wave_front_velocity(number v)
+{
+	m_frontVelocity = v;
+}
+
+
+number TimeStepController::characteristic_time_scale() const
+{
+	number timeScale = std::numeric_limits<number>::max();
+	const size_t nMt = m_vTransporter.size();
+	for (size_t i = 0; i < nMt; ++i)
+		timeScale = std::min(timeScale, m_timeScaleFrac * m_vTransporter[i]->characteristic_time_scale());
+
+	// the front is to pass at most one element per step
+	if (m_frontResolution > 0.0 && m_frontVelocity != 0.0)
+		timeScale = std::min(timeScale, m_frontResolution / fabs(m_frontVelocity));
+
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		timeScale = com.allreduce(timeScale, PCL_RO_MIN);
+	}
+#endif
+
+	return timeScale;
+}
+
+
+bool TimeStepController::check_step(number dt, number relChange)
+{
+	const bool accept = relChange <= m_tol || dt <= m_dtMin;
+
+	// step size for which the change is expected to meet the tolerance
+	number factor = relChange > 0.0 ? m_safety * m_tol / relChange : m_maxGrowth;
+	factor = std::max(factor, m_maxShrink);
+	factor = std::min(factor, accept ? m_maxGrowth : 1.0);
+
+	number newDt = std::min(factor * dt, characteristic_time_scale());
+	m_nextDt = std::min(std::max(newDt, m_dtMin), m_dtMax);
+
+	if (accept)
+		++m_nAccepted;
+	else
+		++m_nRejected;
+
+	return accept;
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-15
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__TIME_STEP_CONTROLLER_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__TIME_STEP_CONTROLLER_H
+
+#include "common/types.h"  // for number
+#include "common/util/smart_pointer.h"  // for SmartPtr
+#include "../membrane_transporters/membrane_transporter_interface.h"  // for IMembraneTransporter
+
+#include <cstddef>
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+/// @addtogroup neuro_collection
+/// @{
+
+/// Time step size control based on the kinetics of the membrane mechanisms
+/**
+ * After each time step, the user passes the size of the step and a measure of
+ * the relative change of the solution (or the fluxes) in this step to check_step().
+ * The step is rejected if the change exceeds the tolerance; in that case, it has
+ * to be repeated from the old solution with the (smaller) step size next_dt().
+ * Otherwise, the next step size is chosen such that the expected change meets the
+ * tolerance (with a safety factor) and restricted by
+ * - a fraction of the smallest characteristic time scale of all registered
+ *   membrane transport mechanisms (cf. IMembraneTransporter::characteristic_time_scale()),
+ * - the time a calcium wave front needs to pass one element at the front
+ *   (if a front velocity is set, e.g., from a WaveFrontTracker),
+ * - growth and shrinking limits per step,
+ * - lower and upper bounds.
+ *
+ * As the time scales of the mechanisms are large close to equilibrium, large steps
+ * are taken in quiescent periods and small steps only during events.
+ * The measure of change is expected to be the same on all processes;
+ * the time scales are reduced over all processes, so check_step() is collective.
+ */
+class TimeStepController
+{
+	public:
+		/// constructor
+		TimeStepController();
+
+		/// register a membrane transport mechanism whose time scale restricts the step size
+		void add_transporter(SmartPtr<IMembraneTransporter> mt);
+
+		/// set lower and upper bound for the step size (in s)
+		void set_time_step_bounds(number dtMin, number dtMax);
+
+		/// set the maximal factors by which the step size may grow (> 1) or shrink (< 1) per step
+		void set_growth_limits(number maxGrowth, number maxShrink);
+
+		/// set the safety factor (< 1) applied to the step size estimated from the change
+		void set_safety_factor(number safety);
+
+		/// set the relative change of the solution (or fluxes) tolerated per time step
+		void set_change_tolerance(number tol);
+
+		/// set the fraction of the smallest characteristic time scale allowed as step size
+		void set_time_scale_fraction(number frac);
+
+		/// set the size of the elements at the wave front (in m)
+		void set_wave_front_resolution(number h);
+
+		/// set the current velocity of the wave front (in m/s; 0: no front)
+		void set_wave_front_velocity(number v);
+
+		/// smallest characteristic time scale of all mechanisms and the wave front (collective)
+		number characteristic_time_scale() const;
+
+		/**
+		 * @brief check the last time step and calculate the size of the next one
+		 *
+		 * This method is collective.
+		 *
+		 * @param dt         size of the last time step (in s)
+		 * @param relChange  relative change of the solution (or fluxes) during that step
+		 * @return whether the step is accepted (it always is if dt is the lower bound)
+		 */
+		bool check_step(number dt, number relChange);
+
+		/// size proposed for the next step (repetition of the last step if it was rejected)
+		number next_dt() const {return m_nextDt;}
+
+		/// number of accepted and rejected steps so far
+		size_t num_accepted() const {return m_nAccepted;}
+		size_t num_rejected() const {return m_nRejected;}
+
+	private:
+		std::vector<SmartPtr<IMembraneTransporter> > m_vTransporter;
+
+		number m_dtMin;
+		number m_dtMax;
+		number m_maxGrowth;
+		number m_maxShrink;
+		number m_safety;
+		number m_tol;
+		number m_timeScaleFrac;
+		number m_frontResolution;
+		number m_frontVelocity;
+
+		number m_nextDt;
+		size_t m_nAccepted;
+		size_t m_nRejected;
+};
+
+/// @}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__TIME_STEP_CONTROLLER_H
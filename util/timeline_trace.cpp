@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "timeline_trace.h"
+
+#include <fstream>                       // for ofstream
+#include <set>                           // for set
+#include <sstream>                       // for ostringstream
+#include <time.h>                        // for clock_gettime
+#include <utility>                       // for pair
+#include <vector>                        // for vector
+
+#include "common/error.h"                // for UG_COND_THROW
+#include "common/log.h"                  // for UG_LOG
+#include "thread_scratch.h"              // for thread_index
+
+#ifdef UG_PARALLEL
+	#include "pcl/pcl_base.h"                // for NumProcs, ProcRank
+	#include "pcl/pcl_process_communicator.h"  // for ProcessCommunicator
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+namespace {
+
+struct TraceEvent
+{
+	const char* name;
+	double begin;     ///< in s since the origin
+	double duration;  ///< in s
+	size_t thread;
+};
+
+struct TraceBuffer
+{
+	TraceBuffer() : bRecording(false), origin(0.0), next(0), num(0), dropped(0) {}
+
+	bool bRecording;
+	double origin;
+	std::vector<TraceEvent> vEvent;
+	size_t next;
+	size_t num;
+	size_t dropped;
+
+	/// names given from the script (stable storage for the events)
+	std::set<std::string> sName;
+
+	/// phases begun from the script and not yet ended
+	std::vector<std::pair<const char*, double> > vOpen;
+};
+
+TraceBuffer& trace_buffer()
+{
+	static TraceBuffer buf;
+	return buf;
+}
+
+double wall_time()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+}
+
+void record_event(const char* name, double begin, double end)
+{
+#ifdef _OPENMP
+	#pragma omp critical (nc_timeline_trace)
+#endif
+	{
+		TraceBuffer& buf = trace_buffer();
+		if (buf.bRecording && !buf.vEvent.empty())
+		{
+			TraceEvent& ev = buf.vEvent[buf.next];
+			ev.name = name;
+			ev.begin = begin - buf.origin;
+			ev.duration = end - begin;
+			ev.thread = thread_index();
+
+			buf.next = (buf.next + 1) % buf.vEvent.size();
+			if (buf.num < buf.vEvent.size())
+				++buf.num;
+			else
+				++buf.dropped;
+		}
+	}
+}
+
+void append_json_string(std::ostringstream& oss, const char* s)
+{
+	oss << '"';
+	for (; *s; ++s)
+	{
+		if (*s == '"' || *s == '\\')
+			oss << '\\';
+		oss << *s;
+	}
+	oss << '"';
+}
+
+} // anonymous namespace
+
+
+
+void start_timeline_trace(size_t capacity)
+{
+	UG_COND_THROW(!capacity, "Timeline trace capacity must be positive.");
+
+	TraceBuffer& buf = trace_buffer();
+	buf.vEvent.assign(capacity, TraceEvent());
+	buf.next = 0;
+	buf.num = 0;
+	buf.dropped = 0;
+	buf.vOpen.clear();
+
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		com.barrier();
+	}
+#endif
+	buf.origin = wall_time();
+	buf.bRecording = true;
+}
+
+
+void stop_timeline_trace()
+{
+	trace_buffer().bRecording = false;
+}
+
+
+bool timeline_trace_enabled()
+{
+	return trace_buffer().bRecording;
+}
+
+
+void timeline_trace_begin(const std::string& name)
+{
+	TraceBuffer& buf = trace_buffer();
+	if (!buf.bRecording)
+		return;
+
+	const char* stableName = buf.sName.insert(name).first->c_str();
+	buf.vOpen.push_back(std::make_pair(stableName, wall_time()));
+}
+
+
+void timeline_trace_end()
+{
+	TraceBuffer& buf = trace_buffer();
+	if (buf.vOpen.empty())
+		return;
+
+	const std::pair<const char*, double> open = buf.vOpen.back();
+	buf.vOpen.pop_back();
+	record_event(open.first, open.second, wall_time());
+}
+
+
+void write_timeline_trace(const std::string& fileName)
+{
+	TraceBuffer& buf = trace_buffer();
+
+	int rank = 0;
+#ifdef UG_PARALLEL
+	rank = pcl::ProcRank();
+#endif
+
+	// serialize local events (oldest first)
+	std::ostringstream oss;
+	oss.precision(3);
+	oss << std::fixed;
+	oss << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << rank
+		<< ", \"args\": {\"name\": \"rank " << rank << "\"}}";
+	const size_t cap = buf.vEvent.size();
+	const size_t first = buf.num < cap ? 0 : buf.next;
+	for (size_t k = 0; k < buf.num; ++k)
+	{
+		const TraceEvent& ev = buf.vEvent[(first + k) % cap];
+		oss << ",\n{\"name\": ";
+		append_json_string(oss, ev.name);
+		oss << ", \"cat\": \"neuro_collection\", \"ph\": \"X\", \"ts\": " << 1e6 * ev.begin
+			<< ", \"dur\": " << 1e6 * ev.duration << ", \"pid\": " << rank
+			<< ", \"tid\": " << ev.thread << "}";
+	}
+	if (buf.dropped)
+		UG_LOG("Timeline trace: " << buf.dropped << " older events have been dropped on process "
+			<< rank << " (ring buffer capacity " << cap << ")." << std::endl);
+
+	const std::string loc = oss.str();
+	std::vector<char> vLoc(loc.begin(), loc.end());
+	std::vector<char> vAll;
+	std::vector<int> vSize;
+#ifdef UG_PARALLEL
+	if (pcl::NumProcs() > 1)
+	{
+		pcl::ProcessCommunicator com;
+		com.gatherv(vAll, vLoc, 0, &vSize, NULL);
+	}
+	else
+#endif
+	{
+		vAll.swap(vLoc);
+		vSize.assign(1, (int) vAll.size());
+	}
+
+	if (rank != 0)
+		return;
+
+	std::ofstream ofs(fileName.c_str());
+	UG_COND_THROW(!ofs.is_open(), "Could not open timeline trace file '" << fileName << "'.");
+
+	ofs << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	size_t offset = 0;
+	for (size_t p = 0; p < vSize.size(); ++p)
+	{
+		if (!vSize[p])
+			continue;
+		if (p)
+			ofs << ",\n";
+		ofs.write(&vAll[offset], vSize[p]);
+		offset += vSize[p];
+	}
+	ofs << "\n]}\n";
+}
+
+
+
+TimelineTraceScope::TimelineTraceScope(const char* name)
+: m_name(name), m_begin(trace_buffer().bRecording ? wall_time() : -1.0)
+{}
+
+TimelineTraceScope::~TimelineTraceScope()
+{
+	if (m_begin >= 0.0)
+		record_event(m_name, m_begin, wall_time());
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
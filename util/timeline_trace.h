@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__TIMELINE_TRACE_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__TIMELINE_TRACE_H
+
+#include <cstddef>                       // for size_t
+#include <string>                        // for string
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Start recording timeline events of the plugin's coupling phases
+ *
+ * While recording, the phases of a coupled (hybrid) time step (1d substepping in
+ * VDCC_BG_CN::prepare_timestep(), potential value exchange, synaptic current
+ * gathering, measurement output) and any phases marked from the script via
+ * timeline_trace_begin()/timeline_trace_end() are recorded as events with begin
+ * time and duration.
+ *
+ * Each process keeps its events in a ring buffer of the given capacity, i.e.,
+ * only the latest events are kept in long runs. The time origin is taken after
+ * a barrier, so processes are aligned up to the barrier's latency.
+ * Restarting discards all events recorded so far.
+ *
+ * @param capacity  maximal number of events kept per process
+ */
+void start_timeline_trace(size_t capacity);
+
+/// stop recording (events are kept until written or restarted)
+void stop_timeline_trace();
+
+/// whether events are currently recorded
+bool timeline_trace_enabled();
+
+/**
+ * @brief Write the recorded events of all processes in Chrome trace JSON format
+ *
+ * The file can be viewed in chrome://tracing or Perfetto. Each process is shown
+ * as a separate track (pid = rank), so idle times and communication waits
+ * can be compared across processes.
+ * This function is collective: the events are gathered on and written by process 0.
+ *
+ * @param fileName  output file name
+ */
+void write_timeline_trace(const std::string& fileName);
+
+/// begin a phase (from a script); phases may be nested
+void timeline_trace_begin(const std::string& name);
+
+/// end the innermost phase begun by timeline_trace_begin()
+void timeline_trace_end();
+
+
+/**
+ * @brief Records an event for the lifetime of the object (if recording)
+ *
+ * Only to be used for coarse phases (not for element-wise assembling),
+ * use NC_HOT_PATH_SCOPE there.
+ */
+class TimelineTraceScope
+{
+	public:
+		/// the name must be a string literal (it is not copied)
+		TimelineTraceScope(const char* name);
+		~TimelineTraceScope();
+
+	private:
+		const char* m_name;
+		double m_begin;  ///< negative if not recording
+};
+
+/// record the remainder of the enclosing scope as a timeline event
+#define NC_TRACE_SCOPE(name) TimelineTraceScope ncTraceScope(name)
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__TIMELINE_TRACE_H
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "vm_time_series.h"
+
+#include <clocale>                       // for setlocale
+#include <cstdio>                        // for snprintf
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+std::string FormatVmFileTime(const std::string& timeFmt, number time)
+{
+	char buffer[100];
+	std::string oldLocale(setlocale(LC_ALL, NULL));
+	setlocale(LC_NUMERIC, "C");		// ensure decimal point is a . (not a ,)
+	int n = snprintf(buffer, 100, timeFmt.c_str(), time);
+	setlocale(LC_NUMERIC, oldLocale.c_str());
+
+	UG_COND_THROW(n < 0 || n >= 100, "Time format string provided does not meet requirements.\n"
+		<< "It must contain exactly one placeholder (which has to convert a floating point number)"
+		<< "and must not produce an output string longer than 100 chars.");
+
+	return std::string(buffer);
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__VM_TIME_SERIES_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__VM_TIME_SERIES_H
+
+#include <cstddef>                       // for size_t
+#include <string>                        // for string
+#include <vector>                        // for vector
+
+#include "common/types.h"                // for number
+#include "common/math/ugmath.h"          // for MathVector
+#include "kd_tree.h"                     // for KDTree
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Membrane potential time series in a preprocessed binary format
+ *
+ * Membrane potentials given at a fixed set of points for a sequence of time points
+ * are stored in one binary file (in native byte order) with the following layout:
+ *   - header: magic "NCVMTS01", dim (uint32), value size (uint32),
+ *     number of points M (uint64), number of time points N (uint64),
+ *   - point coordinates (M*dim doubles),
+ *   - time points in ascending order (N doubles),
+ *   - potential values (N*M floats, time point by time point).
+ *
+ * On opening, the file is memory-mapped (where supported; otherwise it is read
+ * into memory) and a k-d tree is built on the point coordinates once.
+ * Selecting another time point then only swaps the pointer to the current
+ * value array. The value arrays of the next time points are prefetched
+ * asynchronously by the operating system (madvise) when a time point is selected.
+ * Values can be linearly interpolated between two consecutive time points.
+ *
+ * Such files can be generated from a series of text files by write_from_text_files().
+ */
+template <int dim>
+class VmTimeSeries
+{
+	public:
+		typedef MathVector<dim> pos_type;
+
+	public:
+		/// constructor
+		VmTimeSeries();
+
+		/// destructor
+		~VmTimeSeries();
+
+		/// open a binary potential file
+		void open(const std::string& fileName);
+
+		/// close the file (if open)
+		void close();
+
+		/// whether a file is open
+		bool is_open() const {return m_pData != NULL;}
+
+		/// number of points
+		size_t num_points() const {return m_nPts;}
+
+		/// number of time points
+		size_t num_times() const {return m_nTimes;}
+
+		/// time point with given index
+		number time(size_t i) const {return m_pTimes[i];}
+
+		/// index of the last time point not after t (0 if t precedes all time points)
+		size_t time_index(number t) const;
+
+		/// select the time point whose potential values are returned by vm()
+		void select_time(size_t i);
+
+		/**
+		 * @brief select a point in time for linear interpolation of potential values
+		 * vm() then returns values linearly interpolated between the last time point
+		 * not after t and the following one. Outside the range of time points,
+		 * the values of the first or last time point are used.
+		 */
+		void select_time_interpolated(number t);
+
+		/// set number of time points after the selected one to prefetch (default: 2)
+		void set_num_prefetch(size_t n) {m_nPrefetch = n;}
+
+		/// currently selected time point index
+		size_t selected_time() const {return m_curTime;}
+
+		/// index of the data point nearest to a given position
+		size_t nearest(const pos_type& pos) const;
+
+		/// potential value of a data point at the selected time point
+		number vm(size_t pt) const
+		{
+			const number v = m_pCurVals[pt];
+			return m_interpWeight ? v + m_interpWeight * (m_pNextVals[pt] - v) : v;
+		}
+
+		/// potential value at the data point nearest to a given position at the selected time point
+		number vm(const pos_type& pos) const {return vm(nearest(pos));}
+
+		/// potential value of a data point at a given time point index
+		number vm(size_t pt, size_t timeInd) const {return m_pVals[timeInd*m_nPts + pt];}
+
+		/**
+		 * @brief convert a series of potential text files to the binary format
+		 *
+		 * The text files are expected to contain one line per point, consisting of
+		 * the point coordinates followed by the potential value. All files must
+		 * contain the same points in the same order.
+		 * File names are composed of baseName, the time formatted by timeFmt and ext,
+		 * just like for VDCC_BG_VM2UG.
+		 *
+		 * @param outFileName   name of the binary output file
+		 * @param baseName      base name of the text files
+		 * @param timeFmt       format of time in file names (e.g. "%.4f")
+		 * @param ext           extension of the text files
+		 * @param fileInterval  time interval between two files
+		 * @param fileOffset    time of the first file
+		 * @param numFiles      number of files
+		 */
+		static void write_from_text_files
+		(
+			const std::string& outFileName,
+			const std::string& baseName,
+			const std::string& timeFmt,
+			const std::string& ext,
+			number fileInterval,
+			number fileOffset,
+			size_t numFiles
+		);
+
+	protected:
+		/// advise the operating system to read ahead the values of the given time points
+		void prefetch(size_t begin, size_t end) const;
+
+		static void read_text_file
+		(
+			const std::string& fileName,
+			std::vector<pos_type>& vPosOut,
+			std::vector<float>& vValOut
+		);
+
+	private:
+		const char* m_pData;        ///< begin of file contents
+		size_t m_dataSize;          ///< size of file contents
+		bool m_bMapped;             ///< whether file contents are memory-mapped
+		std::vector<char> m_vBuffer;  ///< file contents if not memory-mapped
+
+		size_t m_nPts;
+		size_t m_nTimes;
+		const double* m_pTimes;     ///< time points (in file)
+		const float* m_pVals;       ///< potential values (in file)
+		const float* m_pCurVals;    ///< potential values of selected time point
+		const float* m_pNextVals;   ///< potential values of the following time point (interpolation)
+		number m_interpWeight;      ///< interpolation weight of the following time point
+		size_t m_curTime;
+		size_t m_nPrefetch;         ///< number of time points to prefetch
+
+		KDTree<dim> m_kdTree;
+};
+
+
+/// formats a point in time with a printf format string, always using a decimal point
+std::string FormatVmFileTime(const std::string& timeFmt, number time);
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "vm_time_series_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__VM_TIME_SERIES_H
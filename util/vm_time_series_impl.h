@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "vm_time_series.h"
+
+#include <algorithm>                     // for std::upper_bound, std::min
+#include <cstring>                       // for memcmp, memcpy
+#include <fstream>                       // for ifstream, ofstream
+#include <sstream>                       // for istringstream
+#include <stdint.h>                      // for uint32_t, uint64_t
+
+#include "common/error.h"                // for UG_COND_THROW
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define NC_VM_TIME_SERIES_MMAP
+	#include <fcntl.h>                   // for open
+	#include <sys/mman.h>                // for mmap, munmap
+	#include <sys/stat.h>                // for fstat
+	#include <unistd.h>                  // for close, sysconf
+#endif
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+namespace vm_time_series_detail {
+
+static const char magic[8] = {'N', 'C', 'V', 'M', 'T', 'S', '0', '1'};
+
+struct Header
+{
+	char magic[8];
+	uint32_t dim;
+	uint32_t valueSize;
+	uint64_t nPts;
+	uint64_t nTimes;
+};
+
+} // namespace vm_time_series_detail
+
+
+template <int dim>
+VmTimeSeries<dim>::VmTimeSeries()
+: m_pData(NULL), m_dataSize(0), m_bMapped(false),
+  m_nPts(0), m_nTimes(0), m_pTimes(NULL), m_pVals(NULL), m_pCurVals(NULL), m_pNextVals(NULL),
+  m_interpWeight(0.0), m_curTime(0), m_nPrefetch(2)
+{}
+
+
+template <int dim>
+VmTimeSeries<dim>::~VmTimeSeries()
+{
+	close();
+}
+
+
+template <int dim>
+void VmTimeSeries<dim>::open(const std::string& fileName)
+{
+	typedef vm_time_series_detail::Header Header;
+
+	close();
+
+#ifdef NC_VM_TIME_SERIES_MMAP
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	UG_COND_THROW(fd < 0, "Could not open potential file '" << fileName << "'.");
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		::close(fd);
+		UG_THROW("Could not determine size of potential file '" << fileName << "'.");
+	}
+	m_dataSize = (size_t) st.st_size;
+	if (m_dataSize)
+	{
+		void* p = mmap(NULL, m_dataSize, PROT_READ, MAP_SHARED, fd, 0);
+		if (p != MAP_FAILED)
+		{
+			m_pData = static_cast<const char*>(p);
+			m_bMapped = true;
+		}
+	}
+	::close(fd);
+#endif
+
+	// fall back to reading the whole file
+	if (!m_pData)
+	{
+		std::ifstream ifs(fileName.c_str(), std::ios::in | std::ios::binary);
+		UG_COND_THROW(!ifs.good(), "Could not open potential file '" << fileName << "'.");
+		ifs.seekg(0, std::ios::end);
+		m_dataSize = (size_t) ifs.tellg();
+		ifs.seekg(0, std::ios::beg);
+		m_vBuffer.resize(m_dataSize + 1);
+		ifs.read(&m_vBuffer[0], m_dataSize);
+		UG_COND_THROW(!ifs.good() && m_dataSize, "Could not read potential file '" << fileName << "'.");
+		m_pData = &m_vBuffer[0];
+	}
+
+	// check header
+	try
+	{
+		UG_COND_THROW(m_dataSize < sizeof(Header), "File is too small to contain a header.");
+		Header h;
+		memcpy(&h, m_pData, sizeof(Header));
+		UG_COND_THROW(memcmp(h.magic, vm_time_series_detail::magic, 8),
+			"File is not a binary potential file.");
+		UG_COND_THROW(h.dim != (uint32_t) dim, "File contains " << h.dim << "d coordinates, "
+			"but " << dim << "d coordinates are required.");
+		UG_COND_THROW(h.valueSize != sizeof(float), "Unsupported value size " << h.valueSize << ".");
+		UG_COND_THROW(!h.nPts || !h.nTimes, "File contains no potential values.");
+
+		m_nPts = (size_t) h.nPts;
+		m_nTimes = (size_t) h.nTimes;
+		const size_t coordsOffset = sizeof(Header);
+		const size_t timesOffset = coordsOffset + m_nPts * dim * sizeof(double);
+		const size_t valsOffset = timesOffset + m_nTimes * sizeof(double);
+		UG_COND_THROW(m_dataSize < valsOffset + m_nTimes * m_nPts * sizeof(float),
+			"File is truncated.");
+
+		m_pTimes = reinterpret_cast<const double*>(m_pData + timesOffset);
+		m_pVals = reinterpret_cast<const float*>(m_pData + valsOffset);
+
+		// build search tree on coordinates
+		const double* pCoords = reinterpret_cast<const double*>(m_pData + coordsOffset);
+		std::vector<pos_type> vPts(m_nPts);
+		for (size_t i = 0; i < m_nPts; ++i)
+			for (int d = 0; d < dim; ++d)
+				vPts[i][d] = pCoords[i*dim + d];
+		m_kdTree.build(vPts);
+	}
+	catch (const UGError& err)
+	{
+		close();
+		UG_THROW(err.get_msg() << "\nInvalid binary potential file '" << fileName << "'.");
+	}
+
+	select_time(0);
+}
+
+
+template <int dim>
+void VmTimeSeries<dim>::close()
+{
+#ifdef NC_VM_TIME_SERIES_MMAP
+	if (m_bMapped)
+		munmap(const_cast<char*>(m_pData), m_dataSize);
+#endif
+	m_bMapped = false;
+	m_vBuffer.clear();
+	m_pData = NULL;
+	m_dataSize = 0;
+
+	m_nPts = 0;
+	m_nTimes = 0;
+	m_pTimes = NULL;
+	m_pVals = NULL;
+	m_pCurVals = NULL;
+	m_pNextVals = NULL;
+	m_interpWeight = 0.0;
+	m_curTime = 0;
+	m_kdTree.clear();
+}
+
+
+template <int dim>
+size_t VmTimeSeries<dim>::time_index(number t) const
+{
+	UG_ASSERT(is_open(), "No potential file open.");
+
+	// small tolerance for times that are given as sums of time steps
+	const double* it = std::upper_bound(m_pTimes, m_pTimes + m_nTimes, t + 1e-9);
+	if (it == m_pTimes)
+		return 0;
+	return (size_t) (it - m_pTimes) - 1;
+}
+
+
+template <int dim>
+void VmTimeSeries<dim>::select_time(size_t i)
+{
+	UG_COND_THROW(i >= m_nTimes, "Time point index " << i << " out of range (number of time points: "
+		<< m_nTimes << ").");
+	m_curTime = i;
+	m_pCurVals = m_pVals + i*m_nPts;
+	m_pNextVals = m_pCurVals;
+	m_interpWeight = 0.0;
+
+	prefetch(i + 1, std::min(i + 1 + m_nPrefetch, m_nTimes));
+}
+
+
+template <int dim>
+void VmTimeSeries<dim>::select_time_interpolated(number t)
+{
+	const size_t i = time_index(t);
+	select_time(i);
+
+	if (i + 1 < m_nTimes && t > m_pTimes[i])
+	{
+		m_pNextVals = m_pVals + (i+1)*m_nPts;
+		m_interpWeight = std::min((t - m_pTimes[i]) / (m_pTimes[i+1] - m_pTimes[i]), 1.0);
+	}
+}
+
+
+template <int dim>
+void VmTimeSeries<dim>::prefetch(size_t begin, size_t end) const
+{
+#ifdef NC_VM_TIME_SERIES_MMAP
+	if (!m_bMapped || begin >= end)
+		return;
+
+	// madvise requires a page-aligned start address
+	const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+	const size_t first = reinterpret_cast<const char*>(m_pVals + begin*m_nPts) - m_pData;
+	const size_t last = reinterpret_cast<const char*>(m_pVals + end*m_nPts) - m_pData;
+	const size_t alignedFirst = first - first % pageSize;
+	madvise(const_cast<char*>(m_pData) + alignedFirst, last - alignedFirst, MADV_WILLNEED);
+#else
+	(void) begin;
+	(void) end;
+#endif
+}
+
+
+template <int dim>
+size_t VmTimeSeries<dim>::nearest(const pos_type& pos) const
+{
+	UG_ASSERT(is_open(), "No potential file open.");
+
+	typename KDTree<dim>::value_type distSq;
+	return m_kdTree.nearest(pos, distSq);
+}
+
+
+template <int dim>
+void VmTimeSeries<dim>::read_text_file
+(
+	const std::string& fileName,
+	std::vector<pos_type>& vPosOut,
+	std::vector<float>& vValOut
+)
+{
+	std::ifstream ifs(fileName.c_str());
+	UG_COND_THROW(!ifs.good(), "Could not open potential file '" << fileName << "'.");
+
+	vPosOut.clear();
+	vValOut.clear();
+
+	std::string line;
+	std::vector<double> vNum;
+	size_t lineNo = 0;
+	while (std::getline(ifs, line))
+	{
+		++lineNo;
+		std::istringstream iss(line);
+		iss.imbue(std::locale::classic());
+
+		vNum.clear();
+		double x;
+		while (iss >> x)
+			vNum.push_back(x);
+
+		// skip empty lines
+		if (vNum.empty())
+			continue;
+
+		UG_COND_THROW(vNum.size() < (size_t) dim + 1, "Line " << lineNo << " of potential file '"
+			<< fileName << "' does not contain " << dim << " coordinates and a potential value.");
+
+		pos_type pos;
+		for (int d = 0; d < dim; ++d)
+			pos[d] = vNum[d];
+		vPosOut.push_back(pos);
+		vValOut.push_back((float) vNum.back());
+	}
+}
+
+
+template <int dim>
+void VmTimeSeries<dim>::write_from_text_files
+(
+	const std::string& outFileName,
+	const std::string& baseName,
+	const std::string& timeFmt,
+	const std::string& ext,
+	number fileInterval,
+	number fileOffset,
+	size_t numFiles
+)
+{
+	typedef vm_time_series_detail::Header Header;
+
+	UG_COND_THROW(!numFiles, "At least one potential file is required.");
+
+	std::vector<pos_type> vPos0, vPos;
+	std::vector<float> vVal;
+	std::vector<double> vTimes(numFiles);
+	for (size_t f = 0; f < numFiles; ++f)
+		vTimes[f] = fileOffset + f * fileInterval;
+
+	std::ofstream ofs(outFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	UG_COND_THROW(!ofs.good(), "Could not open '" << outFileName << "' for writing.");
+
+	for (size_t f = 0; f < numFiles; ++f)
+	{
+		const std::string fileName = baseName + FormatVmFileTime(timeFmt, vTimes[f]) + ext;
+
+		if (!f)
+		{
+			read_text_file(fileName, vPos0, vVal);
+			UG_COND_THROW(vPos0.empty(), "Potential file '" << fileName << "' contains no points.");
+
+			// header, coordinates and times
+			Header h;
+			memcpy(h.magic, vm_time_series_detail::magic, 8);
+			h.dim = (uint32_t) dim;
+			h.valueSize = (uint32_t) sizeof(float);
+			h.nPts = (uint64_t) vPos0.size();
+			h.nTimes = (uint64_t) numFiles;
+			ofs.write(reinterpret_cast<const char*>(&h), sizeof(Header));
+
+			std::vector<double> vCoords(vPos0.size() * dim);
+			for (size_t i = 0; i < vPos0.size(); ++i)
+				for (int d = 0; d < dim; ++d)
+					vCoords[i*dim + d] = vPos0[i][d];
+			ofs.write(reinterpret_cast<const char*>(&vCoords[0]), vCoords.size() * sizeof(double));
+			ofs.write(reinterpret_cast<const char*>(&vTimes[0]), numFiles * sizeof(double));
+		}
+		else
+		{
+			read_text_file(fileName, vPos, vVal);
+			UG_COND_THROW(vPos.size() != vPos0.size(), "Potential file '" << fileName << "' contains "
+				<< vPos.size() << " points, but the first file contains " << vPos0.size() << ".");
+			for (size_t i = 0; i < vPos.size(); ++i)
+				UG_COND_THROW(VecDistanceSq(vPos[i], vPos0[i]) > 1e-18, "Point " << i << " in potential file '"
+					<< fileName << "' differs from the one in the first file.\n"
+					"Binary potential files require the same points in the same order for all times.");
+		}
+
+		ofs.write(reinterpret_cast<const char*>(&vVal[0]), vVal.size() * sizeof(float));
+		UG_COND_THROW(!ofs.good(), "Writing to '" << outFileName << "' failed.");
+	}
+}
+
+
+} // namespace neuro_collection
+} // namespace ug
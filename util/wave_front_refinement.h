@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#ifndef UG__PLUGINS__NEURO_COLLECTION__UTIL__WAVE_FRONT_REFINEMENT_H
+#define UG__PLUGINS__NEURO_COLLECTION__UTIL__WAVE_FRONT_REFINEMENT_H
+
+#include "common/types.h"                           // for number
+#include "common/util/smart_pointer.h"              // for SmartPtr
+#include "lib_disc/domain_traits.h"                 // for domain_traits
+#include "lib_grid/refinement/refiner_interface.h"  // for IRefiner
+
+#include "neurite_axial_refinement_marker.h"        // for NeuriteAxialRefinementMarker
+
+#include <vector>
+
+
+namespace ug {
+namespace neuro_collection {
+
+///@addtogroup plugin_neuro_collection
+///@{
+
+
+/**
+ * @brief Moving-window adaptive refinement around a wave front
+ *
+ * A calcium wave travelling along a dendrite (in x direction) only needs
+ * fine resolution in a narrow band around its front. This class marks all
+ * surface elements (of full dimension) intersecting the window
+ * [xFront - behind, xFront + ahead] for refinement (up to a maximal level),
+ * and all refined surface elements lying completely outside of the window
+ * widened by a coarsening margin for coarsening.
+ * The front position can be obtained from waveFrontX() or a WaveFrontTracker.
+ *
+ * Call mark() before each adaption of the refiner, i.e.
+ *   driver:mark(refiner, tracker:front_position())
+ *   refiner:refine() or refiner:coarsen()
+ *
+ * On neurite grids created by the neurites_from_swc functions, a
+ * NeuriteAxialRefinementMarker can be set, in which case the elements in
+ * the window are refined anisotropically in axial direction only.
+ *
+ * If there is no front (xFront = -max number), nothing is refined.
+ */
+template <typename TDomain>
+class WaveFrontRefinementDriver
+{
+	public:
+		static const int dim = TDomain::dim;
+		typedef typename domain_traits<dim>::grid_base_object elem_type;
+
+	public:
+		/// constructor
+		WaveFrontRefinementDriver(SmartPtr<TDomain> dom);
+
+		/// set extent of the refinement window behind and ahead of the front
+		void set_window(number behind, number ahead);
+
+		/// set distance from the window beyond which elements are coarsened (default: 0)
+		void set_coarsening_margin(number margin);
+
+		/// set maximal refinement level (default: 1)
+		void set_max_level(int lvl);
+
+		/// refine axially only, using the given marker (only for 3d neurite grids)
+		void set_axial_marker(SmartPtr<NeuriteAxialRefinementMarker> marker);
+
+		/// mark elements for refinement and coarsening around the given front position
+		void mark(SmartPtr<IRefiner> refiner, number xFront);
+
+		/// number of elements marked for refinement by the last call to mark()
+		size_t num_marked_for_refinement() const {return m_nRefine;}
+
+		/// number of elements marked for coarsening by the last call to mark()
+		size_t num_marked_for_coarsening() const {return m_nCoarsen;}
+
+	private:
+		SmartPtr<TDomain> m_spDom;
+		number m_behind;
+		number m_ahead;
+		number m_coarsenMargin;
+		int m_maxLevel;
+		SmartPtr<NeuriteAxialRefinementMarker> m_spAxialMarker;
+
+		std::vector<elem_type*> m_vRefine;
+		size_t m_nRefine;
+		size_t m_nCoarsen;
+};
+
+///@}
+
+} // namespace neuro_collection
+} // namespace ug
+
+#include "wave_front_refinement_impl.h"
+
+#endif // UG__PLUGINS__NEURO_COLLECTION__UTIL__WAVE_FRONT_REFINEMENT_H
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2009-2019: G-CSC, Goethe University Frankfurt
+ *
+ * Author: agent
+ * Creation date: 2026-10-14
+ *
+ * This file is part of NeuroBox, which is based on UG4.
+ *
+ * NeuroBox and UG4 are free software: You can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 3
+ * (as published by the Free Software Foundation) with the following additional
+ * attribution requirements (according to LGPL/GPL v3 §7):
+ *
+ * (1) The following notice must be displayed in the appropriate legal notices
+ * of covered and combined works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (2) The following notice must be displayed at a prominent place in the
+ * terminal output of covered works: "Based on UG4 (www.ug4.org/license)".
+ *
+ * (3) The following bibliography is recommended for citation and must be
+ * preserved in all covered files:
+ * "Reiter, S., Vogel, A., Heppner, I., Rupp, M., and Wittum, G. A massively
+ *   parallel geometric multigrid solver on hierarchically distributed grids.
+ *   Computing and visualization in science 16, 4 (2013), 151-164"
+ * "Vogel, A., Reiter, S., Rupp, M., Nägel, A., and Wittum, G. UG4 -- a novel
+ *   flexible software system for simulating PDE based models on high performance
+ *   computers. Computing and visualization in science 16, 4 (2013), 165-179"
+ * "Stepniewski, M., Breit, M., Hoffer, M. and Queisser, G.
+ *   NeuroBox: computational mathematics in multiscale neuroscience.
+ *   Computing and visualization in science (2019).
+ * "Breit, M. et al. Anatomically detailed and large-scale simulations studying
+ *   synapse loss and synchrony using NeuroBox. Front. Neuroanat. 10 (2016), 8"
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ */
+
+#include "wave_front_refinement.h"
+
+#include "common/error.h"                 // for UG_COND_THROW
+#include "lib_grid/tools/surface_view.h"  // for SurfaceView
+
+#include <algorithm>                      // for std::min, std::max
+#include <limits>                         // for numeric_limits
+
+
+namespace ug {
+namespace neuro_collection {
+
+
+template <typename TElem>
+void MarkWindowForRefinement
+(
+	SmartPtr<IRefiner> refiner,
+	SmartPtr<NeuriteAxialRefinementMarker> axialMarker,
+	const std::vector<TElem*>& vElem
+)
+{
+	UG_COND_THROW(axialMarker.valid(), "Axial refinement is only available for volume grids.");
+
+	const size_t nElem = vElem.size();
+	for (size_t i = 0; i < nElem; ++i)
+		refiner->mark(vElem[i], RM_REFINE);
+}
+
+inline void MarkWindowForRefinement
+(
+	SmartPtr<IRefiner> refiner,
+	SmartPtr<NeuriteAxialRefinementMarker> axialMarker,
+	const std::vector<Volume*>& vElem
+)
+{
+	if (axialMarker.valid())
+	{
+		axialMarker->mark_volumes(refiner, vElem);
+		return;
+	}
+
+	const size_t nElem = vElem.size();
+	for (size_t i = 0; i < nElem; ++i)
+		refiner->mark(vElem[i], RM_REFINE);
+}
+
+
+
+template <typename TDomain>
+WaveFrontRefinementDriver<TDomain>::WaveFrontRefinementDriver(SmartPtr<TDomain> dom)
+: m_spDom(dom),
+  m_behind(0.0),
+  m_ahead(0.0),
+  m_coarsenMargin(0.0),
+  m_maxLevel(1),
+  m_nRefine(0),
+  m_nCoarsen(0)
+{
+	UG_COND_THROW(!m_spDom.valid(), "WaveFrontRefinementDriver: Invalid domain given.");
+}
+
+
+template <typename TDomain>
+void WaveFrontRefinementDriver<TDomain>::set_window(number behind, number ahead)
+{
+	UG_COND_THROW(behind < 0.0 || ahead < 0.0, "Window extents must be non-negative.");
+	m_behind = behind;
+	m_ahead = ahead;
+}
+
+
+template <typename TDomain>
+void WaveFrontRefinementDriver<TDomain>::set_coarsening_margin(number margin)
+{
+	UG_COND_THROW(margin < 0.0, "Coarsening margin must be non-negative.");
+	m_coarsenMargin = margin;
+}
+
+
+template <typename TDomain>
+void WaveFrontRefinementDriver<TDomain>::set_max_level(int lvl)
+{
+	UG_COND_THROW(lvl < 0, "Maximal level must be non-negative.");
+	m_maxLevel = lvl;
+}
+
+
+template <typename TDomain>
+void WaveFrontRefinementDriver<TDomain>::set_axial_marker(SmartPtr<NeuriteAxialRefinementMarker> marker)
+{
+	m_spAxialMarker = marker;
+}
+
+
+template <typename TDomain>
+void WaveFrontRefinementDriver<TDomain>::mark(SmartPtr<IRefiner> refiner, number xFront)
+{
+	typedef typename SurfaceView::traits<elem_type>::const_iterator elem_it;
+
+	const bool bFront = xFront > -std::numeric_limits<number>::max();
+	const number winLeft = xFront - m_behind;
+	const number winRight = xFront + m_ahead;
+	const number keepLeft = winLeft - m_coarsenMargin;
+	const number keepRight = winRight + m_coarsenMargin;
+
+	MultiGrid& mg = *m_spDom->grid();
+	const typename TDomain::position_accessor_type& aaPos = m_spDom->position_accessor();
+	SurfaceView sv(m_spDom->subset_handler());
+
+	m_vRefine.clear();
+	m_nCoarsen = 0;
+
+	elem_it it = sv.begin<elem_type>(GridLevel(), SurfaceView::ALL_BUT_SHADOW_COPY);
+	elem_it itEnd = sv.end<elem_type>(GridLevel(), SurfaceView::ALL_BUT_SHADOW_COPY);
+	for (; it != itEnd; ++it)
+	{
+		elem_type* elem = *it;
+
+		// x extent of element
+		number xMin = std::numeric_limits<number>::max();
+		number xMax = -std::numeric_limits<number>::max();
+		const size_t nVrt = elem->num_vertices();
+		for (size_t i = 0; i < nVrt; ++i)
+		{
+			const number x = aaPos[elem->vertex(i)][0];
+			xMin = std::min(xMin, x);
+			xMax = std::max(xMax, x);
+		}
+
+		const int lvl = mg.get_level(elem);
+		if (bFront && xMax >= winLeft && xMin <= winRight)
+		{
+			if (lvl < m_maxLevel)
+				m_vRefine.push_back(elem);
+		}
+		else if (lvl > 0 && (!bFront || xMax < keepLeft || xMin > keepRight))
+		{
+			refiner->mark(elem, RM_COARSEN);
+			++m_nCoarsen;
+		}
+	}
+
+	MarkWindowForRefinement(refiner, m_spAxialMarker, m_vRefine);
+	m_nRefine = m_vRefine.size();
+}
+
+
+} // namespace neuro_collection
+} // namespace ug